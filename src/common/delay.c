@@ -12,10 +12,8 @@ void blocked_delay_ms(uint32_t ms)
 
 void sys_timer_blocked_delay_ms(float delay_ms)
 {
-	float start_time = get_sys_time_ms();
-	float curr_time;
+	uint64_t start_time = get_time_us();
+	uint64_t delay_us = (uint64_t)(delay_ms * 1000.0f);
 
-	do {
-		curr_time = get_sys_time_ms();
-	} while((curr_time - start_time) < delay_ms);
+	while((get_time_us() - start_time) < delay_us);
 }
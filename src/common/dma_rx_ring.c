@@ -0,0 +1,69 @@
+#include <stdint.h>
+#include <string.h>
+#include "dma_rx_ring.h"
+
+void dma_rx_ring_init(dma_rx_ring_t *ring, uint8_t *buf, uint32_t size)
+{
+	ring->buf = buf;
+	ring->size = size;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->dma_pos = 0;
+	ring->overrun_cnt = 0;
+}
+
+/* called by the half transfer, transfer complete and idle line interrupts of
+ * the same stream (same priority), dma_pos = buffer size - ndtr. the dma can
+ * not move a full lap between two calls since the half transfer and transfer
+ * complete interrupts are raised every half of the buffer */
+void dma_rx_ring_update(dma_rx_ring_t *ring, uint32_t dma_pos)
+{
+	uint32_t received = (dma_pos - ring->dma_pos) & (ring->size - 1);
+	ring->dma_pos = dma_pos & (ring->size - 1);
+
+	__atomic_store_n(&ring->head, ring->head + received, __ATOMIC_RELEASE);
+}
+
+uint32_t dma_rx_ring_available(dma_rx_ring_t *ring)
+{
+	return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - ring->tail;
+}
+
+/* bulk read of the received bytes, returns the number of bytes copied */
+int dma_rx_ring_read(dma_rx_ring_t *ring, uint8_t *data, int size)
+{
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	uint32_t tail = ring->tail;
+
+	/* the dma may already be up to half of the buffer ahead of the published
+	 * head, only the last half of the buffer is guaranteed to be intact */
+	uint32_t half = ring->size / 2;
+	if((head - tail) > half) {
+		ring->overrun_cnt += (head - tail) - half;
+		tail = head - half;
+	}
+
+	uint32_t len = head - tail;
+	if(len > (uint32_t)size) {
+		len = size;
+	}
+
+	/* copy in two parts if the data wraps around the end of the buffer */
+	uint32_t start = tail & (ring->size - 1);
+	uint32_t first = ring->size - start;
+	if(first > len) {
+		first = len;
+	}
+
+	memcpy(data, &ring->buf[start], first);
+	memcpy(&data[first], ring->buf, len - first);
+
+	ring->tail = tail + len;
+
+	return len;
+}
+
+uint32_t dma_rx_ring_get_overrun_cnt(dma_rx_ring_t *ring)
+{
+	return ring->overrun_cnt;
+}
@@ -0,0 +1,26 @@
+#ifndef __DMA_RX_RING_H__
+#define __DMA_RX_RING_H__
+
+#include <stdint.h>
+
+/* receive ring of a circular dma stream. the dma is the producer, its position
+ * is published by the half transfer, transfer complete and idle line
+ * interrupts. the consumer reads the published bytes without locking */
+typedef struct {
+	uint8_t *buf;
+	uint32_t size;     //must be power of 2
+
+	uint32_t head;     //bytes written by the dma, only modified by the interrupts
+	uint32_t tail;     //bytes read, only modified by the consumer
+	uint32_t dma_pos;  //position of the dma in the buffer at the last update
+
+	uint32_t overrun_cnt; //bytes overwritten by the dma before being read
+} dma_rx_ring_t;
+
+void dma_rx_ring_init(dma_rx_ring_t *ring, uint8_t *buf, uint32_t size);
+void dma_rx_ring_update(dma_rx_ring_t *ring, uint32_t dma_pos);
+uint32_t dma_rx_ring_available(dma_rx_ring_t *ring);
+int dma_rx_ring_read(dma_rx_ring_t *ring, uint8_t *data, int size);
+uint32_t dma_rx_ring_get_overrun_cnt(dma_rx_ring_t *ring);
+
+#endif
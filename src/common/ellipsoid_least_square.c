@@ -115,10 +115,10 @@ void ellipsoid_least_square_fitting(float *x0, float *y0, float *z0, float *A, f
 	MAT_INV(&LS_A, &LS_A_INV); //XXX: check inversion is valid or not
 	MAT_MULT(&LS_A_INV, &LS_b, &LS_x);
 
-	*x0 = -0.5 * mat_data(LS_x)[2]; //XXX: use fast squared root function
+	*x0 = -0.5f * mat_data(LS_x)[2]; //XXX: use fast squared root function
 	*y0 = -mat_data(LS_x)[3] / (2.0f * mat_data(LS_x)[0]);
 	*z0 = mat_data(LS_x)[4] / (2.0f * mat_data(LS_x)[1]);
-	*A = sqrt(mat_data(LS_x)[0]*mat_data(LS_x)[0] + mat_data(LS_x)[1]*mat_data(LS_x)[1] + mat_data(LS_x)[2]*mat_data(LS_x)[2]);
-	*B = *A / sqrt(mat_data(LS_x)[0]);
-	*C = *A / sqrt(mat_data(LS_x)[1]);
+	*A = sqrtf(mat_data(LS_x)[0]*mat_data(LS_x)[0] + mat_data(LS_x)[1]*mat_data(LS_x)[1] + mat_data(LS_x)[2]*mat_data(LS_x)[2]);
+	*B = *A / sqrtf(mat_data(LS_x)[0]);
+	*C = *A / sqrtf(mat_data(LS_x)[1]);
 }
@@ -0,0 +1,80 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "frame_parser.h"
+
+void frame_parser_init(frame_parser_t *parser, uint8_t *buf, int size)
+{
+	parser->buf = buf;
+	parser->size = size;
+	parser->pos = 0;
+	parser->checksum = FRAME_PARSER_CHECKSUM_INIT_VAL;
+	parser->frame_cnt = 0;
+	parser->framing_err_cnt = 0;
+	parser->checksum_err_cnt = 0;
+}
+
+uint8_t frame_parser_checksum(uint8_t *payload, int size)
+{
+	uint8_t result = FRAME_PARSER_CHECKSUM_INIT_VAL;
+
+	int i;
+	for(i = 0; i < size; i++) {
+		result ^= payload[i];
+	}
+
+	return result;
+}
+
+/* constant time per byte, returns true if a complete frame with valid
+ * checksum is assembled in the buffer. the buffer stays untouched until the
+ * next start byte is fed */
+bool frame_parser_feed(frame_parser_t *parser, uint8_t c)
+{
+	/* hunt for the start byte */
+	if(parser->pos == 0) {
+		if(c == FRAME_PARSER_START_BYTE) {
+			parser->buf[0] = c;
+			parser->checksum = FRAME_PARSER_CHECKSUM_INIT_VAL;
+			parser->pos = 1;
+		}
+		return false;
+	}
+
+	/* end of the frame */
+	if(parser->pos == (parser->size - 1)) {
+		parser->pos = 0;
+
+		if(c != FRAME_PARSER_END_BYTE) {
+			parser->framing_err_cnt++;
+
+			/* the start byte of the next frame may be received early if
+			 * bytes were lost */
+			if(c == FRAME_PARSER_START_BYTE) {
+				parser->buf[0] = c;
+				parser->checksum = FRAME_PARSER_CHECKSUM_INIT_VAL;
+				parser->pos = 1;
+			}
+			return false;
+		}
+
+		parser->buf[parser->size - 1] = c;
+
+		if(parser->checksum != parser->buf[1]) {
+			parser->checksum_err_cnt++;
+			return false;
+		}
+
+		parser->frame_cnt++;
+		return true;
+	}
+
+	/* checksum and id bytes are not covered by the checksum */
+	if(parser->pos >= 3) {
+		parser->checksum ^= c;
+	}
+
+	parser->buf[parser->pos] = c;
+	parser->pos++;
+
+	return false;
+}
@@ -0,0 +1,31 @@
+#ifndef __FRAME_PARSER_H__
+#define __FRAME_PARSER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* serial frame of the optitrack and vins-mono links:
+ * +------------+----------+----+----------+----------+
+ * | start byte | checksum | id | payloads | end byte |
+ * +------------+----------+----+----------+----------+
+ * the checksum is the xor of the payloads with the initial value 19 */
+#define FRAME_PARSER_START_BYTE '@'
+#define FRAME_PARSER_END_BYTE '+'
+#define FRAME_PARSER_CHECKSUM_INIT_VAL 19
+
+typedef struct {
+	uint8_t *buf;  //frame is assembled in place
+	int size;      //frame size including the start and end byte
+	int pos;       //0: waiting for the start byte
+	uint8_t checksum; //running checksum of the received payloads
+
+	uint32_t frame_cnt;
+	uint32_t framing_err_cnt;  //end byte mismatch
+	uint32_t checksum_err_cnt;
+} frame_parser_t;
+
+void frame_parser_init(frame_parser_t *parser, uint8_t *buf, int size);
+bool frame_parser_feed(frame_parser_t *parser, uint8_t c);
+uint8_t frame_parser_checksum(uint8_t *payload, int size);
+
+#endif
@@ -0,0 +1,225 @@
+#ifndef __MAT3_H__
+#define __MAT3_H__
+
+#include "arm_math.h"
+
+/* fixed size 3x1 vector and 3x3 matrix (row-major) operations. all functions
+ * are unrolled and inlined, the result must not alias with the operands
+ * unless stated otherwise */
+
+typedef struct {
+	float v[3];
+} vec3_t;
+
+typedef struct {
+	float m[9];
+} mat3_t;
+
+#define MAT3_AT(mat, r, c) ((mat)->m[(r) * 3 + (c)])
+
+static inline void vec3_set(vec3_t *vec, float x, float y, float z)
+{
+	vec->v[0] = x;
+	vec->v[1] = y;
+	vec->v[2] = z;
+}
+
+static inline void vec3_load(vec3_t *vec, const float *data)
+{
+	vec->v[0] = data[0];
+	vec->v[1] = data[1];
+	vec->v[2] = data[2];
+}
+
+/* result can alias with the operands */
+static inline void vec3_add(const vec3_t *a, const vec3_t *b, vec3_t *result)
+{
+	result->v[0] = a->v[0] + b->v[0];
+	result->v[1] = a->v[1] + b->v[1];
+	result->v[2] = a->v[2] + b->v[2];
+}
+
+/* result can alias with the operands */
+static inline void vec3_sub(const vec3_t *a, const vec3_t *b, vec3_t *result)
+{
+	result->v[0] = a->v[0] - b->v[0];
+	result->v[1] = a->v[1] - b->v[1];
+	result->v[2] = a->v[2] - b->v[2];
+}
+
+/* result can alias with the operand */
+static inline void vec3_scale(const vec3_t *a, float scale, vec3_t *result)
+{
+	result->v[0] = a->v[0] * scale;
+	result->v[1] = a->v[1] * scale;
+	result->v[2] = a->v[2] * scale;
+}
+
+static inline float vec3_dot(const vec3_t *a, const vec3_t *b)
+{
+	return a->v[0] * b->v[0] + a->v[1] * b->v[1] + a->v[2] * b->v[2];
+}
+
+/* result = a x b */
+static inline void vec3_cross(const vec3_t *a, const vec3_t *b, vec3_t *result)
+{
+	result->v[0] = a->v[1] * b->v[2] - a->v[2] * b->v[1];
+	result->v[1] = a->v[2] * b->v[0] - a->v[0] * b->v[2];
+	result->v[2] = a->v[0] * b->v[1] - a->v[1] * b->v[0];
+}
+
+static inline float vec3_norm(const vec3_t *a)
+{
+	float norm;
+	arm_sqrt_f32(vec3_dot(a, a), &norm);
+	return norm;
+}
+
+static inline void vec3_normalize(vec3_t *a)
+{
+	vec3_scale(a, 1.0f / vec3_norm(a), a);
+}
+
+static inline void mat3_load(mat3_t *mat, const float *data)
+{
+	int i;
+	for(i = 0; i < 9; i++) {
+		mat->m[i] = data[i];
+	}
+}
+
+/* mat = diag(x, y, z) */
+static inline void mat3_diag(mat3_t *mat, float x, float y, float z)
+{
+	mat->m[0] = x;
+	mat->m[1] = 0.0f;
+	mat->m[2] = 0.0f;
+	mat->m[3] = 0.0f;
+	mat->m[4] = y;
+	mat->m[5] = 0.0f;
+	mat->m[6] = 0.0f;
+	mat->m[7] = 0.0f;
+	mat->m[8] = z;
+}
+
+/* mat = [col0, col1, col2] */
+static inline void mat3_from_cols(mat3_t *mat, const vec3_t *col0, const vec3_t *col1,
+                                  const vec3_t *col2)
+{
+	mat->m[0] = col0->v[0];
+	mat->m[3] = col0->v[1];
+	mat->m[6] = col0->v[2];
+	mat->m[1] = col1->v[0];
+	mat->m[4] = col1->v[1];
+	mat->m[7] = col1->v[2];
+	mat->m[2] = col2->v[0];
+	mat->m[5] = col2->v[1];
+	mat->m[8] = col2->v[2];
+}
+
+static inline void mat3_transpose(const mat3_t *a, mat3_t *result)
+{
+	result->m[0] = a->m[0];
+	result->m[1] = a->m[3];
+	result->m[2] = a->m[6];
+	result->m[3] = a->m[1];
+	result->m[4] = a->m[4];
+	result->m[5] = a->m[7];
+	result->m[6] = a->m[2];
+	result->m[7] = a->m[5];
+	result->m[8] = a->m[8];
+}
+
+/* result can alias with the operands */
+static inline void mat3_add(const mat3_t *a, const mat3_t *b, mat3_t *result)
+{
+	int i;
+	for(i = 0; i < 9; i++) {
+		result->m[i] = a->m[i] + b->m[i];
+	}
+}
+
+/* result can alias with the operands */
+static inline void mat3_sub(const mat3_t *a, const mat3_t *b, mat3_t *result)
+{
+	int i;
+	for(i = 0; i < 9; i++) {
+		result->m[i] = a->m[i] - b->m[i];
+	}
+}
+
+/* result = a * b */
+static inline void mat3_mul(const mat3_t *a, const mat3_t *b, mat3_t *result)
+{
+	result->m[0] = a->m[0] * b->m[0] + a->m[1] * b->m[3] + a->m[2] * b->m[6];
+	result->m[1] = a->m[0] * b->m[1] + a->m[1] * b->m[4] + a->m[2] * b->m[7];
+	result->m[2] = a->m[0] * b->m[2] + a->m[1] * b->m[5] + a->m[2] * b->m[8];
+	result->m[3] = a->m[3] * b->m[0] + a->m[4] * b->m[3] + a->m[5] * b->m[6];
+	result->m[4] = a->m[3] * b->m[1] + a->m[4] * b->m[4] + a->m[5] * b->m[7];
+	result->m[5] = a->m[3] * b->m[2] + a->m[4] * b->m[5] + a->m[5] * b->m[8];
+	result->m[6] = a->m[6] * b->m[0] + a->m[7] * b->m[3] + a->m[8] * b->m[6];
+	result->m[7] = a->m[6] * b->m[1] + a->m[7] * b->m[4] + a->m[8] * b->m[7];
+	result->m[8] = a->m[6] * b->m[2] + a->m[7] * b->m[5] + a->m[8] * b->m[8];
+}
+
+/* result = transpose(a) * b, without forming the transpose */
+static inline void mat3_trans_mul(const mat3_t *a, const mat3_t *b, mat3_t *result)
+{
+	result->m[0] = a->m[0] * b->m[0] + a->m[3] * b->m[3] + a->m[6] * b->m[6];
+	result->m[1] = a->m[0] * b->m[1] + a->m[3] * b->m[4] + a->m[6] * b->m[7];
+	result->m[2] = a->m[0] * b->m[2] + a->m[3] * b->m[5] + a->m[6] * b->m[8];
+	result->m[3] = a->m[1] * b->m[0] + a->m[4] * b->m[3] + a->m[7] * b->m[6];
+	result->m[4] = a->m[1] * b->m[1] + a->m[4] * b->m[4] + a->m[7] * b->m[7];
+	result->m[5] = a->m[1] * b->m[2] + a->m[4] * b->m[5] + a->m[7] * b->m[8];
+	result->m[6] = a->m[2] * b->m[0] + a->m[5] * b->m[3] + a->m[8] * b->m[6];
+	result->m[7] = a->m[2] * b->m[1] + a->m[5] * b->m[4] + a->m[8] * b->m[7];
+	result->m[8] = a->m[2] * b->m[2] + a->m[5] * b->m[5] + a->m[8] * b->m[8];
+}
+
+/* result = a * vec */
+static inline void mat3_mul_vec3(const mat3_t *a, const vec3_t *vec, vec3_t *result)
+{
+	result->v[0] = a->m[0] * vec->v[0] + a->m[1] * vec->v[1] + a->m[2] * vec->v[2];
+	result->v[1] = a->m[3] * vec->v[0] + a->m[4] * vec->v[1] + a->m[5] * vec->v[2];
+	result->v[2] = a->m[6] * vec->v[0] + a->m[7] * vec->v[1] + a->m[8] * vec->v[2];
+}
+
+/* result = transpose(a) * vec */
+static inline void mat3_trans_mul_vec3(const mat3_t *a, const vec3_t *vec, vec3_t *result)
+{
+	result->v[0] = a->m[0] * vec->v[0] + a->m[3] * vec->v[1] + a->m[6] * vec->v[2];
+	result->v[1] = a->m[1] * vec->v[0] + a->m[4] * vec->v[1] + a->m[7] * vec->v[2];
+	result->v[2] = a->m[2] * vec->v[0] + a->m[5] * vec->v[1] + a->m[8] * vec->v[2];
+}
+
+/* skew-symmetric matrix of the vector, hat(a) * b = a x b */
+static inline void mat3_hat(const vec3_t *vec, mat3_t *result)
+{
+	result->m[0] = 0.0f;
+	result->m[1] = -vec->v[2];
+	result->m[2] = +vec->v[1];
+	result->m[3] = +vec->v[2];
+	result->m[4] = 0.0f;
+	result->m[5] = -vec->v[0];
+	result->m[6] = -vec->v[1];
+	result->m[7] = +vec->v[0];
+	result->m[8] = 0.0f;
+}
+
+/* vee map of a skew-symmetric matrix */
+static inline void mat3_vee(const mat3_t *mat, vec3_t *result)
+{
+	result->v[0] = mat->m[7];
+	result->v[1] = mat->m[2];
+	result->v[2] = mat->m[3];
+}
+
+/* vee(a - transpose(a)), the skew-symmetric part is formed implicitly */
+static inline void mat3_vee_skew(const mat3_t *a, vec3_t *result)
+{
+	result->v[0] = a->m[7] - a->m[5];
+	result->v[1] = a->m[2] - a->m[6];
+	result->v[2] = a->m[3] - a->m[1];
+}
+
+#endif
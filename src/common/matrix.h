@@ -36,6 +36,13 @@
 
 #define mat_data(mat) mat.pData
 
+/* packed storage of a n x n symmetric matrix, only the upper triangular part
+ * is saved (row-major), the element (r, c) and (c, r) share the same index */
+#define SYM_MAT_SIZE(n) ((n) * ((n) + 1) / 2)
+#define SYM_MAT_INDEX(n, r, c) \
+	((r) <= (c) ? ((r) * (n) - ((r) * ((r) - 1)) / 2 + (c) - (r)) : \
+	              ((c) * (n) - ((c) * ((c) - 1)) / 2 + (r) - (c)))
+
 extern volatile arm_status mat_op_status;
 
 void matrix_reset(float *data, int row_num, int column_num);
@@ -39,9 +39,9 @@ void quat_normalize(float *q)
 //in: quaterion, out: euler angle [radian]
 void quat_to_euler(float *q, euler_t *euler)
 {
-	euler->roll = atan2(2.0*(q[0]*q[1] + q[2]*q[3]), 1.0-2.0*(q[1]*q[1] + q[2]*q[2]));
-	euler->pitch = asin(2.0*(q[0]*q[2] - q[3]*q[1]));
-	euler->yaw = atan2(2.0*(q[0]*q[3] + q[1]*q[2]), 1.0-2.0*(q[2]*q[2] + q[3]*q[3]));
+	euler->roll = atan2f(2.0f*(q[0]*q[1] + q[2]*q[3]), 1.0f-2.0f*(q[1]*q[1] + q[2]*q[2]));
+	euler->pitch = asinf(2.0f*(q[0]*q[2] - q[3]*q[1]));
+	euler->yaw = atan2f(2.0f*(q[0]*q[3] + q[1]*q[2]), 1.0f-2.0f*(q[2]*q[2] + q[3]*q[3]));
 }
 
 //in: euler angle [radian], out: quaternion
@@ -1,8 +1,8 @@
 #ifndef __SE3_MATH_H__
 #define __SE3_MATH_H__
 
-#define deg_to_rad(angle) (angle * 0.01745329252)
-#define rad_to_deg(radian) (radian * 57.2957795056)
+#define deg_to_rad(angle) ((angle) * 0.01745329252f)
+#define rad_to_deg(radian) ((radian) * 57.2957795056f)
 
 #include "se3_math.h"
 
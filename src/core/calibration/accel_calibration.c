@@ -31,9 +31,9 @@ static int detect_accel_orientation(float *accel)
 	bool y_is_neg = accel[1] < 0.0f ? true : false;
 	bool z_is_neg = accel[2] < 0.0f ? true : false;
 
-	float x_norm = fabs(accel[0]);
-	float y_norm = fabs(accel[1]);
-	float z_norm = fabs(accel[2]);
+	float x_norm = fabsf(accel[0]);
+	float y_norm = fabsf(accel[1]);
+	float z_norm = fabsf(accel[2]);
 
 	if(x_norm > y_norm && x_norm > z_norm) {
 		/* x norm is the biggest */
@@ -110,15 +110,15 @@ bool detect_accel_motion(float *accel)
 	accel_change[1] = accel[1] - accel_last[1];
 	accel_change[2] = accel[2] - accel_last[2];
 
-	float accel_change_norm = sqrt(accel_change[0] * accel_change[0] +
-	                               accel_change[1] * accel_change[1] +
-	                               accel_change[2] * accel_change[2]);
+	float accel_change_norm = sqrtf(accel_change[0] * accel_change[0] +
+	                                accel_change[1] * accel_change[1] +
+	                                accel_change[2] * accel_change[2]);
 
 	accel_last[0] = accel[0];
 	accel_last[1] = accel[1];
 	accel_last[2] = accel[2];
 
-	if(accel_change_norm > 0.98) {
+	if(accel_change_norm > 0.98f) {
 		return true;
 	} else {
 		return false;
@@ -313,9 +313,9 @@ void mavlink_accel_scale_calibration_handler(void)
 		if(front_finished == true && back_finished == true &&
 		    up_finished == true && down_finished == true &&
 		    left_finished == true && right_finished == true) {
-			float x_scale = (2.0f * 9.81) / (calib_x_p - calib_x_n);
-			float y_scale = (2.0f * 9.81) / (calib_y_p - calib_y_n);
-			float z_scale = (2.0f * 9.81) / (calib_z_p - calib_z_n);
+			float x_scale = (2.0f * 9.81f) / (calib_x_p - calib_x_n);
+			float y_scale = (2.0f * 9.81f) / (calib_y_p - calib_y_n);
+			float z_scale = (2.0f * 9.81f) / (calib_z_p - calib_z_n);
 
 			set_accel_scale_factor(x_scale, y_scale, z_scale);
 
@@ -485,9 +485,9 @@ void shell_accel_calibration_handler(void)
 		if(front_finished == true && back_finished == true &&
 		    up_finished == true && down_finished == true &&
 		    left_finished == true && right_finished == true) {
-			float x_scale = (2.0f * 9.81) / (calib_x_p - calib_x_n);
-			float y_scale = (2.0f * 9.81) / (calib_y_p - calib_y_n);
-			float z_scale = (2.0f * 9.81) / (calib_z_p - calib_z_n);
+			float x_scale = (2.0f * 9.81f) / (calib_x_p - calib_x_n);
+			float y_scale = (2.0f * 9.81f) / (calib_y_p - calib_y_n);
+			float z_scale = (2.0f * 9.81f) / (calib_z_p - calib_z_n);
 
 			set_accel_scale_factor(x_scale, y_scale, z_scale);
 
@@ -503,7 +503,7 @@ void shell_accel_calibration_handler(void)
 			        "x scale: %f\n\r"
 			        "y scale: %f\n\r"
 			        "z scale: %f\n\r",
-			        x_scale, y_scale, z_scale);
+			        (double)x_scale, (double)y_scale, (double)z_scale);
 			shell_puts(s);
 
 			break;
@@ -541,6 +541,6 @@ void shell_accel_calibration_handler(void)
 	        "x offset: %f\n\r"
 	        "y offset: %f\n\r"
 	        "z offset: %f\n\r",
-	        x_offset, y_offset, z_offset);
+	        (double)x_offset, (double)y_offset, (double)z_offset);
 	shell_puts(s);
 }
@@ -71,7 +71,7 @@ void print_compass_data_csv(void)
 	while(1) {
 		get_compass_raw(mag);
 
-		sprintf(s, "%.3f,%.3f,%.3f\n", mag[0], mag[1], mag[2]);
+		sprintf(s, "%.3f,%.3f,%.3f\n", (double)mag[0], (double)mag[1], (double)mag[2]);
 		len = strlen(s);
 
 		uart3_puts((char *)s, len);
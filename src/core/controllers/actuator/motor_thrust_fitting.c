@@ -4,7 +4,7 @@
 /* using polynomial functions for thrust curve line fitting */
 float thrust_max = 845.0f; //[g]
 float coeff_c_to_t[6] = {-2842.8f, 3951.7f, -1925.4f, 1381.3f, 257.37f, -7.0118f};
-float coeff_t_to_c[6] = {1.169e-14, -2.264e-11, 1.697e-08, -6.715e-06, 2.336e-03, 3.082e-02};
+float coeff_t_to_c[6] = {1.169e-14f, -2.264e-11f, 1.697e-08f, -6.715e-06f, 2.336e-03f, 3.082e-02f};
 
 void set_motor_max_thrust(float max)
 {
@@ -54,7 +54,7 @@ float convert_motor_cmd_to_thrust(float percentage)
 	bound_float(&thrust, thrust_max, 0);
 
 	//convert thrust unit from [g.f] to [N]
-	thrust *= 0.00980665;
+	thrust *= 0.00980665f;
 
 	return thrust;
 }
@@ -64,7 +64,7 @@ float convert_motor_cmd_to_thrust(float percentage)
 float convert_motor_thrust_to_cmd(float thrust)
 {
 	//convert thrust unit from [N] to [g.f]
-	thrust *= 101.9716;
+	thrust *= 101.9716f;
 
 	bound_float(&thrust, thrust_max, 0.0f);
 
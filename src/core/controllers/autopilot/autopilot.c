@@ -34,8 +34,8 @@ void autopilot_init(void)
 	autopilot.armed = false;
 	autopilot.motor_locked = false;
 	autopilot.period = 1.0f / 400.0f;
-	autopilot.landing_speed = 0.6; //[m/s]
-	autopilot.takeoff_speed = 0.25; //[m/s]
+	autopilot.landing_speed = 0.6f; //[m/s]
+	autopilot.takeoff_speed = 0.25f; //[m/s]
 	autopilot.takeoff_height = 1.5f;  //[m]
 	autopilot.landing_accept_height_lower = 0.10f; //[m]
 	autopilot.landing_accept_height_upper = 0.12f; //[m]
@@ -163,7 +163,7 @@ void autopilot_get_accel_feedforward(float *accel_ff)
 
 void autopilot_hovering_position_trimming_handler(void)
 {
-	const float dt = 0.0001;
+	const float dt = 0.0001f;
 
 	/* position setpoint increment in ned body-fixed frame  */
 	float x_increment_b = 0.0f;
@@ -250,9 +250,9 @@ void debug_print_waypoint_list(void)
 	int i;
 	for(i = 0; i < autopilot.waypoint_num; i++) {
 		sprintf(s, "wp #%d: x=%.1f, y=%.1f, z=%.1f, heading=%.1f,  stay_time=%.1f, radius=%.1f\n\r",
-		        i, autopilot.waypoints[i].pos[0], autopilot.waypoints[i].pos[1],
-		        autopilot.waypoints[i].pos[2], autopilot.waypoints[i].heading,
-		        autopilot.waypoints[i].halt_time_sec, autopilot.waypoints[i].touch_radius);
+		        i, (double)autopilot.waypoints[i].pos[0], (double)autopilot.waypoints[i].pos[1],
+		        (double)autopilot.waypoints[i].pos[2], (double)autopilot.waypoints[i].heading,
+		        (double)autopilot.waypoints[i].halt_time_sec, (double)autopilot.waypoints[i].touch_radius);
 		uart1_puts(s, strlen(s));
 	}
 }
@@ -270,12 +270,12 @@ void debug_print_waypoint_status(void)
 	sprintf(s, "current waypoint = #%d, x=%.1fm, y=%.1fm, z=%.1fm,"
 	        " heading=%.1f, stay_time=%.1f, radius=%.1fm\n\r",
 	        curr_waypoint_num,
-	        autopilot.waypoints[curr_waypoint_num].pos[0] * 0.01,
-	        autopilot.waypoints[curr_waypoint_num].pos[1] * 0.01,
-	        autopilot.waypoints[curr_waypoint_num].pos[2] * 0.01,
-	        autopilot.waypoints[curr_waypoint_num].heading,
-	        autopilot.waypoints[curr_waypoint_num].halt_time_sec,
-	        autopilot.waypoints[curr_waypoint_num].touch_radius * 0.01);
+	        (double)(autopilot.waypoints[curr_waypoint_num].pos[0] * 0.01f),
+	        (double)(autopilot.waypoints[curr_waypoint_num].pos[1] * 0.01f),
+	        (double)(autopilot.waypoints[curr_waypoint_num].pos[2] * 0.01f),
+	        (double)autopilot.waypoints[curr_waypoint_num].heading,
+	        (double)autopilot.waypoints[curr_waypoint_num].halt_time_sec,
+	        (double)(autopilot.waypoints[curr_waypoint_num].touch_radius * 0.01f));
 	uart1_puts(s, strlen(s));
 	freertos_task_delay(1);
 }
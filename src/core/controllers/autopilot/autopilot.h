@@ -113,7 +113,7 @@ typedef struct {
 	struct waypoint_t waypoints[TRAJ_WP_MAX_NUM]; //waypoint list (enu frame)
 	int curr_waypoint;       //index of current waypoint to track
 	int waypoint_num;        //total waypoint numbers
-	int waypoint_wait_timer; //used for delay between waypoints
+	float waypoint_wait_timer; //used for delay between waypoints
 
 	/* trajectory following datas */
 	struct trajectory_segment_t trajectory_segments[TRAJ_WP_MAX_NUM]; //trajectory list
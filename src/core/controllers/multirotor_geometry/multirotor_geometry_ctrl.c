@@ -5,7 +5,7 @@
 #include "gpio.h"
 #include "sbus_radio.h"
 #include "ahrs.h"
-#include "matrix.h"
+#include "mat3.h"
 #include "motor_thrust_fitting.h"
 #include "motor.h"
 #include "bound.h"
@@ -25,44 +25,19 @@
 #include "attitude_state.h"
 #include "waypoint_following.h"
 #include "fence.h"
+#include "flight_log.h"
 
-#define dt 0.0025 //[s]
+#define dt 0.0025f //[s]
 #define MOTOR_TO_CG_LENGTH 16.25f //[cm]
-#define MOTOR_TO_CG_LENGTH_M (MOTOR_TO_CG_LENGTH * 0.01) //[m]
+#define MOTOR_TO_CG_LENGTH_M (MOTOR_TO_CG_LENGTH * 0.01f) //[m]
 #define COEFFICIENT_YAW 1.0f
 
-MAT_ALLOC(J, 3, 3);
-MAT_ALLOC(R, 3, 3);
-MAT_ALLOC(Rd, 3, 3);
-MAT_ALLOC(Rt, 3, 3);
-MAT_ALLOC(Rtd, 3, 3);
-MAT_ALLOC(RtdR, 3, 3);
-MAT_ALLOC(RtRd, 3, 3);
-MAT_ALLOC(RtRdWd, 3, 3);
-MAT_ALLOC(Re3, 3, 1);
-MAT_ALLOC(W, 3, 1);
-MAT_ALLOC(W_dot, 3, 1);
-MAT_ALLOC(Wd, 3, 1);
-MAT_ALLOC(W_hat, 3, 3);
-MAT_ALLOC(Wd_dot, 3, 1);
-MAT_ALLOC(JW, 3, 1);
-MAT_ALLOC(WJW, 3, 1);
-MAT_ALLOC(JWdot, 3, 1);
-MAT_ALLOC(M, 3, 1);
-MAT_ALLOC(eR_mat, 3, 3);
-MAT_ALLOC(eR, 3, 1);
-MAT_ALLOC(eW, 3, 1);
-MAT_ALLOC(WRt, 3, 3);
-MAT_ALLOC(WRtRd, 3, 3);
-MAT_ALLOC(WRtRdWd, 3, 1);
-MAT_ALLOC(RtRdWddot, 3, 1);
-MAT_ALLOC(WRtRdWd_RtRdWddot, 3, 1);
-MAT_ALLOC(J_WRtRdWd_RtRdWddot, 3, 1);
-MAT_ALLOC(inertia_effect, 3, 1);
-MAT_ALLOC(kxex_kvev_mge3_mxd_dot_dot, 3, 1);
-MAT_ALLOC(b1d, 3, 1);
-MAT_ALLOC(b2d, 3, 1);
-MAT_ALLOC(b3d, 3, 1);
+mat3_t J;
+mat3_t R;  //body to inertial frame
+mat3_t Rd; //desired attitude
+vec3_t W_dot;
+vec3_t eR, eW;
+vec3_t inertia_effect;
 
 float pos_error[3];
 float vel_error[3];
@@ -97,39 +72,6 @@ void geometry_ctrl_init(void)
 	float geo_fence_origin[3] = {0.0f, 0.0f, 0.0f};
 	autopilot_set_enu_rectangular_fence(geo_fence_origin, 2.5f, 1.3f, 3.0f);
 
-	MAT_INIT(J, 3, 3);
-	MAT_INIT(R, 3, 3);
-	MAT_INIT(Rd, 3, 3);
-	MAT_INIT(Rt, 3, 3);
-	MAT_INIT(Rtd, 3, 3);
-	MAT_INIT(RtdR, 3, 3);
-	MAT_INIT(RtRd, 3, 3);
-	MAT_INIT(RtRdWd, 3, 3);
-	MAT_INIT(Re3, 3, 1);
-	MAT_INIT(W, 3, 1);
-	MAT_INIT(W_dot, 3, 1);
-	MAT_INIT(Wd, 3, 1);
-	MAT_INIT(W_hat, 3, 3);
-	MAT_INIT(Wd_dot, 3, 1);
-	MAT_INIT(JW, 3, 1);
-	MAT_INIT(WJW, 3, 1);
-	MAT_INIT(JWdot, 3, 1);
-	MAT_INIT(M, 3, 1);
-	MAT_INIT(eR_mat, 3, 3);
-	MAT_INIT(eR, 3, 1);
-	MAT_INIT(eW, 3, 1);
-	MAT_INIT(WRt, 3, 3);
-	MAT_INIT(WRtRd, 3, 3);
-	MAT_INIT(WRtRdWd, 3, 1);
-	MAT_INIT(RtRdWddot, 3, 1);
-	MAT_INIT(WRtRdWd_RtRdWddot, 3, 1);
-	MAT_INIT(J_WRtRdWd_RtRdWddot, 3, 1);
-	MAT_INIT(inertia_effect, 3, 1);
-	MAT_INIT(kxex_kvev_mge3_mxd_dot_dot, 3, 1);
-	MAT_INIT(b1d, 3, 1);
-	MAT_INIT(b2d, 3, 1);
-	MAT_INIT(b3d, 3, 1);
-
 	/* modify local variables when user change them via ground station */
 	set_sys_param_update_var_addr(MR_GEO_GAIN_ROLL_P, &krx);
 	set_sys_param_update_var_addr(MR_GEO_GAIN_ROLL_D, &kwx);
@@ -148,9 +90,9 @@ void geometry_ctrl_init(void)
 	set_sys_param_update_var_addr(MR_GEO_GAIN_POS_Y_I, &k_tracking_i_gain[1]);
 	set_sys_param_update_var_addr(MR_GEO_GAIN_POS_Z_I, &k_tracking_i_gain[2]);
 	set_sys_param_update_var_addr(MR_GEO_UAV_MASS, &uav_mass);
-	set_sys_param_update_var_addr(MR_GEO_INERTIA_JXX, &mat_data(J)[0*3 + 0]);
-	set_sys_param_update_var_addr(MR_GEO_INERTIA_JYY, &mat_data(J)[1*3 + 1]);
-	set_sys_param_update_var_addr(MR_GEO_INERTIA_JZZ, &mat_data(J)[2*3 + 2]);
+	set_sys_param_update_var_addr(MR_GEO_INERTIA_JXX, &MAT3_AT(&J, 0, 0));
+	set_sys_param_update_var_addr(MR_GEO_INERTIA_JYY, &MAT3_AT(&J, 1, 1));
+	set_sys_param_update_var_addr(MR_GEO_INERTIA_JZZ, &MAT3_AT(&J, 2, 2));
 	set_sys_param_update_var_addr(PWM_TO_THRUST_C1, &coeff_cmd_to_thrust[0]);
 	set_sys_param_update_var_addr(PWM_TO_THRUST_C2, &coeff_cmd_to_thrust[1]);
 	set_sys_param_update_var_addr(PWM_TO_THRUST_C3, &coeff_cmd_to_thrust[2]);
@@ -183,9 +125,9 @@ void geometry_ctrl_init(void)
 	get_sys_param_float(MR_GEO_GAIN_POS_Y_I, &k_tracking_i_gain[1]);
 	get_sys_param_float(MR_GEO_GAIN_POS_Z_I, &k_tracking_i_gain[2]);
 	get_sys_param_float(MR_GEO_UAV_MASS, &uav_mass);
-	get_sys_param_float(MR_GEO_INERTIA_JXX, &mat_data(J)[0*3 + 0]);
-	get_sys_param_float(MR_GEO_INERTIA_JYY, &mat_data(J)[1*3 + 1]);
-	get_sys_param_float(MR_GEO_INERTIA_JZZ, &mat_data(J)[2*3 + 2]);
+	get_sys_param_float(MR_GEO_INERTIA_JXX, &MAT3_AT(&J, 0, 0));
+	get_sys_param_float(MR_GEO_INERTIA_JYY, &MAT3_AT(&J, 1, 1));
+	get_sys_param_float(MR_GEO_INERTIA_JZZ, &MAT3_AT(&J, 2, 2));
 	get_sys_param_float(PWM_TO_THRUST_C1, &coeff_cmd_to_thrust[0]);
 	get_sys_param_float(PWM_TO_THRUST_C2, &coeff_cmd_to_thrust[1]);
 	get_sys_param_float(PWM_TO_THRUST_C3, &coeff_cmd_to_thrust[2]);
@@ -219,24 +161,27 @@ void estimate_uav_dynamics(float *gyro, float *moments, float *m_rot_frame)
 	angular_vel_last[1] = gyro[1];
 	angular_vel_last[2] = gyro[2];
 
-	lpf_first_order(angular_accel[0], &mat_data(W_dot)[0], 0.01);
-	lpf_first_order(angular_accel[1], &mat_data(W_dot)[1], 0.01);
-	lpf_first_order(angular_accel[2], &mat_data(W_dot)[2], 0.01);
+	lpf_first_order(angular_accel[0], &W_dot.v[0], 0.01f);
+	lpf_first_order(angular_accel[1], &W_dot.v[1], 0.01f);
+	lpf_first_order(angular_accel[2], &W_dot.v[2], 0.01f);
+
+	vec3_t W, JW, WJW, JWdot, M;
+	vec3_load(&W, gyro);
 
 	//J* W_dot
-	MAT_MULT(&J, &W_dot, &JWdot);
+	mat3_mul_vec3(&J, &W_dot, &JWdot);
 	//W x JW
-	MAT_MULT(&J, &W, &JW);
-	cross_product_3x1(mat_data(W), mat_data(JW), mat_data(WJW));
+	mat3_mul_vec3(&J, &W, &JW);
+	vec3_cross(&W, &JW, &WJW);
 	//M = J * W_dot + W X (J * W)
-	MAT_ADD(&JWdot, &WJW, &M);
-
-	m_rot_frame[0] = mat_data(JWdot)[0];
-	m_rot_frame[1] = mat_data(JWdot)[1];
-	m_rot_frame[2] = mat_data(JWdot)[2];
-	moments[0] = mat_data(M)[0];
-	moments[1] = mat_data(M)[1];
-	moments[2] = mat_data(M)[2];
+	vec3_add(&JWdot, &WJW, &M);
+
+	m_rot_frame[0] = JWdot.v[0];
+	m_rot_frame[1] = JWdot.v[1];
+	m_rot_frame[2] = JWdot.v[2];
+	moments[0] = M.v[0];
+	moments[1] = M.v[1];
+	moments[2] = M.v[2];
 }
 
 void reset_geometry_tracking_error_integral(void)
@@ -246,24 +191,63 @@ void reset_geometry_tracking_error_integral(void)
 	tracking_error_integral[2] = 0.0f;
 }
 
+/* calculate eR, eW and the inertia feedfoward term from the current attitude
+ * R and the desired attitude Rd */
+static void geometry_attitude_error(vec3_t *W, vec3_t *Wd, vec3_t *Wd_dot)
+{
+	/* Rd^T * R, the R^T * Rd term is its transpose */
+	mat3_t RtdR;
+	mat3_trans_mul(&Rd, &R, &RtdR);
+
+	/* calculate attitude error eR = 1/2 * vee(Rd^T * R - R^T * Rd) */
+	mat3_vee_skew(&RtdR, &eR);
+	vec3_scale(&eR, 0.5f, &eR);
+
+	/* calculate attitude rate error eW = W - R^T * Rd * Wd */
+	vec3_t RtRdWd;
+	mat3_trans_mul_vec3(&RtdR, Wd, &RtRdWd);
+	vec3_sub(W, &RtRdWd, &eW);
+
+	/* calculate the inertia feedfoward term */
+	//W x JW
+	vec3_t JW, WJW;
+	mat3_mul_vec3(&J, W, &JW);
+	vec3_cross(W, &JW, &WJW);
+	inertia_effect = WJW;
+
+#if 0   /* inertia feedfoward term for motion planning (trajectory is known) */
+	/* calculate inertia effect (trajectory is defined, Wd and Wd_dot are not zero) */
+	//W * R^T * Rd * Wd
+	vec3_t WRtRdWd;
+	vec3_cross(W, &RtRdWd, &WRtRdWd);
+	//R^T * Rd * Wd_dot
+	vec3_t RtRdWddot;
+	mat3_trans_mul_vec3(&RtdR, Wd_dot, &RtRdWddot);
+	//(W * R^T * Rd * Wd) - (R^T * Rd * Wd_dot)
+	vec3_t WRtRdWd_RtRdWddot;
+	vec3_sub(&WRtRdWd, &RtRdWddot, &WRtRdWd_RtRdWddot);
+	//J*[(W * R^T * Rd * Wd) - (R^T * Rd * Wd_dot)]
+	vec3_t J_WRtRdWd_RtRdWddot;
+	mat3_mul_vec3(&J, &WRtRdWd_RtRdWddot, &J_WRtRdWd_RtRdWddot);
+	//inertia effect = (W x JW) - J*[(W * R^T * Rd * Wd) - (R^T * Rd * Wd_dot)]
+	vec3_sub(&WJW, &J_WRtRdWd_RtRdWddot, &inertia_effect);
+#endif
+}
+
 void geometry_manual_ctrl(euler_t *rc, float *attitude_q, float *gyro, float *output_moments,
                           bool heading_present)
 {
 	/* convert radio command (euler angle) to rotation matrix */
-	euler_to_rotation_matrix(rc, mat_data(Rd), mat_data(Rtd));
+	float Rtd[9];
+	euler_to_rotation_matrix(rc, Rd.m, Rtd);
 
 	/* W (angular velocity) */
-	mat_data(W)[0] = gyro[0];
-	mat_data(W)[1] = gyro[1];
-	mat_data(W)[2] = gyro[2];
+	vec3_t W;
+	vec3_load(&W, gyro);
 
 	/* set Wd and Wd_dot to 0 since there is no predefined trajectory */
-	mat_data(Wd)[0] = 0.0f;
-	mat_data(Wd)[1] = 0.0f;
-	mat_data(Wd)[2] = 0.0f;
-	mat_data(Wd_dot)[0] = 0.0f;
-	mat_data(Wd_dot)[1] = 0.0f;
-	mat_data(Wd_dot)[2] = 0.0f;
+	vec3_t Wd = {{0.0f, 0.0f, 0.0f}};
+	vec3_t Wd_dot = {{0.0f, 0.0f, 0.0f}};
 
 	float _krz, _kwz; //switch between full heading control and yaw rate control
 
@@ -272,57 +256,18 @@ void geometry_manual_ctrl(euler_t *rc, float *attitude_q, float *gyro, float *ou
 		/* yaw rate control only */
 		_krz = 0.0f;
 		_kwz = yaw_rate_ctrl_gain;
-		mat_data(Wd)[2] = rc->yaw; //set yaw rate desired value
+		Wd.v[2] = rc->yaw; //set yaw rate desired value
 	} else {
 		_krz = krz;
 		_kwz = kwz;
 	}
 
-	/* calculate attitude error eR */
-	MAT_MULT(&Rtd, &R, &RtdR);
-	MAT_MULT(&Rt, &Rd, &RtRd);
-	MAT_SUB(&RtdR, &RtRd, &eR_mat);
-	vee_map_3x3(mat_data(eR_mat), mat_data(eR));
-	mat_data(eR)[0] *= 0.5f;
-	mat_data(eR)[1] *= 0.5f;
-	mat_data(eR)[2] *= 0.5f;
-
-	/* calculate attitude rate error eW */
-	//MAT_MULT(&Rt, &Rd, &RtRd); //the term is duplicated
-	MAT_MULT(&RtRd, &Wd, &RtRdWd);
-	MAT_SUB(&W, &RtRdWd, &eW);
-
-	/* calculate the inertia feedfoward term */
-	//W x JW
-	MAT_MULT(&J, &W, &JW);
-	cross_product_3x1(mat_data(W), mat_data(JW), mat_data(WJW));
-	mat_data(inertia_effect)[0] = mat_data(WJW)[0];
-	mat_data(inertia_effect)[1] = mat_data(WJW)[1];
-	mat_data(inertia_effect)[2] = mat_data(WJW)[2];
-
-#if 0   /* inertia feedfoward term for motion planning (trajectory is known) */
-	/* calculate inertia effect (trajectory is defined, Wd and Wd_dot are not zero) */
-	//W * R^T * Rd * Wd
-	hat_map_3x3(mat_data(W), mat_data(W_hat));
-	MAT_MULT(&W_hat, &Rt, &WRt);
-	MAT_MULT(&WRt, &Rd, &WRtRd);
-	MAT_MULT(&WRtRd, &Wd, &WRtRdWd);
-	//R^T * Rd * Wd_dot
-	//MAT_MULT(&Rt, &Rd, &RtRd); //the term is duplicated
-	MAT_MULT(&RtRd, &Wd_dot, &RtRdWddot);
-	//(W * R^T * Rd * Wd) - (R^T * Rd * Wd_dot)
-	MAT_SUB(&WRtRdWd, &RtRdWddot, &WRtRdWd_RtRdWddot);
-	//J*[(W * R^T * Rd * Wd) - (R^T * Rd * Wd_dot)]
-	MAT_MULT(&J, &WRtRdWd_RtRdWddot, &J_WRtRdWd_RtRdWddot);
-	//inertia effect = (W x JW) - J*[(W * R^T * Rd * Wd) - (R^T * Rd * Wd_dot)]
-	MAT_SUB(&WJW, &J_WRtRdWd_RtRdWddot, &inertia_effect);
-
-#endif
+	geometry_attitude_error(&W, &Wd, &Wd_dot);
 
 	/* control input M1, M2, M3 */
-	output_moments[0] = -krx*mat_data(eR)[0] -kwx*mat_data(eW)[0] + mat_data(inertia_effect)[0];
-	output_moments[1] = -kry*mat_data(eR)[1] -kwy*mat_data(eW)[1] + mat_data(inertia_effect)[1];
-	output_moments[2] = -_krz*mat_data(eR)[2] -_kwz*mat_data(eW)[2] + mat_data(inertia_effect)[2];
+	output_moments[0] = -krx*eR.v[0] -kwx*eW.v[0] + inertia_effect.v[0];
+	output_moments[1] = -kry*eR.v[1] -kwy*eW.v[1] + inertia_effect.v[1];
+	output_moments[2] = -_krz*eR.v[2] -_kwz*eW.v[2] + inertia_effect.v[2];
 }
 
 void geometry_tracking_ctrl(euler_t *rc, float *attitude_q, float *gyro,
@@ -359,112 +304,60 @@ void geometry_tracking_ctrl(euler_t *rc, float *attitude_q, float *gyro,
 	bound_float(&tracking_error_integral[1], 150, -150);
 	bound_float(&tracking_error_integral[2], 50, -50);
 
-	mat_data(kxex_kvev_mge3_mxd_dot_dot)[0] = -kpx*pos_error[0] - kvx*vel_error[0] +
-	                force_ff_ned[0] - tracking_error_integral[0];
-	mat_data(kxex_kvev_mge3_mxd_dot_dot)[1] = -kpy*pos_error[1] - kvy*vel_error[1] +
-	                force_ff_ned[1] - tracking_error_integral[1];
-	mat_data(kxex_kvev_mge3_mxd_dot_dot)[2] = -kpz*pos_error[2] - kvz*vel_error[2] +
-	                force_ff_ned[2] - tracking_error_integral[2] -
-	                uav_mass * 9.81;
+	vec3_t kxex_kvev_mge3_mxd_dot_dot;
+	kxex_kvev_mge3_mxd_dot_dot.v[0] = -kpx*pos_error[0] - kvx*vel_error[0] +
+	                                  force_ff_ned[0] - tracking_error_integral[0];
+	kxex_kvev_mge3_mxd_dot_dot.v[1] = -kpy*pos_error[1] - kvy*vel_error[1] +
+	                                  force_ff_ned[1] - tracking_error_integral[1];
+	kxex_kvev_mge3_mxd_dot_dot.v[2] = -kpz*pos_error[2] - kvz*vel_error[2] +
+	                                  force_ff_ned[2] - tracking_error_integral[2] -
+	                                  uav_mass * 9.81f;
 
 	/* calculate the denominator of b3d */
 	float b3d_denominator; //caution: this term should not be 0
-	norm_3x1(mat_data(kxex_kvev_mge3_mxd_dot_dot), &b3d_denominator);
-	b3d_denominator = -1.0f / b3d_denominator;
+	b3d_denominator = -1.0f / vec3_norm(&kxex_kvev_mge3_mxd_dot_dot);
 
 	if(manual_flight == true) {
 		/* enable altitude control only, control roll and pitch manually */
 		//convert radio command (euler angle) to rotation matrix
-		euler_to_rotation_matrix(rc, mat_data(Rd), mat_data(Rtd));
+		float Rtd[9];
+		euler_to_rotation_matrix(rc, Rd.m, Rtd);
 	} else {
 		/* enable tracking control for x and y axis */
+		vec3_t b1d, b2d, b3d;
 		//b1d
-		mat_data(b1d)[0] = arm_cos_f32(rc->yaw);
-		mat_data(b1d)[1] = arm_sin_f32(rc->yaw);
-		mat_data(b1d)[2] = 0.0f;
+		vec3_set(&b1d, arm_cos_f32(rc->yaw), arm_sin_f32(rc->yaw), 0.0f);
 		//b3d = -kxex_kvev_mge3_mxd_dot_dot / ||kxex_kvev_mge3_mxd_dot_dot||
-		mat_data(b3d)[0] = mat_data(kxex_kvev_mge3_mxd_dot_dot)[0] * b3d_denominator;
-		mat_data(b3d)[1] = mat_data(kxex_kvev_mge3_mxd_dot_dot)[1] * b3d_denominator;
-		mat_data(b3d)[2] = mat_data(kxex_kvev_mge3_mxd_dot_dot)[2] * b3d_denominator;
+		vec3_scale(&kxex_kvev_mge3_mxd_dot_dot, b3d_denominator, &b3d);
 		//b2d = b3d X b1d / ||b3d X b1d||
-		cross_product_3x1(mat_data(b3d), mat_data(b1d), mat_data(b2d));
-		normalize_3x1(mat_data(b2d));
+		vec3_cross(&b3d, &b1d, &b2d);
+		vec3_normalize(&b2d);
 		/* proj[b1d] = b2d X b3d */
-		cross_product_3x1(mat_data(b2d), mat_data(b3d), mat_data(b1d));
+		vec3_cross(&b2d, &b3d, &b1d);
 
 		//Rd = [b1d; b3d X b1d; b3d]
-		mat_data(Rd)[0*3 + 0] = mat_data(b1d)[0];
-		mat_data(Rd)[1*3 + 0] = mat_data(b1d)[1];
-		mat_data(Rd)[2*3 + 0] = mat_data(b1d)[2];
-		mat_data(Rd)[0*3 + 1] = mat_data(b2d)[0];
-		mat_data(Rd)[1*3 + 1] = mat_data(b2d)[1];
-		mat_data(Rd)[2*3 + 1] = mat_data(b2d)[2];
-		mat_data(Rd)[0*3 + 2] = mat_data(b3d)[0];
-		mat_data(Rd)[1*3 + 2] = mat_data(b3d)[1];
-		mat_data(Rd)[2*3 + 2] = mat_data(b3d)[2];
-
-		//transpose(Rd)
-		mat_data(Rtd)[0*3 + 0] = mat_data(Rd)[0*3 + 0];
-		mat_data(Rtd)[1*3 + 0] = mat_data(Rd)[0*3 + 1];
-		mat_data(Rtd)[2*3 + 0] = mat_data(Rd)[0*3 + 2];
-		mat_data(Rtd)[0*3 + 1] = mat_data(Rd)[1*3 + 0];
-		mat_data(Rtd)[1*3 + 1] = mat_data(Rd)[1*3 + 1];
-		mat_data(Rtd)[2*3 + 1] = mat_data(Rd)[1*3 + 2];
-		mat_data(Rtd)[0*3 + 2] = mat_data(Rd)[2*3 + 0];
-		mat_data(Rtd)[1*3 + 2] = mat_data(Rd)[2*3 + 1];
-		mat_data(Rtd)[2*3 + 2] = mat_data(Rd)[2*3 + 2];
+		mat3_from_cols(&Rd, &b1d, &b2d, &b3d);
 	}
 
 	/* R * e3 */
-	mat_data(Re3)[0] = mat_data(R)[0*3 + 2];
-	mat_data(Re3)[1] = mat_data(R)[1*3 + 2];
-	mat_data(Re3)[2] = mat_data(R)[2*3 + 2];
+	vec3_t Re3 = {{MAT3_AT(&R, 0, 2), MAT3_AT(&R, 1, 2), MAT3_AT(&R, 2, 2)}};
 	/* f = -(-kx * ex - kv * ev - mge3 + m * x_d_dot_dot) . (R * e3) */
-	float neg_kxex_kvev_mge3_mxd_dot_dot[3];
-	neg_kxex_kvev_mge3_mxd_dot_dot[0] = -mat_data(kxex_kvev_mge3_mxd_dot_dot)[0];
-	neg_kxex_kvev_mge3_mxd_dot_dot[1] = -mat_data(kxex_kvev_mge3_mxd_dot_dot)[1];
-	neg_kxex_kvev_mge3_mxd_dot_dot[2] = -mat_data(kxex_kvev_mge3_mxd_dot_dot)[2];
-	arm_dot_prod_f32(neg_kxex_kvev_mge3_mxd_dot_dot, mat_data(Re3), 3, output_force);
+	*output_force = -vec3_dot(&kxex_kvev_mge3_mxd_dot_dot, &Re3);
 
 	/* W (angular velocity) */
-	mat_data(W)[0] = gyro[0];
-	mat_data(W)[1] = gyro[1];
-	mat_data(W)[2] = gyro[2];
+	vec3_t W;
+	vec3_load(&W, gyro);
 
 	/* set Wd and Wd_dot to 0 since there is no predefined trajectory */
-	mat_data(Wd)[0] = 0.0f;
-	mat_data(Wd)[1] = 0.0f;
-	mat_data(Wd)[2] = 0.0f;
-	mat_data(Wd_dot)[0] = 0.0f;
-	mat_data(Wd_dot)[1] = 0.0f;
-	mat_data(Wd_dot)[2] = 0.0f;
-
-	/* calculate attitude error eR */
-	MAT_MULT(&Rtd, &R, &RtdR);
-	MAT_MULT(&Rt, &Rd, &RtRd);
-	MAT_SUB(&RtdR, &RtRd, &eR_mat);
-	vee_map_3x3(mat_data(eR_mat), mat_data(eR));
-	mat_data(eR)[0] *= 0.5f;
-	mat_data(eR)[1] *= 0.5f;
-	mat_data(eR)[2] *= 0.5f;
-
-	/* calculate attitude rate error eW */
-	//MAT_MULT(&Rt, &Rd, &RtRd); //the term is duplicated
-	MAT_MULT(&RtRd, &Wd, &RtRdWd);
-	MAT_SUB(&W, &RtRdWd, &eW);
+	vec3_t Wd = {{0.0f, 0.0f, 0.0f}};
+	vec3_t Wd_dot = {{0.0f, 0.0f, 0.0f}};
 
-	/* calculate the inertia feedfoward term */
-	//W x JW
-	MAT_MULT(&J, &W, &JW);
-	cross_product_3x1(mat_data(W), mat_data(JW), mat_data(WJW));
-	mat_data(inertia_effect)[0] = mat_data(WJW)[0];
-	mat_data(inertia_effect)[1] = mat_data(WJW)[1];
-	mat_data(inertia_effect)[2] = mat_data(WJW)[2];
+	geometry_attitude_error(&W, &Wd, &Wd_dot);
 
 	/* control input M1, M2, M3 */
-	output_moments[0] = -krx*mat_data(eR)[0] -kwx*mat_data(eW)[0] + mat_data(inertia_effect)[0];
-	output_moments[1] = -kry*mat_data(eR)[1] -kwy*mat_data(eW)[1] + mat_data(inertia_effect)[1];
-	output_moments[2] = -krz*mat_data(eR)[2] -kwz*mat_data(eW)[2] + mat_data(inertia_effect)[2];
+	output_moments[0] = -krx*eR.v[0] -kwx*eW.v[0] + inertia_effect.v[0];
+	output_moments[1] = -kry*eR.v[1] -kwy*eW.v[1] + inertia_effect.v[1];
+	output_moments[2] = -krz*eR.v[2] -kwz*eW.v[2] + inertia_effect.v[2];
 }
 
 #define l_div_4 (0.25f * (1.0f / MOTOR_TO_CG_LENGTH_M))
@@ -472,7 +365,7 @@ void geometry_tracking_ctrl(euler_t *rc, float *attitude_q, float *gyro,
 void mr_geometry_ctrl_thrust_allocation(float *moment, float total_force)
 {
 	/* quadrotor thrust allocation */
-	float distributed_force = total_force *= 0.25; //split force to 4 motors
+	float distributed_force = total_force *= 0.25f; //split force to 4 motors
 	float motor_force[4];
 	motor_force[0] = -l_div_4 * moment[0] + l_div_4 * moment[1] +
 	                 -b_div_4 * moment[2] + distributed_force;
@@ -556,8 +449,9 @@ void multirotor_geometry_control(radio_t *rc, float *desired_heading)
 	get_attitude_euler_angles(&attitude_roll, &attitude_pitch, &attitude_yaw);
 
 	/* get direction consine matrix of current attitude */
-	get_rotation_matrix_b2i(&mat_data(R));
-	get_rotation_matrix_i2b(&mat_data(Rt));
+	float *R_b2i;
+	get_rotation_matrix_b2i(&R_b2i);
+	mat3_load(&R, R_b2i);
 
 	/* prepare position and velocity data */
 	float curr_pos_enu[3] = {0.0f}, curr_pos_ned[3] = {0.0f};
@@ -612,7 +506,7 @@ void multirotor_geometry_control(radio_t *rc, float *desired_heading)
 		                     heading_available);
 
 		/* generate total thrust for quadrotor (open-loop) */
-		control_force = 4.0f * convert_motor_cmd_to_thrust(rc->throttle * 0.01 /* [%] */);
+		control_force = 4.0f * convert_motor_cmd_to_thrust(rc->throttle * 0.01f /* [%] */);
 	}
 
 	if(rc->safety == true) {
@@ -644,29 +538,35 @@ void multirotor_geometry_control(radio_t *rc, float *desired_heading)
 	} else {
 		motor_halt();
 	}
+
+	flight_log_controller_t ctrl_log = {
+		.moments = {control_moments[0], control_moments[1], control_moments[2]},
+		.force = control_force
+	};
+	flight_log_write(FLIGHT_LOG_CONTROLLER, &ctrl_log, sizeof(ctrl_log));
 }
 
 void send_geometry_moment_ctrl_debug(debug_msg_t *payload)
 {
-	float roll_error = rad_to_deg(mat_data(eR)[0]);
-	float pitch_error = rad_to_deg(mat_data(eR)[1]);
-	float yaw_error = rad_to_deg(mat_data(eR)[2]);
+	float roll_error = rad_to_deg(eR.v[0]);
+	float pitch_error = rad_to_deg(eR.v[1]);
+	float yaw_error = rad_to_deg(eR.v[2]);
 
-	float wx_error = rad_to_deg(mat_data(eW)[0]);
-	float wy_error = rad_to_deg(mat_data(eW)[1]);
-	float wz_error = rad_to_deg(mat_data(eW)[2]);
+	float wx_error = rad_to_deg(eW.v[0]);
+	float wy_error = rad_to_deg(eW.v[1]);
+	float wz_error = rad_to_deg(eW.v[2]);
 
 	float geometry_ctrl_feedback_moments[3];
 	float geometry_ctrl_feedfoward_moments[3];
 
 	/* calculate the feedback moment and convert the unit from [gram force * m] to [newton * m] */
-	geometry_ctrl_feedback_moments[0] = (-krx*mat_data(eR)[0] -kwx*mat_data(eW)[0]);
-	geometry_ctrl_feedback_moments[1] = (-kry*mat_data(eR)[1] -kwy*mat_data(eW)[1]);
-	geometry_ctrl_feedback_moments[2] = (-krz*mat_data(eR)[2] -kwz*mat_data(eW)[2]);
+	geometry_ctrl_feedback_moments[0] = (-krx*eR.v[0] -kwx*eW.v[0]);
+	geometry_ctrl_feedback_moments[1] = (-kry*eR.v[1] -kwy*eW.v[1]);
+	geometry_ctrl_feedback_moments[2] = (-krz*eR.v[2] -kwz*eW.v[2]);
 
-	geometry_ctrl_feedfoward_moments[0] = mat_data(inertia_effect)[0];
-	geometry_ctrl_feedfoward_moments[1] = mat_data(inertia_effect)[1];
-	geometry_ctrl_feedfoward_moments[2] = mat_data(inertia_effect)[2];
+	geometry_ctrl_feedfoward_moments[0] = inertia_effect.v[0];
+	geometry_ctrl_feedfoward_moments[1] = inertia_effect.v[1];
+	geometry_ctrl_feedfoward_moments[2] = inertia_effect.v[2];
 
 	pack_debug_debug_message_header(payload, MESSAGE_ID_GEOMETRY_MOMENT_CTRL);
 	pack_debug_debug_message_float(&roll_error, payload);
@@ -8,6 +8,14 @@
 void geometry_ctrl_init(void);
 void multirotor_geometry_control(radio_t *rc, float *desired_heading);
 
+void estimate_uav_dynamics(float *gyro, float *moments, float *m_rot_frame);
+void geometry_manual_ctrl(euler_t *rc, float *attitude_q, float *gyro, float *output_moments,
+                          bool heading_present);
+void geometry_tracking_ctrl(euler_t *rc, float *attitude_q, float *gyro,
+                            float *pos_des_enu, float *vel_des_enu, float *accel_ff_enu,
+                            float *curr_pos_ned, float *curr_vel_ned, float *output_moments,
+                            float *output_force, bool manual_flight);
+
 void send_geometry_moment_ctrl_debug(debug_msg_t *payload);
 void send_geometry_tracking_ctrl_debug(debug_msg_t *payload);
 void send_uav_dynamics_debug(debug_msg_t *payload);
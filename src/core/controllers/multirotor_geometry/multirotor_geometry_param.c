@@ -36,12 +36,12 @@ void init_multirotor_geometry_param_list(void)
 	init_sys_param_float(PWM_TO_THRUST_C4, "PWM_TO_THRUST_C4", 1381.3f);
 	init_sys_param_float(PWM_TO_THRUST_C5, "PWM_TO_THRUST_C5", 257.37f);
 	init_sys_param_float(PWM_TO_THRUST_C6, "PWM_TO_THRUST_C6", -7.0118f);
-	init_sys_param_float(THRUST_TO_PWM_C1, "THRUST_TO_PWM_C1", 1.169e-14);
-	init_sys_param_float(THRUST_TO_PWM_C2, "THRUST_TO_PWM_C2", -2.264e-11);
-	init_sys_param_float(THRUST_TO_PWM_C3, "THRUST_TO_PWM_C3", 1.697e-08);
-	init_sys_param_float(THRUST_TO_PWM_C4, "THRUST_TO_PWM_C4", -6.715e-06);
-	init_sys_param_float(THRUST_TO_PWM_C5, "THRUST_TO_PWM_C5", 2.336e-03);
-	init_sys_param_float(THRUST_TO_PWM_C6, "THRUST_TO_PWM_C6", 3.082e-02);
+	init_sys_param_float(THRUST_TO_PWM_C1, "THRUST_TO_PWM_C1", 1.169e-14f);
+	init_sys_param_float(THRUST_TO_PWM_C2, "THRUST_TO_PWM_C2", -2.264e-11f);
+	init_sys_param_float(THRUST_TO_PWM_C3, "THRUST_TO_PWM_C3", 1.697e-08f);
+	init_sys_param_float(THRUST_TO_PWM_C4, "THRUST_TO_PWM_C4", -6.715e-06f);
+	init_sys_param_float(THRUST_TO_PWM_C5, "THRUST_TO_PWM_C5", 2.336e-03f);
+	init_sys_param_float(THRUST_TO_PWM_C6, "THRUST_TO_PWM_C6", 3.082e-02f);
 	init_sys_param_float(THRUST_MAX, "THRUST_MAX", 845.0f);
 
 	load_param_list_from_flash();
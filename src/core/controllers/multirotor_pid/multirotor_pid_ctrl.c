@@ -116,7 +116,7 @@ void attitude_pid_control(pid_control_t *pid, float ahrs_attitude,
 {
 	//error = reference (setpoint) - measurement
 	pid->error_current = setpoint_attitude - ahrs_attitude;
-	pid->error_integral += (pid->error_current * pid->ki * 0.0025);
+	pid->error_integral += (pid->error_current * pid->ki * 0.0025f);
 	bound_float(&pid->error_integral, 10.0f, -10.0f);
 	pid->error_derivative = -angular_velocity; //error_derivative = 0 (setpoint) - measurement_derivative
 	pid->p_final = pid->kp * pid->error_current;
@@ -147,12 +147,12 @@ void yaw_pd_control(pid_control_t *pid, float desired_heading, float ahrs_yaw, f
 	float compl_angle;
 	if(pid->error_current < 0.0f) {
 		compl_angle = pid->error_current + 360.0f;
-		if(fabs(pid->error_current) > compl_angle) {
+		if(fabsf(pid->error_current) > compl_angle) {
 			pid->error_current = compl_angle;
 		}
 	} else if(pid->error_current > 0.0f) {
 		compl_angle = pid->error_current - 360.0f;
-		if(fabs(compl_angle) < pid->error_current) {
+		if(fabsf(compl_angle) < pid->error_current) {
 			pid->error_current = compl_angle;
 		}
 	}
@@ -178,7 +178,7 @@ void altitude_control(float alt, float alt_vel, pid_control_t *alt_vel_pid, pid_
 
 	/* altitude control (control output becomes setpoint of velocity controller) */
 	alt_pid->error_current = alt_pid->setpoint - alt;
-	alt_pid->error_integral += (alt_pid->error_current * alt_pid->ki * 0.0025);
+	alt_pid->error_integral += (alt_pid->error_current * alt_pid->ki * 0.0025f);
 	alt_pid->p_final = alt_pid->kp * alt_pid->error_current;
 	alt_pid->i_final = alt_pid->error_integral;
 	alt_pid->output = alt_pid->p_final + alt_pid->i_final;
@@ -211,7 +211,7 @@ void position_2d_control(float current_pos, float current_vel, pid_control_t *po
 {
 	pos_pid->error_current = pos_pid->setpoint - current_pos;
 	pos_pid->p_final = pos_pid->kp * pos_pid->error_current;
-	pos_pid->error_integral += (pos_pid->error_current * pos_pid->ki * 0.0025);
+	pos_pid->error_integral += (pos_pid->error_current * pos_pid->ki * 0.0025f);
 	pos_pid->error_derivative = -current_vel;
 	pos_pid->d_final = pos_pid->kd * pos_pid->error_derivative;
 	bound_float(&pos_pid->error_integral, pos_pid->output_max, pos_pid->output_min);
@@ -391,7 +391,7 @@ void multirotor_pid_control(radio_t *rc, float *desired_heading)
 
 	//used if heading sensor is not present
 	yaw_rate_p_control(&pid_yaw_rate, -rc->yaw, gyro_lpf[2]);
-	yaw_pd_control(&pid_yaw, *desired_heading, attitude_yaw, gyro_lpf[2], 0.0025);
+	yaw_pd_control(&pid_yaw, *desired_heading, attitude_yaw, gyro_lpf[2], 0.0025f);
 
 	/* check if heading sensor is present */
 	float yaw_ctrl_output = pid_yaw.output;
@@ -49,9 +49,9 @@ void send_ins_sensor_debug_message(debug_msg_t *payload)
 	barometer_velocity = barometer_get_relative_altitude_rate();
 
 	//XXX
-	gyro_raw[0] *= 0.0174533;
-	gyro_raw[1] *= 0.0174533;
-	gyro_raw[2] *= 0.0174533;
+	gyro_raw[0] *= 0.0174533f;
+	gyro_raw[1] *= 0.0174533f;
+	gyro_raw[2] *= 0.0174533f;
 
 	pack_debug_debug_message_header(payload, MESSAGE_ID_INS_SENSOR);
 	pack_debug_debug_message_float(&current_time_ms, payload);
@@ -135,8 +135,8 @@ void send_gps_accuracy_debug_message(debug_msg_t *payload)
 	get_gps_position_uncertainty(&h_acc, &v_acc);
 
 	/* convert unit from [mm] to [m] */
-	h_acc *= 0.001;
-	v_acc *= 0.001;
+	h_acc *= 0.001f;
+	v_acc *= 0.001f;
 
 	pack_debug_debug_message_header(payload, MESSAGE_ID_GPS_ACCURACY);
 	pack_debug_debug_message_float(&h_acc, payload);
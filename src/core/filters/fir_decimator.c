@@ -0,0 +1,86 @@
+#include <math.h>
+#include <string.h>
+#include "fir_decimator.h"
+
+void fir_decimator_init(fir_decimator_t *fir, int channels, int taps, int factor,
+                        float sampling_freq, float cutoff_freq)
+{
+	if(channels > FIR_DECIMATOR_CHANNELS_MAX) channels = FIR_DECIMATOR_CHANNELS_MAX;
+	if(taps > FIR_DECIMATOR_TAPS_MAX) taps = FIR_DECIMATOR_TAPS_MAX;
+
+	fir->channels = channels;
+	fir->taps = taps;
+	fir->factor = factor;
+	fir->sampling_freq = sampling_freq;
+
+	/* hamming windowed sinc, normalized to unity gain at dc */
+	float fc = cutoff_freq / sampling_freq;
+	float center = (float)(taps - 1) * 0.5f;
+	float sum = 0.0f;
+
+	int i;
+	for(i = 0; i < taps; i++) {
+		float x = (float)i - center;
+		float sinc = (fabsf(x) < 1e-6f) ? 2.0f * fc :
+		             sinf(2.0f * (float)M_PI * fc * x) / ((float)M_PI * x);
+		float window = 0.54f - 0.46f * cosf(2.0f * (float)M_PI * (float)i / (float)(taps - 1));
+		fir->coeff[i] = sinc * window;
+		sum += fir->coeff[i];
+	}
+
+	for(i = 0; i < taps; i++) {
+		fir->coeff[i] /= sum;
+	}
+
+	fir_decimator_reset(fir);
+}
+
+void fir_decimator_reset(fir_decimator_t *fir)
+{
+	fir->phase = 0;
+	fir->pos = 0;
+	memset(fir->history, 0, sizeof(fir->history));
+}
+
+/* push one sample of every channel, returns true if the output is calculated */
+bool fir_decimator_update(fir_decimator_t *fir, float *input, float *output)
+{
+	int taps = fir->taps;
+	int pos = fir->pos;
+
+	int c;
+	for(c = 0; c < fir->channels; c++) {
+		fir->history[c][pos] = input[c];
+		fir->history[c][pos + taps] = input[c];
+	}
+
+	pos++;
+	if(pos == taps) pos = 0;
+	fir->pos = pos;
+
+	fir->phase++;
+	if(fir->phase < fir->factor) {
+		return false;
+	}
+	fir->phase = 0;
+
+	/* history[pos] to history[pos + taps - 1] are the samples from the oldest
+	 * to the latest */
+	int i;
+	for(c = 0; c < fir->channels; c++) {
+		float *x = &fir->history[c][pos];
+		float y = 0.0f;
+		for(i = 0; i < taps; i++) {
+			y += fir->coeff[i] * x[i];
+		}
+		output[c] = y;
+	}
+
+	return true;
+}
+
+/* group delay of the linear phase filter [s] */
+float fir_decimator_get_delay(fir_decimator_t *fir)
+{
+	return (float)(fir->taps - 1) * 0.5f / fir->sampling_freq;
+}
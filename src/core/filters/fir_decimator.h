@@ -0,0 +1,33 @@
+#ifndef __FIR_DECIMATOR_H__
+#define __FIR_DECIMATOR_H__
+
+#include <stdbool.h>
+
+#define FIR_DECIMATOR_TAPS_MAX     32
+#define FIR_DECIMATOR_CHANNELS_MAX 6
+
+/* multi-channel fir low pass filter with decimation, the output is only
+ * calculated for every factor-th input sample */
+typedef struct {
+	int channels;
+	int taps;
+	int factor;
+	int phase;
+	int pos;
+
+	float sampling_freq;
+
+	float coeff[FIR_DECIMATOR_TAPS_MAX];
+
+	/* every sample is stored twice so the window of the latest taps is
+	 * always contiguous */
+	float history[FIR_DECIMATOR_CHANNELS_MAX][2 * FIR_DECIMATOR_TAPS_MAX];
+} fir_decimator_t;
+
+void fir_decimator_init(fir_decimator_t *fir, int channels, int taps, int factor,
+                        float sampling_freq, float cutoff_freq);
+void fir_decimator_reset(fir_decimator_t *fir);
+bool fir_decimator_update(fir_decimator_t *fir, float *input, float *output);
+float fir_decimator_get_delay(fir_decimator_t *fir);
+
+#endif
@@ -0,0 +1,127 @@
+#include <string.h>
+#include "se3_math.h"
+#include "imu_preint.h"
+
+static void imu_preint_reset_interval(imu_preint_t *preint)
+{
+	memset(preint->alpha, 0, sizeof(preint->alpha));
+	memset(preint->beta, 0, sizeof(preint->beta));
+	memset(preint->nu, 0, sizeof(preint->nu));
+	memset(preint->sculling, 0, sizeof(preint->sculling));
+	preint->dt = 0.0f;
+	preint->sample_cnt = 0;
+}
+
+void imu_preint_init(imu_preint_t *preint)
+{
+	imu_preint_reset_interval(preint);
+	preint->history_cnt = 0;
+}
+
+/* integrate one sample, accel is the specific force [m/s^2] and gyro is the angular
+ * rate [rad/s] of the body frame, time_us is the sampling time of the sensor [us].
+ * the interval is taken from the integer timestamps, a float second timestamp
+ * loses the 1ms resolution after a few hours.
+ * the increments between two samples integrate the parabola through the last three
+ * samples (trapezoidal after a restart), the coning and sculling terms are the ones
+ * of the two-sample algorithm (savage) with the increment of the previous sample */
+void imu_preint_update(imu_preint_t *preint, float *accel, float *gyro, uint64_t time_us)
+{
+	/* an earlier timestamp wraps to a huge interval and restarts the integration */
+	float sample_dt = (float)(time_us - preint->last_time_us) * 1e-6f;
+	int i;
+
+	/* first sample or a gap, the integration starts from this sample */
+	if(preint->history_cnt == 0 || sample_dt <= 0.0f || sample_dt > IMU_PREINT_MAX_GAP) {
+		for(i = 0; i < 3; i++) {
+			preint->last_gyro[i] = gyro[i];
+			preint->last_accel[i] = accel[i];
+			preint->last_delta_angle[i] = 0.0f;
+			preint->last_delta_vel[i] = 0.0f;
+		}
+		preint->last_time_us = time_us;
+		preint->history_cnt = 1;
+		return;
+	}
+
+	/* the trapezoid underestimates the vibration of the rates, e.g. 0.8% of the
+	 * amplitude at 50Hz with the 1kHz samples, the parabola integrates the last
+	 * interval with h/12 * (-x[k-2] + 8 * x[k-1] + 5 * x[k]) (uniform sampling) */
+	float delta_angle[3], delta_vel[3];
+	if(preint->history_cnt < 2) {
+		float half_dt = 0.5f * sample_dt;
+		for(i = 0; i < 3; i++) {
+			delta_angle[i] = (gyro[i] + preint->last_gyro[i]) * half_dt;
+			delta_vel[i] = (accel[i] + preint->last_accel[i]) * half_dt;
+		}
+		preint->history_cnt = 2;
+	} else {
+		float dt_12 = sample_dt * (1.0f / 12.0f);
+		for(i = 0; i < 3; i++) {
+			delta_angle[i] = (-preint->prev_gyro[i] + 8.0f * preint->last_gyro[i] +
+			                  5.0f * gyro[i]) * dt_12;
+			delta_vel[i] = (-preint->prev_accel[i] + 8.0f * preint->last_accel[i] +
+			                5.0f * accel[i]) * dt_12;
+		}
+	}
+
+	/* coning: beta += 1/2 * (alpha + 1/6 * delta_angle_last) x delta_angle */
+	float alpha_coning[3], coning[3];
+	for(i = 0; i < 3; i++) {
+		alpha_coning[i] = preint->alpha[i] + preint->last_delta_angle[i] * (1.0f / 6.0f);
+	}
+	cross_product_3x1(alpha_coning, delta_angle, coning);
+
+	/* sculling: 1/2 * (alpha x delta_v + nu x delta_angle) +
+	 *           1/12 * (delta_angle_last x delta_v + delta_v_last x delta_angle) */
+	float alpha_dv[3], nu_da[3], da_last_dv[3], dv_last_da[3];
+	cross_product_3x1(preint->alpha, delta_vel, alpha_dv);
+	cross_product_3x1(preint->nu, delta_angle, nu_da);
+	cross_product_3x1(preint->last_delta_angle, delta_vel, da_last_dv);
+	cross_product_3x1(preint->last_delta_vel, delta_angle, dv_last_da);
+
+	for(i = 0; i < 3; i++) {
+		preint->beta[i] += 0.5f * coning[i];
+		preint->sculling[i] += 0.5f * (alpha_dv[i] + nu_da[i]) +
+		                       (1.0f / 12.0f) * (da_last_dv[i] + dv_last_da[i]);
+
+		preint->alpha[i] += delta_angle[i];
+		preint->nu[i] += delta_vel[i];
+
+		preint->prev_gyro[i] = preint->last_gyro[i];
+		preint->prev_accel[i] = preint->last_accel[i];
+		preint->last_gyro[i] = gyro[i];
+		preint->last_accel[i] = accel[i];
+		preint->last_delta_angle[i] = delta_angle[i];
+		preint->last_delta_vel[i] = delta_vel[i];
+	}
+	preint->last_time_us = time_us;
+
+	preint->dt += sample_dt;
+	preint->sample_cnt++;
+}
+
+/* get the delta angle [rad], delta velocity [m/s] and the length [s] of the interval
+ * since the last call and start the next interval. returns false if no sample is
+ * integrated */
+bool imu_preint_take(imu_preint_t *preint, float *delta_angle, float *delta_vel, float *dt)
+{
+	if(preint->sample_cnt == 0) {
+		return false;
+	}
+
+	/* rotation of the specific force during the interval, 1/2 * alpha x nu */
+	float rotation[3];
+	cross_product_3x1(preint->alpha, preint->nu, rotation);
+
+	int i;
+	for(i = 0; i < 3; i++) {
+		delta_angle[i] = preint->alpha[i] + preint->beta[i];
+		delta_vel[i] = preint->nu[i] + 0.5f * rotation[i] + preint->sculling[i];
+	}
+	*dt = preint->dt;
+
+	imu_preint_reset_interval(preint);
+
+	return true;
+}
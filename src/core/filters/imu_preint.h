@@ -0,0 +1,37 @@
+#ifndef __IMU_PREINT_H__
+#define __IMU_PREINT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define IMU_PREINT_MAX_GAP 0.02f //[s], the integration restarts after a longer gap
+
+/* integration of the imu samples between two estimator steps. the delta angle is
+ * compensated for the coning motion and the delta velocity for the rotation and
+ * the sculling motion, both are expressed in the body frame at the beginning of
+ * the interval */
+typedef struct {
+	float alpha[3];     //integrated angular rate [rad]
+	float beta[3];      //coning correction [rad]
+	float nu[3];        //integrated specific force [m/s]
+	float sculling[3];  //sculling correction [m/s]
+	float dt;           //length of the interval [s]
+	int sample_cnt;
+
+	/* the last two samples and the increments of the last one, kept across the
+	 * intervals */
+	float last_gyro[3];
+	float last_accel[3];
+	float prev_gyro[3];
+	float prev_accel[3];
+	float last_delta_angle[3];
+	float last_delta_vel[3];
+	uint64_t last_time_us;
+	int history_cnt;    //number of the samples kept, 0 to 2
+} imu_preint_t;
+
+void imu_preint_init(imu_preint_t *preint);
+void imu_preint_update(imu_preint_t *preint, float *accel, float *gyro, uint64_t time_us);
+bool imu_preint_take(imu_preint_t *preint, float *delta_angle, float *delta_vel, float *dt);
+
+#endif
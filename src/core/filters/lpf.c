@@ -7,7 +7,7 @@ void lpf_first_order_init(float *ret_gain, float sampling_time, float cutoff_fre
 	//reference: low pass filter (wikipedia)
 
 	//return the alpha value of the first order low pass filter
-	*ret_gain = sampling_time / (sampling_time + 1/ (2 * M_PI * cutoff_freq));
+	*ret_gain = sampling_time / (sampling_time + 1.0f / (2.0f * (float)M_PI * cutoff_freq));
 }
 
 void lpf_first_order(float new, float *filtered, float alpha)
@@ -19,8 +19,8 @@ void lpf_second_order_init(lpf2_t *lpf, float sampling_freq, float cutoff_freq)
 {
 	//reference: How does a low-pass filter programmatically work? (stackexchange)
 
-	float alpha = tan(M_PI * cutoff_freq / sampling_freq);
-	float sqrt2 = sqrt(2.0f);
+	float alpha = tanf((float)M_PI * cutoff_freq / sampling_freq);
+	float sqrt2 = sqrtf(2.0f);
 	float alpha_squared = alpha * alpha;
 	float sqrt2_alpha = sqrt2 * alpha;
 
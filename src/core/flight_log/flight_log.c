@@ -0,0 +1,180 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "sys_time.h"
+#include "sensor_log.h"
+#include "flight_log.h"
+
+/* the rings have one producer (the imu interrupt or the flight control task)
+ * and one consumer (the flight log task) each, the indices are published with
+ * release/acquire ordering so no critical section is required */
+
+#define CCMRAM __attribute__((section(".ccmram")))
+
+#define FLIGHT_LOG_SYNC_BYTE SENSOR_LOG_SYNC_BYTE
+
+enum {
+	FLIGHT_LOG_ISR_RING,
+	FLIGHT_LOG_TASK_RING,
+	FLIGHT_LOG_RING_CNT
+} FLIGHT_LOG_RING;
+
+typedef struct {
+	uint8_t *buf;
+	uint32_t mask;
+	uint32_t head; //write position, only modified by the producer
+	uint32_t tail; //read position, only modified by the consumer
+	uint32_t dropped_cnt;
+} flight_log_ring_t;
+
+CCMRAM static uint8_t flight_log_isr_buf[FLIGHT_LOG_ISR_RING_SIZE];
+CCMRAM static uint8_t flight_log_task_buf[FLIGHT_LOG_TASK_RING_SIZE];
+
+struct {
+	flight_log_ring_t rings[FLIGHT_LOG_RING_CNT];
+	volatile bool running;
+
+	/* the consumer only switches the ring at the head position taken when
+	 * it started draining it, so the records are never interleaved */
+	int drain_ring;
+	uint32_t drain_end;
+	bool draining;
+} flight_log;
+
+static uint32_t flight_log_get_time_us(void)
+{
+	/* truncated to 32 bits, same as the sensor log */
+	return (uint32_t)get_time_us();
+}
+
+static void flight_log_ring_push(flight_log_ring_t *ring, uint32_t *head, uint8_t c)
+{
+	ring->buf[*head & ring->mask] = c;
+	(*head)++;
+}
+
+static void flight_log_ring_write(flight_log_ring_t *ring, int type, void *payload, int size)
+{
+	if(flight_log.running == false || size > SENSOR_LOG_PAYLOAD_MAX) {
+		return;
+	}
+
+	uint32_t head = ring->head;
+	uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	/* one byte is kept for distinguishing between full and empty */
+	uint32_t free_space = ring->mask - (head - tail);
+	if(free_space < (uint32_t)(SENSOR_LOG_HEADER_SIZE + size + 1)) {
+		/* drop the record instead of breaking the stream */
+		ring->dropped_cnt++;
+		return;
+	}
+
+	uint32_t timestamp_us = flight_log_get_time_us();
+	uint8_t *ts = (uint8_t *)&timestamp_us;
+	uint8_t checksum = (uint8_t)type ^ (uint8_t)size;
+
+	flight_log_ring_push(ring, &head, FLIGHT_LOG_SYNC_BYTE);
+	flight_log_ring_push(ring, &head, (uint8_t)type);
+	flight_log_ring_push(ring, &head, (uint8_t)size);
+
+	int i;
+	for(i = 0; i < 4; i++) {
+		checksum ^= ts[i];
+		flight_log_ring_push(ring, &head, ts[i]);
+	}
+	for(i = 0; i < size; i++) {
+		checksum ^= ((uint8_t *)payload)[i];
+		flight_log_ring_push(ring, &head, ((uint8_t *)payload)[i]);
+	}
+	flight_log_ring_push(ring, &head, checksum);
+
+	/* publish the whole record at once */
+	__atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+}
+
+/* called by the flight control task */
+void flight_log_write(int type, void *payload, int size)
+{
+	flight_log_ring_write(&flight_log.rings[FLIGHT_LOG_TASK_RING], type, payload, size);
+}
+
+/* called by the imu interrupt */
+void flight_log_write_from_isr(int type, void *payload, int size)
+{
+	flight_log_ring_write(&flight_log.rings[FLIGHT_LOG_ISR_RING], type, payload, size);
+}
+
+void flight_log_start(void)
+{
+	if(flight_log.running == true) {
+		return;
+	}
+
+	/* ccm-ram is not cleared by the startup code */
+	flight_log.rings[FLIGHT_LOG_ISR_RING] = (flight_log_ring_t) {
+		.buf = flight_log_isr_buf, .mask = FLIGHT_LOG_ISR_RING_SIZE - 1
+	};
+	flight_log.rings[FLIGHT_LOG_TASK_RING] = (flight_log_ring_t) {
+		.buf = flight_log_task_buf, .mask = FLIGHT_LOG_TASK_RING_SIZE - 1
+	};
+	flight_log.drain_ring = 0;
+	flight_log.draining = false;
+
+	__atomic_store_n(&flight_log.running, true, __ATOMIC_RELEASE);
+}
+
+void flight_log_stop(void)
+{
+	flight_log.running = false;
+}
+
+bool flight_log_is_running(void)
+{
+	return flight_log.running;
+}
+
+/* pop up to size bytes from the rings, return the number of bytes */
+int flight_log_read(uint8_t *buf, int size)
+{
+	if(flight_log.running == false) {
+		return 0;
+	}
+
+	int read_cnt = 0;
+	int switch_cnt = 0;
+
+	while(read_cnt < size && switch_cnt < FLIGHT_LOG_RING_CNT) {
+		flight_log_ring_t *ring = &flight_log.rings[flight_log.drain_ring];
+
+		if(flight_log.draining == false) {
+			flight_log.drain_end = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+			flight_log.draining = true;
+		}
+
+		uint32_t tail = ring->tail;
+		while(tail != flight_log.drain_end && read_cnt < size) {
+			buf[read_cnt] = ring->buf[tail & ring->mask];
+			tail++;
+			read_cnt++;
+		}
+		__atomic_store_n(&ring->tail, tail, __ATOMIC_RELEASE);
+
+		if(tail != flight_log.drain_end) {
+			break;
+		}
+
+		/* reached a record boundary, continue with the next ring */
+		flight_log.draining = false;
+		flight_log.drain_ring = (flight_log.drain_ring + 1) % FLIGHT_LOG_RING_CNT;
+		switch_cnt++;
+	}
+
+	return read_cnt;
+}
+
+uint32_t flight_log_get_dropped_cnt(void)
+{
+	return flight_log.rings[FLIGHT_LOG_ISR_RING].dropped_cnt +
+	       flight_log.rings[FLIGHT_LOG_TASK_RING].dropped_cnt;
+}
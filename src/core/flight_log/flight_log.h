@@ -0,0 +1,68 @@
+#ifndef __FLIGHT_LOG_H__
+#define __FLIGHT_LOG_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* full rate flight data log, the records share the format of the sensor log
+ * (see sensor_log.h) and can be decoded by tools/flight_log_decode.py */
+
+/* every record source writes into the ring of its own context, the imu
+ * interrupt and the flight control task. the rings are placed in the ccm-ram
+ * which is not reachable by the dma */
+#define FLIGHT_LOG_ISR_RING_SIZE  16384 //[bytes], must be power of 2
+#define FLIGHT_LOG_TASK_RING_SIZE 32768 //[bytes], must be power of 2
+
+enum {
+	FLIGHT_LOG_IMU = 32,
+	FLIGHT_LOG_ATTITUDE = 33,
+	FLIGHT_LOG_INS = 34,
+	FLIGHT_LOG_CONTROLLER = 35,
+	FLIGHT_LOG_MOTOR = 36,
+	FLIGHT_LOG_PERF = 37
+} FLIGHT_LOG_TYPE;
+
+/* calibrated imu data of every interrupt (1KHz) */
+typedef struct __attribute__((packed)) {
+	float accel[3]; //[m/s^2]
+	float gyro[3];  //[deg/s]
+} flight_log_imu_t;
+
+typedef struct __attribute__((packed)) {
+	float q[4];
+} flight_log_attitude_t;
+
+typedef struct __attribute__((packed)) {
+	float pos_enu[3]; //[m]
+	float vel_enu[3]; //[m/s]
+} flight_log_ins_t;
+
+typedef struct __attribute__((packed)) {
+	float moments[3]; //[N*m]
+	float force;      //[N]
+} flight_log_controller_t;
+
+/* pwm pulse of the motor timers */
+typedef struct __attribute__((packed)) {
+	uint16_t pulse[4];
+} flight_log_motor_t;
+
+/* cpu cycles of the last flight control loop */
+typedef struct __attribute__((packed)) {
+	uint32_t ahrs_ins;
+	uint32_t controller;
+	uint32_t loop;
+	uint32_t wakeup;
+} flight_log_perf_t;
+
+void flight_log_start(void);
+void flight_log_stop(void);
+bool flight_log_is_running(void);
+
+void flight_log_write(int type, void *payload, int size);
+void flight_log_write_from_isr(int type, void *payload, int size);
+
+int flight_log_read(uint8_t *buf, int size);
+uint32_t flight_log_get_dropped_cnt(void);
+
+#endif
@@ -25,9 +25,13 @@
 #include "proj_config.h"
 #include "mavlink_task.h"
 #include "debug_link_task.h"
+#include "sensor_log_task.h"
+#include "flight_log_task.h"
 #include "perf.h"
 #include "perf_list.h"
+#include "task_stats.h"
 #include "sw_i2c.h"
+#include "i2c.h"
 #include "crc.h"
 #include "ublox_m8n.h"
 #include "calibration_task.h"
@@ -39,13 +43,34 @@
 perf_t perf_list[] = {
 	DEF_PERF(PERF_AHRS_INS, "ahrs and ins")
 	DEF_PERF(PERF_CONTROLLER, "controller")
-	DEF_PERF(PERF_FLIGHT_CONTROL_LOOP, "flight control loop")
-	DEF_PERF(PERF_FLIGHT_CONTROL_TRIGGER_TIME, "flight control trigger time")
+	/* histogram bucket width and deadline [us]. the loop has to finish in its
+	 * 2.5ms slot, a trigger period longer than 1.5 slots means a skipped one */
+	DEF_PERF_HIST(PERF_FLIGHT_CONTROL_LOOP, "flight control loop", 250, 2500)
+	DEF_PERF_HIST(PERF_FLIGHT_CONTROL_TRIGGER_TIME, "flight control trigger time", 250, 3750)
+	DEF_PERF_HIST(PERF_FLIGHT_CONTROL_WAKEUP, "flight control wakeup", 10, 0)
+	DEF_PERF_HIST(PERF_IMU_ISR, "imu isr", 2, 0)
+	DEF_PERF_HIST(PERF_IMU_SPI_DMA_ISR, "imu spi dma isr", 2, 0)
+	DEF_PERF_HIST(PERF_TIMER5_ISR, "timer5 isr", 2, 0)
+	DEF_PERF_HIST(PERF_TIMER3_ISR, "timer3 isr", 2, 0)
+};
+
+/* cpu time budget of the tasks in every 2.5ms frame [us] */
+task_budget_t task_budget_list[] = {
+	DEF_TASK_BUDGET("flight controller", 1000)
+	DEF_TASK_BUDGET("mavlink publisher", 150)
+	DEF_TASK_BUDGET("mavlink receiver", 100)
+	DEF_TASK_BUDGET("shell", 100)
+	DEF_TASK_BUDGET("debug_link", 100)
+	DEF_TASK_BUDGET("sensor log", 100)
+	DEF_TASK_BUDGET("flight log", 150)
+	DEF_TASK_BUDGET("calibration", 50)
+	DEF_TASK_BUDGET("compass driver", 50)
 };
 
 int main(void)
 {
 	perf_init(perf_list, SIZE_OF_PERF_LIST(perf_list));
+	task_stats_init(task_budget_list, SIZE_OF_TASK_BUDGET_LIST(task_budget_list));
 
 	NVIC_PriorityGroupConfig(NVIC_PriorityGroup_4);
 
@@ -57,8 +82,15 @@ int main(void)
 	crc_init();
 	led_init();
 	ext_switch_init();
+#if (SELECT_DEBUG_TELEM == TELEM_SENSOR_LOG)
+	uart1_init(921600);
+#elif (SELECT_DEBUG_TELEM == TELEM_FLIGHT_LOG)
+	uart1_init(1500000);
+#else
 	uart1_init(115200);
+#endif
 	uart3_init(115200); //telem
+	sbus_init();
 	uart4_init(100000); //s-bus
 
 #if (SELECT_NAVIGATION_DEVICE1 == NAV_DEV1_USE_GPS)
@@ -74,7 +106,7 @@ int main(void)
 	vins_mono_init(UAV_DEFAULT_ID); //TODO: tracker id is not needed
 #endif
 
-	timer12_init();    //system timer and flight controller timer
+	timer5_init();     //system timer and flight controller timer
 	pwm_timer1_init(); //motor
 	pwm_timer4_init(); //motor
 	exti10_init();     //imu ext interrupt
@@ -84,7 +116,11 @@ int main(void)
 
 #if (ENABLE_MAGNETOMETER == 1)
 	/* compass (ist8310) */
+#if (SELECT_COMPASS_I2C == COMPASS_HW_I2C)
+	i2c2_init();
+#else
 	sw_i2c_init();
+#endif
 	ist8310_register_task("compass driver", 512, tskIDLE_PRIORITY + 5);
 #endif
 
@@ -110,6 +146,10 @@ int main(void)
 	debug_link_register_task("debug_link", 512, tskIDLE_PRIORITY + 3);
 #elif (SELECT_DEBUG_TELEM == TELEM_SHELL)
 	shell_register_task("shell", 1024, tskIDLE_PRIORITY + 3);
+#elif (SELECT_DEBUG_TELEM == TELEM_SENSOR_LOG)
+	sensor_log_register_task("sensor log", 512, tskIDLE_PRIORITY + 3);
+#elif (SELECT_DEBUG_TELEM == TELEM_FLIGHT_LOG)
+	flight_log_register_task("flight log", 512, tskIDLE_PRIORITY + 1);
 #endif
 
 	/* sensor calibration task
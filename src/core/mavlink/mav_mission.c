@@ -12,7 +12,7 @@
 #include "sys_param.h"
 #include "waypoint_following.h"
 
-#define MISSION_TIMEOUT_TIME 2.0f //[s]
+#define MISSION_TIMEOUT_TIME 2000000 //[us]
 #define MISSION_RETRY_TIMES 5
 
 mavlink_mission_manager mission_manager;
@@ -48,7 +48,7 @@ void mav_mission_request_list(mavlink_message_t *received_msg)
 		mission_manager.send_mission = true;
 
 		/* reset timeout timer */
-		mission_manager.sender_timout_timer = get_sys_time_s();
+		mission_manager.sender_timout_timer = get_time_us();
 	}
 }
 
@@ -99,7 +99,7 @@ void mav_mission_count(mavlink_message_t *received_msg)
 	send_mavlink_msg_to_uart(&msg);
 
 	/* start timeout timer and reset retry counter */
-	mission_manager.recept_timout_timer = get_sys_time_s();
+	mission_manager.recept_timout_timer = get_time_us();
 	mission_manager.recept_retry = 0;
 }
 
@@ -147,7 +147,7 @@ void mav_mission_item_int(mavlink_message_t *received_msg)
 		send_mavlink_msg_to_uart(&msg);
 
 		/* start timeout timer and reset retry counter */
-		mission_manager.recept_timout_timer = get_sys_time_s();
+		mission_manager.recept_timout_timer = get_time_us();
 		mission_manager.recept_retry = 0;
 	}
 
@@ -172,7 +172,7 @@ void mav_mission_item_int(mavlink_message_t *received_msg)
 		send_mavlink_msg_to_uart(&msg);
 
 		/* start timeout timer and reset retry counter */
-		mission_manager.recept_timout_timer = get_sys_time_s();
+		mission_manager.recept_timout_timer = get_time_us();
 		mission_manager.recept_retry = 0;
 	}
 }
@@ -235,7 +235,7 @@ void mav_mission_request_int(mavlink_message_t *received_msg)
 	send_mavlink_msg_to_uart(&msg);
 
 	/* reset timeout timer */
-	mission_manager.sender_timout_timer = get_sys_time_s();
+	mission_manager.sender_timout_timer = get_time_us();
 }
 
 void mav_mission_ack(mavlink_message_t *received_msg)
@@ -304,7 +304,7 @@ void mission_waypoint_microservice_handler_out(void)
 {
 	if(mission_manager.send_mission == false) return;
 
-	float curr_time = get_sys_time_s();
+	uint64_t curr_time = get_time_us();
 	if((curr_time - mission_manager.sender_timout_timer) > MISSION_TIMEOUT_TIME) {
 		mission_manager.send_mission = false;
 	}
@@ -314,7 +314,7 @@ void mission_waypoint_microservice_handler_in(void)
 {
 	if(mission_manager.receive_mission == false) return;
 
-	float curr_time = get_sys_time_s();
+	uint64_t curr_time = get_time_us();
 	if((curr_time - mission_manager.recept_timout_timer) > MISSION_TIMEOUT_TIME) {
 		/* timeout, send request message */
 		if(mission_manager.recept_retry <= MISSION_RETRY_TIMES) {
@@ -8,14 +8,14 @@
 typedef struct {
 	/* transmission */
 	bool send_mission;
-	float sender_timout_timer;
+	uint64_t sender_timout_timer; //[us]
       
 	/* reception */
 	bool receive_mission;
 	int recept_cnt;
 	int recept_index;
 	int recvd_mission_type;
-	float recept_timout_timer; 
+	uint64_t recept_timout_timer; //[us]
 	int recept_retry;
 } mavlink_mission_manager;
 
@@ -10,6 +10,8 @@
 #include "position_state.h"
 #include "common_list.h"
 #include "sys_param.h"
+#include "perf.h"
+#include "task_stats.h"
 
 extern attitude_t attitude;
 
@@ -54,15 +56,15 @@ void send_mavlink_status_text(char *s, uint8_t severity, uint16_t id, uint8_t se
 
 void send_mavlink_system_status(void)
 {
-	float battery_voltage = 12.5 * 1000;
+	float battery_voltage = 12.5f * 1000;
 	float battery_remain_percentage = 100;
 	mavlink_message_t msg;
 
 	float sys_id;
 	get_sys_param_float(MAV_SYS_ID, &sys_id);
 
-	mavlink_msg_sys_status_pack((uint8_t)sys_id, 1, &msg, 0, 0, 0, 0, battery_voltage, -1,
-	                            battery_remain_percentage, 0, 0, 0, 0, 0, 0);
+	mavlink_msg_sys_status_pack((uint8_t)sys_id, 1, &msg, 0, 0, 0, 0, (uint16_t)battery_voltage, -1,
+	                            (int8_t)battery_remain_percentage, 0, 0, 0, 0, 0, 0);
 	send_mavlink_msg_to_uart(&msg);
 }
 
@@ -76,9 +78,9 @@ void send_mavlink_rc_channels(void)
 	get_sys_param_float(MAV_SYS_ID, &sys_id);
 
 	mavlink_message_t msg;
-	float boot_time_ms = get_sys_time_ms();
+	uint32_t boot_time_ms = (uint32_t)(get_time_us() / 1000);
 
-	mavlink_msg_rc_channels_pack((uint8_t)sys_id, 1, &msg, boot_time_ms, 8, rc_val[0], rc_val[1],
+	mavlink_msg_rc_channels_pack((uint8_t)sys_id, 1, &msg, boot_time_ms, 18, rc_val[0], rc_val[1],
 	                             rc_val[2], rc_val[3], rc_val[4], rc_val[5], rc_val[6],
 	                             rc_val[7], rc_val[8], rc_val[9], rc_val[10], rc_val[11],
 	                             rc_val[12], rc_val[13], rc_val[14], rc_val[15], rc_val[16],
@@ -91,7 +93,7 @@ void send_mavlink_attitude(void)
 	float roll = deg_to_rad(attitude.roll);
 	float pitch = deg_to_rad(attitude.pitch);
 	float yaw = deg_to_rad(attitude.yaw);
-	uint32_t curr_time_ms = (uint32_t)get_sys_time_ms();
+	uint32_t curr_time_ms = (uint32_t)(get_time_us() / 1000);
 
 	float sys_id;
 	get_sys_param_float(MAV_SYS_ID, &sys_id);
@@ -108,7 +110,7 @@ void send_mavlink_attitude_quaternion(void)
 	float yaw_speed = 0.0f;
 	float *repr_offset_q = 0;
 
-	uint32_t curr_time_ms = (uint32_t)get_sys_time_ms();
+	uint32_t curr_time_ms = (uint32_t)(get_time_us() / 1000);
 
 	float sys_id;
 	get_sys_param_float(MAV_SYS_ID, &sys_id);
@@ -122,7 +124,7 @@ void send_mavlink_attitude_quaternion(void)
 
 void send_mavlink_gps(void)
 {
-	uint32_t curr_time_ms = (uint32_t)get_sys_time_ms();
+	uint32_t curr_time_ms = (uint32_t)(get_time_us() / 1000);
 
 	int32_t longitude = 0, latitude = 0, height_msl = 0;
 	uint8_t sv_num = 0;
@@ -145,7 +147,7 @@ void send_mavlink_gps(void)
 	fix_type = get_gps_fix_type();
 	get_gps_position_uncertainty(&h_acc, &v_acc);
 	ground_speed = get_gps_ground_speed();
-	gps_yaw = get_gps_heading() * 1e2;
+	gps_yaw = get_gps_heading() * 1e2f;
 
 	float sys_id;
 	get_sys_param_float(MAV_SYS_ID, &sys_id);
@@ -166,7 +168,7 @@ void send_mavlink_local_position_ned(void)
 	get_enu_position(pos);
 	get_enu_velocity(vel);
 
-	uint32_t curr_time_ms = (uint32_t)get_sys_time_ms();
+	uint32_t curr_time_ms = (uint32_t)(get_time_us() / 1000);
 
 	float sys_id;
 	get_sys_param_float(MAV_SYS_ID, &sys_id);
@@ -201,3 +203,94 @@ void send_mavlink_reached_waypoint(void)
 	mavlink_msg_mission_item_reached_pack((uint8_t)sys_id, 1, &msg, curr_waypoint);
 	send_mavlink_msg_to_uart(&msg);
 }
+
+/* send the latency histogram of one perf entry with the debug_float_array
+ * message, the entries are sent in turns. array_id is the perf id and the
+ * data layout is:
+ * [count, deadline misses, deadline, min, max, mean, last, bucket width,
+ *  bucket 0, ..., bucket PERF_HIST_BUCKETS-1], time unit is [us] */
+void send_mavlink_perf_histogram(void)
+{
+	static int id = 0;
+
+	int list_size = perf_get_list_size();
+	if(list_size == 0) {
+		return;
+	}
+
+	/* find next perf entry with the histogram enabled */
+	int i;
+	for(i = 0; i < list_size; i++) {
+		id = (id + 1) % list_size;
+		if(perf_has_histogram(id) == true) break;
+	}
+	if(perf_has_histogram(id) == false) {
+		return;
+	}
+
+	float data[MAVLINK_MSG_DEBUG_FLOAT_ARRAY_FIELD_DATA_LEN] = {0.0f};
+	data[0] = (float)perf_get_count(id);
+	data[1] = (float)perf_get_deadline_miss_cnt(id);
+	data[2] = (float)perf_get_deadline_us(id);
+	data[3] = perf_cycles_to_us((float)perf_get_min_cycles(id));
+	data[4] = perf_cycles_to_us((float)perf_get_max_cycles(id));
+	data[5] = perf_cycles_to_us(perf_get_mean_cycles(id));
+	data[6] = perf_cycles_to_us((float)perf_get_last_cycles(id));
+	data[7] = (float)perf_get_bucket_us(id);
+	for(i = 0; i < PERF_HIST_BUCKETS; i++) {
+		data[8 + i] = (float)perf_get_bucket_cnt(id, i);
+	}
+
+	/* name field is not null terminated if the string is too long */
+	char name[MAVLINK_MSG_DEBUG_FLOAT_ARRAY_FIELD_NAME_LEN] = {0};
+	char *perf_name = perf_get_name(id);
+	for(i = 0; i < MAVLINK_MSG_DEBUG_FLOAT_ARRAY_FIELD_NAME_LEN && perf_name[i] != '\0'; i++) {
+		name[i] = perf_name[i];
+	}
+
+	uint64_t curr_time_us = get_time_us();
+
+	float sys_id;
+	get_sys_param_float(MAV_SYS_ID, &sys_id);
+
+	mavlink_message_t msg;
+	mavlink_msg_debug_float_array_pack((uint8_t)sys_id, 1, &msg, curr_time_us, name, id, data);
+	send_mavlink_msg_to_uart(&msg);
+}
+
+/* send the task statistics with the debug_float_array message, array_id is
+ * TASK_STATS_ARRAY_ID_OFFSET + task index and the data layout is:
+ * [cpu percentage, cpu time per frame [us], budget per frame [us],
+ *  stack free [words], priority, state, over budget, over budget count] */
+void send_mavlink_task_stats(void)
+{
+	float sys_id;
+	get_sys_param_float(MAV_SYS_ID, &sys_id);
+
+	uint64_t curr_time_us = get_time_us();
+
+	int i, j;
+	for(i = 0; i < task_stats_get_task_cnt(); i++) {
+		task_stats_t *stats = task_stats_get(i);
+
+		float data[MAVLINK_MSG_DEBUG_FLOAT_ARRAY_FIELD_DATA_LEN] = {0.0f};
+		data[0] = stats->cpu_percentage;
+		data[1] = stats->frame_time_us;
+		data[2] = stats->budget_us;
+		data[3] = (float)stats->stack_free;
+		data[4] = (float)stats->priority;
+		data[5] = (float)stats->state;
+		data[6] = stats->over_budget ? 1.0f : 0.0f;
+		data[7] = (float)stats->over_budget_cnt;
+
+		char name[MAVLINK_MSG_DEBUG_FLOAT_ARRAY_FIELD_NAME_LEN] = {0};
+		for(j = 0; j < MAVLINK_MSG_DEBUG_FLOAT_ARRAY_FIELD_NAME_LEN && stats->name[j] != '\0'; j++) {
+			name[j] = stats->name[j];
+		}
+
+		mavlink_message_t msg;
+		mavlink_msg_debug_float_array_pack((uint8_t)sys_id, 1, &msg, curr_time_us, name,
+		                                   TASK_STATS_ARRAY_ID_OFFSET + i, data);
+		send_mavlink_msg_to_uart(&msg);
+	}
+}
@@ -1,6 +1,10 @@
 #ifndef __MAV_PUBLISHER_H__
 #define __MAV_PUBLISHER_H__
 
+/* debug_float_array ids of the task statistics, the perf histograms use the
+ * perf id */
+#define TASK_STATS_ARRAY_ID_OFFSET 100
+
 void send_mavlink_msg_to_uart(mavlink_message_t *msg);
 
 void send_mavlink_heartbeat(void);
@@ -13,5 +17,7 @@ void send_mavlink_gps(void);
 void send_mavlink_local_position_ned(void);
 void send_mavlink_current_waypoint(void);
 void send_mavlink_reached_waypoint(void);
+void send_mavlink_perf_histogram(void);
+void send_mavlink_task_stats(void);
 
 #endif
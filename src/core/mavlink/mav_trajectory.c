@@ -26,8 +26,8 @@ void polynomial_trajectory_microservice_handler(void)
 	}
 
 	if(traj_msg_manager.do_recept == true || traj_msg_manager.recept_finished == true) {
-		float current_time = get_sys_time_s();
-		if((current_time - traj_msg_manager.recept_start_time) >= 5.0f) {
+		uint64_t current_time = get_time_us();
+		if((current_time - traj_msg_manager.recept_start_time) >= 5000000) {
 			if(traj_msg_manager.recept_finished == true) {
 				/* succeeded: close transaction after 5 seconds in case
 				 * the ground station didn't received the ack message */
@@ -74,7 +74,7 @@ void mav_polynomial_trajectory_write(mavlink_message_t *received_msg)
 		return;
 	}
 
-	traj_msg_manager.recept_start_time = get_sys_time_s();
+	traj_msg_manager.recept_start_time = get_time_us();
 
 	/* setup trajectory configuration of autopilot*/
 	traj_msg_manager.z_planned = (poly_traj_write.z_enabled == 0 ? false : true);
@@ -166,7 +166,7 @@ void mav_polynomial_trajectory_item(mavlink_message_t *received_msg)
 	/* should not receive any trajectory if handshaking not happened */
 	if(traj_msg_manager.do_recept == false) return;
 
-	traj_msg_manager.recept_start_time = get_sys_time_s();
+	traj_msg_manager.recept_start_time = get_time_us();
 
 	int ret_val = 0;
 
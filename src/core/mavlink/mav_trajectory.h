@@ -10,7 +10,7 @@ typedef struct {
 	bool do_recept;
 	int list_size;
 	uint8_t recept_index;
-	float recept_start_time;
+	uint64_t recept_start_time; //[us]
 	bool recept_finished;
 
 	bool z_planned;
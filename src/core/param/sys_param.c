@@ -441,7 +441,7 @@ int load_param_list_from_flash(void)
 	int read_list_size = 0;
 	int read_crc = 0;
 
-	uint32_t flash_start_addr = ADDR_FLASH_SECTOR_11;
+	uintptr_t flash_start_addr = ADDR_FLASH_SECTOR_11;
 
 	/* read header (parameter list size) and crc */
 	memcpy(&read_list_size, (uint32_t *)(flash_start_addr), sizeof(int));
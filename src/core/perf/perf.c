@@ -1,5 +1,6 @@
+#include <stdint.h>
 #include "perf.h"
-#include "sys_time.h"
+#include "cycle_counter.h"
 
 perf_t *perf_ptr;
 int perf_list_size;
@@ -8,22 +9,164 @@ void perf_init(perf_t *perf_list, int list_size)
 {
 	perf_ptr = perf_list;
 	perf_list_size = list_size;
+
+	cycle_counter_init();
+
+	int i;
+	for(i = 0; i < list_size; i++) {
+		/* convert the histogram settings once, so perf_end() only needs
+		 * a division to find the bucket */
+		perf_list[i].bucket_cycles = (uint32_t)((uint64_t)perf_list[i].bucket_us *
+		                                        CYCLE_COUNTER_FREQ / 1000000);
+		perf_list[i].deadline_cycles = (uint32_t)((uint64_t)perf_list[i].deadline_us *
+		                                          CYCLE_COUNTER_FREQ / 1000000);
+		perf_reset(i);
+	}
 }
 
 void perf_start(int id)
 {
-	perf_ptr[id].start_time = get_sys_time_s();
+	perf_ptr[id].start_cycle = get_cycle_count();
 }
 
 void perf_end(int id)
 {
-	perf_ptr[id].end_time = get_sys_time_s();
-	perf_ptr[id].exec_time = perf_ptr[id].end_time - perf_ptr[id].start_time;
+	/* unsigned subtraction is still valid after the counter wraps around */
+	uint32_t cycles = get_cycle_count() - perf_ptr[id].start_cycle;
+
+	perf_ptr[id].last_cycles = cycles;
+	perf_ptr[id].total_cycles += cycles;
+	perf_ptr[id].count++;
+
+	if(cycles < perf_ptr[id].min_cycles) {
+		perf_ptr[id].min_cycles = cycles;
+	}
+
+	if(cycles > perf_ptr[id].max_cycles) {
+		perf_ptr[id].max_cycles = cycles;
+	}
+
+	if(perf_ptr[id].bucket_cycles > 0) {
+		uint32_t bucket = cycles / perf_ptr[id].bucket_cycles;
+		if(bucket >= PERF_HIST_BUCKETS) {
+			bucket = PERF_HIST_BUCKETS - 1;
+		}
+		perf_ptr[id].hist[bucket]++;
+	}
+
+	if(perf_ptr[id].deadline_cycles > 0 && cycles > perf_ptr[id].deadline_cycles) {
+		perf_ptr[id].deadline_miss_cnt++;
+	}
+}
+
+void perf_reset(int id)
+{
+	perf_ptr[id].last_cycles = 0;
+	perf_ptr[id].min_cycles = UINT32_MAX;
+	perf_ptr[id].max_cycles = 0;
+	perf_ptr[id].total_cycles = 0;
+	perf_ptr[id].count = 0;
+
+	int i;
+	for(i = 0; i < PERF_HIST_BUCKETS; i++) {
+		perf_ptr[id].hist[i] = 0;
+	}
+	perf_ptr[id].deadline_miss_cnt = 0;
+}
+
+uint32_t perf_get_last_cycles(int id)
+{
+	return perf_ptr[id].last_cycles;
+}
+
+uint32_t perf_get_min_cycles(int id)
+{
+	return (perf_ptr[id].count > 0) ? perf_ptr[id].min_cycles : 0;
+}
+
+uint32_t perf_get_max_cycles(int id)
+{
+	return perf_ptr[id].max_cycles;
+}
+
+float perf_get_mean_cycles(int id)
+{
+	if(perf_ptr[id].count == 0) {
+		return 0.0f;
+	}
+
+	return (float)perf_ptr[id].total_cycles / (float)perf_ptr[id].count;
+}
+
+uint32_t perf_get_count(int id)
+{
+	return perf_ptr[id].count;
+}
+
+bool perf_has_histogram(int id)
+{
+	return perf_ptr[id].bucket_cycles > 0;
+}
+
+uint32_t perf_get_bucket_us(int id)
+{
+	return perf_ptr[id].bucket_us;
+}
+
+uint32_t perf_get_deadline_us(int id)
+{
+	return perf_ptr[id].deadline_us;
+}
+
+/* bucket i counts the samples in [i * bucket_us, (i + 1) * bucket_us) */
+uint32_t perf_get_bucket_cnt(int id, int bucket)
+{
+	return perf_ptr[id].hist[bucket];
+}
+
+uint32_t perf_get_deadline_miss_cnt(int id)
+{
+	return perf_ptr[id].deadline_miss_cnt;
+}
+
+/* upper edge of the bucket containing the given percentile (0~100), the
+ * result is limited by the bucket width */
+float perf_get_percentile_us(int id, float percentile)
+{
+	uint32_t count = 0;
+	int i;
+	for(i = 0; i < PERF_HIST_BUCKETS; i++) {
+		count += perf_ptr[id].hist[i];
+	}
+
+	if(count == 0) {
+		return 0.0f;
+	}
+
+	float max_us = perf_cycles_to_us((float)perf_ptr[id].max_cycles);
+	float target = percentile * 0.01f * (float)count;
+	uint32_t sum = 0;
+	for(i = 0; i < PERF_HIST_BUCKETS - 1; i++) {
+		sum += perf_ptr[id].hist[i];
+		if((float)sum >= target) {
+			float upper_edge_us = (float)((i + 1) * perf_ptr[id].bucket_us);
+			return (upper_edge_us < max_us) ? upper_edge_us : max_us;
+		}
+	}
+
+	/* percentile falls into the overflow bucket */
+	return max_us;
+}
+
+float perf_cycles_to_us(float cycles)
+{
+	return cycles * (1000000.0f / (float)CYCLE_COUNTER_FREQ);
 }
 
+/* execution time of the last measurement */
 float perf_get_time_s(int id)
 {
-	return perf_ptr[id].exec_time;
+	return perf_cycles_to_us((float)perf_ptr[id].last_cycles) * 1e-6f;
 }
 
 char *perf_get_name(int id)
@@ -1,20 +1,61 @@
 #ifndef __PERF_H__
 #define __PERF_H__
 
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PERF_HIST_BUCKETS 16
+
 #define DEF_PERF(id, name_str) [id] = {.name = name_str},
+
+/* perf entry with a latency histogram of PERF_HIST_BUCKETS buckets, the last
+ * bucket also counts every sample beyond the range. set deadline_us to 0 to
+ * disable the deadline miss counting */
+#define DEF_PERF_HIST(id, name_str, bucket_width_us, deadline_time_us) \
+	[id] = {.name = name_str, .bucket_us = bucket_width_us, .deadline_us = deadline_time_us},
 #define SIZE_OF_PERF_LIST(list) (sizeof(list) / sizeof(perf_t))
 
+/* execution time in cpu cycles, see cycle_counter.h */
 typedef struct {
 	char *name;
-	float start_time;
-	float end_time;
-	float exec_time;
+	uint32_t start_cycle;
+	uint32_t last_cycles;
+	uint32_t min_cycles;
+	uint32_t max_cycles;
+	uint64_t total_cycles;
+	uint32_t count;
+
+	/* latency histogram and deadline misses, every entry is only updated by
+	 * one context (task or isr) so no locking is required */
+	uint32_t bucket_us;
+	uint32_t deadline_us;
+	uint32_t bucket_cycles;
+	uint32_t deadline_cycles;
+	uint32_t hist[PERF_HIST_BUCKETS];
+	uint32_t deadline_miss_cnt;
 } perf_t;
 
 void perf_init(perf_t *perf_list, int list_size);
 void perf_start(int id);
 void perf_end(int id);
+void perf_reset(int id);
+
+uint32_t perf_get_last_cycles(int id);
+uint32_t perf_get_min_cycles(int id);
+uint32_t perf_get_max_cycles(int id);
+float perf_get_mean_cycles(int id);
+uint32_t perf_get_count(int id);
+
+bool perf_has_histogram(int id);
+uint32_t perf_get_bucket_us(int id);
+uint32_t perf_get_deadline_us(int id);
+uint32_t perf_get_bucket_cnt(int id, int bucket);
+uint32_t perf_get_deadline_miss_cnt(int id);
+float perf_get_percentile_us(int id, float percentile);
+
+float perf_cycles_to_us(float cycles);
 float perf_get_time_s(int id);
+
 char *perf_get_name(int id);
 int perf_get_list_size(void);
 
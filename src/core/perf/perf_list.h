@@ -1,12 +1,17 @@
 #ifndef __PERF_LIST_H__
-#define __PREF_LIST_H__
+#define __PERF_LIST_H__
 
 /* enumerate performace counter id for executuin time profiling */
 enum {
 	PERF_AHRS_INS,
 	PERF_CONTROLLER,
 	PERF_FLIGHT_CONTROL_LOOP,
-	PERF_FLIGHT_CONTROL_TRIGGER_TIME
+	PERF_FLIGHT_CONTROL_TRIGGER_TIME,
+	PERF_FLIGHT_CONTROL_WAKEUP,
+	PERF_IMU_ISR,
+	PERF_IMU_SPI_DMA_ISR,
+	PERF_TIMER5_ISR,
+	PERF_TIMER3_ISR
 } PERF_LIST;
 
 #endif
@@ -0,0 +1,135 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "sys_time.h"
+#include "task_stats.h"
+
+/* per-task cpu load and stack usage, calculated from the freertos run time
+ * counters (microseconds) between two calls of task_stats_update() */
+
+struct {
+	task_budget_t *budget_list;
+	int budget_list_size;
+
+	task_stats_t tasks[TASK_STATS_MAX];
+	int task_cnt;
+
+	uint32_t last_total_run_time;
+	float last_update_time;
+	float window_time;
+} task_stats;
+
+void task_stats_init(task_budget_t *budget_list, int list_size)
+{
+	task_stats.budget_list = budget_list;
+	task_stats.budget_list_size = list_size;
+	task_stats.task_cnt = 0;
+}
+
+static float task_stats_find_budget(char *name)
+{
+	int i;
+	for(i = 0; i < task_stats.budget_list_size; i++) {
+		if(strcmp(task_stats.budget_list[i].name, name) == 0) {
+			return task_stats.budget_list[i].budget_us;
+		}
+	}
+
+	return 0.0f;
+}
+
+static task_stats_t *task_stats_find(UBaseType_t task_number)
+{
+	int i;
+	for(i = 0; i < task_stats.task_cnt; i++) {
+		if(task_stats.tasks[i].task_number == task_number) {
+			return &task_stats.tasks[i];
+		}
+	}
+
+	/* new task */
+	if(task_stats.task_cnt == TASK_STATS_MAX) {
+		return NULL;
+	}
+
+	task_stats_t *stats = &task_stats.tasks[task_stats.task_cnt];
+	task_stats.task_cnt++;
+
+	memset(stats, 0, sizeof(task_stats_t));
+	stats->task_number = task_number;
+
+	return stats;
+}
+
+/* should be called periodically (~1Hz) by a single task */
+void task_stats_update(void)
+{
+	static TaskStatus_t status[TASK_STATS_MAX];
+	uint32_t total_run_time;
+
+	UBaseType_t task_cnt = uxTaskGetSystemState(status, TASK_STATS_MAX, &total_run_time);
+	float curr_time = get_sys_time_s();
+
+	/* the counters are unsigned, the differences are still valid after
+	 * wrapping around */
+	uint32_t window_run_time = total_run_time - task_stats.last_total_run_time;
+	float window_time = curr_time - task_stats.last_update_time;
+	float frame_cnt = window_time / TASK_STATS_FRAME_TIME;
+
+	bool first_update = (task_stats.last_update_time == 0.0f);
+
+	UBaseType_t i;
+	for(i = 0; i < task_cnt; i++) {
+		task_stats_t *stats = task_stats_find(status[i].xTaskNumber);
+		if(stats == NULL) {
+			continue;
+		}
+
+		if(stats->name[0] == '\0') {
+			strncpy(stats->name, status[i].pcTaskName, configMAX_TASK_NAME_LEN - 1);
+			stats->budget_us = task_stats_find_budget(stats->name);
+			stats->last_run_time = status[i].ulRunTimeCounter;
+		}
+
+		stats->priority = status[i].uxCurrentPriority;
+		stats->state = status[i].eCurrentState;
+		stats->stack_free = status[i].usStackHighWaterMark;
+
+		uint32_t run_time = status[i].ulRunTimeCounter - stats->last_run_time;
+		stats->last_run_time = status[i].ulRunTimeCounter;
+
+		if(first_update == true || window_run_time == 0 || frame_cnt <= 0.0f) {
+			continue;
+		}
+
+		stats->cpu_percentage = (float)run_time / (float)window_run_time * 100.0f;
+		stats->frame_time_us = (float)run_time / frame_cnt;
+
+		stats->over_budget = (stats->budget_us > 0.0f) &&
+		                     (stats->frame_time_us > stats->budget_us);
+		if(stats->over_budget == true) {
+			stats->over_budget_cnt++;
+		}
+	}
+
+	task_stats.last_total_run_time = total_run_time;
+	task_stats.last_update_time = curr_time;
+	task_stats.window_time = first_update ? 0.0f : window_time;
+}
+
+int task_stats_get_task_cnt(void)
+{
+	return task_stats.task_cnt;
+}
+
+task_stats_t *task_stats_get(int index)
+{
+	return &task_stats.tasks[index];
+}
+
+float task_stats_get_window_time_s(void)
+{
+	return task_stats.window_time;
+}
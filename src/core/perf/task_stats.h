@@ -0,0 +1,44 @@
+#ifndef __TASK_STATS_H__
+#define __TASK_STATS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define TASK_STATS_MAX        16
+#define TASK_STATS_FRAME_TIME 0.0025f //[s], period of the flight control loop
+
+#define DEF_TASK_BUDGET(name_str, budget_time_us) {.name = name_str, .budget_us = budget_time_us},
+#define SIZE_OF_TASK_BUDGET_LIST(list) (sizeof(list) / sizeof(task_budget_t))
+
+/* cpu time a task may take from every 2.5ms frame on average */
+typedef struct {
+	char *name;
+	float budget_us;
+} task_budget_t;
+
+typedef struct {
+	char name[configMAX_TASK_NAME_LEN];
+	UBaseType_t task_number;
+	UBaseType_t priority;
+	eTaskState state;
+	uint16_t stack_free;       //stack high-water mark [words]
+
+	uint32_t last_run_time;    //run time counter of the last update [us]
+	float cpu_percentage;
+	float frame_time_us;       //cpu time per frame of the last window
+	float budget_us;           //0 if the task has no budget
+
+	bool over_budget;
+	uint32_t over_budget_cnt;  //number of windows exceeding the budget
+} task_stats_t;
+
+void task_stats_init(task_budget_t *budget_list, int list_size);
+void task_stats_update(void);
+
+int task_stats_get_task_cnt(void);
+task_stats_t *task_stats_get(int index);
+float task_stats_get_window_time_s(void);
+
+#endif
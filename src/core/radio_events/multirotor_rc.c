@@ -51,14 +51,14 @@ void rc_wait_unlock_geasture(void)
 {
 	radio_t rc;
 
-	float time_last = 0.0f;
-	float time_current = 0.0f;
+	uint64_t time_last = 0;
+	uint64_t time_current = 0;
 
 	while(1) {
 		sbus_rc_read(&rc);
 
-		time_current = get_sys_time_ms();
-		if(time_current - time_last > 100.0f) {
+		time_current = get_time_us();
+		if(time_current - time_last > 100000) {
 			led_toggle(LED_R);
 			time_last = time_current;
 		}
@@ -91,7 +91,7 @@ bool rc_unlock_geasture_handler(radio_t *rc, float *accel_lpf)
 
 		float accel_translational = accel_norm - 9.78f;
 
-		if(accel_translational < 0.5) {
+		if(accel_translational < 0.5f) {
 			motor_lock = true;
 		}
 	} else {
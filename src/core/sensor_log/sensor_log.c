@@ -0,0 +1,236 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "sys_time.h"
+#include "mpu6500.h"
+#include "ms5611.h"
+#include "optitrack.h"
+#include "vins_mono.h"
+#include "sensor_log.h"
+
+/* binary log of the raw sensor data, the records are written into a ring
+ * buffer by the sensor drivers (from both the tasks and the interrupts) and
+ * drained by the sensor log task. the log can be replayed on the host with
+ * the same driver and estimator code, see host/replay */
+
+enum {
+	SENSOR_LOG_PARSE_WAIT_SYNC,
+	SENSOR_LOG_PARSE_HEADER,
+	SENSOR_LOG_PARSE_PAYLOAD,
+	SENSOR_LOG_PARSE_CHECKSUM
+} SENSOR_LOG_PARSE_STATE;
+
+extern mpu6500_t mpu6500;
+extern ms5611_t ms5611;
+extern optitrack_t optitrack;
+extern vins_mono_t vins_mono;
+
+struct {
+	uint8_t buf[SENSOR_LOG_BUFFER_SIZE];
+	volatile int head; //write position
+	volatile int tail; //read position
+
+	volatile bool running;
+	uint32_t dropped_cnt;
+} sensor_log;
+
+static uint32_t sensor_log_get_time_us(void)
+{
+	/* truncated to 32 bits, wraps around every 71 minutes */
+	return (uint32_t)get_time_us();
+}
+
+static int sensor_log_free_space(void)
+{
+	int used = sensor_log.head - sensor_log.tail;
+	if(used < 0) {
+		used += SENSOR_LOG_BUFFER_SIZE;
+	}
+
+	/* one byte is kept for distinguishing between full and empty */
+	return SENSOR_LOG_BUFFER_SIZE - used - 1;
+}
+
+static void sensor_log_buf_push(uint8_t *data, int size)
+{
+	int i;
+	for(i = 0; i < size; i++) {
+		sensor_log.buf[sensor_log.head] = data[i];
+		sensor_log.head = (sensor_log.head + 1) % SENSOR_LOG_BUFFER_SIZE;
+	}
+}
+
+void sensor_log_write(int type, void *payload, int size)
+{
+	if(sensor_log.running == false || size > SENSOR_LOG_PAYLOAD_MAX) {
+		return;
+	}
+
+	uint8_t header[SENSOR_LOG_HEADER_SIZE];
+	header[0] = SENSOR_LOG_SYNC_BYTE;
+	header[1] = type;
+	header[2] = size;
+
+	uint8_t checksum = header[1] ^ header[2];
+
+	/* the record is written by the drivers from different interrupt
+	 * priorities, the whole record must be pushed at once */
+	UBaseType_t isr_mask = taskENTER_CRITICAL_FROM_ISR();
+
+	uint32_t timestamp_us = sensor_log_get_time_us();
+	memcpy(&header[3], &timestamp_us, sizeof(uint32_t));
+
+	if(sensor_log_free_space() < (SENSOR_LOG_HEADER_SIZE + size + 1)) {
+		/* buffer is full, drop the record instead of breaking the stream */
+		sensor_log.dropped_cnt++;
+		taskEXIT_CRITICAL_FROM_ISR(isr_mask);
+		return;
+	}
+
+	int i;
+	for(i = 3; i < SENSOR_LOG_HEADER_SIZE; i++) {
+		checksum ^= header[i];
+	}
+	for(i = 0; i < size; i++) {
+		checksum ^= ((uint8_t *)payload)[i];
+	}
+
+	sensor_log_buf_push(header, SENSOR_LOG_HEADER_SIZE);
+	sensor_log_buf_push((uint8_t *)payload, size);
+	sensor_log_buf_push(&checksum, 1);
+
+	taskEXIT_CRITICAL_FROM_ISR(isr_mask);
+}
+
+static void sensor_log_write_calibration(void)
+{
+	sensor_log_calibration_t calib = {
+		.imu_init_finished = mpu6500.init_finished,
+		.gyro_bias = {mpu6500.gyro_bias[0], mpu6500.gyro_bias[1], mpu6500.gyro_bias[2]},
+		.accel_scale = mpu6500.accel_scale,
+		.gyro_scale = mpu6500.gyro_scale,
+		.accel_rescale = {mpu6500.accel_rescale_x, mpu6500.accel_rescale_y,
+		                  mpu6500.accel_rescale_z
+		                 },
+		.accel_bias = {mpu6500.accel_bias[0], mpu6500.accel_bias[1], mpu6500.accel_bias[2]},
+		.barometer_init_finished = ms5611.init_finished,
+		.barometer_prom = {ms5611.c1, ms5611.c2, ms5611.c3, ms5611.c4, ms5611.c5, ms5611.c6},
+		.press_lpf = ms5611.press_lpf,
+		.press_sea_level = ms5611.press_sea_level,
+		.optitrack_id = optitrack.id,
+		.vins_mono_id = vins_mono.id
+	};
+
+	sensor_log_write(SENSOR_LOG_CALIBRATION, &calib, sizeof(calib));
+}
+
+void sensor_log_start(void)
+{
+	if(sensor_log.running == true) {
+		return;
+	}
+
+	sensor_log.running = true;
+	sensor_log_write_calibration();
+}
+
+void sensor_log_stop(void)
+{
+	sensor_log.running = false;
+}
+
+bool sensor_log_is_running(void)
+{
+	return sensor_log.running;
+}
+
+/* pop up to size bytes from the log buffer, return the number of bytes */
+int sensor_log_read(uint8_t *buf, int size)
+{
+	int read_cnt = 0;
+
+	/* only the head is modified by the writers */
+	int head = sensor_log.head;
+	while(sensor_log.tail != head && read_cnt < size) {
+		buf[read_cnt] = sensor_log.buf[sensor_log.tail];
+		sensor_log.tail = (sensor_log.tail + 1) % SENSOR_LOG_BUFFER_SIZE;
+		read_cnt++;
+	}
+
+	return read_cnt;
+}
+
+uint32_t sensor_log_get_dropped_cnt(void)
+{
+	return sensor_log.dropped_cnt;
+}
+
+void sensor_log_parser_init(sensor_log_parser_t *parser)
+{
+	parser->state = SENSOR_LOG_PARSE_WAIT_SYNC;
+	parser->recept_cnt = 0;
+	parser->error_cnt = 0;
+}
+
+/* feed one byte into the parser, return true if a complete record is
+ * received (saved in parser->record) */
+bool sensor_log_parse(sensor_log_parser_t *parser, uint8_t c)
+{
+	sensor_log_record_t *record = &parser->record;
+
+	switch(parser->state) {
+	case SENSOR_LOG_PARSE_WAIT_SYNC:
+		if(c == SENSOR_LOG_SYNC_BYTE) {
+			parser->header[0] = c;
+			parser->recept_cnt = 1;
+			parser->checksum = 0;
+			parser->state = SENSOR_LOG_PARSE_HEADER;
+		}
+		break;
+	case SENSOR_LOG_PARSE_HEADER:
+		parser->header[parser->recept_cnt] = c;
+		parser->checksum ^= c;
+		parser->recept_cnt++;
+
+		if(parser->recept_cnt < SENSOR_LOG_HEADER_SIZE) {
+			break;
+		}
+
+		record->type = parser->header[1];
+		record->size = parser->header[2];
+		memcpy(&record->timestamp_us, &parser->header[3], sizeof(uint32_t));
+
+		if(record->type >= SENSOR_LOG_TYPE_MAX || record->size > SENSOR_LOG_PAYLOAD_MAX) {
+			parser->error_cnt++;
+			parser->state = SENSOR_LOG_PARSE_WAIT_SYNC;
+			break;
+		}
+
+		parser->recept_cnt = 0;
+		parser->state = (record->size > 0) ? SENSOR_LOG_PARSE_PAYLOAD :
+		                SENSOR_LOG_PARSE_CHECKSUM;
+		break;
+	case SENSOR_LOG_PARSE_PAYLOAD:
+		record->payload[parser->recept_cnt] = c;
+		parser->checksum ^= c;
+		parser->recept_cnt++;
+
+		if(parser->recept_cnt == record->size) {
+			parser->state = SENSOR_LOG_PARSE_CHECKSUM;
+		}
+		break;
+	case SENSOR_LOG_PARSE_CHECKSUM:
+		parser->state = SENSOR_LOG_PARSE_WAIT_SYNC;
+
+		if(c != parser->checksum) {
+			parser->error_cnt++;
+			return false;
+		}
+
+		return true;
+	}
+
+	return false;
+}
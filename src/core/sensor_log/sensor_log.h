@@ -0,0 +1,109 @@
+#ifndef __SENSOR_LOG_H__
+#define __SENSOR_LOG_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* sensor log record format (little endian):
+   +-----+------+-------------+----------------+---------+----------+
+   | '$' | type | payload len | timestamp [us] | payload | checksum |
+   +-----+------+-------------+----------------+---------+----------+
+   |  1  |  1   |      1      |       4        |  0~255  |    1     |
+   +-----+------+-------------+----------------+---------+----------+
+   the checksum is the xor of type, payload length, timestamp and payload */
+
+#define SENSOR_LOG_SYNC_BYTE     '$'
+#define SENSOR_LOG_HEADER_SIZE   7
+#define SENSOR_LOG_PAYLOAD_MAX   96
+#define SENSOR_LOG_RECORD_MAX    (SENSOR_LOG_HEADER_SIZE + SENSOR_LOG_PAYLOAD_MAX + 1)
+
+#define SENSOR_LOG_BUFFER_SIZE   8192
+
+enum {
+	SENSOR_LOG_CALIBRATION = 0,
+	SENSOR_LOG_IMU = 1,
+	SENSOR_LOG_COMPASS = 2,
+	SENSOR_LOG_BAROMETER = 3,
+	SENSOR_LOG_GPS = 4,
+	SENSOR_LOG_OPTITRACK = 5,
+	SENSOR_LOG_VINS_MONO = 6,
+	SENSOR_LOG_TYPE_CNT
+} SENSOR_LOG_TYPE;
+
+/* the flight log (see flight_log.h) shares the record format, its types are
+ * placed after the sensor log ones */
+#define SENSOR_LOG_TYPE_MAX 64
+
+/* driver states required for reproducing the sensor data, written as the
+ * first record of each log */
+typedef struct __attribute__((packed)) {
+	/* mpu6500 */
+	uint8_t imu_init_finished;
+	int16_t gyro_bias[3];
+	float accel_scale;
+	float gyro_scale;
+	float accel_rescale[3];
+	float accel_bias[3];
+
+	/* ms5611 */
+	uint8_t barometer_init_finished;
+	uint16_t barometer_prom[6];
+	float press_lpf;
+	float press_sea_level;
+
+	/* optitrack and vins-mono tracker id */
+	uint8_t optitrack_id;
+	uint8_t vins_mono_id;
+} sensor_log_calibration_t;
+
+/* unscaled mpu6500 readings in the body frame, before the bias cancellation */
+typedef struct __attribute__((packed)) {
+	int16_t accel[3];
+	int16_t gyro[3];
+	int16_t temp;
+} sensor_log_imu_t;
+
+/* unscaled ist8310 readings */
+typedef struct __attribute__((packed)) {
+	int16_t mag[3];
+} sensor_log_compass_t;
+
+/* ms5611 d1 (pressure) and d2 (temperature) conversion results */
+typedef struct __attribute__((packed)) {
+	int32_t d1;
+	int32_t d2;
+} sensor_log_barometer_t;
+
+/* gps: ubx nav-pvt payload (92 bytes), optitrack and vins-mono: the whole
+ * serial message, all are logged after the checksum validation */
+
+typedef struct {
+	uint8_t type;
+	uint8_t size;
+	uint32_t timestamp_us;
+	uint8_t payload[SENSOR_LOG_PAYLOAD_MAX];
+} sensor_log_record_t;
+
+typedef struct {
+	int state;
+	int recept_cnt;
+	uint8_t checksum;
+	uint8_t header[SENSOR_LOG_HEADER_SIZE];
+	sensor_log_record_t record;
+
+	uint32_t error_cnt;
+} sensor_log_parser_t;
+
+void sensor_log_start(void);
+void sensor_log_stop(void);
+bool sensor_log_is_running(void);
+
+void sensor_log_write(int type, void *payload, int size);
+
+int sensor_log_read(uint8_t *buf, int size);
+uint32_t sensor_log_get_dropped_cnt(void);
+
+void sensor_log_parser_init(sensor_log_parser_t *parser);
+bool sensor_log_parse(sensor_log_parser_t *parser, uint8_t c);
+
+#endif
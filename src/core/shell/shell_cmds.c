@@ -9,6 +9,7 @@
 #include "autopilot.h"
 #include "perf.h"
 #include "perf_list.h"
+#include "task_stats.h"
 #include "sys_param.h"
 #include "imu.h"
 #include "delay.h"
@@ -41,7 +42,7 @@ void shell_cmd_help(char param_list[PARAM_LIST_SIZE_MAX][PARAM_LEN_MAX], int par
 	          "accel_calib\n\r"
 	          "motor_calib\n\r"
 	          "motor_test\n\r"
-	          "perf\n\r"
+	          "perf, top\n\r"
 	          "params\n\r";
 	shell_puts(s);
 }
@@ -176,9 +177,9 @@ void shell_cmd_fly(char param_list[PARAM_LIST_SIZE_MAX][PARAM_LEN_MAX], int para
 		}
 
 		sprintf(s, "east-north-up waypoint (x, y, z) = (%fm, %fm, %fm)\n\r",
-		        pos[0], pos[1], pos[2]);
+		        (double)pos[0], (double)pos[1], (double)pos[2]);
 	} else if(param_cnt == 3) {
-		sprintf(s, "east-north-up waypoint (x, y) = (%fm, %fm)\n\r", pos[0], pos[1]);
+		sprintf(s, "east-north-up waypoint (x, y) = (%fm, %fm)\n\r", (double)pos[0], (double)pos[1]);
 	}
 	shell_puts(s);
 
@@ -235,7 +236,8 @@ static void mission_add_cmd_handler(char param_list[PARAM_LIST_SIZE_MAX][PARAM_L
 	char s[200] = {'\0'};
 	sprintf(s, "new waypoint: x=%.1fm, y=%.1fm, z=%.1fm, heading=%.1f, "
 	        "stay_time=%.1f, radius=%.1fm\n\r",
-	        pos[0], pos[1], pos[2], heading, stay_time_sec, radius);
+	        (double)pos[0], (double)pos[1], (double)pos[2], (double)heading,
+	        (double)stay_time_sec, (double)radius);
 	shell_puts(s);
 
 	char user_agree[CMD_LEN_MAX];
@@ -465,7 +467,7 @@ void shell_cmd_accel(char param_list[PARAM_LIST_SIZE_MAX][PARAM_LEN_MAX], int pa
 
 void shell_cmd_perf(char param_list[PARAM_LIST_SIZE_MAX][PARAM_LEN_MAX], int param_cnt)
 {
-	char s[100];
+	char s[150];
 	shell_puts("performance analysis:\n\r---------------------\n\r");
 
 	float flight_control_trigger_time = perf_get_time_s(PERF_FLIGHT_CONTROL_TRIGGER_TIME);
@@ -477,18 +479,120 @@ void shell_cmd_perf(char param_list[PARAM_LIST_SIZE_MAX][PARAM_LEN_MAX], int par
 	float flight_loop_cpu_percentage = flight_loop_time / flight_control_trigger_time * 100;
 
 	sprintf(s, "[flight controller task] executing frequency: %.0fHz\n\r",
-	        1.0 / flight_control_trigger_time);
+	        (double)(1.0f / flight_control_trigger_time));
 	shell_puts(s);
 
 	sprintf(s, "* [AHRS] %.2fms (%.0f%%)\n\r",
-	        ahrs_time * 1000.0f, ahrs_cpu_percentage);
+	        (double)(ahrs_time * 1000.0f), (double)ahrs_cpu_percentage);
 	shell_puts(s);
 	sprintf(s, "* [controller] %.2fms (%.0f%%)\n\r",
-	        controller_time * 1000.0f, controller_cpu_percentage);
+	        (double)(controller_time * 1000.0f), (double)controller_cpu_percentage);
+	shell_puts(s);
+	sprintf(s, "* [total] %.2fms (%.0f%%)\n\r\n\r",
+	        (double)(flight_loop_time * 1000.0f), (double)flight_loop_cpu_percentage);
+	shell_puts(s);
+
+	/* statistics since boot, in microseconds (cpu cycles) */
+	sprintf(s, "%-28s %16s %16s %16s %16s\n\r",
+	        "[us (cycles)]", "last", "mean", "min", "max");
+	shell_puts(s);
+
+	int i;
+	for(i = 0; i < perf_get_list_size(); i++) {
+		uint32_t last = perf_get_last_cycles(i);
+		float mean = perf_get_mean_cycles(i);
+		uint32_t min = perf_get_min_cycles(i);
+		uint32_t max = perf_get_max_cycles(i);
+
+		sprintf(s, "%-28s %7.1f (%6lu) %7.1f (%6.0f) %7.1f (%6lu) %7.1f (%6lu)\n\r",
+		        perf_get_name(i),
+		        (double)perf_cycles_to_us(last), (unsigned long)last,
+		        (double)perf_cycles_to_us(mean), (double)mean,
+		        (double)perf_cycles_to_us(min), (unsigned long)min,
+		        (double)perf_cycles_to_us(max), (unsigned long)max);
+		shell_puts(s);
+	}
+
+	/* latency histograms and deadline misses */
+	for(i = 0; i < perf_get_list_size(); i++) {
+		if(perf_has_histogram(i) == false) {
+			continue;
+		}
+
+		unsigned long bucket_us = perf_get_bucket_us(i);
+
+		sprintf(s, "\n\r[%s] count: %lu, p50: %.1fus, p99: %.1fus, max: %.1fus",
+		        perf_get_name(i), (unsigned long)perf_get_count(i),
+		        (double)perf_get_percentile_us(i, 50.0f), (double)perf_get_percentile_us(i, 99.0f),
+		        (double)perf_cycles_to_us(perf_get_max_cycles(i)));
+		shell_puts(s);
+
+		if(perf_get_deadline_us(i) > 0) {
+			sprintf(s, ", deadline misses (>%luus): %lu",
+			        (unsigned long)perf_get_deadline_us(i),
+			        (unsigned long)perf_get_deadline_miss_cnt(i));
+			shell_puts(s);
+		}
+		shell_puts("\n\r");
+
+		int j;
+		for(j = 0; j < PERF_HIST_BUCKETS; j++) {
+			uint32_t cnt = perf_get_bucket_cnt(i, j);
+			if(cnt == 0) {
+				continue;
+			}
+
+			if(j == PERF_HIST_BUCKETS - 1) {
+				sprintf(s, "  %5lu~      us: %lu\n\r", j * bucket_us, (unsigned long)cnt);
+			} else {
+				sprintf(s, "  %5lu~%5luus: %lu\n\r", j * bucket_us, (j + 1) * bucket_us,
+				        (unsigned long)cnt);
+			}
+			shell_puts(s);
+		}
+	}
+}
+
+void shell_cmd_top(char param_list[PARAM_LIST_SIZE_MAX][PARAM_LEN_MAX], int param_cnt)
+{
+	char s[150];
+	const char task_state_c[] = {'X', 'R', 'B', 'S', 'D', '?'}; //see eTaskState
+
+	int task_cnt = task_stats_get_task_cnt();
+	if(task_cnt == 0) {
+		shell_puts("task statistics are not ready.\n\r");
+		return;
+	}
+
+	sprintf(s, "task statistics of the last %.1fs, budget and time are per 2.5ms frame:\n\r",
+	        (double)task_stats_get_window_time_s());
 	shell_puts(s);
-	sprintf(s, "* [total] %.2fms (%.0f%%)\n\r",
-	        flight_loop_time * 1000.0f, flight_loop_cpu_percentage);
+
+	sprintf(s, "%-20s %4s %5s %7s %10s %10s %10s %s\n\r",
+	        "task", "prio", "state", "cpu", "time", "budget", "stack free", "");
 	shell_puts(s);
+
+	int i;
+	for(i = 0; i < task_cnt; i++) {
+		task_stats_t *stats = task_stats_get(i);
+
+		int state = stats->state;
+		if(state < 0 || state > eInvalid) {
+			state = eInvalid;
+		}
+
+		char budget_s[20] = "-";
+		if(stats->budget_us > 0.0f) {
+			sprintf(budget_s, "%.1fus", (double)stats->budget_us);
+		}
+
+		sprintf(s, "%-20s %4lu %5c %6.1f%% %8.1fus %10s %4u words %s\n\r",
+		        stats->name, (unsigned long)stats->priority, task_state_c[state],
+		        (double)stats->cpu_percentage, (double)stats->frame_time_us, budget_s,
+		        (unsigned int)stats->stack_free,
+		        stats->over_budget ? "[over budget]" : "");
+		shell_puts(s);
+	}
 }
 
 static void param_list_cmd_handler(char param_list[PARAM_LIST_SIZE_MAX][PARAM_LEN_MAX])
@@ -558,7 +662,7 @@ static void param_list_cmd_handler(char param_list[PARAM_LIST_SIZE_MAX][PARAM_LE
 			type_s = SYS_PARAM_TYPE_TO_STRING(SYS_PARAM_FLOAT);
 			get_sys_param_float(i, &f);
 			sprintf(s, "[#%d][%s][%s][%.2f]\n\r",
-			        i, name, type_s, f);
+			        i, name, type_s, (double)f);
 			break;
 		default:
 			sprintf(s, "[#%d][%s][unknown type %d]\n\r",
@@ -649,7 +753,7 @@ void shell_cmd_compass(char param_list[PARAM_LIST_SIZE_MAX][PARAM_LEN_MAX], int
 		update_freq = get_compass_update_rate();
 
 		sprintf(s, "[%.0fHz] compass x:%.0f, y:%.0f, z:%.0f\n\r",
-		        update_freq, mag[0], mag[1], mag[2]);
+		        (double)update_freq, (double)mag[0], (double)mag[1], (double)mag[2]);
 		shell_puts(s);
 
 		freertos_task_delay(1000);
@@ -696,7 +800,7 @@ void shell_cmd_motor_test(char param_list[PARAM_LIST_SIZE_MAX][PARAM_LEN_MAX], i
 	while(1) {
 		curr_motor_signal = get_motor_force_testing_percentage();
 
-		sprintf(s, "current control signal is %.2f%%\n\r", curr_motor_signal * 100.0f);
+		sprintf(s, "current control signal is %.2f%%\n\r", (double)(curr_motor_signal * 100.0f));
 		shell_puts(s);
 
 		shell_init_struct(&shell, "please enter new command (0~100): ", ret_str);
@@ -43,13 +43,16 @@ struct {
 
 void ahrs_init(void)
 {
-	complementary_ahrs_init(0.0025);
+	complementary_ahrs_init(0.0025f);
 
-	madgwick_init(&madgwick_ahrs, 400, 0.13);
+	madgwick_init(&madgwick_ahrs, 400, 0.13f);
 
-	eskf_ahrs_init(0.0025);
+	eskf_ahrs_init(0.0025f);
 
-	optitrack_ahrs_init(0.0025);
+	optitrack_ahrs_init(0.0025f);
+
+	/* drop the imu samples queued before the initialization */
+	imu_sample_flush();
 
 	switch(SELECT_HEADING_SENSOR) {
 	case HEADING_FUSION_USE_COMPASS:
@@ -119,7 +122,7 @@ void ahrs_gyro_integration(float *q, float *gyro, float time)
 	arm_sqrt_f32((w[0]*w[0]) + (w[1]*w[1]) + (w[2]*w[2]), &w_norm);
 
 	/* reciprocal of w_norm is unstable when w_norm is ~0 */
-	if(w_norm > 1.0e-12) {
+	if(w_norm > 1.0e-12f) {
 		float q_last[4];
 		quaternion_copy(q_last, q);
 
@@ -270,7 +273,7 @@ bool ahrs_compass_quality_test(float *mag_new)
 	quaternion_mult(q_ahrs_i2b, q_mag_b2i, q_diff);
 
 	//get euler principal axis agnle of q_mag minus q_ahrs
-	compass_ahrs_yaw_diff = rad_to_deg(acos(q_diff[0]));
+	compass_ahrs_yaw_diff = rad_to_deg(acosf(q_diff[0]));
 
 	if(compass_ahrs_yaw_diff > 45) {
 		last_failed_time = get_sys_time_s();
@@ -284,7 +287,7 @@ bool ahrs_compass_quality_test(float *mag_new)
 	float q1 = q_mag_i2b[1];
 	float q2 = q_mag_i2b[2];
 	float q3 = q_mag_i2b[3];
-	compass_quality_debug.compass_yaw = rad_to_deg(atan2(2.0*(q0*q3 + q1*q2), 1.0-2.0*(q2*q2 + q3*q3)));
+	compass_quality_debug.compass_yaw = rad_to_deg(atan2f(2.0f*(q0*q3 + q1*q2), 1.0f-2.0f*(q2*q2 + q3*q3)));
 
 	compass_quality_debug.ahrs_yaw = yaw;
 #endif
@@ -295,17 +298,38 @@ bool ahrs_compass_quality_test(float *mag_new)
 	return compass_is_stable;
 }
 
+/* mean angular rate [rad/s] of the interval since the last estimation, the samples
+ * are integrated with 1KHz and read with 400Hz (see imu_read_increments()). the
+ * latest sample is used if the queue is empty */
+static void ahrs_read_gyro(float *gyro_rad)
+{
+	float delta_angle[3], delta_vel[3], dt;
+	if(imu_read_increments(delta_angle, delta_vel, &dt) == false) {
+		float gyro[3];
+		get_gyro_lpf(gyro);
+		gyro_rad[0] = deg_to_rad(gyro[0]);
+		gyro_rad[1] = deg_to_rad(gyro[1]);
+		gyro_rad[2] = deg_to_rad(gyro[2]);
+		return;
+	}
+
+	float div_dt = 1.0f / dt;
+	gyro_rad[0] = delta_angle[0] * div_dt;
+	gyro_rad[1] = delta_angle[1] * div_dt;
+	gyro_rad[2] = delta_angle[2] * div_dt;
+}
+
 void ahrs_estimate(attitude_t *attitude)
 {
 	static bool compass_init = false;
 
 	float accel[3];
-	float gyro[3];
+	float gyro_rad[3];
 	float mag[3];
 
 	/* read imu data (update with 1KHz, read with 400Hz) */
 	get_accel_lpf(accel);
-	get_gyro_lpf(gyro);
+	ahrs_read_gyro(gyro_rad);
 
 	/* note that acceleromter senses the negative gravity acceleration (normal force)
 	 * a_imu = (R(phi, theta, psi) * a_translation) - (R(phi, theta, psi) * g) */
@@ -314,11 +338,6 @@ void ahrs_estimate(attitude_t *attitude)
 	gravity[1] = -accel[1];
 	gravity[2] = -accel[2];
 
-	float gyro_rad[3];
-	gyro_rad[0] = deg_to_rad(gyro[0]);
-	gyro_rad[1] = deg_to_rad(gyro[1]);
-	gyro_rad[2] = deg_to_rad(gyro[2]);
-
 	/* check compass data is availabe or not */
 	bool recvd_compass = ins_compass_sync_buffer_available();
 	if(recvd_compass == true) {
@@ -12,7 +12,7 @@
  * Keeping a Good Attitude: A Quaternion-Based Orientation Filter for IMUs and MARGs
  * by Roberto G. Valenti, Ivan Dryanovski and Jizhong Xiao */
 
-const float sqrt_2 = sqrt(2);
+const float sqrt_2 = 1.41421356f;
 
 MAT_ALLOC(q, 4, 1);
 MAT_ALLOC(R_gyro, 3, 3);
@@ -177,7 +177,7 @@ void ahrs_imu_complementary_filter_estimate(float *q_out, float *accel, float *g
 	quaternion_mult(w, mat_data(q), q_dot);
 
 	float q_gyro[4];
-	float half_dt = -0.5 * comp_ahrs_dt;
+	float half_dt = -0.5f * comp_ahrs_dt;
 	q_gyro[0] = mat_data(q)[0] + (q_dot[0] * half_dt);
 	q_gyro[1] = mat_data(q)[1] + (q_dot[1] * half_dt);
 	q_gyro[2] = mat_data(q)[2] + (q_dot[2] * half_dt);
@@ -228,7 +228,7 @@ void ahrs_marg_complementary_filter_estimate(float *q_out, float *accel, float *
 	quaternion_mult(w, mat_data(q), q_dot);
 
 	float q_gyro[4];
-	float half_dt = -0.5 * comp_ahrs_dt;
+	float half_dt = -0.5f * comp_ahrs_dt;
 	q_gyro[0] = mat_data(q)[0] + (q_dot[0] * half_dt);
 	q_gyro[1] = mat_data(q)[1] + (q_dot[1] * half_dt);
 	q_gyro[2] = mat_data(q)[2] + (q_dot[2] * half_dt);
@@ -8,8 +8,9 @@
 #include "comp_ahrs.h"
 #include "compass.h"
 #include "imu.h"
+#include "proj_config.h"
 
-#define ESKF_RESCALE(number) (number * 10e7) //to improve the numerical stability
+#define ESKF_RESCALE(number) ((number) * 10e7f) //to improve the numerical stability
 
 MAT_ALLOC(x_nominal, 4, 1);     //x = [q0; q1; q2; q3]
 MAT_ALLOC(x_error_state, 3, 1); //delta_x = [theta_x; theta_y; theta_z]
@@ -55,10 +56,122 @@ MAT_ALLOC(mag_resid, 3, 1);
 float eskf_dt;
 float eskf_half_dt;
 
+static int eskf_ahrs_update_mode = SELECT_ESKF_AHRS_UPDATE;
+
+void eskf_ahrs_set_update_mode(int mode)
+{
+	eskf_ahrs_update_mode = mode;
+}
+
+/* process the measurement components one by one as scalar updates instead of inverting
+ * (H*P*Ht + V), the measurement noises are uncorrelated so the result is the same */
+static void eskf_ahrs_sequential_update(float *H, float *resid, float *V)
+{
+	float *P = mat_data(P_prior);
+	float *delta_x = mat_data(x_error_state);
+	float PHt[3];
+	int r, c, i;
+
+	matrix_reset(delta_x, 3, 1);
+
+	for(i = 0; i < 3; i++) {
+		float *h = &H[i*3];
+
+		//P * Ht
+		PHt[0] = P[0*3 + 0]*h[0] + P[0*3 + 1]*h[1] + P[0*3 + 2]*h[2];
+		PHt[1] = P[1*3 + 0]*h[0] + P[1*3 + 1]*h[1] + P[1*3 + 2]*h[2];
+		PHt[2] = P[2*3 + 0]*h[0] + P[2*3 + 1]*h[1] + P[2*3 + 2]*h[2];
+
+		//H * P * Ht + V
+		float div_HPHt_V = 1.0f / (h[0]*PHt[0] + h[1]*PHt[1] + h[2]*PHt[2] + V[i*3 + i]);
+
+		//delta_x = delta_x + K * (resid - H * delta_x)
+		float innovation = resid[i] - (h[0]*delta_x[0] + h[1]*delta_x[1] + h[2]*delta_x[2]);
+		for(r = 0; r < 3; r++) {
+			delta_x[r] += PHt[r] * innovation * div_HPHt_V;
+		}
+
+		//P = P - K * (P * Ht)'
+		for(r = 0; r < 3; r++) {
+			for(c = 0; c < 3; c++) {
+				P[r*3 + c] -= PHt[r] * PHt[c] * div_HPHt_V;
+			}
+		}
+	}
+
+	memcpy(mat_data(P_post), mat_data(P_prior), sizeof(float) * 9);
+}
+
+static void eskf_ahrs_accelerometer_batch_update(void)
+{
+	/* calculate kalman gain */
+	//K = P * Ht * inv(H*P*Ht + V)
+	MAT_TRANS(&H_accel, &H_accel_t);
+	MAT_MULT(&P_prior, &H_accel_t, &PHt_accel);
+	MAT_MULT(&H_accel, &PHt_accel, &HPHt_accel);
+	MAT_ADD(&HPHt_accel, &V_accel, &HPHt_V_accel);
+	MAT_INV(&HPHt_V_accel, &HPHt_V_accel_inv);
+	MAT_MULT(&PHt_accel, &HPHt_V_accel_inv, &K_accel);
+
+	/* calculate error state residual */
+	//delta_x = K * (y_accel - h_accel)
+	MAT_SUB(&y_accel, &h_accel, &accel_resid);
+	MAT_MULT(&K_accel, &accel_resid, &x_error_state);
+
+	/* calculate a posteriori process covariance matrix */
+	//P = (I - K*H) * P
+	MAT_MULT(&K_accel, &H_accel, &KH_accel);
+	mat_data(I_KH_accel)[0*3 + 0] = 1.0f - mat_data(KH_accel)[0*3 + 0];
+	mat_data(I_KH_accel)[0*3 + 1] =        mat_data(KH_accel)[0*3 + 1];
+	mat_data(I_KH_accel)[0*3 + 2] =        mat_data(KH_accel)[0*3 + 2];
+
+	mat_data(I_KH_accel)[1*3 + 0] =        mat_data(KH_accel)[1*3 + 0];
+	mat_data(I_KH_accel)[1*3 + 1] = 1.0f - mat_data(KH_accel)[1*3 + 1];
+	mat_data(I_KH_accel)[1*3 + 2] =        mat_data(KH_accel)[1*3 + 2];
+
+	mat_data(I_KH_accel)[2*3 + 0] =        mat_data(KH_accel)[2*3 + 0];
+	mat_data(I_KH_accel)[2*3 + 1] =        mat_data(KH_accel)[2*3 + 1];
+	mat_data(I_KH_accel)[2*3 + 2] = 1.0f - mat_data(KH_accel)[2*3 + 2];
+	MAT_MULT(&I_KH_accel, &P_prior, &P_post);
+}
+
+static void eskf_ahrs_magnetometer_batch_update(void)
+{
+	/* calculate kalman gain */
+	//K = P * Ht * inv(H*P*Ht + V)
+	MAT_TRANS(&H_mag, &H_mag_t);
+	MAT_MULT(&P_prior, &H_mag_t, &PHt_mag);
+	MAT_MULT(&H_mag, &PHt_mag, &HPHt_mag);
+	MAT_ADD(&HPHt_mag, &V_mag, &HPHt_V_mag);
+	MAT_INV(&HPHt_V_mag, &HPHt_V_mag_inv);
+	MAT_MULT(&PHt_mag, &HPHt_V_mag_inv, &K_mag);
+
+	/* calculate error state residual */
+	//delta_x = K * (y_mag - h_mag)
+	MAT_SUB(&y_mag, &h_mag, &mag_resid);
+	MAT_MULT(&K_mag, &mag_resid, &x_error_state);
+
+	/* calculate a posteriori process covariance matrix */
+	//P = (I - K*H) * P
+	MAT_MULT(&K_mag, &H_mag, &KH_mag);
+	mat_data(I_KH_mag)[0*3 + 0] = 1.0f - mat_data(KH_mag)[0*3 + 0];
+	mat_data(I_KH_mag)[0*3 + 1] =        mat_data(KH_mag)[0*3 + 1];
+	mat_data(I_KH_mag)[0*3 + 2] =        mat_data(KH_mag)[0*3 + 2];
+
+	mat_data(I_KH_mag)[1*3 + 0] =        mat_data(KH_mag)[1*3 + 0];
+	mat_data(I_KH_mag)[1*3 + 1] = 1.0f - mat_data(KH_mag)[1*3 + 1];
+	mat_data(I_KH_mag)[1*3 + 2] =        mat_data(KH_mag)[1*3 + 2];
+
+	mat_data(I_KH_mag)[2*3 + 0] =        mat_data(KH_mag)[2*3 + 0];
+	mat_data(I_KH_mag)[2*3 + 1] =        mat_data(KH_mag)[2*3 + 1];
+	mat_data(I_KH_mag)[2*3 + 2] = 1.0f - mat_data(KH_mag)[2*3 + 2];
+	MAT_MULT(&I_KH_mag, &P_prior, &P_post);
+}
+
 void eskf_ahrs_init(float dt)
 {
 	eskf_dt = dt;
-	eskf_half_dt = 0.5 * dt;
+	eskf_half_dt = 0.5f * dt;
 
 	MAT_INIT(x_nominal, 4, 1);
 	MAT_INIT(x_error_state, 3, 1);
@@ -108,17 +221,17 @@ void eskf_ahrs_init(float dt)
 	mat_data(x_nominal)[3] = 0.0f;
 
 	/* initialize Q_i matrix */
-	mat_data(Q_i)[0*3 + 0] = ESKF_RESCALE(1e-5);
+	mat_data(Q_i)[0*3 + 0] = ESKF_RESCALE(1e-5f);
 	mat_data(Q_i)[0*3 + 1] = 0.0f;
 	mat_data(Q_i)[0*3 + 2] = 0.0f;
 
 	mat_data(Q_i)[1*3 + 0] = 0.0f;
-	mat_data(Q_i)[1*3 + 1] = ESKF_RESCALE(1e-5);
+	mat_data(Q_i)[1*3 + 1] = ESKF_RESCALE(1e-5f);
 	mat_data(Q_i)[1*3 + 2] = 0.0f;
 
 	mat_data(Q_i)[2*3 + 0] = 0.0f;
 	mat_data(Q_i)[2*3 + 1] = 0.0f;
-	mat_data(Q_i)[2*3 + 2] = ESKF_RESCALE(1e-5);
+	mat_data(Q_i)[2*3 + 2] = ESKF_RESCALE(1e-5f);
 
 	/* initialize P matrix */
 	mat_data(P_post)[0*3 + 0] = ESKF_RESCALE(5.0f);
@@ -134,30 +247,30 @@ void eskf_ahrs_init(float dt)
 	mat_data(P_post)[2*3 + 2] = ESKF_RESCALE(5.0f);
 
 	/* initialize V_accel matrix */
-	mat_data(V_accel)[0*3 + 0] = ESKF_RESCALE(7e-1);
+	mat_data(V_accel)[0*3 + 0] = ESKF_RESCALE(7e-1f);
 	mat_data(V_accel)[0*3 + 1] = 0.0f;
 	mat_data(V_accel)[0*3 + 2] = 0.0f;
 
 	mat_data(V_accel)[1*3 + 0] = 0.0f;
-	mat_data(V_accel)[1*3 + 1] = ESKF_RESCALE(7e-1);
+	mat_data(V_accel)[1*3 + 1] = ESKF_RESCALE(7e-1f);
 	mat_data(V_accel)[1*3 + 2] = 0.0f;
 
 	mat_data(V_accel)[2*3 + 0] = 0.0f;
 	mat_data(V_accel)[2*3 + 1] = 0.0f;
-	mat_data(V_accel)[2*3 + 2] = ESKF_RESCALE(7e-1);
+	mat_data(V_accel)[2*3 + 2] = ESKF_RESCALE(7e-1f);
 
 	/* initialize V_mag matrix */
-	mat_data(V_mag)[0*3 + 0] = ESKF_RESCALE(5e-1);
+	mat_data(V_mag)[0*3 + 0] = ESKF_RESCALE(5e-1f);
 	mat_data(V_mag)[0*3 + 1] = 0.0f;
 	mat_data(V_mag)[0*3 + 2] = 0.0f;
 
 	mat_data(V_mag)[1*3 + 0] = 0.0f;
-	mat_data(V_mag)[1*3 + 1] = ESKF_RESCALE(5e-1);
+	mat_data(V_mag)[1*3 + 1] = ESKF_RESCALE(5e-1f);
 	mat_data(V_mag)[1*3 + 2] = 0.0f;
 
 	mat_data(V_mag)[2*3 + 0] = 0.0f;
 	mat_data(V_mag)[2*3 + 1] = 0.0f;
-	mat_data(V_mag)[2*3 + 2] = ESKF_RESCALE(5e-1);
+	mat_data(V_mag)[2*3 + 2] = ESKF_RESCALE(5e-1f);
 
 	int r, c;
 	for(r = 0; r < 3; r++) {
@@ -262,35 +375,13 @@ void eskf_ahrs_accelerometer_correct(float *accel)
 	mat_data(h_accel)[1] = 2 * (q2*q3 + q0*q1);
 	mat_data(h_accel)[2] = q0*q0 - q1*q1 - q2*q2 + q3*q3;
 
-	/* calculate kalman gain */
-	//K = P * Ht * inv(H*P*Ht + V)
-	MAT_TRANS(&H_accel, &H_accel_t);
-	MAT_MULT(&P_prior, &H_accel_t, &PHt_accel);
-	MAT_MULT(&H_accel, &PHt_accel, &HPHt_accel);
-	MAT_ADD(&HPHt_accel, &V_accel, &HPHt_V_accel);
-	MAT_INV(&HPHt_V_accel, &HPHt_V_accel_inv);
-	MAT_MULT(&PHt_accel, &HPHt_V_accel_inv, &K_accel);
-
-	/* calculate error state residual */
-	//delta_x = K * (y_accel - h_accel)
-	MAT_SUB(&y_accel, &h_accel, &accel_resid);
-	MAT_MULT(&K_accel, &accel_resid, &x_error_state);
-
-	/* calculate a posteriori process covariance matrix */
-	//P = (I - K*H) * P
-	MAT_MULT(&K_accel, &H_accel, &KH_accel);
-	mat_data(I_KH_accel)[0*3 + 0] = 1.0f - mat_data(KH_accel)[0*3 + 0];
-	mat_data(I_KH_accel)[0*3 + 1] =        mat_data(KH_accel)[0*3 + 1];
-	mat_data(I_KH_accel)[0*3 + 2] =        mat_data(KH_accel)[0*3 + 2];
-
-	mat_data(I_KH_accel)[1*3 + 0] =        mat_data(KH_accel)[1*3 + 0];
-	mat_data(I_KH_accel)[1*3 + 1] = 1.0f - mat_data(KH_accel)[1*3 + 1];
-	mat_data(I_KH_accel)[1*3 + 2] =        mat_data(KH_accel)[1*3 + 2];
-
-	mat_data(I_KH_accel)[2*3 + 0] =        mat_data(KH_accel)[2*3 + 0];
-	mat_data(I_KH_accel)[2*3 + 1] =        mat_data(KH_accel)[2*3 + 1];
-	mat_data(I_KH_accel)[2*3 + 2] = 1.0f - mat_data(KH_accel)[2*3 + 2];
-	MAT_MULT(&I_KH_accel, &P_prior, &P_post);
+	if(eskf_ahrs_update_mode == ESKF_UPDATE_SEQUENTIAL) {
+		MAT_SUB(&y_accel, &h_accel, &accel_resid);
+		eskf_ahrs_sequential_update(mat_data(H_accel), mat_data(accel_resid),
+		                            mat_data(V_accel));
+	} else {
+		eskf_ahrs_accelerometer_batch_update();
+	}
 
 	/* P_post becoms the P_prior of the magnatometer correction */
 	memcpy(mat_data(P_prior), mat_data(P_post), sizeof(float) * 9);
@@ -298,9 +389,9 @@ void eskf_ahrs_accelerometer_correct(float *accel)
 	/* error state injection */
 	float q_error[4];
 	q_error[0] = 1.0f;
-	q_error[1] = 0.5 * mat_data(x_error_state)[0];
-	q_error[2] = 0.5 * mat_data(x_error_state)[1];
-	q_error[3] = 0.5 * mat_data(x_error_state)[2];
+	q_error[1] = 0.5f * mat_data(x_error_state)[0];
+	q_error[2] = 0.5f * mat_data(x_error_state)[1];
+	q_error[3] = 0.5f * mat_data(x_error_state)[2];
 
 	//x_nominal (a posteriori) = q_error * x_nominal (a priori)
 	float x_last[4];
@@ -322,7 +413,7 @@ void eskf_ahrs_magnetometer_correct(float *mag)
 	float q2 = mat_data(x_nominal)[2];
 	float q3 = mat_data(x_nominal)[3];
 
-	float gamma = sqrt(mag[0]*mag[0] + mag[1]*mag[1]);
+	float gamma = sqrtf(mag[0]*mag[0] + mag[1]*mag[1]);
 
 	/* construct error state observation matrix */
 	mat_data(H_x_mag)[0*4 + 0] = 2*(+gamma*q0 - mag[2]*q2);
@@ -365,42 +456,20 @@ void eskf_ahrs_magnetometer_correct(float *mag)
 	mat_data(h_mag)[1] = 2*gamma*(q1*q2 - q0*q3) + 2*mag[2]*(q2*q3 + q0*q1);
 	mat_data(h_mag)[2] = 2*gamma*(q1*q3 + q0*q2) + mag[2]*(q0*q0 - q1*q1 - q2*q2 + q3*q3);
 
-	/* calculate kalman gain */
-	//K = P * Ht * inv(H*P*Ht + V)
-	MAT_TRANS(&H_mag, &H_mag_t);
-	MAT_MULT(&P_prior, &H_mag_t, &PHt_mag);
-	MAT_MULT(&H_mag, &PHt_mag, &HPHt_mag);
-	MAT_ADD(&HPHt_mag, &V_mag, &HPHt_V_mag);
-	MAT_INV(&HPHt_V_mag, &HPHt_V_mag_inv);
-	MAT_MULT(&PHt_mag, &HPHt_V_mag_inv, &K_mag);
-
-	/* calculate error state residual */
-	//delta_x = K * (y_mag - h_mag)
-	MAT_SUB(&y_mag, &h_mag, &mag_resid);
-	MAT_MULT(&K_mag, &mag_resid, &x_error_state);
-
-	/* calculate a posteriori process covariance matrix */
-	//P = (I - K*H) * P
-	MAT_MULT(&K_mag, &H_mag, &KH_mag);
-	mat_data(I_KH_mag)[0*3 + 0] = 1.0f - mat_data(KH_mag)[0*3 + 0];
-	mat_data(I_KH_mag)[0*3 + 1] =        mat_data(KH_mag)[0*3 + 1];
-	mat_data(I_KH_mag)[0*3 + 2] =        mat_data(KH_mag)[0*3 + 2];
-
-	mat_data(I_KH_mag)[1*3 + 0] =        mat_data(KH_mag)[1*3 + 0];
-	mat_data(I_KH_mag)[1*3 + 1] = 1.0f - mat_data(KH_mag)[1*3 + 1];
-	mat_data(I_KH_mag)[1*3 + 2] =        mat_data(KH_mag)[1*3 + 2];
-
-	mat_data(I_KH_mag)[2*3 + 0] =        mat_data(KH_mag)[2*3 + 0];
-	mat_data(I_KH_mag)[2*3 + 1] =        mat_data(KH_mag)[2*3 + 1];
-	mat_data(I_KH_mag)[2*3 + 2] = 1.0f - mat_data(KH_mag)[2*3 + 2];
-	MAT_MULT(&I_KH_mag, &P_prior, &P_post);
+	if(eskf_ahrs_update_mode == ESKF_UPDATE_SEQUENTIAL) {
+		MAT_SUB(&y_mag, &h_mag, &mag_resid);
+		eskf_ahrs_sequential_update(mat_data(H_mag), mat_data(mag_resid),
+		                            mat_data(V_mag));
+	} else {
+		eskf_ahrs_magnetometer_batch_update();
+	}
 
 	/* error state injection */
 	float q_error[4];
 	q_error[0] = 1.0f;
 	q_error[1] = 0.0f; //0.5 * mat_data(x_error_state)[0];
 	q_error[2] = 0.0f; //0.5 * mat_data(x_error_state)[1];
-	q_error[3] = 0.5 * mat_data(x_error_state)[2];
+	q_error[3] = 0.5f * mat_data(x_error_state)[2];
 
 	//x_nominal (a posteriori) = q_error * x_nominal (a priori)
 	float x_last[4];
@@ -2,6 +2,7 @@
 #define __ESKF_AHRS_H__
 
 void eskf_ahrs_init(float dt);
+void eskf_ahrs_set_update_mode(int mode);
 void eskf_ahrs_predict(float *gyro);
 void eskf_ahrs_accelerometer_correct(float *accel);
 void eskf_ahrs_magnetometer_correct(float *mag);
@@ -38,7 +38,7 @@ void ahrs_optitrack_imu_fuse_estimate(float *q_out, float *gyro)
 	quaternion_mult(w, mat_data(q), q_dot);
 
 	float q_gyro[4];
-	float half_dt = -0.5 * optitrack_ahrs_dt;
+	float half_dt = -0.5f * optitrack_ahrs_dt;
 	q_gyro[0] = mat_data(q)[0] + (q_dot[0] * half_dt);
 	q_gyro[1] = mat_data(q)[1] + (q_dot[1] * half_dt);
 	q_gyro[2] = mat_data(q)[2] + (q_dot[2] * half_dt);
@@ -48,10 +48,10 @@ void get_home_longitude_latitude(float *longitude, float *latitude)
 void longitude_latitude_to_enu(float longitude, float latitude, float height_msl,
                                float *x_enu, float *y_enu, float *z_enu)
 {
-	float sin_lambda = sin(deg_to_rad(longitude));
-	float cos_lambda = cos(deg_to_rad(longitude));
-	float sin_phi = sin(deg_to_rad(latitude));
-	float cos_phi = cos(deg_to_rad(latitude));
+	float sin_lambda = sinf(deg_to_rad(longitude));
+	float cos_lambda = cosf(deg_to_rad(longitude));
+	float sin_phi = sinf(deg_to_rad(latitude));
+	float cos_phi = cosf(deg_to_rad(latitude));
 
 	/* convert geodatic coordinates to earth center earth fixed frame (ecef) */
 	float ecef_now_x = (height_msl + EARTH_RADIUS) * cos_phi * cos_lambda;
@@ -42,10 +42,10 @@ float gps_vy_lpf;
 void ins_init(void)
 {
 	//sampling time = 0.2s (5Hz), cutoff frequency = 10Hz
-	lpf_first_order_init(&gps_px_lpf_gain, 0.2, 1);
-	lpf_first_order_init(&gps_py_lpf_gain, 0.2, 1);
-	lpf_first_order_init(&gps_vx_lpf_gain, 0.2, 1);
-	lpf_first_order_init(&gps_vy_lpf_gain, 0.2, 1);
+	lpf_first_order_init(&gps_px_lpf_gain, 0.2f, 1);
+	lpf_first_order_init(&gps_py_lpf_gain, 0.2f, 1);
+	lpf_first_order_init(&gps_vx_lpf_gain, 0.2f, 1);
+	lpf_first_order_init(&gps_vy_lpf_gain, 0.2f, 1);
 
 	ins_comp_filter_init(INS_LOOP_PERIOD);
 	eskf_ins_init(INS_LOOP_PERIOD);
@@ -167,7 +167,7 @@ void ins_complementary_filter_estimate(float *pos_enu_raw, float *vel_enu_raw,
 	if(recvd_barometer == true) {
 		/* get barometer data from sync buffer */
 		ins_barometer_sync_buffer_pop(&barometer_height,
-		                              &barometer_height_rate);
+		                              &barometer_height_rate, NULL);
 		pos_enu_raw[2] = barometer_height;
 		vel_enu_raw[2] = barometer_height_rate;
 
@@ -179,7 +179,7 @@ void ins_complementary_filter_estimate(float *pos_enu_raw, float *vel_enu_raw,
 		if(recvd_gps == true) {
 			/* get gps data from sync buffer */
 			ins_gps_sync_buffer_pop(&longitude, &latitude, &gps_msl_height,
-			                        &gps_ned_vx, &gps_ned_vy, &gps_ned_vz);
+			                        &gps_ned_vx, &gps_ned_vy, &gps_ned_vz, NULL);
 
 			/* convert gps data from geographic coordinate system to
 			 * enu frame */
@@ -16,102 +16,157 @@
 #include "barometer.h"
 #include "position_state.h"
 #include "vins_mono.h"
+#include "sys_time.h"
+#include "ins_eskf.h"
+#include "ins_eskf_generated.h"
 
-#define ESKF_RESCALE(number) (number * 1e7) //to improve the numerical stability
+#define ESKF_RESCALE(number) ((number) * 1e7f) //to improve the numerical stability
 
 #define R(r, c)             _R.pData[(r * 3) + c]
 #define Rt(r, c)            _Rt.pData[(r * 3) + c]
-#define P_prior(r, c)       _P_prior.pData[(r * 9) + c]
-#define P_post(r, c)        _P_post.pData[(r * 9) + c]
-#define R_am_ab_dt(r, c)    _R_am_ab_dt.pData[(r * 3) + c]
-#define Rt_wm_wb_dt(r, c)   _Rt_wm_wb_dt.pData[(r * 3) + c]
-#define Q_i(r, c)           _Q_i.pData[(r * 6) + c]
-#define K_accel(r, c)       _K_accel.pData[(r * 3) + c]
-#define K_mag(r, c)         _K_mag.pData[(r * 3) + c]
-#define K_gps(r, c)         _K_gps.pData[(r * 4) + c]
-#define K_baro(r, c)        _K_baro.pData[(r * 2) + c]
+#define P_prior(r, c)       _P_prior[SYM_MAT_INDEX(ESKF_INS_STATE_NUM, r, c)]
+#define P_post(r, c)        _P_post[SYM_MAT_INDEX(ESKF_INS_STATE_NUM, r, c)]
+#define Q_i(r, c)           _Q_i.pData[(r * 12) + c]
 #define V_accel(r, c)       _V_accel.pData[(r * 3) + c]
 #define V_mag(r, c)         _V_mag.pData[(r * 3) + c]
 #define V_gps(r, c)         _V_gps.pData[(r * 4) + c]
 #define V_baro(r, c)        _V_baro.pData[(r * 2) + c]
-#define PHt_accel(r, c)     _PHt_accel.pData[(r * 3) + c]
-#define PHt_mag(r, c)       _PHt_mag.pData[(r * 3) + c]
-#define PHt_gps(r, c)       _PHt_gps.pData[(r * 4) + c]
-#define PHt_baro(r, c)      _PHt_baro.pData[(r * 2) + c]
-#define HPHt_V_accel(r, c)  _HPHt_V_accel.pData[(r * 3) + c]
-#define HPHt_V_mag(r, c)    _HPHt_V_mag.pData[(r * 3) + c]
-#define HPHt_V_gps(r, c)    _HPHt_V_gps.pData[(r * 4) + c]
-#define HPHt_V_baro(r, c)   _HPHt_V_baro.pData[(r * 2) + c]
-
-MAT_ALLOC(nominal_state, 10, 1);
-MAT_ALLOC(error_state, 9, 1);
-MAT_ALLOC(_Q_i, 6, 6);
+
+MAT_ALLOC(nominal_state, 16, 1);
+MAT_ALLOC(error_state, ESKF_INS_STATE_NUM, 1);
+MAT_ALLOC(_Q_i, 12, 12);
 MAT_ALLOC(_V_accel, 3, 3);
 MAT_ALLOC(_V_mag, 3, 3);
 MAT_ALLOC(_V_gps, 4, 4);
 MAT_ALLOC(_V_baro, 2, 2);
-MAT_ALLOC(_P_prior, 9, 9);
-MAT_ALLOC(_P_post, 9, 9);
 MAT_ALLOC(_R, 3, 3);
 MAT_ALLOC(_Rt, 3, 3);
-MAT_ALLOC(_R_am_ab_dt, 3, 3);
-MAT_ALLOC(_Rt_wm_wb_dt, 3, 3);
-MAT_ALLOC(_PHt_accel, 9, 3);
-MAT_ALLOC(_PHt_mag, 9, 3);
-MAT_ALLOC(_PHt_gps, 9, 4);
-MAT_ALLOC(_PHt_baro, 9, 2);
-MAT_ALLOC(_HPHt_V_accel, 3, 3);
-MAT_ALLOC(_HPHt_V_mag, 3, 3);
-MAT_ALLOC(_HPHt_V_gps, 4, 4);
-MAT_ALLOC(_HPHt_V_baro, 2, 2);
-MAT_ALLOC(_HPHt_V_accel_inv, 3, 3);
-MAT_ALLOC(_HPHt_V_mag_inv, 3, 3);
-MAT_ALLOC(_HPHt_V_gps_inv, 4, 4);
-MAT_ALLOC(_HPHt_V_baro_inv, 2, 2);
-MAT_ALLOC(_K_accel, 9, 3);
-MAT_ALLOC(_K_mag, 9, 3);
-MAT_ALLOC(_K_gps, 9, 4);
-MAT_ALLOC(_K_baro, 9, 2);
+
+/* the process covariance matrices are symmetric, only the upper triangular
+ * parts are stored and updated */
+float _P_prior[SYM_MAT_SIZE(ESKF_INS_STATE_NUM)];
+float _P_post[SYM_MAT_SIZE(ESKF_INS_STATE_NUM)];
 
 float dt;
 float half_dt;
 float half_dt_squared;
 
+/* bias corrected accelerometer input of the last prediction step */
+static float accel_b_last[3];
+
+/* nominal position and velocity of the past prediction steps */
+typedef struct {
+	uint64_t time_us;
+	float pos[3];
+	float vel[3];
+} eskf_ins_history_t;
+
+static eskf_ins_history_t eskf_ins_history[ESKF_INS_HISTORY_SIZE];
+static int eskf_ins_history_newest;
+static int eskf_ins_history_cnt;
+static int eskf_ins_history_skip_cnt;
+static uint64_t eskf_ins_present_time_us;
+
+static int eskf_ins_update_mode = SELECT_ESKF_INS_UPDATE;
+
+void eskf_ins_set_update_mode(int mode)
+{
+	eskf_ins_update_mode = mode;
+}
+
+/* non-zero element of a measurement matrix row */
+typedef struct {
+	int index;
+	float h;
+} eskf_ins_h_t;
+
+/* error states corrected by the measurements (bit masks), see eskf_ins_scalar_update().
+ * the attitude is left to the accelerometer and the compass (yaw only), the delayed
+ * gps and barometer are not linear enough in it while the velocity error is still large */
+#define ESKF_INS_CORRECT_ALL  0x7fff
+#define ESKF_INS_CORRECT_MAG  ((1 << 8) | (1 << 14))
+#define ESKF_INS_CORRECT_GPS  ((1 << 0) | (1 << 1) | (1 << 3) | (1 << 4) | (0x7 << 9))
+#define ESKF_INS_CORRECT_BARO ((1 << 2) | (1 << 5) | (0x7 << 9))
+
+/* scalar measurement update of the a priori process covariance matrix (in place) and the
+ * error state, h lists the non-zero elements of the measurement matrix row. calling it
+ * once for each measurement component gives the same result as the batch update if the
+ * measurement noises are uncorrelated. the error states not in the corrected mask have no
+ * gain (schmidt), their covariance is kept and only their cross covariance with the
+ * corrected states is reduced, so P stays consistent with the injected error state */
+static inline void eskf_ins_scalar_update(const eskf_ins_h_t *h, int h_cnt, uint32_t corrected,
+                                          float residual, float variance)
+{
+	const int n = ESKF_INS_STATE_NUM;
+	float *delta_x = mat_data(error_state);
+	float PHt[ESKF_INS_STATE_NUM] = {0.0f};
+	int r, c, i;
+
+	/* calculate P * Ht, only the columns of the non-zero elements are read. the column j
+	 * of the packed upper triangle steps by (n - 1 - r) down to the diagonal and continues
+	 * along the row j */
+	for(i = 0; i < h_cnt; i++) {
+		int j = h[i].index;
+		float h_j = h[i].h;
+
+		const float *P_col = &_P_prior[j];
+		for(r = 0; r < j; r++) {
+			PHt[r] += *P_col * h_j;
+			P_col += n - 1 - r;
+		}
+		for(r = j; r < n; r++) {
+			PHt[r] += P_col[r - j] * h_j;
+		}
+	}
+
+	/* calculate (H * P * Ht) + V and the residual left by the previous components */
+	float HPHt_V = variance;
+	float innovation = residual;
+	for(i = 0; i < h_cnt; i++) {
+		HPHt_V += h[i].h * PHt[h[i].index];
+		innovation -= h[i].h * delta_x[h[i].index];
+	}
+	float div_HPHt_V = 1.0f / HPHt_V;
+
+	/* P * Ht of the corrected states */
+	float PHt_corrected[ESKF_INS_STATE_NUM];
+	for(r = 0; r < n; r++) {
+		PHt_corrected[r] = ((corrected >> r) & 1) ? PHt[r] : 0.0f;
+	}
+
+	/* delta_x = delta_x + K * innovation, K = P * Ht / (H * P * Ht + V) */
+	float innovation_gain = innovation * div_HPHt_V;
+	for(r = 0; r < n; r++) {
+		delta_x[r] += PHt_corrected[r] * innovation_gain;
+	}
+
+	/* P = P - K * (P * Ht)' if the row or the column is corrected, only the upper
+	 * triangular part is updated */
+	float *P = _P_prior;
+	for(r = 0; r < n; r++) {
+		float K_r = PHt[r] * div_HPHt_V;
+		const float *PHt_c = ((corrected >> r) & 1) ? PHt : PHt_corrected;
+		for(c = r; c < n; c++) {
+			*P++ -= K_r * PHt_c[c];
+		}
+	}
+}
+
 void eskf_ins_init(float _dt)
 {
 	dt = _dt;
 	half_dt = 0.5f * dt;
 	half_dt_squared = 0.5f * dt * dt;
 
-	MAT_INIT(nominal_state, 10, 1);
-	MAT_INIT(error_state, 9, 1);
-	MAT_INIT(_Q_i, 6, 6);
+	MAT_INIT(nominal_state, 16, 1);
+	MAT_INIT(error_state, ESKF_INS_STATE_NUM, 1);
+	MAT_INIT(_Q_i, 12, 12);
 	MAT_INIT(_V_accel, 3, 3);
 	MAT_INIT(_V_mag, 3, 3);
 	MAT_INIT(_V_gps, 4, 4);
 	MAT_INIT(_V_baro, 2, 2);
-	MAT_INIT(_P_prior, 9, 9);
-	MAT_INIT(_P_post, 9, 9);
 	MAT_INIT(_R, 3, 3);
 	MAT_INIT(_Rt, 3, 3);
-	MAT_INIT(_R_am_ab_dt, 3, 3);
-	MAT_INIT(_Rt_wm_wb_dt, 3, 3);
-	MAT_INIT(_PHt_accel, 9, 3);
-	MAT_INIT(_PHt_mag, 9, 3);
-	MAT_INIT(_PHt_gps, 9, 4);
-	MAT_INIT(_PHt_baro, 9, 2);
-	MAT_INIT(_HPHt_V_accel, 3, 3);
-	MAT_INIT(_HPHt_V_mag, 3, 3);
-	MAT_INIT(_HPHt_V_gps, 4, 4);
-	MAT_INIT(_HPHt_V_baro, 2, 2);
-	MAT_INIT(_HPHt_V_accel_inv, 3, 3);
-	MAT_INIT(_HPHt_V_mag_inv, 3, 3);
-	MAT_INIT(_HPHt_V_gps_inv, 4, 4);
-	MAT_INIT(_HPHt_V_baro_inv, 2, 2);
-	MAT_INIT(_K_accel, 9, 3);
-	MAT_INIT(_K_mag, 9, 3);
-	MAT_INIT(_K_gps, 9, 4);
-	MAT_INIT(_K_baro, 9, 2);
 
 	/* initialize the nominal state */
 	mat_data(nominal_state)[0] = 0.0f; //px
@@ -124,24 +179,36 @@ void eskf_ins_init(float _dt)
 	mat_data(nominal_state)[7] = 0.0f; //q1
 	mat_data(nominal_state)[8] = 0.0f; //q2
 	mat_data(nominal_state)[9] = 0.0f; //q3
+	mat_data(nominal_state)[10] = 0.0f; //accel bias x
+	mat_data(nominal_state)[11] = 0.0f; //accel bias y
+	mat_data(nominal_state)[12] = 0.0f; //accel bias z
+	mat_data(nominal_state)[13] = 0.0f; //gyro bias x
+	mat_data(nominal_state)[14] = 0.0f; //gyro bias y
+	mat_data(nominal_state)[15] = 0.0f; //gyro bias z
 
 	float q_i2b[4];
 	init_ahrs_quaternion_with_accel_and_compass(q_i2b);
 	quaternion_conj(q_i2b, &mat_data(nominal_state)[6]);
 
-	matrix_reset(mat_data(error_state), 9, 1);
+	matrix_reset(mat_data(error_state), ESKF_INS_STATE_NUM, 1);
 
 	/* initialize _Q_i matrix */
-	matrix_reset(mat_data(_Q_i), 6, 6);
-	Q_i(0, 0) = ESKF_RESCALE(1e-5); //Var(ax)
-	Q_i(1, 1) = ESKF_RESCALE(1e-5); //Var(ay)
-	Q_i(2, 2) = ESKF_RESCALE(1e-5); //Var(az)
-	Q_i(3, 3) = ESKF_RESCALE(1e-5); //Var(wx)
-	Q_i(4, 4) = ESKF_RESCALE(1e-5); //Var(wy)
-	Q_i(5, 5) = ESKF_RESCALE(1e-5); //Var(wz)
+	matrix_reset(mat_data(_Q_i), 12, 12);
+	Q_i(0, 0) = ESKF_RESCALE(1e-5f); //Var(ax)
+	Q_i(1, 1) = ESKF_RESCALE(1e-5f); //Var(ay)
+	Q_i(2, 2) = ESKF_RESCALE(1e-5f); //Var(az)
+	Q_i(3, 3) = ESKF_RESCALE(1e-6f); //Var(wx)
+	Q_i(4, 4) = ESKF_RESCALE(1e-6f); //Var(wy)
+	Q_i(5, 5) = ESKF_RESCALE(1e-6f); //Var(wz)
+	Q_i(6, 6) = ESKF_RESCALE(1e-9f); //Var(a_b_x), random walk
+	Q_i(7, 7) = ESKF_RESCALE(1e-9f); //Var(a_b_y), random walk
+	Q_i(8, 8) = ESKF_RESCALE(1e-9f); //Var(a_b_z), random walk
+	Q_i(9, 9) = ESKF_RESCALE(1e-10f); //Var(w_b_x), random walk
+	Q_i(10, 10) = ESKF_RESCALE(1e-10f); //Var(w_b_y), random walk
+	Q_i(11, 11) = ESKF_RESCALE(1e-10f); //Var(w_b_z), random walk
 
 	/* initialize P matrix */
-	matrix_reset(mat_data(_P_post), 9, 9);
+	matrix_reset(_P_post, SYM_MAT_SIZE(ESKF_INS_STATE_NUM), 1);
 	P_post(0, 0) = ESKF_RESCALE(5.0f); //Var(px)
 	P_post(1, 1) = ESKF_RESCALE(5.0f); //Var(py)
 	P_post(2, 2) = ESKF_RESCALE(5.0f); //Var(pz)
@@ -151,51 +218,151 @@ void eskf_ins_init(float _dt)
 	P_post(6, 6) = ESKF_RESCALE(5.0f); //Var(theta_x)
 	P_post(7, 7) = ESKF_RESCALE(5.0f); //Var(theta_y)
 	P_post(8, 8) = ESKF_RESCALE(5.0f); //Var(theta_z)
+	P_post(9, 9) = ESKF_RESCALE(1e-2f); //Var(a_b_x)
+	P_post(10, 10) = ESKF_RESCALE(1e-2f); //Var(a_b_y)
+	P_post(11, 11) = ESKF_RESCALE(1e-2f); //Var(a_b_z)
+	P_post(12, 12) = ESKF_RESCALE(1e-4f); //Var(w_b_x), residual of the boot calibration
+	P_post(13, 13) = ESKF_RESCALE(1e-4f); //Var(w_b_y)
+	P_post(14, 14) = ESKF_RESCALE(1e-4f); //Var(w_b_z)
 
 	/* initialize V_accel matrix */
 	matrix_reset(mat_data(_V_accel), 3, 3);
-	V_accel(0, 0) = ESKF_RESCALE(7e-1); //Var(gx)
-	V_accel(1, 1) = ESKF_RESCALE(7e-1); //Var(gy)
-	V_accel(2, 2) = ESKF_RESCALE(7e-1); //Var(gz)
+	V_accel(0, 0) = ESKF_RESCALE(7e-1f); //Var(gx)
+	V_accel(1, 1) = ESKF_RESCALE(7e-1f); //Var(gy)
+	V_accel(2, 2) = ESKF_RESCALE(7e-1f); //Var(gz)
 
 	/* initialize V_mag matrix */
 	matrix_reset(mat_data(_V_mag), 3, 3);
-	V_mag(0, 0) = ESKF_RESCALE(5e-1); //Var(mx)
-	V_mag(1, 1) = ESKF_RESCALE(5e-1); //Var(my)
-	V_mag(2, 2) = ESKF_RESCALE(5e-1); //Var(mz)
+	V_mag(0, 0) = ESKF_RESCALE(5e-1f); //Var(mx)
+	V_mag(1, 1) = ESKF_RESCALE(5e-1f); //Var(my)
+	V_mag(2, 2) = ESKF_RESCALE(5e-1f); //Var(mz)
 
 	/* initial V_gps matrix */
 	matrix_reset(mat_data(_V_gps), 4, 4);
-	V_gps(0, 0) = ESKF_RESCALE(2e-2); //Var(px)
-	V_gps(1, 1) = ESKF_RESCALE(2e-2); //Var(py)
-	V_gps(2, 2) = ESKF_RESCALE(1e-4); //Var(vx)
-	V_gps(3, 3) = ESKF_RESCALE(1e-4); //Var(vy)
+	V_gps(0, 0) = ESKF_RESCALE(2e-2f); //Var(px)
+	V_gps(1, 1) = ESKF_RESCALE(2e-2f); //Var(py)
+	V_gps(2, 2) = ESKF_RESCALE(1e-4f); //Var(vx)
+	V_gps(3, 3) = ESKF_RESCALE(1e-4f); //Var(vy)
 
 	/* initialize V_baro matrix */
 	matrix_reset(mat_data(_V_baro), 2, 2);
-	V_baro(0, 0) = ESKF_RESCALE(1e-1); //Var(pz)
-	V_baro(1, 1) = ESKF_RESCALE(1e-1); //Var(vz)
-
-	matrix_reset(mat_data(_PHt_accel), 9, 3);
-	matrix_reset(mat_data(_PHt_mag), 9, 3);
-	matrix_reset(mat_data(_PHt_gps), 9, 4);
-	matrix_reset(mat_data(_PHt_baro), 9, 2);
-
-	matrix_reset(mat_data(_HPHt_V_accel), 3, 3);
-	matrix_reset(mat_data(_HPHt_V_mag), 3, 3);
-	matrix_reset(mat_data(_HPHt_V_gps), 4, 4);
-	matrix_reset(mat_data(_HPHt_V_baro), 2, 2);
+	V_baro(0, 0) = ESKF_RESCALE(1e-1f); //Var(pz)
+	V_baro(1, 1) = ESKF_RESCALE(1e-1f); //Var(vz)
+
+	accel_b_last[0] = 0.0f;
+	accel_b_last[1] = 0.0f;
+	accel_b_last[2] = 0.0f;
+
+	eskf_ins_history_newest = 0;
+	eskf_ins_history_cnt = 0;
+	eskf_ins_history_skip_cnt = 0;
+	eskf_ins_present_time_us = 0;
+}
+
+/* record the nominal state of the present prediction step, should be called once
+ * per prediction with the time of the imu sample */
+void eskf_ins_history_push(uint64_t time_us)
+{
+	eskf_ins_present_time_us = time_us;
+
+	if(eskf_ins_history_skip_cnt > 0) {
+		eskf_ins_history_skip_cnt--;
+		return;
+	}
+	eskf_ins_history_skip_cnt = ESKF_INS_HISTORY_DECIMATION - 1;
+
+	eskf_ins_history_newest = (eskf_ins_history_newest + 1) % ESKF_INS_HISTORY_SIZE;
+	if(eskf_ins_history_cnt < ESKF_INS_HISTORY_SIZE) {
+		eskf_ins_history_cnt++;
+	}
+
+	eskf_ins_history_t *entry = &eskf_ins_history[eskf_ins_history_newest];
+	entry->time_us = time_us;
+	memcpy(entry->pos, &mat_data(nominal_state)[0], sizeof(entry->pos));
+	memcpy(entry->vel, &mat_data(nominal_state)[3], sizeof(entry->vel));
+}
+
+/* get the nominal position and velocity at the capture time of a delayed measurement,
+ * the return value is the lag between the capture time and the present state [s].
+ * the measurements older than the history are fused at the oldest entry */
+static float eskf_ins_history_lookup(uint64_t capture_time_us, float *pos, float *vel)
+{
+	int i;
+
+	/* not delayed or no history, use the present state */
+	if(eskf_ins_history_cnt == 0 || capture_time_us >= eskf_ins_present_time_us) {
+		for(i = 0; i < 3; i++) {
+			pos[i] = mat_data(nominal_state)[i];
+			vel[i] = mat_data(nominal_state)[i + 3];
+		}
+		return 0.0f;
+	}
+
+	/* search backward for the newest entry not later than the capture time */
+	int index = eskf_ins_history_newest;
+	for(i = 1; i < eskf_ins_history_cnt; i++) {
+		if(eskf_ins_history[index].time_us <= capture_time_us) {
+			break;
+		}
+		index = (index + ESKF_INS_HISTORY_SIZE - 1) % ESKF_INS_HISTORY_SIZE;
+	}
+
+	eskf_ins_history_t *entry = &eskf_ins_history[index];
+	if(entry->time_us > capture_time_us) {
+		capture_time_us = entry->time_us;
+	}
+
+	/* extrapolate from the entry to the capture time (skipped prediction steps) */
+	float entry_dt = (float)(capture_time_us - entry->time_us) * 1e-6f;
+	for(i = 0; i < 3; i++) {
+		pos[i] = entry->pos[i] + entry->vel[i] * entry_dt;
+		vel[i] = entry->vel[i];
+	}
+
+	return (float)(eskf_ins_present_time_us - capture_time_us) * 1e-6f;
+}
+
+/* apply the injected error state to the history as well, each entry is corrected with
+ * the error state propagated back to its time (dp_k = dp - t_lag * dv + t_lag^2 / 2 * da,
+ * dv_k = dv - t_lag * da), otherwise the next delayed measurement sees the residual which
+ * is already corrected. da is the acceleration correction of the attitude and
+ * accelerometer bias errors */
+static void eskf_ins_history_correct(const float *delta_pos, const float *delta_vel,
+                                     const float *delta_accel)
+{
+	int index = eskf_ins_history_newest;
+	int i, j;
+	for(i = 0; i < eskf_ins_history_cnt; i++) {
+		eskf_ins_history_t *entry = &eskf_ins_history[index];
+		float lag = (float)(eskf_ins_present_time_us - entry->time_us) * 1e-6f;
+		float half_lag_squared = 0.5f * lag * lag;
+
+		for(j = 0; j < 3; j++) {
+			entry->pos[j] += delta_pos[j] - lag * delta_vel[j] +
+			                 half_lag_squared * delta_accel[j];
+			entry->vel[j] += delta_vel[j] - lag * delta_accel[j];
+		}
+
+		index = (index + ESKF_INS_HISTORY_SIZE - 1) % ESKF_INS_HISTORY_SIZE;
+	}
 }
 
 void eskf_ins_predict(float *accel, float *gyro)
 {
-	/* input variables (ned frame) */
-	float accel_b_x = accel[0];
-	float accel_b_y = accel[1];
-	float accel_b_z = accel[2];
-	float gyro_b_x = gyro[0];
-	float gyro_b_y = gyro[1];
-	float gyro_b_z = gyro[2];
+	/* input variables (ned frame), the estimated biases are removed */
+	float accel_b[3], gyro_b[3];
+	accel_b[0] = accel[0] - mat_data(nominal_state)[10];
+	accel_b[1] = accel[1] - mat_data(nominal_state)[11];
+	accel_b[2] = accel[2] - mat_data(nominal_state)[12];
+	gyro_b[0] = gyro[0] - mat_data(nominal_state)[13];
+	gyro_b[1] = gyro[1] - mat_data(nominal_state)[14];
+	gyro_b[2] = gyro[2] - mat_data(nominal_state)[15];
+
+	memcpy(accel_b_last, accel_b, sizeof(accel_b_last));
+
+	float accel_b_x = accel_b[0];
+	float accel_b_y = accel_b[1];
+	float accel_b_z = accel_b[2];
 
 	/* body-frame to inertial-frame conversion */
 	float accel_i_ned[3] = {0};
@@ -232,9 +399,9 @@ void eskf_ins_predict(float *accel, float *gyro)
 	/* calculate quaternion time derivative */
 	float w[4];
 	w[0] = 0.0f;
-	w[1] = gyro[0];
-	w[2] = gyro[1];
-	w[3] = gyro[2];
+	w[1] = gyro_b[0];
+	w[2] = gyro_b[1];
+	w[3] = gyro_b[2];
 	float q_dot[4];
 	quaternion_mult(&mat_data(nominal_state)[6], w, q_dot);
 
@@ -248,191 +415,8 @@ void eskf_ins_predict(float *accel, float *gyro)
 	/*==================================*
 	 * process covatiance matrix update *
 	 *==================================*/
-
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate -R * skew_matrix(a_m - a_b) * dt */
-		R_am_ab_dt(0, 0) = -dt*(R(0,1)*accel_b_z-R(0,2)*accel_b_y);
-		R_am_ab_dt(0, 1) = dt*(R(0,0)*accel_b_z-R(0,2)*accel_b_x);
-		R_am_ab_dt(0, 2) = -dt*(R(0,0)*accel_b_y-R(0,1)*accel_b_x);
-		R_am_ab_dt(1, 0) = -dt*(R(1,1)*accel_b_z-R(1,2)*accel_b_y);
-		R_am_ab_dt(1, 1) = dt*(R(1,0)*accel_b_z-R(1,2)*accel_b_x);
-		R_am_ab_dt(1, 2) = -dt*(R(1,0)*accel_b_y-R(1,1)*accel_b_x);
-		R_am_ab_dt(2, 0) = -dt*(R(2,1)*accel_b_z-R(2,2)*accel_b_y);
-		R_am_ab_dt(2, 1) = dt*(R(2,0)*accel_b_z-R(2,2)*accel_b_x);
-		R_am_ab_dt(2, 2) = -dt*(R(2,0)*accel_b_y-R(2,1)*accel_b_x);
-
-		/* calculate Rt{w_m - w_b} * dt */
-		float c0 = dt*gyro_b_z;
-		float c1 = dt*gyro_b_y;
-		float c2 = dt*gyro_b_x;
-
-		Rt_wm_wb_dt(0, 0) = 1.0;
-		Rt_wm_wb_dt(0, 1) = c0;
-		Rt_wm_wb_dt(0, 2) = -c1;
-		Rt_wm_wb_dt(1, 0) = -c0;
-		Rt_wm_wb_dt(1, 1) = 1.0;
-		Rt_wm_wb_dt(1, 2) = c2;
-		Rt_wm_wb_dt(2, 0) = c1;
-		Rt_wm_wb_dt(2, 1) = -c2;
-		Rt_wm_wb_dt(2, 2) = 1.0;
-	}
-
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate a priori process covariance matrix */
-		float c0 = P_post(5,8)+P_post(6,8)*R_am_ab_dt(2,0)+P_post(7,8)*R_am_ab_dt(2,1)+P_post(8,8)*R_am_ab_dt(2,2);
-		float c1 = P_post(5,7)+P_post(6,7)*R_am_ab_dt(2,0)+P_post(7,7)*R_am_ab_dt(2,1)+P_post(8,7)*R_am_ab_dt(2,2);
-		float c2 = P_post(5,6)+P_post(6,6)*R_am_ab_dt(2,0)+P_post(7,6)*R_am_ab_dt(2,1)+P_post(8,6)*R_am_ab_dt(2,2);
-		float c3 = P_post(4,8)+P_post(6,8)*R_am_ab_dt(1,0)+P_post(7,8)*R_am_ab_dt(1,1)+P_post(8,8)*R_am_ab_dt(1,2);
-		float c4 = P_post(4,7)+P_post(6,7)*R_am_ab_dt(1,0)+P_post(7,7)*R_am_ab_dt(1,1)+P_post(8,7)*R_am_ab_dt(1,2);
-		float c5 = P_post(4,6)+P_post(6,6)*R_am_ab_dt(1,0)+P_post(7,6)*R_am_ab_dt(1,1)+P_post(8,6)*R_am_ab_dt(1,2);
-		float c6 = P_post(3,8)+P_post(6,8)*R_am_ab_dt(0,0)+P_post(7,8)*R_am_ab_dt(0,1)+P_post(8,8)*R_am_ab_dt(0,2);
-		float c7 = P_post(3,7)+P_post(6,7)*R_am_ab_dt(0,0)+P_post(7,7)*R_am_ab_dt(0,1)+P_post(8,7)*R_am_ab_dt(0,2);
-		float c8 = P_post(3,6)+P_post(6,6)*R_am_ab_dt(0,0)+P_post(7,6)*R_am_ab_dt(0,1)+P_post(8,6)*R_am_ab_dt(0,2);
-		float c9 = P_post(6,8)*Rt_wm_wb_dt(2,0)+P_post(7,8)*Rt_wm_wb_dt(2,1)+P_post(8,8)*Rt_wm_wb_dt(2,2);
-		float c10 = P_post(6,7)*Rt_wm_wb_dt(2,0)+P_post(7,7)*Rt_wm_wb_dt(2,1)+P_post(8,7)*Rt_wm_wb_dt(2,2);
-		float c11 = P_post(6,6)*Rt_wm_wb_dt(2,0)+P_post(7,6)*Rt_wm_wb_dt(2,1)+P_post(8,6)*Rt_wm_wb_dt(2,2);
-		float c12 = P_post(6,8)*Rt_wm_wb_dt(1,0)+P_post(7,8)*Rt_wm_wb_dt(1,1)+P_post(8,8)*Rt_wm_wb_dt(1,2);
-		float c13 = P_post(6,7)*Rt_wm_wb_dt(1,0)+P_post(7,7)*Rt_wm_wb_dt(1,1)+P_post(8,7)*Rt_wm_wb_dt(1,2);
-		float c14 = P_post(6,6)*Rt_wm_wb_dt(1,0)+P_post(7,6)*Rt_wm_wb_dt(1,1)+P_post(8,6)*Rt_wm_wb_dt(1,2);
-		float c15 = P_post(6,8)*Rt_wm_wb_dt(0,0)+P_post(7,8)*Rt_wm_wb_dt(0,1)+P_post(8,8)*Rt_wm_wb_dt(0,2);
-		float c16 = P_post(6,7)*Rt_wm_wb_dt(0,0)+P_post(7,7)*Rt_wm_wb_dt(0,1)+P_post(8,7)*Rt_wm_wb_dt(0,2);
-		float c17 = P_post(6,6)*Rt_wm_wb_dt(0,0)+P_post(7,6)*Rt_wm_wb_dt(0,1)+P_post(8,6)*Rt_wm_wb_dt(0,2);
-		float c18 = P_post(2,8)+P_post(5,8)*dt;
-		float c19 = P_post(2,7)+P_post(5,7)*dt;
-		float c20 = P_post(2,6)+P_post(5,6)*dt;
-		float c21 = P_post(1,8)+P_post(4,8)*dt;
-		float c22 = P_post(1,7)+P_post(4,7)*dt;
-		float c23 = P_post(1,6)+P_post(4,6)*dt;
-		float c24 = P_post(0,8)+P_post(3,8)*dt;
-		float c25 = P_post(0,7)+P_post(3,7)*dt;
-		float c26 = P_post(0,6)+P_post(3,6)*dt;
-		float c27 = P_post(5,5)*dt;
-		float c28 = P_post(5,4)*dt;
-		float c29 = P_post(5,3)*dt;
-		float c30 = P_post(4,5)*dt;
-		float c31 = P_post(4,4)*dt;
-		float c32 = P_post(4,3)*dt;
-		float c33 = P_post(3,5)*dt;
-		float c34 = P_post(3,4)*dt;
-		float c35 = P_post(3,3)*dt;
-		float c63 = P_post(8,5)*R_am_ab_dt(2,2);
-		float c66 = P_post(8,5)*R_am_ab_dt(1,2);
-		float c67 = P_post(8,4)*R_am_ab_dt(1,2);
-		float c68 = P_post(7,5)*R_am_ab_dt(2,1);
-		float c72 = P_post(8,5)*R_am_ab_dt(0,2);
-		float c73 = P_post(8,4)*R_am_ab_dt(0,2);
-		float c74 = P_post(7,5)*R_am_ab_dt(1,1);
-		float c75 = P_post(8,3)*R_am_ab_dt(0,2);
-		float c76 = P_post(7,4)*R_am_ab_dt(1,1);
-		float c77 = P_post(6,5)*R_am_ab_dt(2,0);
-		float c81 = P_post(7,5)*R_am_ab_dt(0,1);
-		float c82 = P_post(7,4)*R_am_ab_dt(0,1);
-		float c83 = P_post(6,5)*R_am_ab_dt(1,0);
-		float c84 = P_post(7,3)*R_am_ab_dt(0,1);
-		float c85 = P_post(6,4)*R_am_ab_dt(1,0);
-		float c87 = P_post(6,5)*R_am_ab_dt(0,0);
-		float c88 = P_post(6,4)*R_am_ab_dt(0,0);
-		float c89 = P_post(6,3)*R_am_ab_dt(0,0);
-		float c90 = P_post(3,3)+c75+c84+c89;
-		float c91 = P_post(3,4)+c73+c82+c88;
-		float c93 = P_post(3,5)+c72+c81+c87;
-		float c94 = P_post(4,4)+c67+c76+c85;
-		float c96 = P_post(4,5)+c66+c74+c83;
-		float c98 = P_post(5,5)+c63+c68+c77;
-		float c108 = P_post(2,5)+c27;
-		float c109 = P_post(2,4)+c28;
-		float c110 = P_post(2,3)+c29;
-		float c111 = P_post(1,5)+c30;
-		float c112 = P_post(1,4)+c31;
-		float c113 = P_post(1,3)+c32;
-		float c114 = P_post(0,5)+c33;
-		float c115 = P_post(0,4)+c34;
-		float c116 = P_post(0,3)+c35;
-
-		P_prior(0, 0) = P_post(0,0)+P_post(3,0)*dt+c116*dt;
-		P_prior(0, 1) = P_post(0,1)+P_post(3,1)*dt+c115*dt;
-		P_prior(0, 2) = P_post(0,2)+P_post(3,2)*dt+c114*dt;
-		P_prior(0, 3) = c116+R_am_ab_dt(0,0)*c26+R_am_ab_dt(0,1)*c25+R_am_ab_dt(0,2)*c24;
-		P_prior(0, 4) = c115+R_am_ab_dt(1,0)*c26+R_am_ab_dt(1,1)*c25+R_am_ab_dt(1,2)*c24;
-		P_prior(0, 5) = c114+R_am_ab_dt(2,0)*c26+R_am_ab_dt(2,1)*c25+R_am_ab_dt(2,2)*c24;
-		P_prior(0, 6) = Rt_wm_wb_dt(0,0)*c26+Rt_wm_wb_dt(0,1)*c25+Rt_wm_wb_dt(0,2)*c24;
-		P_prior(0, 7) = Rt_wm_wb_dt(1,0)*c26+Rt_wm_wb_dt(1,1)*c25+Rt_wm_wb_dt(1,2)*c24;
-		P_prior(0, 8) = Rt_wm_wb_dt(2,0)*c26+Rt_wm_wb_dt(2,1)*c25+Rt_wm_wb_dt(2,2)*c24;
-		P_prior(1, 0) = P_prior(0, 1);
-		P_prior(1, 1) = P_post(1,1)+P_post(4,1)*dt+c112*dt;
-		P_prior(1, 2) = P_post(1,2)+P_post(4,2)*dt+c111*dt;
-		P_prior(1, 3) = c113+R_am_ab_dt(0,0)*c23+R_am_ab_dt(0,1)*c22+R_am_ab_dt(0,2)*c21;
-		P_prior(1, 4) = c112+R_am_ab_dt(1,0)*c23+R_am_ab_dt(1,1)*c22+R_am_ab_dt(1,2)*c21;
-		P_prior(1, 5) = c111+R_am_ab_dt(2,0)*c23+R_am_ab_dt(2,1)*c22+R_am_ab_dt(2,2)*c21;
-		P_prior(1, 6) = Rt_wm_wb_dt(0,0)*c23+Rt_wm_wb_dt(0,1)*c22+Rt_wm_wb_dt(0,2)*c21;
-		P_prior(1, 7) = Rt_wm_wb_dt(1,0)*c23+Rt_wm_wb_dt(1,1)*c22+Rt_wm_wb_dt(1,2)*c21;
-		P_prior(1, 8) = Rt_wm_wb_dt(2,0)*c23+Rt_wm_wb_dt(2,1)*c22+Rt_wm_wb_dt(2,2)*c21;
-		P_prior(2, 0) = P_prior(0, 2);
-		P_prior(2, 1) = P_prior(1, 2);
-		P_prior(2, 2) = P_post(2,2)+P_post(5,2)*dt+c108*dt;
-		P_prior(2, 3) = c110+R_am_ab_dt(0,0)*c20+R_am_ab_dt(0,1)*c19+R_am_ab_dt(0,2)*c18;
-		P_prior(2, 4) = c109+R_am_ab_dt(1,0)*c20+R_am_ab_dt(1,1)*c19+R_am_ab_dt(1,2)*c18;
-		P_prior(2, 5) = c108+R_am_ab_dt(2,0)*c20+R_am_ab_dt(2,1)*c19+R_am_ab_dt(2,2)*c18;
-		P_prior(2, 6) = Rt_wm_wb_dt(0,0)*c20+Rt_wm_wb_dt(0,1)*c19+Rt_wm_wb_dt(0,2)*c18;
-		P_prior(2, 7) = Rt_wm_wb_dt(1,0)*c20+Rt_wm_wb_dt(1,1)*c19+Rt_wm_wb_dt(1,2)*c18;
-		P_prior(2, 8) = Rt_wm_wb_dt(2,0)*c20+Rt_wm_wb_dt(2,1)*c19+Rt_wm_wb_dt(2,2)*c18;
-		P_prior(3, 0) = P_prior(0, 3);
-		P_prior(3, 1) = P_prior(1, 3);
-		P_prior(3, 2) = P_prior(2, 3);
-		P_prior(3, 3) = Q_i(0,0)+c90+R_am_ab_dt(0,0)*c8+R_am_ab_dt(0,1)*c7+R_am_ab_dt(0,2)*c6;
-		P_prior(3, 4) = c91+R_am_ab_dt(1,0)*c8+R_am_ab_dt(1,1)*c7+R_am_ab_dt(1,2)*c6;
-		P_prior(3, 5) = c93+R_am_ab_dt(2,0)*c8+R_am_ab_dt(2,1)*c7+R_am_ab_dt(2,2)*c6;
-		P_prior(3, 6) = Rt_wm_wb_dt(0,0)*c8+Rt_wm_wb_dt(0,1)*c7+Rt_wm_wb_dt(0,2)*c6;
-		P_prior(3, 7) = Rt_wm_wb_dt(1,0)*c8+Rt_wm_wb_dt(1,1)*c7+Rt_wm_wb_dt(1,2)*c6;
-		P_prior(3, 8) = Rt_wm_wb_dt(2,0)*c8+Rt_wm_wb_dt(2,1)*c7+Rt_wm_wb_dt(2,2)*c6;
-		P_prior(4, 0) = P_prior(0, 4);
-		P_prior(4, 1) = P_prior(1, 4);
-		P_prior(4, 2) = P_prior(2, 4);
-		P_prior(4, 3) = P_prior(3, 4);
-		P_prior(4, 4) = Q_i(1,1)+c94+R_am_ab_dt(1,0)*c5+R_am_ab_dt(1,1)*c4+R_am_ab_dt(1,2)*c3;
-		P_prior(4, 5) = c96+R_am_ab_dt(2,0)*c5+R_am_ab_dt(2,1)*c4+R_am_ab_dt(2,2)*c3;
-		P_prior(4, 6) = Rt_wm_wb_dt(0,0)*c5+Rt_wm_wb_dt(0,1)*c4+Rt_wm_wb_dt(0,2)*c3;
-		P_prior(4, 7) = Rt_wm_wb_dt(1,0)*c5+Rt_wm_wb_dt(1,1)*c4+Rt_wm_wb_dt(1,2)*c3;
-		P_prior(4, 8) = Rt_wm_wb_dt(2,0)*c5+Rt_wm_wb_dt(2,1)*c4+Rt_wm_wb_dt(2,2)*c3;
-		P_prior(5, 0) = P_prior(0, 5);
-		P_prior(5, 1) = P_prior(1, 5);
-		P_prior(5, 2) = P_prior(2, 5);
-		P_prior(5, 3) = P_prior(3, 5);
-		P_prior(5, 4) = P_prior(4, 5);
-		P_prior(5, 5) = Q_i(2,2)+c98+R_am_ab_dt(2,0)*c2+R_am_ab_dt(2,1)*c1+R_am_ab_dt(2,2)*c0;
-		P_prior(5, 6) = Rt_wm_wb_dt(0,0)*c2+Rt_wm_wb_dt(0,1)*c1+Rt_wm_wb_dt(0,2)*c0;
-		P_prior(5, 7) = Rt_wm_wb_dt(1,0)*c2+Rt_wm_wb_dt(1,1)*c1+Rt_wm_wb_dt(1,2)*c0;
-		P_prior(5, 8) = Rt_wm_wb_dt(2,0)*c2+Rt_wm_wb_dt(2,1)*c1+Rt_wm_wb_dt(2,2)*c0;
-		P_prior(6, 0) = P_prior(0, 6);
-		P_prior(6, 1) = P_prior(1, 6);
-		P_prior(6, 2) = P_prior(2, 6);
-		P_prior(6, 3) = P_prior(3, 6);
-		P_prior(6, 4) = P_prior(4, 6);
-		P_prior(6, 5) = P_prior(5, 6);
-		P_prior(6, 6) = Q_i(3,3)+Rt_wm_wb_dt(0,0)*c17+Rt_wm_wb_dt(0,1)*c16+Rt_wm_wb_dt(0,2)*c15;
-		P_prior(6, 7) = Rt_wm_wb_dt(1,0)*c17+Rt_wm_wb_dt(1,1)*c16+Rt_wm_wb_dt(1,2)*c15;
-		P_prior(6, 8) = Rt_wm_wb_dt(2,0)*c17+Rt_wm_wb_dt(2,1)*c16+Rt_wm_wb_dt(2,2)*c15;
-		P_prior(7, 0) = P_prior(0, 7);
-		P_prior(7, 1) = P_prior(1, 7);
-		P_prior(7, 2) = P_prior(2, 7);
-		P_prior(7, 3) = P_prior(3, 7);
-		P_prior(7, 4) = P_prior(4, 7);
-		P_prior(7, 5) = P_prior(5, 7);
-		P_prior(7, 6) = P_prior(6, 7);
-		P_prior(7, 7) = Q_i(4,4)+Rt_wm_wb_dt(1,0)*c14+Rt_wm_wb_dt(1,1)*c13+Rt_wm_wb_dt(1,2)*c12;
-		P_prior(7, 8) = Rt_wm_wb_dt(2,0)*c14+Rt_wm_wb_dt(2,1)*c13+Rt_wm_wb_dt(2,2)*c12;
-		P_prior(8, 0) = P_prior(0, 8);
-		P_prior(8, 1) = P_prior(1, 8);
-		P_prior(8, 2) = P_prior(2, 8);
-		P_prior(8, 3) = P_prior(3, 8);
-		P_prior(8, 4) = P_prior(4, 8);
-		P_prior(8, 5) = P_prior(5, 8);
-		P_prior(8, 6) = P_prior(6, 8);
-		P_prior(8, 7) = P_prior(7, 8);
-		P_prior(8, 8) = Q_i(5,5)+Rt_wm_wb_dt(2,0)*c11+Rt_wm_wb_dt(2,1)*c10+Rt_wm_wb_dt(2,2)*c9;
-	}
+	eskf_ins_covariance_predict(_P_post, _P_prior, mat_data(_R), accel_b, gyro_b,
+	                            mat_data(_Q_i), dt);
 
 	/*=================================================*
 	 * convert estimated quaternion to R and Rt matrix *
@@ -441,230 +425,51 @@ void eskf_ins_predict(float *accel, float *gyro)
 	quat_to_rotation_matrix(q, mat_data(_R), mat_data(_Rt));
 }
 
-void eskf_ins_accelerometer_correct(float *accel)
+/* acceleration correction (enu) of the attitude and accelerometer bias errors,
+ * R * (theta x (a_m - a_b) - delta_a_b), see eskf_ins_predict() */
+static void eskf_ins_accel_error(const float *theta, const float *delta_a_b, float *delta_accel)
 {
-	float accel_sum_squared = (accel[0])*(accel[0]) + (accel[1])*(accel[1]) +
-	                          (accel[2])*(accel[2]) + (accel[3])*(accel[3]);
-	float div_accel_norm;
-	arm_sqrt_f32(accel_sum_squared, &div_accel_norm);
-	div_accel_norm = 1.0f / div_accel_norm;
-
-	float gx = -accel[0] * div_accel_norm;
-	float gy = -accel[1] * div_accel_norm;
-	float gz = -accel[2] * div_accel_norm;
-
-	float q0 = mat_data(nominal_state)[6];
-	float q1 = mat_data(nominal_state)[7];
-	float q2 = mat_data(nominal_state)[8];
-	float q3 = mat_data(nominal_state)[9];
-
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate P * Ht */
-		/* calculate P * Ht */
-		float c0 = q0*q0-q1*q1-q2*q2+q3*q3;
-		float c1 = q0*q2*2.0-q1*q3*2.0;
-		float c2 = q0*q1*2.0+q2*q3*2.0;
-
-		PHt_accel(0, 0) = -P_prior(0,7)*c0+P_prior(0,8)*c2;
-		PHt_accel(0, 1) = P_prior(0,6)*c0+P_prior(0,8)*c1;
-		PHt_accel(0, 2) = -P_prior(0,6)*c2-P_prior(0,7)*c1;
-		PHt_accel(1, 0) = -P_prior(1,7)*c0+P_prior(1,8)*c2;
-		PHt_accel(1, 1) = P_prior(1,6)*c0+P_prior(1,8)*c1;
-		PHt_accel(1, 2) = -P_prior(1,6)*c2-P_prior(1,7)*c1;
-		PHt_accel(2, 0) = -P_prior(2,7)*c0+P_prior(2,8)*c2;
-		PHt_accel(2, 1) = P_prior(2,6)*c0+P_prior(2,8)*c1;
-		PHt_accel(2, 2) = -P_prior(2,6)*c2-P_prior(2,7)*c1;
-		PHt_accel(3, 0) = -P_prior(3,7)*c0+P_prior(3,8)*c2;
-		PHt_accel(3, 1) = P_prior(3,6)*c0+P_prior(3,8)*c1;
-		PHt_accel(3, 2) = -P_prior(3,6)*c2-P_prior(3,7)*c1;
-		PHt_accel(4, 0) = -P_prior(4,7)*c0+P_prior(4,8)*c2;
-		PHt_accel(4, 1) = P_prior(4,6)*c0+P_prior(4,8)*c1;
-		PHt_accel(4, 2) = -P_prior(4,6)*c2-P_prior(4,7)*c1;
-		PHt_accel(5, 0) = -P_prior(5,7)*c0+P_prior(5,8)*c2;
-		PHt_accel(5, 1) = P_prior(5,6)*c0+P_prior(5,8)*c1;
-		PHt_accel(5, 2) = -P_prior(5,6)*c2-P_prior(5,7)*c1;
-		PHt_accel(6, 0) = -P_prior(6,7)*c0+P_prior(6,8)*c2;
-		PHt_accel(6, 1) = P_prior(6,6)*c0+P_prior(6,8)*c1;
-		PHt_accel(6, 2) = -P_prior(6,6)*c2-P_prior(6,7)*c1;
-		PHt_accel(7, 0) = -P_prior(7,7)*c0+P_prior(7,8)*c2;
-		PHt_accel(7, 1) = P_prior(7,6)*c0+P_prior(7,8)*c1;
-		PHt_accel(7, 2) = -P_prior(7,6)*c2-P_prior(7,7)*c1;
-		PHt_accel(8, 0) = -P_prior(8,7)*c0+P_prior(8,8)*c2;
-		PHt_accel(8, 1) = P_prior(8,6)*c0+P_prior(8,8)*c1;
-		PHt_accel(8, 2) = -P_prior(8,6)*c2-P_prior(8,7)*c1;
+	float accel_error_b[3], accel_error_ned[3];
+	cross_product_3x1((float *)theta, accel_b_last, accel_error_b);
+	accel_error_b[0] -= delta_a_b[0];
+	accel_error_b[1] -= delta_a_b[1];
+	accel_error_b[2] -= delta_a_b[2];
+
+	int i;
+	for(i = 0; i < 3; i++) {
+		accel_error_ned[i] = R(i, 0) * accel_error_b[0] + R(i, 1) * accel_error_b[1] +
+		                     R(i, 2) * accel_error_b[2];
 	}
+	delta_accel[0] = accel_error_ned[1];
+	delta_accel[1] = accel_error_ned[0];
+	delta_accel[2] = -accel_error_ned[2];
+}
 
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate (H * P * Ht) + V */
-		float c0 = q0*q0-q1*q1-q2*q2+q3*q3;
-		float c1 = q0*q2*2.0-q1*q3*2.0;
-		float c2 = q0*q1*2.0+q2*q3*2.0;
-
-		HPHt_V_accel(0, 0) = V_accel(0,0)-PHt_accel(7,0)*c0+PHt_accel(8,0)*c2;
-		HPHt_V_accel(0, 1) = -PHt_accel(7,1)*c0+PHt_accel(8,1)*c2;
-		HPHt_V_accel(0, 2) = -PHt_accel(7,2)*c0+PHt_accel(8,2)*c2;
-		HPHt_V_accel(1, 0) = PHt_accel(6,0)*c0+PHt_accel(8,0)*c1;
-		HPHt_V_accel(1, 1) = V_accel(1,1)+PHt_accel(6,1)*c0+PHt_accel(8,1)*c1;
-		HPHt_V_accel(1, 2) = PHt_accel(6,2)*c0+PHt_accel(8,2)*c1;
-		HPHt_V_accel(2, 0) = -PHt_accel(6,0)*c2-PHt_accel(7,0)*c1;
-		HPHt_V_accel(2, 1) = -PHt_accel(6,1)*c2-PHt_accel(7,1)*c1;
-		HPHt_V_accel(2, 2) = V_accel(2,2)-PHt_accel(6,2)*c2-PHt_accel(7,2)*c1;
-	}
+/* add the error state to the nominal state, the attitude error is injected as
+ * q * [1, theta / 2] */
+static void eskf_ins_error_state_injection(void)
+{
+	float *delta_x = mat_data(error_state);
+	int i;
 
-	/* calculate kalman gain */
-	//K = P * Ht * inv(H*P*Ht + V)
-	MAT_INV(&_HPHt_V_accel, &_HPHt_V_accel_inv);
-	MAT_MULT(&_PHt_accel, &_HPHt_V_accel_inv, &_K_accel);
-
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate error state residual */
-		float c0 = gz-q0*q0+q1*q1+q2*q2-q3*q3;
-		float c1 = -gy+q0*q1*2.0+q2*q3*2.0;
-		float c2 = gx+q0*q2*2.0-q1*q3*2.0;
-
-		mat_data(error_state)[0] = K_accel(0,0)*c2-K_accel(0,1)*c1+K_accel(0,2)*c0;
-		mat_data(error_state)[1] = K_accel(1,0)*c2-K_accel(1,1)*c1+K_accel(1,2)*c0;
-		mat_data(error_state)[2] = K_accel(2,0)*c2-K_accel(2,1)*c1+K_accel(2,2)*c0;
-		mat_data(error_state)[3] = K_accel(3,0)*c2-K_accel(3,1)*c1+K_accel(3,2)*c0;
-		mat_data(error_state)[4] = K_accel(4,0)*c2-K_accel(4,1)*c1+K_accel(4,2)*c0;
-		mat_data(error_state)[5] = K_accel(5,0)*c2-K_accel(5,1)*c1+K_accel(5,2)*c0;
-		mat_data(error_state)[6] = K_accel(6,0)*c2-K_accel(6,1)*c1+K_accel(6,2)*c0;
-		mat_data(error_state)[7] = K_accel(7,0)*c2-K_accel(7,1)*c1+K_accel(7,2)*c0;
-		mat_data(error_state)[8] = K_accel(8,0)*c2-K_accel(8,1)*c1+K_accel(8,2)*c0;
-	}
+	float delta_accel[3];
+	eskf_ins_accel_error(&delta_x[6], &delta_x[9], delta_accel);
 
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate a posteriori process covariance matrix */
-		//P = (I - K*H) * P
-		float c0 = q0*q0-q1*q1-q2*q2+q3*q3;
-		float c1 = q0*q2*2.0-q1*q3*2.0;
-		float c2 = q0*q1*2.0+q2*q3*2.0;
-		float c3 = -K_accel(6,1)*c0+K_accel(6,2)*c2+1.0;
-		float c4 = K_accel(8,1)*c0-K_accel(8,2)*c2;
-		float c5 = K_accel(7,1)*c0-K_accel(7,2)*c2;
-		float c6 = K_accel(5,1)*c0-K_accel(5,2)*c2;
-		float c7 = K_accel(4,1)*c0-K_accel(4,2)*c2;
-		float c8 = K_accel(3,1)*c0-K_accel(3,2)*c2;
-		float c9 = K_accel(2,1)*c0-K_accel(2,2)*c2;
-		float c10 = K_accel(1,1)*c0-K_accel(1,2)*c2;
-		float c11 = K_accel(0,1)*c0-K_accel(0,2)*c2;
-		float c12 = K_accel(8,0)*c2+K_accel(8,1)*c1-1.0;
-		float c13 = K_accel(7,0)*c0+K_accel(7,2)*c1+1.0;
-		float c14 = K_accel(8,0)*c0+K_accel(8,2)*c1;
-		float c15 = K_accel(7,0)*c2+K_accel(7,1)*c1;
-		float c16 = K_accel(6,0)*c2+K_accel(6,1)*c1;
-		float c17 = K_accel(6,0)*c0+K_accel(6,2)*c1;
-		float c18 = K_accel(5,0)*c2+K_accel(5,1)*c1;
-		float c19 = K_accel(5,0)*c0+K_accel(5,2)*c1;
-		float c20 = K_accel(4,0)*c2+K_accel(4,1)*c1;
-		float c21 = K_accel(4,0)*c0+K_accel(4,2)*c1;
-		float c22 = K_accel(3,0)*c2+K_accel(3,1)*c1;
-		float c23 = K_accel(3,0)*c0+K_accel(3,2)*c1;
-		float c24 = K_accel(2,0)*c2+K_accel(2,1)*c1;
-		float c25 = K_accel(2,0)*c0+K_accel(2,2)*c1;
-		float c26 = K_accel(1,0)*c2+K_accel(1,1)*c1;
-		float c27 = K_accel(1,0)*c0+K_accel(1,2)*c1;
-		float c28 = K_accel(0,0)*c2+K_accel(0,1)*c1;
-		float c29 = K_accel(0,0)*c0+K_accel(0,2)*c1;
-
-		P_post(0, 0) = P_prior(0,0)-P_prior(6,0)*c11+P_prior(7,0)*c29-P_prior(8,0)*c28;
-		P_post(0, 1) = P_prior(0,1)-P_prior(6,1)*c11+P_prior(7,1)*c29-P_prior(8,1)*c28;
-		P_post(0, 2) = P_prior(0,2)-P_prior(6,2)*c11+P_prior(7,2)*c29-P_prior(8,2)*c28;
-		P_post(0, 3) = P_prior(0,3)-P_prior(6,3)*c11+P_prior(7,3)*c29-P_prior(8,3)*c28;
-		P_post(0, 4) = P_prior(0,4)-P_prior(6,4)*c11+P_prior(7,4)*c29-P_prior(8,4)*c28;
-		P_post(0, 5) = P_prior(0,5)-P_prior(6,5)*c11+P_prior(7,5)*c29-P_prior(8,5)*c28;
-		P_post(0, 6) = P_prior(0,6)-P_prior(6,6)*c11+P_prior(7,6)*c29-P_prior(8,6)*c28;
-		P_post(0, 7) = P_prior(0,7)-P_prior(6,7)*c11+P_prior(7,7)*c29-P_prior(8,7)*c28;
-		P_post(0, 8) = P_prior(0,8)-P_prior(6,8)*c11+P_prior(7,8)*c29-P_prior(8,8)*c28;
-		P_post(1, 0) = P_post(0, 1);
-		P_post(1, 1) = P_prior(1,1)-P_prior(6,1)*c10+P_prior(7,1)*c27-P_prior(8,1)*c26;
-		P_post(1, 2) = P_prior(1,2)-P_prior(6,2)*c10+P_prior(7,2)*c27-P_prior(8,2)*c26;
-		P_post(1, 3) = P_prior(1,3)-P_prior(6,3)*c10+P_prior(7,3)*c27-P_prior(8,3)*c26;
-		P_post(1, 4) = P_prior(1,4)-P_prior(6,4)*c10+P_prior(7,4)*c27-P_prior(8,4)*c26;
-		P_post(1, 5) = P_prior(1,5)-P_prior(6,5)*c10+P_prior(7,5)*c27-P_prior(8,5)*c26;
-		P_post(1, 6) = P_prior(1,6)-P_prior(6,6)*c10+P_prior(7,6)*c27-P_prior(8,6)*c26;
-		P_post(1, 7) = P_prior(1,7)-P_prior(6,7)*c10+P_prior(7,7)*c27-P_prior(8,7)*c26;
-		P_post(1, 8) = P_prior(1,8)-P_prior(6,8)*c10+P_prior(7,8)*c27-P_prior(8,8)*c26;
-		P_post(2, 0) = P_post(0, 2);
-		P_post(2, 1) = P_post(1, 2);
-		P_post(2, 2) = P_prior(2,2)-P_prior(6,2)*c9+P_prior(7,2)*c25-P_prior(8,2)*c24;
-		P_post(2, 3) = P_prior(2,3)-P_prior(6,3)*c9+P_prior(7,3)*c25-P_prior(8,3)*c24;
-		P_post(2, 4) = P_prior(2,4)-P_prior(6,4)*c9+P_prior(7,4)*c25-P_prior(8,4)*c24;
-		P_post(2, 5) = P_prior(2,5)-P_prior(6,5)*c9+P_prior(7,5)*c25-P_prior(8,5)*c24;
-		P_post(2, 6) = P_prior(2,6)-P_prior(6,6)*c9+P_prior(7,6)*c25-P_prior(8,6)*c24;
-		P_post(2, 7) = P_prior(2,7)-P_prior(6,7)*c9+P_prior(7,7)*c25-P_prior(8,7)*c24;
-		P_post(2, 8) = P_prior(2,8)-P_prior(6,8)*c9+P_prior(7,8)*c25-P_prior(8,8)*c24;
-		P_post(3, 0) = P_post(0, 3);
-		P_post(3, 1) = P_post(1, 3);
-		P_post(3, 2) = P_post(2, 3);
-		P_post(3, 3) = P_prior(3,3)-P_prior(6,3)*c8+P_prior(7,3)*c23-P_prior(8,3)*c22;
-		P_post(3, 4) = P_prior(3,4)-P_prior(6,4)*c8+P_prior(7,4)*c23-P_prior(8,4)*c22;
-		P_post(3, 5) = P_prior(3,5)-P_prior(6,5)*c8+P_prior(7,5)*c23-P_prior(8,5)*c22;
-		P_post(3, 6) = P_prior(3,6)-P_prior(6,6)*c8+P_prior(7,6)*c23-P_prior(8,6)*c22;
-		P_post(3, 7) = P_prior(3,7)-P_prior(6,7)*c8+P_prior(7,7)*c23-P_prior(8,7)*c22;
-		P_post(3, 8) = P_prior(3,8)-P_prior(6,8)*c8+P_prior(7,8)*c23-P_prior(8,8)*c22;
-		P_post(4, 0) = P_post(0, 4);
-		P_post(4, 1) = P_post(1, 4);
-		P_post(4, 2) = P_post(2, 4);
-		P_post(4, 3) = P_post(3, 4);
-		P_post(4, 4) = P_prior(4,4)-P_prior(6,4)*c7+P_prior(7,4)*c21-P_prior(8,4)*c20;
-		P_post(4, 5) = P_prior(4,5)-P_prior(6,5)*c7+P_prior(7,5)*c21-P_prior(8,5)*c20;
-		P_post(4, 6) = P_prior(4,6)-P_prior(6,6)*c7+P_prior(7,6)*c21-P_prior(8,6)*c20;
-		P_post(4, 7) = P_prior(4,7)-P_prior(6,7)*c7+P_prior(7,7)*c21-P_prior(8,7)*c20;
-		P_post(4, 8) = P_prior(4,8)-P_prior(6,8)*c7+P_prior(7,8)*c21-P_prior(8,8)*c20;
-		P_post(5, 0) = P_post(0, 5);
-		P_post(5, 1) = P_post(1, 5);
-		P_post(5, 2) = P_post(2, 5);
-		P_post(5, 3) = P_post(3, 5);
-		P_post(5, 4) = P_post(4, 5);
-		P_post(5, 5) = P_prior(5,5)-P_prior(6,5)*c6+P_prior(7,5)*c19-P_prior(8,5)*c18;
-		P_post(5, 6) = P_prior(5,6)-P_prior(6,6)*c6+P_prior(7,6)*c19-P_prior(8,6)*c18;
-		P_post(5, 7) = P_prior(5,7)-P_prior(6,7)*c6+P_prior(7,7)*c19-P_prior(8,7)*c18;
-		P_post(5, 8) = P_prior(5,8)-P_prior(6,8)*c6+P_prior(7,8)*c19-P_prior(8,8)*c18;
-		P_post(6, 0) = P_post(0, 6);
-		P_post(6, 1) = P_post(1, 6);
-		P_post(6, 2) = P_post(2, 6);
-		P_post(6, 3) = P_post(3, 6);
-		P_post(6, 4) = P_post(4, 6);
-		P_post(6, 5) = P_post(5, 6);
-		P_post(6, 6) = P_prior(6,6)*c3+P_prior(7,6)*c17-P_prior(8,6)*c16;
-		P_post(6, 7) = P_prior(6,7)*c3+P_prior(7,7)*c17-P_prior(8,7)*c16;
-		P_post(6, 8) = P_prior(6,8)*c3+P_prior(7,8)*c17-P_prior(8,8)*c16;
-		P_post(7, 0) = P_post(0, 7);
-		P_post(7, 1) = P_post(1, 7);
-		P_post(7, 2) = P_post(2, 7);
-		P_post(7, 3) = P_post(3, 7);
-		P_post(7, 4) = P_post(4, 7);
-		P_post(7, 5) = P_post(5, 7);
-		P_post(7, 6) = P_post(6, 7);
-		P_post(7, 7) = -P_prior(6,7)*c5+P_prior(7,7)*c13-P_prior(8,7)*c15;
-		P_post(7, 8) = -P_prior(6,8)*c5+P_prior(7,8)*c13-P_prior(8,8)*c15;
-		P_post(8, 0) = P_post(0, 8);
-		P_post(8, 1) = P_post(1, 8);
-		P_post(8, 2) = P_post(2, 8);
-		P_post(8, 3) = P_post(3, 8);
-		P_post(8, 4) = P_post(4, 8);
-		P_post(8, 5) = P_post(5, 8);
-		P_post(8, 6) = P_post(6, 8);
-		P_post(8, 7) = P_post(7, 8);
-		P_post(8, 8) = -P_prior(6,8)*c4+P_prior(7,8)*c14-P_prior(8,8)*c12;
+	//position, velocity and the imu biases
+	for(i = 0; i < 6; i++) {
+		mat_data(nominal_state)[i] += delta_x[i];
+	}
+	for(i = 9; i < ESKF_INS_STATE_NUM; i++) {
+		mat_data(nominal_state)[i + 1] += delta_x[i];
 	}
 
-	/* P_post becoms the P_prior of other measurement's correction */
-	memcpy(mat_data(_P_prior), mat_data(_P_post), sizeof(float) * 9 * 9);
-
-	/* error state injection */
+	//nominal_state (a posteriori) = q_error * nominal_state (a priori)
 	float q_error[4];
 	q_error[0] = 1.0f;
-	q_error[1] = 0.5 * mat_data(error_state)[6];
-	q_error[2] = 0.5 * mat_data(error_state)[7];
-	q_error[3] = 0.5 * mat_data(error_state)[8];
+	q_error[1] = 0.5f * delta_x[6];
+	q_error[2] = 0.5f * delta_x[7];
+	q_error[3] = 0.5f * delta_x[8];
 
-	//nominal_state (a posteriori) = q_error * nominal_state (a priori)
 	float q_last[4];
 	quaternion_copy(q_last, &mat_data(nominal_state)[6]);
 	quaternion_mult(q_last, q_error, &mat_data(nominal_state)[6]);
@@ -672,6 +477,8 @@ void eskf_ins_accelerometer_correct(float *accel)
 	//renormailization
 	quat_normalize(&mat_data(nominal_state)[6]);
 
+	eskf_ins_history_correct(&delta_x[0], &delta_x[3], delta_accel);
+
 	/*=================================================*
 	 * convert estimated quaternion to R and Rt matrix *
 	 *=================================================*/
@@ -679,10 +486,101 @@ void eskf_ins_accelerometer_correct(float *accel)
 	quat_to_rotation_matrix(q, mat_data(_R), mat_data(_Rt));
 }
 
+/* sequential update, one scalar update for each axis of the gravity vector. the
+ * attitude error around the measured axis is not observable (zero in H) */
+static void eskf_ins_accelerometer_sequential_update(float *H, float *resid)
+{
+	const eskf_ins_h_t h_gx[5] = {{7, H[1]}, {8, H[2]}, {9, H[3]}, {10, H[4]}, {11, H[5]}};
+	const eskf_ins_h_t h_gy[5] = {{6, H[6]}, {8, H[8]}, {9, H[9]}, {10, H[10]}, {11, H[11]}};
+	const eskf_ins_h_t h_gz[5] = {{6, H[12]}, {7, H[13]}, {9, H[15]}, {10, H[16]}, {11, H[17]}};
+
+	matrix_reset(mat_data(error_state), ESKF_INS_STATE_NUM, 1);
+	eskf_ins_scalar_update(h_gx, 5, ESKF_INS_CORRECT_ALL, resid[0], V_accel(0, 0));
+	eskf_ins_scalar_update(h_gy, 5, ESKF_INS_CORRECT_ALL, resid[1], V_accel(1, 1));
+	eskf_ins_scalar_update(h_gz, 5, ESKF_INS_CORRECT_ALL, resid[2], V_accel(2, 2));
+
+	/* P_post becoms the P_prior of other measurement's correction */
+	memcpy(_P_post, _P_prior, sizeof(_P_post));
+}
+
+/* batch update, the kalman gain is calculated with the inverse of (H*P*Ht + V) */
+static void eskf_ins_accelerometer_batch_update(float *H, float *resid)
+{
+	eskf_ins_accelerometer_covariance_update(_P_prior, _P_post, mat_data(error_state),
+	                                        H, resid, mat_data(_V_accel));
+
+	/* P_post becoms the P_prior of other measurement's correction */
+	memcpy(_P_prior, _P_post, sizeof(_P_prior));
+}
+
+void eskf_ins_accelerometer_correct(float *accel)
+{
+	/* remove the estimated bias, otherwise it is seen as a tilt of the gravity vector */
+	float accel_b[3];
+	accel_b[0] = accel[0] - mat_data(nominal_state)[10];
+	accel_b[1] = accel[1] - mat_data(nominal_state)[11];
+	accel_b[2] = accel[2] - mat_data(nominal_state)[12];
+
+	float accel_sum_squared = (accel_b[0])*(accel_b[0]) + (accel_b[1])*(accel_b[1]) +
+	                          (accel_b[2])*(accel_b[2]);
+	float div_accel_norm;
+	arm_sqrt_f32(accel_sum_squared, &div_accel_norm);
+	div_accel_norm = 1.0f / div_accel_norm;
+
+	float g[3];
+	g[0] = -accel_b[0] * div_accel_norm;
+	g[1] = -accel_b[1] * div_accel_norm;
+	g[2] = -accel_b[2] * div_accel_norm;
+
+	/* predicted gravity vector and the (theta_x, theta_y, theta_z, a_b_x, a_b_y, a_b_z)
+	 * columns of the measurement matrix */
+	float h[3], H[3 * 6];
+	eskf_ins_accelerometer_measurement(&mat_data(nominal_state)[6], g, div_accel_norm, h, H);
+
+	float resid[3];
+	resid[0] = g[0] - h[0];
+	resid[1] = g[1] - h[1];
+	resid[2] = g[2] - h[2];
+
+	if(eskf_ins_update_mode == ESKF_UPDATE_SEQUENTIAL) {
+		eskf_ins_accelerometer_sequential_update(H, resid);
+	} else {
+		eskf_ins_accelerometer_batch_update(H, resid);
+	}
+
+	eskf_ins_error_state_injection();
+}
+
+/* sequential update, one scalar update for each axis of the magnetic field vector,
+ * the diagonal of H is zero */
+static void eskf_ins_magnetometer_sequential_update(float *H, float *resid)
+{
+	const eskf_ins_h_t h_mx[2] = {{7, H[1]}, {8, H[2]}};
+	const eskf_ins_h_t h_my[2] = {{6, H[3]}, {8, H[5]}};
+	const eskf_ins_h_t h_mz[2] = {{6, H[6]}, {7, H[7]}};
+
+	matrix_reset(mat_data(error_state), ESKF_INS_STATE_NUM, 1);
+	eskf_ins_scalar_update(h_mx, 2, ESKF_INS_CORRECT_MAG, resid[0], V_mag(0, 0));
+	eskf_ins_scalar_update(h_my, 2, ESKF_INS_CORRECT_MAG, resid[1], V_mag(1, 1));
+	eskf_ins_scalar_update(h_mz, 2, ESKF_INS_CORRECT_MAG, resid[2], V_mag(2, 2));
+
+	/* P_post becoms the P_prior of other measurement's correction */
+	memcpy(_P_post, _P_prior, sizeof(_P_post));
+}
+
+/* batch update, the kalman gain is calculated with the inverse of (H*P*Ht + V) */
+static void eskf_ins_magnetometer_batch_update(float *H, float *resid)
+{
+	eskf_ins_magnetometer_covariance_update(_P_prior, _P_post, mat_data(error_state),
+	                                       H, resid, mat_data(_V_mag));
+
+	/* P_post becoms the P_prior of other measurement's correction */
+	memcpy(_P_prior, _P_post, sizeof(_P_prior));
+}
+
 void eskf_ins_magnetometer_correct(float *mag)
 {
-	float mag_sum_squared = (mag[0])*(mag[0]) + (mag[1])*(mag[1]) +
-	                        (mag[2])*(mag[2]) + (mag[3])*(mag[3]);
+	float mag_sum_squared = (mag[0])*(mag[0]) + (mag[1])*(mag[1]) + (mag[2])*(mag[2]);
 	float div_mag_norm;
 	arm_sqrt_f32(mag_sum_squared, &div_mag_norm);
 	div_mag_norm = 1.0f / div_mag_norm;
@@ -691,604 +589,139 @@ void eskf_ins_magnetometer_correct(float *mag)
 	float my = mag[1] * div_mag_norm;
 	float mz = mag[2] * div_mag_norm;
 
-	float q0 = mat_data(nominal_state)[6];
-	float q1 = mat_data(nominal_state)[7];
-	float q2 = mat_data(nominal_state)[8];
-	float q3 = mat_data(nominal_state)[9];
-
-	float gamma = sqrt(mx*mx + my*my);
-
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate P * Ht */
-		float c0_ = gamma*q0*2.0-mz*q2*2.0;
-		float c1_ = gamma*q1*2.0+mz*q3*2.0;
-		float c2_ = gamma*q2*2.0+mz*q0*2.0;
-		float c3_ = gamma*q3*2.0-mz*q1*2.0;
-
-		float c0 = c0_*q3*(-1.0*0.5)+(c1_*q2)*0.5+(c2_*q1)*0.5-(c3_*q0)*0.5;
-		float c1 = (c0_*q2)*0.5+(c2_*q0)*0.5+(c1_*q3)*0.5+(c3_*q1)*0.5;
-		float c2 = c3_;
-		float c3 = (c2*q2)*0.5-(c0_*q1)*0.5+(c1_*q0)*0.5-(c2_*q3)*0.5;
-		float c4 = (c2*q3)*0.5-(c0_*q0)*0.5-(c1_*q1)*0.5+(c2_*q2)*0.5;
-
-		PHt_mag(0, 0) = -P_prior(0,7)*c1+P_prior(0,8)*c0+P_prior(0,6)*c3;
-		PHt_mag(0, 1) = P_prior(0,6)*c1+P_prior(0,7)*c3+P_prior(0,8)*c4;
-		PHt_mag(0, 2) = -P_prior(0,6)*c0-P_prior(0,7)*c4+P_prior(0,8)*c3;
-		PHt_mag(1, 0) = -P_prior(1,7)*c1+P_prior(1,8)*c0+P_prior(1,6)*c3;
-		PHt_mag(1, 1) = P_prior(1,6)*c1+P_prior(1,7)*c3+P_prior(1,8)*c4;
-		PHt_mag(1, 2) = -P_prior(1,6)*c0-P_prior(1,7)*c4+P_prior(1,8)*c3;
-		PHt_mag(2, 0) = -P_prior(2,7)*c1+P_prior(2,8)*c0+P_prior(2,6)*c3;
-		PHt_mag(2, 1) = P_prior(2,6)*c1+P_prior(2,7)*c3+P_prior(2,8)*c4;
-		PHt_mag(2, 2) = -P_prior(2,6)*c0-P_prior(2,7)*c4+P_prior(2,8)*c3;
-		PHt_mag(3, 0) = -P_prior(3,7)*c1+P_prior(3,8)*c0+P_prior(3,6)*c3;
-		PHt_mag(3, 1) = P_prior(3,6)*c1+P_prior(3,7)*c3+P_prior(3,8)*c4;
-		PHt_mag(3, 2) = -P_prior(3,6)*c0-P_prior(3,7)*c4+P_prior(3,8)*c3;
-		PHt_mag(4, 0) = -P_prior(4,7)*c1+P_prior(4,8)*c0+P_prior(4,6)*c3;
-		PHt_mag(4, 1) = P_prior(4,6)*c1+P_prior(4,7)*c3+P_prior(4,8)*c4;
-		PHt_mag(4, 2) = -P_prior(4,6)*c0-P_prior(4,7)*c4+P_prior(4,8)*c3;
-		PHt_mag(5, 0) = -P_prior(5,7)*c1+P_prior(5,8)*c0+P_prior(5,6)*c3;
-		PHt_mag(5, 1) = P_prior(5,6)*c1+P_prior(5,7)*c3+P_prior(5,8)*c4;
-		PHt_mag(5, 2) = -P_prior(5,6)*c0-P_prior(5,7)*c4+P_prior(5,8)*c3;
-		PHt_mag(6, 0) = -P_prior(6,7)*c1+P_prior(6,8)*c0+P_prior(6,6)*c3;
-		PHt_mag(6, 1) = P_prior(6,6)*c1+P_prior(6,7)*c3+P_prior(6,8)*c4;
-		PHt_mag(6, 2) = -P_prior(6,6)*c0-P_prior(6,7)*c4+P_prior(6,8)*c3;
-		PHt_mag(7, 0) = -P_prior(7,7)*c1+P_prior(7,8)*c0+P_prior(7,6)*c3;
-		PHt_mag(7, 1) = P_prior(7,6)*c1+P_prior(7,7)*c3+P_prior(7,8)*c4;
-		PHt_mag(7, 2) = -P_prior(7,6)*c0-P_prior(7,7)*c4+P_prior(7,8)*c3;
-		PHt_mag(8, 0) = -P_prior(8,7)*c1+P_prior(8,8)*c0+P_prior(8,6)*c3;
-		PHt_mag(8, 1) = P_prior(8,6)*c1+P_prior(8,7)*c3+P_prior(8,8)*c4;
-		PHt_mag(8, 2) = -P_prior(8,6)*c0-P_prior(8,7)*c4+P_prior(8,8)*c3;
+	/* the reference field has no east component, gamma is its horizontal magnitude and
+	 * md the down component of the measurement rotated into the ned frame */
+	float mn = R(0, 0) * mx + R(0, 1) * my + R(0, 2) * mz;
+	float me = R(1, 0) * mx + R(1, 1) * my + R(1, 2) * mz;
+	float md = R(2, 0) * mx + R(2, 1) * my + R(2, 2) * mz;
+	float gamma = sqrtf(mn*mn + me*me);
+
+	/* predicted magnetic field vector and the (theta_x, theta_y, theta_z) columns of the
+	 * measurement matrix */
+	float h[3], H[3 * 3];
+	eskf_ins_magnetometer_measurement(&mat_data(nominal_state)[6], gamma, md, h, H);
+
+	float resid[3];
+	resid[0] = mx - h[0];
+	resid[1] = my - h[1];
+	resid[2] = mz - h[2];
+
+	if(eskf_ins_update_mode == ESKF_UPDATE_SEQUENTIAL) {
+		eskf_ins_magnetometer_sequential_update(H, resid);
+	} else {
+		eskf_ins_magnetometer_batch_update(H, resid);
 	}
 
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate (H * P * Ht) + V */
-		float c0_ = gamma*q0*2.0-mz*q2*2.0;
-		float c1_ = gamma*q1*2.0+mz*q3*2.0;
-		float c2_ = gamma*q2*2.0+mz*q0*2.0;
-		float c3_ = gamma*q3*2.0-mz*q1*2.0;
-
-		float c0 = c0_*q3*(-1.0*0.5)+(c1_*q2)*0.5+(c2_*q1)*0.5-(c3_*q0)*0.5;
-		float c1 = (c0_*q2)*0.5+(c2_*q0)*0.5+(c1_*q3)*0.5+(c3_*q1)*0.5;
-		float c2 = c3_;
-		float c3 = (c2*q2)*0.5-(c0_*q1)*0.5+(c1_*q0)*0.5-(c2_*q3)*0.5;
-		float c4 = (c2*q3)*0.5-(c0_*q0)*0.5-(c1_*q1)*0.5+(c2_*q2)*0.5;
-
-		HPHt_V_mag(0, 0) = V_mag(0,0)+PHt_mag(6,0)*c3-PHt_mag(7,0)*c1+PHt_mag(8,0)*c0;
-		HPHt_V_mag(0, 1) = PHt_mag(6,1)*c3-PHt_mag(7,1)*c1+PHt_mag(8,1)*c0;
-		HPHt_V_mag(0, 2) = PHt_mag(6,2)*c3-PHt_mag(7,2)*c1+PHt_mag(8,2)*c0;
-		HPHt_V_mag(1, 0) = PHt_mag(6,0)*c1+PHt_mag(7,0)*c3+PHt_mag(8,0)*c4;
-		HPHt_V_mag(1, 1) = V_mag(1,1)+PHt_mag(6,1)*c1+PHt_mag(7,1)*c3+PHt_mag(8,1)*c4;
-		HPHt_V_mag(1, 2) = PHt_mag(6,2)*c1+PHt_mag(7,2)*c3+PHt_mag(8,2)*c4;
-		HPHt_V_mag(2, 0) = -PHt_mag(6,0)*c0-PHt_mag(7,0)*c4+PHt_mag(8,0)*c3;
-		HPHt_V_mag(2, 1) = -PHt_mag(6,1)*c0-PHt_mag(7,1)*c4+PHt_mag(8,1)*c3;
-		HPHt_V_mag(2, 2) = V_mag(2,2)-PHt_mag(6,2)*c0-PHt_mag(7,2)*c4+PHt_mag(8,2)*c3;
-	}
+	eskf_ins_error_state_injection();
+}
 
-	/* calculate kalman gain */
-	//K = P * Ht * inv(H*P*Ht + V)
-	MAT_INV(&_HPHt_V_mag, &_HPHt_V_mag_inv);
-	MAT_MULT(&_PHt_mag, &_HPHt_V_mag_inv, &_K_mag);
-
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate error state residual */
-		float c0_ = -q2*q2;
-		float c1_ = q3*q3;
-		float c2_ = q1*q1;
-		float c3_ = q0*q0;
-		float c4_ = q0*q2;
-		float c5_ = q1*q3;
-
-		float c0 = mx-gamma*(c0_-c1_+c2_+c3_)+mz*(c4_-c5_)*2.0;
-		float c1 = -mz+mz*(c0_+c1_-c2_+c3_)+gamma*(c4_+c5_)*2.0;
-		float c2 = my+gamma*(q0*q3-q1*q2)*2.0-mz*(q0*q1+q2*q3)*2.0;
-
-		mat_data(error_state)[0] = K_mag(0,0)*c0+K_mag(0,1)*c2-K_mag(0,2)*c1;
-		mat_data(error_state)[1] = K_mag(1,0)*c0+K_mag(1,1)*c2-K_mag(1,2)*c1;
-		mat_data(error_state)[2] = K_mag(2,0)*c0+K_mag(2,1)*c2-K_mag(2,2)*c1;
-		mat_data(error_state)[3] = K_mag(3,0)*c0+K_mag(3,1)*c2-K_mag(3,2)*c1;
-		mat_data(error_state)[4] = K_mag(4,0)*c0+K_mag(4,1)*c2-K_mag(4,2)*c1;
-		mat_data(error_state)[5] = K_mag(5,0)*c0+K_mag(5,1)*c2-K_mag(5,2)*c1;
-		mat_data(error_state)[6] = K_mag(6,0)*c0+K_mag(6,1)*c2-K_mag(6,2)*c1;
-		mat_data(error_state)[7] = K_mag(7,0)*c0+K_mag(7,1)*c2-K_mag(7,2)*c1;
-		mat_data(error_state)[8] = K_mag(8,0)*c0+K_mag(8,1)*c2-K_mag(8,2)*c1;
-	}
+/* sequential update, the measurement matrix rows select px, py, vx and vy directly.
+ * a delayed position is a measurement of the present state with the row
+ * [1, 0, 0, -lag] on (p, v) since p_capture = p_present - lag * v */
+static void eskf_ins_gps_sequential_update(float *resid, float lag)
+{
+	const eskf_ins_h_t h_px[2] = {{0, 1.0f}, {3, -lag}};
+	const eskf_ins_h_t h_py[2] = {{1, 1.0f}, {4, -lag}};
+	const eskf_ins_h_t h_vx = {3, 1.0f};
+	const eskf_ins_h_t h_vy = {4, 1.0f};
 
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate a posteriori process covariance matrix */
-		//P = (I - K*H) * P
-		float c0_ = gamma*q3*2.0-mz*q1*2.0;
-		float c1_ = gamma*q1*2.0+mz*q3*2.0;
-		float c2_ = gamma*q2*2.0+mz*q0*2.0;
-		float c3_ = gamma*q0*2.0-mz*q2*2.0;
-
-		float c0 = c0_*q0*(-1.0*0.5)+(c1_*q2)*0.5+(c2_*q1)*0.5-(c3_*q3)*0.5;
-		float c1 = (c0_*q1)*0.5+(c2_*q0)*0.5+(c1_*q3)*0.5+(c3_*q2)*0.5;
-		float c2 = c3_;
-		float c3 = (c2*q1)*0.5-(c1_*q0)*0.5-(c0_*q2)*0.5+(c2_*q3)*0.5;
-		float c4 = (c2*q0)*0.5+(c1_*q1)*0.5-(c0_*q3)*0.5-(c2_*q2)*0.5;
-		float c5 = -K_mag(8,0)*c0+K_mag(8,1)*c4+K_mag(8,2)*c3+1.0;
-		float c6 = K_mag(7,0)*c1+K_mag(7,1)*c3-K_mag(7,2)*c4+1.0;
-		float c7 = -K_mag(6,1)*c1+K_mag(6,2)*c0+K_mag(6,0)*c3+1.0;
-		float c8 = K_mag(8,0)*c1+K_mag(8,1)*c3-K_mag(8,2)*c4;
-		float c9 = -K_mag(8,1)*c1+K_mag(8,2)*c0+K_mag(8,0)*c3;
-		float c10 = -K_mag(7,0)*c0+K_mag(7,1)*c4+K_mag(7,2)*c3;
-		float c11 = -K_mag(7,1)*c1+K_mag(7,2)*c0+K_mag(7,0)*c3;
-		float c12 = K_mag(6,0)*c1+K_mag(6,1)*c3-K_mag(6,2)*c4;
-		float c13 = -K_mag(6,0)*c0+K_mag(6,1)*c4+K_mag(6,2)*c3;
-		float c14 = K_mag(5,0)*c1+K_mag(5,1)*c3-K_mag(5,2)*c4;
-		float c15 = -K_mag(5,0)*c0+K_mag(5,1)*c4+K_mag(5,2)*c3;
-		float c16 = -K_mag(5,1)*c1+K_mag(5,2)*c0+K_mag(5,0)*c3;
-		float c17 = K_mag(4,0)*c1+K_mag(4,1)*c3-K_mag(4,2)*c4;
-		float c18 = -K_mag(4,0)*c0+K_mag(4,1)*c4+K_mag(4,2)*c3;
-		float c19 = -K_mag(4,1)*c1+K_mag(4,2)*c0+K_mag(4,0)*c3;
-		float c20 = K_mag(3,0)*c1+K_mag(3,1)*c3-K_mag(3,2)*c4;
-		float c21 = -K_mag(3,0)*c0+K_mag(3,1)*c4+K_mag(3,2)*c3;
-		float c22 = -K_mag(3,1)*c1+K_mag(3,2)*c0+K_mag(3,0)*c3;
-		float c23 = K_mag(2,0)*c1+K_mag(2,1)*c3-K_mag(2,2)*c4;
-		float c24 = -K_mag(2,0)*c0+K_mag(2,1)*c4+K_mag(2,2)*c3;
-		float c25 = -K_mag(2,1)*c1+K_mag(2,2)*c0+K_mag(2,0)*c3;
-		float c26 = K_mag(1,0)*c1+K_mag(1,1)*c3-K_mag(1,2)*c4;
-		float c27 = -K_mag(1,0)*c0+K_mag(1,1)*c4+K_mag(1,2)*c3;
-		float c28 = -K_mag(1,1)*c1+K_mag(1,2)*c0+K_mag(1,0)*c3;
-		float c29 = K_mag(0,0)*c1+K_mag(0,1)*c3-K_mag(0,2)*c4;
-		float c30 = -K_mag(0,0)*c0+K_mag(0,1)*c4+K_mag(0,2)*c3;
-		float c31 = -K_mag(0,1)*c1+K_mag(0,2)*c0+K_mag(0,0)*c3;
-
-		P_post(0, 0) = P_prior(0,0)+P_prior(6,0)*c31+P_prior(7,0)*c29+P_prior(8,0)*c30;
-		P_post(0, 1) = P_prior(0,1)+P_prior(6,1)*c31+P_prior(7,1)*c29+P_prior(8,1)*c30;
-		P_post(0, 2) = P_prior(0,2)+P_prior(6,2)*c31+P_prior(7,2)*c29+P_prior(8,2)*c30;
-		P_post(0, 3) = P_prior(0,3)+P_prior(6,3)*c31+P_prior(7,3)*c29+P_prior(8,3)*c30;
-		P_post(0, 4) = P_prior(0,4)+P_prior(6,4)*c31+P_prior(7,4)*c29+P_prior(8,4)*c30;
-		P_post(0, 5) = P_prior(0,5)+P_prior(6,5)*c31+P_prior(7,5)*c29+P_prior(8,5)*c30;
-		P_post(0, 6) = P_prior(0,6)+P_prior(6,6)*c31+P_prior(7,6)*c29+P_prior(8,6)*c30;
-		P_post(0, 7) = P_prior(0,7)+P_prior(6,7)*c31+P_prior(7,7)*c29+P_prior(8,7)*c30;
-		P_post(0, 8) = P_prior(0,8)+P_prior(6,8)*c31+P_prior(7,8)*c29+P_prior(8,8)*c30;
-		P_post(1, 0) = P_post(0, 1);
-		P_post(1, 1) = P_prior(1,1)+P_prior(6,1)*c28+P_prior(7,1)*c26+P_prior(8,1)*c27;
-		P_post(1, 2) = P_prior(1,2)+P_prior(6,2)*c28+P_prior(7,2)*c26+P_prior(8,2)*c27;
-		P_post(1, 3) = P_prior(1,3)+P_prior(6,3)*c28+P_prior(7,3)*c26+P_prior(8,3)*c27;
-		P_post(1, 4) = P_prior(1,4)+P_prior(6,4)*c28+P_prior(7,4)*c26+P_prior(8,4)*c27;
-		P_post(1, 5) = P_prior(1,5)+P_prior(6,5)*c28+P_prior(7,5)*c26+P_prior(8,5)*c27;
-		P_post(1, 6) = P_prior(1,6)+P_prior(6,6)*c28+P_prior(7,6)*c26+P_prior(8,6)*c27;
-		P_post(1, 7) = P_prior(1,7)+P_prior(6,7)*c28+P_prior(7,7)*c26+P_prior(8,7)*c27;
-		P_post(1, 8) = P_prior(1,8)+P_prior(6,8)*c28+P_prior(7,8)*c26+P_prior(8,8)*c27;
-		P_post(2, 0) = P_post(0, 2);
-		P_post(2, 1) = P_post(1, 2);
-		P_post(2, 2) = P_prior(2,2)+P_prior(6,2)*c25+P_prior(7,2)*c23+P_prior(8,2)*c24;
-		P_post(2, 3) = P_prior(2,3)+P_prior(6,3)*c25+P_prior(7,3)*c23+P_prior(8,3)*c24;
-		P_post(2, 4) = P_prior(2,4)+P_prior(6,4)*c25+P_prior(7,4)*c23+P_prior(8,4)*c24;
-		P_post(2, 5) = P_prior(2,5)+P_prior(6,5)*c25+P_prior(7,5)*c23+P_prior(8,5)*c24;
-		P_post(2, 6) = P_prior(2,6)+P_prior(6,6)*c25+P_prior(7,6)*c23+P_prior(8,6)*c24;
-		P_post(2, 7) = P_prior(2,7)+P_prior(6,7)*c25+P_prior(7,7)*c23+P_prior(8,7)*c24;
-		P_post(2, 8) = P_prior(2,8)+P_prior(6,8)*c25+P_prior(7,8)*c23+P_prior(8,8)*c24;
-		P_post(3, 0) = P_post(0, 3);
-		P_post(3, 1) = P_post(1, 3);
-		P_post(3, 2) = P_post(2, 3);
-		P_post(3, 3) = P_prior(3,3)+P_prior(6,3)*c22+P_prior(7,3)*c20+P_prior(8,3)*c21;
-		P_post(3, 4) = P_prior(3,4)+P_prior(6,4)*c22+P_prior(7,4)*c20+P_prior(8,4)*c21;
-		P_post(3, 5) = P_prior(3,5)+P_prior(6,5)*c22+P_prior(7,5)*c20+P_prior(8,5)*c21;
-		P_post(3, 6) = P_prior(3,6)+P_prior(6,6)*c22+P_prior(7,6)*c20+P_prior(8,6)*c21;
-		P_post(3, 7) = P_prior(3,7)+P_prior(6,7)*c22+P_prior(7,7)*c20+P_prior(8,7)*c21;
-		P_post(3, 8) = P_prior(3,8)+P_prior(6,8)*c22+P_prior(7,8)*c20+P_prior(8,8)*c21;
-		P_post(4, 0) = P_post(0, 4);
-		P_post(4, 1) = P_post(1, 4);
-		P_post(4, 2) = P_post(2, 4);
-		P_post(4, 3) = P_post(3, 4);
-		P_post(4, 4) = P_prior(4,4)+P_prior(6,4)*c19+P_prior(7,4)*c17+P_prior(8,4)*c18;
-		P_post(4, 5) = P_prior(4,5)+P_prior(6,5)*c19+P_prior(7,5)*c17+P_prior(8,5)*c18;
-		P_post(4, 6) = P_prior(4,6)+P_prior(6,6)*c19+P_prior(7,6)*c17+P_prior(8,6)*c18;
-		P_post(4, 7) = P_prior(4,7)+P_prior(6,7)*c19+P_prior(7,7)*c17+P_prior(8,7)*c18;
-		P_post(4, 8) = P_prior(4,8)+P_prior(6,8)*c19+P_prior(7,8)*c17+P_prior(8,8)*c18;
-		P_post(5, 0) = P_post(0, 5);
-		P_post(5, 1) = P_post(1, 5);
-		P_post(5, 2) = P_post(2, 5);
-		P_post(5, 3) = P_post(3, 5);
-		P_post(5, 4) = P_post(4, 5);
-		P_post(5, 5) = P_prior(5,5)+P_prior(6,5)*c16+P_prior(7,5)*c14+P_prior(8,5)*c15;
-		P_post(5, 6) = P_prior(5,6)+P_prior(6,6)*c16+P_prior(7,6)*c14+P_prior(8,6)*c15;
-		P_post(5, 7) = P_prior(5,7)+P_prior(6,7)*c16+P_prior(7,7)*c14+P_prior(8,7)*c15;
-		P_post(5, 8) = P_prior(5,8)+P_prior(6,8)*c16+P_prior(7,8)*c14+P_prior(8,8)*c15;
-		P_post(6, 0) = P_post(0, 6);
-		P_post(6, 1) = P_post(1, 6);
-		P_post(6, 2) = P_post(2, 6);
-		P_post(6, 3) = P_post(3, 6);
-		P_post(6, 4) = P_post(4, 6);
-		P_post(6, 5) = P_post(5, 6);
-		P_post(6, 6) = P_prior(6,6)*c7+P_prior(7,6)*c12+P_prior(8,6)*c13;
-		P_post(6, 7) = P_prior(6,7)*c7+P_prior(7,7)*c12+P_prior(8,7)*c13;
-		P_post(6, 8) = P_prior(6,8)*c7+P_prior(7,8)*c12+P_prior(8,8)*c13;
-		P_post(7, 0) = P_post(0, 7);
-		P_post(7, 1) = P_post(1, 7);
-		P_post(7, 2) = P_post(2, 7);
-		P_post(7, 3) = P_post(3, 7);
-		P_post(7, 4) = P_post(4, 7);
-		P_post(7, 5) = P_post(5, 7);
-		P_post(7, 6) = P_post(6, 7);
-		P_post(7, 7) = P_prior(6,7)*c11+P_prior(7,7)*c6+P_prior(8,7)*c10;
-		P_post(7, 8) = P_prior(6,8)*c11+P_prior(7,8)*c6+P_prior(8,8)*c10;
-		P_post(8, 0) = P_post(0, 8);
-		P_post(8, 1) = P_post(1, 8);
-		P_post(8, 2) = P_post(2, 8);
-		P_post(8, 3) = P_post(3, 8);
-		P_post(8, 4) = P_post(4, 8);
-		P_post(8, 5) = P_post(5, 8);
-		P_post(8, 6) = P_post(6, 8);
-		P_post(8, 7) = P_post(7, 8);
-		P_post(8, 8) = P_prior(6,8)*c9+P_prior(7,8)*c8+P_prior(8,8)*c5;
-	}
+	matrix_reset(mat_data(error_state), ESKF_INS_STATE_NUM, 1);
+	eskf_ins_scalar_update(h_px, 2, ESKF_INS_CORRECT_GPS, resid[0], V_gps(0, 0));
+	eskf_ins_scalar_update(h_py, 2, ESKF_INS_CORRECT_GPS, resid[1], V_gps(1, 1));
+	eskf_ins_scalar_update(&h_vx, 1, ESKF_INS_CORRECT_GPS, resid[2], V_gps(2, 2));
+	eskf_ins_scalar_update(&h_vy, 1, ESKF_INS_CORRECT_GPS, resid[3], V_gps(3, 3));
 
 	/* P_post becoms the P_prior of other measurement's correction */
-	memcpy(mat_data(_P_prior), mat_data(_P_post), sizeof(float) * 9 * 9);
+	memcpy(_P_post, _P_prior, sizeof(_P_post));
+}
 
-	/* error state injection */
-	float q_error[4];
-	q_error[0] = 1.0f;
-	q_error[1] = 0.0f; //0.5 * mat_data(error_state)[6];
-	q_error[2] = 0.0f; //0.5 * mat_data(error_state)[7];
-	q_error[3] = 0.5 * mat_data(error_state)[8];
+/* batch update, the kalman gain is calculated with the inverse of (H*P*Ht + V) */
+static void eskf_ins_gps_batch_update(float *resid, float lag)
+{
+	eskf_ins_gps_covariance_update(_P_prior, _P_post, mat_data(error_state),
+	                               lag, resid, mat_data(_V_gps));
 
-	//nominal_state (a posteriori) = q_error * nominal_state (a priori)
-	float q_last[4];
-	quaternion_copy(q_last, &mat_data(nominal_state)[6]);
-	quaternion_mult(q_last, q_error, &mat_data(nominal_state)[6]);
+	/* P_post becoms the P_prior of other measurement's correction */
+	memcpy(_P_prior, _P_post, sizeof(_P_prior));
+}
 
-	//renormailization
-	quat_normalize(&mat_data(nominal_state)[6]);
+/* the residual is calculated with the nominal state at the capture time, the error
+ * state is then a correction of the present state (see eskf_ins_history_correct()) */
+void eskf_ins_gps_delayed_correct(float px_enu, float py_enu,
+                                  float vx_enu, float vy_enu,
+                                  uint64_t capture_time_us)
+{
+	float pos[3], vel[3];
+	float lag = eskf_ins_history_lookup(capture_time_us, pos, vel);
+
+	float resid[4];
+	resid[0] = px_enu - pos[0];
+	resid[1] = py_enu - pos[1];
+	resid[2] = vx_enu - vel[0];
+	resid[3] = vy_enu - vel[1];
+
+	if(eskf_ins_update_mode == ESKF_UPDATE_SEQUENTIAL) {
+		eskf_ins_gps_sequential_update(resid, lag);
+	} else {
+		eskf_ins_gps_batch_update(resid, lag);
+	}
 
-	/*=================================================*
-	 * convert estimated quaternion to R and Rt matrix *
-	 *=================================================*/
-	float *q = &mat_data(nominal_state)[6];
-	quat_to_rotation_matrix(q, mat_data(_R), mat_data(_Rt));
+	eskf_ins_error_state_injection();
 }
 
 void eskf_ins_gps_correct(float px_enu, float py_enu,
                           float vx_enu, float vy_enu)
 {
-	float px_gps = px_enu;
-	float py_gps = py_enu;
-	float vx_gps = vx_enu;
-	float vy_gps = vy_enu;
-	float px = mat_data(nominal_state)[0];
-	float py = mat_data(nominal_state)[1];
-	float vx = mat_data(nominal_state)[3];
-	float vy = mat_data(nominal_state)[4];
-
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate P * Ht */
-		PHt_gps(0, 0) = P_prior(0,0);
-		PHt_gps(0, 1) = P_prior(0,1);
-		PHt_gps(0, 2) = P_prior(0,3);
-		PHt_gps(0, 3) = P_prior(0,4);
-		PHt_gps(1, 0) = P_prior(1,0);
-		PHt_gps(1, 1) = P_prior(1,1);
-		PHt_gps(1, 2) = P_prior(1,3);
-		PHt_gps(1, 3) = P_prior(1,4);
-		PHt_gps(2, 0) = P_prior(2,0);
-		PHt_gps(2, 1) = P_prior(2,1);
-		PHt_gps(2, 2) = P_prior(2,3);
-		PHt_gps(2, 3) = P_prior(2,4);
-		PHt_gps(3, 0) = P_prior(3,0);
-		PHt_gps(3, 1) = P_prior(3,1);
-		PHt_gps(3, 2) = P_prior(3,3);
-		PHt_gps(3, 3) = P_prior(3,4);
-		PHt_gps(4, 0) = P_prior(4,0);
-		PHt_gps(4, 1) = P_prior(4,1);
-		PHt_gps(4, 2) = P_prior(4,3);
-		PHt_gps(4, 3) = P_prior(4,4);
-		PHt_gps(5, 0) = P_prior(5,0);
-		PHt_gps(5, 1) = P_prior(5,1);
-		PHt_gps(5, 2) = P_prior(5,3);
-		PHt_gps(5, 3) = P_prior(5,4);
-		PHt_gps(6, 0) = P_prior(6,0);
-		PHt_gps(6, 1) = P_prior(6,1);
-		PHt_gps(6, 2) = P_prior(6,3);
-		PHt_gps(6, 3) = P_prior(6,4);
-		PHt_gps(7, 0) = P_prior(7,0);
-		PHt_gps(7, 1) = P_prior(7,1);
-		PHt_gps(7, 2) = P_prior(7,3);
-		PHt_gps(7, 3) = P_prior(7,4);
-		PHt_gps(8, 0) = P_prior(8,0);
-		PHt_gps(8, 1) = P_prior(8,1);
-		PHt_gps(8, 2) = P_prior(8,3);
-		PHt_gps(8, 3) = P_prior(8,4);
-	}
-
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate (H * P * Ht) + V */
-		HPHt_V_gps(0, 0) = PHt_gps(0,0)+V_gps(0,0);
-		HPHt_V_gps(0, 1) = PHt_gps(0,1);
-		HPHt_V_gps(0, 2) = PHt_gps(0,2);
-		HPHt_V_gps(0, 3) = PHt_gps(0,3);
-		HPHt_V_gps(1, 0) = PHt_gps(1,0);
-		HPHt_V_gps(1, 1) = PHt_gps(1,1)+V_gps(1,1);
-		HPHt_V_gps(1, 2) = PHt_gps(1,2);
-		HPHt_V_gps(1, 3) = PHt_gps(1,3);
-		HPHt_V_gps(2, 0) = PHt_gps(3,0);
-		HPHt_V_gps(2, 1) = PHt_gps(3,1);
-		HPHt_V_gps(2, 2) = PHt_gps(3,2)+V_gps(2,2);
-		HPHt_V_gps(2, 3) = PHt_gps(3,3);
-		HPHt_V_gps(3, 0) = PHt_gps(4,0);
-		HPHt_V_gps(3, 1) = PHt_gps(4,1);
-		HPHt_V_gps(3, 2) = PHt_gps(4,2);
-		HPHt_V_gps(3, 3) = PHt_gps(4,3)+V_gps(3,3);
-	}
+	eskf_ins_gps_delayed_correct(px_enu, py_enu, vx_enu, vy_enu, UINT64_MAX);
+}
 
-	/* calculate kalman gain */
-	//K = P * Ht * inv(H*P*Ht + V)
-	MAT_INV(&_HPHt_V_gps, &_HPHt_V_gps_inv);
-	MAT_MULT(&_PHt_gps, &_HPHt_V_gps_inv, &_K_gps);
-
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate error state residual */
-		float c0 = vy-vy_gps;
-		float c1 = vx-vx_gps;
-		float c2 = py-py_gps;
-		float c3 = px-px_gps;
-
-		mat_data(error_state)[0] = -K_gps(0,0)*c3-K_gps(0,1)*c2-K_gps(0,2)*c1-K_gps(0,3)*c0;
-		mat_data(error_state)[1] = -K_gps(1,0)*c3-K_gps(1,1)*c2-K_gps(1,2)*c1-K_gps(1,3)*c0;
-		mat_data(error_state)[3] = -K_gps(3,0)*c3-K_gps(3,1)*c2-K_gps(3,2)*c1-K_gps(3,3)*c0;
-		mat_data(error_state)[4] = -K_gps(4,0)*c3-K_gps(4,1)*c2-K_gps(4,2)*c1-K_gps(4,3)*c0;
-	}
+/* sequential update, the measurement matrix rows select pz and vz directly,
+ * see eskf_ins_gps_sequential_update() for the delayed height */
+static void eskf_ins_barometer_sequential_update(float *resid, float lag)
+{
+	const eskf_ins_h_t h_pz[2] = {{2, 1.0f}, {5, -lag}};
+	const eskf_ins_h_t h_vz = {5, 1.0f};
 
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate a posteriori process covariance matrix */
-		float c0 = K_gps(4,3)-1.0;
-		float c1 = K_gps(3,2)-1.0;
-		float c2 = K_gps(1,1)-1.0;
-		float c3 = K_gps(0,0)-1.0;
-
-		P_post(0, 0) = -P_prior(0,0)*c3-K_gps(0,1)*P_prior(1,0)-K_gps(0,2)*P_prior(3,0)-K_gps(0,3)*P_prior(4,0);
-		P_post(0, 1) = -P_prior(0,1)*c3-K_gps(0,1)*P_prior(1,1)-K_gps(0,2)*P_prior(3,1)-K_gps(0,3)*P_prior(4,1);
-		P_post(0, 2) = -P_prior(0,2)*c3-K_gps(0,1)*P_prior(1,2)-K_gps(0,2)*P_prior(3,2)-K_gps(0,3)*P_prior(4,2);
-		P_post(0, 3) = -P_prior(0,3)*c3-K_gps(0,1)*P_prior(1,3)-K_gps(0,2)*P_prior(3,3)-K_gps(0,3)*P_prior(4,3);
-		P_post(0, 4) = -P_prior(0,4)*c3-K_gps(0,1)*P_prior(1,4)-K_gps(0,2)*P_prior(3,4)-K_gps(0,3)*P_prior(4,4);
-		P_post(0, 5) = -P_prior(0,5)*c3-K_gps(0,1)*P_prior(1,5)-K_gps(0,2)*P_prior(3,5)-K_gps(0,3)*P_prior(4,5);
-		P_post(0, 6) = -P_prior(0,6)*c3-K_gps(0,1)*P_prior(1,6)-K_gps(0,2)*P_prior(3,6)-K_gps(0,3)*P_prior(4,6);
-		P_post(0, 7) = -P_prior(0,7)*c3-K_gps(0,1)*P_prior(1,7)-K_gps(0,2)*P_prior(3,7)-K_gps(0,3)*P_prior(4,7);
-		P_post(0, 8) = -P_prior(0,8)*c3-K_gps(0,1)*P_prior(1,8)-K_gps(0,2)*P_prior(3,8)-K_gps(0,3)*P_prior(4,8);
-		P_post(1, 0) = P_post(0, 1);
-		P_post(1, 1) = -P_prior(1,1)*c2-K_gps(1,0)*P_prior(0,1)-K_gps(1,2)*P_prior(3,1)-K_gps(1,3)*P_prior(4,1);
-		P_post(1, 2) = -P_prior(1,2)*c2-K_gps(1,0)*P_prior(0,2)-K_gps(1,2)*P_prior(3,2)-K_gps(1,3)*P_prior(4,2);
-		P_post(1, 3) = -P_prior(1,3)*c2-K_gps(1,0)*P_prior(0,3)-K_gps(1,2)*P_prior(3,3)-K_gps(1,3)*P_prior(4,3);
-		P_post(1, 4) = -P_prior(1,4)*c2-K_gps(1,0)*P_prior(0,4)-K_gps(1,2)*P_prior(3,4)-K_gps(1,3)*P_prior(4,4);
-		P_post(1, 5) = -P_prior(1,5)*c2-K_gps(1,0)*P_prior(0,5)-K_gps(1,2)*P_prior(3,5)-K_gps(1,3)*P_prior(4,5);
-		P_post(1, 6) = -P_prior(1,6)*c2-K_gps(1,0)*P_prior(0,6)-K_gps(1,2)*P_prior(3,6)-K_gps(1,3)*P_prior(4,6);
-		P_post(1, 7) = -P_prior(1,7)*c2-K_gps(1,0)*P_prior(0,7)-K_gps(1,2)*P_prior(3,7)-K_gps(1,3)*P_prior(4,7);
-		P_post(1, 8) = -P_prior(1,8)*c2-K_gps(1,0)*P_prior(0,8)-K_gps(1,2)*P_prior(3,8)-K_gps(1,3)*P_prior(4,8);
-		P_post(2, 0) = P_post(0, 2);
-		P_post(2, 1) = P_post(1, 2);
-		P_post(2, 2) = P_prior(2,2)-K_gps(2,0)*P_prior(0,2)-K_gps(2,1)*P_prior(1,2)-K_gps(2,2)*P_prior(3,2)-K_gps(2,3)*P_prior(4,2);
-		P_post(2, 3) = P_prior(2,3)-K_gps(2,0)*P_prior(0,3)-K_gps(2,1)*P_prior(1,3)-K_gps(2,2)*P_prior(3,3)-K_gps(2,3)*P_prior(4,3);
-		P_post(2, 4) = P_prior(2,4)-K_gps(2,0)*P_prior(0,4)-K_gps(2,1)*P_prior(1,4)-K_gps(2,2)*P_prior(3,4)-K_gps(2,3)*P_prior(4,4);
-		P_post(2, 5) = P_prior(2,5)-K_gps(2,0)*P_prior(0,5)-K_gps(2,1)*P_prior(1,5)-K_gps(2,2)*P_prior(3,5)-K_gps(2,3)*P_prior(4,5);
-		P_post(2, 6) = P_prior(2,6)-K_gps(2,0)*P_prior(0,6)-K_gps(2,1)*P_prior(1,6)-K_gps(2,2)*P_prior(3,6)-K_gps(2,3)*P_prior(4,6);
-		P_post(2, 7) = P_prior(2,7)-K_gps(2,0)*P_prior(0,7)-K_gps(2,1)*P_prior(1,7)-K_gps(2,2)*P_prior(3,7)-K_gps(2,3)*P_prior(4,7);
-		P_post(2, 8) = P_prior(2,8)-K_gps(2,0)*P_prior(0,8)-K_gps(2,1)*P_prior(1,8)-K_gps(2,2)*P_prior(3,8)-K_gps(2,3)*P_prior(4,8);
-		P_post(3, 0) = P_post(0, 3);
-		P_post(3, 1) = P_post(1, 3);
-		P_post(3, 2) = P_post(2, 3);
-		P_post(3, 3) = -P_prior(3,3)*c1-K_gps(3,0)*P_prior(0,3)-K_gps(3,1)*P_prior(1,3)-K_gps(3,3)*P_prior(4,3);
-		P_post(3, 4) = -P_prior(3,4)*c1-K_gps(3,0)*P_prior(0,4)-K_gps(3,1)*P_prior(1,4)-K_gps(3,3)*P_prior(4,4);
-		P_post(3, 5) = -P_prior(3,5)*c1-K_gps(3,0)*P_prior(0,5)-K_gps(3,1)*P_prior(1,5)-K_gps(3,3)*P_prior(4,5);
-		P_post(3, 6) = -P_prior(3,6)*c1-K_gps(3,0)*P_prior(0,6)-K_gps(3,1)*P_prior(1,6)-K_gps(3,3)*P_prior(4,6);
-		P_post(3, 7) = -P_prior(3,7)*c1-K_gps(3,0)*P_prior(0,7)-K_gps(3,1)*P_prior(1,7)-K_gps(3,3)*P_prior(4,7);
-		P_post(3, 8) = -P_prior(3,8)*c1-K_gps(3,0)*P_prior(0,8)-K_gps(3,1)*P_prior(1,8)-K_gps(3,3)*P_prior(4,8);
-		P_post(4, 0) = P_post(0, 4);
-		P_post(4, 1) = P_post(1, 4);
-		P_post(4, 2) = P_post(2, 4);
-		P_post(4, 3) = P_post(3, 4);
-		P_post(4, 4) = -P_prior(4,4)*c0-K_gps(4,0)*P_prior(0,4)-K_gps(4,1)*P_prior(1,4)-K_gps(4,2)*P_prior(3,4);
-		P_post(4, 5) = -P_prior(4,5)*c0-K_gps(4,0)*P_prior(0,5)-K_gps(4,1)*P_prior(1,5)-K_gps(4,2)*P_prior(3,5);
-		P_post(4, 6) = -P_prior(4,6)*c0-K_gps(4,0)*P_prior(0,6)-K_gps(4,1)*P_prior(1,6)-K_gps(4,2)*P_prior(3,6);
-		P_post(4, 7) = -P_prior(4,7)*c0-K_gps(4,0)*P_prior(0,7)-K_gps(4,1)*P_prior(1,7)-K_gps(4,2)*P_prior(3,7);
-		P_post(4, 8) = -P_prior(4,8)*c0-K_gps(4,0)*P_prior(0,8)-K_gps(4,1)*P_prior(1,8)-K_gps(4,2)*P_prior(3,8);
-		P_post(5, 0) = P_post(0, 5);
-		P_post(5, 1) = P_post(1, 5);
-		P_post(5, 2) = P_post(2, 5);
-		P_post(5, 3) = P_post(3, 5);
-		P_post(5, 4) = P_post(4, 5);
-		P_post(5, 5) = P_prior(5,5)-K_gps(5,0)*P_prior(0,5)-K_gps(5,1)*P_prior(1,5)-K_gps(5,2)*P_prior(3,5)-K_gps(5,3)*P_prior(4,5);
-		P_post(5, 6) = P_prior(5,6)-K_gps(5,0)*P_prior(0,6)-K_gps(5,1)*P_prior(1,6)-K_gps(5,2)*P_prior(3,6)-K_gps(5,3)*P_prior(4,6);
-		P_post(5, 7) = P_prior(5,7)-K_gps(5,0)*P_prior(0,7)-K_gps(5,1)*P_prior(1,7)-K_gps(5,2)*P_prior(3,7)-K_gps(5,3)*P_prior(4,7);
-		P_post(5, 8) = P_prior(5,8)-K_gps(5,0)*P_prior(0,8)-K_gps(5,1)*P_prior(1,8)-K_gps(5,2)*P_prior(3,8)-K_gps(5,3)*P_prior(4,8);
-		P_post(6, 0) = P_post(0, 6);
-		P_post(6, 1) = P_post(1, 6);
-		P_post(6, 2) = P_post(2, 6);
-		P_post(6, 3) = P_post(3, 6);
-		P_post(6, 4) = P_post(4, 6);
-		P_post(6, 5) = P_post(5, 6);
-		P_post(6, 6) = P_prior(6,6)-K_gps(6,0)*P_prior(0,6)-K_gps(6,1)*P_prior(1,6)-K_gps(6,2)*P_prior(3,6)-K_gps(6,3)*P_prior(4,6);
-		P_post(6, 7) = P_prior(6,7)-K_gps(6,0)*P_prior(0,7)-K_gps(6,1)*P_prior(1,7)-K_gps(6,2)*P_prior(3,7)-K_gps(6,3)*P_prior(4,7);
-		P_post(6, 8) = P_prior(6,8)-K_gps(6,0)*P_prior(0,8)-K_gps(6,1)*P_prior(1,8)-K_gps(6,2)*P_prior(3,8)-K_gps(6,3)*P_prior(4,8);
-		P_post(7, 0) = P_post(0, 7);
-		P_post(7, 1) = P_post(1, 7);
-		P_post(7, 2) = P_post(2, 7);
-		P_post(7, 3) = P_post(3, 7);
-		P_post(7, 4) = P_post(4, 7);
-		P_post(7, 5) = P_post(5, 7);
-		P_post(7, 6) = P_post(6, 7);
-		P_post(7, 7) = P_prior(7,7)-K_gps(7,0)*P_prior(0,7)-K_gps(7,1)*P_prior(1,7)-K_gps(7,2)*P_prior(3,7)-K_gps(7,3)*P_prior(4,7);
-		P_post(7, 8) = P_prior(7,8)-K_gps(7,0)*P_prior(0,8)-K_gps(7,1)*P_prior(1,8)-K_gps(7,2)*P_prior(3,8)-K_gps(7,3)*P_prior(4,8);
-		P_post(8, 0) = P_post(0, 8);
-		P_post(8, 1) = P_post(1, 8);
-		P_post(8, 2) = P_post(2, 8);
-		P_post(8, 3) = P_post(3, 8);
-		P_post(8, 4) = P_post(4, 8);
-		P_post(8, 5) = P_post(5, 8);
-		P_post(8, 6) = P_post(6, 8);
-		P_post(8, 7) = P_post(7, 8);
-		P_post(8, 8) = P_prior(8,8)-K_gps(8,0)*P_prior(0,8)-K_gps(8,1)*P_prior(1,8)-K_gps(8,2)*P_prior(3,8)-K_gps(8,3)*P_prior(4,8);
-	}
+	matrix_reset(mat_data(error_state), ESKF_INS_STATE_NUM, 1);
+	eskf_ins_scalar_update(h_pz, 2, ESKF_INS_CORRECT_BARO, resid[0], V_baro(0, 0));
+	eskf_ins_scalar_update(&h_vz, 1, ESKF_INS_CORRECT_BARO, resid[1], V_baro(1, 1));
 
 	/* P_post becoms the P_prior of other measurement's correction */
-	memcpy(mat_data(_P_prior), mat_data(_P_post), sizeof(float) * 9 * 9);
-
-	/* error state injection */
-	mat_data(nominal_state)[0] += mat_data(error_state)[0];
-	mat_data(nominal_state)[1] += mat_data(error_state)[1];
-	mat_data(nominal_state)[3] += mat_data(error_state)[3];
-	mat_data(nominal_state)[4] += mat_data(error_state)[4];
+	memcpy(_P_post, _P_prior, sizeof(_P_post));
 }
 
-void eskf_ins_barometer_correct(float barometer_z, float barometer_vz)
+/* batch update, the kalman gain is calculated with the inverse of (H*P*Ht + V) */
+static void eskf_ins_barometer_batch_update(float *resid, float lag)
 {
-	float pz_baro = barometer_z;
-	float vz_baro = barometer_vz;
-	float pz = mat_data(nominal_state)[2];
-	float vz = mat_data(nominal_state)[5];
-
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate P * Ht */
-		PHt_baro(0, 0) = P_prior(0,2);
-		PHt_baro(0, 1) = P_prior(0,5);
-		PHt_baro(1, 0) = P_prior(1,2);
-		PHt_baro(1, 1) = P_prior(1,5);
-		PHt_baro(2, 0) = P_prior(2,2);
-		PHt_baro(2, 1) = P_prior(2,5);
-		PHt_baro(3, 0) = P_prior(3,2);
-		PHt_baro(3, 1) = P_prior(3,5);
-		PHt_baro(4, 0) = P_prior(4,2);
-		PHt_baro(4, 1) = P_prior(4,5);
-		PHt_baro(5, 0) = P_prior(5,2);
-		PHt_baro(5, 1) = P_prior(5,5);
-		PHt_baro(6, 0) = P_prior(6,2);
-		PHt_baro(6, 1) = P_prior(6,5);
-		PHt_baro(7, 0) = P_prior(7,2);
-		PHt_baro(7, 1) = P_prior(7,5);
-		PHt_baro(8, 0) = P_prior(8,2);
-		PHt_baro(8, 1) = P_prior(8,5);
-	}
+	eskf_ins_barometer_covariance_update(_P_prior, _P_post, mat_data(error_state),
+	                                     lag, resid, mat_data(_V_baro));
 
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate (H * P * Ht) + V */
-		HPHt_V_baro(0, 0) = PHt_baro(2,0)+V_baro(0,0);
-		HPHt_V_baro(0, 1) = PHt_baro(2,1);
-		HPHt_V_baro(1, 0) = PHt_baro(5,0);
-		HPHt_V_baro(1, 1) = PHt_baro(5,1)+V_baro(1,1);
-	}
-
-	/* calculate kalman gain */
-	//K = P * Ht * inv(H*P*Ht + V)
-	MAT_INV(&_HPHt_V_baro, &_HPHt_V_baro_inv);
-	MAT_MULT(&_PHt_baro, &_HPHt_V_baro_inv, &_K_baro);
+	/* P_post becoms the P_prior of other measurement's correction */
+	memcpy(_P_prior, _P_post, sizeof(_P_prior));
+}
 
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate error state residual */
-		float c0 = vz-vz_baro;
-		float c1 = pz-pz_baro;
+void eskf_ins_barometer_delayed_correct(float barometer_z, float barometer_vz,
+                                        uint64_t capture_time_us)
+{
+	float pos[3], vel[3];
+	float lag = eskf_ins_history_lookup(capture_time_us, pos, vel);
 
-		mat_data(error_state)[2] = -K_baro(2,0)*c1-K_baro(2,1)*c0;
-		mat_data(error_state)[5] = -K_baro(5,0)*c1-K_baro(5,1)*c0;
-	}
+	float resid[2];
+	resid[0] = barometer_z - pos[2];
+	resid[1] = barometer_vz - vel[2];
 
-	/* codeblock for preventing nameing conflict */
-	{
-		/* calculate a posteriori process covariance matrix */
-		float c0 = K_baro(5,1)-1.0;
-		float c1 = K_baro(2,0)-1.0;
-
-		P_post(0, 0) = P_prior(0,0)-K_baro(0,0)*P_prior(2,0)-K_baro(0,1)*P_prior(5,0);
-		P_post(0, 1) = P_prior(0,1)-K_baro(0,0)*P_prior(2,1)-K_baro(0,1)*P_prior(5,1);
-		P_post(0, 2) = P_prior(0,2)-K_baro(0,0)*P_prior(2,2)-K_baro(0,1)*P_prior(5,2);
-		P_post(0, 3) = P_prior(0,3)-K_baro(0,0)*P_prior(2,3)-K_baro(0,1)*P_prior(5,3);
-		P_post(0, 4) = P_prior(0,4)-K_baro(0,0)*P_prior(2,4)-K_baro(0,1)*P_prior(5,4);
-		P_post(0, 5) = P_prior(0,5)-K_baro(0,0)*P_prior(2,5)-K_baro(0,1)*P_prior(5,5);
-		P_post(0, 6) = P_prior(0,6)-K_baro(0,0)*P_prior(2,6)-K_baro(0,1)*P_prior(5,6);
-		P_post(0, 7) = P_prior(0,7)-K_baro(0,0)*P_prior(2,7)-K_baro(0,1)*P_prior(5,7);
-		P_post(0, 8) = P_prior(0,8)-K_baro(0,0)*P_prior(2,8)-K_baro(0,1)*P_prior(5,8);
-		P_post(1, 0) = P_post(0, 1);
-		P_post(1, 1) = P_prior(1,1)-K_baro(1,0)*P_prior(2,1)-K_baro(1,1)*P_prior(5,1);
-		P_post(1, 2) = P_prior(1,2)-K_baro(1,0)*P_prior(2,2)-K_baro(1,1)*P_prior(5,2);
-		P_post(1, 3) = P_prior(1,3)-K_baro(1,0)*P_prior(2,3)-K_baro(1,1)*P_prior(5,3);
-		P_post(1, 4) = P_prior(1,4)-K_baro(1,0)*P_prior(2,4)-K_baro(1,1)*P_prior(5,4);
-		P_post(1, 5) = P_prior(1,5)-K_baro(1,0)*P_prior(2,5)-K_baro(1,1)*P_prior(5,5);
-		P_post(1, 6) = P_prior(1,6)-K_baro(1,0)*P_prior(2,6)-K_baro(1,1)*P_prior(5,6);
-		P_post(1, 7) = P_prior(1,7)-K_baro(1,0)*P_prior(2,7)-K_baro(1,1)*P_prior(5,7);
-		P_post(1, 8) = P_prior(1,8)-K_baro(1,0)*P_prior(2,8)-K_baro(1,1)*P_prior(5,8);
-		P_post(2, 0) = P_post(0, 2);
-		P_post(2, 1) = P_post(1, 2);
-		P_post(2, 2) = -P_prior(2,2)*c1-K_baro(2,1)*P_prior(5,2);
-		P_post(2, 3) = -P_prior(2,3)*c1-K_baro(2,1)*P_prior(5,3);
-		P_post(2, 4) = -P_prior(2,4)*c1-K_baro(2,1)*P_prior(5,4);
-		P_post(2, 5) = -P_prior(2,5)*c1-K_baro(2,1)*P_prior(5,5);
-		P_post(2, 6) = -P_prior(2,6)*c1-K_baro(2,1)*P_prior(5,6);
-		P_post(2, 7) = -P_prior(2,7)*c1-K_baro(2,1)*P_prior(5,7);
-		P_post(2, 8) = -P_prior(2,8)*c1-K_baro(2,1)*P_prior(5,8);
-		P_post(3, 0) = P_post(0, 3);
-		P_post(3, 1) = P_post(1, 3);
-		P_post(3, 2) = P_post(2, 3);
-		P_post(3, 3) = P_prior(3,3)-K_baro(3,0)*P_prior(2,3)-K_baro(3,1)*P_prior(5,3);
-		P_post(3, 4) = P_prior(3,4)-K_baro(3,0)*P_prior(2,4)-K_baro(3,1)*P_prior(5,4);
-		P_post(3, 5) = P_prior(3,5)-K_baro(3,0)*P_prior(2,5)-K_baro(3,1)*P_prior(5,5);
-		P_post(3, 6) = P_prior(3,6)-K_baro(3,0)*P_prior(2,6)-K_baro(3,1)*P_prior(5,6);
-		P_post(3, 7) = P_prior(3,7)-K_baro(3,0)*P_prior(2,7)-K_baro(3,1)*P_prior(5,7);
-		P_post(3, 8) = P_prior(3,8)-K_baro(3,0)*P_prior(2,8)-K_baro(3,1)*P_prior(5,8);
-		P_post(4, 0) = P_post(0, 4);
-		P_post(4, 1) = P_post(1, 4);
-		P_post(4, 2) = P_post(2, 4);
-		P_post(4, 3) = P_post(3, 4);
-		P_post(4, 4) = P_prior(4,4)-K_baro(4,0)*P_prior(2,4)-K_baro(4,1)*P_prior(5,4);
-		P_post(4, 5) = P_prior(4,5)-K_baro(4,0)*P_prior(2,5)-K_baro(4,1)*P_prior(5,5);
-		P_post(4, 6) = P_prior(4,6)-K_baro(4,0)*P_prior(2,6)-K_baro(4,1)*P_prior(5,6);
-		P_post(4, 7) = P_prior(4,7)-K_baro(4,0)*P_prior(2,7)-K_baro(4,1)*P_prior(5,7);
-		P_post(4, 8) = P_prior(4,8)-K_baro(4,0)*P_prior(2,8)-K_baro(4,1)*P_prior(5,8);
-		P_post(5, 0) = P_post(0, 5);
-		P_post(5, 1) = P_post(1, 5);
-		P_post(5, 2) = P_post(2, 5);
-		P_post(5, 3) = P_post(3, 5);
-		P_post(5, 4) = P_post(4, 5);
-		P_post(5, 5) = -P_prior(5,5)*c0-K_baro(5,0)*P_prior(2,5);
-		P_post(5, 6) = -P_prior(5,6)*c0-K_baro(5,0)*P_prior(2,6);
-		P_post(5, 7) = -P_prior(5,7)*c0-K_baro(5,0)*P_prior(2,7);
-		P_post(5, 8) = -P_prior(5,8)*c0-K_baro(5,0)*P_prior(2,8);
-		P_post(6, 0) = P_post(0, 6);
-		P_post(6, 1) = P_post(1, 6);
-		P_post(6, 2) = P_post(2, 6);
-		P_post(6, 3) = P_post(3, 6);
-		P_post(6, 4) = P_post(4, 6);
-		P_post(6, 5) = P_post(5, 6);
-		P_post(6, 6) = P_prior(6,6)-K_baro(6,0)*P_prior(2,6)-K_baro(6,1)*P_prior(5,6);
-		P_post(6, 7) = P_prior(6,7)-K_baro(6,0)*P_prior(2,7)-K_baro(6,1)*P_prior(5,7);
-		P_post(6, 8) = P_prior(6,8)-K_baro(6,0)*P_prior(2,8)-K_baro(6,1)*P_prior(5,8);
-		P_post(7, 0) = P_post(0, 7);
-		P_post(7, 1) = P_post(1, 7);
-		P_post(7, 2) = P_post(2, 7);
-		P_post(7, 3) = P_post(3, 7);
-		P_post(7, 4) = P_post(4, 7);
-		P_post(7, 5) = P_post(5, 7);
-		P_post(7, 6) = P_post(6, 7);
-		P_post(7, 7) = P_prior(7,7)-K_baro(7,0)*P_prior(2,7)-K_baro(7,1)*P_prior(5,7);
-		P_post(7, 8) = P_prior(7,8)-K_baro(7,0)*P_prior(2,8)-K_baro(7,1)*P_prior(5,8);
-		P_post(8, 0) = P_post(0, 8);
-		P_post(8, 1) = P_post(1, 8);
-		P_post(8, 2) = P_post(2, 8);
-		P_post(8, 3) = P_post(3, 8);
-		P_post(8, 4) = P_post(4, 8);
-		P_post(8, 5) = P_post(5, 8);
-		P_post(8, 6) = P_post(6, 8);
-		P_post(8, 7) = P_post(7, 8);
-		P_post(8, 8) = P_prior(8,8)-K_baro(8,0)*P_prior(2,8)-K_baro(8,1)*P_prior(5,8);
+	if(eskf_ins_update_mode == ESKF_UPDATE_SEQUENTIAL) {
+		eskf_ins_barometer_sequential_update(resid, lag);
+	} else {
+		eskf_ins_barometer_batch_update(resid, lag);
 	}
 
-	/* P_post becoms the P_prior of other measurement's correction */
-	memcpy(mat_data(_P_prior), mat_data(_P_post), sizeof(float) * 9 * 9);
+	eskf_ins_error_state_injection();
+}
 
-	/* error state injection */
-	mat_data(nominal_state)[2] += mat_data(error_state)[2];
-	mat_data(nominal_state)[5] += mat_data(error_state)[5];
+void eskf_ins_barometer_correct(float barometer_z, float barometer_vz)
+{
+	eskf_ins_barometer_delayed_correct(barometer_z, barometer_vz, UINT64_MAX);
 }
 
 void get_eskf_ins_attitude_quaternion(float *q_out)
@@ -1296,7 +729,41 @@ void get_eskf_ins_attitude_quaternion(float *q_out)
 	/* return the conjugated quaternion since we use opposite convention compared to the paper.
 	 * paper: quaternion of earth frame to body-fixed frame
 	 * us: quaternion of body-fixed frame to earth frame */
-	quaternion_conj(mat_data(nominal_state), q_out);
+	quaternion_conj(&mat_data(nominal_state)[6], q_out);
+}
+
+void get_eskf_ins_position_velocity(float *pos_enu, float *vel_enu)
+{
+	pos_enu[0] = mat_data(nominal_state)[0];
+	pos_enu[1] = mat_data(nominal_state)[1];
+	pos_enu[2] = mat_data(nominal_state)[2];
+	vel_enu[0] = mat_data(nominal_state)[3];
+	vel_enu[1] = mat_data(nominal_state)[4];
+	vel_enu[2] = mat_data(nominal_state)[5];
+}
+
+/* accelerometer [m/s^2] and gyroscope [rad/s] biases (body frame, ned) */
+void get_eskf_ins_imu_bias(float *accel_bias, float *gyro_bias)
+{
+	accel_bias[0] = mat_data(nominal_state)[10];
+	accel_bias[1] = mat_data(nominal_state)[11];
+	accel_bias[2] = mat_data(nominal_state)[12];
+	gyro_bias[0] = mat_data(nominal_state)[13];
+	gyro_bias[1] = mat_data(nominal_state)[14];
+	gyro_bias[2] = mat_data(nominal_state)[15];
+}
+
+/* unpack the process covariance matrix into a full 15x15 matrix */
+void get_eskf_ins_covariance_matrix(float *P_out)
+{
+	float recover_covariance_scaling = 1.0f / ESKF_RESCALE(1);
+
+	int r, c;
+	for(r = 0; r < ESKF_INS_STATE_NUM; r++) {
+		for(c = 0; c < ESKF_INS_STATE_NUM; c++) {
+			P_out[r * ESKF_INS_STATE_NUM + c] = P_post(r, c) * recover_covariance_scaling;
+		}
+	}
 }
 
 bool ins_eskf_estimate(attitude_t *attitude,
@@ -1326,29 +793,51 @@ bool ins_eskf_estimate(attitude_t *attitude,
 	set_rgb_led_service_navigation_on_flag(sensor_all_ready);
 
 	/* variables of sensor readings */
-	float accel[3];
+	float accel[3], accel_mean[3];
 	float gyro[3], gyro_rad[3];
 	float mag[3];
 	float longitude, latitude, gps_msl_height;
 	float gps_ned_vx, gps_ned_vy, gps_ned_vz;
 	float barometer_height, barometer_height_rate;
+	uint64_t barometer_time_us, gps_time_us;
 
 	bool recvd_compass = ins_compass_sync_buffer_available();
 	bool recvd_barometer = ins_barometer_sync_buffer_available();
 	bool recvd_gps = ins_gps_sync_buffer_available();
 
 	get_accel_lpf(accel);
-	get_gyro_lpf(gyro);
-	gyro_rad[0] = deg_to_rad(gyro[0]);
-	gyro_rad[1] = deg_to_rad(gyro[1]);
-	gyro_rad[2] = deg_to_rad(gyro[2]);
+
+	/* mean specific force and angular rate of the interval since the last prediction,
+	 * integrated with 1KHz (see imu_read_increments()). the latest sample is used if
+	 * the queue is empty */
+	float delta_angle[3], delta_vel[3], imu_dt;
+	if(imu_read_increments(delta_angle, delta_vel, &imu_dt) == true) {
+		float div_imu_dt = 1.0f / imu_dt;
+		accel_mean[0] = delta_vel[0] * div_imu_dt;
+		accel_mean[1] = delta_vel[1] * div_imu_dt;
+		accel_mean[2] = delta_vel[2] * div_imu_dt;
+		gyro_rad[0] = delta_angle[0] * div_imu_dt;
+		gyro_rad[1] = delta_angle[1] * div_imu_dt;
+		gyro_rad[2] = delta_angle[2] * div_imu_dt;
+	} else {
+		get_gyro_lpf(gyro);
+		accel_mean[0] = accel[0];
+		accel_mean[1] = accel[1];
+		accel_mean[2] = accel[2];
+		gyro_rad[0] = deg_to_rad(gyro[0]);
+		gyro_rad[1] = deg_to_rad(gyro[1]);
+		gyro_rad[2] = deg_to_rad(gyro[2]);
+	}
 
 	/* eskf prediction (400Hz) */
-	eskf_ins_predict(accel, gyro_rad);
+	eskf_ins_predict(accel_mean, gyro_rad);
 
 	/* accelerometer (gravity) correction for attitude states (400Hz) */
 	eskf_ins_accelerometer_correct(accel);
 
+	/* keep the nominal states for the delayed measurements */
+	eskf_ins_history_push(get_time_us());
+
 	/* compass correction (50Hz)*/
 	static bool compass_init = false;
 	if(recvd_compass == true) {
@@ -1367,18 +856,19 @@ bool ins_eskf_estimate(attitude_t *attitude,
 	if(recvd_barometer == true) {
 		/* get barometer data from sync buffer */
 		ins_barometer_sync_buffer_pop(&barometer_height,
-		                              &barometer_height_rate);
+		                              &barometer_height_rate, &barometer_time_us);
 		pos_enu_raw[2] = barometer_height;
 		vel_enu_raw[2] = barometer_height_rate;
 
-		eskf_ins_barometer_correct(pos_enu_raw[2], vel_enu_raw[2]);
+		eskf_ins_barometer_delayed_correct(pos_enu_raw[2], vel_enu_raw[2],
+		                                   barometer_time_us - ESKF_INS_BAROMETER_DELAY);
 	}
 
 	/* gps correction (5Hz) */
 	if(recvd_gps == true) {
 		/* get gps data from sync buffer */
 		ins_gps_sync_buffer_pop(&longitude, &latitude, &gps_msl_height,
-		                        &gps_ned_vx, &gps_ned_vy, &gps_ned_vz);
+		                        &gps_ned_vx, &gps_ned_vy, &gps_ned_vz, &gps_time_us);
 
 		/* convert gps data from geographic coordinate system to
 		 * enu frame */
@@ -1396,8 +886,9 @@ bool ins_eskf_estimate(attitude_t *attitude,
 		vel_enu_raw[0] = gps_ned_vy; //x_enu = y_ned
 		vel_enu_raw[1] = gps_ned_vx; //y_enu = x_ned
 
-		eskf_ins_gps_correct(pos_enu_raw[0], pos_enu_raw[1],
-		                     vel_enu_raw[0], vel_enu_raw[1]);
+		eskf_ins_gps_delayed_correct(pos_enu_raw[0], pos_enu_raw[1],
+		                             vel_enu_raw[0], vel_enu_raw[1],
+		                             gps_time_us - ESKF_INS_GPS_DELAY);
 	}
 
 	pos_enu_fused[0] = mat_data(nominal_state)[0];  //px
@@ -1426,25 +917,13 @@ void send_ins_eskf1_covariance_matrix_debug_message(debug_msg_t *payload)
 {
 	float recover_covariance_scaling = 1.0f / ESKF_RESCALE(1);
 
-	float p00, p11, p22, p33, p44, p55, p66, p77, p88;
-	p00 = P_post(0, 0) * recover_covariance_scaling;
-	p11 = P_post(1, 1) * recover_covariance_scaling;
-	p22 = P_post(2, 2) * recover_covariance_scaling;
-	p33 = P_post(3, 3) * recover_covariance_scaling;
-	p44 = P_post(4, 4) * recover_covariance_scaling;
-	p55 = P_post(5, 5) * recover_covariance_scaling;
-	p66 = P_post(6, 6) * recover_covariance_scaling;
-	p77 = P_post(7, 7) * recover_covariance_scaling;
-	p88 = P_post(8, 8) * recover_covariance_scaling;
-
 	pack_debug_debug_message_header(payload, MESSAGE_ID_INS_ESKF1_COVARIANCE);
-	pack_debug_debug_message_float(&p00, payload);
-	pack_debug_debug_message_float(&p11, payload);
-	pack_debug_debug_message_float(&p22, payload);
-	pack_debug_debug_message_float(&p33, payload);
-	pack_debug_debug_message_float(&p44, payload);
-	pack_debug_debug_message_float(&p55, payload);
-	pack_debug_debug_message_float(&p66, payload);
-	pack_debug_debug_message_float(&p77, payload);
-	pack_debug_debug_message_float(&p88, payload);
+
+	/* diagonal elements (p, v, theta, accel bias, gyro bias) */
+	float p_ii;
+	int i;
+	for(i = 0; i < ESKF_INS_STATE_NUM; i++) {
+		p_ii = P_post(i, i) * recover_covariance_scaling;
+		pack_debug_debug_message_float(&p_ii, payload);
+	}
 }
@@ -1,12 +1,43 @@
 #ifndef __INS_ESKF_H__
 #define __INS_ESKF_H__
 
+#include <stdint.h>
+
+/* error states: position, velocity, attitude, accelerometer bias and gyroscope bias */
+#define ESKF_INS_STATE_NUM 15
+
+/* history of the nominal position and velocity for fusing the delayed measurements
+ * at their capture time, the ring covers ESKF_INS_HISTORY_SIZE * ESKF_INS_HISTORY_DECIMATION
+ * prediction steps (640ms with 400Hz) and costs 32 bytes per entry */
+#define ESKF_INS_HISTORY_SIZE       64
+#define ESKF_INS_HISTORY_DECIMATION 4  //store every n-th prediction step
+
+/* latency between the measurement capture and the push into the sync buffer */
+#define ESKF_INS_GPS_DELAY       100000 //[us], nav-pvt output and uart transmission
+#define ESKF_INS_BAROMETER_DELAY 0      //[us]
+
 void eskf_ins_init(float dt);
+void eskf_ins_set_update_mode(int mode);
+void eskf_ins_predict(float *accel, float *gyro);
+void eskf_ins_accelerometer_correct(float *accel);
+void eskf_ins_magnetometer_correct(float *mag);
+void eskf_ins_gps_correct(float px_enu, float py_enu,
+                          float vx_enu, float vy_enu);
+void eskf_ins_barometer_correct(float barometer_z, float barometer_vz);
+void eskf_ins_history_push(uint64_t time_us);
+void eskf_ins_gps_delayed_correct(float px_enu, float py_enu,
+                                  float vx_enu, float vy_enu,
+                                  uint64_t capture_time_us);
+void eskf_ins_barometer_delayed_correct(float barometer_z, float barometer_vz,
+                                        uint64_t capture_time_us);
 bool ins_eskf_estimate(attitude_t *attitude,
                        float *pos_enu_raw, float *vel_enu_raw,
                        float *pos_enu_fused, float *vel_enu_fused);
 
 void get_eskf_ins_attitude_quaternion(float *q_out);
+void get_eskf_ins_position_velocity(float *pos_enu, float *vel_enu);
+void get_eskf_ins_imu_bias(float *accel_bias, float *gyro_bias);
+void get_eskf_ins_covariance_matrix(float *P_out);
 
 void send_ins_eskf1_covariance_matrix_debug_message(debug_msg_t *payload);
 
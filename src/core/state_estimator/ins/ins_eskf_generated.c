@@ -0,0 +1,1314 @@
+/* generated by tools/eskf_codegen.py, do not edit */
+
+#include "matrix.h"
+#include "ins_eskf_generated.h"
+
+#define P_prior(r, c) _P_prior[SYM_MAT_INDEX(15, r, c)]
+#define P_post(r, c)  _P_post[SYM_MAT_INDEX(15, r, c)]
+
+/* P_prior = F * P_post * Ft + Q, F is the error state transition matrix
+ * and Q has the variances of the acceleration and angular velocity noises
+ * and of the bias random walks, accel and gyro are the bias corrected inputs */
+void eskf_ins_covariance_predict(const float *_P_post, float *_P_prior, const float *R,
+                                 const float *accel, const float *gyro, const float *Q_i, float dt)
+{
+	/* non-zero elements of F (except the identity and dt blocks) */
+	float c0 = dt*gyro[2];
+	float c1 = dt*gyro[1];
+	float c2 = dt*gyro[0];
+	float F_3_6 = dt*(R[5]*accel[1] - R[4]*accel[2]);
+	float F_3_7 = dt*(R[3]*accel[2] - R[5]*accel[0]);
+	float F_6_7 = c0;
+	float F_3_8 = dt*(R[4]*accel[0] - R[3]*accel[1]);
+	float F_6_8 = -c1;
+	float F_4_6 = dt*(R[2]*accel[1] - R[1]*accel[2]);
+	float F_7_6 = -c0;
+	float F_4_7 = dt*(R[0]*accel[2] - R[2]*accel[0]);
+	float F_4_8 = dt*(R[1]*accel[0] - R[0]*accel[1]);
+	float F_7_8 = c2;
+	float F_5_6 = dt*(R[7]*accel[2] - R[8]*accel[1]);
+	float F_8_6 = c1;
+	float F_5_7 = dt*(R[8]*accel[0] - R[6]*accel[2]);
+	float F_8_7 = -c2;
+	float F_5_8 = dt*(R[6]*accel[1] - R[7]*accel[0]);
+	float F_3_9 = -R[3]*dt;
+	float F_3_10 = -R[4]*dt;
+	float F_3_11 = -R[5]*dt;
+	float F_4_9 = -R[0]*dt;
+	float F_4_10 = -R[1]*dt;
+	float F_4_11 = -R[2]*dt;
+	float F_5_9 = R[6]*dt;
+	float F_5_10 = R[7]*dt;
+	float F_5_11 = R[8]*dt;
+
+	/* calculate F * P_post */
+	float c3 = P_post(3, 4)*dt;
+	float c4 = P_post(3, 5)*dt;
+	float c5 = P_post(4, 5)*dt;
+	float c6 = -P_post(12, 13)*dt;
+	float c7 = -P_post(12, 14)*dt;
+	float c8 = -P_post(13, 14)*dt;
+	float FP_0_0 = P_post(0, 0) + P_post(0, 3)*dt;
+	float FP_0_1 = P_post(0, 1) + P_post(1, 3)*dt;
+	float FP_0_2 = P_post(0, 2) + P_post(2, 3)*dt;
+	float FP_0_3 = P_post(0, 3) + P_post(3, 3)*dt;
+	float FP_0_4 = P_post(0, 4) + c3;
+	float FP_0_5 = P_post(0, 5) + c4;
+	float FP_0_6 = P_post(0, 6) + P_post(3, 6)*dt;
+	float FP_0_7 = P_post(0, 7) + P_post(3, 7)*dt;
+	float FP_0_8 = P_post(0, 8) + P_post(3, 8)*dt;
+	float FP_0_9 = P_post(0, 9) + P_post(3, 9)*dt;
+	float FP_0_10 = P_post(0, 10) + P_post(3, 10)*dt;
+	float FP_0_11 = P_post(0, 11) + P_post(3, 11)*dt;
+	float FP_0_12 = P_post(0, 12) + P_post(3, 12)*dt;
+	float FP_0_13 = P_post(0, 13) + P_post(3, 13)*dt;
+	float FP_0_14 = P_post(0, 14) + P_post(3, 14)*dt;
+	float FP_1_1 = P_post(1, 1) + P_post(1, 4)*dt;
+	float FP_1_2 = P_post(1, 2) + P_post(2, 4)*dt;
+	float FP_1_3 = P_post(1, 3) + c3;
+	float FP_1_4 = P_post(1, 4) + P_post(4, 4)*dt;
+	float FP_1_5 = P_post(1, 5) + c5;
+	float FP_1_6 = P_post(1, 6) + P_post(4, 6)*dt;
+	float FP_1_7 = P_post(1, 7) + P_post(4, 7)*dt;
+	float FP_1_8 = P_post(1, 8) + P_post(4, 8)*dt;
+	float FP_1_9 = P_post(1, 9) + P_post(4, 9)*dt;
+	float FP_1_10 = P_post(1, 10) + P_post(4, 10)*dt;
+	float FP_1_11 = P_post(1, 11) + P_post(4, 11)*dt;
+	float FP_1_12 = P_post(1, 12) + P_post(4, 12)*dt;
+	float FP_1_13 = P_post(1, 13) + P_post(4, 13)*dt;
+	float FP_1_14 = P_post(1, 14) + P_post(4, 14)*dt;
+	float FP_2_2 = P_post(2, 2) + P_post(2, 5)*dt;
+	float FP_2_3 = P_post(2, 3) + c4;
+	float FP_2_4 = P_post(2, 4) + c5;
+	float FP_2_5 = P_post(2, 5) + P_post(5, 5)*dt;
+	float FP_2_6 = P_post(2, 6) + P_post(5, 6)*dt;
+	float FP_2_7 = P_post(2, 7) + P_post(5, 7)*dt;
+	float FP_2_8 = P_post(2, 8) + P_post(5, 8)*dt;
+	float FP_2_9 = P_post(2, 9) + P_post(5, 9)*dt;
+	float FP_2_10 = P_post(2, 10) + P_post(5, 10)*dt;
+	float FP_2_11 = P_post(2, 11) + P_post(5, 11)*dt;
+	float FP_2_12 = P_post(2, 12) + P_post(5, 12)*dt;
+	float FP_2_13 = P_post(2, 13) + P_post(5, 13)*dt;
+	float FP_2_14 = P_post(2, 14) + P_post(5, 14)*dt;
+	float FP_3_3 = F_3_10*P_post(3, 10) + F_3_11*P_post(3, 11) + F_3_6*P_post(3, 6) + F_3_7*P_post(3, 7) + F_3_8*P_post(3, 8) + F_3_9*P_post(3, 9) + P_post(3, 3);
+	float FP_3_4 = F_3_10*P_post(4, 10) + F_3_11*P_post(4, 11) + F_3_6*P_post(4, 6) + F_3_7*P_post(4, 7) + F_3_8*P_post(4, 8) + F_3_9*P_post(4, 9) + P_post(3, 4);
+	float FP_3_5 = F_3_10*P_post(5, 10) + F_3_11*P_post(5, 11) + F_3_6*P_post(5, 6) + F_3_7*P_post(5, 7) + F_3_8*P_post(5, 8) + F_3_9*P_post(5, 9) + P_post(3, 5);
+	float FP_3_6 = F_3_10*P_post(6, 10) + F_3_11*P_post(6, 11) + F_3_6*P_post(6, 6) + F_3_7*P_post(6, 7) + F_3_8*P_post(6, 8) + F_3_9*P_post(6, 9) + P_post(3, 6);
+	float FP_3_7 = F_3_10*P_post(7, 10) + F_3_11*P_post(7, 11) + F_3_6*P_post(6, 7) + F_3_7*P_post(7, 7) + F_3_8*P_post(7, 8) + F_3_9*P_post(7, 9) + P_post(3, 7);
+	float FP_3_8 = F_3_10*P_post(8, 10) + F_3_11*P_post(8, 11) + F_3_6*P_post(6, 8) + F_3_7*P_post(7, 8) + F_3_8*P_post(8, 8) + F_3_9*P_post(8, 9) + P_post(3, 8);
+	float FP_3_9 = F_3_10*P_post(9, 10) + F_3_11*P_post(9, 11) + F_3_6*P_post(6, 9) + F_3_7*P_post(7, 9) + F_3_8*P_post(8, 9) + F_3_9*P_post(9, 9) + P_post(3, 9);
+	float FP_3_10 = F_3_10*P_post(10, 10) + F_3_11*P_post(10, 11) + F_3_6*P_post(6, 10) + F_3_7*P_post(7, 10) + F_3_8*P_post(8, 10) + F_3_9*P_post(9, 10) + P_post(3, 10);
+	float FP_3_11 = F_3_10*P_post(10, 11) + F_3_11*P_post(11, 11) + F_3_6*P_post(6, 11) + F_3_7*P_post(7, 11) + F_3_8*P_post(8, 11) + F_3_9*P_post(9, 11) + P_post(3, 11);
+	float FP_3_12 = F_3_10*P_post(10, 12) + F_3_11*P_post(11, 12) + F_3_6*P_post(6, 12) + F_3_7*P_post(7, 12) + F_3_8*P_post(8, 12) + F_3_9*P_post(9, 12) + P_post(3, 12);
+	float FP_3_13 = F_3_10*P_post(10, 13) + F_3_11*P_post(11, 13) + F_3_6*P_post(6, 13) + F_3_7*P_post(7, 13) + F_3_8*P_post(8, 13) + F_3_9*P_post(9, 13) + P_post(3, 13);
+	float FP_3_14 = F_3_10*P_post(10, 14) + F_3_11*P_post(11, 14) + F_3_6*P_post(6, 14) + F_3_7*P_post(7, 14) + F_3_8*P_post(8, 14) + F_3_9*P_post(9, 14) + P_post(3, 14);
+	float FP_4_4 = F_4_10*P_post(4, 10) + F_4_11*P_post(4, 11) + F_4_6*P_post(4, 6) + F_4_7*P_post(4, 7) + F_4_8*P_post(4, 8) + F_4_9*P_post(4, 9) + P_post(4, 4);
+	float FP_4_5 = F_4_10*P_post(5, 10) + F_4_11*P_post(5, 11) + F_4_6*P_post(5, 6) + F_4_7*P_post(5, 7) + F_4_8*P_post(5, 8) + F_4_9*P_post(5, 9) + P_post(4, 5);
+	float FP_4_6 = F_4_10*P_post(6, 10) + F_4_11*P_post(6, 11) + F_4_6*P_post(6, 6) + F_4_7*P_post(6, 7) + F_4_8*P_post(6, 8) + F_4_9*P_post(6, 9) + P_post(4, 6);
+	float FP_4_7 = F_4_10*P_post(7, 10) + F_4_11*P_post(7, 11) + F_4_6*P_post(6, 7) + F_4_7*P_post(7, 7) + F_4_8*P_post(7, 8) + F_4_9*P_post(7, 9) + P_post(4, 7);
+	float FP_4_8 = F_4_10*P_post(8, 10) + F_4_11*P_post(8, 11) + F_4_6*P_post(6, 8) + F_4_7*P_post(7, 8) + F_4_8*P_post(8, 8) + F_4_9*P_post(8, 9) + P_post(4, 8);
+	float FP_4_9 = F_4_10*P_post(9, 10) + F_4_11*P_post(9, 11) + F_4_6*P_post(6, 9) + F_4_7*P_post(7, 9) + F_4_8*P_post(8, 9) + F_4_9*P_post(9, 9) + P_post(4, 9);
+	float FP_4_10 = F_4_10*P_post(10, 10) + F_4_11*P_post(10, 11) + F_4_6*P_post(6, 10) + F_4_7*P_post(7, 10) + F_4_8*P_post(8, 10) + F_4_9*P_post(9, 10) + P_post(4, 10);
+	float FP_4_11 = F_4_10*P_post(10, 11) + F_4_11*P_post(11, 11) + F_4_6*P_post(6, 11) + F_4_7*P_post(7, 11) + F_4_8*P_post(8, 11) + F_4_9*P_post(9, 11) + P_post(4, 11);
+	float FP_4_12 = F_4_10*P_post(10, 12) + F_4_11*P_post(11, 12) + F_4_6*P_post(6, 12) + F_4_7*P_post(7, 12) + F_4_8*P_post(8, 12) + F_4_9*P_post(9, 12) + P_post(4, 12);
+	float FP_4_13 = F_4_10*P_post(10, 13) + F_4_11*P_post(11, 13) + F_4_6*P_post(6, 13) + F_4_7*P_post(7, 13) + F_4_8*P_post(8, 13) + F_4_9*P_post(9, 13) + P_post(4, 13);
+	float FP_4_14 = F_4_10*P_post(10, 14) + F_4_11*P_post(11, 14) + F_4_6*P_post(6, 14) + F_4_7*P_post(7, 14) + F_4_8*P_post(8, 14) + F_4_9*P_post(9, 14) + P_post(4, 14);
+	float FP_5_5 = F_5_10*P_post(5, 10) + F_5_11*P_post(5, 11) + F_5_6*P_post(5, 6) + F_5_7*P_post(5, 7) + F_5_8*P_post(5, 8) + F_5_9*P_post(5, 9) + P_post(5, 5);
+	float FP_5_6 = F_5_10*P_post(6, 10) + F_5_11*P_post(6, 11) + F_5_6*P_post(6, 6) + F_5_7*P_post(6, 7) + F_5_8*P_post(6, 8) + F_5_9*P_post(6, 9) + P_post(5, 6);
+	float FP_5_7 = F_5_10*P_post(7, 10) + F_5_11*P_post(7, 11) + F_5_6*P_post(6, 7) + F_5_7*P_post(7, 7) + F_5_8*P_post(7, 8) + F_5_9*P_post(7, 9) + P_post(5, 7);
+	float FP_5_8 = F_5_10*P_post(8, 10) + F_5_11*P_post(8, 11) + F_5_6*P_post(6, 8) + F_5_7*P_post(7, 8) + F_5_8*P_post(8, 8) + F_5_9*P_post(8, 9) + P_post(5, 8);
+	float FP_5_9 = F_5_10*P_post(9, 10) + F_5_11*P_post(9, 11) + F_5_6*P_post(6, 9) + F_5_7*P_post(7, 9) + F_5_8*P_post(8, 9) + F_5_9*P_post(9, 9) + P_post(5, 9);
+	float FP_5_10 = F_5_10*P_post(10, 10) + F_5_11*P_post(10, 11) + F_5_6*P_post(6, 10) + F_5_7*P_post(7, 10) + F_5_8*P_post(8, 10) + F_5_9*P_post(9, 10) + P_post(5, 10);
+	float FP_5_11 = F_5_10*P_post(10, 11) + F_5_11*P_post(11, 11) + F_5_6*P_post(6, 11) + F_5_7*P_post(7, 11) + F_5_8*P_post(8, 11) + F_5_9*P_post(9, 11) + P_post(5, 11);
+	float FP_5_12 = F_5_10*P_post(10, 12) + F_5_11*P_post(11, 12) + F_5_6*P_post(6, 12) + F_5_7*P_post(7, 12) + F_5_8*P_post(8, 12) + F_5_9*P_post(9, 12) + P_post(5, 12);
+	float FP_5_13 = F_5_10*P_post(10, 13) + F_5_11*P_post(11, 13) + F_5_6*P_post(6, 13) + F_5_7*P_post(7, 13) + F_5_8*P_post(8, 13) + F_5_9*P_post(9, 13) + P_post(5, 13);
+	float FP_5_14 = F_5_10*P_post(10, 14) + F_5_11*P_post(11, 14) + F_5_6*P_post(6, 14) + F_5_7*P_post(7, 14) + F_5_8*P_post(8, 14) + F_5_9*P_post(9, 14) + P_post(5, 14);
+	float FP_6_6 = F_6_7*P_post(6, 7) + F_6_8*P_post(6, 8) + P_post(6, 6) - P_post(6, 12)*dt;
+	float FP_6_7 = F_6_7*P_post(7, 7) + F_6_8*P_post(7, 8) + P_post(6, 7) - P_post(7, 12)*dt;
+	float FP_6_8 = F_6_7*P_post(7, 8) + F_6_8*P_post(8, 8) + P_post(6, 8) - P_post(8, 12)*dt;
+	float FP_6_9 = F_6_7*P_post(7, 9) + F_6_8*P_post(8, 9) + P_post(6, 9) - P_post(9, 12)*dt;
+	float FP_6_10 = F_6_7*P_post(7, 10) + F_6_8*P_post(8, 10) + P_post(6, 10) - P_post(10, 12)*dt;
+	float FP_6_11 = F_6_7*P_post(7, 11) + F_6_8*P_post(8, 11) + P_post(6, 11) - P_post(11, 12)*dt;
+	float FP_6_12 = F_6_7*P_post(7, 12) + F_6_8*P_post(8, 12) + P_post(6, 12) - P_post(12, 12)*dt;
+	float FP_6_13 = F_6_7*P_post(7, 13) + F_6_8*P_post(8, 13) + P_post(6, 13) + c6;
+	float FP_6_14 = F_6_7*P_post(7, 14) + F_6_8*P_post(8, 14) + P_post(6, 14) + c7;
+	float FP_7_6 = F_7_6*P_post(6, 6) + F_7_8*P_post(6, 8) + P_post(6, 7) - P_post(6, 13)*dt;
+	float FP_7_7 = F_7_6*P_post(6, 7) + F_7_8*P_post(7, 8) + P_post(7, 7) - P_post(7, 13)*dt;
+	float FP_7_8 = F_7_6*P_post(6, 8) + F_7_8*P_post(8, 8) + P_post(7, 8) - P_post(8, 13)*dt;
+	float FP_7_9 = F_7_6*P_post(6, 9) + F_7_8*P_post(8, 9) + P_post(7, 9) - P_post(9, 13)*dt;
+	float FP_7_10 = F_7_6*P_post(6, 10) + F_7_8*P_post(8, 10) + P_post(7, 10) - P_post(10, 13)*dt;
+	float FP_7_11 = F_7_6*P_post(6, 11) + F_7_8*P_post(8, 11) + P_post(7, 11) - P_post(11, 13)*dt;
+	float FP_7_12 = F_7_6*P_post(6, 12) + F_7_8*P_post(8, 12) + P_post(7, 12) + c6;
+	float FP_7_13 = F_7_6*P_post(6, 13) + F_7_8*P_post(8, 13) + P_post(7, 13) - P_post(13, 13)*dt;
+	float FP_7_14 = F_7_6*P_post(6, 14) + F_7_8*P_post(8, 14) + P_post(7, 14) + c8;
+	float FP_8_6 = F_8_6*P_post(6, 6) + F_8_7*P_post(6, 7) + P_post(6, 8) - P_post(6, 14)*dt;
+	float FP_8_7 = F_8_6*P_post(6, 7) + F_8_7*P_post(7, 7) + P_post(7, 8) - P_post(7, 14)*dt;
+	float FP_8_8 = F_8_6*P_post(6, 8) + F_8_7*P_post(7, 8) + P_post(8, 8) - P_post(8, 14)*dt;
+	float FP_8_9 = F_8_6*P_post(6, 9) + F_8_7*P_post(7, 9) + P_post(8, 9) - P_post(9, 14)*dt;
+	float FP_8_10 = F_8_6*P_post(6, 10) + F_8_7*P_post(7, 10) + P_post(8, 10) - P_post(10, 14)*dt;
+	float FP_8_11 = F_8_6*P_post(6, 11) + F_8_7*P_post(7, 11) + P_post(8, 11) - P_post(11, 14)*dt;
+	float FP_8_12 = F_8_6*P_post(6, 12) + F_8_7*P_post(7, 12) + P_post(8, 12) + c7;
+	float FP_8_13 = F_8_6*P_post(6, 13) + F_8_7*P_post(7, 13) + P_post(8, 13) + c8;
+	float FP_8_14 = F_8_6*P_post(6, 14) + F_8_7*P_post(7, 14) + P_post(8, 14) - P_post(14, 14)*dt;
+
+	/* calculate the a priori process covariance matrix */
+	P_prior(0, 0) = FP_0_0 + FP_0_3*dt;
+	P_prior(0, 1) = FP_0_1 + FP_0_4*dt;
+	P_prior(0, 2) = FP_0_2 + FP_0_5*dt;
+	P_prior(0, 3) = FP_0_10*F_3_10 + FP_0_11*F_3_11 + FP_0_3 + FP_0_6*F_3_6 + FP_0_7*F_3_7 + FP_0_8*F_3_8 + FP_0_9*F_3_9;
+	P_prior(0, 4) = FP_0_10*F_4_10 + FP_0_11*F_4_11 + FP_0_4 + FP_0_6*F_4_6 + FP_0_7*F_4_7 + FP_0_8*F_4_8 + FP_0_9*F_4_9;
+	P_prior(0, 5) = FP_0_10*F_5_10 + FP_0_11*F_5_11 + FP_0_5 + FP_0_6*F_5_6 + FP_0_7*F_5_7 + FP_0_8*F_5_8 + FP_0_9*F_5_9;
+	P_prior(0, 6) = FP_0_6 + FP_0_7*F_6_7 + FP_0_8*F_6_8 - FP_0_12*dt;
+	P_prior(0, 7) = FP_0_6*F_7_6 + FP_0_7 + FP_0_8*F_7_8 - FP_0_13*dt;
+	P_prior(0, 8) = FP_0_6*F_8_6 + FP_0_7*F_8_7 + FP_0_8 - FP_0_14*dt;
+	P_prior(0, 9) = FP_0_9;
+	P_prior(0, 10) = FP_0_10;
+	P_prior(0, 11) = FP_0_11;
+	P_prior(0, 12) = FP_0_12;
+	P_prior(0, 13) = FP_0_13;
+	P_prior(0, 14) = FP_0_14;
+	P_prior(1, 1) = FP_1_1 + FP_1_4*dt;
+	P_prior(1, 2) = FP_1_2 + FP_1_5*dt;
+	P_prior(1, 3) = FP_1_10*F_3_10 + FP_1_11*F_3_11 + FP_1_3 + FP_1_6*F_3_6 + FP_1_7*F_3_7 + FP_1_8*F_3_8 + FP_1_9*F_3_9;
+	P_prior(1, 4) = FP_1_10*F_4_10 + FP_1_11*F_4_11 + FP_1_4 + FP_1_6*F_4_6 + FP_1_7*F_4_7 + FP_1_8*F_4_8 + FP_1_9*F_4_9;
+	P_prior(1, 5) = FP_1_10*F_5_10 + FP_1_11*F_5_11 + FP_1_5 + FP_1_6*F_5_6 + FP_1_7*F_5_7 + FP_1_8*F_5_8 + FP_1_9*F_5_9;
+	P_prior(1, 6) = FP_1_6 + FP_1_7*F_6_7 + FP_1_8*F_6_8 - FP_1_12*dt;
+	P_prior(1, 7) = FP_1_6*F_7_6 + FP_1_7 + FP_1_8*F_7_8 - FP_1_13*dt;
+	P_prior(1, 8) = FP_1_6*F_8_6 + FP_1_7*F_8_7 + FP_1_8 - FP_1_14*dt;
+	P_prior(1, 9) = FP_1_9;
+	P_prior(1, 10) = FP_1_10;
+	P_prior(1, 11) = FP_1_11;
+	P_prior(1, 12) = FP_1_12;
+	P_prior(1, 13) = FP_1_13;
+	P_prior(1, 14) = FP_1_14;
+	P_prior(2, 2) = FP_2_2 + FP_2_5*dt;
+	P_prior(2, 3) = FP_2_10*F_3_10 + FP_2_11*F_3_11 + FP_2_3 + FP_2_6*F_3_6 + FP_2_7*F_3_7 + FP_2_8*F_3_8 + FP_2_9*F_3_9;
+	P_prior(2, 4) = FP_2_10*F_4_10 + FP_2_11*F_4_11 + FP_2_4 + FP_2_6*F_4_6 + FP_2_7*F_4_7 + FP_2_8*F_4_8 + FP_2_9*F_4_9;
+	P_prior(2, 5) = FP_2_10*F_5_10 + FP_2_11*F_5_11 + FP_2_5 + FP_2_6*F_5_6 + FP_2_7*F_5_7 + FP_2_8*F_5_8 + FP_2_9*F_5_9;
+	P_prior(2, 6) = FP_2_6 + FP_2_7*F_6_7 + FP_2_8*F_6_8 - FP_2_12*dt;
+	P_prior(2, 7) = FP_2_6*F_7_6 + FP_2_7 + FP_2_8*F_7_8 - FP_2_13*dt;
+	P_prior(2, 8) = FP_2_6*F_8_6 + FP_2_7*F_8_7 + FP_2_8 - FP_2_14*dt;
+	P_prior(2, 9) = FP_2_9;
+	P_prior(2, 10) = FP_2_10;
+	P_prior(2, 11) = FP_2_11;
+	P_prior(2, 12) = FP_2_12;
+	P_prior(2, 13) = FP_2_13;
+	P_prior(2, 14) = FP_2_14;
+	P_prior(3, 3) = FP_3_10*F_3_10 + FP_3_11*F_3_11 + FP_3_3 + FP_3_6*F_3_6 + FP_3_7*F_3_7 + FP_3_8*F_3_8 + FP_3_9*F_3_9 + Q_i[0];
+	P_prior(3, 4) = FP_3_10*F_4_10 + FP_3_11*F_4_11 + FP_3_4 + FP_3_6*F_4_6 + FP_3_7*F_4_7 + FP_3_8*F_4_8 + FP_3_9*F_4_9;
+	P_prior(3, 5) = FP_3_10*F_5_10 + FP_3_11*F_5_11 + FP_3_5 + FP_3_6*F_5_6 + FP_3_7*F_5_7 + FP_3_8*F_5_8 + FP_3_9*F_5_9;
+	P_prior(3, 6) = FP_3_6 + FP_3_7*F_6_7 + FP_3_8*F_6_8 - FP_3_12*dt;
+	P_prior(3, 7) = FP_3_6*F_7_6 + FP_3_7 + FP_3_8*F_7_8 - FP_3_13*dt;
+	P_prior(3, 8) = FP_3_6*F_8_6 + FP_3_7*F_8_7 + FP_3_8 - FP_3_14*dt;
+	P_prior(3, 9) = FP_3_9;
+	P_prior(3, 10) = FP_3_10;
+	P_prior(3, 11) = FP_3_11;
+	P_prior(3, 12) = FP_3_12;
+	P_prior(3, 13) = FP_3_13;
+	P_prior(3, 14) = FP_3_14;
+	P_prior(4, 4) = FP_4_10*F_4_10 + FP_4_11*F_4_11 + FP_4_4 + FP_4_6*F_4_6 + FP_4_7*F_4_7 + FP_4_8*F_4_8 + FP_4_9*F_4_9 + Q_i[13];
+	P_prior(4, 5) = FP_4_10*F_5_10 + FP_4_11*F_5_11 + FP_4_5 + FP_4_6*F_5_6 + FP_4_7*F_5_7 + FP_4_8*F_5_8 + FP_4_9*F_5_9;
+	P_prior(4, 6) = FP_4_6 + FP_4_7*F_6_7 + FP_4_8*F_6_8 - FP_4_12*dt;
+	P_prior(4, 7) = FP_4_6*F_7_6 + FP_4_7 + FP_4_8*F_7_8 - FP_4_13*dt;
+	P_prior(4, 8) = FP_4_6*F_8_6 + FP_4_7*F_8_7 + FP_4_8 - FP_4_14*dt;
+	P_prior(4, 9) = FP_4_9;
+	P_prior(4, 10) = FP_4_10;
+	P_prior(4, 11) = FP_4_11;
+	P_prior(4, 12) = FP_4_12;
+	P_prior(4, 13) = FP_4_13;
+	P_prior(4, 14) = FP_4_14;
+	P_prior(5, 5) = FP_5_10*F_5_10 + FP_5_11*F_5_11 + FP_5_5 + FP_5_6*F_5_6 + FP_5_7*F_5_7 + FP_5_8*F_5_8 + FP_5_9*F_5_9 + Q_i[26];
+	P_prior(5, 6) = FP_5_6 + FP_5_7*F_6_7 + FP_5_8*F_6_8 - FP_5_12*dt;
+	P_prior(5, 7) = FP_5_6*F_7_6 + FP_5_7 + FP_5_8*F_7_8 - FP_5_13*dt;
+	P_prior(5, 8) = FP_5_6*F_8_6 + FP_5_7*F_8_7 + FP_5_8 - FP_5_14*dt;
+	P_prior(5, 9) = FP_5_9;
+	P_prior(5, 10) = FP_5_10;
+	P_prior(5, 11) = FP_5_11;
+	P_prior(5, 12) = FP_5_12;
+	P_prior(5, 13) = FP_5_13;
+	P_prior(5, 14) = FP_5_14;
+	P_prior(6, 6) = FP_6_6 + FP_6_7*F_6_7 + FP_6_8*F_6_8 + Q_i[39] - FP_6_12*dt;
+	P_prior(6, 7) = FP_6_6*F_7_6 + FP_6_7 + FP_6_8*F_7_8 - FP_6_13*dt;
+	P_prior(6, 8) = FP_6_6*F_8_6 + FP_6_7*F_8_7 + FP_6_8 - FP_6_14*dt;
+	P_prior(6, 9) = FP_6_9;
+	P_prior(6, 10) = FP_6_10;
+	P_prior(6, 11) = FP_6_11;
+	P_prior(6, 12) = FP_6_12;
+	P_prior(6, 13) = FP_6_13;
+	P_prior(6, 14) = FP_6_14;
+	P_prior(7, 7) = FP_7_6*F_7_6 + FP_7_7 + FP_7_8*F_7_8 + Q_i[52] - FP_7_13*dt;
+	P_prior(7, 8) = FP_7_6*F_8_6 + FP_7_7*F_8_7 + FP_7_8 - FP_7_14*dt;
+	P_prior(7, 9) = FP_7_9;
+	P_prior(7, 10) = FP_7_10;
+	P_prior(7, 11) = FP_7_11;
+	P_prior(7, 12) = FP_7_12;
+	P_prior(7, 13) = FP_7_13;
+	P_prior(7, 14) = FP_7_14;
+	P_prior(8, 8) = FP_8_6*F_8_6 + FP_8_7*F_8_7 + FP_8_8 + Q_i[65] - FP_8_14*dt;
+	P_prior(8, 9) = FP_8_9;
+	P_prior(8, 10) = FP_8_10;
+	P_prior(8, 11) = FP_8_11;
+	P_prior(8, 12) = FP_8_12;
+	P_prior(8, 13) = FP_8_13;
+	P_prior(8, 14) = FP_8_14;
+	P_prior(9, 9) = P_post(9, 9) + Q_i[78];
+	P_prior(9, 10) = P_post(9, 10);
+	P_prior(9, 11) = P_post(9, 11);
+	P_prior(9, 12) = P_post(9, 12);
+	P_prior(9, 13) = P_post(9, 13);
+	P_prior(9, 14) = P_post(9, 14);
+	P_prior(10, 10) = P_post(10, 10) + Q_i[91];
+	P_prior(10, 11) = P_post(10, 11);
+	P_prior(10, 12) = P_post(10, 12);
+	P_prior(10, 13) = P_post(10, 13);
+	P_prior(10, 14) = P_post(10, 14);
+	P_prior(11, 11) = P_post(11, 11) + Q_i[104];
+	P_prior(11, 12) = P_post(11, 12);
+	P_prior(11, 13) = P_post(11, 13);
+	P_prior(11, 14) = P_post(11, 14);
+	P_prior(12, 12) = P_post(12, 12) + Q_i[117];
+	P_prior(12, 13) = P_post(12, 13);
+	P_prior(12, 14) = P_post(12, 14);
+	P_prior(13, 13) = P_post(13, 13) + Q_i[130];
+	P_prior(13, 14) = P_post(13, 14);
+	P_prior(14, 14) = P_post(14, 14) + Q_i[143];
+}
+
+/* predicted gravity vector (body frame) and the attitude error
+ * and accelerometer bias columns (6-11) of the measurement matrix */
+void eskf_ins_accelerometer_measurement(const float *q, const float *g, float div_norm, float *h,
+                                        float *H)
+{
+	/* predicted measurement and measurement matrix */
+	float c0 = q[0]*q[2] - q[1]*q[3];
+	float c1 = -2.0f*c0;
+	float c2 = 2.0f*(q[0]*q[1] + q[2]*q[3]);
+	float c3 = q[0]*q[0] + q[3]*q[3] - q[1]*q[1] - q[2]*q[2];
+	float c4 = div_norm*g[0];
+	float c5 = c4*g[1];
+	float c6 = c4*g[2];
+	float c7 = div_norm*g[1]*g[2];
+	h[0] = c1;
+	h[1] = c2;
+	h[2] = c3;
+	H[0] = 0.0f;
+	H[1] = -c3;
+	H[2] = c2;
+	H[3] = div_norm*(g[0]*g[0] - 1.0f);
+	H[4] = c5;
+	H[5] = c6;
+	H[6] = c3;
+	H[7] = 0.0f;
+	H[8] = 2.0f*c0;
+	H[9] = c5;
+	H[10] = div_norm*(g[1]*g[1] - 1.0f);
+	H[11] = c7;
+	H[12] = -c2;
+	H[13] = c1;
+	H[14] = 0.0f;
+	H[15] = c6;
+	H[16] = c7;
+	H[17] = div_norm*(g[2]*g[2] - 1.0f);
+}
+
+/* predicted magnetic field vector (body frame) and the attitude
+ * error columns (6-8) of the measurement matrix */
+void eskf_ins_magnetometer_measurement(const float *q, float gamma, float mz, float *h, float *H)
+{
+	/* predicted measurement and measurement matrix */
+	float c0 = q[0]*q[2];
+	float c1 = q[1]*q[3];
+	float c2 = 2.0f*mz;
+	float c3 = q[1]*q[1];
+	float c4 = q[3]*q[3];
+	float c5 = q[0]*q[0];
+	float c6 = q[2]*q[2];
+	float c7 = c5 - c6;
+	float c8 = q[0]*q[3];
+	float c9 = q[1]*q[2];
+	float c10 = q[0]*q[1];
+	float c11 = q[2]*q[3];
+	float c12 = 2.0f*gamma;
+	float c13 = c0*c12 + c1*c12 + c4*mz + c5*mz - c3*mz - c6*mz;
+	float c14 = c10*mz + c11*mz + c9*gamma - c8*gamma;
+	float c15 = c1*c2 + c3*gamma + c5*gamma - c4*gamma - c6*gamma - 2.0f*mz*q[0]*q[2];
+	h[0] = gamma*(c3 + c7 - c4) - c2*(c0 - c1);
+	h[1] = 2.0f*mz*(c10 + c11) - 2.0f*gamma*(c8 - c9);
+	h[2] = c12*(c0 + c1) + mz*(c4 + c7 - c3);
+	H[0] = 0.0f;
+	H[1] = -c13;
+	H[2] = 2.0f*c14;
+	H[3] = c13;
+	H[4] = 0.0f;
+	H[5] = -c15;
+	H[6] = -2.0f*c14;
+	H[7] = c15;
+	H[8] = 0.0f;
+}
+
+/* kalman gain, error state and a posteriori covariance of the
+ * accelerometer update, H contains the columns 6-11 of the measurement
+ * matrix (see eskf_ins_accelerometer_measurement()) */
+void eskf_ins_accelerometer_covariance_update(const float *_P_prior, float *_P_post, float *delta_x,
+                                              const float *H, const float *resid, const float *V)
+{
+	/* calculate P * Ht */
+	float PHt_0_0 = H[1]*P_prior(0, 7) + H[2]*P_prior(0, 8) + H[3]*P_prior(0, 9) + H[4]*P_prior(0, 10) + H[5]*P_prior(0, 11);
+	float PHt_0_1 = H[6]*P_prior(0, 6) + H[8]*P_prior(0, 8) + H[9]*P_prior(0, 9) + H[10]*P_prior(0, 10) + H[11]*P_prior(0, 11);
+	float PHt_0_2 = H[12]*P_prior(0, 6) + H[13]*P_prior(0, 7) + H[15]*P_prior(0, 9) + H[16]*P_prior(0, 10) + H[17]*P_prior(0, 11);
+	float PHt_1_0 = H[1]*P_prior(1, 7) + H[2]*P_prior(1, 8) + H[3]*P_prior(1, 9) + H[4]*P_prior(1, 10) + H[5]*P_prior(1, 11);
+	float PHt_1_1 = H[6]*P_prior(1, 6) + H[8]*P_prior(1, 8) + H[9]*P_prior(1, 9) + H[10]*P_prior(1, 10) + H[11]*P_prior(1, 11);
+	float PHt_1_2 = H[12]*P_prior(1, 6) + H[13]*P_prior(1, 7) + H[15]*P_prior(1, 9) + H[16]*P_prior(1, 10) + H[17]*P_prior(1, 11);
+	float PHt_2_0 = H[1]*P_prior(2, 7) + H[2]*P_prior(2, 8) + H[3]*P_prior(2, 9) + H[4]*P_prior(2, 10) + H[5]*P_prior(2, 11);
+	float PHt_2_1 = H[6]*P_prior(2, 6) + H[8]*P_prior(2, 8) + H[9]*P_prior(2, 9) + H[10]*P_prior(2, 10) + H[11]*P_prior(2, 11);
+	float PHt_2_2 = H[12]*P_prior(2, 6) + H[13]*P_prior(2, 7) + H[15]*P_prior(2, 9) + H[16]*P_prior(2, 10) + H[17]*P_prior(2, 11);
+	float PHt_3_0 = H[1]*P_prior(3, 7) + H[2]*P_prior(3, 8) + H[3]*P_prior(3, 9) + H[4]*P_prior(3, 10) + H[5]*P_prior(3, 11);
+	float PHt_3_1 = H[6]*P_prior(3, 6) + H[8]*P_prior(3, 8) + H[9]*P_prior(3, 9) + H[10]*P_prior(3, 10) + H[11]*P_prior(3, 11);
+	float PHt_3_2 = H[12]*P_prior(3, 6) + H[13]*P_prior(3, 7) + H[15]*P_prior(3, 9) + H[16]*P_prior(3, 10) + H[17]*P_prior(3, 11);
+	float PHt_4_0 = H[1]*P_prior(4, 7) + H[2]*P_prior(4, 8) + H[3]*P_prior(4, 9) + H[4]*P_prior(4, 10) + H[5]*P_prior(4, 11);
+	float PHt_4_1 = H[6]*P_prior(4, 6) + H[8]*P_prior(4, 8) + H[9]*P_prior(4, 9) + H[10]*P_prior(4, 10) + H[11]*P_prior(4, 11);
+	float PHt_4_2 = H[12]*P_prior(4, 6) + H[13]*P_prior(4, 7) + H[15]*P_prior(4, 9) + H[16]*P_prior(4, 10) + H[17]*P_prior(4, 11);
+	float PHt_5_0 = H[1]*P_prior(5, 7) + H[2]*P_prior(5, 8) + H[3]*P_prior(5, 9) + H[4]*P_prior(5, 10) + H[5]*P_prior(5, 11);
+	float PHt_5_1 = H[6]*P_prior(5, 6) + H[8]*P_prior(5, 8) + H[9]*P_prior(5, 9) + H[10]*P_prior(5, 10) + H[11]*P_prior(5, 11);
+	float PHt_5_2 = H[12]*P_prior(5, 6) + H[13]*P_prior(5, 7) + H[15]*P_prior(5, 9) + H[16]*P_prior(5, 10) + H[17]*P_prior(5, 11);
+	float PHt_6_0 = H[1]*P_prior(6, 7) + H[2]*P_prior(6, 8) + H[3]*P_prior(6, 9) + H[4]*P_prior(6, 10) + H[5]*P_prior(6, 11);
+	float PHt_6_1 = H[6]*P_prior(6, 6) + H[8]*P_prior(6, 8) + H[9]*P_prior(6, 9) + H[10]*P_prior(6, 10) + H[11]*P_prior(6, 11);
+	float PHt_6_2 = H[12]*P_prior(6, 6) + H[13]*P_prior(6, 7) + H[15]*P_prior(6, 9) + H[16]*P_prior(6, 10) + H[17]*P_prior(6, 11);
+	float PHt_7_0 = H[1]*P_prior(7, 7) + H[2]*P_prior(7, 8) + H[3]*P_prior(7, 9) + H[4]*P_prior(7, 10) + H[5]*P_prior(7, 11);
+	float PHt_7_1 = H[6]*P_prior(6, 7) + H[8]*P_prior(7, 8) + H[9]*P_prior(7, 9) + H[10]*P_prior(7, 10) + H[11]*P_prior(7, 11);
+	float PHt_7_2 = H[12]*P_prior(6, 7) + H[13]*P_prior(7, 7) + H[15]*P_prior(7, 9) + H[16]*P_prior(7, 10) + H[17]*P_prior(7, 11);
+	float PHt_8_0 = H[1]*P_prior(7, 8) + H[2]*P_prior(8, 8) + H[3]*P_prior(8, 9) + H[4]*P_prior(8, 10) + H[5]*P_prior(8, 11);
+	float PHt_8_1 = H[6]*P_prior(6, 8) + H[8]*P_prior(8, 8) + H[9]*P_prior(8, 9) + H[10]*P_prior(8, 10) + H[11]*P_prior(8, 11);
+	float PHt_8_2 = H[12]*P_prior(6, 8) + H[13]*P_prior(7, 8) + H[15]*P_prior(8, 9) + H[16]*P_prior(8, 10) + H[17]*P_prior(8, 11);
+	float PHt_9_0 = H[1]*P_prior(7, 9) + H[2]*P_prior(8, 9) + H[3]*P_prior(9, 9) + H[4]*P_prior(9, 10) + H[5]*P_prior(9, 11);
+	float PHt_9_1 = H[6]*P_prior(6, 9) + H[8]*P_prior(8, 9) + H[9]*P_prior(9, 9) + H[10]*P_prior(9, 10) + H[11]*P_prior(9, 11);
+	float PHt_9_2 = H[12]*P_prior(6, 9) + H[13]*P_prior(7, 9) + H[15]*P_prior(9, 9) + H[16]*P_prior(9, 10) + H[17]*P_prior(9, 11);
+	float PHt_10_0 = H[1]*P_prior(7, 10) + H[2]*P_prior(8, 10) + H[3]*P_prior(9, 10) + H[4]*P_prior(10, 10) + H[5]*P_prior(10, 11);
+	float PHt_10_1 = H[6]*P_prior(6, 10) + H[8]*P_prior(8, 10) + H[9]*P_prior(9, 10) + H[10]*P_prior(10, 10) + H[11]*P_prior(10, 11);
+	float PHt_10_2 = H[12]*P_prior(6, 10) + H[13]*P_prior(7, 10) + H[15]*P_prior(9, 10) + H[16]*P_prior(10, 10) + H[17]*P_prior(10, 11);
+	float PHt_11_0 = H[1]*P_prior(7, 11) + H[2]*P_prior(8, 11) + H[3]*P_prior(9, 11) + H[4]*P_prior(10, 11) + H[5]*P_prior(11, 11);
+	float PHt_11_1 = H[6]*P_prior(6, 11) + H[8]*P_prior(8, 11) + H[9]*P_prior(9, 11) + H[10]*P_prior(10, 11) + H[11]*P_prior(11, 11);
+	float PHt_11_2 = H[12]*P_prior(6, 11) + H[13]*P_prior(7, 11) + H[15]*P_prior(9, 11) + H[16]*P_prior(10, 11) + H[17]*P_prior(11, 11);
+	float PHt_12_0 = H[1]*P_prior(7, 12) + H[2]*P_prior(8, 12) + H[3]*P_prior(9, 12) + H[4]*P_prior(10, 12) + H[5]*P_prior(11, 12);
+	float PHt_12_1 = H[6]*P_prior(6, 12) + H[8]*P_prior(8, 12) + H[9]*P_prior(9, 12) + H[10]*P_prior(10, 12) + H[11]*P_prior(11, 12);
+	float PHt_12_2 = H[12]*P_prior(6, 12) + H[13]*P_prior(7, 12) + H[15]*P_prior(9, 12) + H[16]*P_prior(10, 12) + H[17]*P_prior(11, 12);
+	float PHt_13_0 = H[1]*P_prior(7, 13) + H[2]*P_prior(8, 13) + H[3]*P_prior(9, 13) + H[4]*P_prior(10, 13) + H[5]*P_prior(11, 13);
+	float PHt_13_1 = H[6]*P_prior(6, 13) + H[8]*P_prior(8, 13) + H[9]*P_prior(9, 13) + H[10]*P_prior(10, 13) + H[11]*P_prior(11, 13);
+	float PHt_13_2 = H[12]*P_prior(6, 13) + H[13]*P_prior(7, 13) + H[15]*P_prior(9, 13) + H[16]*P_prior(10, 13) + H[17]*P_prior(11, 13);
+	float PHt_14_0 = H[1]*P_prior(7, 14) + H[2]*P_prior(8, 14) + H[3]*P_prior(9, 14) + H[4]*P_prior(10, 14) + H[5]*P_prior(11, 14);
+	float PHt_14_1 = H[6]*P_prior(6, 14) + H[8]*P_prior(8, 14) + H[9]*P_prior(9, 14) + H[10]*P_prior(10, 14) + H[11]*P_prior(11, 14);
+	float PHt_14_2 = H[12]*P_prior(6, 14) + H[13]*P_prior(7, 14) + H[15]*P_prior(9, 14) + H[16]*P_prior(10, 14) + H[17]*P_prior(11, 14);
+
+	/* calculate (H * P * Ht) + V */
+	float HPHt_V_0_0 = H[1]*PHt_7_0 + H[2]*PHt_8_0 + H[3]*PHt_9_0 + H[4]*PHt_10_0 + H[5]*PHt_11_0 + V[0];
+	float HPHt_V_0_1 = H[1]*PHt_7_1 + H[2]*PHt_8_1 + H[3]*PHt_9_1 + H[4]*PHt_10_1 + H[5]*PHt_11_1;
+	float HPHt_V_0_2 = H[1]*PHt_7_2 + H[2]*PHt_8_2 + H[3]*PHt_9_2 + H[4]*PHt_10_2 + H[5]*PHt_11_2;
+	float HPHt_V_1_1 = H[6]*PHt_6_1 + H[8]*PHt_8_1 + H[9]*PHt_9_1 + H[10]*PHt_10_1 + H[11]*PHt_11_1 + V[4];
+	float HPHt_V_1_2 = H[6]*PHt_6_2 + H[8]*PHt_8_2 + H[9]*PHt_9_2 + H[10]*PHt_10_2 + H[11]*PHt_11_2;
+	float HPHt_V_2_2 = H[12]*PHt_6_2 + H[13]*PHt_7_2 + H[15]*PHt_9_2 + H[16]*PHt_10_2 + H[17]*PHt_11_2 + V[8];
+
+	/* calculate inv((H * P * Ht) + V) */
+	float c0 = HPHt_V_0_1*HPHt_V_1_2 - HPHt_V_0_2*HPHt_V_1_1;
+	float c1 = HPHt_V_1_1*HPHt_V_2_2 - HPHt_V_1_2*HPHt_V_1_2;
+	float c2 = HPHt_V_0_1*HPHt_V_2_2 - HPHt_V_0_2*HPHt_V_1_2;
+	float div_det = 1.0f/(HPHt_V_0_0*c1 + HPHt_V_0_2*c0 - HPHt_V_0_1*c2);
+	float HPHt_V_inv_0_0 = c1*div_det;
+	float HPHt_V_inv_0_1 = -c2*div_det;
+	float HPHt_V_inv_0_2 = c0*div_det;
+	float HPHt_V_inv_1_1 = div_det*(HPHt_V_0_0*HPHt_V_2_2 - HPHt_V_0_2*HPHt_V_0_2);
+	float HPHt_V_inv_1_2 = -div_det*(HPHt_V_0_0*HPHt_V_1_2 - HPHt_V_0_1*HPHt_V_0_2);
+	float HPHt_V_inv_2_2 = div_det*(HPHt_V_0_0*HPHt_V_1_1 - HPHt_V_0_1*HPHt_V_0_1);
+
+	/* calculate kalman gain */
+	float K_0_0 = HPHt_V_inv_0_0*PHt_0_0 + HPHt_V_inv_0_1*PHt_0_1 + HPHt_V_inv_0_2*PHt_0_2;
+	float K_0_1 = HPHt_V_inv_0_1*PHt_0_0 + HPHt_V_inv_1_1*PHt_0_1 + HPHt_V_inv_1_2*PHt_0_2;
+	float K_0_2 = HPHt_V_inv_0_2*PHt_0_0 + HPHt_V_inv_1_2*PHt_0_1 + HPHt_V_inv_2_2*PHt_0_2;
+	float K_1_0 = HPHt_V_inv_0_0*PHt_1_0 + HPHt_V_inv_0_1*PHt_1_1 + HPHt_V_inv_0_2*PHt_1_2;
+	float K_1_1 = HPHt_V_inv_0_1*PHt_1_0 + HPHt_V_inv_1_1*PHt_1_1 + HPHt_V_inv_1_2*PHt_1_2;
+	float K_1_2 = HPHt_V_inv_0_2*PHt_1_0 + HPHt_V_inv_1_2*PHt_1_1 + HPHt_V_inv_2_2*PHt_1_2;
+	float K_2_0 = HPHt_V_inv_0_0*PHt_2_0 + HPHt_V_inv_0_1*PHt_2_1 + HPHt_V_inv_0_2*PHt_2_2;
+	float K_2_1 = HPHt_V_inv_0_1*PHt_2_0 + HPHt_V_inv_1_1*PHt_2_1 + HPHt_V_inv_1_2*PHt_2_2;
+	float K_2_2 = HPHt_V_inv_0_2*PHt_2_0 + HPHt_V_inv_1_2*PHt_2_1 + HPHt_V_inv_2_2*PHt_2_2;
+	float K_3_0 = HPHt_V_inv_0_0*PHt_3_0 + HPHt_V_inv_0_1*PHt_3_1 + HPHt_V_inv_0_2*PHt_3_2;
+	float K_3_1 = HPHt_V_inv_0_1*PHt_3_0 + HPHt_V_inv_1_1*PHt_3_1 + HPHt_V_inv_1_2*PHt_3_2;
+	float K_3_2 = HPHt_V_inv_0_2*PHt_3_0 + HPHt_V_inv_1_2*PHt_3_1 + HPHt_V_inv_2_2*PHt_3_2;
+	float K_4_0 = HPHt_V_inv_0_0*PHt_4_0 + HPHt_V_inv_0_1*PHt_4_1 + HPHt_V_inv_0_2*PHt_4_2;
+	float K_4_1 = HPHt_V_inv_0_1*PHt_4_0 + HPHt_V_inv_1_1*PHt_4_1 + HPHt_V_inv_1_2*PHt_4_2;
+	float K_4_2 = HPHt_V_inv_0_2*PHt_4_0 + HPHt_V_inv_1_2*PHt_4_1 + HPHt_V_inv_2_2*PHt_4_2;
+	float K_5_0 = HPHt_V_inv_0_0*PHt_5_0 + HPHt_V_inv_0_1*PHt_5_1 + HPHt_V_inv_0_2*PHt_5_2;
+	float K_5_1 = HPHt_V_inv_0_1*PHt_5_0 + HPHt_V_inv_1_1*PHt_5_1 + HPHt_V_inv_1_2*PHt_5_2;
+	float K_5_2 = HPHt_V_inv_0_2*PHt_5_0 + HPHt_V_inv_1_2*PHt_5_1 + HPHt_V_inv_2_2*PHt_5_2;
+	float K_6_0 = HPHt_V_inv_0_0*PHt_6_0 + HPHt_V_inv_0_1*PHt_6_1 + HPHt_V_inv_0_2*PHt_6_2;
+	float K_6_1 = HPHt_V_inv_0_1*PHt_6_0 + HPHt_V_inv_1_1*PHt_6_1 + HPHt_V_inv_1_2*PHt_6_2;
+	float K_6_2 = HPHt_V_inv_0_2*PHt_6_0 + HPHt_V_inv_1_2*PHt_6_1 + HPHt_V_inv_2_2*PHt_6_2;
+	float K_7_0 = HPHt_V_inv_0_0*PHt_7_0 + HPHt_V_inv_0_1*PHt_7_1 + HPHt_V_inv_0_2*PHt_7_2;
+	float K_7_1 = HPHt_V_inv_0_1*PHt_7_0 + HPHt_V_inv_1_1*PHt_7_1 + HPHt_V_inv_1_2*PHt_7_2;
+	float K_7_2 = HPHt_V_inv_0_2*PHt_7_0 + HPHt_V_inv_1_2*PHt_7_1 + HPHt_V_inv_2_2*PHt_7_2;
+	float K_8_0 = HPHt_V_inv_0_0*PHt_8_0 + HPHt_V_inv_0_1*PHt_8_1 + HPHt_V_inv_0_2*PHt_8_2;
+	float K_8_1 = HPHt_V_inv_0_1*PHt_8_0 + HPHt_V_inv_1_1*PHt_8_1 + HPHt_V_inv_1_2*PHt_8_2;
+	float K_8_2 = HPHt_V_inv_0_2*PHt_8_0 + HPHt_V_inv_1_2*PHt_8_1 + HPHt_V_inv_2_2*PHt_8_2;
+	float K_9_0 = HPHt_V_inv_0_0*PHt_9_0 + HPHt_V_inv_0_1*PHt_9_1 + HPHt_V_inv_0_2*PHt_9_2;
+	float K_9_1 = HPHt_V_inv_0_1*PHt_9_0 + HPHt_V_inv_1_1*PHt_9_1 + HPHt_V_inv_1_2*PHt_9_2;
+	float K_9_2 = HPHt_V_inv_0_2*PHt_9_0 + HPHt_V_inv_1_2*PHt_9_1 + HPHt_V_inv_2_2*PHt_9_2;
+	float K_10_0 = HPHt_V_inv_0_0*PHt_10_0 + HPHt_V_inv_0_1*PHt_10_1 + HPHt_V_inv_0_2*PHt_10_2;
+	float K_10_1 = HPHt_V_inv_0_1*PHt_10_0 + HPHt_V_inv_1_1*PHt_10_1 + HPHt_V_inv_1_2*PHt_10_2;
+	float K_10_2 = HPHt_V_inv_0_2*PHt_10_0 + HPHt_V_inv_1_2*PHt_10_1 + HPHt_V_inv_2_2*PHt_10_2;
+	float K_11_0 = HPHt_V_inv_0_0*PHt_11_0 + HPHt_V_inv_0_1*PHt_11_1 + HPHt_V_inv_0_2*PHt_11_2;
+	float K_11_1 = HPHt_V_inv_0_1*PHt_11_0 + HPHt_V_inv_1_1*PHt_11_1 + HPHt_V_inv_1_2*PHt_11_2;
+	float K_11_2 = HPHt_V_inv_0_2*PHt_11_0 + HPHt_V_inv_1_2*PHt_11_1 + HPHt_V_inv_2_2*PHt_11_2;
+	float K_12_0 = HPHt_V_inv_0_0*PHt_12_0 + HPHt_V_inv_0_1*PHt_12_1 + HPHt_V_inv_0_2*PHt_12_2;
+	float K_12_1 = HPHt_V_inv_0_1*PHt_12_0 + HPHt_V_inv_1_1*PHt_12_1 + HPHt_V_inv_1_2*PHt_12_2;
+	float K_12_2 = HPHt_V_inv_0_2*PHt_12_0 + HPHt_V_inv_1_2*PHt_12_1 + HPHt_V_inv_2_2*PHt_12_2;
+	float K_13_0 = HPHt_V_inv_0_0*PHt_13_0 + HPHt_V_inv_0_1*PHt_13_1 + HPHt_V_inv_0_2*PHt_13_2;
+	float K_13_1 = HPHt_V_inv_0_1*PHt_13_0 + HPHt_V_inv_1_1*PHt_13_1 + HPHt_V_inv_1_2*PHt_13_2;
+	float K_13_2 = HPHt_V_inv_0_2*PHt_13_0 + HPHt_V_inv_1_2*PHt_13_1 + HPHt_V_inv_2_2*PHt_13_2;
+	float K_14_0 = HPHt_V_inv_0_0*PHt_14_0 + HPHt_V_inv_0_1*PHt_14_1 + HPHt_V_inv_0_2*PHt_14_2;
+	float K_14_1 = HPHt_V_inv_0_1*PHt_14_0 + HPHt_V_inv_1_1*PHt_14_1 + HPHt_V_inv_1_2*PHt_14_2;
+	float K_14_2 = HPHt_V_inv_0_2*PHt_14_0 + HPHt_V_inv_1_2*PHt_14_1 + HPHt_V_inv_2_2*PHt_14_2;
+
+	/* calculate error state */
+	delta_x[0] = K_0_0*resid[0] + K_0_1*resid[1] + K_0_2*resid[2];
+	delta_x[1] = K_1_0*resid[0] + K_1_1*resid[1] + K_1_2*resid[2];
+	delta_x[2] = K_2_0*resid[0] + K_2_1*resid[1] + K_2_2*resid[2];
+	delta_x[3] = K_3_0*resid[0] + K_3_1*resid[1] + K_3_2*resid[2];
+	delta_x[4] = K_4_0*resid[0] + K_4_1*resid[1] + K_4_2*resid[2];
+	delta_x[5] = K_5_0*resid[0] + K_5_1*resid[1] + K_5_2*resid[2];
+	delta_x[6] = K_6_0*resid[0] + K_6_1*resid[1] + K_6_2*resid[2];
+	delta_x[7] = K_7_0*resid[0] + K_7_1*resid[1] + K_7_2*resid[2];
+	delta_x[8] = K_8_0*resid[0] + K_8_1*resid[1] + K_8_2*resid[2];
+	delta_x[9] = K_9_0*resid[0] + K_9_1*resid[1] + K_9_2*resid[2];
+	delta_x[10] = K_10_0*resid[0] + K_10_1*resid[1] + K_10_2*resid[2];
+	delta_x[11] = K_11_0*resid[0] + K_11_1*resid[1] + K_11_2*resid[2];
+	delta_x[12] = K_12_0*resid[0] + K_12_1*resid[1] + K_12_2*resid[2];
+	delta_x[13] = K_13_0*resid[0] + K_13_1*resid[1] + K_13_2*resid[2];
+	delta_x[14] = K_14_0*resid[0] + K_14_1*resid[1] + K_14_2*resid[2];
+
+	/* calculate a posteriori process covariance matrix */
+	P_post(0, 0) = P_prior(0, 0) - K_0_0*PHt_0_0 - K_0_1*PHt_0_1 - K_0_2*PHt_0_2;
+	P_post(0, 1) = P_prior(0, 1) - K_0_0*PHt_1_0 - K_0_1*PHt_1_1 - K_0_2*PHt_1_2;
+	P_post(0, 2) = P_prior(0, 2) - K_0_0*PHt_2_0 - K_0_1*PHt_2_1 - K_0_2*PHt_2_2;
+	P_post(0, 3) = P_prior(0, 3) - K_0_0*PHt_3_0 - K_0_1*PHt_3_1 - K_0_2*PHt_3_2;
+	P_post(0, 4) = P_prior(0, 4) - K_0_0*PHt_4_0 - K_0_1*PHt_4_1 - K_0_2*PHt_4_2;
+	P_post(0, 5) = P_prior(0, 5) - K_0_0*PHt_5_0 - K_0_1*PHt_5_1 - K_0_2*PHt_5_2;
+	P_post(0, 6) = P_prior(0, 6) - K_0_0*PHt_6_0 - K_0_1*PHt_6_1 - K_0_2*PHt_6_2;
+	P_post(0, 7) = P_prior(0, 7) - K_0_0*PHt_7_0 - K_0_1*PHt_7_1 - K_0_2*PHt_7_2;
+	P_post(0, 8) = P_prior(0, 8) - K_0_0*PHt_8_0 - K_0_1*PHt_8_1 - K_0_2*PHt_8_2;
+	P_post(0, 9) = P_prior(0, 9) - K_0_0*PHt_9_0 - K_0_1*PHt_9_1 - K_0_2*PHt_9_2;
+	P_post(0, 10) = P_prior(0, 10) - K_0_0*PHt_10_0 - K_0_1*PHt_10_1 - K_0_2*PHt_10_2;
+	P_post(0, 11) = P_prior(0, 11) - K_0_0*PHt_11_0 - K_0_1*PHt_11_1 - K_0_2*PHt_11_2;
+	P_post(0, 12) = P_prior(0, 12) - K_0_0*PHt_12_0 - K_0_1*PHt_12_1 - K_0_2*PHt_12_2;
+	P_post(0, 13) = P_prior(0, 13) - K_0_0*PHt_13_0 - K_0_1*PHt_13_1 - K_0_2*PHt_13_2;
+	P_post(0, 14) = P_prior(0, 14) - K_0_0*PHt_14_0 - K_0_1*PHt_14_1 - K_0_2*PHt_14_2;
+	P_post(1, 1) = P_prior(1, 1) - K_1_0*PHt_1_0 - K_1_1*PHt_1_1 - K_1_2*PHt_1_2;
+	P_post(1, 2) = P_prior(1, 2) - K_1_0*PHt_2_0 - K_1_1*PHt_2_1 - K_1_2*PHt_2_2;
+	P_post(1, 3) = P_prior(1, 3) - K_1_0*PHt_3_0 - K_1_1*PHt_3_1 - K_1_2*PHt_3_2;
+	P_post(1, 4) = P_prior(1, 4) - K_1_0*PHt_4_0 - K_1_1*PHt_4_1 - K_1_2*PHt_4_2;
+	P_post(1, 5) = P_prior(1, 5) - K_1_0*PHt_5_0 - K_1_1*PHt_5_1 - K_1_2*PHt_5_2;
+	P_post(1, 6) = P_prior(1, 6) - K_1_0*PHt_6_0 - K_1_1*PHt_6_1 - K_1_2*PHt_6_2;
+	P_post(1, 7) = P_prior(1, 7) - K_1_0*PHt_7_0 - K_1_1*PHt_7_1 - K_1_2*PHt_7_2;
+	P_post(1, 8) = P_prior(1, 8) - K_1_0*PHt_8_0 - K_1_1*PHt_8_1 - K_1_2*PHt_8_2;
+	P_post(1, 9) = P_prior(1, 9) - K_1_0*PHt_9_0 - K_1_1*PHt_9_1 - K_1_2*PHt_9_2;
+	P_post(1, 10) = P_prior(1, 10) - K_1_0*PHt_10_0 - K_1_1*PHt_10_1 - K_1_2*PHt_10_2;
+	P_post(1, 11) = P_prior(1, 11) - K_1_0*PHt_11_0 - K_1_1*PHt_11_1 - K_1_2*PHt_11_2;
+	P_post(1, 12) = P_prior(1, 12) - K_1_0*PHt_12_0 - K_1_1*PHt_12_1 - K_1_2*PHt_12_2;
+	P_post(1, 13) = P_prior(1, 13) - K_1_0*PHt_13_0 - K_1_1*PHt_13_1 - K_1_2*PHt_13_2;
+	P_post(1, 14) = P_prior(1, 14) - K_1_0*PHt_14_0 - K_1_1*PHt_14_1 - K_1_2*PHt_14_2;
+	P_post(2, 2) = P_prior(2, 2) - K_2_0*PHt_2_0 - K_2_1*PHt_2_1 - K_2_2*PHt_2_2;
+	P_post(2, 3) = P_prior(2, 3) - K_2_0*PHt_3_0 - K_2_1*PHt_3_1 - K_2_2*PHt_3_2;
+	P_post(2, 4) = P_prior(2, 4) - K_2_0*PHt_4_0 - K_2_1*PHt_4_1 - K_2_2*PHt_4_2;
+	P_post(2, 5) = P_prior(2, 5) - K_2_0*PHt_5_0 - K_2_1*PHt_5_1 - K_2_2*PHt_5_2;
+	P_post(2, 6) = P_prior(2, 6) - K_2_0*PHt_6_0 - K_2_1*PHt_6_1 - K_2_2*PHt_6_2;
+	P_post(2, 7) = P_prior(2, 7) - K_2_0*PHt_7_0 - K_2_1*PHt_7_1 - K_2_2*PHt_7_2;
+	P_post(2, 8) = P_prior(2, 8) - K_2_0*PHt_8_0 - K_2_1*PHt_8_1 - K_2_2*PHt_8_2;
+	P_post(2, 9) = P_prior(2, 9) - K_2_0*PHt_9_0 - K_2_1*PHt_9_1 - K_2_2*PHt_9_2;
+	P_post(2, 10) = P_prior(2, 10) - K_2_0*PHt_10_0 - K_2_1*PHt_10_1 - K_2_2*PHt_10_2;
+	P_post(2, 11) = P_prior(2, 11) - K_2_0*PHt_11_0 - K_2_1*PHt_11_1 - K_2_2*PHt_11_2;
+	P_post(2, 12) = P_prior(2, 12) - K_2_0*PHt_12_0 - K_2_1*PHt_12_1 - K_2_2*PHt_12_2;
+	P_post(2, 13) = P_prior(2, 13) - K_2_0*PHt_13_0 - K_2_1*PHt_13_1 - K_2_2*PHt_13_2;
+	P_post(2, 14) = P_prior(2, 14) - K_2_0*PHt_14_0 - K_2_1*PHt_14_1 - K_2_2*PHt_14_2;
+	P_post(3, 3) = P_prior(3, 3) - K_3_0*PHt_3_0 - K_3_1*PHt_3_1 - K_3_2*PHt_3_2;
+	P_post(3, 4) = P_prior(3, 4) - K_3_0*PHt_4_0 - K_3_1*PHt_4_1 - K_3_2*PHt_4_2;
+	P_post(3, 5) = P_prior(3, 5) - K_3_0*PHt_5_0 - K_3_1*PHt_5_1 - K_3_2*PHt_5_2;
+	P_post(3, 6) = P_prior(3, 6) - K_3_0*PHt_6_0 - K_3_1*PHt_6_1 - K_3_2*PHt_6_2;
+	P_post(3, 7) = P_prior(3, 7) - K_3_0*PHt_7_0 - K_3_1*PHt_7_1 - K_3_2*PHt_7_2;
+	P_post(3, 8) = P_prior(3, 8) - K_3_0*PHt_8_0 - K_3_1*PHt_8_1 - K_3_2*PHt_8_2;
+	P_post(3, 9) = P_prior(3, 9) - K_3_0*PHt_9_0 - K_3_1*PHt_9_1 - K_3_2*PHt_9_2;
+	P_post(3, 10) = P_prior(3, 10) - K_3_0*PHt_10_0 - K_3_1*PHt_10_1 - K_3_2*PHt_10_2;
+	P_post(3, 11) = P_prior(3, 11) - K_3_0*PHt_11_0 - K_3_1*PHt_11_1 - K_3_2*PHt_11_2;
+	P_post(3, 12) = P_prior(3, 12) - K_3_0*PHt_12_0 - K_3_1*PHt_12_1 - K_3_2*PHt_12_2;
+	P_post(3, 13) = P_prior(3, 13) - K_3_0*PHt_13_0 - K_3_1*PHt_13_1 - K_3_2*PHt_13_2;
+	P_post(3, 14) = P_prior(3, 14) - K_3_0*PHt_14_0 - K_3_1*PHt_14_1 - K_3_2*PHt_14_2;
+	P_post(4, 4) = P_prior(4, 4) - K_4_0*PHt_4_0 - K_4_1*PHt_4_1 - K_4_2*PHt_4_2;
+	P_post(4, 5) = P_prior(4, 5) - K_4_0*PHt_5_0 - K_4_1*PHt_5_1 - K_4_2*PHt_5_2;
+	P_post(4, 6) = P_prior(4, 6) - K_4_0*PHt_6_0 - K_4_1*PHt_6_1 - K_4_2*PHt_6_2;
+	P_post(4, 7) = P_prior(4, 7) - K_4_0*PHt_7_0 - K_4_1*PHt_7_1 - K_4_2*PHt_7_2;
+	P_post(4, 8) = P_prior(4, 8) - K_4_0*PHt_8_0 - K_4_1*PHt_8_1 - K_4_2*PHt_8_2;
+	P_post(4, 9) = P_prior(4, 9) - K_4_0*PHt_9_0 - K_4_1*PHt_9_1 - K_4_2*PHt_9_2;
+	P_post(4, 10) = P_prior(4, 10) - K_4_0*PHt_10_0 - K_4_1*PHt_10_1 - K_4_2*PHt_10_2;
+	P_post(4, 11) = P_prior(4, 11) - K_4_0*PHt_11_0 - K_4_1*PHt_11_1 - K_4_2*PHt_11_2;
+	P_post(4, 12) = P_prior(4, 12) - K_4_0*PHt_12_0 - K_4_1*PHt_12_1 - K_4_2*PHt_12_2;
+	P_post(4, 13) = P_prior(4, 13) - K_4_0*PHt_13_0 - K_4_1*PHt_13_1 - K_4_2*PHt_13_2;
+	P_post(4, 14) = P_prior(4, 14) - K_4_0*PHt_14_0 - K_4_1*PHt_14_1 - K_4_2*PHt_14_2;
+	P_post(5, 5) = P_prior(5, 5) - K_5_0*PHt_5_0 - K_5_1*PHt_5_1 - K_5_2*PHt_5_2;
+	P_post(5, 6) = P_prior(5, 6) - K_5_0*PHt_6_0 - K_5_1*PHt_6_1 - K_5_2*PHt_6_2;
+	P_post(5, 7) = P_prior(5, 7) - K_5_0*PHt_7_0 - K_5_1*PHt_7_1 - K_5_2*PHt_7_2;
+	P_post(5, 8) = P_prior(5, 8) - K_5_0*PHt_8_0 - K_5_1*PHt_8_1 - K_5_2*PHt_8_2;
+	P_post(5, 9) = P_prior(5, 9) - K_5_0*PHt_9_0 - K_5_1*PHt_9_1 - K_5_2*PHt_9_2;
+	P_post(5, 10) = P_prior(5, 10) - K_5_0*PHt_10_0 - K_5_1*PHt_10_1 - K_5_2*PHt_10_2;
+	P_post(5, 11) = P_prior(5, 11) - K_5_0*PHt_11_0 - K_5_1*PHt_11_1 - K_5_2*PHt_11_2;
+	P_post(5, 12) = P_prior(5, 12) - K_5_0*PHt_12_0 - K_5_1*PHt_12_1 - K_5_2*PHt_12_2;
+	P_post(5, 13) = P_prior(5, 13) - K_5_0*PHt_13_0 - K_5_1*PHt_13_1 - K_5_2*PHt_13_2;
+	P_post(5, 14) = P_prior(5, 14) - K_5_0*PHt_14_0 - K_5_1*PHt_14_1 - K_5_2*PHt_14_2;
+	P_post(6, 6) = P_prior(6, 6) - K_6_0*PHt_6_0 - K_6_1*PHt_6_1 - K_6_2*PHt_6_2;
+	P_post(6, 7) = P_prior(6, 7) - K_6_0*PHt_7_0 - K_6_1*PHt_7_1 - K_6_2*PHt_7_2;
+	P_post(6, 8) = P_prior(6, 8) - K_6_0*PHt_8_0 - K_6_1*PHt_8_1 - K_6_2*PHt_8_2;
+	P_post(6, 9) = P_prior(6, 9) - K_6_0*PHt_9_0 - K_6_1*PHt_9_1 - K_6_2*PHt_9_2;
+	P_post(6, 10) = P_prior(6, 10) - K_6_0*PHt_10_0 - K_6_1*PHt_10_1 - K_6_2*PHt_10_2;
+	P_post(6, 11) = P_prior(6, 11) - K_6_0*PHt_11_0 - K_6_1*PHt_11_1 - K_6_2*PHt_11_2;
+	P_post(6, 12) = P_prior(6, 12) - K_6_0*PHt_12_0 - K_6_1*PHt_12_1 - K_6_2*PHt_12_2;
+	P_post(6, 13) = P_prior(6, 13) - K_6_0*PHt_13_0 - K_6_1*PHt_13_1 - K_6_2*PHt_13_2;
+	P_post(6, 14) = P_prior(6, 14) - K_6_0*PHt_14_0 - K_6_1*PHt_14_1 - K_6_2*PHt_14_2;
+	P_post(7, 7) = P_prior(7, 7) - K_7_0*PHt_7_0 - K_7_1*PHt_7_1 - K_7_2*PHt_7_2;
+	P_post(7, 8) = P_prior(7, 8) - K_7_0*PHt_8_0 - K_7_1*PHt_8_1 - K_7_2*PHt_8_2;
+	P_post(7, 9) = P_prior(7, 9) - K_7_0*PHt_9_0 - K_7_1*PHt_9_1 - K_7_2*PHt_9_2;
+	P_post(7, 10) = P_prior(7, 10) - K_7_0*PHt_10_0 - K_7_1*PHt_10_1 - K_7_2*PHt_10_2;
+	P_post(7, 11) = P_prior(7, 11) - K_7_0*PHt_11_0 - K_7_1*PHt_11_1 - K_7_2*PHt_11_2;
+	P_post(7, 12) = P_prior(7, 12) - K_7_0*PHt_12_0 - K_7_1*PHt_12_1 - K_7_2*PHt_12_2;
+	P_post(7, 13) = P_prior(7, 13) - K_7_0*PHt_13_0 - K_7_1*PHt_13_1 - K_7_2*PHt_13_2;
+	P_post(7, 14) = P_prior(7, 14) - K_7_0*PHt_14_0 - K_7_1*PHt_14_1 - K_7_2*PHt_14_2;
+	P_post(8, 8) = P_prior(8, 8) - K_8_0*PHt_8_0 - K_8_1*PHt_8_1 - K_8_2*PHt_8_2;
+	P_post(8, 9) = P_prior(8, 9) - K_8_0*PHt_9_0 - K_8_1*PHt_9_1 - K_8_2*PHt_9_2;
+	P_post(8, 10) = P_prior(8, 10) - K_8_0*PHt_10_0 - K_8_1*PHt_10_1 - K_8_2*PHt_10_2;
+	P_post(8, 11) = P_prior(8, 11) - K_8_0*PHt_11_0 - K_8_1*PHt_11_1 - K_8_2*PHt_11_2;
+	P_post(8, 12) = P_prior(8, 12) - K_8_0*PHt_12_0 - K_8_1*PHt_12_1 - K_8_2*PHt_12_2;
+	P_post(8, 13) = P_prior(8, 13) - K_8_0*PHt_13_0 - K_8_1*PHt_13_1 - K_8_2*PHt_13_2;
+	P_post(8, 14) = P_prior(8, 14) - K_8_0*PHt_14_0 - K_8_1*PHt_14_1 - K_8_2*PHt_14_2;
+	P_post(9, 9) = P_prior(9, 9) - K_9_0*PHt_9_0 - K_9_1*PHt_9_1 - K_9_2*PHt_9_2;
+	P_post(9, 10) = P_prior(9, 10) - K_9_0*PHt_10_0 - K_9_1*PHt_10_1 - K_9_2*PHt_10_2;
+	P_post(9, 11) = P_prior(9, 11) - K_9_0*PHt_11_0 - K_9_1*PHt_11_1 - K_9_2*PHt_11_2;
+	P_post(9, 12) = P_prior(9, 12) - K_9_0*PHt_12_0 - K_9_1*PHt_12_1 - K_9_2*PHt_12_2;
+	P_post(9, 13) = P_prior(9, 13) - K_9_0*PHt_13_0 - K_9_1*PHt_13_1 - K_9_2*PHt_13_2;
+	P_post(9, 14) = P_prior(9, 14) - K_9_0*PHt_14_0 - K_9_1*PHt_14_1 - K_9_2*PHt_14_2;
+	P_post(10, 10) = P_prior(10, 10) - K_10_0*PHt_10_0 - K_10_1*PHt_10_1 - K_10_2*PHt_10_2;
+	P_post(10, 11) = P_prior(10, 11) - K_10_0*PHt_11_0 - K_10_1*PHt_11_1 - K_10_2*PHt_11_2;
+	P_post(10, 12) = P_prior(10, 12) - K_10_0*PHt_12_0 - K_10_1*PHt_12_1 - K_10_2*PHt_12_2;
+	P_post(10, 13) = P_prior(10, 13) - K_10_0*PHt_13_0 - K_10_1*PHt_13_1 - K_10_2*PHt_13_2;
+	P_post(10, 14) = P_prior(10, 14) - K_10_0*PHt_14_0 - K_10_1*PHt_14_1 - K_10_2*PHt_14_2;
+	P_post(11, 11) = P_prior(11, 11) - K_11_0*PHt_11_0 - K_11_1*PHt_11_1 - K_11_2*PHt_11_2;
+	P_post(11, 12) = P_prior(11, 12) - K_11_0*PHt_12_0 - K_11_1*PHt_12_1 - K_11_2*PHt_12_2;
+	P_post(11, 13) = P_prior(11, 13) - K_11_0*PHt_13_0 - K_11_1*PHt_13_1 - K_11_2*PHt_13_2;
+	P_post(11, 14) = P_prior(11, 14) - K_11_0*PHt_14_0 - K_11_1*PHt_14_1 - K_11_2*PHt_14_2;
+	P_post(12, 12) = P_prior(12, 12) - K_12_0*PHt_12_0 - K_12_1*PHt_12_1 - K_12_2*PHt_12_2;
+	P_post(12, 13) = P_prior(12, 13) - K_12_0*PHt_13_0 - K_12_1*PHt_13_1 - K_12_2*PHt_13_2;
+	P_post(12, 14) = P_prior(12, 14) - K_12_0*PHt_14_0 - K_12_1*PHt_14_1 - K_12_2*PHt_14_2;
+	P_post(13, 13) = P_prior(13, 13) - K_13_0*PHt_13_0 - K_13_1*PHt_13_1 - K_13_2*PHt_13_2;
+	P_post(13, 14) = P_prior(13, 14) - K_13_0*PHt_14_0 - K_13_1*PHt_14_1 - K_13_2*PHt_14_2;
+	P_post(14, 14) = P_prior(14, 14) - K_14_0*PHt_14_0 - K_14_1*PHt_14_1 - K_14_2*PHt_14_2;
+}
+
+/* kalman gain, error state and a posteriori covariance of the
+ * magnetometer update, H contains the columns 6-8 of the measurement
+ * matrix (see eskf_ins_magnetometer_measurement()) */
+void eskf_ins_magnetometer_covariance_update(const float *_P_prior, float *_P_post, float *delta_x,
+                                             const float *H, const float *resid, const float *V)
+{
+	/* calculate P * Ht */
+	float PHt_0_0 = H[1]*P_prior(0, 7) + H[2]*P_prior(0, 8);
+	float PHt_0_1 = H[3]*P_prior(0, 6) + H[5]*P_prior(0, 8);
+	float PHt_0_2 = H[6]*P_prior(0, 6) + H[7]*P_prior(0, 7);
+	float PHt_1_0 = H[1]*P_prior(1, 7) + H[2]*P_prior(1, 8);
+	float PHt_1_1 = H[3]*P_prior(1, 6) + H[5]*P_prior(1, 8);
+	float PHt_1_2 = H[6]*P_prior(1, 6) + H[7]*P_prior(1, 7);
+	float PHt_2_0 = H[1]*P_prior(2, 7) + H[2]*P_prior(2, 8);
+	float PHt_2_1 = H[3]*P_prior(2, 6) + H[5]*P_prior(2, 8);
+	float PHt_2_2 = H[6]*P_prior(2, 6) + H[7]*P_prior(2, 7);
+	float PHt_3_0 = H[1]*P_prior(3, 7) + H[2]*P_prior(3, 8);
+	float PHt_3_1 = H[3]*P_prior(3, 6) + H[5]*P_prior(3, 8);
+	float PHt_3_2 = H[6]*P_prior(3, 6) + H[7]*P_prior(3, 7);
+	float PHt_4_0 = H[1]*P_prior(4, 7) + H[2]*P_prior(4, 8);
+	float PHt_4_1 = H[3]*P_prior(4, 6) + H[5]*P_prior(4, 8);
+	float PHt_4_2 = H[6]*P_prior(4, 6) + H[7]*P_prior(4, 7);
+	float PHt_5_0 = H[1]*P_prior(5, 7) + H[2]*P_prior(5, 8);
+	float PHt_5_1 = H[3]*P_prior(5, 6) + H[5]*P_prior(5, 8);
+	float PHt_5_2 = H[6]*P_prior(5, 6) + H[7]*P_prior(5, 7);
+	float PHt_6_0 = H[1]*P_prior(6, 7) + H[2]*P_prior(6, 8);
+	float PHt_6_1 = H[3]*P_prior(6, 6) + H[5]*P_prior(6, 8);
+	float PHt_6_2 = H[6]*P_prior(6, 6) + H[7]*P_prior(6, 7);
+	float PHt_7_0 = H[1]*P_prior(7, 7) + H[2]*P_prior(7, 8);
+	float PHt_7_1 = H[3]*P_prior(6, 7) + H[5]*P_prior(7, 8);
+	float PHt_7_2 = H[6]*P_prior(6, 7) + H[7]*P_prior(7, 7);
+	float PHt_8_0 = H[1]*P_prior(7, 8) + H[2]*P_prior(8, 8);
+	float PHt_8_1 = H[3]*P_prior(6, 8) + H[5]*P_prior(8, 8);
+	float PHt_8_2 = H[6]*P_prior(6, 8) + H[7]*P_prior(7, 8);
+	float PHt_9_0 = H[1]*P_prior(7, 9) + H[2]*P_prior(8, 9);
+	float PHt_9_1 = H[3]*P_prior(6, 9) + H[5]*P_prior(8, 9);
+	float PHt_9_2 = H[6]*P_prior(6, 9) + H[7]*P_prior(7, 9);
+	float PHt_10_0 = H[1]*P_prior(7, 10) + H[2]*P_prior(8, 10);
+	float PHt_10_1 = H[3]*P_prior(6, 10) + H[5]*P_prior(8, 10);
+	float PHt_10_2 = H[6]*P_prior(6, 10) + H[7]*P_prior(7, 10);
+	float PHt_11_0 = H[1]*P_prior(7, 11) + H[2]*P_prior(8, 11);
+	float PHt_11_1 = H[3]*P_prior(6, 11) + H[5]*P_prior(8, 11);
+	float PHt_11_2 = H[6]*P_prior(6, 11) + H[7]*P_prior(7, 11);
+	float PHt_12_0 = H[1]*P_prior(7, 12) + H[2]*P_prior(8, 12);
+	float PHt_12_1 = H[3]*P_prior(6, 12) + H[5]*P_prior(8, 12);
+	float PHt_12_2 = H[6]*P_prior(6, 12) + H[7]*P_prior(7, 12);
+	float PHt_13_0 = H[1]*P_prior(7, 13) + H[2]*P_prior(8, 13);
+	float PHt_13_1 = H[3]*P_prior(6, 13) + H[5]*P_prior(8, 13);
+	float PHt_13_2 = H[6]*P_prior(6, 13) + H[7]*P_prior(7, 13);
+	float PHt_14_0 = H[1]*P_prior(7, 14) + H[2]*P_prior(8, 14);
+	float PHt_14_1 = H[3]*P_prior(6, 14) + H[5]*P_prior(8, 14);
+	float PHt_14_2 = H[6]*P_prior(6, 14) + H[7]*P_prior(7, 14);
+
+	/* calculate (H * P * Ht) + V */
+	float HPHt_V_0_0 = H[1]*PHt_7_0 + H[2]*PHt_8_0 + V[0];
+	float HPHt_V_0_1 = H[1]*PHt_7_1 + H[2]*PHt_8_1;
+	float HPHt_V_0_2 = H[1]*PHt_7_2 + H[2]*PHt_8_2;
+	float HPHt_V_1_1 = H[3]*PHt_6_1 + H[5]*PHt_8_1 + V[4];
+	float HPHt_V_1_2 = H[3]*PHt_6_2 + H[5]*PHt_8_2;
+	float HPHt_V_2_2 = H[6]*PHt_6_2 + H[7]*PHt_7_2 + V[8];
+
+	/* calculate inv((H * P * Ht) + V) */
+	float c0 = HPHt_V_0_1*HPHt_V_1_2 - HPHt_V_0_2*HPHt_V_1_1;
+	float c1 = HPHt_V_1_1*HPHt_V_2_2 - HPHt_V_1_2*HPHt_V_1_2;
+	float c2 = HPHt_V_0_1*HPHt_V_2_2 - HPHt_V_0_2*HPHt_V_1_2;
+	float div_det = 1.0f/(HPHt_V_0_0*c1 + HPHt_V_0_2*c0 - HPHt_V_0_1*c2);
+	float HPHt_V_inv_0_0 = c1*div_det;
+	float HPHt_V_inv_0_1 = -c2*div_det;
+	float HPHt_V_inv_0_2 = c0*div_det;
+	float HPHt_V_inv_1_1 = div_det*(HPHt_V_0_0*HPHt_V_2_2 - HPHt_V_0_2*HPHt_V_0_2);
+	float HPHt_V_inv_1_2 = -div_det*(HPHt_V_0_0*HPHt_V_1_2 - HPHt_V_0_1*HPHt_V_0_2);
+	float HPHt_V_inv_2_2 = div_det*(HPHt_V_0_0*HPHt_V_1_1 - HPHt_V_0_1*HPHt_V_0_1);
+
+	/* calculate kalman gain */
+	float K_8_0 = HPHt_V_inv_0_0*PHt_8_0 + HPHt_V_inv_0_1*PHt_8_1 + HPHt_V_inv_0_2*PHt_8_2;
+	float K_8_1 = HPHt_V_inv_0_1*PHt_8_0 + HPHt_V_inv_1_1*PHt_8_1 + HPHt_V_inv_1_2*PHt_8_2;
+	float K_8_2 = HPHt_V_inv_0_2*PHt_8_0 + HPHt_V_inv_1_2*PHt_8_1 + HPHt_V_inv_2_2*PHt_8_2;
+	float K_14_0 = HPHt_V_inv_0_0*PHt_14_0 + HPHt_V_inv_0_1*PHt_14_1 + HPHt_V_inv_0_2*PHt_14_2;
+	float K_14_1 = HPHt_V_inv_0_1*PHt_14_0 + HPHt_V_inv_1_1*PHt_14_1 + HPHt_V_inv_1_2*PHt_14_2;
+	float K_14_2 = HPHt_V_inv_0_2*PHt_14_0 + HPHt_V_inv_1_2*PHt_14_1 + HPHt_V_inv_2_2*PHt_14_2;
+
+	/* calculate error state */
+	delta_x[0] = 0.0f;
+	delta_x[1] = 0.0f;
+	delta_x[2] = 0.0f;
+	delta_x[3] = 0.0f;
+	delta_x[4] = 0.0f;
+	delta_x[5] = 0.0f;
+	delta_x[6] = 0.0f;
+	delta_x[7] = 0.0f;
+	delta_x[8] = K_8_0*resid[0] + K_8_1*resid[1] + K_8_2*resid[2];
+	delta_x[9] = 0.0f;
+	delta_x[10] = 0.0f;
+	delta_x[11] = 0.0f;
+	delta_x[12] = 0.0f;
+	delta_x[13] = 0.0f;
+	delta_x[14] = K_14_0*resid[0] + K_14_1*resid[1] + K_14_2*resid[2];
+
+	/* calculate a posteriori process covariance matrix */
+	P_post(0, 0) = P_prior(0, 0);
+	P_post(0, 1) = P_prior(0, 1);
+	P_post(0, 2) = P_prior(0, 2);
+	P_post(0, 3) = P_prior(0, 3);
+	P_post(0, 4) = P_prior(0, 4);
+	P_post(0, 5) = P_prior(0, 5);
+	P_post(0, 6) = P_prior(0, 6);
+	P_post(0, 7) = P_prior(0, 7);
+	P_post(0, 8) = P_prior(0, 8) - K_8_0*PHt_0_0 - K_8_1*PHt_0_1 - K_8_2*PHt_0_2;
+	P_post(0, 9) = P_prior(0, 9);
+	P_post(0, 10) = P_prior(0, 10);
+	P_post(0, 11) = P_prior(0, 11);
+	P_post(0, 12) = P_prior(0, 12);
+	P_post(0, 13) = P_prior(0, 13);
+	P_post(0, 14) = P_prior(0, 14) - K_14_0*PHt_0_0 - K_14_1*PHt_0_1 - K_14_2*PHt_0_2;
+	P_post(1, 1) = P_prior(1, 1);
+	P_post(1, 2) = P_prior(1, 2);
+	P_post(1, 3) = P_prior(1, 3);
+	P_post(1, 4) = P_prior(1, 4);
+	P_post(1, 5) = P_prior(1, 5);
+	P_post(1, 6) = P_prior(1, 6);
+	P_post(1, 7) = P_prior(1, 7);
+	P_post(1, 8) = P_prior(1, 8) - K_8_0*PHt_1_0 - K_8_1*PHt_1_1 - K_8_2*PHt_1_2;
+	P_post(1, 9) = P_prior(1, 9);
+	P_post(1, 10) = P_prior(1, 10);
+	P_post(1, 11) = P_prior(1, 11);
+	P_post(1, 12) = P_prior(1, 12);
+	P_post(1, 13) = P_prior(1, 13);
+	P_post(1, 14) = P_prior(1, 14) - K_14_0*PHt_1_0 - K_14_1*PHt_1_1 - K_14_2*PHt_1_2;
+	P_post(2, 2) = P_prior(2, 2);
+	P_post(2, 3) = P_prior(2, 3);
+	P_post(2, 4) = P_prior(2, 4);
+	P_post(2, 5) = P_prior(2, 5);
+	P_post(2, 6) = P_prior(2, 6);
+	P_post(2, 7) = P_prior(2, 7);
+	P_post(2, 8) = P_prior(2, 8) - K_8_0*PHt_2_0 - K_8_1*PHt_2_1 - K_8_2*PHt_2_2;
+	P_post(2, 9) = P_prior(2, 9);
+	P_post(2, 10) = P_prior(2, 10);
+	P_post(2, 11) = P_prior(2, 11);
+	P_post(2, 12) = P_prior(2, 12);
+	P_post(2, 13) = P_prior(2, 13);
+	P_post(2, 14) = P_prior(2, 14) - K_14_0*PHt_2_0 - K_14_1*PHt_2_1 - K_14_2*PHt_2_2;
+	P_post(3, 3) = P_prior(3, 3);
+	P_post(3, 4) = P_prior(3, 4);
+	P_post(3, 5) = P_prior(3, 5);
+	P_post(3, 6) = P_prior(3, 6);
+	P_post(3, 7) = P_prior(3, 7);
+	P_post(3, 8) = P_prior(3, 8) - K_8_0*PHt_3_0 - K_8_1*PHt_3_1 - K_8_2*PHt_3_2;
+	P_post(3, 9) = P_prior(3, 9);
+	P_post(3, 10) = P_prior(3, 10);
+	P_post(3, 11) = P_prior(3, 11);
+	P_post(3, 12) = P_prior(3, 12);
+	P_post(3, 13) = P_prior(3, 13);
+	P_post(3, 14) = P_prior(3, 14) - K_14_0*PHt_3_0 - K_14_1*PHt_3_1 - K_14_2*PHt_3_2;
+	P_post(4, 4) = P_prior(4, 4);
+	P_post(4, 5) = P_prior(4, 5);
+	P_post(4, 6) = P_prior(4, 6);
+	P_post(4, 7) = P_prior(4, 7);
+	P_post(4, 8) = P_prior(4, 8) - K_8_0*PHt_4_0 - K_8_1*PHt_4_1 - K_8_2*PHt_4_2;
+	P_post(4, 9) = P_prior(4, 9);
+	P_post(4, 10) = P_prior(4, 10);
+	P_post(4, 11) = P_prior(4, 11);
+	P_post(4, 12) = P_prior(4, 12);
+	P_post(4, 13) = P_prior(4, 13);
+	P_post(4, 14) = P_prior(4, 14) - K_14_0*PHt_4_0 - K_14_1*PHt_4_1 - K_14_2*PHt_4_2;
+	P_post(5, 5) = P_prior(5, 5);
+	P_post(5, 6) = P_prior(5, 6);
+	P_post(5, 7) = P_prior(5, 7);
+	P_post(5, 8) = P_prior(5, 8) - K_8_0*PHt_5_0 - K_8_1*PHt_5_1 - K_8_2*PHt_5_2;
+	P_post(5, 9) = P_prior(5, 9);
+	P_post(5, 10) = P_prior(5, 10);
+	P_post(5, 11) = P_prior(5, 11);
+	P_post(5, 12) = P_prior(5, 12);
+	P_post(5, 13) = P_prior(5, 13);
+	P_post(5, 14) = P_prior(5, 14) - K_14_0*PHt_5_0 - K_14_1*PHt_5_1 - K_14_2*PHt_5_2;
+	P_post(6, 6) = P_prior(6, 6);
+	P_post(6, 7) = P_prior(6, 7);
+	P_post(6, 8) = P_prior(6, 8) - K_8_0*PHt_6_0 - K_8_1*PHt_6_1 - K_8_2*PHt_6_2;
+	P_post(6, 9) = P_prior(6, 9);
+	P_post(6, 10) = P_prior(6, 10);
+	P_post(6, 11) = P_prior(6, 11);
+	P_post(6, 12) = P_prior(6, 12);
+	P_post(6, 13) = P_prior(6, 13);
+	P_post(6, 14) = P_prior(6, 14) - K_14_0*PHt_6_0 - K_14_1*PHt_6_1 - K_14_2*PHt_6_2;
+	P_post(7, 7) = P_prior(7, 7);
+	P_post(7, 8) = P_prior(7, 8) - K_8_0*PHt_7_0 - K_8_1*PHt_7_1 - K_8_2*PHt_7_2;
+	P_post(7, 9) = P_prior(7, 9);
+	P_post(7, 10) = P_prior(7, 10);
+	P_post(7, 11) = P_prior(7, 11);
+	P_post(7, 12) = P_prior(7, 12);
+	P_post(7, 13) = P_prior(7, 13);
+	P_post(7, 14) = P_prior(7, 14) - K_14_0*PHt_7_0 - K_14_1*PHt_7_1 - K_14_2*PHt_7_2;
+	P_post(8, 8) = P_prior(8, 8) - K_8_0*PHt_8_0 - K_8_1*PHt_8_1 - K_8_2*PHt_8_2;
+	P_post(8, 9) = P_prior(8, 9) - K_8_0*PHt_9_0 - K_8_1*PHt_9_1 - K_8_2*PHt_9_2;
+	P_post(8, 10) = P_prior(8, 10) - K_8_0*PHt_10_0 - K_8_1*PHt_10_1 - K_8_2*PHt_10_2;
+	P_post(8, 11) = P_prior(8, 11) - K_8_0*PHt_11_0 - K_8_1*PHt_11_1 - K_8_2*PHt_11_2;
+	P_post(8, 12) = P_prior(8, 12) - K_8_0*PHt_12_0 - K_8_1*PHt_12_1 - K_8_2*PHt_12_2;
+	P_post(8, 13) = P_prior(8, 13) - K_8_0*PHt_13_0 - K_8_1*PHt_13_1 - K_8_2*PHt_13_2;
+	P_post(8, 14) = P_prior(8, 14) - K_8_0*PHt_14_0 - K_8_1*PHt_14_1 - K_8_2*PHt_14_2;
+	P_post(9, 9) = P_prior(9, 9);
+	P_post(9, 10) = P_prior(9, 10);
+	P_post(9, 11) = P_prior(9, 11);
+	P_post(9, 12) = P_prior(9, 12);
+	P_post(9, 13) = P_prior(9, 13);
+	P_post(9, 14) = P_prior(9, 14) - K_14_0*PHt_9_0 - K_14_1*PHt_9_1 - K_14_2*PHt_9_2;
+	P_post(10, 10) = P_prior(10, 10);
+	P_post(10, 11) = P_prior(10, 11);
+	P_post(10, 12) = P_prior(10, 12);
+	P_post(10, 13) = P_prior(10, 13);
+	P_post(10, 14) = P_prior(10, 14) - K_14_0*PHt_10_0 - K_14_1*PHt_10_1 - K_14_2*PHt_10_2;
+	P_post(11, 11) = P_prior(11, 11);
+	P_post(11, 12) = P_prior(11, 12);
+	P_post(11, 13) = P_prior(11, 13);
+	P_post(11, 14) = P_prior(11, 14) - K_14_0*PHt_11_0 - K_14_1*PHt_11_1 - K_14_2*PHt_11_2;
+	P_post(12, 12) = P_prior(12, 12);
+	P_post(12, 13) = P_prior(12, 13);
+	P_post(12, 14) = P_prior(12, 14) - K_14_0*PHt_12_0 - K_14_1*PHt_12_1 - K_14_2*PHt_12_2;
+	P_post(13, 13) = P_prior(13, 13);
+	P_post(13, 14) = P_prior(13, 14) - K_14_0*PHt_13_0 - K_14_1*PHt_13_1 - K_14_2*PHt_13_2;
+	P_post(14, 14) = P_prior(14, 14) - K_14_0*PHt_14_0 - K_14_1*PHt_14_1 - K_14_2*PHt_14_2;
+}
+
+/* kalman gain, error state and a posteriori covariance of the gps update,
+ * resid = (px, py, vx, vy) - nominal state at the capture time */
+void eskf_ins_gps_covariance_update(const float *_P_prior, float *_P_post, float *delta_x,
+                                    float lag, const float *resid, const float *V)
+{
+	/* calculate P * Ht */
+	float c0 = -P_prior(3, 4)*lag;
+	float PHt_0_0 = P_prior(0, 0) - P_prior(0, 3)*lag;
+	float PHt_0_1 = P_prior(0, 1) - P_prior(0, 4)*lag;
+	float PHt_0_2 = P_prior(0, 3);
+	float PHt_0_3 = P_prior(0, 4);
+	float PHt_1_0 = P_prior(0, 1) - P_prior(1, 3)*lag;
+	float PHt_1_1 = P_prior(1, 1) - P_prior(1, 4)*lag;
+	float PHt_1_2 = P_prior(1, 3);
+	float PHt_1_3 = P_prior(1, 4);
+	float PHt_2_0 = P_prior(0, 2) - P_prior(2, 3)*lag;
+	float PHt_2_1 = P_prior(1, 2) - P_prior(2, 4)*lag;
+	float PHt_2_2 = P_prior(2, 3);
+	float PHt_2_3 = P_prior(2, 4);
+	float PHt_3_0 = P_prior(0, 3) - P_prior(3, 3)*lag;
+	float PHt_3_1 = P_prior(1, 3) + c0;
+	float PHt_3_2 = P_prior(3, 3);
+	float PHt_3_3 = P_prior(3, 4);
+	float PHt_4_0 = P_prior(0, 4) + c0;
+	float PHt_4_1 = P_prior(1, 4) - P_prior(4, 4)*lag;
+	float PHt_4_2 = P_prior(3, 4);
+	float PHt_4_3 = P_prior(4, 4);
+	float PHt_5_0 = P_prior(0, 5) - P_prior(3, 5)*lag;
+	float PHt_5_1 = P_prior(1, 5) - P_prior(4, 5)*lag;
+	float PHt_5_2 = P_prior(3, 5);
+	float PHt_5_3 = P_prior(4, 5);
+	float PHt_6_0 = P_prior(0, 6) - P_prior(3, 6)*lag;
+	float PHt_6_1 = P_prior(1, 6) - P_prior(4, 6)*lag;
+	float PHt_6_2 = P_prior(3, 6);
+	float PHt_6_3 = P_prior(4, 6);
+	float PHt_7_0 = P_prior(0, 7) - P_prior(3, 7)*lag;
+	float PHt_7_1 = P_prior(1, 7) - P_prior(4, 7)*lag;
+	float PHt_7_2 = P_prior(3, 7);
+	float PHt_7_3 = P_prior(4, 7);
+	float PHt_8_0 = P_prior(0, 8) - P_prior(3, 8)*lag;
+	float PHt_8_1 = P_prior(1, 8) - P_prior(4, 8)*lag;
+	float PHt_8_2 = P_prior(3, 8);
+	float PHt_8_3 = P_prior(4, 8);
+	float PHt_9_0 = P_prior(0, 9) - P_prior(3, 9)*lag;
+	float PHt_9_1 = P_prior(1, 9) - P_prior(4, 9)*lag;
+	float PHt_9_2 = P_prior(3, 9);
+	float PHt_9_3 = P_prior(4, 9);
+	float PHt_10_0 = P_prior(0, 10) - P_prior(3, 10)*lag;
+	float PHt_10_1 = P_prior(1, 10) - P_prior(4, 10)*lag;
+	float PHt_10_2 = P_prior(3, 10);
+	float PHt_10_3 = P_prior(4, 10);
+	float PHt_11_0 = P_prior(0, 11) - P_prior(3, 11)*lag;
+	float PHt_11_1 = P_prior(1, 11) - P_prior(4, 11)*lag;
+	float PHt_11_2 = P_prior(3, 11);
+	float PHt_11_3 = P_prior(4, 11);
+	float PHt_12_0 = P_prior(0, 12) - P_prior(3, 12)*lag;
+	float PHt_12_1 = P_prior(1, 12) - P_prior(4, 12)*lag;
+	float PHt_12_2 = P_prior(3, 12);
+	float PHt_12_3 = P_prior(4, 12);
+	float PHt_13_0 = P_prior(0, 13) - P_prior(3, 13)*lag;
+	float PHt_13_1 = P_prior(1, 13) - P_prior(4, 13)*lag;
+	float PHt_13_2 = P_prior(3, 13);
+	float PHt_13_3 = P_prior(4, 13);
+	float PHt_14_0 = P_prior(0, 14) - P_prior(3, 14)*lag;
+	float PHt_14_1 = P_prior(1, 14) - P_prior(4, 14)*lag;
+	float PHt_14_2 = P_prior(3, 14);
+	float PHt_14_3 = P_prior(4, 14);
+
+	/* calculate (H * P * Ht) + V */
+	float HPHt_V_0_0 = PHt_0_0 + V[0] - PHt_3_0*lag;
+	float HPHt_V_0_1 = PHt_0_1 - PHt_3_1*lag;
+	float HPHt_V_0_2 = PHt_0_2 - PHt_3_2*lag;
+	float HPHt_V_0_3 = PHt_0_3 - PHt_3_3*lag;
+	float HPHt_V_1_1 = PHt_1_1 + V[5] - PHt_4_1*lag;
+	float HPHt_V_1_2 = PHt_1_2 - PHt_4_2*lag;
+	float HPHt_V_1_3 = PHt_1_3 - PHt_4_3*lag;
+	float HPHt_V_2_2 = PHt_3_2 + V[10];
+	float HPHt_V_2_3 = PHt_3_3;
+	float HPHt_V_3_3 = PHt_4_3 + V[15];
+
+	/* calculate inv((H * P * Ht) + V) */
+	float c1 = HPHt_V_2_3*HPHt_V_2_3;
+	float c2 = HPHt_V_1_2*HPHt_V_1_2;
+	float c3 = HPHt_V_1_3*HPHt_V_1_3;
+	float c4 = HPHt_V_2_2*HPHt_V_3_3;
+	float c5 = HPHt_V_1_2*HPHt_V_2_3;
+	float c6 = HPHt_V_1_1*c1 + HPHt_V_2_2*c3 + HPHt_V_3_3*c2 - HPHt_V_1_1*c4 - 2.0f*HPHt_V_1_3*c5;
+	float c7 = HPHt_V_0_2*HPHt_V_1_3;
+	float c8 = HPHt_V_1_2*HPHt_V_3_3;
+	float c9 = HPHt_V_0_3*HPHt_V_2_2;
+	float c10 = HPHt_V_0_1*c4 + HPHt_V_0_3*c5 + HPHt_V_2_3*c7 - HPHt_V_0_1*c1 - HPHt_V_0_2*c8 - HPHt_V_1_3*c9;
+	float c11 = HPHt_V_0_1*HPHt_V_1_3;
+	float c12 = HPHt_V_1_1*HPHt_V_2_3;
+	float c13 = HPHt_V_0_1*c5 + HPHt_V_1_1*c9 + HPHt_V_1_2*c7 - HPHt_V_0_2*c12 - HPHt_V_0_3*c2 - HPHt_V_2_2*c11;
+	float c14 = HPHt_V_0_2*HPHt_V_3_3;
+	float c15 = HPHt_V_0_3*HPHt_V_1_2;
+	float c16 = HPHt_V_0_1*c8 + HPHt_V_0_2*c3 + HPHt_V_0_3*c12 - HPHt_V_1_1*c14 - HPHt_V_1_3*c15 - HPHt_V_2_3*c11;
+	float c17 = HPHt_V_0_2*HPHt_V_0_2;
+	float c18 = HPHt_V_0_3*HPHt_V_0_3;
+	float c19 = HPHt_V_0_2*HPHt_V_0_3;
+	float c20 = HPHt_V_0_1*HPHt_V_2_3;
+	float c21 = HPHt_V_0_0*HPHt_V_1_3;
+	float c22 = HPHt_V_0_1*HPHt_V_0_1;
+	float c23 = HPHt_V_0_0*HPHt_V_1_1;
+	float div_det = -1.0f/(HPHt_V_0_0*c6 + HPHt_V_0_1*c10 + HPHt_V_0_3*c13 - HPHt_V_0_2*c16);
+	float HPHt_V_inv_0_0 = -c6*div_det;
+	float HPHt_V_inv_0_1 = -c10*div_det;
+	float HPHt_V_inv_0_2 = c16*div_det;
+	float HPHt_V_inv_0_3 = -c13*div_det;
+	float HPHt_V_inv_1_1 = -div_det*(HPHt_V_0_0*c1 + HPHt_V_2_2*c18 + HPHt_V_3_3*c17 - HPHt_V_0_0*c4 - 2.0f*HPHt_V_2_3*c19);
+	float HPHt_V_inv_1_2 = -div_det*(HPHt_V_0_0*c8 + HPHt_V_0_3*c20 + HPHt_V_0_3*c7 - HPHt_V_0_1*c14 - HPHt_V_1_2*c18 - HPHt_V_2_3*c21);
+	float HPHt_V_inv_1_3 = div_det*(HPHt_V_0_0*c5 + HPHt_V_0_1*c9 + HPHt_V_1_3*c17 - HPHt_V_0_2*c15 - HPHt_V_0_2*c20 - HPHt_V_2_2*c21);
+	float HPHt_V_inv_2_2 = -div_det*(HPHt_V_0_0*c3 + HPHt_V_1_1*c18 + HPHt_V_3_3*c22 - 2.0f*HPHt_V_0_3*c11 - HPHt_V_3_3*c23);
+	float HPHt_V_inv_2_3 = -div_det*(HPHt_V_0_0*c12 + HPHt_V_0_1*c15 + HPHt_V_0_1*c7 - HPHt_V_1_1*c19 - HPHt_V_1_2*c21 - HPHt_V_2_3*c22);
+	float HPHt_V_inv_3_3 = -div_det*(HPHt_V_0_0*c2 + HPHt_V_1_1*c17 + HPHt_V_2_2*c22 - 2.0f*HPHt_V_0_1*HPHt_V_0_2*HPHt_V_1_2 - HPHt_V_2_2*c23);
+
+	/* calculate kalman gain */
+	float K_0_0 = HPHt_V_inv_0_0*PHt_0_0 + HPHt_V_inv_0_1*PHt_0_1 + HPHt_V_inv_0_2*PHt_0_2 + HPHt_V_inv_0_3*PHt_0_3;
+	float K_0_1 = HPHt_V_inv_0_1*PHt_0_0 + HPHt_V_inv_1_1*PHt_0_1 + HPHt_V_inv_1_2*PHt_0_2 + HPHt_V_inv_1_3*PHt_0_3;
+	float K_0_2 = HPHt_V_inv_0_2*PHt_0_0 + HPHt_V_inv_1_2*PHt_0_1 + HPHt_V_inv_2_2*PHt_0_2 + HPHt_V_inv_2_3*PHt_0_3;
+	float K_0_3 = HPHt_V_inv_0_3*PHt_0_0 + HPHt_V_inv_1_3*PHt_0_1 + HPHt_V_inv_2_3*PHt_0_2 + HPHt_V_inv_3_3*PHt_0_3;
+	float K_1_0 = HPHt_V_inv_0_0*PHt_1_0 + HPHt_V_inv_0_1*PHt_1_1 + HPHt_V_inv_0_2*PHt_1_2 + HPHt_V_inv_0_3*PHt_1_3;
+	float K_1_1 = HPHt_V_inv_0_1*PHt_1_0 + HPHt_V_inv_1_1*PHt_1_1 + HPHt_V_inv_1_2*PHt_1_2 + HPHt_V_inv_1_3*PHt_1_3;
+	float K_1_2 = HPHt_V_inv_0_2*PHt_1_0 + HPHt_V_inv_1_2*PHt_1_1 + HPHt_V_inv_2_2*PHt_1_2 + HPHt_V_inv_2_3*PHt_1_3;
+	float K_1_3 = HPHt_V_inv_0_3*PHt_1_0 + HPHt_V_inv_1_3*PHt_1_1 + HPHt_V_inv_2_3*PHt_1_2 + HPHt_V_inv_3_3*PHt_1_3;
+	float K_3_0 = HPHt_V_inv_0_0*PHt_3_0 + HPHt_V_inv_0_1*PHt_3_1 + HPHt_V_inv_0_2*PHt_3_2 + HPHt_V_inv_0_3*PHt_3_3;
+	float K_3_1 = HPHt_V_inv_0_1*PHt_3_0 + HPHt_V_inv_1_1*PHt_3_1 + HPHt_V_inv_1_2*PHt_3_2 + HPHt_V_inv_1_3*PHt_3_3;
+	float K_3_2 = HPHt_V_inv_0_2*PHt_3_0 + HPHt_V_inv_1_2*PHt_3_1 + HPHt_V_inv_2_2*PHt_3_2 + HPHt_V_inv_2_3*PHt_3_3;
+	float K_3_3 = HPHt_V_inv_0_3*PHt_3_0 + HPHt_V_inv_1_3*PHt_3_1 + HPHt_V_inv_2_3*PHt_3_2 + HPHt_V_inv_3_3*PHt_3_3;
+	float K_4_0 = HPHt_V_inv_0_0*PHt_4_0 + HPHt_V_inv_0_1*PHt_4_1 + HPHt_V_inv_0_2*PHt_4_2 + HPHt_V_inv_0_3*PHt_4_3;
+	float K_4_1 = HPHt_V_inv_0_1*PHt_4_0 + HPHt_V_inv_1_1*PHt_4_1 + HPHt_V_inv_1_2*PHt_4_2 + HPHt_V_inv_1_3*PHt_4_3;
+	float K_4_2 = HPHt_V_inv_0_2*PHt_4_0 + HPHt_V_inv_1_2*PHt_4_1 + HPHt_V_inv_2_2*PHt_4_2 + HPHt_V_inv_2_3*PHt_4_3;
+	float K_4_3 = HPHt_V_inv_0_3*PHt_4_0 + HPHt_V_inv_1_3*PHt_4_1 + HPHt_V_inv_2_3*PHt_4_2 + HPHt_V_inv_3_3*PHt_4_3;
+	float K_9_0 = HPHt_V_inv_0_0*PHt_9_0 + HPHt_V_inv_0_1*PHt_9_1 + HPHt_V_inv_0_2*PHt_9_2 + HPHt_V_inv_0_3*PHt_9_3;
+	float K_9_1 = HPHt_V_inv_0_1*PHt_9_0 + HPHt_V_inv_1_1*PHt_9_1 + HPHt_V_inv_1_2*PHt_9_2 + HPHt_V_inv_1_3*PHt_9_3;
+	float K_9_2 = HPHt_V_inv_0_2*PHt_9_0 + HPHt_V_inv_1_2*PHt_9_1 + HPHt_V_inv_2_2*PHt_9_2 + HPHt_V_inv_2_3*PHt_9_3;
+	float K_9_3 = HPHt_V_inv_0_3*PHt_9_0 + HPHt_V_inv_1_3*PHt_9_1 + HPHt_V_inv_2_3*PHt_9_2 + HPHt_V_inv_3_3*PHt_9_3;
+	float K_10_0 = HPHt_V_inv_0_0*PHt_10_0 + HPHt_V_inv_0_1*PHt_10_1 + HPHt_V_inv_0_2*PHt_10_2 + HPHt_V_inv_0_3*PHt_10_3;
+	float K_10_1 = HPHt_V_inv_0_1*PHt_10_0 + HPHt_V_inv_1_1*PHt_10_1 + HPHt_V_inv_1_2*PHt_10_2 + HPHt_V_inv_1_3*PHt_10_3;
+	float K_10_2 = HPHt_V_inv_0_2*PHt_10_0 + HPHt_V_inv_1_2*PHt_10_1 + HPHt_V_inv_2_2*PHt_10_2 + HPHt_V_inv_2_3*PHt_10_3;
+	float K_10_3 = HPHt_V_inv_0_3*PHt_10_0 + HPHt_V_inv_1_3*PHt_10_1 + HPHt_V_inv_2_3*PHt_10_2 + HPHt_V_inv_3_3*PHt_10_3;
+	float K_11_0 = HPHt_V_inv_0_0*PHt_11_0 + HPHt_V_inv_0_1*PHt_11_1 + HPHt_V_inv_0_2*PHt_11_2 + HPHt_V_inv_0_3*PHt_11_3;
+	float K_11_1 = HPHt_V_inv_0_1*PHt_11_0 + HPHt_V_inv_1_1*PHt_11_1 + HPHt_V_inv_1_2*PHt_11_2 + HPHt_V_inv_1_3*PHt_11_3;
+	float K_11_2 = HPHt_V_inv_0_2*PHt_11_0 + HPHt_V_inv_1_2*PHt_11_1 + HPHt_V_inv_2_2*PHt_11_2 + HPHt_V_inv_2_3*PHt_11_3;
+	float K_11_3 = HPHt_V_inv_0_3*PHt_11_0 + HPHt_V_inv_1_3*PHt_11_1 + HPHt_V_inv_2_3*PHt_11_2 + HPHt_V_inv_3_3*PHt_11_3;
+
+	/* calculate error state */
+	delta_x[0] = K_0_0*resid[0] + K_0_1*resid[1] + K_0_2*resid[2] + K_0_3*resid[3];
+	delta_x[1] = K_1_0*resid[0] + K_1_1*resid[1] + K_1_2*resid[2] + K_1_3*resid[3];
+	delta_x[2] = 0.0f;
+	delta_x[3] = K_3_0*resid[0] + K_3_1*resid[1] + K_3_2*resid[2] + K_3_3*resid[3];
+	delta_x[4] = K_4_0*resid[0] + K_4_1*resid[1] + K_4_2*resid[2] + K_4_3*resid[3];
+	delta_x[5] = 0.0f;
+	delta_x[6] = 0.0f;
+	delta_x[7] = 0.0f;
+	delta_x[8] = 0.0f;
+	delta_x[9] = K_9_0*resid[0] + K_9_1*resid[1] + K_9_2*resid[2] + K_9_3*resid[3];
+	delta_x[10] = K_10_0*resid[0] + K_10_1*resid[1] + K_10_2*resid[2] + K_10_3*resid[3];
+	delta_x[11] = K_11_0*resid[0] + K_11_1*resid[1] + K_11_2*resid[2] + K_11_3*resid[3];
+	delta_x[12] = 0.0f;
+	delta_x[13] = 0.0f;
+	delta_x[14] = 0.0f;
+
+	/* calculate a posteriori process covariance matrix */
+	P_post(0, 0) = P_prior(0, 0) - K_0_0*PHt_0_0 - K_0_1*PHt_0_1 - K_0_2*PHt_0_2 - K_0_3*PHt_0_3;
+	P_post(0, 1) = P_prior(0, 1) - K_0_0*PHt_1_0 - K_0_1*PHt_1_1 - K_0_2*PHt_1_2 - K_0_3*PHt_1_3;
+	P_post(0, 2) = P_prior(0, 2) - K_0_0*PHt_2_0 - K_0_1*PHt_2_1 - K_0_2*PHt_2_2 - K_0_3*PHt_2_3;
+	P_post(0, 3) = P_prior(0, 3) - K_0_0*PHt_3_0 - K_0_1*PHt_3_1 - K_0_2*PHt_3_2 - K_0_3*PHt_3_3;
+	P_post(0, 4) = P_prior(0, 4) - K_0_0*PHt_4_0 - K_0_1*PHt_4_1 - K_0_2*PHt_4_2 - K_0_3*PHt_4_3;
+	P_post(0, 5) = P_prior(0, 5) - K_0_0*PHt_5_0 - K_0_1*PHt_5_1 - K_0_2*PHt_5_2 - K_0_3*PHt_5_3;
+	P_post(0, 6) = P_prior(0, 6) - K_0_0*PHt_6_0 - K_0_1*PHt_6_1 - K_0_2*PHt_6_2 - K_0_3*PHt_6_3;
+	P_post(0, 7) = P_prior(0, 7) - K_0_0*PHt_7_0 - K_0_1*PHt_7_1 - K_0_2*PHt_7_2 - K_0_3*PHt_7_3;
+	P_post(0, 8) = P_prior(0, 8) - K_0_0*PHt_8_0 - K_0_1*PHt_8_1 - K_0_2*PHt_8_2 - K_0_3*PHt_8_3;
+	P_post(0, 9) = P_prior(0, 9) - K_0_0*PHt_9_0 - K_0_1*PHt_9_1 - K_0_2*PHt_9_2 - K_0_3*PHt_9_3;
+	P_post(0, 10) = P_prior(0, 10) - K_0_0*PHt_10_0 - K_0_1*PHt_10_1 - K_0_2*PHt_10_2 - K_0_3*PHt_10_3;
+	P_post(0, 11) = P_prior(0, 11) - K_0_0*PHt_11_0 - K_0_1*PHt_11_1 - K_0_2*PHt_11_2 - K_0_3*PHt_11_3;
+	P_post(0, 12) = P_prior(0, 12) - K_0_0*PHt_12_0 - K_0_1*PHt_12_1 - K_0_2*PHt_12_2 - K_0_3*PHt_12_3;
+	P_post(0, 13) = P_prior(0, 13) - K_0_0*PHt_13_0 - K_0_1*PHt_13_1 - K_0_2*PHt_13_2 - K_0_3*PHt_13_3;
+	P_post(0, 14) = P_prior(0, 14) - K_0_0*PHt_14_0 - K_0_1*PHt_14_1 - K_0_2*PHt_14_2 - K_0_3*PHt_14_3;
+	P_post(1, 1) = P_prior(1, 1) - K_1_0*PHt_1_0 - K_1_1*PHt_1_1 - K_1_2*PHt_1_2 - K_1_3*PHt_1_3;
+	P_post(1, 2) = P_prior(1, 2) - K_1_0*PHt_2_0 - K_1_1*PHt_2_1 - K_1_2*PHt_2_2 - K_1_3*PHt_2_3;
+	P_post(1, 3) = P_prior(1, 3) - K_1_0*PHt_3_0 - K_1_1*PHt_3_1 - K_1_2*PHt_3_2 - K_1_3*PHt_3_3;
+	P_post(1, 4) = P_prior(1, 4) - K_1_0*PHt_4_0 - K_1_1*PHt_4_1 - K_1_2*PHt_4_2 - K_1_3*PHt_4_3;
+	P_post(1, 5) = P_prior(1, 5) - K_1_0*PHt_5_0 - K_1_1*PHt_5_1 - K_1_2*PHt_5_2 - K_1_3*PHt_5_3;
+	P_post(1, 6) = P_prior(1, 6) - K_1_0*PHt_6_0 - K_1_1*PHt_6_1 - K_1_2*PHt_6_2 - K_1_3*PHt_6_3;
+	P_post(1, 7) = P_prior(1, 7) - K_1_0*PHt_7_0 - K_1_1*PHt_7_1 - K_1_2*PHt_7_2 - K_1_3*PHt_7_3;
+	P_post(1, 8) = P_prior(1, 8) - K_1_0*PHt_8_0 - K_1_1*PHt_8_1 - K_1_2*PHt_8_2 - K_1_3*PHt_8_3;
+	P_post(1, 9) = P_prior(1, 9) - K_1_0*PHt_9_0 - K_1_1*PHt_9_1 - K_1_2*PHt_9_2 - K_1_3*PHt_9_3;
+	P_post(1, 10) = P_prior(1, 10) - K_1_0*PHt_10_0 - K_1_1*PHt_10_1 - K_1_2*PHt_10_2 - K_1_3*PHt_10_3;
+	P_post(1, 11) = P_prior(1, 11) - K_1_0*PHt_11_0 - K_1_1*PHt_11_1 - K_1_2*PHt_11_2 - K_1_3*PHt_11_3;
+	P_post(1, 12) = P_prior(1, 12) - K_1_0*PHt_12_0 - K_1_1*PHt_12_1 - K_1_2*PHt_12_2 - K_1_3*PHt_12_3;
+	P_post(1, 13) = P_prior(1, 13) - K_1_0*PHt_13_0 - K_1_1*PHt_13_1 - K_1_2*PHt_13_2 - K_1_3*PHt_13_3;
+	P_post(1, 14) = P_prior(1, 14) - K_1_0*PHt_14_0 - K_1_1*PHt_14_1 - K_1_2*PHt_14_2 - K_1_3*PHt_14_3;
+	P_post(2, 2) = P_prior(2, 2);
+	P_post(2, 3) = P_prior(2, 3) - K_3_0*PHt_2_0 - K_3_1*PHt_2_1 - K_3_2*PHt_2_2 - K_3_3*PHt_2_3;
+	P_post(2, 4) = P_prior(2, 4) - K_4_0*PHt_2_0 - K_4_1*PHt_2_1 - K_4_2*PHt_2_2 - K_4_3*PHt_2_3;
+	P_post(2, 5) = P_prior(2, 5);
+	P_post(2, 6) = P_prior(2, 6);
+	P_post(2, 7) = P_prior(2, 7);
+	P_post(2, 8) = P_prior(2, 8);
+	P_post(2, 9) = P_prior(2, 9) - K_9_0*PHt_2_0 - K_9_1*PHt_2_1 - K_9_2*PHt_2_2 - K_9_3*PHt_2_3;
+	P_post(2, 10) = P_prior(2, 10) - K_10_0*PHt_2_0 - K_10_1*PHt_2_1 - K_10_2*PHt_2_2 - K_10_3*PHt_2_3;
+	P_post(2, 11) = P_prior(2, 11) - K_11_0*PHt_2_0 - K_11_1*PHt_2_1 - K_11_2*PHt_2_2 - K_11_3*PHt_2_3;
+	P_post(2, 12) = P_prior(2, 12);
+	P_post(2, 13) = P_prior(2, 13);
+	P_post(2, 14) = P_prior(2, 14);
+	P_post(3, 3) = P_prior(3, 3) - K_3_0*PHt_3_0 - K_3_1*PHt_3_1 - K_3_2*PHt_3_2 - K_3_3*PHt_3_3;
+	P_post(3, 4) = P_prior(3, 4) - K_3_0*PHt_4_0 - K_3_1*PHt_4_1 - K_3_2*PHt_4_2 - K_3_3*PHt_4_3;
+	P_post(3, 5) = P_prior(3, 5) - K_3_0*PHt_5_0 - K_3_1*PHt_5_1 - K_3_2*PHt_5_2 - K_3_3*PHt_5_3;
+	P_post(3, 6) = P_prior(3, 6) - K_3_0*PHt_6_0 - K_3_1*PHt_6_1 - K_3_2*PHt_6_2 - K_3_3*PHt_6_3;
+	P_post(3, 7) = P_prior(3, 7) - K_3_0*PHt_7_0 - K_3_1*PHt_7_1 - K_3_2*PHt_7_2 - K_3_3*PHt_7_3;
+	P_post(3, 8) = P_prior(3, 8) - K_3_0*PHt_8_0 - K_3_1*PHt_8_1 - K_3_2*PHt_8_2 - K_3_3*PHt_8_3;
+	P_post(3, 9) = P_prior(3, 9) - K_3_0*PHt_9_0 - K_3_1*PHt_9_1 - K_3_2*PHt_9_2 - K_3_3*PHt_9_3;
+	P_post(3, 10) = P_prior(3, 10) - K_3_0*PHt_10_0 - K_3_1*PHt_10_1 - K_3_2*PHt_10_2 - K_3_3*PHt_10_3;
+	P_post(3, 11) = P_prior(3, 11) - K_3_0*PHt_11_0 - K_3_1*PHt_11_1 - K_3_2*PHt_11_2 - K_3_3*PHt_11_3;
+	P_post(3, 12) = P_prior(3, 12) - K_3_0*PHt_12_0 - K_3_1*PHt_12_1 - K_3_2*PHt_12_2 - K_3_3*PHt_12_3;
+	P_post(3, 13) = P_prior(3, 13) - K_3_0*PHt_13_0 - K_3_1*PHt_13_1 - K_3_2*PHt_13_2 - K_3_3*PHt_13_3;
+	P_post(3, 14) = P_prior(3, 14) - K_3_0*PHt_14_0 - K_3_1*PHt_14_1 - K_3_2*PHt_14_2 - K_3_3*PHt_14_3;
+	P_post(4, 4) = P_prior(4, 4) - K_4_0*PHt_4_0 - K_4_1*PHt_4_1 - K_4_2*PHt_4_2 - K_4_3*PHt_4_3;
+	P_post(4, 5) = P_prior(4, 5) - K_4_0*PHt_5_0 - K_4_1*PHt_5_1 - K_4_2*PHt_5_2 - K_4_3*PHt_5_3;
+	P_post(4, 6) = P_prior(4, 6) - K_4_0*PHt_6_0 - K_4_1*PHt_6_1 - K_4_2*PHt_6_2 - K_4_3*PHt_6_3;
+	P_post(4, 7) = P_prior(4, 7) - K_4_0*PHt_7_0 - K_4_1*PHt_7_1 - K_4_2*PHt_7_2 - K_4_3*PHt_7_3;
+	P_post(4, 8) = P_prior(4, 8) - K_4_0*PHt_8_0 - K_4_1*PHt_8_1 - K_4_2*PHt_8_2 - K_4_3*PHt_8_3;
+	P_post(4, 9) = P_prior(4, 9) - K_4_0*PHt_9_0 - K_4_1*PHt_9_1 - K_4_2*PHt_9_2 - K_4_3*PHt_9_3;
+	P_post(4, 10) = P_prior(4, 10) - K_4_0*PHt_10_0 - K_4_1*PHt_10_1 - K_4_2*PHt_10_2 - K_4_3*PHt_10_3;
+	P_post(4, 11) = P_prior(4, 11) - K_4_0*PHt_11_0 - K_4_1*PHt_11_1 - K_4_2*PHt_11_2 - K_4_3*PHt_11_3;
+	P_post(4, 12) = P_prior(4, 12) - K_4_0*PHt_12_0 - K_4_1*PHt_12_1 - K_4_2*PHt_12_2 - K_4_3*PHt_12_3;
+	P_post(4, 13) = P_prior(4, 13) - K_4_0*PHt_13_0 - K_4_1*PHt_13_1 - K_4_2*PHt_13_2 - K_4_3*PHt_13_3;
+	P_post(4, 14) = P_prior(4, 14) - K_4_0*PHt_14_0 - K_4_1*PHt_14_1 - K_4_2*PHt_14_2 - K_4_3*PHt_14_3;
+	P_post(5, 5) = P_prior(5, 5);
+	P_post(5, 6) = P_prior(5, 6);
+	P_post(5, 7) = P_prior(5, 7);
+	P_post(5, 8) = P_prior(5, 8);
+	P_post(5, 9) = P_prior(5, 9) - K_9_0*PHt_5_0 - K_9_1*PHt_5_1 - K_9_2*PHt_5_2 - K_9_3*PHt_5_3;
+	P_post(5, 10) = P_prior(5, 10) - K_10_0*PHt_5_0 - K_10_1*PHt_5_1 - K_10_2*PHt_5_2 - K_10_3*PHt_5_3;
+	P_post(5, 11) = P_prior(5, 11) - K_11_0*PHt_5_0 - K_11_1*PHt_5_1 - K_11_2*PHt_5_2 - K_11_3*PHt_5_3;
+	P_post(5, 12) = P_prior(5, 12);
+	P_post(5, 13) = P_prior(5, 13);
+	P_post(5, 14) = P_prior(5, 14);
+	P_post(6, 6) = P_prior(6, 6);
+	P_post(6, 7) = P_prior(6, 7);
+	P_post(6, 8) = P_prior(6, 8);
+	P_post(6, 9) = P_prior(6, 9) - K_9_0*PHt_6_0 - K_9_1*PHt_6_1 - K_9_2*PHt_6_2 - K_9_3*PHt_6_3;
+	P_post(6, 10) = P_prior(6, 10) - K_10_0*PHt_6_0 - K_10_1*PHt_6_1 - K_10_2*PHt_6_2 - K_10_3*PHt_6_3;
+	P_post(6, 11) = P_prior(6, 11) - K_11_0*PHt_6_0 - K_11_1*PHt_6_1 - K_11_2*PHt_6_2 - K_11_3*PHt_6_3;
+	P_post(6, 12) = P_prior(6, 12);
+	P_post(6, 13) = P_prior(6, 13);
+	P_post(6, 14) = P_prior(6, 14);
+	P_post(7, 7) = P_prior(7, 7);
+	P_post(7, 8) = P_prior(7, 8);
+	P_post(7, 9) = P_prior(7, 9) - K_9_0*PHt_7_0 - K_9_1*PHt_7_1 - K_9_2*PHt_7_2 - K_9_3*PHt_7_3;
+	P_post(7, 10) = P_prior(7, 10) - K_10_0*PHt_7_0 - K_10_1*PHt_7_1 - K_10_2*PHt_7_2 - K_10_3*PHt_7_3;
+	P_post(7, 11) = P_prior(7, 11) - K_11_0*PHt_7_0 - K_11_1*PHt_7_1 - K_11_2*PHt_7_2 - K_11_3*PHt_7_3;
+	P_post(7, 12) = P_prior(7, 12);
+	P_post(7, 13) = P_prior(7, 13);
+	P_post(7, 14) = P_prior(7, 14);
+	P_post(8, 8) = P_prior(8, 8);
+	P_post(8, 9) = P_prior(8, 9) - K_9_0*PHt_8_0 - K_9_1*PHt_8_1 - K_9_2*PHt_8_2 - K_9_3*PHt_8_3;
+	P_post(8, 10) = P_prior(8, 10) - K_10_0*PHt_8_0 - K_10_1*PHt_8_1 - K_10_2*PHt_8_2 - K_10_3*PHt_8_3;
+	P_post(8, 11) = P_prior(8, 11) - K_11_0*PHt_8_0 - K_11_1*PHt_8_1 - K_11_2*PHt_8_2 - K_11_3*PHt_8_3;
+	P_post(8, 12) = P_prior(8, 12);
+	P_post(8, 13) = P_prior(8, 13);
+	P_post(8, 14) = P_prior(8, 14);
+	P_post(9, 9) = P_prior(9, 9) - K_9_0*PHt_9_0 - K_9_1*PHt_9_1 - K_9_2*PHt_9_2 - K_9_3*PHt_9_3;
+	P_post(9, 10) = P_prior(9, 10) - K_9_0*PHt_10_0 - K_9_1*PHt_10_1 - K_9_2*PHt_10_2 - K_9_3*PHt_10_3;
+	P_post(9, 11) = P_prior(9, 11) - K_9_0*PHt_11_0 - K_9_1*PHt_11_1 - K_9_2*PHt_11_2 - K_9_3*PHt_11_3;
+	P_post(9, 12) = P_prior(9, 12) - K_9_0*PHt_12_0 - K_9_1*PHt_12_1 - K_9_2*PHt_12_2 - K_9_3*PHt_12_3;
+	P_post(9, 13) = P_prior(9, 13) - K_9_0*PHt_13_0 - K_9_1*PHt_13_1 - K_9_2*PHt_13_2 - K_9_3*PHt_13_3;
+	P_post(9, 14) = P_prior(9, 14) - K_9_0*PHt_14_0 - K_9_1*PHt_14_1 - K_9_2*PHt_14_2 - K_9_3*PHt_14_3;
+	P_post(10, 10) = P_prior(10, 10) - K_10_0*PHt_10_0 - K_10_1*PHt_10_1 - K_10_2*PHt_10_2 - K_10_3*PHt_10_3;
+	P_post(10, 11) = P_prior(10, 11) - K_10_0*PHt_11_0 - K_10_1*PHt_11_1 - K_10_2*PHt_11_2 - K_10_3*PHt_11_3;
+	P_post(10, 12) = P_prior(10, 12) - K_10_0*PHt_12_0 - K_10_1*PHt_12_1 - K_10_2*PHt_12_2 - K_10_3*PHt_12_3;
+	P_post(10, 13) = P_prior(10, 13) - K_10_0*PHt_13_0 - K_10_1*PHt_13_1 - K_10_2*PHt_13_2 - K_10_3*PHt_13_3;
+	P_post(10, 14) = P_prior(10, 14) - K_10_0*PHt_14_0 - K_10_1*PHt_14_1 - K_10_2*PHt_14_2 - K_10_3*PHt_14_3;
+	P_post(11, 11) = P_prior(11, 11) - K_11_0*PHt_11_0 - K_11_1*PHt_11_1 - K_11_2*PHt_11_2 - K_11_3*PHt_11_3;
+	P_post(11, 12) = P_prior(11, 12) - K_11_0*PHt_12_0 - K_11_1*PHt_12_1 - K_11_2*PHt_12_2 - K_11_3*PHt_12_3;
+	P_post(11, 13) = P_prior(11, 13) - K_11_0*PHt_13_0 - K_11_1*PHt_13_1 - K_11_2*PHt_13_2 - K_11_3*PHt_13_3;
+	P_post(11, 14) = P_prior(11, 14) - K_11_0*PHt_14_0 - K_11_1*PHt_14_1 - K_11_2*PHt_14_2 - K_11_3*PHt_14_3;
+	P_post(12, 12) = P_prior(12, 12);
+	P_post(12, 13) = P_prior(12, 13);
+	P_post(12, 14) = P_prior(12, 14);
+	P_post(13, 13) = P_prior(13, 13);
+	P_post(13, 14) = P_prior(13, 14);
+	P_post(14, 14) = P_prior(14, 14);
+}
+
+/* kalman gain, error state and a posteriori covariance of the barometer
+ * update, resid = (pz, vz) - nominal state at the capture time */
+void eskf_ins_barometer_covariance_update(const float *_P_prior, float *_P_post, float *delta_x,
+                                          float lag, const float *resid, const float *V)
+{
+	/* calculate P * Ht */
+	float PHt_0_0 = P_prior(0, 2) - P_prior(0, 5)*lag;
+	float PHt_0_1 = P_prior(0, 5);
+	float PHt_1_0 = P_prior(1, 2) - P_prior(1, 5)*lag;
+	float PHt_1_1 = P_prior(1, 5);
+	float PHt_2_0 = P_prior(2, 2) - P_prior(2, 5)*lag;
+	float PHt_2_1 = P_prior(2, 5);
+	float PHt_3_0 = P_prior(2, 3) - P_prior(3, 5)*lag;
+	float PHt_3_1 = P_prior(3, 5);
+	float PHt_4_0 = P_prior(2, 4) - P_prior(4, 5)*lag;
+	float PHt_4_1 = P_prior(4, 5);
+	float PHt_5_0 = P_prior(2, 5) - P_prior(5, 5)*lag;
+	float PHt_5_1 = P_prior(5, 5);
+	float PHt_6_0 = P_prior(2, 6) - P_prior(5, 6)*lag;
+	float PHt_6_1 = P_prior(5, 6);
+	float PHt_7_0 = P_prior(2, 7) - P_prior(5, 7)*lag;
+	float PHt_7_1 = P_prior(5, 7);
+	float PHt_8_0 = P_prior(2, 8) - P_prior(5, 8)*lag;
+	float PHt_8_1 = P_prior(5, 8);
+	float PHt_9_0 = P_prior(2, 9) - P_prior(5, 9)*lag;
+	float PHt_9_1 = P_prior(5, 9);
+	float PHt_10_0 = P_prior(2, 10) - P_prior(5, 10)*lag;
+	float PHt_10_1 = P_prior(5, 10);
+	float PHt_11_0 = P_prior(2, 11) - P_prior(5, 11)*lag;
+	float PHt_11_1 = P_prior(5, 11);
+	float PHt_12_0 = P_prior(2, 12) - P_prior(5, 12)*lag;
+	float PHt_12_1 = P_prior(5, 12);
+	float PHt_13_0 = P_prior(2, 13) - P_prior(5, 13)*lag;
+	float PHt_13_1 = P_prior(5, 13);
+	float PHt_14_0 = P_prior(2, 14) - P_prior(5, 14)*lag;
+	float PHt_14_1 = P_prior(5, 14);
+
+	/* calculate (H * P * Ht) + V */
+	float HPHt_V_0_0 = PHt_2_0 + V[0] - PHt_5_0*lag;
+	float HPHt_V_0_1 = PHt_2_1 - PHt_5_1*lag;
+	float HPHt_V_1_1 = PHt_5_1 + V[3];
+
+	/* calculate inv((H * P * Ht) + V) */
+	float div_det = 1.0f/(HPHt_V_0_0*HPHt_V_1_1 - HPHt_V_0_1*HPHt_V_0_1);
+	float HPHt_V_inv_0_0 = HPHt_V_1_1*div_det;
+	float HPHt_V_inv_0_1 = -HPHt_V_0_1*div_det;
+	float HPHt_V_inv_1_1 = HPHt_V_0_0*div_det;
+
+	/* calculate kalman gain */
+	float K_2_0 = HPHt_V_inv_0_0*PHt_2_0 + HPHt_V_inv_0_1*PHt_2_1;
+	float K_2_1 = HPHt_V_inv_0_1*PHt_2_0 + HPHt_V_inv_1_1*PHt_2_1;
+	float K_5_0 = HPHt_V_inv_0_0*PHt_5_0 + HPHt_V_inv_0_1*PHt_5_1;
+	float K_5_1 = HPHt_V_inv_0_1*PHt_5_0 + HPHt_V_inv_1_1*PHt_5_1;
+	float K_9_0 = HPHt_V_inv_0_0*PHt_9_0 + HPHt_V_inv_0_1*PHt_9_1;
+	float K_9_1 = HPHt_V_inv_0_1*PHt_9_0 + HPHt_V_inv_1_1*PHt_9_1;
+	float K_10_0 = HPHt_V_inv_0_0*PHt_10_0 + HPHt_V_inv_0_1*PHt_10_1;
+	float K_10_1 = HPHt_V_inv_0_1*PHt_10_0 + HPHt_V_inv_1_1*PHt_10_1;
+	float K_11_0 = HPHt_V_inv_0_0*PHt_11_0 + HPHt_V_inv_0_1*PHt_11_1;
+	float K_11_1 = HPHt_V_inv_0_1*PHt_11_0 + HPHt_V_inv_1_1*PHt_11_1;
+
+	/* calculate error state */
+	delta_x[0] = 0.0f;
+	delta_x[1] = 0.0f;
+	delta_x[2] = K_2_0*resid[0] + K_2_1*resid[1];
+	delta_x[3] = 0.0f;
+	delta_x[4] = 0.0f;
+	delta_x[5] = K_5_0*resid[0] + K_5_1*resid[1];
+	delta_x[6] = 0.0f;
+	delta_x[7] = 0.0f;
+	delta_x[8] = 0.0f;
+	delta_x[9] = K_9_0*resid[0] + K_9_1*resid[1];
+	delta_x[10] = K_10_0*resid[0] + K_10_1*resid[1];
+	delta_x[11] = K_11_0*resid[0] + K_11_1*resid[1];
+	delta_x[12] = 0.0f;
+	delta_x[13] = 0.0f;
+	delta_x[14] = 0.0f;
+
+	/* calculate a posteriori process covariance matrix */
+	P_post(0, 0) = P_prior(0, 0);
+	P_post(0, 1) = P_prior(0, 1);
+	P_post(0, 2) = P_prior(0, 2) - K_2_0*PHt_0_0 - K_2_1*PHt_0_1;
+	P_post(0, 3) = P_prior(0, 3);
+	P_post(0, 4) = P_prior(0, 4);
+	P_post(0, 5) = P_prior(0, 5) - K_5_0*PHt_0_0 - K_5_1*PHt_0_1;
+	P_post(0, 6) = P_prior(0, 6);
+	P_post(0, 7) = P_prior(0, 7);
+	P_post(0, 8) = P_prior(0, 8);
+	P_post(0, 9) = P_prior(0, 9) - K_9_0*PHt_0_0 - K_9_1*PHt_0_1;
+	P_post(0, 10) = P_prior(0, 10) - K_10_0*PHt_0_0 - K_10_1*PHt_0_1;
+	P_post(0, 11) = P_prior(0, 11) - K_11_0*PHt_0_0 - K_11_1*PHt_0_1;
+	P_post(0, 12) = P_prior(0, 12);
+	P_post(0, 13) = P_prior(0, 13);
+	P_post(0, 14) = P_prior(0, 14);
+	P_post(1, 1) = P_prior(1, 1);
+	P_post(1, 2) = P_prior(1, 2) - K_2_0*PHt_1_0 - K_2_1*PHt_1_1;
+	P_post(1, 3) = P_prior(1, 3);
+	P_post(1, 4) = P_prior(1, 4);
+	P_post(1, 5) = P_prior(1, 5) - K_5_0*PHt_1_0 - K_5_1*PHt_1_1;
+	P_post(1, 6) = P_prior(1, 6);
+	P_post(1, 7) = P_prior(1, 7);
+	P_post(1, 8) = P_prior(1, 8);
+	P_post(1, 9) = P_prior(1, 9) - K_9_0*PHt_1_0 - K_9_1*PHt_1_1;
+	P_post(1, 10) = P_prior(1, 10) - K_10_0*PHt_1_0 - K_10_1*PHt_1_1;
+	P_post(1, 11) = P_prior(1, 11) - K_11_0*PHt_1_0 - K_11_1*PHt_1_1;
+	P_post(1, 12) = P_prior(1, 12);
+	P_post(1, 13) = P_prior(1, 13);
+	P_post(1, 14) = P_prior(1, 14);
+	P_post(2, 2) = P_prior(2, 2) - K_2_0*PHt_2_0 - K_2_1*PHt_2_1;
+	P_post(2, 3) = P_prior(2, 3) - K_2_0*PHt_3_0 - K_2_1*PHt_3_1;
+	P_post(2, 4) = P_prior(2, 4) - K_2_0*PHt_4_0 - K_2_1*PHt_4_1;
+	P_post(2, 5) = P_prior(2, 5) - K_2_0*PHt_5_0 - K_2_1*PHt_5_1;
+	P_post(2, 6) = P_prior(2, 6) - K_2_0*PHt_6_0 - K_2_1*PHt_6_1;
+	P_post(2, 7) = P_prior(2, 7) - K_2_0*PHt_7_0 - K_2_1*PHt_7_1;
+	P_post(2, 8) = P_prior(2, 8) - K_2_0*PHt_8_0 - K_2_1*PHt_8_1;
+	P_post(2, 9) = P_prior(2, 9) - K_2_0*PHt_9_0 - K_2_1*PHt_9_1;
+	P_post(2, 10) = P_prior(2, 10) - K_2_0*PHt_10_0 - K_2_1*PHt_10_1;
+	P_post(2, 11) = P_prior(2, 11) - K_2_0*PHt_11_0 - K_2_1*PHt_11_1;
+	P_post(2, 12) = P_prior(2, 12) - K_2_0*PHt_12_0 - K_2_1*PHt_12_1;
+	P_post(2, 13) = P_prior(2, 13) - K_2_0*PHt_13_0 - K_2_1*PHt_13_1;
+	P_post(2, 14) = P_prior(2, 14) - K_2_0*PHt_14_0 - K_2_1*PHt_14_1;
+	P_post(3, 3) = P_prior(3, 3);
+	P_post(3, 4) = P_prior(3, 4);
+	P_post(3, 5) = P_prior(3, 5) - K_5_0*PHt_3_0 - K_5_1*PHt_3_1;
+	P_post(3, 6) = P_prior(3, 6);
+	P_post(3, 7) = P_prior(3, 7);
+	P_post(3, 8) = P_prior(3, 8);
+	P_post(3, 9) = P_prior(3, 9) - K_9_0*PHt_3_0 - K_9_1*PHt_3_1;
+	P_post(3, 10) = P_prior(3, 10) - K_10_0*PHt_3_0 - K_10_1*PHt_3_1;
+	P_post(3, 11) = P_prior(3, 11) - K_11_0*PHt_3_0 - K_11_1*PHt_3_1;
+	P_post(3, 12) = P_prior(3, 12);
+	P_post(3, 13) = P_prior(3, 13);
+	P_post(3, 14) = P_prior(3, 14);
+	P_post(4, 4) = P_prior(4, 4);
+	P_post(4, 5) = P_prior(4, 5) - K_5_0*PHt_4_0 - K_5_1*PHt_4_1;
+	P_post(4, 6) = P_prior(4, 6);
+	P_post(4, 7) = P_prior(4, 7);
+	P_post(4, 8) = P_prior(4, 8);
+	P_post(4, 9) = P_prior(4, 9) - K_9_0*PHt_4_0 - K_9_1*PHt_4_1;
+	P_post(4, 10) = P_prior(4, 10) - K_10_0*PHt_4_0 - K_10_1*PHt_4_1;
+	P_post(4, 11) = P_prior(4, 11) - K_11_0*PHt_4_0 - K_11_1*PHt_4_1;
+	P_post(4, 12) = P_prior(4, 12);
+	P_post(4, 13) = P_prior(4, 13);
+	P_post(4, 14) = P_prior(4, 14);
+	P_post(5, 5) = P_prior(5, 5) - K_5_0*PHt_5_0 - K_5_1*PHt_5_1;
+	P_post(5, 6) = P_prior(5, 6) - K_5_0*PHt_6_0 - K_5_1*PHt_6_1;
+	P_post(5, 7) = P_prior(5, 7) - K_5_0*PHt_7_0 - K_5_1*PHt_7_1;
+	P_post(5, 8) = P_prior(5, 8) - K_5_0*PHt_8_0 - K_5_1*PHt_8_1;
+	P_post(5, 9) = P_prior(5, 9) - K_5_0*PHt_9_0 - K_5_1*PHt_9_1;
+	P_post(5, 10) = P_prior(5, 10) - K_5_0*PHt_10_0 - K_5_1*PHt_10_1;
+	P_post(5, 11) = P_prior(5, 11) - K_5_0*PHt_11_0 - K_5_1*PHt_11_1;
+	P_post(5, 12) = P_prior(5, 12) - K_5_0*PHt_12_0 - K_5_1*PHt_12_1;
+	P_post(5, 13) = P_prior(5, 13) - K_5_0*PHt_13_0 - K_5_1*PHt_13_1;
+	P_post(5, 14) = P_prior(5, 14) - K_5_0*PHt_14_0 - K_5_1*PHt_14_1;
+	P_post(6, 6) = P_prior(6, 6);
+	P_post(6, 7) = P_prior(6, 7);
+	P_post(6, 8) = P_prior(6, 8);
+	P_post(6, 9) = P_prior(6, 9) - K_9_0*PHt_6_0 - K_9_1*PHt_6_1;
+	P_post(6, 10) = P_prior(6, 10) - K_10_0*PHt_6_0 - K_10_1*PHt_6_1;
+	P_post(6, 11) = P_prior(6, 11) - K_11_0*PHt_6_0 - K_11_1*PHt_6_1;
+	P_post(6, 12) = P_prior(6, 12);
+	P_post(6, 13) = P_prior(6, 13);
+	P_post(6, 14) = P_prior(6, 14);
+	P_post(7, 7) = P_prior(7, 7);
+	P_post(7, 8) = P_prior(7, 8);
+	P_post(7, 9) = P_prior(7, 9) - K_9_0*PHt_7_0 - K_9_1*PHt_7_1;
+	P_post(7, 10) = P_prior(7, 10) - K_10_0*PHt_7_0 - K_10_1*PHt_7_1;
+	P_post(7, 11) = P_prior(7, 11) - K_11_0*PHt_7_0 - K_11_1*PHt_7_1;
+	P_post(7, 12) = P_prior(7, 12);
+	P_post(7, 13) = P_prior(7, 13);
+	P_post(7, 14) = P_prior(7, 14);
+	P_post(8, 8) = P_prior(8, 8);
+	P_post(8, 9) = P_prior(8, 9) - K_9_0*PHt_8_0 - K_9_1*PHt_8_1;
+	P_post(8, 10) = P_prior(8, 10) - K_10_0*PHt_8_0 - K_10_1*PHt_8_1;
+	P_post(8, 11) = P_prior(8, 11) - K_11_0*PHt_8_0 - K_11_1*PHt_8_1;
+	P_post(8, 12) = P_prior(8, 12);
+	P_post(8, 13) = P_prior(8, 13);
+	P_post(8, 14) = P_prior(8, 14);
+	P_post(9, 9) = P_prior(9, 9) - K_9_0*PHt_9_0 - K_9_1*PHt_9_1;
+	P_post(9, 10) = P_prior(9, 10) - K_9_0*PHt_10_0 - K_9_1*PHt_10_1;
+	P_post(9, 11) = P_prior(9, 11) - K_9_0*PHt_11_0 - K_9_1*PHt_11_1;
+	P_post(9, 12) = P_prior(9, 12) - K_9_0*PHt_12_0 - K_9_1*PHt_12_1;
+	P_post(9, 13) = P_prior(9, 13) - K_9_0*PHt_13_0 - K_9_1*PHt_13_1;
+	P_post(9, 14) = P_prior(9, 14) - K_9_0*PHt_14_0 - K_9_1*PHt_14_1;
+	P_post(10, 10) = P_prior(10, 10) - K_10_0*PHt_10_0 - K_10_1*PHt_10_1;
+	P_post(10, 11) = P_prior(10, 11) - K_10_0*PHt_11_0 - K_10_1*PHt_11_1;
+	P_post(10, 12) = P_prior(10, 12) - K_10_0*PHt_12_0 - K_10_1*PHt_12_1;
+	P_post(10, 13) = P_prior(10, 13) - K_10_0*PHt_13_0 - K_10_1*PHt_13_1;
+	P_post(10, 14) = P_prior(10, 14) - K_10_0*PHt_14_0 - K_10_1*PHt_14_1;
+	P_post(11, 11) = P_prior(11, 11) - K_11_0*PHt_11_0 - K_11_1*PHt_11_1;
+	P_post(11, 12) = P_prior(11, 12) - K_11_0*PHt_12_0 - K_11_1*PHt_12_1;
+	P_post(11, 13) = P_prior(11, 13) - K_11_0*PHt_13_0 - K_11_1*PHt_13_1;
+	P_post(11, 14) = P_prior(11, 14) - K_11_0*PHt_14_0 - K_11_1*PHt_14_1;
+	P_post(12, 12) = P_prior(12, 12);
+	P_post(12, 13) = P_prior(12, 13);
+	P_post(12, 14) = P_prior(12, 14);
+	P_post(13, 13) = P_prior(13, 13);
+	P_post(13, 14) = P_prior(13, 14);
+	P_post(14, 14) = P_prior(14, 14);
+}
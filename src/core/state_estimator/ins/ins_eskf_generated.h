@@ -0,0 +1,20 @@
+/* generated by tools/eskf_codegen.py, do not edit */
+
+#ifndef __INS_ESKF_GENERATED_H__
+#define __INS_ESKF_GENERATED_H__
+
+void eskf_ins_covariance_predict(const float *_P_post, float *_P_prior, const float *R,
+                                 const float *accel, const float *gyro, const float *Q_i, float dt);
+void eskf_ins_accelerometer_measurement(const float *q, const float *g, float div_norm, float *h,
+                                        float *H);
+void eskf_ins_magnetometer_measurement(const float *q, float gamma, float mz, float *h, float *H);
+void eskf_ins_accelerometer_covariance_update(const float *_P_prior, float *_P_post, float *delta_x,
+                                              const float *H, const float *resid, const float *V);
+void eskf_ins_magnetometer_covariance_update(const float *_P_prior, float *_P_post, float *delta_x,
+                                             const float *H, const float *resid, const float *V);
+void eskf_ins_gps_covariance_update(const float *_P_prior, float *_P_post, float *delta_x,
+                                    float lag, const float *resid, const float *V);
+void eskf_ins_barometer_covariance_update(const float *_P_prior, float *_P_post, float *delta_x,
+                                          float lag, const float *resid, const float *V);
+
+#endif
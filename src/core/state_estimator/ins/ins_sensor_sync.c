@@ -1,3 +1,4 @@
+#include <stddef.h>
 #include <stdbool.h>
 #include "ins_sensor_sync.h"
 #include "sys_time.h"
@@ -48,7 +49,7 @@ bool ins_barometer_sync_buffer_available(void)
 void ins_barometer_sync_buffer_push(float height, float height_rate)
 {
 	ins_sync_barometer_item_t barometer_item = {
-		.timestamp_s = get_sys_time_s(),
+		.timestamp_us = get_time_us(),
 		.height = height,
 		.height_rate = height_rate
 	};
@@ -60,7 +61,7 @@ void ins_barometer_sync_buffer_push_from_isr(float height, float height_rate,
                 BaseType_t *higher_priority_task_woken)
 {
 	ins_sync_barometer_item_t barometer_item = {
-		.timestamp_s = get_sys_time_s(),
+		.timestamp_us = get_time_us(),
 		.height = height,
 		.height_rate = height_rate
 	};
@@ -68,12 +69,15 @@ void ins_barometer_sync_buffer_push_from_isr(float height, float height_rate,
 	xQueueSendToBackFromISR(ins_sync_barometer_queue, &barometer_item, higher_priority_task_woken);
 }
 
-bool ins_barometer_sync_buffer_pop(float *height, float *height_rate)
+bool ins_barometer_sync_buffer_pop(float *height, float *height_rate, uint64_t *timestamp_us)
 {
 	ins_sync_barometer_item_t recvd_barometer_item;
 	if(xQueueReceive(ins_sync_barometer_queue, &recvd_barometer_item, 0) == pdTRUE) {
 		*height = recvd_barometer_item.height;
 		*height_rate = recvd_barometer_item.height_rate;
+		if(timestamp_us != NULL) {
+			*timestamp_us = recvd_barometer_item.timestamp_us;
+		}
 		return true;
 	} else {
 		return false;
@@ -94,7 +98,7 @@ void ins_gps_sync_buffer_push(float longitude, float latitude, float height_msl,
                               float vx_ned, float vy_ned, float vz_ned)
 {
 	ins_sync_gps_item_t gps_item = {
-		.timestamp_s = get_sys_time_s(),
+		.timestamp_us = get_time_us(),
 		.longitude = longitude,
 		.latitude = latitude,
 		.height_msl = height_msl,
@@ -111,7 +115,7 @@ void ins_gps_sync_buffer_push_from_isr(float longitude, float latitude, float he
                                        BaseType_t *higher_priority_task_woken)
 {
 	ins_sync_gps_item_t gps_item = {
-		.timestamp_s = get_sys_time_s(),
+		.timestamp_us = get_time_us(),
 		.longitude = longitude,
 		.latitude = latitude,
 		.height_msl = height_msl,
@@ -124,7 +128,8 @@ void ins_gps_sync_buffer_push_from_isr(float longitude, float latitude, float he
 }
 
 bool ins_gps_sync_buffer_pop(float *longitude, float *latitude, float *height_msl,
-                             float *vx_ned, float *vy_ned, float *vz_ned)
+                             float *vx_ned, float *vy_ned, float *vz_ned,
+                             uint64_t *timestamp_us)
 {
 	ins_sync_gps_item_t recvd_gps_item;
 	if(xQueueReceive(ins_sync_gps_queue, &recvd_gps_item, 0) == pdTRUE) {
@@ -134,6 +139,9 @@ bool ins_gps_sync_buffer_pop(float *longitude, float *latitude, float *height_ms
 		*vx_ned = recvd_gps_item.vx_ned;
 		*vy_ned = recvd_gps_item.vy_ned;
 		*vz_ned = recvd_gps_item.vz_ned;
+		if(timestamp_us != NULL) {
+			*timestamp_us = recvd_gps_item.timestamp_us;
+		}
 		return true;
 	} else {
 		return false;
@@ -153,7 +161,7 @@ bool ins_compass_sync_buffer_available(void)
 void ins_compass_sync_buffer_push(float *mag)
 {
 	ins_sync_compass_item_t compass_item = {
-		.timestamp_s = get_sys_time_s(),
+		.timestamp_us = get_time_us(),
 		.mag_x = mag[0],
 		.mag_y = mag[1],
 		.mag_z = mag[2]
@@ -165,7 +173,7 @@ void ins_compass_sync_buffer_push(float *mag)
 void ins_compass_sync_buffer_push_from_isr(float *mag, BaseType_t *higher_priority_task_woken)
 {
 	ins_sync_compass_item_t compass_item = {
-		.timestamp_s = get_sys_time_s(),
+		.timestamp_us = get_time_us(),
 		.mag_x = mag[0],
 		.mag_y = mag[1],
 		.mag_z = mag[2]
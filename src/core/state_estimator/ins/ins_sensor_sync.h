@@ -1,19 +1,20 @@
 #ifndef __INS_SENSOR_SYNC_H__
 #define __INS_SENSOR_SYNC_H__
 
+#include <stdint.h>
 #include <stdbool.h>
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
 
 typedef struct {
-	float timestamp_s;
+	uint64_t timestamp_us; //push time
 	float height;
 	float height_rate;
 } ins_sync_barometer_item_t;
 
 typedef struct {
-	float timestamp_s;
+	uint64_t timestamp_us; //push time
 	float longitude;
 	float latitude;
 	float height_msl;
@@ -23,7 +24,7 @@ typedef struct {
 } ins_sync_gps_item_t;
 
 typedef struct {
-	float timestamp_s;
+	uint64_t timestamp_us; //push time
 	float mag_x;
 	float mag_y;
 	float mag_z;
@@ -36,7 +37,7 @@ bool ins_barometer_sync_buffer_available(void);
 void ins_barometer_sync_buffer_push(float height, float height_rate);
 void ins_barometer_sync_buffer_push_from_isr(float height, float height_rate,
                                              BaseType_t *higher_priority_task_woken);
-bool ins_barometer_sync_buffer_pop(float *height, float *height_rate);
+bool ins_barometer_sync_buffer_pop(float *height, float *height_rate, uint64_t *timestamp_us);
 
 bool ins_gps_sync_buffer_available(void);
 void ins_gps_sync_buffer_push(float longitude, float latitude, float height_msl,
@@ -45,7 +46,8 @@ void ins_gps_sync_buffer_push_from_isr(float longitude, float latitude, float he
                                        float vx_ned, float vy_ned, float vz_ned,
                                        BaseType_t *higher_priority_task_woken);
 bool ins_gps_sync_buffer_pop(float *longitude, float *latitude, float *height_msl,
-                             float *vx_ned, float *vy_ned, float *vz_ned);
+                             float *vx_ned, float *vy_ned, float *vz_ned,
+                             uint64_t *timestamp_us);
 
 bool ins_compass_sync_buffer_available(void);
 void ins_compass_sync_buffer_push(float *mag);
@@ -10,7 +10,7 @@ bool free_fall_detect(float *g, float *g_norm)
 
 	*g_norm = accel_norm;
 
-	float threshold = 9.8 * 0.5; //0.1g acceleration
+	float threshold = 9.8f * 0.5f; //0.1g acceleration
 	if(accel_norm <= threshold) return true;
 
 	return false;
@@ -35,6 +35,9 @@
 #include "ins_sensor_sync.h"
 #include "led.h"
 #include "attitude_state.h"
+#include "sensor_log.h"
+#include "flight_log.h"
+#include "position_state.h"
 
 #define FLIGHT_CTL_PRESCALER_RELOAD 10
 
@@ -48,6 +51,10 @@ radio_t rc;
 void flight_ctrl_semaphore_handler(void)
 {
 	static BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	/* latency between the trigger and the flight control task waking up */
+	perf_start(PERF_FLIGHT_CONTROL_WAKEUP);
+
 	xSemaphoreGiveFromISR(flight_ctrl_semphr, &xHigherPriorityTaskWoken);
 	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 }
@@ -56,16 +63,16 @@ void rc_safety_protection(void)
 {
 	radio_t rc;
 
-	float time_last = 0.0f;
-	float time_current = 0.0f;
+	uint64_t time_last = 0;
+	uint64_t time_current = 0;
 
 	led_off(LED_R);
 	led_off(LED_G);
 	led_off(LED_B);
 
 	do {
-		time_current = get_sys_time_ms();
-		if(time_current - time_last > 100.0f) {
+		time_current = get_time_us();
+		if(time_current - time_last > 100000) {
 			led_toggle(LED_R);
 			time_last = time_current;
 		}
@@ -94,6 +101,36 @@ void rc_yaw_setpoint_handler(float *desired_yaw, float rc_yaw_cmd, float dt)
 	}
 }
 
+/* flight data of every loop, the imu and the controller record themselves */
+static void flight_ctrl_log_update(void)
+{
+	if(flight_log_is_running() == false) {
+		return;
+	}
+
+	flight_log_attitude_t attitude;
+	get_attitude_quaternion(attitude.q);
+	flight_log_write(FLIGHT_LOG_ATTITUDE, &attitude, sizeof(attitude));
+
+	flight_log_ins_t ins;
+	get_enu_position(ins.pos_enu);
+	get_enu_velocity(ins.vel_enu);
+	flight_log_write(FLIGHT_LOG_INS, &ins, sizeof(ins));
+
+	flight_log_motor_t motor = {
+		.pulse = {*MOTOR1, *MOTOR2, *MOTOR3, *MOTOR4}
+	};
+	flight_log_write(FLIGHT_LOG_MOTOR, &motor, sizeof(motor));
+
+	flight_log_perf_t perf = {
+		.ahrs_ins = perf_get_last_cycles(PERF_AHRS_INS),
+		.controller = perf_get_last_cycles(PERF_CONTROLLER),
+		.loop = perf_get_last_cycles(PERF_FLIGHT_CONTROL_LOOP),
+		.wakeup = perf_get_last_cycles(PERF_FLIGHT_CONTROL_WAKEUP)
+	};
+	flight_log_write(FLIGHT_LOG_PERF, &perf, sizeof(perf));
+}
+
 void task_flight_ctrl(void *param)
 {
 #if (SELECT_CONTROLLER == QUADROTOR_USE_PID)
@@ -146,6 +183,13 @@ void task_flight_ctrl(void *param)
 	ahrs_init();
 	ins_init();
 
+#if (SELECT_DEBUG_TELEM == TELEM_SENSOR_LOG)
+	/* sensors are calibrated, start recording the raw data */
+	sensor_log_start();
+#elif (SELECT_DEBUG_TELEM == TELEM_FLIGHT_LOG)
+	flight_log_start();
+#endif
+
 	/* from now on, led control task will be taken by rgb_led_service driver */
 	enable_rgb_led_service();
 
@@ -155,6 +199,7 @@ void task_flight_ctrl(void *param)
 	while(1) {
 		perf_start(PERF_FLIGHT_CONTROL_TRIGGER_TIME);
 		while(xSemaphoreTake(flight_ctrl_semphr, 9) == pdFALSE);
+		perf_end(PERF_FLIGHT_CONTROL_WAKEUP);
 
 		gpio_on(EXT_SW);
 		perf_start(PERF_FLIGHT_CONTROL_LOOP);
@@ -173,7 +218,7 @@ void task_flight_ctrl(void *param)
 #endif
 
 		sbus_rc_read(&rc);
-		rc_yaw_setpoint_handler(&desired_yaw, -rc.yaw, 0.0025);
+		rc_yaw_setpoint_handler(&desired_yaw, -rc.yaw, 0.0025f);
 
 		/* attitude estimation */
 		perf_start(PERF_AHRS_INS);
@@ -194,6 +239,9 @@ void task_flight_ctrl(void *param)
 		perf_end(PERF_CONTROLLER);
 
 		perf_end(PERF_FLIGHT_CONTROL_LOOP);
+
+		flight_ctrl_log_update();
+
 		perf_end(PERF_FLIGHT_CONTROL_TRIGGER_TIME);
 		gpio_off(EXT_SW);
 
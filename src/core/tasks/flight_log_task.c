@@ -0,0 +1,34 @@
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "uart.h"
+#include "delay.h"
+#include "flight_log.h"
+#include "flight_log_task.h"
+
+/* the records take ~80KB/s, the uart should be configured with a baudrate of
+ * at least 1000000. the buffer is placed in the sram since the dma can not
+ * access the ccm-ram of the rings */
+#define FLIGHT_LOG_DRAIN_SIZE 1024
+
+void task_flight_log(void *param)
+{
+	static uint8_t buf[FLIGHT_LOG_DRAIN_SIZE];
+
+	while(1) {
+		int size = flight_log_read(buf, FLIGHT_LOG_DRAIN_SIZE);
+
+		if(size > 0) {
+			/* blocked until the dma transfer is finished */
+			uart1_puts((char *)buf, size);
+		} else {
+			freertos_task_delay(2.5);
+		}
+	}
+}
+
+void flight_log_register_task(const char *task_name, configSTACK_DEPTH_TYPE stack_size,
+                              UBaseType_t priority)
+{
+	xTaskCreate(task_flight_log, task_name, stack_size, NULL, priority, NULL);
+}
@@ -0,0 +1,7 @@
+#ifndef __FLIGHT_LOG_TASK_H__
+#define __FLIGHT_LOG_TASK_H__
+
+void flight_log_register_task(const char *task_name, configSTACK_DEPTH_TYPE stack_size,
+                              UBaseType_t priority);
+
+#endif
@@ -12,8 +12,10 @@
 #include "delay.h"
 #include "uart.h"
 #include "autopilot.h"
+#include "task_stats.h"
 
 #define MAVLINK_QUEUE_SIZE 10
+#define MAVLINK_RX_READ_SIZE 64
 
 typedef struct {
 	mavlink_message_t mav_msg;
@@ -65,6 +67,10 @@ void mavlink_tx_task(void *param)
 			send_mavlink_heartbeat();
 			send_mavlink_system_status();
 
+			/* cpu load of the last second */
+			task_stats_update();
+			send_mavlink_task_stats();
+
 			prescaler_div_50 = 0;
 		}
 		prescaler_div_50++;
@@ -74,6 +80,8 @@ void mavlink_tx_task(void *param)
 #if (SELECT_POSITION_SENSOR == POSITION_FUSION_USE_GPS)
 			send_mavlink_gps();
 #endif
+			send_mavlink_perf_histogram();
+
 			prescaler_div_10 = 0;
 		}
 		prescaler_div_10++;
@@ -113,24 +121,27 @@ void mavlink_tx_task(void *param)
 
 void mavlink_rx_task(void *param)
 {
-	char c;
+	uint8_t rx_buf[MAVLINK_RX_READ_SIZE];
+	int rx_cnt, i;
 
 	while(1) {
 		mavlink_status_t mavlink_recpt_status;
 
-		/* receive mavlink message */
-		if(uart3_getc(&c, portMAX_DELAY) == true) {
+		/* receive mavlink message, blocked until the dma ring is not empty */
+		rx_cnt = uart3_read(rx_buf, MAVLINK_RX_READ_SIZE, portMAX_DELAY);
+
+		for(i = 0; i < rx_cnt; i++) {
 			received_mavlink_msg =
-			        mavlink_parse_char(MAVLINK_COMM_1, (uint8_t)c, &mavlink_recpt_msg, &mavlink_recpt_status);
-		}
+			        mavlink_parse_char(MAVLINK_COMM_1, rx_buf[i], &mavlink_recpt_msg, &mavlink_recpt_status);
 
-		/* save received mavlink to queue */
-		if(received_mavlink_msg == 1) {
-			mavlink_queue_item_t mavlink_queue_item;
-			mavlink_queue_item.mav_msg = mavlink_recpt_msg;
+			/* save received mavlink to queue */
+			if(received_mavlink_msg == 1) {
+				mavlink_queue_item_t mavlink_queue_item;
+				mavlink_queue_item.mav_msg = mavlink_recpt_msg;
 
-			while(xQueueSendToBack(mavlink_queue,
-			                       &mavlink_queue_item, portMAX_DELAY) != pdTRUE);
+				while(xQueueSendToBack(mavlink_queue,
+				                       &mavlink_queue_item, portMAX_DELAY) != pdTRUE);
+			}
 		}
 	}
 }
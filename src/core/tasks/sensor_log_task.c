@@ -0,0 +1,32 @@
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "uart.h"
+#include "delay.h"
+#include "sensor_log.h"
+#include "sensor_log_task.h"
+
+/* 1KHz imu records take ~22KB/s, the uart should be configured with a baudrate
+ * of at least 460800 */
+#define SENSOR_LOG_DRAIN_SIZE 512
+
+void task_sensor_log(void *param)
+{
+	static uint8_t buf[SENSOR_LOG_DRAIN_SIZE];
+
+	while(1) {
+		int size = sensor_log_read(buf, SENSOR_LOG_DRAIN_SIZE);
+
+		if(size > 0) {
+			uart1_puts((char *)buf, size);
+		} else {
+			freertos_task_delay(2.5);
+		}
+	}
+}
+
+void sensor_log_register_task(const char *task_name, configSTACK_DEPTH_TYPE stack_size,
+                              UBaseType_t priority)
+{
+	xTaskCreate(task_sensor_log, task_name, stack_size, NULL, priority, NULL);
+}
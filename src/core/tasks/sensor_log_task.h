@@ -0,0 +1,7 @@
+#ifndef __SENSOR_LOG_TASK_H__
+#define __SENSOR_LOG_TASK_H__
+
+void sensor_log_register_task(const char *task_name, configSTACK_DEPTH_TYPE stack_size,
+                              UBaseType_t priority);
+
+#endif
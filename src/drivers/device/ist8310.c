@@ -2,13 +2,18 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
+#include "proj_config.h"
 #include "sw_i2c.h"
+#include "i2c.h"
 #include "delay.h"
 #include "ist8310.h"
 #include "sys_time.h"
 #include "gpio.h"
 #include "lpf.h"
 #include "ins_sensor_sync.h"
+#include "sensor_log.h"
+
+#define IST8310_I2C_TIMEOUT_MS 10
 
 SemaphoreHandle_t ist8310_semphr;
 
@@ -29,13 +34,85 @@ float ist8310_lpf_gain;
 bool ist8310_available(void)
 {
 	//timeout if no data available more than 300ms
-	float current_time = get_sys_time_ms();
-	if((current_time - ist8310.last_read_time) > 300) {
+	if((get_time_us() - ist8310.last_read_time) > 300000) {
+		return false;
+	}
+	return true;
+}
+
+#if (SELECT_COMPASS_I2C == COMPASS_HW_I2C)
+
+SemaphoreHandle_t ist8310_i2c_semphr;
+i2c_transaction_t ist8310_i2c_transaction;
+
+static void ist8310_i2c_callback(i2c_transaction_t *transaction,
+                                 BaseType_t *higher_priority_task_woken)
+{
+	xSemaphoreGiveFromISR(ist8310_i2c_semphr, higher_priority_task_woken);
+}
+
+/* submit the transaction to i2c2 and sleep until it is completed by the
+ * interrupt, the bus is free for other devices in the meantime */
+static bool ist8310_i2c_transfer(uint8_t addr, uint8_t *data, int size, bool read)
+{
+	/* the transaction of the last timeout is still in the queue */
+	if(ist8310_i2c_transaction.busy == true) {
+		ist8310.i2c_error_cnt++;
+		return false;
+	}
+
+	ist8310_i2c_transaction.addr = IST8310_ADDR;
+	ist8310_i2c_transaction.reg = addr;
+	ist8310_i2c_transaction.data = data;
+	ist8310_i2c_transaction.size = size;
+	ist8310_i2c_transaction.read = read;
+	ist8310_i2c_transaction.callback = ist8310_i2c_callback;
+
+	if(i2c2_transaction_submit(&ist8310_i2c_transaction) == false) {
+		ist8310.i2c_error_cnt++;
 		return false;
 	}
+
+	if(xSemaphoreTake(ist8310_i2c_semphr, pdMS_TO_TICKS(IST8310_I2C_TIMEOUT_MS)) == pdFALSE ||
+	    ist8310_i2c_transaction.error == true) {
+		ist8310.i2c_error_cnt++;
+		return false;
+	}
+
 	return true;
 }
 
+uint8_t ist8310_read_byte(uint8_t addr)
+{
+	uint8_t data = 0;
+	ist8310_i2c_transfer(addr, &data, 1, true);
+	return data;
+}
+
+void ist8310_write_byte(uint8_t addr, uint8_t data)
+{
+	ist8310_i2c_transfer(addr, &data, 1, false);
+}
+
+/* the transactions only block the calling task, the blocked interface of the
+ * software i2c is mapped to them */
+uint8_t ist8310_blocked_read_byte(uint8_t addr)
+{
+	return ist8310_read_byte(addr);
+}
+
+void ist8310_blocked_write_byte(uint8_t addr, uint8_t data)
+{
+	ist8310_write_byte(addr, data);
+}
+
+bool ist8310_read_bytes(uint8_t addr, uint8_t *data, int size)
+{
+	return ist8310_i2c_transfer(addr, data, size, true);
+}
+
+#else
+
 uint8_t ist8310_read_byte(uint8_t addr)
 {
 	uint8_t data;
@@ -98,7 +175,7 @@ void ist8310_blocked_write_byte(uint8_t addr, uint8_t data)
 	sw_i2c_blocked_stop();
 }
 
-void ist8310_read_bytes(uint8_t addr, uint8_t *data, int size)
+bool ist8310_read_bytes(uint8_t addr, uint8_t *data, int size)
 {
 	sw_i2c_start();
 	sw_i2c_send_byte((IST8310_ADDR << 1) | 0);
@@ -119,8 +196,13 @@ void ist8310_read_bytes(uint8_t addr, uint8_t *data, int size)
 		}
 	}
 	sw_i2c_stop();
+
+	/* the acknowledgements are not checked by the software i2c */
+	return true;
 }
 
+#endif
+
 static uint8_t ist8310_read_who_i_am(void)
 {
 	uint8_t id = ist8310_blocked_read_byte(IST8310_REG_WIA);
@@ -134,6 +216,14 @@ void ist8310_reset(void)
 	blocked_delay_ms(100);
 }
 
+void ist8310_filter_init(void)
+{
+	ist8310.last_update_time = get_sys_time_s();
+
+	//sampling time = 0.02s (50Hz), cutoff frequency = 20Hz
+	lpf_first_order_init(&ist8310_lpf_gain, 0.02, 5);
+}
+
 void ist8130_init(void)
 {
 	while(ist8310_read_who_i_am() != IST8310_CHIP_ID);
@@ -146,10 +236,7 @@ void ist8130_init(void)
 	ist8310_blocked_write_byte(IST8310_REG_PDCTL, IST8310_PD_NORMAL);
 	blocked_delay_ms(100);
 
-	ist8310.last_update_time = get_sys_time_s();
-
-	//sampling time = 0.02s (50Hz), cutoff frequency = 20Hz
-	lpf_first_order_init(&ist8310_lpf_gain, 0.02, 5);
+	ist8310_filter_init();
 }
 
 void ist8310_wait_until_stable(void)
@@ -185,24 +272,12 @@ void ist8310_undistortion(float *mag)
 	mag[2] *= ist8310.div_squared_semi_axis_size_z;
 }
 
-void ist8310_read_sensor(void)
+/* process one sample of the unscaled sensor readings */
+void ist8310_sample_update(int16_t *mag_unscaled)
 {
-	/* check "IST8310 User Manual v1.5" for details */
-
-	//sigle measurement mode
-	ist8310_blocked_write_byte(IST8310_REG_CTRL1, IST8310_ODR_SINGLE);
-
-	//wait 6ms for 16x average
-	freertos_task_delay(15);
-
-	/* read sensor datas */
-	uint8_t buf[6];
-	ist8310_read_bytes(IST8310_REG_DATA, buf, 6);
-
-	/* composite unscaled data */
-	ist8310.mag_unscaled[0] = (((int16_t)buf[3]) << 8 | buf[2]);
-	ist8310.mag_unscaled[1] = (((int16_t)buf[1]) << 8 | buf[0]);
-	ist8310.mag_unscaled[2] = (((int16_t)buf[5]) << 8 | buf[4]);
+	ist8310.mag_unscaled[0] = mag_unscaled[0];
+	ist8310.mag_unscaled[1] = mag_unscaled[1];
+	ist8310.mag_unscaled[2] = mag_unscaled[2];
 
 	/* convert unscaled data to raw data (NED frame) */
 	ist8310.mag_raw[0] = ist8310.mag_unscaled[0] * IST8310_RESOLUTION * 0.01;
@@ -223,10 +298,37 @@ void ist8310_read_sensor(void)
 	/* update timer only if data is valid */
 	if(ist8310.mag_raw[0] != 0 || ist8310.mag_raw[1] != 0 || ist8310.mag_raw[2] != 0) {
 		ins_compass_sync_buffer_push(ist8310.mag_lpf);
-		ist8310.last_read_time = get_sys_time_ms();
+		ist8310.last_read_time = get_time_us();
 	}
 }
 
+void ist8310_read_sensor(void)
+{
+	/* check "IST8310 User Manual v1.5" for details */
+
+	//sigle measurement mode
+	ist8310_blocked_write_byte(IST8310_REG_CTRL1, IST8310_ODR_SINGLE);
+
+	//wait 6ms for 16x average
+	freertos_task_delay(15);
+
+	/* read sensor datas */
+	uint8_t buf[6];
+	if(ist8310_read_bytes(IST8310_REG_DATA, buf, 6) == false) {
+		return;
+	}
+
+	/* composite unscaled data */
+	sensor_log_compass_t compass;
+	compass.mag[0] = (((int16_t)buf[3]) << 8 | buf[2]);
+	compass.mag[1] = (((int16_t)buf[1]) << 8 | buf[0]);
+	compass.mag[2] = (((int16_t)buf[5]) << 8 | buf[4]);
+
+	sensor_log_write(SENSOR_LOG_COMPASS, &compass, sizeof(compass));
+
+	ist8310_sample_update(compass.mag);
+}
+
 void ist8310_get_mag_raw(float *mag_raw)
 {
 	mag_raw[0] = ist8310.mag_raw[0];
@@ -295,5 +397,8 @@ void ist8310_register_task(const char *task_name, configSTACK_DEPTH_TYPE stack_s
                            UBaseType_t priority)
 {
 	ist8310_semphr = xSemaphoreCreateBinary();
+#if (SELECT_COMPASS_I2C == COMPASS_HW_I2C)
+	ist8310_i2c_semphr = xSemaphoreCreateBinary();
+#endif
 	xTaskCreate(ist8310_driver_task, task_name, stack_size, NULL, priority, NULL);
 }
@@ -55,10 +55,14 @@ typedef struct {
 	float div_squared_semi_axis_size_y;
 	float div_squared_semi_axis_size_z;
 
-	float last_read_time;
+	uint64_t last_read_time; //[us]
+
+	uint32_t i2c_error_cnt; //nack or timeout of the hardware i2c transactions
 } ist8310_t;
 
 void ist8130_init(void);
+void ist8310_filter_init(void);
+void ist8310_sample_update(int16_t *mag_unscaled);
 void ist8310_wait_until_stable(void);
 bool ist8310_available(void);
 void ist8310_register_task(const char *task_name, configSTACK_DEPTH_TYPE stack_size,
@@ -12,6 +12,10 @@
 #include "sys_param.h"
 #include "common_list.h"
 #include "led.h"
+#include "sensor_log.h"
+#include "flight_log.h"
+#include "sys_time.h"
+#include "proj_config.h"
 
 #define IMU_CALIB_SAMPLE_CNT 1000
 
@@ -21,6 +25,9 @@ mpu6500_t mpu6500 = {
 	.accel_fs = MPU6500_GYRO_FS_8G,
 	.gyro_fs = MPU6500_GYRO_FS_1000_DPS,
 	.init_finished = false,
+	.mode = SELECT_IMU_MODE,
+	.burst_read_busy = false,
+	.fifo_enabled = false,
 };
 
 /* first order lpf */
@@ -29,6 +36,18 @@ float mpu6500_lpf_gain;
 /* second order lpf */
 lpf2_t mpu6500_lpf2;
 
+/* spi1 dma buffers of the burst read (accelerometer, temperature and gyroscope),
+ * the first byte is for the register address */
+static uint8_t mpu6500_burst_tx_buf[MPU6500_BURST_READ_SIZE] = {
+	MPU6500_ACCEL_XOUT_H | 0x80,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+static uint8_t mpu6500_burst_rx_buf[MPU6500_BURST_READ_SIZE];
+
+/* spi1 dma buffers of the fifo count and fifo data reads */
+static uint8_t mpu6500_fifo_tx_buf[MPU6500_FIFO_READ_SIZE];
+static uint8_t mpu6500_fifo_rx_buf[MPU6500_FIFO_READ_SIZE];
 
 static uint8_t mpu6500_read_byte(uint8_t address)
 {
@@ -94,6 +113,30 @@ bool mpu6500_calibration_not_finished(void)
 
 }
 
+void mpu6500_filter_init(void)
+{
+	//sampling time = 0.001s (1KHz), cutoff frequency = 25Hz
+	lpf_first_order_init(&mpu6500_lpf_gain, 0.001, 25);
+
+	lpf_second_order_init(&mpu6500_lpf2, 1000.0f, 40.0f);
+
+	//anti-aliasing filter of the fifo mode, 8KHz -> 1KHz
+	fir_decimator_init(&mpu6500.fifo_fir, 6, MPU6500_FIFO_FIR_TAPS, MPU6500_FIFO_DECIMATION,
+	                   MPU6500_FIFO_SAMPLE_RATE, MPU6500_FIFO_FIR_CUTOFF);
+}
+
+/* select the acquisition mode (IMU_DATA_READY or IMU_FIFO), must be called
+ * before mpu6500_init() */
+void mpu6500_set_mode(int mode)
+{
+	mpu6500.mode = mode;
+}
+
+static void mpu6500_fifo_reset(void)
+{
+	mpu6500_write_byte(MPU6500_USER_CTRL, USER_CTRL_FIFO_EN | USER_CTRL_FIFO_RST);
+}
+
 void mpu6500_init(void)
 {
 	while((mpu6500_read_who_am_i() != 0x70));
@@ -165,22 +208,38 @@ void mpu6500_init(void)
 	}
 	blocked_delay_ms(100);
 
-	//gyroscope update rate = 1KHz, low pass filter bandwitdh = 20Hz
-	mpu6500_write_byte(MPU6500_CONFIG, GYRO_DLPF_BANDWIDTH_20Hz);
-	blocked_delay_ms(100);
+	mpu6500_filter_init();
 
-	//acceleromter update rate = 1KHz, low pass filter bandwitdh = 20Hz
-	mpu6500_write_byte(MPU6500_ACCEL_CONFIG2, ACCEL_DLPF_BANDWIDTH_20Hz);
-	blocked_delay_ms(100);
+	if(mpu6500.mode == IMU_FIFO) {
+		//gyroscope update rate = 8KHz, low pass filter bandwitdh = 250Hz
+		mpu6500_write_byte(MPU6500_CONFIG, FIFO_MODE_NO_OVERWRITE | GYRO_DLPF_BANDWIDTH_250Hz);
+		blocked_delay_ms(100);
 
-	//enable data ready interrupt
-	mpu6500_write_byte(MPU6500_INT_ENABLE, 0x01);
-	blocked_delay_ms(100);
+		//acceleromter update rate = 4KHz, low pass filter bandwitdh = 1.13KHz
+		mpu6500_write_byte(MPU6500_ACCEL_CONFIG2, ACCEL_DLPF_DISABLE);
+		blocked_delay_ms(100);
 
-	//sampling time = 0.001s (1KHz), cutoff frequency = 25Hz
-	lpf_first_order_init(&mpu6500_lpf_gain, 0.001, 25);
+		//write accelerometer, temperature and gyroscope into the fifo, the
+		//fifo is drained by mpu6500_fifo_drain_handler() with 1KHz
+		mpu6500_write_byte(MPU6500_FIFO_EN, FIFO_EN_TEMP_GYRO_ACCEL);
+		blocked_delay_ms(100);
 
-	lpf_second_order_init(&mpu6500_lpf2, 1000.0f, 40.0f);
+		//start with an empty fifo (4.5ms until it is full)
+		mpu6500_fifo_reset();
+		mpu6500.fifo_enabled = true;
+	} else {
+		//gyroscope update rate = 1KHz, low pass filter bandwitdh = 20Hz
+		mpu6500_write_byte(MPU6500_CONFIG, GYRO_DLPF_BANDWIDTH_20Hz);
+		blocked_delay_ms(100);
+
+		//acceleromter update rate = 1KHz, low pass filter bandwitdh = 20Hz
+		mpu6500_write_byte(MPU6500_ACCEL_CONFIG2, ACCEL_DLPF_BANDWIDTH_20Hz);
+		blocked_delay_ms(100);
+
+		//enable data ready interrupt
+		mpu6500_write_byte(MPU6500_INT_ENABLE, 0x01);
+		blocked_delay_ms(100);
+	}
 
 	while(mpu6500.init_finished == false);
 }
@@ -239,37 +298,18 @@ void mpu6500_temp_convert_to_scale(int16_t *temp_unscaled, float *temp_scaled)
 	*temp_scaled = *temp_unscaled * MPU6500T_85degC + 21.0f;
 }
 
-void mpu6500_int_handler(void)
+/* process one sample of the unscaled sensor readings (body frame), time_us is
+ * the sampling time of the sensor */
+void mpu6500_sample_update(int16_t *accel_unscaled, int16_t *gyro_unscaled, int16_t temp_unscaled,
+                           uint64_t time_us)
 {
-	uint8_t buffer[14];
-
-	/* read sensor datas via spi */
-	mpu6500_chip_select();
-	spi_read_write(SPI1, MPU6500_ACCEL_XOUT_H | 0x80);
-	buffer[0] = spi_read_write(SPI1, 0xff);
-	buffer[1] = spi_read_write(SPI1, 0xff);
-	buffer[2] = spi_read_write(SPI1, 0xff);
-	buffer[3] = spi_read_write(SPI1, 0xff);
-	buffer[4] = spi_read_write(SPI1, 0xff);
-	buffer[5] = spi_read_write(SPI1, 0xff);
-	buffer[6] = spi_read_write(SPI1, 0xff);
-	buffer[7] = spi_read_write(SPI1, 0xff);
-	buffer[8] = spi_read_write(SPI1, 0xff);
-	buffer[9] = spi_read_write(SPI1, 0xff);
-	buffer[10] = spi_read_write(SPI1, 0xff);
-	buffer[11] = spi_read_write(SPI1, 0xff);
-	buffer[12] = spi_read_write(SPI1, 0xff);
-	buffer[13] = spi_read_write(SPI1, 0xff);
-
-	/* composite sensor data */
-	mpu6500.accel_unscaled[0] = -(((int16_t)buffer[0] << 8) | (int16_t)buffer[1]);
-	mpu6500.accel_unscaled[1] = -(((int16_t)buffer[2] << 8) | (int16_t)buffer[3]);
-	mpu6500.accel_unscaled[2] = +((int16_t)buffer[4] << 8) | (int16_t)buffer[5];
-	mpu6500.temp_unscaled = ((int16_t)buffer[6] << 8) | (int16_t)buffer[7];
-	mpu6500.gyro_unscaled[0] = -(((int16_t)buffer[8] << 8) | (int16_t)buffer[9]);
-	mpu6500.gyro_unscaled[1] = -(((int16_t)buffer[10] << 8) | (int16_t)buffer[11]);
-	mpu6500.gyro_unscaled[2] = +((int16_t)buffer[12] << 8) | (int16_t)buffer[13];
-	mpu6500_chip_deselect();
+	mpu6500.accel_unscaled[0] = accel_unscaled[0];
+	mpu6500.accel_unscaled[1] = accel_unscaled[1];
+	mpu6500.accel_unscaled[2] = accel_unscaled[2];
+	mpu6500.gyro_unscaled[0] = gyro_unscaled[0];
+	mpu6500.gyro_unscaled[1] = gyro_unscaled[1];
+	mpu6500.gyro_unscaled[2] = gyro_unscaled[2];
+	mpu6500.temp_unscaled = temp_unscaled;
 
 	if(mpu6500.init_finished == false) {
 		mpu6500_bias_calc(mpu6500.gyro_unscaled, mpu6500.accel_unscaled);
@@ -298,6 +338,175 @@ void mpu6500_int_handler(void)
 	mpu6500.gyro_lpf[0] = mpu6500.gyro_raw[0];
 	mpu6500.gyro_lpf[1] = mpu6500.gyro_raw[1];
 	mpu6500.gyro_lpf[2] = mpu6500.gyro_raw[2];
+
+	imu_sample_push(mpu6500.accel_raw, mpu6500.gyro_raw, time_us);
+}
+
+/* composite sensor data of the burst read and the fifo frame */
+static void mpu6500_decode(uint8_t *buffer, sensor_log_imu_t *imu)
+{
+	imu->accel[0] = -(((int16_t)buffer[0] << 8) | (int16_t)buffer[1]);
+	imu->accel[1] = -(((int16_t)buffer[2] << 8) | (int16_t)buffer[3]);
+	imu->accel[2] = +((int16_t)buffer[4] << 8) | (int16_t)buffer[5];
+	imu->temp = ((int16_t)buffer[6] << 8) | (int16_t)buffer[7];
+	imu->gyro[0] = -(((int16_t)buffer[8] << 8) | (int16_t)buffer[9]);
+	imu->gyro[1] = -(((int16_t)buffer[10] << 8) | (int16_t)buffer[11]);
+	imu->gyro[2] = +((int16_t)buffer[12] << 8) | (int16_t)buffer[13];
+}
+
+static void mpu6500_publish(sensor_log_imu_t *imu, uint64_t time_us)
+{
+	sensor_log_write(SENSOR_LOG_IMU, imu, sizeof(sensor_log_imu_t));
+
+	mpu6500_sample_update(imu->accel, imu->gyro, imu->temp, time_us);
+
+	if(mpu6500.init_finished == true && flight_log_is_running() == true) {
+		flight_log_imu_t imu_log = {
+			.accel = {mpu6500.accel_raw[0], mpu6500.accel_raw[1], mpu6500.accel_raw[2]},
+			.gyro = {mpu6500.gyro_raw[0], mpu6500.gyro_raw[1], mpu6500.gyro_raw[2]}
+		};
+		flight_log_write_from_isr(FLIGHT_LOG_IMU, &imu_log, sizeof(imu_log));
+	}
+}
+
+/* parse the frames read from the fifo (oldest first) and decimate them with
+ * the anti-aliasing filter, time_us is the sampling time of the last frame */
+void mpu6500_fifo_parse(uint8_t *buffer, int frames, uint64_t time_us)
+{
+	uint64_t delay_us = (uint64_t)lrintf(fir_decimator_get_delay(&mpu6500.fifo_fir) * 1e6f);
+
+	int i;
+	for(i = 0; i < frames; i++) {
+		sensor_log_imu_t imu;
+		mpu6500_decode(&buffer[i * MPU6500_FIFO_FRAME_SIZE], &imu);
+
+		float input[6] = {
+			imu.accel[0], imu.accel[1], imu.accel[2],
+			imu.gyro[0], imu.gyro[1], imu.gyro[2]
+		};
+		float output[6];
+
+		if(fir_decimator_update(&mpu6500.fifo_fir, input, output) == false) {
+			continue;
+		}
+
+		imu.accel[0] = (int16_t)lrintf(output[0]);
+		imu.accel[1] = (int16_t)lrintf(output[1]);
+		imu.accel[2] = (int16_t)lrintf(output[2]);
+		imu.gyro[0] = (int16_t)lrintf(output[3]);
+		imu.gyro[1] = (int16_t)lrintf(output[4]);
+		imu.gyro[2] = (int16_t)lrintf(output[5]);
+
+		uint64_t frame_time_us = time_us - (uint64_t)(frames - 1 - i) * MPU6500_FIFO_FRAME_PERIOD_US;
+		mpu6500_publish(&imu, frame_time_us - delay_us);
+	}
+}
+
+/* data ready interrupt, only starts the burst read of the sensor data with spi1
+ * dma. the data is processed by mpu6500_burst_read_handler() after the transfer */
+void mpu6500_int_handler(void)
+{
+	/* the last burst read is not finished yet, drop the sample */
+	if(mpu6500.burst_read_busy == true) {
+		mpu6500.burst_read_drop_cnt++;
+		return;
+	}
+
+	mpu6500.burst_read_busy = true;
+	mpu6500.burst_read_state = MPU6500_BURST_READ_SAMPLE;
+
+	mpu6500_chip_select();
+	spi1_dma_read_write(mpu6500_burst_tx_buf, mpu6500_burst_rx_buf, MPU6500_BURST_READ_SIZE);
+}
+
+/* fifo mode (1KHz, timer5), starts reading the fifo count with spi1 dma. the
+ * fifo data is read after the count by mpu6500_burst_read_handler() */
+void mpu6500_fifo_drain_handler(void)
+{
+	/* data ready mode or the spi1 is still used by mpu6500_init() */
+	if(mpu6500.fifo_enabled == false) {
+		return;
+	}
+
+	/* the last drain is not finished yet */
+	if(mpu6500.burst_read_busy == true) {
+		mpu6500.burst_read_drop_cnt++;
+		return;
+	}
+
+	mpu6500.burst_read_busy = true;
+	mpu6500.burst_read_state = MPU6500_BURST_READ_FIFO_COUNT;
+
+	mpu6500_fifo_tx_buf[0] = MPU6500_FIFO_COUNTH | 0x80;
+	mpu6500_fifo_tx_buf[1] = 0xff;
+	mpu6500_fifo_tx_buf[2] = 0xff;
+
+	mpu6500_chip_select();
+	spi1_dma_read_write(mpu6500_fifo_tx_buf, mpu6500_fifo_rx_buf, 3);
+}
+
+static void mpu6500_fifo_count_handler(void)
+{
+	int count = ((int)(mpu6500_fifo_rx_buf[1] & 0x1f) << 8) | (int)mpu6500_fifo_rx_buf[2];
+
+	/* the fifo stops receiving new frames once it is full, samples are lost */
+	if(count >= MPU6500_FIFO_SIZE) {
+		mpu6500.fifo_overflow_cnt++;
+		mpu6500_fifo_reset();
+		mpu6500.burst_read_busy = false;
+		return;
+	}
+
+	int frames = count / MPU6500_FIFO_FRAME_SIZE;
+	if(frames > MPU6500_FIFO_READ_FRAMES) {
+		frames = MPU6500_FIFO_READ_FRAMES;
+	}
+
+	if(frames == 0) {
+		mpu6500.burst_read_busy = false;
+		return;
+	}
+
+	mpu6500.fifo_frames = frames;
+	mpu6500.burst_read_state = MPU6500_BURST_READ_FIFO_DATA;
+
+	/* fifo_r_w does not increase the register address on burst read */
+	int size = 1 + frames * MPU6500_FIFO_FRAME_SIZE;
+	mpu6500_fifo_tx_buf[0] = MPU6500_FIFO_R_W | 0x80;
+	memset(&mpu6500_fifo_tx_buf[1], 0xff, size - 1);
+
+	mpu6500_chip_select();
+	spi1_dma_read_write(mpu6500_fifo_tx_buf, mpu6500_fifo_rx_buf, size);
+}
+
+/* spi1 dma completion interrupt of the burst read */
+void mpu6500_burst_read_handler(void)
+{
+	/* spurious completion */
+	if(mpu6500.burst_read_busy == false) {
+		return;
+	}
+
+	mpu6500_chip_deselect();
+
+	switch(mpu6500.burst_read_state) {
+	case MPU6500_BURST_READ_SAMPLE: {
+		sensor_log_imu_t imu;
+		mpu6500_decode(&mpu6500_burst_rx_buf[1], &imu);
+		mpu6500_publish(&imu, get_time_us());
+		break;
+	}
+	case MPU6500_BURST_READ_FIFO_COUNT:
+		/* continue with the fifo data */
+		mpu6500_fifo_count_handler();
+		return;
+	case MPU6500_BURST_READ_FIFO_DATA:
+		mpu6500_fifo_parse(&mpu6500_fifo_rx_buf[1], mpu6500.fifo_frames, get_time_us());
+		break;
+	}
+
+	/* the buffers can be reused by the next burst read */
+	mpu6500.burst_read_busy = false;
 }
 
 void mpu6500_set_scale_factor(float x_scale, float y_scale, float z_scale)
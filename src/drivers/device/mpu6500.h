@@ -6,6 +6,7 @@
 #include "stm32f4xx_conf.h"
 #include "spi.h"
 #include "imu.h"
+#include "fir_decimator.h"
 
 #define mpu6500_chip_select() GPIO_ResetBits(GPIOA, GPIO_Pin_4)
 #define mpu6500_chip_deselect() GPIO_SetBits(GPIOA, GPIO_Pin_4)
@@ -50,10 +51,36 @@
 
 #define MPU6500T_85degC 0.00294f
 
+#define MPU6500_BURST_READ_SIZE 15 //register address + accel (6) + temp (2) + gyro (6)
+
+/* fifo mode: every frame has the same layout as the burst read, the
+ * accelerometer (4kHz) is repeated in the frames of the gyroscope (8kHz) */
+#define MPU6500_FIFO_SIZE        512
+#define MPU6500_FIFO_FRAME_SIZE  14
+#define MPU6500_FIFO_READ_FRAMES 36 //(512 / 14) frames, 4.5ms of the fifo
+#define MPU6500_FIFO_READ_SIZE   (1 + MPU6500_FIFO_READ_FRAMES * MPU6500_FIFO_FRAME_SIZE)
+#define MPU6500_FIFO_SAMPLE_RATE 8000.0f //[Hz]
+#define MPU6500_FIFO_FRAME_PERIOD_US 125 //[us], 1 / MPU6500_FIFO_SAMPLE_RATE
+#define MPU6500_FIFO_DECIMATION  8       //8kHz -> 1kHz
+#define MPU6500_FIFO_FIR_TAPS    24
+#define MPU6500_FIFO_FIR_CUTOFF  350.0f  //[Hz]
+
+#define FIFO_MODE_NO_OVERWRITE     0x40
+#define FIFO_EN_TEMP_GYRO_ACCEL    0xf8
+#define USER_CTRL_FIFO_EN          0x40
+#define USER_CTRL_FIFO_RST         0x04
+
+#define GYRO_DLPF_BANDWIDTH_250Hz 0x00 //8kHz sampling rate
 #define GYRO_DLPF_BANDWIDTH_20Hz  0x04
 
 #define ACCEL_DLPF_BANDWIDTH_20Hz 0x04
-#define ACCEL_DLPF_DISABLE        0x08
+#define ACCEL_DLPF_DISABLE        0x08 //1.13kHz bandwidth, 4kHz sampling rate
+
+enum {
+	MPU6500_BURST_READ_SAMPLE,     //data ready mode
+	MPU6500_BURST_READ_FIFO_COUNT, //fifo mode
+	MPU6500_BURST_READ_FIFO_DATA
+} MPU6500_BURST_READ_STATE;
 
 enum {
 	MPU6500_GYRO_FS_2G = 0,
@@ -81,6 +108,20 @@ typedef struct {
 	float gyro_scale;
 	volatile bool init_finished;
 
+	/* acquisition mode, see SELECT_IMU_MODE of proj_config.h */
+	int mode;
+
+	/* spi1 dma burst read */
+	volatile bool burst_read_busy;
+	int burst_read_state;
+	uint32_t burst_read_drop_cnt;
+
+	/* fifo mode */
+	volatile bool fifo_enabled; //drained by the timer after the configuration
+	int fifo_frames;
+	uint32_t fifo_overflow_cnt;
+	fir_decimator_t fifo_fir;
+
 	/* sensor datas */
         int16_t accel_unscaled[3];
         int16_t gyro_unscaled[3];
@@ -101,7 +142,14 @@ typedef struct {
 } mpu6500_t;
 
 void mpu6500_init(void);
+void mpu6500_filter_init(void);
 void mpu6500_int_handler(void);
+void mpu6500_fifo_drain_handler(void);
+void mpu6500_burst_read_handler(void);
+void mpu6500_set_mode(int mode);
+void mpu6500_fifo_parse(uint8_t *buffer, int frames, uint64_t time_us);
+void mpu6500_sample_update(int16_t *accel_unscaled, int16_t *gyro_unscaled, int16_t temp_unscaled,
+                           uint64_t time_us);
 bool mpu6500_calibration_not_finished(void);
 
 void mpu6500_reset_scale_factor(void);
@@ -9,9 +9,9 @@
 #include "debug_link.h"
 #include "lpf.h"
 #include "ins_sensor_sync.h"
-#include "coroutine.h"
 #include "sys_time.h"
 #include "barometer.h"
+#include "sensor_log.h"
 #include "ins_sensor_sync.h"
 
 #define POW2(x) ((x) * (x))
@@ -19,8 +19,13 @@
 
 #define MS5611_UPDATE_FREQ (50)
 
+#define MS5611_ADC_READ 0x00
+
 ms5611_t ms5611;
 
+static void ms5611_adc_read_callback(spi_transaction_t *transaction,
+                                     BaseType_t *higher_priority_task_woken);
+
 bool ms5611_available(void)
 {
 	return true; //TODO: data lost checking?
@@ -47,26 +52,6 @@ void ms5611_read_uint16(uint8_t address, uint32_t *data)
 	ms5611_chip_deselect();
 }
 
-void ms5611_read_int24_addr(uint8_t address)
-{
-	ms5611_chip_select();
-	spi_read_write(SPI3, address);
-	ms5611_chip_deselect();
-}
-
-void ms5611_read_int24_data(int32_t *data)
-{
-	uint8_t byte1, byte2, byte3;
-
-	ms5611_chip_select();
-	spi_read_write(SPI3, 0x00);
-	byte1 = spi_read_write(SPI3, 0x00);
-	byte2 = spi_read_write(SPI3, 0x00);
-	byte3 = spi_read_write(SPI3, 0x00);
-	*data = ((int32_t)byte1 << 16) | ((int32_t)byte2 << 8) | (int32_t)byte3;
-	ms5611_chip_deselect();
-}
-
 void ms5611_read_prom(void)
 {
 	ms5611_chip_select();
@@ -83,6 +68,29 @@ void ms5611_init(void)
 {
 	ms5611_reset();
 	ms5611_read_prom();
+
+	/* the conversions are driven by the queued spi3 transactions after the
+	 * initialization: adc read (command + 24-bit result), then the command
+	 * of the next conversion */
+	ms5611.adc_read = (spi_transaction_t) {
+		.tx_buf = ms5611.adc_read_tx,
+		.rx_buf = ms5611.adc_read_rx,
+		.size = MS5611_ADC_READ_SIZE,
+		.cs_gpio = GPIOA,
+		.cs_pin = GPIO_Pin_15,
+		.callback = ms5611_adc_read_callback
+	};
+	ms5611.adc_read_tx[0] = MS5611_ADC_READ;
+	ms5611.convert_cmd = 0; //no conversion in progress
+
+	ms5611.convert = (spi_transaction_t) {
+		.tx_buf = &ms5611.convert_cmd,
+		.rx_buf = &ms5611.convert_rx,
+		.size = 1,
+		.cs_gpio = GPIOA,
+		.cs_pin = GPIO_Pin_15,
+		.callback = NULL
+	};
 }
 
 void ms5611_wait_until_stable(void)
@@ -206,31 +214,11 @@ void send_barometer_debug_message(debug_msg_t *payload)
 	pack_debug_debug_message_float(&ms5611.rel_vel_lpf, payload);
 }
 
-void ms5611_driver_handler(BaseType_t *higher_priority_task_woken)
+/* process one pair of the d1 (pressure) and d2 (temperature) conversion results */
+void ms5611_sample_update(int32_t d1, int32_t d2, BaseType_t *higher_priority_task_woken)
 {
-	static bool do_initial_start = true;
-	if(do_initial_start == true) {
-		do_initial_start = false;
-
-		/* trigger ms5611 d1 conversion, need to wait 10ms for
-		 * getting the result */
-		ms5611_read_int24_addr(MS5611_D1_CONVERT_OSR4096);
-		return;
-	}
-
-	CR_START();
-
-	/* get the result of d1 conversion */
-	ms5611_read_int24_data(&ms5611.d1);
-
-	/* trigger ms5611 d2 conversion, need to wait 10ms for getting
-	 * the result */
-	ms5611_read_int24_addr(MS5611_D2_CONVERT_OSR4096);
-
-	CR_YIELD();
-
-	/* get the result of d2 conversion */
-	ms5611_read_int24_data(&ms5611.d2);
+	ms5611.d1 = d1;
+	ms5611.d2 = d2;
 
 	/* convert ms5611 register to pressure and temperature value */
 	ms5611_convert_pressure_temperature(ms5611.d1, ms5611.d2);
@@ -241,10 +229,52 @@ void ms5611_driver_handler(BaseType_t *higher_priority_task_woken)
 	float curr_time = get_sys_time_s();
 	ms5611.update_freq = 1.0f / (curr_time - ms5611.last_read_time);
 	ms5611.last_read_time = curr_time;
+}
+
+static void ms5611_adc_read_callback(spi_transaction_t *transaction,
+                                     BaseType_t *higher_priority_task_woken)
+{
+	uint8_t *rx = transaction->rx_buf;
+	int32_t data = ((int32_t)rx[1] << 16) | ((int32_t)rx[2] << 8) | (int32_t)rx[3];
+
+	if(ms5611.read_cmd == MS5611_D1_CONVERT_OSR4096) {
+		/* result of d1 conversion */
+		ms5611.d1 = data;
+		return;
+	}
+
+	/* result of d2 conversion */
+	ms5611.d2 = data;
 
-	/* trigger ms5611 d1 conversion, need to wait 10ms for getting
-	 * the result */
-	ms5611_read_int24_addr(MS5611_D1_CONVERT_OSR4096);
+	sensor_log_barometer_t barometer = {.d1 = ms5611.d1, .d2 = ms5611.d2};
+	sensor_log_write(SENSOR_LOG_BAROMETER, &barometer, sizeof(barometer));
 
-	CR_END();
+	ms5611_sample_update(ms5611.d1, ms5611.d2, higher_priority_task_woken);
+}
+
+/* called every 10ms (conversion time of osr4096), the d1 and d2 conversions
+ * are interleaved. the handler only queues the spi3 transactions, the result
+ * is processed by the completion callback of the adc read */
+void ms5611_driver_handler(BaseType_t *higher_priority_task_woken)
+{
+	/* the transactions of the last period are not yet finished */
+	if(ms5611.adc_read.busy == true || ms5611.convert.busy == true) {
+		ms5611.spi_overrun_cnt++;
+		return;
+	}
+
+	if(ms5611.convert_cmd != 0) {
+		/* get the result of the last conversion */
+		ms5611.read_cmd = ms5611.convert_cmd;
+		spi3_transaction_submit(&ms5611.adc_read);
+	}
+
+	/* trigger the next conversion, need to wait 10ms for getting the
+	 * result */
+	if(ms5611.convert_cmd == MS5611_D1_CONVERT_OSR4096) {
+		ms5611.convert_cmd = MS5611_D2_CONVERT_OSR4096;
+	} else {
+		ms5611.convert_cmd = MS5611_D1_CONVERT_OSR4096;
+	}
+	spi3_transaction_submit(&ms5611.convert);
 }
@@ -24,6 +24,8 @@
 #define MS5611_OSR2048_DELAY   4
 #define MS5611_OSR4096_DELAY  10
 
+#define MS5611_ADC_READ_SIZE 4
+
 #define ms5611_chip_select() GPIO_ResetBits(GPIOA, GPIO_Pin_15)
 #define ms5611_chip_deselect() GPIO_SetBits(GPIOA, GPIO_Pin_15)
 
@@ -48,6 +50,16 @@ typedef struct {
 
 	float last_read_time;
 	float update_freq;
+
+	/* queued spi3 transactions */
+	spi_transaction_t adc_read;
+	spi_transaction_t convert;
+	uint8_t adc_read_tx[MS5611_ADC_READ_SIZE];
+	uint8_t adc_read_rx[MS5611_ADC_READ_SIZE];
+	uint8_t convert_cmd; //command of the conversion in progress
+	uint8_t convert_rx;
+	uint8_t read_cmd;    //command of the conversion being read
+	uint32_t spi_overrun_cnt;
 } ms5611_t;
 
 bool ms5611_available(void);
@@ -63,6 +75,7 @@ float ms5611_get_relative_altitude(void);
 float ms5611_get_relative_altitude_rate(void);
 
 void ms5611_driver_handler(BaseType_t *higher_priority_task_woken);
+void ms5611_sample_update(int32_t d1, int32_t d2, BaseType_t *higher_priority_task_woken);
 
 void send_barometer_debug_message(debug_msg_t *payload);
 
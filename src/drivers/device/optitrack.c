@@ -11,121 +11,133 @@
 #include "sys_time.h"
 #include "lpf.h"
 #include "debug_link.h"
+#include "sensor_log.h"
 #include "led.h"
 #include "proj_config.h"
+#include "frame_parser.h"
 
-#define OPTITRACK_QUEUE_SIZE (32 * 400) //~400 packets
-
-typedef struct {
-	char c;
-} optitrack_buf_c_t;
-
-QueueHandle_t optitrack_queue;
+#define OPTITRACK_RX_READ_SIZE 64
 
 optitrack_t optitrack;
 
 void optitrack_init(int id)
 {
 	optitrack.id = id;
-	optitrack_queue = xQueueCreate(OPTITRACK_QUEUE_SIZE, sizeof(optitrack_buf_c_t));
+	optitrack.vel_ready = false;
+	frame_parser_init(&optitrack.parser, optitrack.buf, OPTITRACK_SERIAL_MSG_SIZE);
 }
 
 bool optitrack_available(void)
 {
 	//timeout if no data available more than 300ms
-	float current_time = get_sys_time_ms();
-	if((current_time - optitrack.time_now) > 300) {
+	if((get_time_us() - optitrack.time_now) > 300000) {
 		return false;
 	}
 	return true;
 }
 
-void optitrack_buf_push(uint8_t c)
+void optitrack_update(void)
 {
-	if(optitrack.buf_pos >= OPTITRACK_SERIAL_MSG_SIZE) {
-		/* drop the oldest data and shift the rest to left */
-		int i;
-		for(i = 1; i < OPTITRACK_SERIAL_MSG_SIZE; i++) {
-			optitrack.buf[i - 1] = optitrack.buf[i];
-		}
+	uint8_t rx_buf[OPTITRACK_RX_READ_SIZE];
+	int rx_cnt, i;
+	bool received = false;
 
-		/* save new byte to the last array element */
-		optitrack.buf[OPTITRACK_SERIAL_MSG_SIZE - 1] = c;
-		optitrack.buf_pos = OPTITRACK_SERIAL_MSG_SIZE;
-	} else {
-		/* append new byte if the array boundary is not yet reached */
-		optitrack.buf[optitrack.buf_pos] = c;
-		optitrack.buf_pos++;
+	/* drain the uart7 dma ring in chunks */
+	while((rx_cnt = uart7_read(rx_buf, OPTITRACK_RX_READ_SIZE)) > 0) {
+		for(i = 0; i < rx_cnt; i++) {
+			if(frame_parser_feed(&optitrack.parser, rx_buf[i]) == false) {
+				continue;
+			}
+
+			/* only the latest frame is decoded, the older ones have no
+			 * reception time */
+			if(received == true) {
+				optitrack.skip_cnt++;
+			}
+			memcpy(optitrack.frame, optitrack.buf, OPTITRACK_SERIAL_MSG_SIZE);
+			received = true;
+		}
 	}
-}
 
-void optitrack_isr_handler(uint8_t c)
-{
-	optitrack_buf_c_t optitrack_queue_item;
-	optitrack_queue_item.c = c;
+	if(received == true) {
+		/* the frames are separated by a gap, so the last idle line is the
+		 * end of the latest frame */
+		uint64_t timestamp_us = uart7_get_rx_time();
+		timestamp_us -= (timestamp_us > OPTITRACK_FRAME_TX_TIME) ? OPTITRACK_FRAME_TX_TIME : timestamp_us;
+
+		/* decode optitrack message */
+		if(optitrack_serial_decoder(optitrack.frame, timestamp_us) == 0) {
+			sensor_log_write(SENSOR_LOG_OPTITRACK, optitrack.frame,
+			                 OPTITRACK_SERIAL_MSG_SIZE);
+		}
+	}
 
-	BaseType_t higher_priority_task_woken = pdFALSE;
-	xQueueSendToBackFromISR(optitrack_queue, &optitrack_queue_item,
-	                        &higher_priority_task_woken);
-	portEND_SWITCHING_ISR(higher_priority_task_woken);
+	/* hide the latency of the link */
+	optitrack_predict(get_time_us());
 }
 
-void optitrack_update(void)
+/* alpha-beta filter with the measured frame period, the dropped and the
+ * jittered frames change the period instead of the velocity */
+static void optitrack_filter_update(float dt)
 {
-	optitrack_buf_c_t recept_c;
-	while(xQueueReceive(optitrack_queue, &recept_c, 0) == pdTRUE) {
-		uint8_t c = recept_c.c;
+	int i;
+	for(i = 0; i < 3; i++) {
+		/* numerical differentiation for comparison */
+		optitrack.vel_raw[i] = (optitrack.pos[i] - optitrack.pos_last[i]) / dt;
 
-		optitrack_buf_push(c);
-		if(c == '+' && optitrack.buf[0] == '@') {
-			/* decode optitrack message */
-			if(optitrack_serial_decoder(optitrack.buf) == 0) {
-				optitrack.buf_pos = 0; //reset position pointer
-			}
-		}
+		float pos_predict = optitrack.pos_filtered[i] + optitrack.vel_filtered[i] * dt;
+		float residual = optitrack.pos[i] - pos_predict;
+
+		optitrack.pos_filtered[i] = pos_predict + OPTITRACK_FILTER_ALPHA * residual;
+		optitrack.vel_filtered[i] += (OPTITRACK_FILTER_BETA / dt) * residual;
 	}
+
+	optitrack.update_rate = 1.0f / dt;
 }
 
-#define OPTITRACK_CHECKSUM_INIT_VAL 19
-static uint8_t generate_optitrack_checksum_byte(uint8_t *payload, int payload_count)
+static void optitrack_filter_reset(void)
 {
-	uint8_t result = OPTITRACK_CHECKSUM_INIT_VAL;
-
 	int i;
-	for(i = 0; i < payload_count; i++)
-		result ^= payload[i];
-
-	return result;
+	for(i = 0; i < 3; i++) {
+		optitrack.pos_filtered[i] = optitrack.pos[i];
+		optitrack.vel_raw[i] = 0.0f;
+		optitrack.vel_filtered[i] = 0.0f;
+	}
 }
 
-void optitrack_numerical_vel_calc(void)
+/* extrapolate the filtered position from the capture time of the latest
+ * frame to the given time */
+void optitrack_predict(uint64_t time_us)
 {
-	const float dt = 1.0f / 120.0f; //fixed dt (120Hz)
-	optitrack.vel_raw[0] = (optitrack.pos[0] - optitrack.pos_last[0]) / dt;
-	optitrack.vel_raw[1] = (optitrack.pos[1] - optitrack.pos_last[1]) / dt;
-	optitrack.vel_raw[2] = (optitrack.pos[2] - optitrack.pos_last[2]) / dt;
-
-	float received_period = (optitrack.time_now - optitrack.time_last) * 0.001;
-	optitrack.update_rate = 1.0f / received_period;
+	float dt = 0.0f;
+	if(time_us > optitrack.time_now) {
+		uint64_t predict_time = time_us - optitrack.time_now;
+		if(predict_time > OPTITRACK_PREDICT_TIME_MAX) {
+			predict_time = OPTITRACK_PREDICT_TIME_MAX;
+		}
+		dt = (float)predict_time * 1e-6f;
+	}
 
-	optitrack.vel_filtered[0] = optitrack.vel_raw[0];
-	optitrack.vel_filtered[1] = optitrack.vel_raw[1];
-	optitrack.vel_filtered[2] = optitrack.vel_raw[2];
-	//lpf(optitrack.vel_raw[0], &(optitrack.vel_filtered[0]), 0.8);
-	//lpf(optitrack.vel_raw[1], &(optitrack.vel_filtered[1]), 0.8);
-	//lpf(optitrack.vel_raw[2], &(optitrack.vel_filtered[2]), 0.8);
+	optitrack.pos_predict[0] = optitrack.pos_filtered[0] + optitrack.vel_filtered[0] * dt;
+	optitrack.pos_predict[1] = optitrack.pos_filtered[1] + optitrack.vel_filtered[1] * dt;
+	optitrack.pos_predict[2] = optitrack.pos_filtered[2] + optitrack.vel_filtered[2] * dt;
 }
 
-int optitrack_serial_decoder(uint8_t *buf)
+/* decode a frame validated by the frame parser, the timestamp is the capture
+ * time of the frame */
+int optitrack_serial_decoder(uint8_t *buf, uint64_t timestamp_us)
 {
-	uint8_t recv_checksum = buf[1];
-	uint8_t checksum = generate_optitrack_checksum_byte(&buf[3], OPTITRACK_SERIAL_MSG_SIZE - 4);
 	int recv_id = buf[2];
-	if(checksum != recv_checksum || optitrack.id != recv_id) {
+	if(optitrack.id != recv_id) {
 		return 1; //error detected
 	}
 
-	optitrack.time_now = get_sys_time_ms();
+	/* out of order or repeated frame */
+	if(optitrack.vel_ready == true && timestamp_us <= optitrack.time_now) {
+		return 1;
+	}
+
+	optitrack.time_now = timestamp_us;
 
 	float enu_pos_x, enu_pos_y, enu_pos_z;
 
@@ -142,19 +154,20 @@ int optitrack_serial_decoder(uint8_t *buf)
 	memcpy(&optitrack.q[0], &buf[27], sizeof(float));
 	optitrack.q[3] *= -1;
 
-	if(optitrack.vel_ready == false) {
-		optitrack.time_last = get_sys_time_ms();
-		optitrack.pos_last[0] = optitrack.pos[0];
-		optitrack.pos_last[1] = optitrack.pos[1];
-		optitrack.pos_last[2] = optitrack.pos[2];
-		optitrack.vel_raw[0] = 0.0f;
-		optitrack.vel_raw[1] = 0.0f;
-		optitrack.vel_raw[2] = 0.0f;
+	uint64_t period = optitrack.time_now - optitrack.time_last;
+
+	if(optitrack.vel_ready == false || period > OPTITRACK_FILTER_RESET_TIME) {
+		if(optitrack.vel_ready == true) {
+			optitrack.filter_reset_cnt++;
+		}
+		optitrack_filter_reset();
 		optitrack.vel_ready = true;
-		return 0;
+	} else {
+		optitrack_filter_update((float)period * 1e-6f);
 	}
 
-	optitrack_numerical_vel_calc();
+	optitrack_predict(timestamp_us);
+
 	optitrack.pos_last[0] = optitrack.pos[0]; //save for next iteration
 	optitrack.pos_last[1] = optitrack.pos[1];
 	optitrack.pos_last[2] = optitrack.pos[2];
@@ -165,32 +178,32 @@ int optitrack_serial_decoder(uint8_t *buf)
 
 float optitrack_read_pos_x(void)
 {
-	return optitrack.pos[0];
+	return optitrack.pos_predict[0];
 }
 
 float optitrack_read_pos_y(void)
 {
-	return optitrack.pos[1];
+	return optitrack.pos_predict[1];
 }
 
 float optitrack_read_pos_z(void)
 {
-	return optitrack.pos[2];
+	return optitrack.pos_predict[2];
 }
 
 float optitrack_read_vel_x(void)
 {
-	return optitrack.vel_raw[0];
+	return optitrack.vel_filtered[0];
 }
 
 float optitrack_read_vel_y(void)
 {
-	return optitrack.vel_raw[1];
+	return optitrack.vel_filtered[1];
 }
 
 float optitrack_read_vel_z(void)
 {
-	return optitrack.vel_raw[2];
+	return optitrack.vel_filtered[2];
 }
 
 void optitrack_get_quaternion(float *q)
@@ -4,35 +4,54 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "debug_link.h"
+#include "frame_parser.h"
 
 #define OPTITRACK_SERIAL_MSG_SIZE 32
 
+/* transmission of one frame at 115200 baud (10 bits per byte), the frame is
+ * timestamped at the idle line of the reception */
+#define OPTITRACK_FRAME_TX_TIME 2778 //[us]
+
+/* alpha-beta filter of the position and velocity, steady state gains of a
+ * constant velocity kalman filter */
+#define OPTITRACK_FILTER_ALPHA 0.6f
+#define OPTITRACK_FILTER_BETA 0.27f
+
+#define OPTITRACK_FILTER_RESET_TIME 100000 //[us], restart after a longer gap
+#define OPTITRACK_PREDICT_TIME_MAX 50000   //[us]
+
 typedef struct {
 	uint8_t id;
 
 	/* position [m] */
 	float pos[3];
+	float pos_filtered[3];
+	float pos_predict[3]; //predicted to the current control tick
 
-	/* velocity (numerical differentiation) [m/s] */
-	float vel_raw[3];
+	/* velocity [m/s] */
+	float vel_raw[3]; //numerical differentiation
 	float vel_filtered[3];
 
 	/* orientation (quaternion) */
 	float q[4];
 
-	float time_now;
-	float time_last;
+	uint64_t time_now;  //[us], capture time of the latest frame
+	uint64_t time_last; //[us]
 	float update_rate;
 
-	volatile int buf_pos;
+	frame_parser_t parser;
 	uint8_t buf[OPTITRACK_SERIAL_MSG_SIZE];
+	uint8_t frame[OPTITRACK_SERIAL_MSG_SIZE];
 	float pos_last[3];
 	bool vel_ready;
+
+	uint32_t skip_cnt; //frames superseded by a newer one of the same read
+	uint32_t filter_reset_cnt;
 } optitrack_t ;
 
 void optitrack_init(int id);
-int optitrack_serial_decoder(uint8_t *buf);
-void optitrack_isr_handler(uint8_t c);
+int optitrack_serial_decoder(uint8_t *buf, uint64_t timestamp_us);
+void optitrack_predict(uint64_t time_us);
 
 void optitrack_update(void);
 bool optitrack_available(void);
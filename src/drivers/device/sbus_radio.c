@@ -8,66 +8,39 @@
 #include "sbus_radio.h"
 #include "sys_time.h"
 
-void parse_sbus(uint8_t *raw_buff, uint16_t *rc_val);
-
 sbus_t sbus;
 
-void sbus_rc_isr_handler(uint8_t byte)
-{
-	static float curr_time_ms;
-	static float last_time_ms;
-
-	curr_time_ms = get_sys_time_ms();
-
-	/* use reception interval time to deteminate
-	   whether it is a new s-bus frame */
-	if((curr_time_ms - last_time_ms) > 2.0f) {
-		sbus.buf_recept_cnt = 0;
-	}
-
-	sbus.buf[sbus.buf_recept_cnt] = byte;
-	sbus.buf_recept_cnt++;
-
-	if((sbus.buf_recept_cnt == 25) && (sbus.buf[0] == 0x0f) && (sbus.buf[24] == 0x00)) {
-		parse_sbus((uint8_t *)sbus.buf, (uint16_t *)sbus.rc_val);
-		sbus.buf_recept_cnt = 0;
-	}
-
-	last_time_ms = curr_time_ms;
-}
-
-void parse_sbus(uint8_t *raw_buff, uint16_t *rc_val)
+static void sbus_parse_channels(uint8_t *buf, uint16_t *rc_val)
 {
-	/* parse channel 1 to 8 */
-	sbus.rc_val[0] = ((raw_buff[1] | raw_buff[2] << 8) & 0x07ff);
-	sbus.rc_val[1] = ((raw_buff[2] >> 3 | raw_buff[3] << 5) & 0x07ff);
-	sbus.rc_val[2] = ((raw_buff[3] >> 6 | raw_buff[4] << 2 | raw_buff[5] << 10) & 0x07ff);
-	sbus.rc_val[3] = ((raw_buff[5] >> 1 | raw_buff[6] << 7) & 0x07ff);
-	sbus.rc_val[4] = ((raw_buff[6] >> 4 | raw_buff[7] << 4) & 0x07ff);
-	sbus.rc_val[5] = ((raw_buff[7] >> 7 | raw_buff[8] << 1 | raw_buff[9] << 9) & 0x07ff);
-	sbus.rc_val[6] = ((raw_buff[9] >> 2 | raw_buff[10] << 6) & 0x07ff);
-	sbus.rc_val[7] = ((raw_buff[10] >> 5 | raw_buff[11] << 3) & 0x07ff);
-
-	/* channel 9 ~ channel 16 haven't yet been validated, check the data before using them */
-	//sbus.rc_val[8] = ((raw_buff[12] | raw_buff[13] << 8) & 0x07ff);
-	//sbus.rc_val[9] = ((raw_buff[13] >> 3 | raw_buff[14] << 5) & 0x07ff);
-	//sbus.rc_val[10] = ((raw_buff[14] >> 6 | raw_buff[15] << 2 | raw_buff[16] << 10) & 0x07ff);
-	//sbus.rc_val[11] = ((raw_buff[16] >> 1 | raw_buff[17] << 7) & 0x07ff);
-	//sbus.rc_val[12] = ((raw_buff[17] >> 4 | raw_buff[18] << 4) & 0x07ff);
-	//sbus.rc_val[13] = ((raw_buff[18] >> 7 | raw_buff[19] << 1 | raw_buff[20] << 9) & 0x07ff);
-	//sbus.rc_val[14] = ((raw_buff[20] >> 2 | raw_buff[21] << 6) & 0x07ff);
-	//sbus.rc_val[15] = ((raw_buff[21] >> 5 | raw_buff[22] << 3) & 0x07ff);
+	/* 16 channels of 11 bits, least significant bit first */
+	rc_val[0] = ((buf[1] | buf[2] << 8) & 0x07ff);
+	rc_val[1] = ((buf[2] >> 3 | buf[3] << 5) & 0x07ff);
+	rc_val[2] = ((buf[3] >> 6 | buf[4] << 2 | buf[5] << 10) & 0x07ff);
+	rc_val[3] = ((buf[5] >> 1 | buf[6] << 7) & 0x07ff);
+	rc_val[4] = ((buf[6] >> 4 | buf[7] << 4) & 0x07ff);
+	rc_val[5] = ((buf[7] >> 7 | buf[8] << 1 | buf[9] << 9) & 0x07ff);
+	rc_val[6] = ((buf[9] >> 2 | buf[10] << 6) & 0x07ff);
+	rc_val[7] = ((buf[10] >> 5 | buf[11] << 3) & 0x07ff);
+	rc_val[8] = ((buf[12] | buf[13] << 8) & 0x07ff);
+	rc_val[9] = ((buf[13] >> 3 | buf[14] << 5) & 0x07ff);
+	rc_val[10] = ((buf[14] >> 6 | buf[15] << 2 | buf[16] << 10) & 0x07ff);
+	rc_val[11] = ((buf[16] >> 1 | buf[17] << 7) & 0x07ff);
+	rc_val[12] = ((buf[17] >> 4 | buf[18] << 4) & 0x07ff);
+	rc_val[13] = ((buf[18] >> 7 | buf[19] << 1 | buf[20] << 9) & 0x07ff);
+	rc_val[14] = ((buf[20] >> 2 | buf[21] << 6) & 0x07ff);
+	rc_val[15] = ((buf[21] >> 5 | buf[22] << 3) & 0x07ff);
 }
 
-void sbus_rc_read(radio_t *rc)
+/* convert the channels to the radio command */
+static void sbus_rc_scale(uint16_t *rc_val, radio_t *rc)
 {
-	float throttle_raw = (float)sbus.rc_val[2]; //channel 3
-	float roll_raw = (float)sbus.rc_val[0]; //channel 1
-	float pitch_raw = (float)sbus.rc_val[1]; //channel 2
-	float yaw_raw = (float)sbus.rc_val[3]; //channel 4
-	float safety_raw = (float)sbus.rc_val[4]; //channel 5
-	float auto_flight = (float)sbus.rc_val[5]; //channel 6
-	float aux1_mode_raw = (float)sbus.rc_val[6]; //channel 7
+	float throttle_raw = (float)rc_val[2]; //channel 3
+	float roll_raw = (float)rc_val[0]; //channel 1
+	float pitch_raw = (float)rc_val[1]; //channel 2
+	float yaw_raw = (float)rc_val[3]; //channel 4
+	float safety_raw = (float)rc_val[4]; //channel 5
+	float auto_flight = (float)rc_val[5]; //channel 6
+	float aux1_mode_raw = (float)rc_val[6]; //channel 7
 
 	if(safety_raw > RC_SAFETY_THRESH) {
 		rc->safety = false; //disarmed
@@ -112,6 +85,82 @@ void sbus_rc_read(radio_t *rc)
 	bound_float(&rc->throttle, RC_THROTTLE_RANGE_MAX, RC_THROTTLE_RANGE_MIN);
 }
 
+void sbus_init(void)
+{
+	/* the radio command before the first frame, same as all channels
+	 * being zero */
+	memset(&sbus, 0, sizeof(sbus));
+	sbus_rc_scale(sbus.frames[0].rc_val, &sbus.frames[0].rc);
+}
+
+/* decode one burst of the receiver, returns false if it is not a valid
+ * s-bus frame. called by the receiver interrupt only */
+bool sbus_frame_decode(uint8_t *buf, int size, uint64_t timestamp_us)
+{
+	if(size != SBUS_FRAME_SIZE || buf[0] != SBUS_HEADER ||
+	    (buf[24] != SBUS_FOOTER && (buf[24] & SBUS2_FOOTER_MASK) != SBUS2_FOOTER)) {
+		sbus.framing_err_cnt++;
+		return false;
+	}
+
+	uint32_t seq = sbus.seq;
+	sbus_frame_t *frame = &sbus.frames[(seq + 1) & 1];
+
+	/* the switches keep their state if the channel is exactly at the
+	 * threshold */
+	frame->rc = sbus.frames[seq & 1].rc;
+
+	sbus_parse_channels(buf, frame->rc_val);
+	frame->ch17 = (buf[23] & SBUS_FLAG_CH17) ? true : false;
+	frame->ch18 = (buf[23] & SBUS_FLAG_CH18) ? true : false;
+	frame->frame_lost = (buf[23] & SBUS_FLAG_FRAME_LOST) ? true : false;
+	frame->failsafe = (buf[23] & SBUS_FLAG_FAILSAFE) ? true : false;
+	frame->timestamp_us = timestamp_us;
+	sbus_rc_scale(frame->rc_val, &frame->rc);
+
+	/* publish the frame */
+	__atomic_store_n(&sbus.seq, seq + 1, __ATOMIC_RELEASE);
+	sbus.frame_cnt++;
+
+	return true;
+}
+
+/* idle line of the receiver (uart4), the frames are separated by a gap of
+ * at least 3ms so every burst should contain exactly one frame */
+void sbus_rc_idle_handler(void)
+{
+	uint8_t buf[SBUS_FRAME_SIZE + 1];
+	int size = uart4_read(buf, sizeof(buf));
+
+	/* drop the rest of an oversized burst */
+	if(size == sizeof(buf)) {
+		uint8_t dummy[SBUS_FRAME_SIZE];
+		while(uart4_read(dummy, sizeof(dummy)) > 0);
+	}
+
+	sbus_frame_decode(buf, size, get_time_us());
+}
+
+/* copy the latest frame, read again if the interrupt published two new
+ * frames in between (the buffer being copied was overwritten) */
+void sbus_read_frame(sbus_frame_t *frame)
+{
+	uint32_t seq;
+
+	do {
+		seq = __atomic_load_n(&sbus.seq, __ATOMIC_ACQUIRE);
+		*frame = sbus.frames[seq & 1];
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while(__atomic_load_n(&sbus.seq, __ATOMIC_RELAXED) != seq);
+}
+
+void sbus_rc_read(radio_t *rc)
+{
+	sbus_frame_t frame;
+	sbus_read_frame(&frame);
+	*rc = frame.rc;
+}
+
 int rc_safety_check(radio_t *rc)
 {
 	if(rc->safety == false) return 1;
@@ -125,48 +174,31 @@ int rc_safety_check(radio_t *rc)
 	return 0;
 }
 
-void debug_print_raw_sbus(void)
+void sbus_get_unscaled(uint16_t *rc_val)
 {
+	sbus_frame_t frame;
+	sbus_read_frame(&frame);
+
 	int i;
-	for(i = 0; i < 25; i++) {
-		char s[10] = {0};
-		sprintf(s, "%d,", sbus.buf[i]);
-		uart1_puts(s, strlen(s));
+	for(i = 0; i < SBUS_CHANNEL_CNT; i++) {
+		rc_val[i] = frame.rc_val[i];
 	}
 
-	char *s = "\n\r";
-	uart1_puts(s, strlen(s));
-}
-
-void sbus_get_unscaled(uint16_t *rc_val)
-{
-	rc_val[0] = sbus.rc_val[0];
-	rc_val[1] = sbus.rc_val[1];
-	rc_val[2] = sbus.rc_val[2];
-	rc_val[3] = sbus.rc_val[3];
-	rc_val[4] = sbus.rc_val[4];
-	rc_val[5] = sbus.rc_val[5];
-	rc_val[6] = sbus.rc_val[6];
-	rc_val[7] = sbus.rc_val[7];
-	rc_val[8] = 0;
-	rc_val[9] = 0;
-	rc_val[10] = 0;
-	rc_val[11] = 0;
-	rc_val[12] = 0;
-	rc_val[13] = 0;
-	rc_val[14] = 0;
-	rc_val[15] = 0;
-	rc_val[16] = 0;
-	rc_val[17] = 0;
-	rc_val[18] = 0;
+	/* digital channels, full scale if set */
+	rc_val[16] = frame.ch17 ? 0x07ff : 0;
+	rc_val[17] = frame.ch18 ? 0x07ff : 0;
 }
 
 void debug_print_rc_val(void)
 {
 	/* debug message */
 	char s[100] = {0};
-	sprintf(s, "ch1:%d, ch2:%d ch3:%d, ch4:%d, ch5:%d, ch6:%d, ch7:%d\n\r",
-	        sbus.rc_val[0], sbus.rc_val[1], sbus.rc_val[2], sbus.rc_val[3], sbus.rc_val[4], sbus.rc_val[5], sbus.rc_val[6]);
+	sbus_frame_t frame;
+	sbus_read_frame(&frame);
+	sprintf(s, "ch1:%d, ch2:%d ch3:%d, ch4:%d, ch5:%d, ch6:%d, ch7:%d%s%s\n\r",
+	        frame.rc_val[0], frame.rc_val[1], frame.rc_val[2], frame.rc_val[3],
+	        frame.rc_val[4], frame.rc_val[5], frame.rc_val[6],
+	        frame.frame_lost ? " [frame lost]" : "", frame.failsafe ? " [failsafe]" : "");
 	uart1_puts(s, strlen(s));
 	blocked_delay_ms(100);
 }
@@ -62,13 +62,46 @@ typedef struct {
 	int aux1_mode;
 } radio_t;
 
+#define SBUS_FRAME_SIZE   25
+#define SBUS_CHANNEL_CNT  16
+#define SBUS_HEADER       0x0f
+#define SBUS_FOOTER       0x00
+#define SBUS2_FOOTER_MASK 0x0f //s-bus2 telemetry slots: 0x04, 0x14, 0x24, 0x34
+#define SBUS2_FOOTER      0x04
+
+/* flags byte */
+#define SBUS_FLAG_CH17       0x01
+#define SBUS_FLAG_CH18       0x02
+#define SBUS_FLAG_FRAME_LOST 0x04
+#define SBUS_FLAG_FAILSAFE   0x08
+
+/* one decoded packet, the scaled radio command is computed by the receiver
+ * interrupt so the readers only copy it */
 typedef struct {
-	uint8_t buf[25];
-	int buf_recept_cnt;
-	uint16_t rc_val[15];
+	uint16_t rc_val[SBUS_CHANNEL_CNT];
+	bool ch17;
+	bool ch18;
+	bool frame_lost;
+	bool failsafe;
+	uint64_t timestamp_us; //end of the frame (idle line)
+
+	radio_t rc;
+} sbus_frame_t;
+
+typedef struct {
+	/* double buffer, the writer fills the buffer not indexed by the
+	 * sequence number and then increments it */
+	sbus_frame_t frames[2];
+	volatile uint32_t seq;
+
+	uint32_t frame_cnt;
+	uint32_t framing_err_cnt; //bursts with wrong size, header or footer
 } sbus_t;
 
-void sbus_rc_isr_handler(uint8_t byte);
+void sbus_init(void);
+void sbus_rc_idle_handler(void);
+bool sbus_frame_decode(uint8_t *buf, int size, uint64_t timestamp_us);
+void sbus_read_frame(sbus_frame_t *frame);
 void sbus_rc_read(radio_t *rc);
 void sbus_get_unscaled(uint16_t *rc_val);
 int rc_safety_check(radio_t *rc);
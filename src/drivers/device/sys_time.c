@@ -2,34 +2,55 @@
 #include <string.h>
 
 #include "stm32f4xx_conf.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include "uart.h"
+#include "timer.h"
 #include "sys_time.h"
 
-sys_time_t sys_tim;
+/* timer5 counts microseconds with 32 bits and wraps around every 71 minutes,
+ * the wraparounds are counted here to extend it to 64 bits. the time has to
+ * be read at least once per wraparound, which is guaranteed by the flight
+ * control trigger of timer5 (400Hz) */
+static uint32_t sys_time_last_cnt = 0;
+static uint32_t sys_time_wrap_cnt = 0;
 
-#define SYS_TIM_TICK_FREQ   400000
-#define SYS_TIM_TICK_PERIOD (1.0f / SYS_TIM_TICK_FREQ)
-
-void sys_time_update_handler(void)
+uint64_t get_time_us(void)
 {
-	sys_tim.tick++;
-	sys_tim.tick_s = SYS_TIM_TICK_PERIOD * (float)sys_tim.tick;
+	UBaseType_t int_mask = taskENTER_CRITICAL_FROM_ISR();
 
-	if(sys_tim.tick == SYS_TIM_TICK_FREQ) {
-		sys_tim.time_s += 1.0f;
-		sys_tim.tick_s = 0.0f;
-		sys_tim.tick = 0;
+	uint32_t cnt = timer5_get_count();
+	if(cnt < sys_time_last_cnt) {
+		sys_time_wrap_cnt++;
 	}
+	sys_time_last_cnt = cnt;
+
+	uint64_t time_us = ((uint64_t)sys_time_wrap_cnt << 32) | cnt;
+
+	taskEXIT_CRITICAL_FROM_ISR(int_mask);
+
+	return time_us;
+}
+
+/* the resolution is limited by the 1MHz counter */
+uint64_t get_time_ns(void)
+{
+	return get_time_us() * 1000ULL;
 }
 
+/* float time for the filters and the controllers, the seconds and the
+ * fraction are converted separately to keep the resolution of the fraction.
+ * the timeout checks should use get_time_us() instead */
 float get_sys_time_ms(void)
 {
-	return (sys_tim.time_s + sys_tim.tick_s) * 1000.0f;
+	uint64_t time_us = get_time_us();
+	return (float)(time_us / 1000) + (float)(time_us % 1000) * 1e-3f;
 }
 
 float get_sys_time_s(void)
 {
-	return sys_tim.time_s + sys_tim.tick_s;
+	uint64_t time_us = get_time_us();
+	return (float)(time_us / 1000000) + (float)(time_us % 1000000) * 1e-6f;
 }
 
 void debug_print_sys_tim(void)
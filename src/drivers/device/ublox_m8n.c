@@ -5,11 +5,11 @@
 #include "task.h"
 #include "ublox_m8n.h"
 #include "uart.h"
-#include "delay.h"
 #include "sys_time.h"
 #include "../../lib/mavlink_v2/ncrl_mavlink/mavlink.h"
 #include "ncrl_mavlink.h"
 #include "ins_sensor_sync.h"
+#include "sensor_log.h"
 
 #define UBX_SYNC_C1 0xb5
 #define UBX_SYNC_C2 0x62
@@ -52,58 +52,127 @@ uint8_t ubx_save_rom_cmd[] = {0xB5, 0x62, 0x06, 0x09, 0x0D, 0x00, 0x00, 0x00, 0x
                               0x17, 0x31, 0xBF
                              };
 
+#define UBLOX_M8N_RX_READ_SIZE 64
+
 typedef struct {
-	char c;
-} ublox_m8n_buf_c_t;
+	uint8_t *cmd;
+	int size;
+} ubx_cfg_cmd_t;
+
+/* configuration sequence, every command is acknowledged by the receiver */
+static ubx_cfg_cmd_t ubx_cfg_list[] = {
+	/* enable nav-pvt message output */
+	{ubx_nav_pvt_set, UBX_NAV_PVT_SET_LEN},
+
+	/* enable nav-sat message output  */
+	//{ubx_nav_sat_set, UBX_NAV_SAT_SET_LEN},
+
+	/* diable nmea messages output */
+	{ubx_nmea_gxgga_set, UBX_NMEA_GXGGA_SET_LEN},
+	{ubx_nmea_gxggl_set, UBX_NMEA_GXGGL_SET_LEN},
+	{ubx_nmea_gxgsa_set, UBX_NMEA_GXGSA_SET_LEN},
+	{ubx_nmea_gxgsv_set, UBX_NMEA_GXGSV_SET_LEN},
+	{ubx_nmea_gxrmc_set, UBX_NMEA_GXRMC_SET_LEN},
+	{ubx_nmea_gxvtg_set, UBX_NMEA_GXVTG_SET_LEN},
 
-QueueHandle_t ublox_m8n_queue;
+	/* set dynamic range to 2g  */
+	{ubx_2g_mode_set, UBX_2G_MODE_SET_LEN},
+
+	/* use UTC time */
+	{ubx_utc_time_set, UBX_UTC_TIME_SET_LEN},
+
+	/* save configurations to rom */
+	//{ubx_save_rom_cmd, UBX_SAVE_ROM_CMD_LEN},
+};
+
+#define UBX_CFG_LIST_SIZE (int)(sizeof(ubx_cfg_list) / sizeof(ubx_cfg_cmd_t))
 
 ublox_t ublox;
 
 bool ublox_available(void)
 {
 	//timeout if no gps data available more than 1000ms
-	float current_time = get_sys_time_s();
-	if((current_time - ublox.last_read_time) > 1.0) {
+	if((get_time_us() - ublox.last_read_time) > 1000000) {
 		return false;
 	}
 	return true;
 }
 
-void ublox_command_send(uint8_t *cmd, int size)
+/* the configuration is sent in the background by ublox_m8n_gps_update() */
+void ublox_m8n_init(void)
 {
-	usart_puts(UART7, (char *)cmd, size);
-	blocked_delay_ms(100);
+	ublox.parser.state = UBX_STATE_WAIT_SYNC_C1;
+	ublox.cfg_state = UBX_CFG_STATE_BOOT_WAIT;
+	ublox.cfg_index = 0;
+	ublox.cfg_retry_cnt = 0;
+	ublox.cfg_time = get_time_us();
 }
 
-void ublox_m8n_init(void)
+bool ublox_m8n_config_done(void)
 {
-	ublox_m8n_queue = xQueueCreate(UBX_BUFFER_SIZE, sizeof(ublox_m8n_buf_c_t));
-
-	blocked_delay_ms(500); //wait until uart finished initialization
-
-	/* enable nav-pvt message output */
-	ublox_command_send(ubx_nav_pvt_set, UBX_NAV_PVT_SET_LEN);
+	return ublox.cfg_state == UBX_CFG_STATE_DONE;
+}
 
-	/* enable nav-sat message output  */
-	//ublox_command_send(ubx_nav_sat_set, UBX_NAV_SAT_SET_LEN);
+static void ublox_m8n_config_next(void)
+{
+	ublox.cfg_index++;
+	ublox.cfg_retry_cnt = 0;
+	ublox.cfg_state = UBX_CFG_STATE_SEND;
+}
 
-	/* diable nmea messages output */
-	ublox_command_send(ubx_nmea_gxgga_set, UBX_NMEA_GXGGA_SET_LEN);
-	ublox_command_send(ubx_nmea_gxggl_set, UBX_NMEA_GXGGL_SET_LEN);
-	ublox_command_send(ubx_nmea_gxgsa_set, UBX_NMEA_GXGSA_SET_LEN);
-	ublox_command_send(ubx_nmea_gxgsv_set, UBX_NMEA_GXGSV_SET_LEN);
-	ublox_command_send(ubx_nmea_gxrmc_set, UBX_NMEA_GXRMC_SET_LEN);
-	ublox_command_send(ubx_nmea_gxvtg_set, UBX_NMEA_GXVTG_SET_LEN);
+/* send the configuration commands one by one, a command is sent again if it
+ * is not acknowledged before the timeout. a rejected command (ack-nak) or a
+ * command without any response is skipped so the rest of the sequence is
+ * still applied */
+static void ublox_m8n_config_handler(void)
+{
+	uint64_t curr_time = get_time_us();
+	ubx_cfg_cmd_t *cfg_cmd;
 
-	/* set dynamic range to 2g  */
-	ublox_command_send(ubx_2g_mode_set, UBX_2G_MODE_SET_LEN);
+	switch(ublox.cfg_state) {
+	case UBX_CFG_STATE_BOOT_WAIT:
+		/* wait until the receiver finished booting */
+		if((curr_time - ublox.cfg_time) < UBX_CFG_BOOT_WAIT_TIME) {
+			break;
+		}
+		ublox.cfg_state = UBX_CFG_STATE_SEND;
+	/* fall through */
+	case UBX_CFG_STATE_SEND:
+		if(ublox.cfg_index >= UBX_CFG_LIST_SIZE) {
+			ublox.cfg_state = UBX_CFG_STATE_DONE;
+			break;
+		}
 
-	/* use UTC time */
-	ublox_command_send(ubx_utc_time_set, UBX_UTC_TIME_SET_LEN);
+		cfg_cmd = &ubx_cfg_list[ublox.cfg_index];
+		if(uart7_write(cfg_cmd->cmd, cfg_cmd->size) == false) {
+			break; //previous transmission is not finished
+		}
 
-	/* save configurations to rom */
-	//ublox_command_send(ubx_save_rom_cmd, UBX_SAVE_ROM_CMD_LEN);
+		ublox.cfg_ack = UBX_CFG_ACK_WAIT;
+		ublox.cfg_time = curr_time;
+		ublox.cfg_state = UBX_CFG_STATE_WAIT_ACK;
+		break;
+	case UBX_CFG_STATE_WAIT_ACK:
+		if(ublox.cfg_ack == UBX_CFG_ACK_RECEIVED) {
+			ublox_m8n_config_next();
+		} else if(ublox.cfg_ack == UBX_CFG_NAK_RECEIVED) {
+			ublox.cfg_nak_cnt++;
+			ublox_m8n_config_next();
+		} else if((curr_time - ublox.cfg_time) > UBX_CFG_ACK_TIMEOUT) {
+			if(ublox.cfg_retry_cnt < UBX_CFG_RETRY_MAX) {
+				ublox.cfg_retry_cnt++;
+				ublox.cfg_resend_cnt++;
+				ublox.cfg_state = UBX_CFG_STATE_SEND;
+			} else {
+				ublox.cfg_timeout_cnt++;
+				ublox_m8n_config_next();
+			}
+		}
+		break;
+	case UBX_CFG_STATE_DONE:
+	default:
+		break;
+	}
 }
 
 /* get raw longitude/ latitude/ height from gps receiver */
@@ -184,46 +253,43 @@ float ublox_m8n_get_update_freq(void)
 
 float ublox_m8n_get_last_update_time_ms(void)
 {
-	return ublox.last_read_time * 1000.0f;
+	return (float)ublox.last_read_time * 1e-3f;
 }
 
-void ublox_checksum_calc(uint8_t *result, uint8_t *payload, uint16_t len)
+static void ublox_decode_ack_msg(ubx_parser_t *parser)
 {
-	result[0] = 0;
-	result[1] = 0;
-
-	int i;
-	for(i = 0; i < len; i++) {
-		result[0] += payload[i];
-		result[1] += result[0];
+	if(parser->len != UBX_ACK_PAYLOAD_LEN || ublox.cfg_state != UBX_CFG_STATE_WAIT_ACK) {
+		return;
 	}
-}
 
-void ublox_m8n_isr_handler(uint8_t c)
-{
-	ublox_m8n_buf_c_t ublox_m8n_queue_item;
-	ublox_m8n_queue_item.c = c;
+	/* the class and id of the acknowledged command */
+	uint8_t *cmd = ubx_cfg_list[ublox.cfg_index].cmd;
+	if(parser->payload[0] != cmd[2] || parser->payload[1] != cmd[3]) {
+		return;
+	}
 
-	BaseType_t higher_priority_task_woken = pdFALSE;
-	xQueueSendToBackFromISR(ublox_m8n_queue, &ublox_m8n_queue_item,
-	                        &higher_priority_task_woken);
-	portEND_SWITCHING_ISR(higher_priority_task_woken);
+	if(parser->msg_id == UBX_ID_ACK_ACK) {
+		ublox.cfg_ack = UBX_CFG_ACK_RECEIVED;
+	} else {
+		ublox.cfg_ack = UBX_CFG_NAK_RECEIVED;
+	}
 }
 
-void ublox_decode_nav_pvt_msg(void)
+static void ublox_decode_nav_pvt_msg(ubx_parser_t *parser)
 {
-	/* check class value and payload length */
-	if((ublox.recept_class != 0x01) || (ublox.recept_len != 92)) {
+	/* check payload length */
+	if(parser->len != UBX_NAV_PVT_PAYLOAD_LEN) {
 		return;
 	}
 
-	/* data length for calculating nav-pvt is 4 <header> + 92 <payload> */
-	ublox_checksum_calc(ublox.calc_ck, ublox.recept_buf, 92 + 4);
-	if(*(uint16_t *)ublox.calc_ck != *(uint16_t *)ublox.recept_ck) {
-		return;
-	}
+	sensor_log_write(SENSOR_LOG_GPS, parser->payload, UBX_NAV_PVT_PAYLOAD_LEN);
 
-	uint8_t *ublox_payload_addr = ublox.recept_buf + 4; //skip header 4 bytes
+	ublox_decode_nav_pvt_payload(parser->payload);
+}
+
+/* decode the payload of a validated nav-pvt message */
+void ublox_decode_nav_pvt_payload(uint8_t *ublox_payload_addr)
+{
 	//memcpy(&ublox.year, (ublox_payload_addr + 4), sizeof(uint16_t));
 	//memcpy(&ublox.month, (ublox_payload_addr + 6), sizeof(uint8_t));
 	//memcpy(&ublox.day, (ublox_payload_addr + 7), sizeof(uint8_t));
@@ -249,8 +315,8 @@ void ublox_decode_nav_pvt_msg(void)
 	 * fix mode = 3D fix mode */
 	if((ublox.num_sv >= 6) && (ublox.fix_type == 3)) {
 		/* set ublox state to be available */
-		float curr_time = get_sys_time_s();
-		ublox.update_freq = 1.0f / (curr_time - ublox.last_read_time);
+		uint64_t curr_time = get_time_us();
+		ublox.update_freq = 1.0f / ((float)(curr_time - ublox.last_read_time) * 1e-6f);
 		ublox.last_read_time = curr_time;
 
 		float longitude = ublox.longitude * 1e-7;
@@ -264,15 +330,10 @@ void ublox_decode_nav_pvt_msg(void)
 	}
 }
 
-void ublox_decode_nav_sat_msg(void)
+static void ublox_decode_nav_sat_msg(ubx_parser_t *parser)
 {
-	/* check class value */
-	if(ublox.recept_class != 0x01) {
-		return;
-	}
-
-	uint8_t *ublox_payload_addr = ublox.recept_buf + 4; //skip header 4 bytes
-	uint8_t offset = 0;
+	uint8_t *ublox_payload_addr = parser->payload;
+	int offset = 0;
 
 	//uint32_t itow;
 	//uint8_t version;
@@ -284,10 +345,8 @@ void ublox_decode_nav_sat_msg(void)
 	memcpy(&num_svs, (ublox_payload_addr + 5), sizeof(uint8_t));
 	//memcpy(&reserved1, (ublox_payload_addr + 6), sizeof(uint16_t));
 
-	/* data length for calculating nav-sat is 4 <header> + (8 + 12*num_svs) <payload> */
-	uint8_t crc_data_len = 12 + (num_svs * 12);
-	ublox_checksum_calc(ublox.calc_ck, ublox.recept_buf, crc_data_len);
-	if(*(uint16_t *)ublox.calc_ck != *(uint16_t *)ublox.recept_ck) {
+	/* payload length is 8 + 12 * num_svs */
+	if(parser->len != 8 + (num_svs * 12)) {
 		return;
 	}
 
@@ -304,118 +363,147 @@ void ublox_decode_nav_sat_msg(void)
 	}
 }
 
-void ublox_m8n_gps_update(void)
+static bool ublox_m8n_payload_wanted(uint8_t msg_class, uint8_t msg_id)
 {
-	ublox_m8n_buf_c_t recept_c;
-
-#if 0   /* test print */
-	while(1) {
-		while(xQueueReceive(ublox_m8n_queue, &recept_c, 0) != pdTRUE);
-		uart_putc(USART3, recept_c.c);
+	if(msg_class == UBX_CLASS_NAV) {
+		return msg_id == UBX_ID_NAV_PVT || msg_id == UBX_ID_NAV_SAT;
+	} else if(msg_class == UBX_CLASS_ACK) {
+		return msg_id == UBX_ID_ACK_ACK || msg_id == UBX_ID_ACK_NAK;
 	}
-#endif
 
+	return false;
+}
+
+/* returns true if a message with valid checksum is received. the checksum
+ * is accumulated while receiving and only the payloads of the decoded
+ * messages are stored */
+static bool ublox_m8n_parse_char(ubx_parser_t *parser, uint8_t c)
+{
 	/* ubx message protocol:
 	   +---------+---------+-------+----+-----+----------+-----------+------------+
 	   | sync c1 | sync c2 | class | id | len | payloads | checksum1 | checksum 2 |
 	   +---------+---------+-------+----+-----+----------+-----------+------------+*/
 
-	bool ready_to_decode = false;
+	/* the checksum covers class, id, length and payload */
+	if(parser->state >= UBX_STATE_RECEIVE_CLASS && parser->state <= UBX_STATE_RECEIVE_PAYLOAD) {
+		parser->ck_a += c;
+		parser->ck_b += parser->ck_a;
+	}
 
-	while(xQueueReceive(ublox_m8n_queue, &recept_c, 0) == pdTRUE) {
-		/* buffer is full, need to be cleared or it may cause buffer overflow */
-		if(ublox.recept_buf_ptr >= (UBX_BUFFER_SIZE - 1)) {
-			ublox.recept_buf_ptr = 0;
+	switch(parser->state) {
+	case UBX_STATE_WAIT_SYNC_C1:
+		if(c == UBX_SYNC_C1) {
+			parser->state = UBX_STATE_WAIT_SYNC_C2;
 		}
+		break;
+	case UBX_STATE_WAIT_SYNC_C2:
+		if(c == UBX_SYNC_C2) {
+			parser->ck_a = 0;
+			parser->ck_b = 0;
+			parser->state = UBX_STATE_RECEIVE_CLASS;
+		} else if(c != UBX_SYNC_C1) {
+			parser->state = UBX_STATE_WAIT_SYNC_C1;
+		}
+		break;
+	case UBX_STATE_RECEIVE_CLASS:
+		parser->msg_class = c;
+		parser->state = UBX_STATE_RECEIVE_ID;
+		break;
+	case UBX_STATE_RECEIVE_ID:
+		parser->msg_id = c;
+		parser->state = UBX_STATE_RECEIVE_LEN1;
+		break;
+	case UBX_STATE_RECEIVE_LEN1:
+		parser->len = c;
+		parser->state = UBX_STATE_RECEIVE_LEN2;
+		break;
+	case UBX_STATE_RECEIVE_LEN2:
+		parser->len |= (uint16_t)c << 8;
+		parser->cnt = 0;
+		parser->store = ublox_m8n_payload_wanted(parser->msg_class, parser->msg_id) &&
+		                (parser->len <= UBX_PAYLOAD_BUF_SIZE);
+		parser->state = (parser->len > 0) ? UBX_STATE_RECEIVE_PAYLOAD : UBX_STATE_RECEIVE_CK1;
+		break;
+	case UBX_STATE_RECEIVE_PAYLOAD:
+		/* other messages are only checksummed */
+		if(parser->store == true) {
+			parser->payload[parser->cnt] = c;
+		}
+		parser->cnt++;
 
-		uint8_t c = recept_c.c;
-
-		/* reception */
-		switch(ublox.parse_state) {
-		case UBX_STATE_WAIT_SYNC_C1:
-			if(c == UBX_SYNC_C1) {
-				ublox.parse_state = UBX_STATE_WAIT_SYNC_C2;
-			}
-			break;
-		case UBX_STATE_WAIT_SYNC_C2:
-			if(c == UBX_SYNC_C2) {
-				ublox.parse_state = UBX_STATE_RECEIVE_CLASS;
-			} else {
-				ublox.parse_state = UBX_STATE_WAIT_SYNC_C1;
-			}
-			break;
-		case UBX_STATE_RECEIVE_CLASS:
-			ublox.recept_class = c;
-
-			/* save class to buffer for checksum calculation */
-			ublox.recept_buf_ptr = 0;
-			ublox.recept_buf[ublox.recept_buf_ptr] = c;
-			ublox.recept_buf_ptr++;
-
-			ublox.parse_state = UBX_STATE_RECEIVE_ID;
-
-			break;
-		case UBX_STATE_RECEIVE_ID:
-			ublox.recept_id = c;
-
-			/* save id to buffer for checksum calculation */
-			ublox.recept_buf[ublox.recept_buf_ptr] = c;
-			ublox.recept_buf_ptr++;
-
-			ublox.parse_state = UBX_STATE_RECEIVE_LEN1;
+		if(parser->cnt == parser->len) {
+			parser->state = UBX_STATE_RECEIVE_CK1;
+		}
+		break;
+	case UBX_STATE_RECEIVE_CK1:
+		if(c != parser->ck_a) {
+			parser->checksum_err_cnt++;
+			parser->state = (c == UBX_SYNC_C1) ? UBX_STATE_WAIT_SYNC_C2 : UBX_STATE_WAIT_SYNC_C1;
+		} else {
+			parser->state = UBX_STATE_RECEIVE_CK2;
+		}
+		break;
+	case UBX_STATE_RECEIVE_CK2:
+		if(c != parser->ck_b) {
+			parser->checksum_err_cnt++;
+			parser->state = (c == UBX_SYNC_C1) ? UBX_STATE_WAIT_SYNC_C2 : UBX_STATE_WAIT_SYNC_C1;
 			break;
-		case UBX_STATE_RECEIVE_LEN1:
-			ublox.recept_len_buf[0] = c;
+		}
 
-			/* save length to buffer for checksum calculation */
-			ublox.recept_buf[ublox.recept_buf_ptr] = c;
-			ublox.recept_buf_ptr++;
+		parser->state = UBX_STATE_WAIT_SYNC_C1;
+		parser->msg_cnt++;
+		return true;
+	}
 
-			ublox.parse_state = UBX_STATE_RECEIVE_LEN2;
-			break;
-		case UBX_STATE_RECEIVE_LEN2:
-			ublox.recept_len_buf[1] = c;
-			ublox.recept_len = *(uint16_t *)ublox.recept_len_buf;
+	return false;
+}
 
-			/* save length to buffer for checksum calculation */
-			ublox.recept_buf[ublox.recept_buf_ptr] = c;
-			ublox.recept_buf_ptr++;
+static void ublox_m8n_decode(ubx_parser_t *parser)
+{
+	if(parser->store == false) {
+		return;
+	}
 
-			ublox.parse_state = UBX_STATE_RECEIVE_PAYLOAD;
+	if(parser->msg_class == UBX_CLASS_NAV) {
+		switch(parser->msg_id) {
+		case UBX_ID_NAV_PVT:
+			ublox_decode_nav_pvt_msg(parser);
 			break;
-		case UBX_STATE_RECEIVE_PAYLOAD: {
-			/* reserve 4 for class, id and len */
-			if(ublox.recept_buf_ptr == (ublox.recept_len - 1 + 4)) {
-				ublox.recept_buf[ublox.recept_buf_ptr] = c;
-				ublox.parse_state = UBX_STATE_RECEIVE_CK1;
-			} else {
-				ublox.recept_buf[ublox.recept_buf_ptr] = c;
-				ublox.recept_buf_ptr++;
-			}
+		case UBX_ID_NAV_SAT:
+			ublox_decode_nav_sat_msg(parser);
 			break;
 		}
-		case UBX_STATE_RECEIVE_CK1:
-			ublox.recept_ck[0] = c;
-			ublox.parse_state = UBX_STATE_RECEIVE_CK2;
-			break;
-		case UBX_STATE_RECEIVE_CK2:
-			/* decode phase */
-			ublox.recept_ck[1] = c;
-			ublox.parse_state = UBX_STATE_WAIT_SYNC_C1;
-			ready_to_decode = true;
-		}
+	} else if(parser->msg_class == UBX_CLASS_ACK) {
+		ublox_decode_ack_msg(parser);
+	}
+}
 
-		/* decode */
-		if(ready_to_decode == true) {
-			switch(ublox.recept_id) {
-			case 0x07: /* ubx-nav-pvt */
-				ublox_decode_nav_pvt_msg();
-				break;
-			case 0x35: /* ubx-nav-sat */
-				ublox_decode_nav_sat_msg();
-				break;
-			}
-			ready_to_decode = false;
+void ublox_m8n_parse(uint8_t *data, int size)
+{
+	int i;
+	for(i = 0; i < size; i++) {
+		if(ublox_m8n_parse_char(&ublox.parser, data[i]) == true) {
+			ublox_m8n_decode(&ublox.parser);
 		}
 	}
 }
+
+void ublox_m8n_gps_update(void)
+{
+	uint8_t rx_buf[UBLOX_M8N_RX_READ_SIZE];
+	int rx_cnt;
+
+#if 0   /* test print */
+	while(1) {
+		rx_cnt = uart7_read(rx_buf, UBLOX_M8N_RX_READ_SIZE);
+		usart_puts(USART3, (char *)rx_buf, rx_cnt);
+	}
+#endif
+
+	/* drain the uart7 dma ring in chunks */
+	while((rx_cnt = uart7_read(rx_buf, UBLOX_M8N_RX_READ_SIZE)) > 0) {
+		ublox_m8n_parse(rx_buf, rx_cnt);
+	}
+
+	ublox_m8n_config_handler();
+}
@@ -1,11 +1,13 @@
 #ifndef __UBLOX_M8N_H__
 #define __UBLOX_M8N_H__
 
+#include <stdint.h>
 #include <stdbool.h>
 
 #define UBLOX_SV_NUM_MAX 255
 
-#define UBX_BUFFER_SIZE 2000
+/* payloads of the decoded messages, nav-sat of up to 166 satellites */
+#define UBX_PAYLOAD_BUF_SIZE 2000
 
 #define UBX_NAV_PVT_SET_LEN 16
 #define UBX_NAV_SAT_SET_LEN 16
@@ -19,6 +21,20 @@
 #define UBX_UTC_TIME_SET_LEN 14
 #define UBX_SAVE_ROM_CMD_LEN 21
 
+#define UBX_NAV_PVT_PAYLOAD_LEN 92
+#define UBX_ACK_PAYLOAD_LEN 2
+
+#define UBX_CLASS_NAV 0x01
+#define UBX_CLASS_ACK 0x05
+#define UBX_ID_NAV_PVT 0x07
+#define UBX_ID_NAV_SAT 0x35
+#define UBX_ID_ACK_NAK 0x00
+#define UBX_ID_ACK_ACK 0x01
+
+#define UBX_CFG_BOOT_WAIT_TIME 500000 //[us]
+#define UBX_CFG_ACK_TIMEOUT 200000    //[us]
+#define UBX_CFG_RETRY_MAX 3
+
 enum {
 	UBX_STATE_WAIT_SYNC_C1 = 0,
 	UBX_STATE_WAIT_SYNC_C2 = 1,
@@ -29,7 +45,36 @@ enum {
 	UBX_STATE_RECEIVE_PAYLOAD = 6,
 	UBX_STATE_RECEIVE_CK1 = 7,
 	UBX_STATE_RECEIVE_CK2 = 8
-} UBX_PARSE_STATE;
+};
+
+/* background configuration of the receiver */
+enum {
+	UBX_CFG_STATE_BOOT_WAIT = 0,
+	UBX_CFG_STATE_SEND = 1,
+	UBX_CFG_STATE_WAIT_ACK = 2,
+	UBX_CFG_STATE_DONE = 3
+};
+
+enum {
+	UBX_CFG_ACK_WAIT = 0,
+	UBX_CFG_ACK_RECEIVED = 1,
+	UBX_CFG_NAK_RECEIVED = 2
+};
+
+typedef struct {
+	int state;
+	uint8_t msg_class;
+	uint8_t msg_id;
+	uint16_t len;
+	uint16_t cnt;
+	uint8_t ck_a; //fletcher checksum, updated with every received byte
+	uint8_t ck_b;
+	bool store;   //the payload is kept for decoding
+	uint8_t payload[UBX_PAYLOAD_BUF_SIZE];
+
+	uint32_t msg_cnt;
+	uint32_t checksum_err_cnt;
+} ubx_parser_t;
 
 struct sat_payload_item {
 	uint8_t gnss_id;
@@ -42,15 +87,16 @@ struct sat_payload_item {
 };
 
 typedef struct {
-	int parse_state;
-	uint8_t recept_class;
-	uint8_t recept_id;
-	uint8_t recept_len_buf[2];
-	uint16_t recept_len;
-	uint8_t recept_ck[2];
-	uint8_t calc_ck[2];
-	uint8_t recept_buf[UBX_BUFFER_SIZE];
-	uint16_t recept_buf_ptr;
+	ubx_parser_t parser;
+
+	int cfg_state;
+	int cfg_index;
+	int cfg_ack;
+	int cfg_retry_cnt;
+	uint64_t cfg_time; //[us], time of the last transmission
+	uint32_t cfg_resend_cnt;
+	uint32_t cfg_nak_cnt;
+	uint32_t cfg_timeout_cnt;
 
 	uint16_t year;
 	uint8_t month;
@@ -75,14 +121,16 @@ typedef struct {
 
 	struct sat_payload_item sat_payload_list[UBLOX_SV_NUM_MAX];
 
-	float last_read_time;
+	uint64_t last_read_time; //[us]
 	float update_freq;
 } ublox_t;
 
 void ublox_m8n_init(void);
-void ublox_m8n_isr_handler(uint8_t c);
+bool ublox_m8n_config_done(void);
 bool ublox_available(void);
+void ublox_m8n_parse(uint8_t *data, int size);
 void ublox_m8n_gps_update(void);
+void ublox_decode_nav_pvt_payload(uint8_t *ublox_payload_addr);
 
 void ublox_m8n_get_longitude_latitude_height_s32(int32_t *longitude, int32_t *latitude, int32_t *height_msl);
 void ublox_m8n_get_longitude_latitude_height(float *longitude, float *latitude, float *height_msl);
@@ -11,104 +11,59 @@
 #include "vins_mono.h"
 #include "sys_time.h"
 #include "debug_link.h"
+#include "sensor_log.h"
+#include "frame_parser.h"
 
 #define VINS_MONO_IMU_MSG_SIZE 27
-#define VINS_MONO_CHECKSUM_INIT_VAL 19
-#define VINS_MONO_QUEUE_SIZE (44 * 100) //~400 packets
-
-typedef struct {
-	char c;
-} vins_mono_buf_c_t;
-
-QueueHandle_t vins_mono_queue;
+#define VINS_MONO_RX_READ_SIZE 64
 
 vins_mono_t vins_mono;
 
 void vins_mono_init(int id)
 {
 	vins_mono.id = id;
-	vins_mono_queue = xQueueCreate(VINS_MONO_QUEUE_SIZE, sizeof(vins_mono_buf_c_t));
+	frame_parser_init(&vins_mono.parser, vins_mono.buf, VINS_MONO_SERIAL_MSG_SIZE);
 }
 
 bool vins_mono_available(void)
 {
 	//timeout if no data available more than 300ms
-	float current_time = get_sys_time_ms();
-	if((current_time - vins_mono.time_now) > 300) {
+	if((get_time_us() - vins_mono.time_now) > 300000) {
 		return false;
 	}
 	return true;
 }
 
-#define VINS_MONO_CHECKSUM_INIT_VAL 19
-static uint8_t generate_vins_mono_checksum_byte(uint8_t *payload, int payload_cnt)
-{
-	uint8_t result = VINS_MONO_CHECKSUM_INIT_VAL;
-
-	int i;
-	for(i = 0; i < payload_cnt; i++)
-		result ^= payload[i];
-
-	return result;
-}
-
-void vins_mono_buf_push(uint8_t c)
-{
-	if(vins_mono.buf_pos >= VINS_MONO_SERIAL_MSG_SIZE) {
-		/* drop the oldest data and shift the rest to left */
-		int i;
-		for(i = 1; i < VINS_MONO_SERIAL_MSG_SIZE; i++) {
-			vins_mono.buf[i - 1] = vins_mono.buf[i];
-		}
-
-		/* save new byte to the last array element */
-		vins_mono.buf[VINS_MONO_SERIAL_MSG_SIZE - 1] = c;
-		vins_mono.buf_pos = VINS_MONO_SERIAL_MSG_SIZE;
-	} else {
-		/* append new byte if the array boundary is not yet reached */
-		vins_mono.buf[vins_mono.buf_pos] = c;
-		vins_mono.buf_pos++;
-	}
-}
-
-void vins_mono_isr_handler(uint8_t c)
-{
-	vins_mono_buf_c_t vins_mono_queue_item;
-	vins_mono_queue_item.c = c;
-
-	BaseType_t higher_priority_task_woken = pdFALSE;
-	xQueueSendToBackFromISR(vins_mono_queue, &vins_mono_queue_item,
-	                        &higher_priority_task_woken);
-	portEND_SWITCHING_ISR(higher_priority_task_woken);
-}
-
 void vins_mono_update(void)
 {
-	vins_mono_buf_c_t recept_c;
-	while(xQueueReceive(vins_mono_queue, &recept_c, 0) == pdTRUE) {
-		uint8_t c = recept_c.c;
+	uint8_t rx_buf[VINS_MONO_RX_READ_SIZE];
+	int rx_cnt, i;
+
+	/* drain the uart6 dma ring in chunks */
+	while((rx_cnt = uart6_read(rx_buf, VINS_MONO_RX_READ_SIZE)) > 0) {
+		for(i = 0; i < rx_cnt; i++) {
+			if(frame_parser_feed(&vins_mono.parser, rx_buf[i]) == false) {
+				continue;
+			}
 
-		vins_mono_buf_push(c);
-		if(c == '+' && vins_mono.buf[0] == '@') {
 			/* decode vins_mono message */
 			if(vins_mono_serial_decoder(vins_mono.buf) == 0) {
-				vins_mono.buf_pos = 0; //reset position pointer
+				sensor_log_write(SENSOR_LOG_VINS_MONO, vins_mono.buf,
+				                 VINS_MONO_SERIAL_MSG_SIZE);
 			}
 		}
-
 	}
 }
 
+/* decode a frame validated by the frame parser */
 int vins_mono_serial_decoder(uint8_t *buf)
 {
-	uint8_t recv_checksum = buf[1];
-	uint8_t checksum = generate_vins_mono_checksum_byte(&buf[3], VINS_MONO_SERIAL_MSG_SIZE - 4);
 	int recv_id = buf[2];
-	if(checksum != recv_checksum || vins_mono.id != recv_id) {
+	if(vins_mono.id != recv_id) {
 		return 1; //error detected
 	}
 
-	vins_mono.time_now = get_sys_time_ms();
+	vins_mono.time_now = get_time_us();
 
 	float q_enu[4];
 
@@ -137,7 +92,7 @@ int vins_mono_serial_decoder(uint8_t *buf)
 	vins_mono.vel_filtered[2] = vins_mono.vel_raw[2];
 
 	/* calculate update rate */
-	float received_period = (vins_mono.time_now - vins_mono.time_last) * 0.001;
+	float received_period = (float)(vins_mono.time_now - vins_mono.time_last) * 1e-6f;
 	vins_mono.update_rate = 1.0f / received_period;
 
 	/* save time for next iteration */
@@ -215,8 +170,8 @@ void send_vins_mono_imu_msg(void)
 	msg_buf[msg_pos] = '+'; //end byte
 	msg_pos += sizeof(uint8_t);
 
-	msg_buf[1] = generate_vins_mono_checksum_byte((uint8_t *)&msg_buf[3],
-	                VINS_MONO_IMU_MSG_SIZE - 3);
+	msg_buf[1] = frame_parser_checksum((uint8_t *)&msg_buf[3],
+	                                   VINS_MONO_IMU_MSG_SIZE - 3);
 
 	uart6_puts(msg_buf, VINS_MONO_IMU_MSG_SIZE);
 }
@@ -1,6 +1,8 @@
 #ifndef __VINS_MONO_H__
 #define __VINS_MONO_H__
 
+#include "frame_parser.h"
+
 #define VINS_MONO_SERIAL_MSG_SIZE 44
 
 typedef struct {
@@ -16,11 +18,11 @@ typedef struct {
 	/* orientation (quaternion) */
 	float q[4];
 
-	float time_now;
-	float time_last;
+	uint64_t time_now;  //[us]
+	uint64_t time_last; //[us]
 	float update_rate;
 
-	volatile int buf_pos;
+	frame_parser_t parser;
 	uint8_t buf[VINS_MONO_SERIAL_MSG_SIZE];
 	bool vel_ready;
 } vins_mono_t ;
@@ -30,7 +32,6 @@ void vins_mono_init(int id);
 
 /* reception of vins-mon pose and velocity information */
 int vins_mono_serial_decoder(uint8_t *buf);
-void vins_mono_isr_handler(uint8_t c);
 
 /* transmission of imu information for vins-mono */
 void send_vins_mono_imu_msg(void);
@@ -4,9 +4,25 @@
 #include "mpu6500.h"
 #include "ist8310.h"
 #include "debug_link.h"
+#include "se3_math.h"
+#include "imu_preint.h"
+#include "imu.h"
+
+/* single producer (imu interrupt), single consumer (flight control task) */
+static struct {
+	imu_sample_t buf[IMU_SAMPLE_QUEUE_SIZE];
+	uint32_t head; //only modified by the producer
+	uint32_t tail; //only modified by the consumer
+	uint32_t overflow_cnt;
+	uint32_t flushed_overflow_cnt; //overflows before the last flush
+} imu_sample_queue;
+
+/* integration of the queued samples, see imu_read_increments() */
+static imu_preint_t imu_preint;
 
 void imu_init(void)
 {
+	imu_preint_init(&imu_preint);
 	mpu6500_init();
 }
 
@@ -70,3 +86,76 @@ float get_imu_temperature(void)
 	return mpu6500_get_temperature();
 
 }
+
+/* called by the imu driver for every new sample, the sample is dropped if the
+ * queue is full */
+void imu_sample_push(float *accel, float *gyro, uint64_t time_us)
+{
+	uint32_t head = imu_sample_queue.head;
+	uint32_t tail = __atomic_load_n(&imu_sample_queue.tail, __ATOMIC_ACQUIRE);
+
+	if((head - tail) >= IMU_SAMPLE_QUEUE_SIZE) {
+		imu_sample_queue.overflow_cnt++;
+		return;
+	}
+
+	imu_sample_t *sample = &imu_sample_queue.buf[head & (IMU_SAMPLE_QUEUE_SIZE - 1)];
+	sample->accel[0] = accel[0];
+	sample->accel[1] = accel[1];
+	sample->accel[2] = accel[2];
+	sample->gyro[0] = gyro[0];
+	sample->gyro[1] = gyro[1];
+	sample->gyro[2] = gyro[2];
+	sample->time_us = time_us;
+
+	__atomic_store_n(&imu_sample_queue.head, head + 1, __ATOMIC_RELEASE);
+}
+
+/* pop the oldest sample, returns false if the queue is empty */
+bool imu_sample_pop(imu_sample_t *sample)
+{
+	uint32_t tail = imu_sample_queue.tail;
+	uint32_t head = __atomic_load_n(&imu_sample_queue.head, __ATOMIC_ACQUIRE);
+
+	if(tail == head) {
+		return false;
+	}
+
+	*sample = imu_sample_queue.buf[tail & (IMU_SAMPLE_QUEUE_SIZE - 1)];
+
+	__atomic_store_n(&imu_sample_queue.tail, tail + 1, __ATOMIC_RELEASE);
+
+	return true;
+}
+
+/* drop the queued samples, can only be called by the consumer */
+void imu_sample_flush(void)
+{
+	imu_sample_queue.flushed_overflow_cnt = imu_sample_queue.overflow_cnt;
+
+	uint32_t head = __atomic_load_n(&imu_sample_queue.head, __ATOMIC_ACQUIRE);
+	__atomic_store_n(&imu_sample_queue.tail, head, __ATOMIC_RELEASE);
+}
+
+uint32_t imu_sample_get_overflow_cnt(void)
+{
+	return imu_sample_queue.overflow_cnt - imu_sample_queue.flushed_overflow_cnt;
+}
+
+/* integrate the samples queued since the last call (1KHz) into the delta angle [rad]
+ * and delta velocity [m/s] with the coning and sculling compensation, dt is the
+ * length of the integrated interval [s]. can only be called by the consumer, returns
+ * false if no new sample is queued */
+bool imu_read_increments(float *delta_angle, float *delta_vel, float *dt)
+{
+	imu_sample_t sample;
+	while(imu_sample_pop(&sample) == true) {
+		float gyro_rad[3];
+		gyro_rad[0] = deg_to_rad(sample.gyro[0]);
+		gyro_rad[1] = deg_to_rad(sample.gyro[1]);
+		gyro_rad[2] = deg_to_rad(sample.gyro[2]);
+		imu_preint_update(&imu_preint, sample.accel, gyro_rad, sample.time_us);
+	}
+
+	return imu_preint_take(&imu_preint, delta_angle, delta_vel, dt);
+}
@@ -1,8 +1,19 @@
 #ifndef __IMU_H__
 #define __IMU_H__
 
+#include <stdint.h>
+#include <stdbool.h>
 #include "debug_link.h"
 
+#define IMU_SAMPLE_QUEUE_SIZE 32 //must be power of 2
+
+/* calibrated imu sample with the time it was sampled by the sensor */
+typedef struct {
+	float accel[3]; //[m/s^2]
+	float gyro[3];  //[deg/s]
+	uint64_t time_us; //[us], same clock as get_time_us()
+} imu_sample_t;
+
 void imu_init(void);
 bool imu_calibration_not_finished(void);
 
@@ -22,4 +33,11 @@ float get_gyro_update_rate(void);
 
 float get_imu_temperature(void);
 
+void imu_sample_push(float *accel, float *gyro, uint64_t time_us);
+bool imu_sample_pop(imu_sample_t *sample);
+void imu_sample_flush(void);
+uint32_t imu_sample_get_overflow_cnt(void);
+
+bool imu_read_increments(float *delta_angle, float *delta_vel, float *dt);
+
 #endif
@@ -0,0 +1,24 @@
+#ifndef __CYCLE_COUNTER_H__
+#define __CYCLE_COUNTER_H__
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+/* cpu cycle counter of the data watchpoint and trace unit (dwt), counts
+ * with the core clock and wraps around every ~23.8s at 180MHz */
+
+#define CYCLE_COUNTER_FREQ SystemCoreClock
+
+static inline void cycle_counter_init(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t get_cycle_count(void)
+{
+	return DWT->CYCCNT;
+}
+
+#endif
@@ -4,6 +4,8 @@
 #include "isr.h"
 #include "gpio.h"
 #include "mpu6500.h"
+#include "perf.h"
+#include "perf_list.h"
 
 void exti10_init(void)
 {
@@ -39,7 +41,9 @@ void exti10_init(void)
 void EXTI15_10_IRQHandler(void)
 {
 	if(EXTI_GetITStatus(EXTI_Line10) == SET) {
+		perf_start(PERF_IMU_ISR);
 		mpu6500_int_handler();
 		EXTI_ClearITPendingBit(EXTI_Line10);
+		perf_end(PERF_IMU_ISR);
 	}
 }
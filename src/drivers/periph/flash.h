@@ -1,6 +1,8 @@
 #ifndef __FLASH_H__
 #define __FLASH_H__
 
+#include <stdint.h>
+
 #define ADDR_FLASH_SECTOR_0  ((uint32_t)0x08000000) //base addrress of sector 0, 16KB
 #define ADDR_FLASH_SECTOR_1  ((uint32_t)0x08004000) //base addrress of sector 1, 16KB
 #define ADDR_FLASH_SECTOR_2  ((uint32_t)0x08008000) //base addrress of sector 2, 16KB
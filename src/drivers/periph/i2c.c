@@ -0,0 +1,294 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_conf.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "i2c.h"
+#include "isr.h"
+
+#define I2C2_CLOCK_SPEED 400000
+
+enum {
+	I2C_STATE_IDLE,
+	I2C_STATE_START,     //start condition of the register address write
+	I2C_STATE_REG,       //register address is being sent
+	I2C_STATE_RESTART,   //repeated start of the read
+	I2C_STATE_READ,      //bytes are read by the rxne interrupt
+	I2C_STATE_READ_BTF,  //waiting for the last two (three) bytes with the clock stretched
+	I2C_STATE_WRITE_DMA,
+	I2C_STATE_WRITE_LAST //last byte of the write is being sent
+} I2C_STATE;
+
+/* queued transactions of i2c2, the one at the head is in progress */
+static i2c_transaction_t *i2c2_queue[I2C2_TRANSACTION_QUEUE_SIZE];
+static uint32_t i2c2_queue_head;
+static uint32_t i2c2_queue_tail;
+
+static volatile int i2c2_state = I2C_STATE_IDLE;
+static int i2c2_read_cnt;
+
+/* <i2c2>
+ * usage: ist8310 (compass), see SELECT_COMPASS_I2C of proj_config.h
+ * scl: gpio_pin_b_10
+ * sda: gpio_pin_b_11
+ * rx: rxne interrupt, the i2c2 rx streams (dma1 stream2/3 channel7) are taken by the
+ *     uart4 (s-bus) and uart7 rx rings
+ * tx dma: dma1 channel7 stream7
+ *
+ * the reception follows the sequences of st an2824 that do not depend on the interrupt
+ * latency: the nack and the stop of the last byte are set while the clock is stretched
+ * (btf: one byte in dr and one in the shift register) or before the address flag is
+ * cleared. a late event interrupt (I2C_ISR_PRIORITY, below the imu and the system
+ * timer) therefore only slows down the transfer. the rxne interrupts of the bytes
+ * before are not time critical either, the bus is stretched while dr is full
+ */
+void i2c2_init(void)
+{
+	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOB, ENABLE);
+	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_I2C2, ENABLE);
+
+	GPIO_PinAFConfig(GPIOB, GPIO_PinSource10, GPIO_AF_I2C2);
+	GPIO_PinAFConfig(GPIOB, GPIO_PinSource11, GPIO_AF_I2C2);
+
+	GPIO_InitTypeDef GPIO_InitStruct = {
+		.GPIO_Pin = GPIO_Pin_10 | GPIO_Pin_11,
+		.GPIO_Mode = GPIO_Mode_AF,
+		.GPIO_Speed = GPIO_Speed_50MHz,
+		.GPIO_OType = GPIO_OType_OD,
+		.GPIO_PuPd = GPIO_PuPd_UP
+	};
+	GPIO_Init(GPIOB, &GPIO_InitStruct);
+
+	I2C_InitTypeDef I2C_InitStruct = {
+		.I2C_ClockSpeed = I2C2_CLOCK_SPEED,
+		.I2C_Mode = I2C_Mode_I2C,
+		.I2C_DutyCycle = I2C_DutyCycle_2,
+		.I2C_OwnAddress1 = 0x00,
+		.I2C_Ack = I2C_Ack_Enable,
+		.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit
+	};
+	I2C_Init(I2C2, &I2C_InitStruct);
+
+	NVIC_InitTypeDef NVIC_InitStruct = {
+		.NVIC_IRQChannel = I2C2_EV_IRQn,
+		.NVIC_IRQChannelPreemptionPriority = I2C_ISR_PRIORITY,
+		.NVIC_IRQChannelSubPriority = 0,
+		.NVIC_IRQChannelCmd = ENABLE
+	};
+	NVIC_Init(&NVIC_InitStruct);
+
+	NVIC_InitStruct.NVIC_IRQChannel = I2C2_ER_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+
+	NVIC_InitStruct.NVIC_IRQChannel = DMA1_Stream7_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+
+	I2C_ITConfig(I2C2, I2C_IT_EVT | I2C_IT_ERR, ENABLE);
+	I2C_Cmd(I2C2, ENABLE);
+}
+
+static void i2c2_tx_dma_start(uint8_t *data, int size)
+{
+	DMA_InitTypeDef DMA_InitStructure = {
+		.DMA_BufferSize = (uint32_t)size,
+		.DMA_FIFOMode = DMA_FIFOMode_Disable,
+		.DMA_FIFOThreshold = DMA_FIFOThreshold_Full,
+		.DMA_MemoryBurst = DMA_MemoryBurst_Single,
+		.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte,
+		.DMA_MemoryInc = DMA_MemoryInc_Enable,
+		.DMA_Mode = DMA_Mode_Normal,
+		.DMA_PeripheralBaseAddr = (uint32_t)(&I2C2->DR),
+		.DMA_PeripheralBurst = DMA_PeripheralBurst_Single,
+		.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+		.DMA_PeripheralInc = DMA_PeripheralInc_Disable,
+		.DMA_Priority = DMA_Priority_Medium,
+		.DMA_Channel = DMA_Channel_7,
+		.DMA_DIR = DMA_DIR_MemoryToPeripheral,
+		.DMA_Memory0BaseAddr = (uint32_t)data
+	};
+	DMA_Init(DMA1_Stream7, &DMA_InitStructure);
+	DMA_ITConfig(DMA1_Stream7, DMA_IT_TC, ENABLE);
+	DMA_Cmd(DMA1_Stream7, ENABLE);
+
+	I2C_DMACmd(I2C2, ENABLE);
+}
+
+static void i2c2_transaction_start(i2c_transaction_t *transaction)
+{
+	transaction->error = false;
+	i2c2_state = I2C_STATE_START;
+	I2C_NACKPositionConfig(I2C2, I2C_NACKPosition_Current);
+	I2C_AcknowledgeConfig(I2C2, ENABLE);
+	I2C_GenerateSTART(I2C2, ENABLE);
+}
+
+/* queue a transaction of i2c2, it is started immediately if the bus is idle.
+ * callable from the tasks and the interrupts up to the syscall priority,
+ * returns false if the queue is full. the data buffer must stay valid until
+ * the busy flag is cleared */
+bool i2c2_transaction_submit(i2c_transaction_t *transaction)
+{
+	UBaseType_t int_mask = taskENTER_CRITICAL_FROM_ISR();
+
+	if((i2c2_queue_tail - i2c2_queue_head) >= I2C2_TRANSACTION_QUEUE_SIZE) {
+		taskEXIT_CRITICAL_FROM_ISR(int_mask);
+		return false;
+	}
+
+	transaction->busy = true;
+	i2c2_queue[i2c2_queue_tail % I2C2_TRANSACTION_QUEUE_SIZE] = transaction;
+	i2c2_queue_tail++;
+
+	if((i2c2_queue_tail - i2c2_queue_head) == 1) {
+		i2c2_transaction_start(transaction);
+	}
+
+	taskEXIT_CRITICAL_FROM_ISR(int_mask);
+
+	return true;
+}
+
+static void i2c2_transaction_complete(bool error)
+{
+	i2c_transaction_t *transaction = i2c2_queue[i2c2_queue_head % I2C2_TRANSACTION_QUEUE_SIZE];
+	i2c2_queue_head++;
+
+	transaction->error = error;
+	transaction->busy = false;
+	i2c2_state = I2C_STATE_IDLE;
+
+	if(i2c2_queue_tail != i2c2_queue_head) {
+		i2c2_transaction_start(i2c2_queue[i2c2_queue_head % I2C2_TRANSACTION_QUEUE_SIZE]);
+	}
+
+	BaseType_t higher_priority_task_woken = pdFALSE;
+	if(transaction->callback != NULL) {
+		transaction->callback(transaction, &higher_priority_task_woken);
+	}
+	portEND_SWITCHING_ISR(higher_priority_task_woken);
+}
+
+void I2C2_EV_IRQHandler(void)
+{
+	i2c_transaction_t *transaction = i2c2_queue[i2c2_queue_head % I2C2_TRANSACTION_QUEUE_SIZE];
+	uint16_t sr1 = I2C2->SR1;
+
+	if(sr1 & I2C_SR1_SB) {
+		/* start condition is generated, send the slave address */
+		if(i2c2_state == I2C_STATE_START) {
+			I2C_Send7bitAddress(I2C2, transaction->addr << 1, I2C_Direction_Transmitter);
+		} else {
+			I2C_Send7bitAddress(I2C2, transaction->addr << 1, I2C_Direction_Receiver);
+		}
+	} else if(sr1 & I2C_SR1_ADDR) {
+		if(i2c2_state == I2C_STATE_START) {
+			/* write the register address, the flag is cleared by reading sr2 */
+			(void)I2C2->SR2;
+			I2C_SendData(I2C2, transaction->reg);
+			i2c2_state = I2C_STATE_REG;
+		} else {
+			i2c2_read_cnt = 0;
+			if(transaction->size == 1) {
+				/* single byte read: nack and stop have to be set
+				 * before the address flag is cleared */
+				I2C_AcknowledgeConfig(I2C2, DISABLE);
+				(void)I2C2->SR2;
+				I2C_GenerateSTOP(I2C2, ENABLE);
+				I2C_ITConfig(I2C2, I2C_IT_BUF, ENABLE);
+				i2c2_state = I2C_STATE_READ;
+			} else if(transaction->size == 2) {
+				/* two byte read: the nack applies to the byte in the
+				 * shift register (pos), both bytes wait for btf */
+				I2C_NACKPositionConfig(I2C2, I2C_NACKPosition_Next);
+				I2C_AcknowledgeConfig(I2C2, DISABLE);
+				(void)I2C2->SR2;
+				i2c2_state = I2C_STATE_READ_BTF;
+			} else if(transaction->size == 3) {
+				(void)I2C2->SR2;
+				i2c2_state = I2C_STATE_READ_BTF;
+			} else {
+				(void)I2C2->SR2;
+				I2C_ITConfig(I2C2, I2C_IT_BUF, ENABLE);
+				i2c2_state = I2C_STATE_READ;
+			}
+		}
+	} else if(sr1 & I2C_SR1_RXNE && i2c2_state == I2C_STATE_READ) {
+		transaction->data[i2c2_read_cnt++] = I2C_ReceiveData(I2C2);
+
+		if(i2c2_read_cnt == transaction->size) {
+			I2C_ITConfig(I2C2, I2C_IT_BUF, DISABLE);
+			i2c2_transaction_complete(false);
+		} else if(i2c2_read_cnt == transaction->size - 3) {
+			/* the last three bytes are handled with btf, the rxne
+			 * interrupt is masked until then */
+			I2C_ITConfig(I2C2, I2C_IT_BUF, DISABLE);
+			i2c2_state = I2C_STATE_READ_BTF;
+		}
+	} else if(sr1 & I2C_SR1_BTF && i2c2_state == I2C_STATE_READ_BTF) {
+		/* data n-2 (n-1) is in dr and data n-1 (n) in the shift register,
+		 * the clock is stretched until dr is read */
+		if(transaction->size == 2) {
+			I2C_GenerateSTOP(I2C2, ENABLE);
+			transaction->data[0] = I2C_ReceiveData(I2C2);
+			transaction->data[1] = I2C_ReceiveData(I2C2);
+			I2C_NACKPositionConfig(I2C2, I2C_NACKPosition_Current);
+			i2c2_transaction_complete(false);
+		} else {
+			/* nack the last byte, then stop after it */
+			I2C_AcknowledgeConfig(I2C2, DISABLE);
+			transaction->data[i2c2_read_cnt++] = I2C_ReceiveData(I2C2);
+			I2C_GenerateSTOP(I2C2, ENABLE);
+			transaction->data[i2c2_read_cnt++] = I2C_ReceiveData(I2C2);
+			I2C_ITConfig(I2C2, I2C_IT_BUF, ENABLE);
+			i2c2_state = I2C_STATE_READ;
+		}
+	} else if(sr1 & I2C_SR1_BTF) {
+		if(i2c2_state == I2C_STATE_REG) {
+			if(transaction->read == true) {
+				I2C_GenerateSTART(I2C2, ENABLE);
+				i2c2_state = I2C_STATE_RESTART;
+			} else if(transaction->size > 0) {
+				i2c2_tx_dma_start(transaction->data, transaction->size);
+				i2c2_state = I2C_STATE_WRITE_DMA;
+			} else {
+				I2C_GenerateSTOP(I2C2, ENABLE);
+				i2c2_transaction_complete(false);
+			}
+		} else if(i2c2_state == I2C_STATE_WRITE_LAST) {
+			/* the flag is cleared by the stop condition */
+			I2C_GenerateSTOP(I2C2, ENABLE);
+			i2c2_transaction_complete(false);
+		}
+	}
+}
+
+void I2C2_ER_IRQHandler(void)
+{
+	/* nack, bus error, arbitration lost or overrun: release the bus and
+	 * complete the transaction with the error flag */
+	I2C_ClearITPendingBit(I2C2, I2C_IT_AF | I2C_IT_BERR | I2C_IT_ARLO | I2C_IT_OVR);
+
+	I2C_ITConfig(I2C2, I2C_IT_BUF, DISABLE);
+	I2C_DMACmd(I2C2, DISABLE);
+	DMA_Cmd(DMA1_Stream7, DISABLE);
+	I2C_NACKPositionConfig(I2C2, I2C_NACKPosition_Current);
+
+	I2C_GenerateSTOP(I2C2, ENABLE);
+
+	if(i2c2_state != I2C_STATE_IDLE) {
+		i2c2_transaction_complete(true);
+	}
+}
+
+void DMA1_Stream7_IRQHandler(void)
+{
+	/* i2c2 tx dma, the last byte is loaded into the data register. the stop
+	 * condition is generated after it is shifted out (btf) */
+	if(DMA_GetITStatus(DMA1_Stream7, DMA_IT_TCIF7) == SET) {
+		DMA_ClearITPendingBit(DMA1_Stream7, DMA_IT_TCIF7);
+
+		I2C_DMACmd(I2C2, DISABLE);
+		i2c2_state = I2C_STATE_WRITE_LAST;
+	}
+}
@@ -0,0 +1,33 @@
+#ifndef __I2C_H__
+#define __I2C_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+
+#define I2C2_TRANSACTION_QUEUE_SIZE 4
+
+typedef struct i2c_transaction i2c_transaction_t;
+
+typedef void (*i2c_transaction_callback_t)(i2c_transaction_t *transaction,
+                BaseType_t *higher_priority_task_woken);
+
+/* register access of a 7-bit address device: the register address is
+ * written first, then the data is written or read after a repeated start */
+struct i2c_transaction {
+	uint8_t addr;
+	uint8_t reg;
+	uint8_t *data;
+	int size;
+	bool read;
+
+	i2c_transaction_callback_t callback; //optional, called by the interrupt
+
+	volatile bool busy;  //set by the submission, cleared on completion
+	volatile bool error; //nack, bus error or arbitration lost
+};
+
+void i2c2_init(void);
+bool i2c2_transaction_submit(i2c_transaction_t *transaction);
+
+#endif
@@ -9,12 +9,13 @@
 #define SYS_TIMER_ISR_PRIORITY (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 0)
 
 #define IMU_EXTI_ISR_PRIORITY (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1)
+#define IMU_SPI_DMA_ISR_PRIORITY (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1)
 
 #define BAROMETER_ISR_PRIORITY (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 2)
 #define SW_I2C_TIMER_ISR_PRIORITY (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 2)
+#define I2C_ISR_PRIORITY (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 2)
 
 #define GPS_OPTITRACK_UART_ISR (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 3)
-#define GPS_UART_TX_ISR (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 3)
 #define UART6_RX_ISR_PRIORITY (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 3)
 
 #define SBUS_ISR_PRIORITY (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 4)
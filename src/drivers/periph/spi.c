@@ -1,11 +1,17 @@
 #include <stdbool.h>
 #include "stm32f4xx_conf.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "spi.h"
+#include "isr.h"
+#include "mpu6500.h"
+#include "perf.h"
+#include "perf_list.h"
 
-SemaphoreHandle_t spi3_tx_semphr;
-SemaphoreHandle_t spi3_rx_semphr;
-
-uint8_t spi3_tx_buf;
-uint8_t spi3_rx_buf;
+/* queued transactions of spi3, the one at the head is in progress */
+static spi_transaction_t *spi3_queue[SPI3_TRANSACTION_QUEUE_SIZE];
+static uint32_t spi3_queue_head;
+static uint32_t spi3_queue_tail;
 
 /* <spi1>
  * usage: mpu6500 (imu)
@@ -13,10 +19,13 @@ uint8_t spi3_rx_buf;
  * sck: gpio_pin_a_5
  * miso: gpio_pin_a_6
  * mosi: gpio_pin_a_7
+ * rx dma: dma2 channel3 stream0
+ * tx dma: dma2 channel3 stream3
  */
 void spi1_init(void)
 {
 	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOA, ENABLE);
+	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2, ENABLE);
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_SPI1, ENABLE);
 
 	GPIO_PinAFConfig(GPIOA, GPIO_PinSource5, GPIO_AF_SPI1);
@@ -51,6 +60,14 @@ void spi1_init(void)
 	};
 	SPI_Init(SPI1, &SPI_InitStruct);
 
+	NVIC_InitTypeDef NVIC_InitStruct = {
+		.NVIC_IRQChannel = DMA2_Stream0_IRQn,
+		.NVIC_IRQChannelPreemptionPriority = IMU_SPI_DMA_ISR_PRIORITY,
+		.NVIC_IRQChannelSubPriority = 0,
+		.NVIC_IRQChannelCmd = ENABLE
+	};
+	NVIC_Init(&NVIC_InitStruct);
+
 	SPI_Cmd(SPI1, ENABLE);
 }
 
@@ -60,14 +77,14 @@ void spi1_init(void)
  * sck: gpio_pin_b_3
  * miso: gpio_pin_b_4
  * mosi: gpio_pin_b_5
+ * rx dma: dma1 channel0 stream0
+ * tx dma: dma1 channel0 stream5
  */
 void spi3_init(void)
 {
-	spi3_tx_semphr = xSemaphoreCreateBinary();
-	spi3_rx_semphr = xSemaphoreCreateBinary();
-
 	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOA, ENABLE);
 	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOB, ENABLE);
+	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
 	RCC_APB1PeriphClockCmd(RCC_APB1Periph_SPI3, ENABLE);
 
 	GPIO_PinAFConfig(GPIOB, GPIO_PinSource3, GPIO_AF_SPI3);
@@ -102,15 +119,14 @@ void spi3_init(void)
 	};
 	SPI_Init(SPI3, &SPI_InitStruct);
 
-#if 0
 	NVIC_InitTypeDef NVIC_InitStruct = {
-		.NVIC_IRQChannel = SPI3_IRQn,
+		.NVIC_IRQChannel = DMA1_Stream0_IRQn,
 		.NVIC_IRQChannelPreemptionPriority = BAROMETER_ISR_PRIORITY,
 		.NVIC_IRQChannelSubPriority = 0,
 		.NVIC_IRQChannelCmd = ENABLE
 	};
 	NVIC_Init(&NVIC_InitStruct);
-#endif
+
 	SPI_Cmd(SPI3, ENABLE);
 }
 
@@ -123,34 +139,149 @@ uint8_t spi_read_write(SPI_TypeDef *spi_channel, uint8_t data)
 	return SPI_I2S_ReceiveData(spi_channel);
 }
 
-void SPI3_IRQHandler(void)
+/* start a full-duplex transfer of spi1 with dma and return immediately, the
+ * completion is signaled by the rx dma interrupt. the caller has to wait for
+ * the completion before starting the next transfer */
+void spi1_dma_read_write(uint8_t *tx_buf, uint8_t *rx_buf, int size)
+{
+	DMA_ClearFlag(DMA2_Stream0, DMA_FLAG_TCIF0 | DMA_FLAG_HTIF0 | DMA_FLAG_TEIF0 |
+	              DMA_FLAG_DMEIF0 | DMA_FLAG_FEIF0);
+	DMA_ClearFlag(DMA2_Stream3, DMA_FLAG_TCIF3 | DMA_FLAG_HTIF3 | DMA_FLAG_TEIF3 |
+	              DMA_FLAG_DMEIF3 | DMA_FLAG_FEIF3);
+
+	//spi1 rx: dma2 channel3 stream0
+	DMA_InitTypeDef DMA_InitStructure = {
+		.DMA_BufferSize = (uint32_t)size,
+		.DMA_FIFOMode = DMA_FIFOMode_Disable,
+		.DMA_FIFOThreshold = DMA_FIFOThreshold_Full,
+		.DMA_MemoryBurst = DMA_MemoryBurst_Single,
+		.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte,
+		.DMA_MemoryInc = DMA_MemoryInc_Enable,
+		.DMA_Mode = DMA_Mode_Normal,
+		.DMA_PeripheralBaseAddr = (uint32_t)(&SPI1->DR),
+		.DMA_PeripheralBurst = DMA_PeripheralBurst_Single,
+		.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+		.DMA_PeripheralInc = DMA_PeripheralInc_Disable,
+		.DMA_Priority = DMA_Priority_High,
+		.DMA_Channel = DMA_Channel_3,
+		.DMA_DIR = DMA_DIR_PeripheralToMemory,
+		.DMA_Memory0BaseAddr = (uint32_t)rx_buf
+	};
+	DMA_Init(DMA2_Stream0, &DMA_InitStructure);
+	DMA_ITConfig(DMA2_Stream0, DMA_IT_TC, ENABLE);
+
+	//spi1 tx: dma2 channel3 stream3
+	DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+	DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)tx_buf;
+	DMA_Init(DMA2_Stream3, &DMA_InitStructure);
+
+	//enable the rx stream first so no received byte is missed
+	DMA_Cmd(DMA2_Stream0, ENABLE);
+	DMA_Cmd(DMA2_Stream3, ENABLE);
+	SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+}
+
+void DMA2_Stream0_IRQHandler(void)
 {
-	BaseType_t higher_priority_task_woken = pdFALSE;
+	/* spi1 rx dma, the last byte of the transfer is received */
+	if(DMA_GetITStatus(DMA2_Stream0, DMA_IT_TCIF0) == SET) {
+		DMA_ClearITPendingBit(DMA2_Stream0, DMA_IT_TCIF0);
+		SPI_I2S_DMACmd(SPI1, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
 
-	if(SPI_GetITStatus(SPI3, SPI_I2S_IT_TXE) == SET) {
-		SPI_I2S_SendData(SPI3, spi3_tx_buf);
-		SPI_I2S_ITConfig(SPI3, SPI_I2S_IT_TXE, DISABLE);
-		xSemaphoreGiveFromISR(spi3_tx_semphr, &higher_priority_task_woken);
+		perf_start(PERF_IMU_SPI_DMA_ISR);
+		mpu6500_burst_read_handler();
+		perf_end(PERF_IMU_SPI_DMA_ISR);
 	}
+}
+
+static void spi3_transaction_start(spi_transaction_t *transaction)
+{
+	GPIO_ResetBits(transaction->cs_gpio, transaction->cs_pin);
+
+	DMA_ClearFlag(DMA1_Stream0, DMA_FLAG_TCIF0 | DMA_FLAG_HTIF0 | DMA_FLAG_TEIF0 |
+	              DMA_FLAG_DMEIF0 | DMA_FLAG_FEIF0);
+	DMA_ClearFlag(DMA1_Stream5, DMA_FLAG_TCIF5 | DMA_FLAG_HTIF5 | DMA_FLAG_TEIF5 |
+	              DMA_FLAG_DMEIF5 | DMA_FLAG_FEIF5);
+
+	//spi3 rx: dma1 channel0 stream0
+	DMA_InitTypeDef DMA_InitStructure = {
+		.DMA_BufferSize = (uint32_t)transaction->size,
+		.DMA_FIFOMode = DMA_FIFOMode_Disable,
+		.DMA_FIFOThreshold = DMA_FIFOThreshold_Full,
+		.DMA_MemoryBurst = DMA_MemoryBurst_Single,
+		.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte,
+		.DMA_MemoryInc = DMA_MemoryInc_Enable,
+		.DMA_Mode = DMA_Mode_Normal,
+		.DMA_PeripheralBaseAddr = (uint32_t)(&SPI3->DR),
+		.DMA_PeripheralBurst = DMA_PeripheralBurst_Single,
+		.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte,
+		.DMA_PeripheralInc = DMA_PeripheralInc_Disable,
+		.DMA_Priority = DMA_Priority_Medium,
+		.DMA_Channel = DMA_Channel_0,
+		.DMA_DIR = DMA_DIR_PeripheralToMemory,
+		.DMA_Memory0BaseAddr = (uint32_t)transaction->rx_buf
+	};
+	DMA_Init(DMA1_Stream0, &DMA_InitStructure);
+	DMA_ITConfig(DMA1_Stream0, DMA_IT_TC, ENABLE);
+
+	//spi3 tx: dma1 channel0 stream5
+	DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+	DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)transaction->tx_buf;
+	DMA_Init(DMA1_Stream5, &DMA_InitStructure);
+
+	DMA_Cmd(DMA1_Stream0, ENABLE);
+	DMA_Cmd(DMA1_Stream5, ENABLE);
+	SPI_I2S_DMACmd(SPI3, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, ENABLE);
+}
+
+/* queue a transaction of spi3, it is started immediately if the bus is idle.
+ * callable from the tasks and the interrupts up to the syscall priority,
+ * returns false if the queue is full. the buffers must stay valid until the
+ * busy flag is cleared */
+bool spi3_transaction_submit(spi_transaction_t *transaction)
+{
+	UBaseType_t int_mask = taskENTER_CRITICAL_FROM_ISR();
+
+	if((spi3_queue_tail - spi3_queue_head) >= SPI3_TRANSACTION_QUEUE_SIZE) {
+		taskEXIT_CRITICAL_FROM_ISR(int_mask);
+		return false;
+	}
+
+	transaction->busy = true;
+	spi3_queue[spi3_queue_tail % SPI3_TRANSACTION_QUEUE_SIZE] = transaction;
+	spi3_queue_tail++;
 
-	if(SPI_GetITStatus(SPI3, SPI_I2S_IT_RXNE) == SET) {
-		spi3_rx_buf = SPI_I2S_ReceiveData(SPI3);
-		SPI_I2S_ITConfig(SPI3, SPI_I2S_IT_RXNE, DISABLE);
-		xSemaphoreGiveFromISR(spi3_rx_semphr, &higher_priority_task_woken);
+	if((spi3_queue_tail - spi3_queue_head) == 1) {
+		spi3_transaction_start(transaction);
 	}
 
-	portEND_SWITCHING_ISR(higher_priority_task_woken);
+	taskEXIT_CRITICAL_FROM_ISR(int_mask);
+
+	return true;
 }
 
-uint8_t spi3_read_write(uint8_t data)
+void DMA1_Stream0_IRQHandler(void)
 {
-	spi3_tx_buf = data;
+	/* spi3 rx dma, the last byte of the transaction is received */
+	if(DMA_GetITStatus(DMA1_Stream0, DMA_IT_TCIF0) == SET) {
+		DMA_ClearITPendingBit(DMA1_Stream0, DMA_IT_TCIF0);
+		SPI_I2S_DMACmd(SPI3, SPI_I2S_DMAReq_Rx | SPI_I2S_DMAReq_Tx, DISABLE);
 
-	SPI_I2S_ITConfig(SPI3, SPI_I2S_IT_TXE, ENABLE);
-	xSemaphoreTake(spi3_tx_semphr, portMAX_DELAY);
+		spi_transaction_t *transaction = spi3_queue[spi3_queue_head % SPI3_TRANSACTION_QUEUE_SIZE];
+		GPIO_SetBits(transaction->cs_gpio, transaction->cs_pin);
+		spi3_queue_head++;
+		transaction->busy = false;
 
-	SPI_I2S_ITConfig(SPI3, SPI_I2S_IT_RXNE, ENABLE);
-	xSemaphoreTake(spi3_rx_semphr, portMAX_DELAY);
+		/* start the next transaction before the callback so the bus is not
+		 * idle while the callback is processing */
+		if(spi3_queue_tail != spi3_queue_head) {
+			spi3_transaction_start(spi3_queue[spi3_queue_head % SPI3_TRANSACTION_QUEUE_SIZE]);
+		}
 
-	return spi3_rx_buf;
+		BaseType_t higher_priority_task_woken = pdFALSE;
+		if(transaction->callback != NULL) {
+			transaction->callback(transaction, &higher_priority_task_woken);
+		}
+		portEND_SWITCHING_ISR(higher_priority_task_woken);
+	}
 }
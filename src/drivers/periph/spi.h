@@ -1,10 +1,38 @@
 #ifndef __SPI_H__
 #define __SPI_H__
 
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx.h"
+#include "FreeRTOS.h"
+
+#define SPI3_TRANSACTION_QUEUE_SIZE 4
+
+typedef struct spi_transaction spi_transaction_t;
+
+typedef void (*spi_transaction_callback_t)(spi_transaction_t *transaction,
+                BaseType_t *higher_priority_task_woken);
+
+/* full-duplex transfer framed by the chip select, the callback is called by
+ * the dma interrupt after the chip select is released */
+struct spi_transaction {
+	uint8_t *tx_buf;
+	uint8_t *rx_buf;
+	int size;
+
+	GPIO_TypeDef *cs_gpio;
+	uint16_t cs_pin;
+
+	spi_transaction_callback_t callback; //optional
+
+	volatile bool busy; //set by the submission, cleared on completion
+};
+
 void spi1_init(void);
 void spi3_init(void);
 
 uint8_t spi_read_write(SPI_TypeDef *spi_channel, uint8_t data);
-uint8_t spi3_read_write(uint8_t data);
+void spi1_dma_read_write(uint8_t *tx_buf, uint8_t *rx_buf, int size);
+bool spi3_transaction_submit(spi_transaction_t *transaction);
 
 #endif
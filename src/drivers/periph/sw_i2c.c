@@ -31,7 +31,7 @@ void sw_i2c_handler(void);
 SemaphoreHandle_t sw_i2c_semphr;
 
 volatile int i2c_state = SW_I2C_DO_NOTHING;
-float coroutine_delay_start_time = 0;
+uint64_t coroutine_delay_start_time = 0; //[us]
 float coroutine_delay_time = 0;
 uint8_t sw_i2c_recpt_data;
 uint8_t sw_i2c_send_data;
@@ -148,14 +148,14 @@ uint8_t sw_i2c_sda_read(void)
 
 void sw_i2c_coroutine_delay_start(float delay_ms)
 {
-	coroutine_delay_start_time = get_sys_time_ms();
+	coroutine_delay_start_time = get_time_us();
 	coroutine_delay_time = delay_ms;
 }
 
 bool sw_i2c_coroutine_delay_times_up(void)
 {
-	float curr_time = get_sys_time_ms();
-	float elapsed_time = curr_time - coroutine_delay_start_time;
+	/* elapsed time of the 64-bit timestamps, exact after long uptimes */
+	float elapsed_time = (float)(get_time_us() - coroutine_delay_start_time) * 1e-3f;
 	if(elapsed_time >= coroutine_delay_time) {
 		return true;
 	} else {
@@ -324,12 +324,10 @@ void sw_i2c_wait_ack_handler(void)
 	sw_i2c_scl_set_high();
 	SW_I2C_COROUTINE_DELAY(I2C_CLOCK_PERIOD_MS);
 
-	float start_time = get_sys_time_ms();
-	float curr_time;
+	uint64_t start_time = get_time_us();
 	float elapsed_time;
 	while(sw_i2c_sda_read()) {
-		curr_time = get_sys_time_ms();
-		elapsed_time = curr_time - start_time;
+		elapsed_time = (float)(get_time_us() - start_time) * 1e-3f;
 		if(elapsed_time >= I2C_CLOCK_PERIOD_MS) {
 			/* failed */
 			break;
@@ -442,11 +440,10 @@ void sw_i2c_send_byte(uint8_t data)
 /**************************************************************/
 void sw_i2c_delay_ms(float delay_ms)
 {
-	float start_time = get_sys_time_ms();
+	uint64_t start_time = get_time_us();
 
 	while(1) {
-		float curr_time = get_sys_time_ms();
-		float elapsed_time = curr_time - start_time;
+		float elapsed_time = (float)(get_time_us() - start_time) * 1e-3f;
 		if(elapsed_time >= delay_ms) {
 			return;
 		}
@@ -494,12 +491,10 @@ bool sw_i2c_blocked_wait_ack(void)
 	sw_i2c_scl_set_high();
 	sw_i2c_delay_ms(I2C_CLOCK_PERIOD_MS);
 
-	float start_time = get_sys_time_ms();
-	float curr_time;
+	uint64_t start_time = get_time_us();
 	float elapsed_time;
 	while(sw_i2c_sda_read()) {
-		curr_time = get_sys_time_ms();
-		elapsed_time = curr_time - start_time;
+		elapsed_time = (float)(get_time_us() - start_time) * 1e-3f;
 		if(elapsed_time >= I2C_CLOCK_PERIOD_MS) {
 			/* failed */
 			sw_i2c_scl_set_low();
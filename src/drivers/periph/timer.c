@@ -9,88 +9,128 @@
 #include "led.h"
 #include "ms5611.h"
 #include "ist8310.h"
+#include "mpu6500.h"
 #include "proj_config.h"
 #include "debug_link_task.h"
 #include "dummy_sensors.h"
+#include "perf.h"
+#include "perf_list.h"
+
+/* compare periods of timer5 in microseconds */
+#define FLIGHT_CTL_PERIOD_US             2500  //400Hz
+#define LED_CTRL_PERIOD_US               40000 //25Hz
+#define IMU_FIFO_PERIOD_US               1000  //1KHz
 
-#define FLIGHT_CTL_PRESCALER_RELOAD      1000  //400Hz
-#define LED_CTRL_PRESCALER_RELOAD        16000 //25Hz
 #define COMPASS_PRESCALER_RELOAD         8     //50Hz
 #define BAROMETER_PRESCALER_RELOAD       4     //100Hz
 
 extern SemaphoreHandle_t flight_ctl_semphr;
 
-void timer12_init(void)
+void timer3_init(void)
 {
-	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM12, ENABLE);
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
 
-	/* 90MHz / (225 * 1) = 400000Hz */
+	/* 90MHz / (225000 * 10) = 400Hz */
 	TIM_TimeBaseInitTypeDef TimeBaseInitStruct = {
-		.TIM_Period = 225 - 1,
-		.TIM_Prescaler = 1 - 1,
+		.TIM_Period = 22500 - 1,
+		.TIM_Prescaler = 10 - 1,
 		.TIM_CounterMode = TIM_CounterMode_Up
 	};
-	TIM_TimeBaseInit(TIM12, &TimeBaseInitStruct);
+	TIM_TimeBaseInit(TIM3, &TimeBaseInitStruct);
 
 	NVIC_InitTypeDef NVIC_InitStruct = {
-		.NVIC_IRQChannel = TIM8_BRK_TIM12_IRQn,
-		.NVIC_IRQChannelPreemptionPriority = SYS_TIMER_ISR_PRIORITY,
+		.NVIC_IRQChannel = TIM3_IRQn,
+		.NVIC_IRQChannelPreemptionPriority = BAROMETER_ISR_PRIORITY,
 		.NVIC_IRQChannelCmd = ENABLE
 	};
 	NVIC_Init(&NVIC_InitStruct);
 
-	TIM_ITConfig(TIM12, TIM_IT_Update, ENABLE);
-	TIM_Cmd(TIM12, ENABLE);
+	TIM_ITConfig(TIM3, TIM_IT_Update, ENABLE);
+	TIM_Cmd(TIM3, ENABLE);
+
 }
 
-void timer3_init(void)
+/* free running 32-bit counter of the system time (see sys_time.c) and the run
+ * time statistics of freertos. the periodic handlers are triggered by the
+ * compare channels, each compare value is advanced by its period in the
+ * interrupt so the triggers do not drift:
+ * channel1: flight controller (400Hz)
+ * channel2: mpu6500 fifo drain (1KHz)
+ * channel3: rgb led (25Hz) */
+void timer5_init(void)
 {
-	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3, ENABLE);
+	RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM5, ENABLE);
 
-	/* 90MHz / (225000 * 10) = 400Hz */
+	/* 90MHz / 90 = 1MHz, wraps around every 71 minutes */
 	TIM_TimeBaseInitTypeDef TimeBaseInitStruct = {
-		.TIM_Period = 22500 - 1,
-		.TIM_Prescaler = 10 - 1,
+		.TIM_Period = 0xffffffff,
+		.TIM_Prescaler = 90 - 1,
 		.TIM_CounterMode = TIM_CounterMode_Up
 	};
-	TIM_TimeBaseInit(TIM3, &TimeBaseInitStruct);
+	TIM_TimeBaseInit(TIM5, &TimeBaseInitStruct);
+
+	TIM_OCInitTypeDef TIM_OCInitStruct = {
+		.TIM_OCMode = TIM_OCMode_Timing,
+		.TIM_OutputState = TIM_OutputState_Disable,
+		.TIM_OCPolarity = TIM_OCPolarity_High
+	};
+
+	TIM_OCInitStruct.TIM_Pulse = FLIGHT_CTL_PERIOD_US;
+	TIM_OC1Init(TIM5, &TIM_OCInitStruct);
+	TIM_OC1PreloadConfig(TIM5, TIM_OCPreload_Disable);
+
+	TIM_OCInitStruct.TIM_Pulse = IMU_FIFO_PERIOD_US;
+	TIM_OC2Init(TIM5, &TIM_OCInitStruct);
+	TIM_OC2PreloadConfig(TIM5, TIM_OCPreload_Disable);
+
+	TIM_OCInitStruct.TIM_Pulse = LED_CTRL_PERIOD_US;
+	TIM_OC3Init(TIM5, &TIM_OCInitStruct);
+	TIM_OC3PreloadConfig(TIM5, TIM_OCPreload_Disable);
 
 	NVIC_InitTypeDef NVIC_InitStruct = {
-		.NVIC_IRQChannel = TIM3_IRQn,
-		.NVIC_IRQChannelPreemptionPriority = BAROMETER_ISR_PRIORITY,
+		.NVIC_IRQChannel = TIM5_IRQn,
+		.NVIC_IRQChannelPreemptionPriority = SYS_TIMER_ISR_PRIORITY,
 		.NVIC_IRQChannelCmd = ENABLE
 	};
 	NVIC_Init(&NVIC_InitStruct);
 
-	TIM_ITConfig(TIM3, TIM_IT_Update, ENABLE);
-	TIM_Cmd(TIM3, ENABLE);
+	TIM_ITConfig(TIM5, TIM_IT_CC1 | TIM_IT_CC2 | TIM_IT_CC3, ENABLE);
+	TIM_Cmd(TIM5, ENABLE);
+}
 
+uint32_t timer5_get_count(void)
+{
+	return TIM5->CNT;
 }
 
-void TIM8_BRK_TIM12_IRQHandler(void)
+void TIM5_IRQHandler(void)
 {
-	static int flight_ctrl_cnt = FLIGHT_CTL_PRESCALER_RELOAD;
-	static int led_ctrl_cnt = LED_CTRL_PRESCALER_RELOAD;
+	perf_start(PERF_TIMER5_ISR);
 
-	if(TIM_GetITStatus(TIM12, TIM_IT_Update) == SET) {
-		TIM_ClearITPendingBit(TIM12, TIM_IT_Update);
+	if(TIM_GetITStatus(TIM5, TIM_IT_CC1) == SET) {
+		TIM_ClearITPendingBit(TIM5, TIM_IT_CC1);
+		TIM5->CCR1 += FLIGHT_CTL_PERIOD_US;
 
-		sys_time_update_handler();
+		/* keeps the 64-bit extension of the counter alive */
+		get_time_us();
 
-		flight_ctrl_cnt--;
-		if(flight_ctrl_cnt == 0) {
-			flight_ctrl_cnt = FLIGHT_CTL_PRESCALER_RELOAD;
-			flight_ctrl_semaphore_handler();
-		}
+		flight_ctrl_semaphore_handler();
+	}
 
-#if 1
-		led_ctrl_cnt--;
-		if(led_ctrl_cnt == 0) {
-			led_ctrl_cnt = LED_CTRL_PRESCALER_RELOAD;
-			rgb_led_handler();
-		}
-#endif
+	/* drain the fifo of the mpu6500 (fifo mode only) */
+	if(TIM_GetITStatus(TIM5, TIM_IT_CC2) == SET) {
+		TIM_ClearITPendingBit(TIM5, TIM_IT_CC2);
+		TIM5->CCR2 += IMU_FIFO_PERIOD_US;
+		mpu6500_fifo_drain_handler();
+	}
+
+	if(TIM_GetITStatus(TIM5, TIM_IT_CC3) == SET) {
+		TIM_ClearITPendingBit(TIM5, TIM_IT_CC3);
+		TIM5->CCR3 += LED_CTRL_PERIOD_US;
+		rgb_led_handler();
 	}
+
+	perf_end(PERF_TIMER5_ISR);
 }
 
 void TIM3_IRQHandler(void)
@@ -105,6 +145,7 @@ void TIM3_IRQHandler(void)
 
 	/* trigger ms5611 driver task (400Hz) */
 	if(TIM_GetITStatus(TIM3, TIM_IT_Update) == SET) {
+		perf_start(PERF_TIMER3_ISR);
 		BaseType_t higher_priority_task_woken = pdFALSE;
 
 #if (ENABLE_BAROMETER == 1)
@@ -130,6 +171,7 @@ void TIM3_IRQHandler(void)
 		//dummy_sensors_update_isr_handler(&higher_priority_task_woken);
 
 		TIM_ClearITPendingBit(TIM3, TIM_IT_Update);
+		perf_end(PERF_TIMER3_ISR);
 		portEND_SWITCHING_ISR(higher_priority_task_woken);
 	}
 }
@@ -1,7 +1,10 @@
 #ifndef __TIMER_H__
 #define __TIMER_H__
 
-void timer12_init(void);
+#include <stdint.h>
+
 void timer3_init(void);
+void timer5_init(void);
+uint32_t timer5_get_count(void);
 
 #endif
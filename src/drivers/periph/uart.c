@@ -8,13 +8,19 @@
 #include "stm32f4xx_conf.h"
 #include "isr.h"
 #include "sbus_radio.h"
-#include "optitrack.h"
-#include "vins_mono.h"
-#include "ublox_m8n.h"
 #include "proj_config.h"
+#include "dma_rx_ring.h"
+#include "sys_time.h"
 
 #define UART1_QUEUE_SIZE 100
-#define UART3_QUEUE_SIZE 500
+
+/* circular dma receive buffers, must be power of 2 */
+#define UART3_RX_RING_SIZE 1024
+#define UART4_RX_RING_SIZE 64
+#define UART6_RX_RING_SIZE 1024
+#define UART7_RX_RING_SIZE 1024
+
+#define UART7_TX_BUF_SIZE 64
 
 typedef struct {
 	char c;
@@ -22,10 +28,59 @@ typedef struct {
 
 SemaphoreHandle_t uart1_tx_semphr;
 SemaphoreHandle_t uart3_tx_semphr;
-SemaphoreHandle_t uart7_tx_semphr;
+SemaphoreHandle_t uart3_rx_semphr;
 
 QueueHandle_t uart1_rx_queue;
-QueueHandle_t uart3_rx_queue;
+
+static uint8_t uart3_rx_buf[UART3_RX_RING_SIZE];
+static uint8_t uart4_rx_buf[UART4_RX_RING_SIZE];
+static uint8_t uart6_rx_buf[UART6_RX_RING_SIZE];
+static uint8_t uart7_rx_buf[UART7_RX_RING_SIZE];
+
+static dma_rx_ring_t uart3_rx_ring;
+static dma_rx_ring_t uart4_rx_ring;
+static dma_rx_ring_t uart6_rx_ring;
+static dma_rx_ring_t uart7_rx_ring;
+
+static uint8_t uart7_tx_buf[UART7_TX_BUF_SIZE];
+static volatile int uart7_tx_size;
+static volatile int uart7_tx_cnt;
+
+static volatile uint64_t uart7_rx_time;
+
+/* circular dma reception with the half transfer and transfer complete
+ * interrupts of the stream and the idle line interrupt of the uart */
+static void uart_rx_dma_init(USART_TypeDef *uart, DMA_Stream_TypeDef *stream, uint32_t channel,
+                             uint8_t *buf, uint32_t size)
+{
+	DMA_InitTypeDef DMA_InitStructure = {
+		.DMA_BufferSize = size,
+		.DMA_FIFOMode = DMA_FIFOMode_Disable,
+		.DMA_FIFOThreshold = DMA_FIFOThreshold_Full,
+		.DMA_MemoryBurst = DMA_MemoryBurst_Single,
+		.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte,
+		.DMA_MemoryInc = DMA_MemoryInc_Enable,
+		.DMA_Mode = DMA_Mode_Circular,
+		.DMA_PeripheralBaseAddr = (uint32_t)(&uart->DR),
+		.DMA_PeripheralBurst = DMA_PeripheralBurst_Single,
+		.DMA_PeripheralInc = DMA_PeripheralInc_Disable,
+		.DMA_Priority = DMA_Priority_High,
+		.DMA_Channel = channel,
+		.DMA_DIR = DMA_DIR_PeripheralToMemory,
+		.DMA_Memory0BaseAddr = (uint32_t)buf
+	};
+	DMA_Init(stream, &DMA_InitStructure);
+	DMA_ITConfig(stream, DMA_IT_HT | DMA_IT_TC, ENABLE);
+	DMA_Cmd(stream, ENABLE);
+
+	USART_DMACmd(uart, USART_DMAReq_Rx, ENABLE);
+	USART_ITConfig(uart, USART_IT_IDLE, ENABLE);
+}
+
+static uint32_t uart_rx_dma_pos(DMA_Stream_TypeDef *stream, uint32_t size)
+{
+	return size - DMA_GetCurrDataCounter(stream);
+}
 
 /*
  * <uart1>
@@ -83,13 +138,14 @@ void uart1_init(int baudrate)
 /*
  * <uart3>
  * usage: telecommunication
- * tx: gpio_pin_d8 (dma1 channel4 stream3)
- * rx: gpio_pin_d9 (dma1 channel4 stream4)
+ * tx: gpio_pin_d8 (dma1 channel7 stream4)
+ * rx: gpio_pin_d9 (dma1 channel4 stream1, circular)
  */
 void uart3_init(int baudrate)
 {
 	uart3_tx_semphr = xSemaphoreCreateBinary();
-	uart3_rx_queue = xQueueCreate(UART3_QUEUE_SIZE, sizeof(uart_c_t));
+	uart3_rx_semphr = xSemaphoreCreateBinary();
+	dma_rx_ring_init(&uart3_rx_ring, uart3_rx_buf, UART3_RX_RING_SIZE);
 
 	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOD, ENABLE);
 	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
@@ -119,28 +175,35 @@ void uart3_init(int baudrate)
 	USART_ClearFlag(USART3, USART_FLAG_TC);
 
 	NVIC_InitTypeDef NVIC_InitStruct = {
-		.NVIC_IRQChannel = DMA1_Stream3_IRQn,
+		.NVIC_IRQChannel = DMA1_Stream4_IRQn,
 		.NVIC_IRQChannelPreemptionPriority = UART3_TX_ISR_PRIORITY,
 		.NVIC_IRQChannelSubPriority = 0,
 		.NVIC_IRQChannelCmd = ENABLE
 	};
 	NVIC_Init(&NVIC_InitStruct);
-	DMA_ITConfig(DMA1_Stream3, DMA_IT_TC, ENABLE);
+	DMA_ITConfig(DMA1_Stream4, DMA_IT_TC, ENABLE);
 
-	NVIC_InitStruct.NVIC_IRQChannel = USART3_IRQn;
+	NVIC_InitStruct.NVIC_IRQChannel = DMA1_Stream1_IRQn;
 	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = UART3_RX_ISR_PRIORITY;
 	NVIC_Init(&NVIC_InitStruct);
-	USART_ITConfig(USART3, USART_IT_RXNE, ENABLE);
+
+	NVIC_InitStruct.NVIC_IRQChannel = USART3_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+
+	uart_rx_dma_init(USART3, DMA1_Stream1, DMA_Channel_4, uart3_rx_buf, UART3_RX_RING_SIZE);
 }
 
 /*
  * <uart4>
  * usage: s-bus
- * rx: gpio_pin_c11
+ * rx: gpio_pin_c11 (dma1 channel4 stream2, circular)
  */
 void uart4_init(int baudrate)
 {
+	dma_rx_ring_init(&uart4_rx_ring, uart4_rx_buf, UART4_RX_RING_SIZE);
+
 	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOC, ENABLE);
+	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
 	RCC_APB1PeriphClockCmd(RCC_APB1Periph_UART4, ENABLE);
 
 	GPIO_PinAFConfig(GPIOC, GPIO_PinSource11, GPIO_AF_UART4);
@@ -166,23 +229,29 @@ void uart4_init(int baudrate)
 	USART_Cmd(UART4, ENABLE);
 
 	NVIC_InitTypeDef NVIC_InitStruct = {
-		.NVIC_IRQChannel = UART4_IRQn,
+		.NVIC_IRQChannel = DMA1_Stream2_IRQn,
 		.NVIC_IRQChannelPreemptionPriority = SBUS_ISR_PRIORITY,
 		.NVIC_IRQChannelSubPriority = 0,
 		.NVIC_IRQChannelCmd = ENABLE
 	};
 	NVIC_Init(&NVIC_InitStruct);
-	USART_ITConfig(UART4, USART_IT_RXNE, ENABLE);
+
+	NVIC_InitStruct.NVIC_IRQChannel = UART4_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+
+	uart_rx_dma_init(UART4, DMA1_Stream2, DMA_Channel_4, uart4_rx_buf, UART4_RX_RING_SIZE);
 }
 
 /*
  * <uart6>
  * usage: cam
  * tx: gpio_pin_c6 (dma2 channel5 stream6)
- * rx: gpio_pin_c7 (dma2 channel5 stream2)
+ * rx: gpio_pin_c7 (dma2 channel5 stream1, circular)
  */
 void uart6_init(int baudrate)
 {
+	dma_rx_ring_init(&uart6_rx_ring, uart6_rx_buf, UART6_RX_RING_SIZE);
+
 	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOC, ENABLE);
 	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA2, ENABLE);
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_USART6, ENABLE);
@@ -211,25 +280,28 @@ void uart6_init(int baudrate)
 	USART_ClearFlag(USART6, USART_FLAG_TC);
 
 	NVIC_InitTypeDef NVIC_InitStruct = {
-		.NVIC_IRQChannel = USART6_IRQn,
+		.NVIC_IRQChannel = DMA2_Stream1_IRQn,
 		.NVIC_IRQChannelPreemptionPriority = UART6_RX_ISR_PRIORITY,
 		.NVIC_IRQChannelSubPriority = 0,
 		.NVIC_IRQChannelCmd = ENABLE
 	};
 	NVIC_Init(&NVIC_InitStruct);
 
-	USART_ITConfig(USART6, USART_IT_RXNE, ENABLE);
+	NVIC_InitStruct.NVIC_IRQChannel = USART6_IRQn;
+	NVIC_Init(&NVIC_InitStruct);
+
+	uart_rx_dma_init(USART6, DMA2_Stream1, DMA_Channel_5, uart6_rx_buf, UART6_RX_RING_SIZE);
 }
 
 /*
  * <uart7>
  * usage: telecommunication
- * tx: gpio_pin_e8
- * rx: gpio_pin_e7
+ * tx: gpio_pin_e8 (polling, dma1 stream1 is taken by the uart3 rx)
+ * rx: gpio_pin_e7 (dma1 channel5 stream3, circular)
  */
 void uart7_init(int baudrate)
 {
-	uart7_tx_semphr = xSemaphoreCreateBinary();
+	dma_rx_ring_init(&uart7_rx_ring, uart7_rx_buf, UART7_RX_RING_SIZE);
 
 	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_GPIOE, ENABLE);
 	RCC_AHB1PeriphClockCmd(RCC_AHB1Periph_DMA1, ENABLE);
@@ -259,19 +331,17 @@ void uart7_init(int baudrate)
 	USART_ClearFlag(UART7, USART_FLAG_TC);
 
 	NVIC_InitTypeDef NVIC_InitStruct = {
-		.NVIC_IRQChannel = DMA1_Stream1_IRQn,
-		.NVIC_IRQChannelPreemptionPriority = GPS_UART_TX_ISR,
+		.NVIC_IRQChannel = DMA1_Stream3_IRQn,
+		.NVIC_IRQChannelPreemptionPriority = GPS_OPTITRACK_UART_ISR,
 		.NVIC_IRQChannelSubPriority = 0,
 		.NVIC_IRQChannelCmd = ENABLE
 	};
 	NVIC_Init(&NVIC_InitStruct);
-	DMA_ITConfig(DMA1_Stream1, DMA_IT_TC, ENABLE);
 
 	NVIC_InitStruct.NVIC_IRQChannel = UART7_IRQn;
-	NVIC_InitStruct.NVIC_IRQChannelPreemptionPriority = GPS_OPTITRACK_UART_ISR;
-	NVIC_InitStruct.NVIC_IRQChannelCmd = ENABLE;
 	NVIC_Init(&NVIC_InitStruct);
-	USART_ITConfig(UART7, USART_IT_RXNE, ENABLE);
+
+	uart_rx_dma_init(UART7, DMA1_Stream3, DMA_Channel_5, uart7_rx_buf, UART7_RX_RING_SIZE);
 }
 
 void uart_putc(USART_TypeDef *uart, char c)
@@ -327,8 +397,8 @@ void uart1_puts(char *s, int size)
 
 void uart3_puts(char *s, int size)
 {
-	//uart3 tx: dma1 channel4 stream3
-	DMA_ClearFlag(DMA1_Stream3, DMA_FLAG_TCIF3);
+	//uart3 tx: dma1 channel7 stream4
+	DMA_ClearFlag(DMA1_Stream4, DMA_FLAG_TCIF4);
 
 	DMA_InitTypeDef DMA_InitStructure = {
 		.DMA_BufferSize = (uint32_t)size,
@@ -342,14 +412,14 @@ void uart3_puts(char *s, int size)
 		.DMA_PeripheralBurst = DMA_PeripheralBurst_Single,
 		.DMA_PeripheralInc = DMA_PeripheralInc_Disable,
 		.DMA_Priority = DMA_Priority_Medium,
-		.DMA_Channel = DMA_Channel_4,
+		.DMA_Channel = DMA_Channel_7,
 		.DMA_DIR = DMA_DIR_MemoryToPeripheral,
 		.DMA_Memory0BaseAddr = (uint32_t)s
 	};
-	DMA_Init(DMA1_Stream3, &DMA_InitStructure);
+	DMA_Init(DMA1_Stream4, &DMA_InitStructure);
 
 	//send data from memory to uart data register
-	DMA_Cmd(DMA1_Stream3, ENABLE);
+	DMA_Cmd(DMA1_Stream4, ENABLE);
 	USART_DMACmd(USART3, USART_DMAReq_Tx, ENABLE);
 
 	xSemaphoreTake(uart3_tx_semphr, portMAX_DELAY);
@@ -401,32 +471,24 @@ void uart6_puts(char *s, int size)
 
 void uart7_puts(char *s, int size)
 {
-	//uart7 tx: dma1 channel5 stream1
-	DMA_ClearFlag(DMA1_Stream1, DMA_FLAG_TCIF5);
+	usart_puts(UART7, s, size);
+}
 
-	DMA_InitTypeDef DMA_InitStructure = {
-		.DMA_BufferSize = (uint32_t)size,
-		.DMA_FIFOMode = DMA_FIFOMode_Disable,
-		.DMA_FIFOThreshold = DMA_FIFOThreshold_Full,
-		.DMA_MemoryBurst = DMA_MemoryBurst_Single,
-		.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte,
-		.DMA_MemoryInc = DMA_MemoryInc_Enable,
-		.DMA_Mode = DMA_Mode_Normal,
-		.DMA_PeripheralBaseAddr = (uint32_t)(&UART7->DR),
-		.DMA_PeripheralBurst = DMA_PeripheralBurst_Single,
-		.DMA_PeripheralInc = DMA_PeripheralInc_Disable,
-		.DMA_Priority = DMA_Priority_Medium,
-		.DMA_Channel = DMA_Channel_5,
-		.DMA_DIR = DMA_DIR_MemoryToPeripheral,
-		.DMA_Memory0BaseAddr = (uint32_t)s
-	};
-	DMA_Init(DMA1_Stream1, &DMA_InitStructure);
+/* non-blocking transmission of uart7 driven by the txe interrupt (the tx dma
+ * stream is occupied by the uart3 reception). returns false if the previous
+ * transmission is not finished yet */
+bool uart7_write(uint8_t *data, int size)
+{
+	if(size > UART7_TX_BUF_SIZE || uart7_tx_cnt < uart7_tx_size) {
+		return false;
+	}
 
-	//send data from memory to uart data register
-	DMA_Cmd(DMA1_Stream1, ENABLE);
-	USART_DMACmd(UART7, USART_DMAReq_Tx, ENABLE);
+	memcpy(uart7_tx_buf, data, size);
+	uart7_tx_cnt = 0;
+	uart7_tx_size = size;
+	USART_ITConfig(UART7, USART_IT_TXE, ENABLE);
 
-	xSemaphoreTake(uart7_tx_semphr, portMAX_DELAY);
+	return true;
 }
 
 bool uart1_getc(char *c, long sleep_ticks)
@@ -440,34 +502,127 @@ bool uart1_getc(char *c, long sleep_ticks)
 	}
 }
 
-bool uart3_getc(char *c, long sleep_ticks)
+/* bulk read of the uart3 reception, blocked until any byte is received or
+ * the timeout is reached. returns the number of bytes copied */
+int uart3_read(uint8_t *data, int size, long sleep_ticks)
 {
-	uart_c_t recpt_c;
-	if(xQueueReceive(uart3_rx_queue, &recpt_c, sleep_ticks) == pdFALSE) {
-		return false;
-	} else {
-		*c = recpt_c.c;
-		return true;
+	if(dma_rx_ring_available(&uart3_rx_ring) == 0) {
+		xSemaphoreTake(uart3_rx_semphr, sleep_ticks);
+	}
+
+	return dma_rx_ring_read(&uart3_rx_ring, data, size);
+}
+
+int uart4_read(uint8_t *data, int size)
+{
+	return dma_rx_ring_read(&uart4_rx_ring, data, size);
+}
+
+int uart6_read(uint8_t *data, int size)
+{
+	return dma_rx_ring_read(&uart6_rx_ring, data, size);
+}
+
+int uart7_read(uint8_t *data, int size)
+{
+	return dma_rx_ring_read(&uart7_rx_ring, data, size);
+}
+
+/* time of the last idle line of uart7 (the end of the latest burst) */
+uint64_t uart7_get_rx_time(void)
+{
+	taskENTER_CRITICAL();
+	uint64_t rx_time = uart7_rx_time;
+	taskEXIT_CRITICAL();
+
+	return rx_time;
+}
+
+uint32_t uart_get_rx_overrun_cnt(USART_TypeDef *uart)
+{
+	if(uart == USART3) {
+		return dma_rx_ring_get_overrun_cnt(&uart3_rx_ring);
+	} else if(uart == UART4) {
+		return dma_rx_ring_get_overrun_cnt(&uart4_rx_ring);
+	} else if(uart == USART6) {
+		return dma_rx_ring_get_overrun_cnt(&uart6_rx_ring);
+	} else if(uart == UART7) {
+		return dma_rx_ring_get_overrun_cnt(&uart7_rx_ring);
+	}
+
+	return 0;
+}
+
+static void uart3_rx_handler(void)
+{
+	dma_rx_ring_update(&uart3_rx_ring, uart_rx_dma_pos(DMA1_Stream1, UART3_RX_RING_SIZE));
+
+	if(dma_rx_ring_available(&uart3_rx_ring) > 0) {
+		BaseType_t higher_priority_task_woken = pdFALSE;
+		xSemaphoreGiveFromISR(uart3_rx_semphr, &higher_priority_task_woken);
+		portEND_SWITCHING_ISR(higher_priority_task_woken);
 	}
 }
 
+static void uart4_rx_handler(void)
+{
+	dma_rx_ring_update(&uart4_rx_ring, uart_rx_dma_pos(DMA1_Stream2, UART4_RX_RING_SIZE));
+}
+
+static void uart6_rx_handler(void)
+{
+	dma_rx_ring_update(&uart6_rx_ring, uart_rx_dma_pos(DMA2_Stream1, UART6_RX_RING_SIZE));
+}
+
+static void uart7_rx_handler(void)
+{
+	dma_rx_ring_update(&uart7_rx_ring, uart_rx_dma_pos(DMA1_Stream3, UART7_RX_RING_SIZE));
+}
+
 void DMA1_Stream1_IRQHandler(void)
 {
-	/* uart7 tx dma */
+	/* uart3 rx dma (half transfer and transfer complete) */
+	if(DMA_GetITStatus(DMA1_Stream1, DMA_IT_HTIF1) == SET) {
+		DMA_ClearITPendingBit(DMA1_Stream1, DMA_IT_HTIF1);
+	}
 	if(DMA_GetITStatus(DMA1_Stream1, DMA_IT_TCIF1) == SET) {
 		DMA_ClearITPendingBit(DMA1_Stream1, DMA_IT_TCIF1);
+	}
 
-		BaseType_t higher_priority_task_woken = pdFALSE;
-		xSemaphoreGiveFromISR(uart7_tx_semphr, &higher_priority_task_woken);
-		portEND_SWITCHING_ISR(higher_priority_task_woken);
+	uart3_rx_handler();
+}
+
+void DMA1_Stream2_IRQHandler(void)
+{
+	/* uart4 rx dma (half transfer and transfer complete) */
+	if(DMA_GetITStatus(DMA1_Stream2, DMA_IT_HTIF2) == SET) {
+		DMA_ClearITPendingBit(DMA1_Stream2, DMA_IT_HTIF2);
 	}
+	if(DMA_GetITStatus(DMA1_Stream2, DMA_IT_TCIF2) == SET) {
+		DMA_ClearITPendingBit(DMA1_Stream2, DMA_IT_TCIF2);
+	}
+
+	uart4_rx_handler();
 }
 
 void DMA1_Stream3_IRQHandler(void)
 {
-	/* uart3 tx dma */
+	/* uart7 rx dma (half transfer and transfer complete) */
+	if(DMA_GetITStatus(DMA1_Stream3, DMA_IT_HTIF3) == SET) {
+		DMA_ClearITPendingBit(DMA1_Stream3, DMA_IT_HTIF3);
+	}
 	if(DMA_GetITStatus(DMA1_Stream3, DMA_IT_TCIF3) == SET) {
 		DMA_ClearITPendingBit(DMA1_Stream3, DMA_IT_TCIF3);
+	}
+
+	uart7_rx_handler();
+}
+
+void DMA1_Stream4_IRQHandler(void)
+{
+	/* uart3 tx dma */
+	if(DMA_GetITStatus(DMA1_Stream4, DMA_IT_TCIF4) == SET) {
+		DMA_ClearITPendingBit(DMA1_Stream4, DMA_IT_TCIF4);
 
 		BaseType_t higher_priority_task_woken = pdFALSE;
 		xSemaphoreGiveFromISR(uart3_tx_semphr, &higher_priority_task_woken);
@@ -475,6 +630,19 @@ void DMA1_Stream3_IRQHandler(void)
 	}
 }
 
+void DMA2_Stream1_IRQHandler(void)
+{
+	/* uart6 rx dma (half transfer and transfer complete) */
+	if(DMA_GetITStatus(DMA2_Stream1, DMA_IT_HTIF1) == SET) {
+		DMA_ClearITPendingBit(DMA2_Stream1, DMA_IT_HTIF1);
+	}
+	if(DMA_GetITStatus(DMA2_Stream1, DMA_IT_TCIF1) == SET) {
+		DMA_ClearITPendingBit(DMA2_Stream1, DMA_IT_TCIF1);
+	}
+
+	uart6_rx_handler();
+}
+
 void DMA2_Stream7_IRQHandler(void)
 {
 	/* uart1 tx dma */
@@ -502,54 +670,55 @@ void USART1_IRQHandler(void)
 
 void USART3_IRQHandler(void)
 {
-	if(USART_GetITStatus(USART3, USART_IT_RXNE) == SET) {
-		uart_c_t uart_queue_item;
-		uart_queue_item.c = USART_ReceiveData(USART3);
+	/* idle line, the end of a burst which did not reach the half of the
+	 * buffer. the flag is cleared by reading sr then dr */
+	if(USART_GetITStatus(USART3, USART_IT_IDLE) == SET) {
 		USART3->SR;
-
-		BaseType_t higher_priority_task_woken = pdFALSE;
-		xQueueSendToBackFromISR(uart3_rx_queue, &uart_queue_item, &higher_priority_task_woken);
-		portEND_SWITCHING_ISR(higher_priority_task_woken);
+		USART3->DR;
+		uart3_rx_handler();
 	}
 }
 
 void UART4_IRQHandler(void)
 {
-	/* using uart4 rxne interrupt to receive and parse
-	   sbus message */
-	uint8_t c;
-
-	if(USART_GetITStatus(UART4, USART_IT_RXNE) == SET) {
-		c = USART_ReceiveData(UART4);
+	/* idle line, the end of an s-bus frame */
+	if(USART_GetITStatus(UART4, USART_IT_IDLE) == SET) {
 		UART4->SR;
-
-		sbus_rc_isr_handler(c);
+		UART4->DR;
+		uart4_rx_handler();
+		sbus_rc_idle_handler();
 	}
 }
 
 void USART6_IRQHandler(void)
 {
-	uint8_t c;
-	if(USART_GetITStatus(USART6, USART_IT_RXNE) == SET) {
-		c = USART_ReceiveData(USART6);
+	/* idle line */
+	if(USART_GetITStatus(USART6, USART_IT_IDLE) == SET) {
 		USART6->SR;
-		vins_mono_isr_handler(c);
+		USART6->DR;
+		uart6_rx_handler();
 	}
 }
 
 void UART7_IRQHandler(void)
 {
-	uint8_t c;
-	if(USART_GetITStatus(UART7, USART_IT_RXNE) == SET) {
-		c = USART_ReceiveData(UART7);
+	/* idle line */
+	if(USART_GetITStatus(UART7, USART_IT_IDLE) == SET) {
 		UART7->SR;
+		UART7->DR;
+		uart7_rx_time = get_time_us();
+		uart7_rx_handler();
+	}
+
+	/* transmit data register empty */
+	if(USART_GetITStatus(UART7, USART_IT_TXE) == SET) {
+		if(uart7_tx_cnt < uart7_tx_size) {
+			USART_SendData(UART7, uart7_tx_buf[uart7_tx_cnt]);
+			uart7_tx_cnt++;
+		}
 
-#if (SELECT_NAVIGATION_DEVICE1 == NAV_DEV1_USE_GPS)
-		ublox_m8n_isr_handler(c);
-#elif (SELECT_NAVIGATION_DEVICE1 == NAV_DEV1_USE_OPTITRACK)
-		optitrack_isr_handler(c);
-#else
-		(void)c; //prevent from unused variable warning
-#endif
+		if(uart7_tx_cnt >= uart7_tx_size) {
+			USART_ITConfig(UART7, USART_IT_TXE, DISABLE);
+		}
 	}
 }
@@ -19,8 +19,15 @@ void uart1_puts(char *s, int size);
 void uart3_puts(char *s, int size);
 void uart6_puts(char *s, int size);
 void uart7_puts(char *s, int size);
+bool uart7_write(uint8_t *data, int size);
 
 bool uart1_getc(char *c, long sleep_ticks);
-bool uart3_getc(char *c, long sleep_ticks);
+
+int uart3_read(uint8_t *data, int size, long sleep_ticks);
+int uart4_read(uint8_t *data, int size);
+int uart6_read(uint8_t *data, int size);
+int uart7_read(uint8_t *data, int size);
+uint64_t uart7_get_rx_time(void);
+uint32_t uart_get_rx_overrun_cnt(USART_TypeDef *uart);
 
 #endif
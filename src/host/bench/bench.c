@@ -0,0 +1,2434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include "arm_math.h"
+#include "matrix.h"
+#include "mat3.h"
+#include "se3_math.h"
+#include "quaternion.h"
+#include "imu.h"
+#include "imu_preint.h"
+#include "mpu6500.h"
+#include "optitrack.h"
+#include "ist8310.h"
+#include "ms5611.h"
+#include "sys_time.h"
+#include "uart.h"
+#include "i2c.h"
+#include "sbus_radio.h"
+#include "ublox_m8n.h"
+#include "dma_rx_ring.h"
+#include "frame_parser.h"
+#include "vins_mono.h"
+#include "ahrs.h"
+#include "ins.h"
+#include "ins_eskf.h"
+#include "eskf_ahrs.h"
+#include "ins_sensor_sync.h"
+#include "attitude_state.h"
+#include "multirotor_geometry_ctrl.h"
+#include "proj_config.h"
+#include "host_periph.h"
+#include "perf.h"
+#include "perf_list.h"
+
+/* micro-benchmark of the flight control core on the host, every function is
+ * called repeatedly with fixed inputs (level hovering) and the execution time
+ * of each call is measured with the monotonic clock */
+
+#define BENCH_WARMUP_CNT 1000
+#define BENCH_SAMPLE_CNT 100000
+
+extern mpu6500_t mpu6500;
+extern optitrack_t optitrack;
+extern ist8310_t ist8310;
+extern ms5611_t ms5611;
+extern sbus_t sbus;
+extern ublox_t ublox;
+
+typedef void (*bench_func_t)(void);
+
+typedef struct {
+	char *name;
+	bench_func_t func;
+	bench_func_t reset; //optional, called before the measurement
+	bench_func_t prepare; //optional, called before every call and not measured
+} bench_t;
+
+static uint64_t bench_samples[BENCH_SAMPLE_CNT];
+
+/* perf entries used by the interrupt handlers called from the benchmark */
+perf_t perf_list[] = {
+	DEF_PERF(PERF_IMU_ISR, "imu isr")
+	DEF_PERF(PERF_IMU_SPI_DMA_ISR, "imu spi dma isr")
+};
+
+/* fixed inputs */
+static float accel_in[3] = {0.0f, 0.0f, -9.81f};
+static float gyro_in[3] = {0.01f, -0.02f, 0.005f};     //[rad/s]
+static float mag_in[3] = {0.45f, 0.0f, 0.89f};
+static radio_t rc = {
+	.throttle = 50.0f,
+	.roll = 0.0f,
+	.pitch = 0.0f,
+	.yaw = 0.0f,
+	.safety = false,
+	.auto_flight = false,
+};
+
+static attitude_t attitude;
+static float desired_yaw = 0.0f;
+static int eskf_cycle_cnt = 0;
+
+static euler_t attitude_cmd = {.roll = 0.05f, .pitch = -0.03f, .yaw = 0.2f};
+static float pos_des_enu[3] = {0.2f, -0.1f, 1.0f};
+static float vel_des_enu[3] = {0.1f, 0.0f, 0.0f};
+static float accel_ff_enu[3] = {0.0f, 0.0f, 0.0f};
+static float curr_pos_ned[3] = {0.15f, 0.25f, -0.9f};
+static float curr_vel_ned[3] = {0.0f, 0.05f, 0.02f};
+static float ctrl_moments[3], ctrl_force, uav_moments[3], uav_m_rot_frame[3];
+
+/* attitude error kernel (eR = 0.5 * vee(Rd^T * R - R^T * Rd)) with the generic
+ * cmsis-dsp matrix functions and the fixed size ones */
+static float kernel_r[9] = {
+	0.9801f, -0.1977f, 0.0198f,
+	0.1987f, 0.9752f, -0.0978f,
+	0.0f, 0.0998f, 0.9950f
+};
+static float kernel_rd[9] = {
+	0.9950f, -0.0998f, 0.0f,
+	0.0998f, 0.9950f, 0.0f,
+	0.0f, 0.0f, 1.0f
+};
+static float kernel_rt[9] = {
+	0.9801f, 0.1987f, 0.0f,
+	-0.1977f, 0.9752f, 0.0998f,
+	0.0198f, -0.0978f, 0.9950f
+};
+static float kernel_rtd[9] = {
+	0.9950f, 0.0998f, 0.0f,
+	-0.0998f, 0.9950f, 0.0f,
+	0.0f, 0.0f, 1.0f
+};
+static float kernel_er[3];
+
+static inline uint64_t bench_time_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int bench_sample_compare(const void *a, const void *b)
+{
+	uint64_t sample_a = *(const uint64_t *)a;
+	uint64_t sample_b = *(const uint64_t *)b;
+	return (sample_a > sample_b) - (sample_a < sample_b);
+}
+
+static void bench_run(bench_t *bench)
+{
+	if(bench->reset != NULL) {
+		bench->reset();
+	}
+
+	int i;
+	for(i = 0; i < BENCH_WARMUP_CNT; i++) {
+		if(bench->prepare != NULL) {
+			bench->prepare();
+		}
+		bench->func();
+	}
+
+	uint64_t sum = 0;
+	for(i = 0; i < BENCH_SAMPLE_CNT; i++) {
+		if(bench->prepare != NULL) {
+			bench->prepare();
+		}
+
+		uint64_t start = bench_time_ns();
+		bench->func();
+		bench_samples[i] = bench_time_ns() - start;
+		sum += bench_samples[i];
+	}
+
+	qsort(bench_samples, BENCH_SAMPLE_CNT, sizeof(uint64_t), bench_sample_compare);
+
+	double mean = (double)sum / BENCH_SAMPLE_CNT;
+	uint64_t p50 = bench_samples[BENCH_SAMPLE_CNT / 2];
+	uint64_t p99 = bench_samples[(BENCH_SAMPLE_CNT * 99) / 100];
+
+	printf("%-40s %10.1f %10lu %10lu %14.0f\n", bench->name, mean,
+	       (unsigned long)p50, (unsigned long)p99, 1e9 / mean);
+}
+
+static void bench_imu_feed(void)
+{
+	/* imu driver outputs: accelerometer in [m/s^2], gyroscope in [deg/s] */
+	mpu6500.accel_lpf[0] = accel_in[0];
+	mpu6500.accel_lpf[1] = accel_in[1];
+	mpu6500.accel_lpf[2] = accel_in[2];
+	mpu6500.gyro_lpf[0] = rad_to_deg(gyro_in[0]);
+	mpu6500.gyro_lpf[1] = rad_to_deg(gyro_in[1]);
+	mpu6500.gyro_lpf[2] = rad_to_deg(gyro_in[2]);
+
+	/* ahrs_estimate() falls back to the latest sample with an empty queue */
+	imu_sample_flush();
+}
+
+static void bench_compass_feed(void)
+{
+	ist8310.mag_lpf[0] = mag_in[0];
+	ist8310.mag_lpf[1] = mag_in[1];
+	ist8310.mag_lpf[2] = mag_in[2];
+}
+
+static void bench_optitrack_feed(void)
+{
+	optitrack.pos[0] = 0.0f;
+	optitrack.pos[1] = 0.0f;
+	optitrack.pos[2] = 1.0f;
+	memcpy(optitrack.pos_filtered, optitrack.pos, sizeof(optitrack.pos));
+	memcpy(optitrack.pos_predict, optitrack.pos, sizeof(optitrack.pos));
+	optitrack.q[0] = 1.0f;
+	optitrack.q[1] = 0.0f;
+	optitrack.q[2] = 0.0f;
+	optitrack.q[3] = 0.0f;
+	optitrack.time_now = 0; //system time is not advanced by the benchmark
+}
+
+static void bench_eskf_ins_reset(void)
+{
+	eskf_ins_set_update_mode(SELECT_ESKF_INS_UPDATE);
+	eskf_ins_init(0.0025f);
+	eskf_cycle_cnt = 0;
+}
+
+static void bench_eskf_ins_sequential_reset(void)
+{
+	bench_eskf_ins_reset();
+	eskf_ins_set_update_mode(ESKF_UPDATE_SEQUENTIAL);
+}
+
+static void bench_eskf_ahrs_reset(void)
+{
+	eskf_ahrs_set_update_mode(SELECT_ESKF_AHRS_UPDATE);
+}
+
+static void bench_eskf_ahrs_batch_reset(void)
+{
+	eskf_ahrs_set_update_mode(ESKF_UPDATE_BATCH);
+}
+
+static void bench_ahrs_estimate(void)
+{
+	ahrs_estimate(&attitude);
+}
+
+static void bench_eskf_ins_predict(void)
+{
+	eskf_ins_predict(accel_in, gyro_in);
+}
+
+static void bench_eskf_ins_accelerometer_correct(void)
+{
+	eskf_ins_accelerometer_correct(accel_in);
+}
+
+static void bench_eskf_ins_magnetometer_correct(void)
+{
+	eskf_ins_magnetometer_correct(mag_in);
+}
+
+static void bench_eskf_ins_gps_correct(void)
+{
+	eskf_ins_gps_correct(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+static void bench_eskf_ins_barometer_correct(void)
+{
+	eskf_ins_barometer_correct(1.0f, 0.0f);
+}
+
+/* fill the history of the delayed measurements */
+static void bench_eskf_ins_history_fill(void)
+{
+	int i;
+	for(i = 0; i < ESKF_INS_HISTORY_SIZE * ESKF_INS_HISTORY_DECIMATION; i++) {
+		eskf_ins_predict(accel_in, gyro_in);
+		eskf_ins_history_push((uint64_t)i * 2500);
+	}
+}
+
+static void bench_eskf_ins_history_reset(void)
+{
+	bench_eskf_ins_reset();
+	bench_eskf_ins_history_fill();
+}
+
+static void bench_eskf_ins_sequential_history_reset(void)
+{
+	bench_eskf_ins_sequential_reset();
+	bench_eskf_ins_history_fill();
+}
+
+/* gps captured in the middle of the history */
+static void bench_eskf_ins_gps_delayed_correct(void)
+{
+	eskf_ins_gps_delayed_correct(0.0f, 0.0f, 0.0f, 0.0f,
+	                             ESKF_INS_HISTORY_SIZE * ESKF_INS_HISTORY_DECIMATION * 2500 / 2);
+}
+
+/* sensor schedule of ins_eskf_estimate(): prediction and accelerometer
+ * correction at 400Hz, compass and barometer at 50Hz, gps at 5Hz. (the
+ * function itself returns immediately with the optitrack configuration of
+ * proj_config.h, so the same sequence is called directly here) */
+static void bench_ins_eskf_cycle(void)
+{
+	eskf_ins_predict(accel_in, gyro_in);
+	eskf_ins_accelerometer_correct(accel_in);
+	eskf_ins_history_push((uint64_t)eskf_cycle_cnt * 2500);
+
+	if((eskf_cycle_cnt % 8) == 0) {
+		eskf_ins_magnetometer_correct(mag_in);
+		eskf_ins_barometer_correct(1.0f, 0.0f);
+	}
+
+	if((eskf_cycle_cnt % 80) == 0) {
+		eskf_ins_gps_correct(0.0f, 0.0f, 0.0f, 0.0f);
+	}
+
+	eskf_cycle_cnt++;
+}
+
+static void bench_ins_state_estimate(void)
+{
+	ins_state_estimate();
+}
+
+static void bench_multirotor_geometry_control(void)
+{
+	multirotor_geometry_control(&rc, &desired_yaw);
+}
+
+static void bench_estimate_uav_dynamics(void)
+{
+	/* alternate the input, the angular acceleration of a constant input
+	 * decays into subnormal numbers */
+	static float sign = 1.0f;
+	float gyro[3] = {sign * gyro_in[0], sign * gyro_in[1], sign * gyro_in[2]};
+	sign = -sign;
+	estimate_uav_dynamics(gyro, uav_moments, uav_m_rot_frame);
+}
+
+static void bench_geometry_manual_ctrl(void)
+{
+	geometry_manual_ctrl(&attitude_cmd, NULL, gyro_in, ctrl_moments, true);
+}
+
+static void bench_geometry_tracking_ctrl(void)
+{
+	geometry_tracking_ctrl(&attitude_cmd, NULL, gyro_in, pos_des_enu, vel_des_enu,
+	                       accel_ff_enu, curr_pos_ned, curr_vel_ned, ctrl_moments,
+	                       &ctrl_force, false);
+}
+
+static void bench_attitude_error_arm_mat(void)
+{
+	float rtd_r[9], rt_rd[9], er_mat[9];
+	arm_matrix_instance_f32 R = {3, 3, kernel_r};
+	arm_matrix_instance_f32 Rd = {3, 3, kernel_rd};
+	arm_matrix_instance_f32 Rt = {3, 3, kernel_rt};
+	arm_matrix_instance_f32 Rtd = {3, 3, kernel_rtd};
+	arm_matrix_instance_f32 RtdR = {3, 3, rtd_r};
+	arm_matrix_instance_f32 RtRd = {3, 3, rt_rd};
+	arm_matrix_instance_f32 eR_mat = {3, 3, er_mat};
+
+	MAT_MULT(&Rtd, &R, &RtdR);
+	MAT_MULT(&Rt, &Rd, &RtRd);
+	MAT_SUB(&RtdR, &RtRd, &eR_mat);
+	vee_map_3x3(er_mat, kernel_er);
+	kernel_er[0] *= 0.5f;
+	kernel_er[1] *= 0.5f;
+	kernel_er[2] *= 0.5f;
+}
+
+static void bench_attitude_error_mat3(void)
+{
+	mat3_t R, Rd, RtdR;
+	vec3_t eR;
+	mat3_load(&R, kernel_r);
+	mat3_load(&Rd, kernel_rd);
+
+	mat3_trans_mul(&Rd, &R, &RtdR);
+	mat3_vee_skew(&RtdR, &eR);
+	kernel_er[0] = 0.5f * eR.v[0];
+	kernel_er[1] = 0.5f * eR.v[1];
+	kernel_er[2] = 0.5f * eR.v[2];
+}
+
+/* registers of the mpu6500 burst read (big endian, chip frame) returned through
+ * the spi1 dma stand-in: accel = (100, -200, -4096), temp = 0, gyro = (10, -20, 30) */
+static uint8_t bench_mpu6500_regs[MPU6500_BURST_READ_SIZE - 1] = {
+	0x00, 0x64, 0xff, 0x38, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x0a, 0xff, 0xec, 0x00, 0x1e
+};
+static int bench_mpu6500_reg_index;
+
+static void bench_mpu6500_chip_select_handler(bool level)
+{
+	bench_mpu6500_reg_index = -1; //register address phase
+}
+
+static uint8_t bench_mpu6500_transfer(uint8_t data)
+{
+	if(bench_mpu6500_reg_index < 0) {
+		bench_mpu6500_reg_index = 0;
+		return 0xff;
+	}
+
+	uint8_t reg = bench_mpu6500_regs[bench_mpu6500_reg_index];
+	bench_mpu6500_reg_index = (bench_mpu6500_reg_index + 1) % (MPU6500_BURST_READ_SIZE - 1);
+	return reg;
+}
+
+static void bench_mpu6500_reset(void)
+{
+	host_spi_attach_device(SPI1, bench_mpu6500_transfer);
+	host_gpio_attach_handler(GPIOA, GPIO_Pin_4, bench_mpu6500_chip_select_handler);
+
+	/* skip the gyroscope bias calibration of mpu6500_init() */
+	mpu6500.accel_scale = 9.81f / 4096.0f;
+	mpu6500.gyro_scale = 1.0f / 32.8f;
+	mpu6500.accel_rescale_x = 1.0f;
+	mpu6500.accel_rescale_y = 1.0f;
+	mpu6500.accel_rescale_z = 1.0f;
+	mpu6500_filter_init();
+	mpu6500.init_finished = true;
+
+	host_spi_dma_complete(SPI1);
+}
+
+static void bench_spi1_dma_complete(void)
+{
+	host_spi_dma_complete(SPI1);
+}
+
+/* synthetic fifo frames (big endian, chip frame) with a sine wave on the x axis
+ * of the gyroscope, accel = (0, 0, -4096) and temp = 0 */
+static void bench_fifo_fill(uint8_t *buf, int frames, int first_frame, float freq, float amplitude)
+{
+	int i;
+	for(i = 0; i < frames; i++) {
+		float t = (float)(first_frame + i) / MPU6500_FIFO_SAMPLE_RATE;
+		int16_t gyro_x = (int16_t)lrintf(amplitude * sinf(2.0f * (float)M_PI * freq * t));
+
+		uint8_t *frame = &buf[i * MPU6500_FIFO_FRAME_SIZE];
+		memset(frame, 0, MPU6500_FIFO_FRAME_SIZE);
+		frame[4] = 0xf0; //accel z = -4096
+		frame[8] = (uint16_t)gyro_x >> 8;
+		frame[9] = (uint16_t)gyro_x & 0xff;
+	}
+}
+
+/* 1ms of the fifo (8 frames), decimated into one sample */
+static uint8_t bench_fifo_buf[MPU6500_FIFO_DECIMATION * MPU6500_FIFO_FRAME_SIZE];
+
+static void bench_mpu6500_fifo_reset(void)
+{
+	bench_mpu6500_reset();
+	bench_fifo_fill(bench_fifo_buf, MPU6500_FIFO_DECIMATION, 0, 50.0f, 1000.0f);
+}
+
+static void bench_mpu6500_fifo_parse(void)
+{
+	mpu6500_fifo_parse(bench_fifo_buf, MPU6500_FIFO_DECIMATION, 1000000);
+}
+
+/* circular dma reception stand-in: the bytes are written at the position of
+ * the dma and the ring is updated at the half transfer, transfer complete and
+ * idle line events like the interrupts of the firmware */
+#define BENCH_DMA_RX_RING_SIZE 256
+#define BENCH_DMA_RX_READ_SIZE 64
+
+static uint8_t bench_dma_rx_buf[BENCH_DMA_RX_RING_SIZE];
+static dma_rx_ring_t bench_dma_rx_ring;
+static uint32_t bench_dma_pos;
+static uint8_t bench_dma_rx_data[BENCH_DMA_RX_READ_SIZE];
+
+static void bench_dma_rx_write(uint8_t *data, int size)
+{
+	int i;
+	for(i = 0; i < size; i++) {
+		bench_dma_rx_buf[bench_dma_pos] = data[i];
+		bench_dma_pos = (bench_dma_pos + 1) & (BENCH_DMA_RX_RING_SIZE - 1);
+
+		if(bench_dma_pos == (BENCH_DMA_RX_RING_SIZE / 2) || bench_dma_pos == 0) {
+			dma_rx_ring_update(&bench_dma_rx_ring, bench_dma_pos);
+		}
+	}
+
+	dma_rx_ring_update(&bench_dma_rx_ring, bench_dma_pos);
+}
+
+static void bench_dma_rx_ring_reset(void)
+{
+	dma_rx_ring_init(&bench_dma_rx_ring, bench_dma_rx_buf, BENCH_DMA_RX_RING_SIZE);
+	bench_dma_pos = 0;
+}
+
+static void bench_dma_rx_ring_prepare(void)
+{
+	/* the dma position moves by a chunk and wraps every 4 chunks */
+	bench_dma_pos = (bench_dma_pos + BENCH_DMA_RX_READ_SIZE - 1) & (BENCH_DMA_RX_RING_SIZE - 1);
+	dma_rx_ring_update(&bench_dma_rx_ring, bench_dma_pos);
+}
+
+static void bench_dma_rx_ring_read(void)
+{
+	dma_rx_ring_read(&bench_dma_rx_ring, bench_dma_rx_data, BENCH_DMA_RX_READ_SIZE);
+}
+
+/* serial frames of the optitrack link, the position carries the sequence
+ * number of the frame */
+static uint8_t bench_frame_stream[OPTITRACK_SERIAL_MSG_SIZE];
+static uint8_t bench_frame_buf[VINS_MONO_SERIAL_MSG_SIZE];
+static frame_parser_t bench_frame_parser;
+
+static void bench_frame_pack(uint8_t *frame, int size, uint32_t seq)
+{
+	int i;
+
+	frame[0] = FRAME_PARSER_START_BYTE;
+	frame[2] = 1; //id
+	for(i = 3; i < size - 1; i++) {
+		frame[i] = (uint8_t)((seq * 2654435761u) >> ((i % 4) * 8)) ^ (uint8_t)i;
+	}
+	memcpy(&frame[3], &seq, sizeof(uint32_t));
+	frame[size - 1] = FRAME_PARSER_END_BYTE;
+	frame[1] = frame_parser_checksum(&frame[3], size - 4);
+}
+
+static void bench_frame_parser_reset(void)
+{
+	frame_parser_init(&bench_frame_parser, bench_frame_buf, OPTITRACK_SERIAL_MSG_SIZE);
+	bench_frame_pack(bench_frame_stream, OPTITRACK_SERIAL_MSG_SIZE, 0);
+}
+
+static void bench_frame_parser_feed(void)
+{
+	int i;
+	for(i = 0; i < OPTITRACK_SERIAL_MSG_SIZE; i++) {
+		frame_parser_feed(&bench_frame_parser, bench_frame_stream[i]);
+	}
+}
+
+/* previous frame detection of the optitrack driver for comparison: shift the
+ * whole buffer for every byte once it is full and verify the checksum of
+ * every candidate */
+static int bench_shift_buf_pos;
+
+static void bench_shift_buf_feed(void)
+{
+	int i, j;
+	for(i = 0; i < OPTITRACK_SERIAL_MSG_SIZE; i++) {
+		uint8_t c = bench_frame_stream[i];
+
+		if(bench_shift_buf_pos >= OPTITRACK_SERIAL_MSG_SIZE) {
+			for(j = 1; j < OPTITRACK_SERIAL_MSG_SIZE; j++) {
+				bench_frame_buf[j - 1] = bench_frame_buf[j];
+			}
+			bench_frame_buf[OPTITRACK_SERIAL_MSG_SIZE - 1] = c;
+		} else {
+			bench_frame_buf[bench_shift_buf_pos] = c;
+			bench_shift_buf_pos++;
+		}
+
+		if(c == FRAME_PARSER_END_BYTE && bench_frame_buf[0] == FRAME_PARSER_START_BYTE &&
+		   frame_parser_checksum(&bench_frame_buf[3], OPTITRACK_SERIAL_MSG_SIZE - 4) ==
+		   bench_frame_buf[1]) {
+			bench_shift_buf_pos = 0;
+		}
+	}
+}
+
+static void bench_shift_buf_reset(void)
+{
+	bench_shift_buf_pos = 0;
+	bench_frame_pack(bench_frame_stream, OPTITRACK_SERIAL_MSG_SIZE, 0);
+}
+
+/* ms5611 model with the calibration data and conversion results of the
+ * example in the datasheet (20.07 deg c, 1000.09 mbar) */
+static const uint16_t bench_ms5611_prom[6] = {40127, 36924, 23317, 23282, 33464, 28312};
+static const uint32_t bench_ms5611_d1 = 9085466;
+static const uint32_t bench_ms5611_d2 = 8569150;
+
+static uint8_t bench_ms5611_cmd;
+static uint8_t bench_ms5611_conversion;
+static int bench_ms5611_byte_index;
+static int bench_ms5611_select_cnt;
+
+static void bench_ms5611_chip_select_handler(bool level)
+{
+	bench_ms5611_byte_index = 0;
+	if(level == false) {
+		bench_ms5611_select_cnt++;
+	}
+}
+
+static uint8_t bench_ms5611_transfer(uint8_t data)
+{
+	int index = bench_ms5611_byte_index++;
+
+	if(index == 0) {
+		bench_ms5611_cmd = data;
+		if((data & 0xf0) == 0x40 || (data & 0xf0) == 0x50) {
+			bench_ms5611_conversion = data;
+		}
+		return 0xff;
+	}
+
+	if(bench_ms5611_cmd >= 0xa2 && bench_ms5611_cmd <= 0xac && index <= 2) {
+		uint16_t prom = bench_ms5611_prom[(bench_ms5611_cmd - 0xa2) / 2];
+		return index == 1 ? prom >> 8 : prom & 0xff;
+	}
+
+	if(bench_ms5611_cmd == 0x00 && index <= 3) {
+		uint32_t adc = bench_ms5611_conversion == MS5611_D1_CONVERT_OSR4096 ?
+		               bench_ms5611_d1 : bench_ms5611_d2;
+		return (adc >> ((3 - index) * 8)) & 0xff;
+	}
+
+	return 0xff;
+}
+
+static void bench_ms5611_reset(void)
+{
+	host_spi_attach_device(SPI3, bench_ms5611_transfer);
+	host_gpio_attach_handler(GPIOA, GPIO_Pin_15, bench_ms5611_chip_select_handler);
+
+	/* drop the transactions left by the last run */
+	while(host_spi_dma_complete(SPI3) == true);
+	ms5611_init();
+}
+
+static void bench_ms5611_complete(void)
+{
+	while(host_spi_dma_complete(SPI3) == true);
+}
+
+static void bench_ms5611_driver_handler(void)
+{
+	BaseType_t higher_priority_task_woken = pdFALSE;
+	ms5611_driver_handler(&higher_priority_task_woken);
+}
+
+/* ist8310 model on i2c2: a register pointer written after the address, the
+ * reads and writes of the transaction auto-increment it. the device can be
+ * detached to test the nack of the address */
+static uint8_t bench_ist8310_regs[0x50];
+static uint8_t bench_ist8310_ptr;
+static int bench_ist8310_byte_index;
+static bool bench_ist8310_present;
+static bool bench_ist8310_reading;
+static int bench_ist8310_stop_cnt;
+
+static void bench_ist8310_start(void)
+{
+	bench_ist8310_byte_index = 0;
+}
+
+static void bench_ist8310_stop(void)
+{
+	bench_ist8310_stop_cnt++;
+}
+
+static bool bench_ist8310_write(uint8_t data)
+{
+	int index = bench_ist8310_byte_index++;
+
+	if(index == 0) {
+		bench_ist8310_reading = (data & 0x01) ? true : false;
+		return bench_ist8310_present && (data >> 1) == IST8310_ADDR;
+	}
+
+	if(index == 1) {
+		bench_ist8310_ptr = data;
+	} else {
+		bench_ist8310_regs[bench_ist8310_ptr++ % sizeof(bench_ist8310_regs)] = data;
+	}
+
+	return true;
+}
+
+static uint8_t bench_ist8310_read(void)
+{
+	if(bench_ist8310_reading == false) {
+		return 0xff;
+	}
+
+	return bench_ist8310_regs[bench_ist8310_ptr++ % sizeof(bench_ist8310_regs)];
+}
+
+static host_i2c_device_t bench_ist8310_device = {
+	.start = bench_ist8310_start,
+	.stop = bench_ist8310_stop,
+	.write = bench_ist8310_write,
+	.read = bench_ist8310_read
+};
+
+/* mag = {-300, 1200, -2000} in the register order of the driver */
+static const uint8_t bench_ist8310_data[6] = {0xb0, 0x04, 0xd4, 0xfe, 0x30, 0xf8};
+
+static uint8_t bench_ist8310_buf[6];
+static int bench_ist8310_complete_cnt;
+
+static void bench_ist8310_callback(i2c_transaction_t *transaction,
+                                   BaseType_t *higher_priority_task_woken)
+{
+	bench_ist8310_complete_cnt++;
+}
+
+static i2c_transaction_t bench_ist8310_transaction = {
+	.addr = IST8310_ADDR,
+	.reg = IST8310_REG_DATA,
+	.data = bench_ist8310_buf,
+	.size = 6,
+	.read = true,
+	.callback = bench_ist8310_callback
+};
+
+static void bench_ist8310_reset(void)
+{
+	host_i2c_attach_device(I2C2, &bench_ist8310_device);
+	bench_ist8310_present = true;
+	memset(bench_ist8310_regs, 0, sizeof(bench_ist8310_regs));
+	bench_ist8310_regs[IST8310_REG_WIA] = IST8310_CHIP_ID;
+	memcpy(&bench_ist8310_regs[IST8310_REG_DATA], bench_ist8310_data, 6);
+}
+
+static void bench_i2c2_ist8310_read(void)
+{
+	i2c2_transaction_submit(&bench_ist8310_transaction);
+}
+
+static void bench_get_time_us(void)
+{
+	get_time_us();
+}
+
+/* s-bus frames in the wire format of the receiver, 16 channels of 11 bits
+ * (least significant bit first), the flag byte and the footer */
+static uint8_t bench_sbus_frame[SBUS_FRAME_SIZE];
+
+static void bench_sbus_pack(uint8_t *frame, uint16_t *rc_val, uint8_t flags, uint8_t footer)
+{
+	memset(frame, 0, SBUS_FRAME_SIZE);
+	frame[0] = SBUS_HEADER;
+
+	int bit_pos = 0;
+	int i, j;
+	for(i = 0; i < SBUS_CHANNEL_CNT; i++) {
+		for(j = 0; j < 11; j++) {
+			if((rc_val[i] >> j) & 0x01) {
+				frame[1 + bit_pos / 8] |= 1 << (bit_pos % 8);
+			}
+			bit_pos++;
+		}
+	}
+
+	frame[23] = flags;
+	frame[24] = footer;
+}
+
+static void bench_sbus_reset(void)
+{
+	uint16_t rc_val[SBUS_CHANNEL_CNT];
+
+	int i;
+	for(i = 0; i < SBUS_CHANNEL_CNT; i++) {
+		rc_val[i] = (uint16_t)(172 + i * 100);
+	}
+	bench_sbus_pack(bench_sbus_frame, rc_val, 0, SBUS_FOOTER);
+
+	sbus_init();
+	uart4_init(100000);
+}
+
+static void bench_sbus_receive(void)
+{
+	/* dma reception and the idle line interrupt of one frame */
+	host_uart_receive(UART4, bench_sbus_frame, SBUS_FRAME_SIZE);
+}
+
+static void bench_sbus_rc_read(void)
+{
+	radio_t rc;
+	sbus_rc_read(&rc);
+}
+
+/* u-blox receiver model on uart7: acknowledges the configuration commands,
+ * rejects cfg-nav5 and ignores the first cfg-rate transmissions */
+#define BENCH_UBX_MSG_SIZE (UBX_NAV_PVT_PAYLOAD_LEN + 8)
+
+static uint8_t bench_ubx_msg[BENCH_UBX_MSG_SIZE];
+static int bench_ubx_msg_size;
+static int bench_ublox_cfg_cnt;
+static int bench_ublox_ignore_cnt;
+
+static int bench_ubx_pack(uint8_t *msg, uint8_t msg_class, uint8_t msg_id, uint8_t *payload, int len)
+{
+	msg[0] = 0xb5;
+	msg[1] = 0x62;
+	msg[2] = msg_class;
+	msg[3] = msg_id;
+	msg[4] = (uint8_t)(len & 0xff);
+	msg[5] = (uint8_t)(len >> 8);
+	memcpy(&msg[6], payload, len);
+
+	uint8_t ck_a = 0, ck_b = 0;
+	int i;
+	for(i = 2; i < len + 6; i++) {
+		ck_a += msg[i];
+		ck_b += ck_a;
+	}
+	msg[len + 6] = ck_a;
+	msg[len + 7] = ck_b;
+
+	return len + 8;
+}
+
+/* nav-pvt of a 3d fix, the position and velocity carry the sequence number */
+static int bench_ubx_nav_pvt_pack(uint8_t *msg, int32_t seq)
+{
+	uint8_t payload[UBX_NAV_PVT_PAYLOAD_LEN] = {0};
+	int32_t longitude = 1209966000 + seq;
+	int32_t latitude = 247954000 - seq;
+	int32_t height_msl = 85000 + seq;
+	int32_t vel_n = seq, vel_e = -seq, vel_d = 2 * seq;
+	uint16_t pdop = 120;
+
+	payload[20] = 3; //3d fix
+	payload[23] = 12; //satellites
+	memcpy(&payload[24], &longitude, sizeof(int32_t));
+	memcpy(&payload[28], &latitude, sizeof(int32_t));
+	memcpy(&payload[36], &height_msl, sizeof(int32_t));
+	memcpy(&payload[48], &vel_n, sizeof(int32_t));
+	memcpy(&payload[52], &vel_e, sizeof(int32_t));
+	memcpy(&payload[56], &vel_d, sizeof(int32_t));
+	memcpy(&payload[76], &pdop, sizeof(uint16_t));
+
+	return bench_ubx_pack(msg, UBX_CLASS_NAV, UBX_ID_NAV_PVT, payload, UBX_NAV_PVT_PAYLOAD_LEN);
+}
+
+static void bench_ublox_tx_handler(char *s, int size)
+{
+	uint8_t *cmd = (uint8_t *)s;
+	bench_ublox_cfg_cnt++;
+
+	/* cfg-rate */
+	if(cmd[2] == 0x06 && cmd[3] == 0x08 && bench_ublox_ignore_cnt > 0) {
+		bench_ublox_ignore_cnt--;
+		return;
+	}
+
+	/* cfg-nav5 is rejected */
+	uint8_t ack_id = (cmd[2] == 0x06 && cmd[3] == 0x24) ? UBX_ID_ACK_NAK : UBX_ID_ACK_ACK;
+
+	uint8_t payload[UBX_ACK_PAYLOAD_LEN] = {cmd[2], cmd[3]};
+	uint8_t msg[UBX_ACK_PAYLOAD_LEN + 8];
+	int msg_size = bench_ubx_pack(msg, UBX_CLASS_ACK, ack_id, payload, UBX_ACK_PAYLOAD_LEN);
+	host_uart_receive(UART7, msg, msg_size);
+}
+
+static void bench_ublox_reset(void)
+{
+	bench_ubx_msg_size = bench_ubx_nav_pvt_pack(bench_ubx_msg, 1);
+}
+
+static void bench_ublox_parse(void)
+{
+	ublox_m8n_parse(bench_ubx_msg, bench_ubx_msg_size);
+}
+
+static imu_preint_t bench_preint;
+static uint64_t bench_preint_time_us;
+
+static void bench_imu_preint_reset(void)
+{
+	imu_preint_init(&bench_preint);
+	bench_preint_time_us = 0;
+}
+
+static void bench_imu_preint_update(void)
+{
+	/* 1kHz samples of the decimated fifo */
+	bench_preint_time_us += 1000;
+	imu_preint_update(&bench_preint, accel_in, gyro_in, bench_preint_time_us);
+}
+
+/* samples queued between two 400Hz steps of the estimator */
+static void bench_imu_increments_push(void)
+{
+	float gyro_deg[3] = {rad_to_deg(gyro_in[0]), rad_to_deg(gyro_in[1]), rad_to_deg(gyro_in[2])};
+
+	int i;
+	for(i = 0; i < 3; i++) {
+		bench_preint_time_us += 1000;
+		imu_sample_push(accel_in, gyro_deg, bench_preint_time_us);
+	}
+}
+
+static void bench_imu_read_increments(void)
+{
+	float delta_angle[3], delta_vel[3], dt;
+	imu_read_increments(delta_angle, delta_vel, &dt);
+}
+
+bench_t bench_list[] = {
+	{"ahrs_estimate", bench_ahrs_estimate, bench_eskf_ahrs_reset},
+	{"ahrs_estimate (batch)", bench_ahrs_estimate, bench_eskf_ahrs_batch_reset},
+	{"eskf_ins_predict", bench_eskf_ins_predict, bench_eskf_ins_reset},
+	{"eskf_ins_accelerometer_correct", bench_eskf_ins_accelerometer_correct, bench_eskf_ins_reset, bench_eskf_ins_predict},
+	{"eskf_ins_accelerometer_correct (seq)", bench_eskf_ins_accelerometer_correct, bench_eskf_ins_sequential_reset, bench_eskf_ins_predict},
+	{"eskf_ins_magnetometer_correct", bench_eskf_ins_magnetometer_correct, bench_eskf_ins_reset, bench_eskf_ins_predict},
+	{"eskf_ins_magnetometer_correct (seq)", bench_eskf_ins_magnetometer_correct, bench_eskf_ins_sequential_reset, bench_eskf_ins_predict},
+	{"eskf_ins_gps_correct", bench_eskf_ins_gps_correct, bench_eskf_ins_reset, bench_eskf_ins_predict},
+	{"eskf_ins_gps_correct (seq)", bench_eskf_ins_gps_correct, bench_eskf_ins_sequential_reset, bench_eskf_ins_predict},
+	{"eskf_ins_gps_delayed_correct", bench_eskf_ins_gps_delayed_correct, bench_eskf_ins_history_reset, bench_eskf_ins_predict},
+	{"eskf_ins_gps_delayed_correct (seq)", bench_eskf_ins_gps_delayed_correct, bench_eskf_ins_sequential_history_reset, bench_eskf_ins_predict},
+	{"eskf_ins_barometer_correct", bench_eskf_ins_barometer_correct, bench_eskf_ins_reset, bench_eskf_ins_predict},
+	{"eskf_ins_barometer_correct (seq)", bench_eskf_ins_barometer_correct, bench_eskf_ins_sequential_reset, bench_eskf_ins_predict},
+	{"ins_eskf_estimate (400Hz cycle)", bench_ins_eskf_cycle, bench_eskf_ins_reset},
+	{"ins_eskf_estimate (400Hz cycle, seq)", bench_ins_eskf_cycle, bench_eskf_ins_sequential_reset},
+	{"ins_state_estimate", bench_ins_state_estimate, NULL},
+	{"multirotor_geometry_control", bench_multirotor_geometry_control, NULL},
+	{"estimate_uav_dynamics", bench_estimate_uav_dynamics, NULL},
+	{"geometry_manual_ctrl", bench_geometry_manual_ctrl, NULL},
+	{"geometry_tracking_ctrl", bench_geometry_tracking_ctrl, NULL},
+	{"attitude error (arm_mat_*)", bench_attitude_error_arm_mat, NULL},
+	{"attitude error (mat3_*)", bench_attitude_error_mat3, NULL},
+	{"mpu6500_int_handler (dma start)", mpu6500_int_handler, bench_mpu6500_reset, bench_spi1_dma_complete},
+	{"spi1 dma completion (mpu6500)", bench_spi1_dma_complete, bench_mpu6500_reset, mpu6500_int_handler},
+	{"mpu6500_fifo_parse (8 frames)", bench_mpu6500_fifo_parse, bench_mpu6500_fifo_reset, imu_sample_flush},
+	{"imu_preint_update (1 sample)", bench_imu_preint_update, bench_imu_preint_reset},
+	{"imu_read_increments (3 samples)", bench_imu_read_increments, bench_imu_preint_reset, bench_imu_increments_push},
+	{"dma_rx_ring_read (63 bytes)", bench_dma_rx_ring_read, bench_dma_rx_ring_reset, bench_dma_rx_ring_prepare},
+	{"ms5611_driver_handler (queue spi3)", bench_ms5611_driver_handler, bench_ms5611_reset, bench_ms5611_complete},
+	{"i2c2_transaction_submit (ist8310 data)", bench_i2c2_ist8310_read, bench_ist8310_reset},
+	{"get_time_us (64-bit extension)", bench_get_time_us, NULL},
+	{"sbus_rc_idle_handler (dma frame)", bench_sbus_receive, bench_sbus_reset},
+	{"sbus_rc_read", bench_sbus_rc_read, bench_sbus_reset, bench_sbus_receive},
+	{"ublox_m8n_parse (nav-pvt message)", bench_ublox_parse, bench_ublox_reset},
+	{"frame_parser_feed (optitrack frame)", bench_frame_parser_feed, bench_frame_parser_reset},
+	{"shift buffer parser (optitrack frame)", bench_shift_buf_feed, bench_shift_buf_reset},
+};
+
+/* run the ins eskf with the sensor schedule and check if the covariance
+ * matrix is still symmetric and positive definite (cholesky decomposition) */
+static bool bench_eskf_ins_covariance_check(int cycle_cnt)
+{
+	bench_eskf_ins_reset();
+
+	int i;
+	for(i = 0; i < cycle_cnt; i++) {
+		bench_ins_eskf_cycle();
+	}
+
+	const int n = ESKF_INS_STATE_NUM;
+	float P[ESKF_INS_STATE_NUM * ESKF_INS_STATE_NUM];
+	float L[ESKF_INS_STATE_NUM * ESKF_INS_STATE_NUM] = {0.0f};
+	get_eskf_ins_covariance_matrix(P);
+
+	int r, c, k;
+	for(r = 0; r < n; r++) {
+		for(c = 0; c < n; c++) {
+			if(isfinite(P[r * n + c]) == false || P[r * n + c] != P[c * n + r]) {
+				printf("error: eskf covariance is not symmetric at (%d, %d)\n", r, c);
+				return false;
+			}
+		}
+	}
+
+	for(c = 0; c < n; c++) {
+		double sum = P[c * n + c];
+		for(k = 0; k < c; k++) {
+			sum -= (double)L[c * n + k] * L[c * n + k];
+		}
+
+		if(sum <= 0.0) {
+			printf("error: eskf covariance is not positive definite (pivot %d = %g)\n",
+			       c, sum);
+			return false;
+		}
+		L[c * n + c] = sqrt(sum);
+
+		for(r = c + 1; r < n; r++) {
+			sum = P[r * n + c];
+			for(k = 0; k < c; k++) {
+				sum -= (double)L[r * n + k] * L[c * n + k];
+			}
+			L[r * n + c] = sum / L[c * n + c];
+		}
+	}
+
+	printf("eskf covariance after %d cycles: symmetric and positive definite, diag = [", cycle_cnt);
+	for(r = 0; r < n; r++) {
+		printf(r == 0 ? "%g" : " %g", P[r * n + r]);
+	}
+	printf("]\n");
+
+	return true;
+}
+
+/* run the sensor schedule with both measurement update methods, the sequential
+ * scalar updates should give the same estimate as the batch update up to the
+ * rounding errors */
+static bool bench_eskf_ins_update_compare(int cycle_cnt)
+{
+	float P[2][ESKF_INS_STATE_NUM * ESKF_INS_STATE_NUM], q[2][4];
+
+	int i, mode;
+	for(mode = 0; mode < 2; mode++) {
+		bench_eskf_ins_reset();
+		eskf_ins_set_update_mode(mode == 0 ? ESKF_UPDATE_BATCH : ESKF_UPDATE_SEQUENTIAL);
+
+		for(i = 0; i < cycle_cnt; i++) {
+			bench_ins_eskf_cycle();
+		}
+
+		get_eskf_ins_covariance_matrix(P[mode]);
+		get_eskf_ins_attitude_quaternion(q[mode]);
+	}
+
+	bench_eskf_ins_reset();
+
+	float P_diff_max = 0.0f, P_max = 0.0f, q_diff_max = 0.0f;
+	for(i = 0; i < ESKF_INS_STATE_NUM * ESKF_INS_STATE_NUM; i++) {
+		P_diff_max = fmaxf(P_diff_max, fabsf(P[0][i] - P[1][i]));
+		P_max = fmaxf(P_max, fabsf(P[0][i]));
+	}
+	for(i = 0; i < 4; i++) {
+		q_diff_max = fmaxf(q_diff_max, fabsf(q[0][i] - q[1][i]));
+	}
+
+	printf("eskf sequential vs batch update after %d cycles: max covariance"
+	       " difference = %g (relative %g), max quaternion difference = %g\n",
+	       cycle_cnt, P_diff_max, P_diff_max / P_max, q_diff_max);
+
+	if((P_diff_max / P_max) > 1e-3f || q_diff_max > 1e-4f) {
+		printf("error: sequential update diverges from the batch update\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* rotate the attitude by a rotation vector [rad] */
+static void bench_quat_rotate(float *q, float *rotvec)
+{
+	float angle = sqrtf(rotvec[0] * rotvec[0] + rotvec[1] * rotvec[1] + rotvec[2] * rotvec[2]);
+	float scale = angle > 1e-9f ? sinf(0.5f * angle) / angle : 0.5f;
+	float dq[4] = {cosf(0.5f * angle), rotvec[0] * scale, rotvec[1] * scale, rotvec[2] * scale};
+
+	float q_next[4];
+	quaternion_mult(q, dq, q_next);
+	quat_normalize(q_next);
+	quaternion_copy(q, q_next);
+}
+
+/* fly a horizontal circle with a biased and noisy accelerometer and feed the eskf with the gps
+ * position and velocity captured 150ms before they arrive. compares the position error
+ * of fusing the delayed gps at its capture time with fusing it as a present measurement */
+static bool bench_eskf_ins_delay_check(void)
+{
+	const uint64_t gps_delay_us = 150000;
+	const uint64_t tick_period_us = 2500;
+	const int tick_cnt = 400 * 30;
+	const float radius = 3.0f, w = 2.0f * M_PI / 5.0f;
+	const float accel_bias[3] = {0.02f, -0.01f, 0.0f};
+	float gyro[3] = {0.0f, 0.0f, 0.0f};
+	float pos_rms[3];
+	float pos_err_max[3] = {0.0f};
+
+	int mode, i, j;
+	for(mode = 0; mode < 3; mode++) {
+		uint64_t delay_us = (mode == 0) ? 0 : gps_delay_us;
+		double pos_err_sum = 0.0;
+		int err_cnt = 0;
+
+		bench_eskf_ins_reset();
+		srand(7);
+
+		/* rotation of the nominal state, the gyroscope input is zero so it stays constant */
+		float q_b2i[4], q[4], R[9], Rt[9];
+		get_eskf_ins_attitude_quaternion(q_b2i);
+		quaternion_conj(q_b2i, q);
+		quat_to_rotation_matrix(q, R, Rt);
+
+		for(i = 0; i < tick_cnt; i++) {
+			uint64_t time_us = (uint64_t)(i + 1) * tick_period_us;
+			float t = (float)time_us * 1e-6f;
+			float s = sinf(w * t), c = cosf(w * t);
+
+			/* enu acceleration of the circle to the body-frame specific force (ned) */
+			float accel_ned[3] = {radius * w * w * c, -radius * w * w * s, -9.78f};
+			float accel[3];
+			for(j = 0; j < 3; j++) {
+				accel[j] = Rt[j * 3 + 0] * accel_ned[0] + Rt[j * 3 + 1] * accel_ned[1] +
+				           Rt[j * 3 + 2] * accel_ned[2] + accel_bias[j] +
+				           ((float)rand() / RAND_MAX - 0.5f) * 0.2f;
+			}
+
+			eskf_ins_predict(accel, gyro);
+			eskf_ins_history_push(time_us);
+
+			/* barometer (50Hz) */
+			if((i % 8) == 0) {
+				eskf_ins_barometer_delayed_correct(0.0f, 0.0f, time_us);
+			}
+
+			/* gps (5Hz) */
+			if((i % 80) == 0 && time_us > delay_us) {
+				float t_gps = (float)(time_us - delay_us) * 1e-6f;
+				float px = radius * sinf(w * t_gps);
+				float py = radius * (1.0f - cosf(w * t_gps));
+				float vx = radius * w * cosf(w * t_gps);
+				float vy = radius * w * sinf(w * t_gps);
+
+				if(mode == 1) {
+					eskf_ins_gps_correct(px, py, vx, vy);
+				} else {
+					eskf_ins_gps_delayed_correct(px, py, vx, vy, time_us - delay_us);
+				}
+			}
+
+			/* skip the first 10 seconds (filter convergence) */
+			if(i < 400 * 10) {
+				continue;
+			}
+
+			float pos[3], vel[3];
+			get_eskf_ins_position_velocity(pos, vel);
+
+			float err_x = pos[0] - radius * s;
+			float err_y = pos[1] - radius * (1.0f - c);
+			float err = sqrtf(err_x * err_x + err_y * err_y);
+			pos_err_sum += err * err;
+			pos_err_max[mode] = fmaxf(pos_err_max[mode], err);
+			err_cnt++;
+		}
+
+		pos_rms[mode] = (float)sqrt(pos_err_sum / err_cnt);
+	}
+
+	bench_eskf_ins_reset();
+
+	printf("eskf delayed gps (%d ms): horizontal position error rms/max = %.3f/%.3f m"
+	       " (fused as present: %.3f/%.3f m, no delay: %.3f/%.3f m), history of %d entries (%d bytes)\n",
+	       (int)(gps_delay_us / 1000), pos_rms[2], pos_err_max[2], pos_rms[1], pos_err_max[1],
+	       pos_rms[0], pos_err_max[0], ESKF_INS_HISTORY_SIZE,
+	       (int)(ESKF_INS_HISTORY_SIZE * (sizeof(uint64_t) + 6 * sizeof(float))));
+
+	if(pos_rms[2] > pos_rms[1] * 0.5f || pos_err_max[2] > pos_err_max[1] * 0.5f) {
+		printf("error: delayed gps is not compensated\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* hover with biased and noisy imu while rolling, pitching and turning slowly. in a pure
+ * turn the horizontal accelerometer bias and the tilt driven by the horizontal gyroscope
+ * bias rotate together with the yaw and can not be told apart, the roll and pitch rates
+ * make them observable. the gps and the barometer are cut for the last seconds, the position
+ * drift of the dead reckoning is compared with the drift of an uncompensated vertical
+ * accelerometer bias (0.5 * a_b * t^2) */
+static bool bench_eskf_ins_bias_check(void)
+{
+	const uint64_t tick_period_us = 2500;
+	const int tick_cnt = 400 * 120;
+	const int outage_tick_cnt = 400 * 10;
+	const float yaw_rate = 2.0f * M_PI / 20.0f;
+	const float tilt_rate = 0.3f; //amplitude of the roll and pitch rates [rad/s]
+	const float accel_bias[3] = {0.15f, -0.1f, 0.08f}; //[m/s^2]
+	const float gyro_bias[3] = {0.01f, -0.008f, 0.006f}; //[rad/s]
+	const float mag_ned[3] = {0.45f, 0.0f, 0.89f};
+
+	bench_eskf_ins_reset();
+	srand(11);
+
+	/* the vehicle starts from the initial attitude of the eskf */
+	float q_b2i[4], q[4];
+	get_eskf_ins_attitude_quaternion(q_b2i);
+	quaternion_conj(q_b2i, q);
+
+	float R[9], Rt[9], accel[3], gyro[3], mag[3];
+	float theta_err_max = 0.0f;
+
+	int i, j;
+	for(i = 0; i < tick_cnt; i++) {
+		uint64_t time_us = (uint64_t)(i + 1) * tick_period_us;
+		float time = (float)time_us * 1e-6f;
+
+		/* body rates of the roll and pitch swings (7s and 11s) and of the turn */
+		float w[3];
+		w[0] = tilt_rate * cosf(2.0f * M_PI * time / 7.0f);
+		w[1] = tilt_rate * sinf(2.0f * M_PI * time / 11.0f);
+		w[2] = yaw_rate;
+
+		float rotvec[3] = {w[0] * 0.0025f, w[1] * 0.0025f, w[2] * 0.0025f};
+		bench_quat_rotate(q, rotvec);
+		quat_to_rotation_matrix(q, R, Rt);
+
+		/* hover, the specific force is Rt * [0; 0; -g] */
+		for(j = 0; j < 3; j++) {
+			accel[j] = R[2 * 3 + j] * -9.78f + accel_bias[j] +
+			           ((float)rand() / RAND_MAX - 0.5f) * 0.2f;
+			gyro[j] = w[j] + gyro_bias[j] + ((float)rand() / RAND_MAX - 0.5f) * 0.01f;
+			mag[j] = R[0 * 3 + j] * mag_ned[0] + R[1 * 3 + j] * mag_ned[1] +
+			         R[2 * 3 + j] * mag_ned[2] + ((float)rand() / RAND_MAX - 0.5f) * 0.02f;
+		}
+
+		eskf_ins_predict(accel, gyro);
+		eskf_ins_accelerometer_correct(accel);
+		eskf_ins_history_push(time_us);
+
+		bool outage = i >= (tick_cnt - outage_tick_cnt);
+
+		/* compass and barometer (50Hz) */
+		if((i % 8) == 0) {
+			eskf_ins_magnetometer_correct(mag);
+			if(outage == false) {
+				eskf_ins_barometer_correct(((float)rand() / RAND_MAX - 0.5f) * 0.2f, 0.0f);
+			}
+		}
+
+		/* gps (5Hz) */
+		if((i % 80) == 0 && outage == false) {
+			eskf_ins_gps_correct(((float)rand() / RAND_MAX - 0.5f) * 0.2f,
+			                     ((float)rand() / RAND_MAX - 0.5f) * 0.2f,
+			                     ((float)rand() / RAND_MAX - 0.5f) * 0.05f,
+			                     ((float)rand() / RAND_MAX - 0.5f) * 0.05f);
+		}
+
+		/* attitude error after the convergence */
+		if(i >= 400 * 60) {
+			float q_est[4];
+			get_eskf_ins_attitude_quaternion(q_b2i);
+			quaternion_conj(q_b2i, q_est);
+			float R_est[9], R_est_t[9];
+			quat_to_rotation_matrix(q_est, R_est, R_est_t);
+			/* angle of R_true^T * R_est */
+			float trace = 0.0f;
+			for(j = 0; j < 3; j++) {
+				trace += R[0 * 3 + j] * R_est[0 * 3 + j] + R[1 * 3 + j] * R_est[1 * 3 + j] +
+				         R[2 * 3 + j] * R_est[2 * 3 + j];
+			}
+			float theta_err = acosf(fminf(1.0f, (trace - 1.0f) * 0.5f));
+			theta_err_max = fmaxf(theta_err_max, theta_err);
+		}
+	}
+
+	float pos[3], vel[3], accel_bias_est[3], gyro_bias_est[3];
+	get_eskf_ins_position_velocity(pos, vel);
+	get_eskf_ins_imu_bias(accel_bias_est, gyro_bias_est);
+
+	bench_eskf_ins_reset();
+
+	float outage_time = (float)outage_tick_cnt * (float)tick_period_us * 1e-6f;
+	float drift = sqrtf(pos[0] * pos[0] + pos[1] * pos[1] + pos[2] * pos[2]);
+	float drift_uncompensated = 0.5f * accel_bias[2] * outage_time * outage_time;
+
+	printf("eskf imu bias: accel = (%.3f, %.3f, %.3f) m/s^2 (true: %.3f, %.3f, %.3f),"
+	       " gyro = (%.4f, %.4f, %.4f) rad/s (true: %.4f, %.4f, %.4f)\n",
+	       accel_bias_est[0], accel_bias_est[1], accel_bias_est[2],
+	       accel_bias[0], accel_bias[1], accel_bias[2],
+	       gyro_bias_est[0], gyro_bias_est[1], gyro_bias_est[2],
+	       gyro_bias[0], gyro_bias[1], gyro_bias[2]);
+	printf("eskf imu bias: max attitude error = %.2f deg, position drift after %.0fs without"
+	       " gps and barometer = %.3f m (uncompensated bias: %.3f m)\n",
+	       rad_to_deg(theta_err_max), outage_time, drift, drift_uncompensated);
+
+	/* the accelerometer bias errors should be less than 0.01m/s^2 and the gyroscope
+	 * bias errors less than 0.001rad/s on every axis */
+	for(j = 0; j < 3; j++) {
+		if(fabsf(accel_bias_est[j] - accel_bias[j]) > 0.01f ||
+		   fabsf(gyro_bias_est[j] - gyro_bias[j]) > 0.001f) {
+			printf("error: eskf imu bias is not estimated\n");
+			return false;
+		}
+	}
+
+	if(rad_to_deg(theta_err_max) > 2.0f || drift > 0.1f * drift_uncompensated) {
+		printf("error: eskf drifts with the imu bias\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* pure coning motion, the x-y plane of the body frame wobbles with the half cone
+ * angle beta at the frequency omega [rad/s] */
+static void bench_coning_quat(double beta, double omega, double t, float *q)
+{
+	q[0] = (float)cos(0.5 * beta);
+	q[1] = (float)(sin(0.5 * beta) * cos(omega * t));
+	q[2] = (float)(sin(0.5 * beta) * sin(omega * t));
+	q[3] = 0.0f;
+}
+
+static void bench_coning_gyro(double beta, double omega, double t, float *gyro)
+{
+	gyro[0] = (float)(-omega * sin(beta) * sin(omega * t));
+	gyro[1] = (float)(omega * sin(beta) * cos(omega * t));
+	gyro[2] = (float)(-omega * (1.0 - cos(beta)));
+}
+
+/* sculling motion, the body rolls with the amplitude a and the specific force
+ * along the y axis oscillates in phase with the amplitude b */
+static void bench_sculling_sample(double a, double b, double omega, double t,
+                                  double *roll, float *gyro, float *accel)
+{
+	*roll = a * sin(omega * t);
+	gyro[0] = (float)(a * omega * cos(omega * t));
+	gyro[1] = gyro[2] = 0.0f;
+	accel[0] = accel[2] = 0.0f;
+	accel[1] = (float)(b * sin(omega * t));
+}
+
+/* feed the imu sample queue at 1kHz with the coning and the sculling motion and
+ * integrate the increments at 400Hz, the mean rates of the previous estimators
+ * miss the rotation inside of the interval. the samples are taken 10h after the
+ * boot, a float second timestamp only resolves ~4ms there */
+static bool bench_imu_preint_check(void)
+{
+	const double sample_period = 0.001;
+	const int sample_cnt = 10000; //10s
+	const double beta = 0.02, omega = 2.0 * M_PI * 50.0;
+	const double roll_amp = 0.02, accel_amp = 5.0;
+	const uint64_t start_time_us = 36000000000ULL; //10h
+
+	float zero[3] = {0.0f, 0.0f, 0.0f};
+	float gyro[3], gyro_deg[3], accel[3];
+	float delta_angle[3], delta_vel[3], dt;
+	int i, j;
+
+	/* coning: the attitude integrated with the increments against the truth */
+	float q_preint[4], q_mean[4], q_true[4];
+	float angle_sum[3] = {0.0f, 0.0f, 0.0f};
+	int preint_cnt = 0;
+
+	imu_sample_flush();
+	for(i = 0; i < sample_cnt; i++) {
+		double t = (double)i * sample_period;
+		bench_coning_gyro(beta, omega, t, gyro);
+		for(j = 0; j < 3; j++) {
+			gyro_deg[j] = rad_to_deg(gyro[j]);
+		}
+		imu_sample_push(zero, gyro_deg, start_time_us + (uint64_t)i * 1000);
+
+		if(i == 0) {
+			/* the integration starts from the first sample */
+			bench_coning_quat(beta, omega, t, q_preint);
+			quaternion_copy(q_mean, q_preint);
+			imu_read_increments(delta_angle, delta_vel, &dt);
+			continue;
+		}
+
+		/* rectangular sum of the samples, the average of the previous ahrs */
+		for(j = 0; j < 3; j++) {
+			angle_sum[j] += gyro[j] * (float)sample_period;
+		}
+
+		/* 400Hz estimator, 2 or 3 samples per step */
+		if((i * 2) % 5 >= 3 || i == sample_cnt - 1) {
+			if(imu_read_increments(delta_angle, delta_vel, &dt) == false) {
+				printf("error: no imu increments from the sample queue\n");
+				return false;
+			}
+			bench_quat_rotate(q_preint, delta_angle);
+			bench_quat_rotate(q_mean, angle_sum);
+			memset(angle_sum, 0, sizeof(angle_sum));
+			preint_cnt++;
+		}
+	}
+	bench_coning_quat(beta, omega, (double)(sample_cnt - 1) * sample_period, q_true);
+
+	float q_conj[4], q_err[4];
+	quaternion_conj(q_true, q_conj);
+	quaternion_mult(q_conj, q_preint, q_err);
+	float coning_err = 2.0f * asinf(fminf(sqrtf(q_err[1] * q_err[1] + q_err[2] * q_err[2] +
+	                                             q_err[3] * q_err[3]), 1.0f));
+	quaternion_mult(q_conj, q_mean, q_err);
+	float coning_err_mean = 2.0f * asinf(fminf(sqrtf(q_err[1] * q_err[1] + q_err[2] * q_err[2] +
+	                                                  q_err[3] * q_err[3]), 1.0f));
+
+	/* sculling: the velocity in the reference frame, the truth is integrated with
+	 * a fine step */
+	double v_true[3] = {0.0, 0.0, 0.0};
+	float v_preint[3] = {0.0f, 0.0f, 0.0f};
+	float v_mean[3] = {0.0f, 0.0f, 0.0f};
+	float vel_sum[3] = {0.0f, 0.0f, 0.0f};
+	double roll, roll_start = 0.0;
+
+	imu_sample_flush();
+	for(i = 0; i < sample_cnt; i++) {
+		double t = (double)i * sample_period;
+		bench_sculling_sample(roll_amp, accel_amp, omega, t, &roll, gyro, accel);
+		for(j = 0; j < 3; j++) {
+			gyro_deg[j] = rad_to_deg(gyro[j]);
+		}
+		/* the gap to the coning samples restarts the integration */
+		imu_sample_push(accel, gyro_deg, start_time_us + 20000000 + (uint64_t)i * 1000);
+
+		if(i == 0) {
+			imu_read_increments(delta_angle, delta_vel, &dt);
+			roll_start = roll;
+			continue;
+		}
+
+		const int fine_step_cnt = 100;
+		int k;
+		for(k = 0; k < fine_step_cnt; k++) {
+			double tk = t - sample_period + ((double)k + 0.5) * sample_period / fine_step_cnt;
+			double f = accel_amp * sin(omega * tk);
+			double r = roll_amp * sin(omega * tk);
+			v_true[1] += cos(r) * f * sample_period / fine_step_cnt;
+			v_true[2] += sin(r) * f * sample_period / fine_step_cnt;
+		}
+
+		for(j = 0; j < 3; j++) {
+			vel_sum[j] += accel[j] * (float)sample_period;
+		}
+
+		if((i * 2) % 5 >= 3 || i == sample_cnt - 1) {
+			if(imu_read_increments(delta_angle, delta_vel, &dt) == false) {
+				printf("error: no imu increments from the sample queue\n");
+				return false;
+			}
+
+			/* body to reference frame at the beginning of the interval */
+			float c = (float)cos(roll_start), s = (float)sin(roll_start);
+			v_preint[1] += c * delta_vel[1] - s * delta_vel[2];
+			v_preint[2] += s * delta_vel[1] + c * delta_vel[2];
+			v_mean[1] += c * vel_sum[1] - s * vel_sum[2];
+			v_mean[2] += s * vel_sum[1] + c * vel_sum[2];
+			memset(vel_sum, 0, sizeof(vel_sum));
+			roll_start = roll;
+		}
+	}
+
+	float sculling_err = sqrtf(powf(v_preint[1] - (float)v_true[1], 2.0f) +
+	                           powf(v_preint[2] - (float)v_true[2], 2.0f));
+	float sculling_err_mean = sqrtf(powf(v_mean[1] - (float)v_true[1], 2.0f) +
+	                                powf(v_mean[2] - (float)v_true[2], 2.0f));
+	imu_sample_flush();
+
+	printf("imu pre-integration (50Hz coning, %d steps): attitude error = %.4f deg"
+	       " (attitude error with the mean rate: %.3f deg)\n", preint_cnt,
+	       rad_to_deg(coning_err), rad_to_deg(coning_err_mean));
+	printf("imu pre-integration (50Hz sculling): velocity error = %.5f m/s"
+	       " (velocity error with the mean specific force: %.3f m/s,"
+	       " rectified sculling velocity: %.3f m/s)\n", sculling_err,
+	       sculling_err_mean, v_true[2]);
+
+	if(coning_err > 0.1f * coning_err_mean || sculling_err > 0.1f * sculling_err_mean) {
+		printf("error: imu pre-integration does not compensate the coning and sculling\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* drive the burst read state machine of the mpu6500 driver with the spi1 dma
+ * stand-in, a data ready interrupt before the completion drops the sample */
+static bool bench_mpu6500_burst_read_check(void)
+{
+	bench_mpu6500_reset();
+	uint32_t drop_cnt = mpu6500.burst_read_drop_cnt;
+
+	mpu6500_int_handler();
+	bool started = mpu6500.burst_read_busy;
+	mpu6500_int_handler();
+	host_spi_dma_complete(SPI1);
+	host_spi_dma_complete(SPI1); //spurious completion
+
+	int16_t *accel = mpu6500.accel_unscaled;
+	int16_t *gyro = mpu6500.gyro_unscaled;
+	bool passed = started == true && mpu6500.burst_read_busy == false &&
+	              mpu6500.burst_read_drop_cnt == drop_cnt + 1 &&
+	              accel[0] == -100 && accel[1] == 200 && accel[2] == -4096 &&
+	              gyro[0] == -10 && gyro[1] == 20 && gyro[2] == 30;
+
+	printf("mpu6500 spi1 dma burst read: accel = (%d, %d, %d), gyro = (%d, %d, %d),"
+	       " %lu dropped\n", accel[0], accel[1], accel[2], gyro[0], gyro[1], gyro[2],
+	       (unsigned long)(mpu6500.burst_read_drop_cnt - drop_cnt));
+
+	if(passed == false) {
+		printf("error: unexpected state of the mpu6500 burst read\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* feed the synthetic fifo frames of a sine wave through the parser and the
+ * decimator, returns the peak of the decimated gyroscope after the transient
+ * of the filter [lsb]. the accelerometer and the timestamps of the sample
+ * queue are checked on the way */
+static float bench_mpu6500_fifo_response(float freq, float amplitude, bool *passed)
+{
+	const int ms_cnt = 200;
+	/* (taps - 1) / 2 frames of 125us, rounded to the microsecond */
+	uint64_t delay_us = (uint64_t)lrintf((float)(MPU6500_FIFO_FIR_TAPS - 1) * 0.5f *
+	                                     (float)MPU6500_FIFO_FRAME_PERIOD_US);
+
+	bench_mpu6500_reset();
+	imu_sample_flush();
+
+	float peak = 0.0f;
+	uint64_t last_time_us = 0;
+	int sample_cnt = 0;
+
+	int i;
+	for(i = 0; i < ms_cnt; i++) {
+		/* time of the last frame of the drain, 1s after the boot */
+		uint64_t time_us = 1000000 + (uint64_t)(i + 1) * 1000 - MPU6500_FIFO_FRAME_PERIOD_US;
+
+		bench_fifo_fill(bench_fifo_buf, MPU6500_FIFO_DECIMATION, i * MPU6500_FIFO_DECIMATION,
+		                freq, amplitude);
+		mpu6500_fifo_parse(bench_fifo_buf, MPU6500_FIFO_DECIMATION, time_us);
+
+		imu_sample_t sample;
+		while(imu_sample_pop(&sample) == true) {
+			if(sample.time_us != time_us - delay_us ||
+			   (sample_cnt > 0 && sample.time_us - last_time_us != 1000)) {
+				printf("error: unexpected timestamp of the decimated sample (%llu)\n",
+				       (unsigned long long)sample.time_us);
+				*passed = false;
+			}
+
+			/* skip the transient of the filter */
+			if(sample_cnt > MPU6500_FIFO_FIR_TAPS) {
+				if(sample.accel[0] != 0.0f || sample.accel[1] != 0.0f ||
+				   fabsf(sample.accel[2] + 9.81f) > 1e-4f) {
+					printf("error: unexpected accelerometer of the decimated sample\n");
+					*passed = false;
+				}
+
+				peak = fmaxf(peak, fabsf(sample.gyro[0] / mpu6500.gyro_scale));
+			}
+
+			last_time_us = sample.time_us;
+			sample_cnt++;
+		}
+	}
+
+	if(sample_cnt != ms_cnt) {
+		printf("error: %d decimated samples from %dms of the fifo\n", sample_cnt, ms_cnt);
+		*passed = false;
+	}
+
+	return peak;
+}
+
+/* frequency response of the fifo decimation (8kHz -> 1kHz) and the throughput
+ * of the parser */
+static bool bench_mpu6500_fifo_check(void)
+{
+	const float amplitude = 8000.0f; //[lsb]
+	bool passed = true;
+
+	float dc = bench_mpu6500_fifo_response(0.0f, amplitude, &passed);
+	float gain_50hz = bench_mpu6500_fifo_response(50.0f, amplitude, &passed) / amplitude;
+	float gain_200hz = bench_mpu6500_fifo_response(200.0f, amplitude, &passed) / amplitude;
+	float gain_1050hz = bench_mpu6500_fifo_response(1050.0f, amplitude, &passed) / amplitude;
+	float gain_3khz = bench_mpu6500_fifo_response(3000.0f, amplitude, &passed) / amplitude;
+
+	printf("mpu6500 fifo decimation: gain = %.3f (50Hz), %.3f (200Hz), %.1fdB (1050Hz),"
+	       " %.1fdB (3kHz)\n", gain_50hz, gain_200hz, 20.0f * log10f(gain_1050hz + 1e-6f),
+	       20.0f * log10f(gain_3khz + 1e-6f));
+
+	if(dc != 0.0f || gain_50hz < 0.97f || gain_50hz > 1.01f || gain_200hz < 0.7f ||
+	   gain_1050hz > 0.01f || gain_3khz > 0.01f) {
+		printf("error: unexpected frequency response of the fifo decimation\n");
+		passed = false;
+	}
+
+	/* throughput: parse one second of the fifo */
+	bench_mpu6500_fifo_reset();
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	int i;
+	for(i = 0; i < 1000; i++) {
+		bench_mpu6500_fifo_parse();
+		imu_sample_flush();
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double elapsed = (double)(end.tv_sec - start.tv_sec) +
+	                 (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+
+	printf("mpu6500 fifo parse throughput: %.0f frames/s (%.0f frames/s of the sensor)\n",
+	       (1000.0 * MPU6500_FIFO_DECIMATION) / elapsed, MPU6500_FIFO_SAMPLE_RATE);
+
+	imu_sample_flush();
+
+	return passed;
+}
+
+/* stream a byte sequence through the dma ring with bursts and reads of varying
+ * sizes across the wraparound, then let the dma run ahead of the consumer and
+ * check if the overrun is counted and only the intact bytes are returned */
+static bool bench_dma_rx_ring_check(void)
+{
+	uint8_t burst[BENCH_DMA_RX_RING_SIZE];
+	uint8_t next_tx = 0, next_rx = 0;
+	uint32_t total = 0;
+	bool passed = true;
+
+	bench_dma_rx_ring_reset();
+	srand(1);
+
+	int i, j;
+	for(i = 0; i < 100000; i++) {
+		/* burst of 1 ~ half of the buffer */
+		int burst_size = 1 + rand() % (BENCH_DMA_RX_RING_SIZE / 2);
+		for(j = 0; j < burst_size; j++) {
+			burst[j] = next_tx++;
+		}
+		bench_dma_rx_write(burst, burst_size);
+
+		int read_size;
+		while((read_size = dma_rx_ring_read(&bench_dma_rx_ring, bench_dma_rx_data,
+		                                    1 + rand() % BENCH_DMA_RX_READ_SIZE)) > 0) {
+			for(j = 0; j < read_size; j++) {
+				if(bench_dma_rx_data[j] != next_rx++) {
+					passed = false;
+				}
+			}
+			total += read_size;
+		}
+	}
+
+	uint32_t overrun_cnt = dma_rx_ring_get_overrun_cnt(&bench_dma_rx_ring);
+	if(passed == false || next_rx != next_tx || overrun_cnt != 0) {
+		printf("error: corrupted stream of the dma ring (%lu overrun)\n",
+		       (unsigned long)overrun_cnt);
+		passed = false;
+	}
+
+	/* the dma writes 3/4 of the buffer without being read */
+	int overrun_size = BENCH_DMA_RX_RING_SIZE * 3 / 4;
+	for(j = 0; j < overrun_size; j++) {
+		burst[j] = next_tx++;
+	}
+	bench_dma_rx_write(burst, overrun_size);
+
+	uint8_t expected = burst[overrun_size - BENCH_DMA_RX_RING_SIZE / 2];
+	int read_cnt = 0, read_size;
+	while((read_size = dma_rx_ring_read(&bench_dma_rx_ring, bench_dma_rx_data,
+	                                    BENCH_DMA_RX_READ_SIZE)) > 0) {
+		for(j = 0; j < read_size; j++) {
+			if(bench_dma_rx_data[j] != expected++) {
+				passed = false;
+			}
+		}
+		read_cnt += read_size;
+	}
+
+	overrun_cnt = dma_rx_ring_get_overrun_cnt(&bench_dma_rx_ring);
+
+	printf("dma rx ring: %lu bytes streamed across the wraparound, overrun of %d bytes"
+	       " detected as %lu dropped and %d read\n", (unsigned long)total, overrun_size,
+	       (unsigned long)overrun_cnt, read_cnt);
+
+	if(overrun_cnt != (uint32_t)(overrun_size - BENCH_DMA_RX_RING_SIZE / 2) ||
+	   read_cnt != BENCH_DMA_RX_RING_SIZE / 2 || passed == false) {
+		printf("error: unexpected overrun handling of the dma ring\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* fuzz the frame parser with a synthetic stream of the given frame rate and
+ * length: random bit flips, lost bytes and inserted garbage. every emitted
+ * frame must be one of the transmitted frames and the intact frames must be
+ * recovered except the ones following a lost or inserted byte */
+static bool bench_frame_parser_fuzz(int frame_size, float frame_rate, float duration)
+{
+	frame_parser_t parser;
+	uint8_t buf[VINS_MONO_SERIAL_MSG_SIZE];
+	uint8_t frame[VINS_MONO_SERIAL_MSG_SIZE];
+	uint8_t expected[VINS_MONO_SERIAL_MSG_SIZE];
+
+	frame_parser_init(&parser, buf, frame_size);
+	srand(2);
+
+	int frame_cnt = (int)(frame_rate * duration);
+	int intact_cnt = 0, resync_cnt = 0, recovered_cnt = 0, false_cnt = 0;
+	bool last_intact = true;
+
+	int seq, i;
+	for(seq = 0; seq < frame_cnt; seq++) {
+		int size = frame_size;
+		bench_frame_pack(frame, size, seq);
+
+		int fault = rand() % 100;
+		int fault_pos = rand() % size;
+		bool intact = true;
+
+		if(fault < 3) {
+			/* bit flip, the id byte is not covered by the checksum */
+			frame[fault_pos] ^= 1 << (rand() % 8);
+			intact = fault_pos == 2;
+		} else if(fault < 5) {
+			/* lost byte */
+			memmove(&frame[fault_pos], &frame[fault_pos + 1], size - fault_pos - 1);
+			size--;
+			intact = false;
+		}
+
+		/* garbage between the frames (the start and end byte included) */
+		if(rand() % 100 < 3) {
+			int garbage_size = 1 + rand() % 8;
+			for(i = 0; i < garbage_size; i++) {
+				uint8_t c = rand() % 4 == 0 ? FRAME_PARSER_START_BYTE : (uint8_t)rand();
+				frame_parser_feed(&parser, c);
+			}
+			last_intact = false;
+		}
+
+		for(i = 0; i < size; i++) {
+			if(frame_parser_feed(&parser, frame[i]) == true) {
+				uint32_t recv_seq;
+				memcpy(&recv_seq, &buf[3], sizeof(uint32_t));
+				bench_frame_pack(expected, frame_size, recv_seq);
+				expected[2] = buf[2];
+
+				if(memcmp(expected, buf, frame_size) != 0 || (int)recv_seq > seq) {
+					false_cnt++;
+				} else if((int)recv_seq == seq) {
+					recovered_cnt++;
+				}
+			}
+		}
+
+		if(intact == true) {
+			intact_cnt++;
+			if(last_intact == false) {
+				resync_cnt++;
+			}
+		}
+		last_intact = intact;
+	}
+
+	printf("frame parser fuzz (%d bytes, %.0fHz, %.0fs): %d frames, %d intact, %d recovered,"
+	       " %d false, %lu framing / %lu checksum errors\n", frame_size, frame_rate,
+	       duration, frame_cnt, intact_cnt, recovered_cnt, false_cnt,
+	       (unsigned long)parser.framing_err_cnt, (unsigned long)parser.checksum_err_cnt);
+
+	if(false_cnt != 0 || recovered_cnt < intact_cnt - resync_cnt ||
+	   recovered_cnt > intact_cnt) {
+		printf("error: unexpected frames emitted by the frame parser\n");
+		return false;
+	}
+
+	return true;
+}
+
+static bool bench_frame_parser_check(void)
+{
+	if(bench_frame_parser_fuzz(OPTITRACK_SERIAL_MSG_SIZE, 120.0f, 600.0f) == false ||
+	   bench_frame_parser_fuzz(VINS_MONO_SERIAL_MSG_SIZE, 400.0f, 600.0f) == false) {
+		return false;
+	}
+
+	/* throughput of a clean stream */
+	bench_frame_parser_reset();
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	int i;
+	for(i = 0; i < 1000000; i++) {
+		bench_frame_parser_feed();
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double elapsed = (double)(end.tv_sec - start.tv_sec) +
+	                 (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+
+	printf("frame parser throughput: %.1f MB/s (%.0f frames/s, %lu parsed)\n",
+	       (1e6 * OPTITRACK_SERIAL_MSG_SIZE) / elapsed * 1e-6, 1e6 / elapsed,
+	       (unsigned long)bench_frame_parser.frame_cnt);
+
+	if(bench_frame_parser.frame_cnt != 1000000) {
+		printf("error: frames lost on a clean stream\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* run the ms5611 driver on the queued spi3 transactions and check the
+ * conversion results and the number of transactions per sample */
+static bool bench_ms5611_check(void)
+{
+	bench_ms5611_reset();
+	bench_ms5611_select_cnt = 0;
+	uint32_t overrun_cnt = ms5611.spi_overrun_cnt;
+
+	const int period_cnt = 100; //1s of the 10ms periods
+	int i;
+	for(i = 0; i < period_cnt; i++) {
+		bench_ms5611_driver_handler();
+		bench_ms5611_complete();
+	}
+
+	/* a new period while the transactions are still queued is skipped */
+	bench_ms5611_driver_handler();
+	bench_ms5611_driver_handler();
+	bench_ms5611_complete();
+
+	printf("ms5611 on spi3 transactions: d1 = %ld, d2 = %ld, %.2f deg c, %.2f mbar,"
+	       " %d transactions in %d periods, %lu skipped\n", (long)ms5611.d1,
+	       (long)ms5611.d2, ms5611.temp_raw, ms5611.press_raw, bench_ms5611_select_cnt,
+	       period_cnt, (unsigned long)(ms5611.spi_overrun_cnt - overrun_cnt));
+
+	/* one conversion command per period and one adc read except the first */
+	if(ms5611.d1 != (int32_t)bench_ms5611_d1 || ms5611.d2 != (int32_t)bench_ms5611_d2 ||
+	   fabsf(ms5611.temp_raw - 20.07f) > 1e-3f || fabsf(ms5611.press_raw - 1000.09f) > 1e-3f ||
+	   bench_ms5611_select_cnt != (period_cnt + 1) * 2 - 1 ||
+	   ms5611.spi_overrun_cnt - overrun_cnt != 1) {
+		printf("error: unexpected ms5611 conversion\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* run the ist8310 register accesses on the i2c2 transactions: chip id, single
+ * measurement trigger and data read, then the nack of a detached device */
+static bool bench_ist8310_i2c_check(void)
+{
+	bench_ist8310_reset();
+	bench_ist8310_complete_cnt = 0;
+	uint64_t bus_time = host_i2c_get_bus_time_ns(I2C2);
+
+	uint8_t id = 0;
+	i2c_transaction_t who_am_i = {
+		.addr = IST8310_ADDR, .reg = IST8310_REG_WIA, .data = &id, .size = 1, .read = true
+	};
+	i2c2_transaction_submit(&who_am_i);
+
+	uint8_t ctrl1 = IST8310_ODR_SINGLE;
+	i2c_transaction_t trigger = {
+		.addr = IST8310_ADDR, .reg = IST8310_REG_CTRL1, .data = &ctrl1, .size = 1, .read = false
+	};
+	i2c2_transaction_submit(&trigger);
+
+	/* the data read of one sample */
+	uint64_t sample_time = host_i2c_get_bus_time_ns(I2C2);
+	i2c2_transaction_submit(&bench_ist8310_transaction);
+	sample_time = host_i2c_get_bus_time_ns(I2C2) - sample_time;
+
+	int16_t mag[3];
+	mag[0] = (((int16_t)bench_ist8310_buf[3]) << 8 | bench_ist8310_buf[2]);
+	mag[1] = (((int16_t)bench_ist8310_buf[1]) << 8 | bench_ist8310_buf[0]);
+	mag[2] = (((int16_t)bench_ist8310_buf[5]) << 8 | bench_ist8310_buf[4]);
+
+	bool read_error = who_am_i.error || trigger.error || bench_ist8310_transaction.error;
+
+	/* the device does not acknowledge the address */
+	bench_ist8310_present = false;
+	i2c2_transaction_submit(&bench_ist8310_transaction);
+	bool nack_error = bench_ist8310_transaction.error;
+	bench_ist8310_present = true;
+
+	bus_time = host_i2c_get_bus_time_ns(I2C2) - bus_time;
+
+	printf("ist8310 on i2c2 transactions: id = 0x%02x, mag = {%d, %d, %d}, %d completions,"
+	       " %.1f us per sample, %.1f us in total, nack %s\n", id, mag[0], mag[1], mag[2],
+	       bench_ist8310_complete_cnt, sample_time * 1e-3, bus_time * 1e-3,
+	       nack_error ? "detected" : "missed");
+
+	/* 1 start + 2 bytes + restart + 7 bytes + stop at 400kHz */
+	if(id != IST8310_CHIP_ID || bench_ist8310_regs[IST8310_REG_CTRL1] != IST8310_ODR_SINGLE ||
+	   mag[0] != -300 || mag[1] != 1200 || mag[2] != -2000 || read_error == true ||
+	   nack_error == false || bench_ist8310_complete_cnt != 2 ||
+	   sample_time != (3 + 9 * 9) * 2500) {
+		printf("error: unexpected ist8310 i2c transaction\n");
+		return false;
+	}
+
+	return true;
+}
+
+static int bench_ist8310_retry_cnt;
+
+/* resubmit the failed read from the completion like the driver task would */
+static void bench_ist8310_retry_callback(i2c_transaction_t *transaction,
+                                         BaseType_t *higher_priority_task_woken)
+{
+	bench_ist8310_complete_cnt++;
+	if(transaction->error == true && bench_ist8310_retry_cnt++ == 0) {
+		i2c2_transaction_submit(transaction);
+	}
+}
+
+/* inject bus errors into the ist8310 transactions of the host i2c2: at the
+ * address byte, at the register byte of a write and in the middle of the data
+ * read. every failed transaction has to release the bus with one stop
+ * condition, complete with the error flag and leave the queue running */
+static bool bench_i2c2_error_check(void)
+{
+	bench_ist8310_reset();
+	bool passed = true;
+
+	/* bytes of a read: address, register, address again, then the data */
+	const int error_bytes[] = {0, 1, 5};
+	for(int i = 0; i < 3; i++) {
+		memset(bench_ist8310_buf, 0, sizeof(bench_ist8310_buf));
+		bench_ist8310_complete_cnt = 0;
+		bench_ist8310_retry_cnt = 0;
+		bench_ist8310_stop_cnt = 0;
+
+		i2c_transaction_t read = bench_ist8310_transaction;
+		read.callback = bench_ist8310_retry_callback;
+
+		host_i2c_inject_bus_error(I2C2, error_bytes[i]);
+		i2c2_transaction_submit(&read);
+
+		int16_t mag[3];
+		mag[0] = (((int16_t)bench_ist8310_buf[3]) << 8 | bench_ist8310_buf[2]);
+		mag[1] = (((int16_t)bench_ist8310_buf[1]) << 8 | bench_ist8310_buf[0]);
+		mag[2] = (((int16_t)bench_ist8310_buf[5]) << 8 | bench_ist8310_buf[4]);
+
+		printf("i2c2 bus error at byte %d: %d completions, %d stop conditions,"
+		       " retried read mag = {%d, %d, %d}\n", error_bytes[i],
+		       bench_ist8310_complete_cnt, bench_ist8310_stop_cnt, mag[0], mag[1], mag[2]);
+
+		/* the failed read and its retry */
+		if(bench_ist8310_complete_cnt != 2 || bench_ist8310_stop_cnt != 2 ||
+		   read.error == true || read.busy == true ||
+		   mag[0] != -300 || mag[1] != 1200 || mag[2] != -2000) {
+			passed = false;
+		}
+	}
+
+	/* the error in a register write must not reach the device */
+	uint8_t ctrl1 = IST8310_ODR_SINGLE;
+	i2c_transaction_t trigger = {
+		.addr = IST8310_ADDR, .reg = IST8310_REG_CTRL1, .data = &ctrl1, .size = 1, .read = false
+	};
+	bench_ist8310_stop_cnt = 0;
+	host_i2c_inject_bus_error(I2C2, 2);
+	i2c2_transaction_submit(&trigger);
+	bool write_error = trigger.error;
+	bool write_applied = bench_ist8310_regs[IST8310_REG_CTRL1] == IST8310_ODR_SINGLE;
+
+	/* the next write goes through */
+	i2c2_transaction_submit(&trigger);
+
+	printf("i2c2 bus error in the register write: %s, %d stop conditions\n",
+	       write_error ? "detected" : "missed", bench_ist8310_stop_cnt);
+
+	if(write_error == false || write_applied == true || trigger.error == true ||
+	   bench_ist8310_stop_cnt != 2 || bench_ist8310_regs[IST8310_REG_CTRL1] != IST8310_ODR_SINGLE) {
+		passed = false;
+	}
+
+	if(passed == false) {
+		printf("error: unexpected i2c2 bus error recovery\n");
+	}
+
+	return passed;
+}
+
+/* replay a recorded s-bus stream through the uart4 dma and idle line: frames
+ * with the flags and the s-bus2 footer, then a truncated, an oversized and a
+ * corrupted burst which must be dropped without changing the last frame */
+static bool bench_sbus_check(void)
+{
+	uint16_t rc_val[SBUS_CHANNEL_CNT];
+	uint8_t burst[SBUS_FRAME_SIZE * 2];
+	const uint64_t period_us = 7000; //high speed mode
+	uint64_t time_us = get_time_us();
+	bool passed = true;
+
+	sbus_init();
+	uart4_init(100000);
+
+	int i;
+	for(i = 0; i < SBUS_CHANNEL_CNT; i++) {
+		rc_val[i] = (uint16_t)((i * 131 + 7) & 0x07ff);
+	}
+	rc_val[0] = (RC_ROLL_MAX + RC_ROLL_MIN) / 2;
+	rc_val[1] = RC_PITCH_MIN;
+	rc_val[2] = RC_THROTTLE_MAX;
+	rc_val[3] = RC_YAW_MAX;
+	rc_val[4] = RC_SAFETY_MAX;
+	rc_val[5] = RC_AUTO_FLIGHT_MAX;
+	rc_val[6] = RC_FLIGHT_MODE_MID;
+	rc_val[15] = 0x07ff;
+
+	struct {
+		uint8_t flags;
+		uint8_t footer;
+		bool valid;
+	} frames[] = {
+		{0, SBUS_FOOTER, true},
+		{SBUS_FLAG_CH17 | SBUS_FLAG_CH18, SBUS_FOOTER, true},
+		{SBUS_FLAG_FRAME_LOST, SBUS_FOOTER, true},
+		{SBUS_FLAG_FRAME_LOST | SBUS_FLAG_FAILSAFE, SBUS_FOOTER, true},
+		{SBUS_FLAG_CH17, 0x14, true}, //s-bus2, telemetry slot 1
+		{0, 0x55, false} //corrupted footer
+	};
+
+	int frame_cnt = (int)(sizeof(frames) / sizeof(frames[0]));
+	for(i = 0; i < frame_cnt; i++) {
+		time_us += period_us;
+		host_timer_set_time_ns(time_us * 1000ULL);
+
+		bench_sbus_pack(burst, rc_val, frames[i].flags, frames[i].footer);
+		host_uart_receive(UART4, burst, SBUS_FRAME_SIZE);
+
+		sbus_frame_t frame;
+		sbus_read_frame(&frame);
+
+		if(frames[i].valid == false) {
+			continue;
+		}
+
+		if(memcmp(frame.rc_val, rc_val, sizeof(rc_val)) != 0 ||
+		   frame.timestamp_us != time_us ||
+		   frame.ch17 != ((frames[i].flags & SBUS_FLAG_CH17) != 0) ||
+		   frame.ch18 != ((frames[i].flags & SBUS_FLAG_CH18) != 0) ||
+		   frame.frame_lost != ((frames[i].flags & SBUS_FLAG_FRAME_LOST) != 0) ||
+		   frame.failsafe != ((frames[i].flags & SBUS_FLAG_FAILSAFE) != 0)) {
+			printf("error: unexpected s-bus frame %d\n", i);
+			passed = false;
+		}
+	}
+	uint64_t last_time_us = time_us - period_us;
+
+	/* truncated frame */
+	time_us += period_us;
+	host_timer_set_time_ns(time_us * 1000ULL);
+	bench_sbus_pack(burst, rc_val, 0, SBUS_FOOTER);
+	host_uart_receive(UART4, burst, SBUS_FRAME_SIZE - 5);
+
+	/* two frames without the gap */
+	time_us += period_us;
+	host_timer_set_time_ns(time_us * 1000ULL);
+	bench_sbus_pack(&burst[SBUS_FRAME_SIZE], rc_val, 0, SBUS_FOOTER);
+	host_uart_receive(UART4, burst, SBUS_FRAME_SIZE * 2);
+
+	/* wrong header */
+	time_us += period_us;
+	host_timer_set_time_ns(time_us * 1000ULL);
+	burst[0] = 0x8f;
+	host_uart_receive(UART4, burst, SBUS_FRAME_SIZE);
+
+	sbus_frame_t frame;
+	sbus_read_frame(&frame);
+	if(frame.timestamp_us != last_time_us || sbus.framing_err_cnt != 4 ||
+	   sbus.frame_cnt != (uint32_t)(frame_cnt - 1)) {
+		printf("error: the invalid s-bus bursts are not dropped\n");
+		passed = false;
+	}
+
+	/* the receiver recovers with the next frame */
+	time_us += period_us;
+	host_timer_set_time_ns(time_us * 1000ULL);
+	bench_sbus_pack(burst, rc_val, 0, SBUS_FOOTER);
+	host_uart_receive(UART4, burst, SBUS_FRAME_SIZE);
+
+	radio_t rc;
+	sbus_rc_read(&rc);
+	sbus_read_frame(&frame);
+
+	uint16_t unscaled[SBUS_CHANNEL_CNT + 2];
+	sbus_get_unscaled(unscaled);
+
+	printf("s-bus: %lu frames decoded, %lu invalid bursts dropped, roll = %.2f, pitch = %.2f,"
+	       " throttle = %.2f, yaw = %.2f, safety = %d, auto flight = %d, aux1 mode = %d\n",
+	       (unsigned long)sbus.frame_cnt, (unsigned long)sbus.framing_err_cnt, rc.roll,
+	       rc.pitch, rc.throttle, rc.yaw, rc.safety, rc.auto_flight, rc.aux1_mode);
+
+	if(frame.timestamp_us != time_us || memcmp(unscaled, rc_val, sizeof(rc_val)) != 0 ||
+	   unscaled[16] != 0 || unscaled[17] != 0 ||
+	   fabsf(rc.roll) > 0.05f || rc.pitch != RC_PITCH_RANGE_MIN ||
+	   rc.throttle != RC_THROTTLE_RANGE_MAX || rc.yaw != RC_YAW_RANGE_MAX ||
+	   rc.safety != false || rc.auto_flight != true || rc.aux1_mode != RC_AUX_MODE2) {
+		printf("error: unexpected s-bus radio command\n");
+		passed = false;
+	}
+
+	return passed;
+}
+
+/* run the receiver model for 3 seconds with the 400Hz update of the flight
+ * control task: the background configuration with a rejected and a lost
+ * command, then a 10Hz nav-pvt stream mixed with nmea sentences and
+ * corrupted messages */
+static bool bench_ublox_check(void)
+{
+	const char nmea[] = "$GNGGA,092725.00,2447.72400,N,12059.79600,E,1,12,0.92,85.0,M,17.1,M,,*78\r\n";
+	const uint64_t period_us = 2500;
+	uint64_t time_us = get_time_us();
+	uint64_t cfg_done_time_us = 0;
+	uint32_t msg_cnt = ublox.parser.msg_cnt;
+	uint32_t checksum_err_cnt = ublox.parser.checksum_err_cnt;
+	int32_t last_seq = 0;
+	int sent_cnt = 0, corrupted_cnt = 0;
+
+	uart7_init(38400);
+	host_uart_set_tx_handler(UART7, bench_ublox_tx_handler);
+	bench_ublox_cfg_cnt = 0;
+	bench_ublox_ignore_cnt = 1;
+	ublox_m8n_init();
+
+	int i;
+	for(i = 0; i < 1200; i++) {
+		time_us += period_us;
+		host_timer_set_time_ns(time_us * 1000ULL);
+
+		/* nav-pvt at 10Hz */
+		if(i % 40 == 39) {
+			int32_t seq = i / 40 + 1;
+			uint8_t msg[BENCH_UBX_MSG_SIZE];
+			int msg_size = bench_ubx_nav_pvt_pack(msg, seq);
+
+			if(seq % 7 == 0) {
+				msg[30] ^= 0x10;
+				corrupted_cnt++;
+			} else {
+				last_seq = seq;
+			}
+			sent_cnt++;
+
+			host_uart_receive(UART7, (uint8_t *)nmea, sizeof(nmea) - 1);
+			host_uart_receive(UART7, msg, msg_size);
+		}
+
+		ublox_m8n_gps_update();
+
+		if(cfg_done_time_us == 0 && ublox_m8n_config_done() == true) {
+			cfg_done_time_us = time_us;
+		}
+	}
+
+	msg_cnt = ublox.parser.msg_cnt - msg_cnt;
+	checksum_err_cnt = ublox.parser.checksum_err_cnt - checksum_err_cnt;
+	host_uart_set_tx_handler(UART7, NULL);
+
+	int32_t longitude, latitude, height_msl;
+	ublox_m8n_get_longitude_latitude_height_s32(&longitude, &latitude, &height_msl);
+
+	printf("ublox: configuration of %d commands done after %.1f ms (%d sent, %lu resent, %lu rejected,"
+	       " %lu timeout), %d nav-pvt sent, %lu messages decoded, %lu checksum errors\n",
+	       bench_ublox_cfg_cnt - (int)ublox.cfg_resend_cnt,
+	       (double)(cfg_done_time_us - (time_us - 1200 * period_us)) * 1e-3,
+	       bench_ublox_cfg_cnt, (unsigned long)ublox.cfg_resend_cnt,
+	       (unsigned long)ublox.cfg_nak_cnt, (unsigned long)ublox.cfg_timeout_cnt, sent_cnt,
+	       (unsigned long)msg_cnt, (unsigned long)checksum_err_cnt);
+
+	/* 9 commands, 8 acknowledged, 1 rejected and 1 resent */
+	if(ublox_m8n_config_done() == false || bench_ublox_cfg_cnt != 10 ||
+	   ublox.cfg_resend_cnt != 1 || ublox.cfg_nak_cnt != 1 || ublox.cfg_timeout_cnt != 0 ||
+	   msg_cnt != (uint32_t)(9 + sent_cnt - corrupted_cnt) ||
+	   checksum_err_cnt != (uint32_t)corrupted_cnt || ublox_available() == false ||
+	   longitude != 1209966000 + last_seq || latitude != 247954000 - last_seq ||
+	   height_msl != 85000 + last_seq || ublox.vel_d != 2 * last_seq) {
+		printf("error: unexpected ublox configuration or nav-pvt decoding\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* trajectory of the optitrack check, 1m at 0.5Hz, 0.5m at 0.3Hz and 0.2m at
+ * 1Hz (up to 9.9m/s^2) */
+static void bench_optitrack_truth(double t, float *pos, float *vel)
+{
+	const double w[3] = {2.0 * M_PI * 0.5, 2.0 * M_PI * 0.3, 2.0 * M_PI * 1.0};
+
+	pos[0] = (float)(1.0 * sin(w[0] * t));
+	pos[1] = (float)(0.5 * cos(w[1] * t));
+	pos[2] = (float)(1.0 + 0.2 * sin(w[2] * t));
+	vel[0] = (float)(1.0 * w[0] * cos(w[0] * t));
+	vel[1] = (float)(-0.5 * w[1] * sin(w[1] * t));
+	vel[2] = (float)(0.2 * w[2] * cos(w[2] * t));
+}
+
+/* stream 120Hz optitrack frames with 0.5mm position noise, up to 2ms of
+ * transmission jitter and 10% dropped frames through the uart7 stand-in and
+ * compare the position and velocity read by the 400Hz control loop with the
+ * trajectory. the numerical differentiation of the previous driver (fixed
+ * period of 1/120s) is computed alongside for comparison */
+static bool bench_optitrack_check(void)
+{
+	const uint64_t frame_period_us = 8333;
+	const uint64_t tick_period_us = 2500;
+	const int tick_cnt = 400 * 20;
+	uint64_t time_base_us = get_time_us() + 1000000;
+
+	uint8_t frame[OPTITRACK_SERIAL_MSG_SIZE];
+	float pos[3], vel[3];
+	float fixed_pos_last[3] = {0}, fixed_vel[3] = {0}, frame_pos[3] = {0};
+	double vel_err_sum = 0.0, fixed_vel_err_sum = 0.0, pos_err_sum = 0.0, frame_pos_err_sum = 0.0;
+	float vel_err_max = 0.0f, fixed_vel_err_max = 0.0f;
+	int frame_index = 0, sent_cnt = 0, dropped_cnt = 0, err_cnt = 0;
+	bool frame_received = false;
+
+	uart7_init(115200);
+	optitrack_init(1);
+	srand(5);
+
+	uint64_t next_capture_us = time_base_us;
+	uint64_t next_arrival_us = next_capture_us + OPTITRACK_FRAME_TX_TIME + rand() % 2000;
+
+	int i, j;
+	for(i = 0; i < tick_cnt; i++) {
+		uint64_t tick_us = time_base_us + 100000 + i * tick_period_us;
+
+		/* deliver the frames which arrived before the tick */
+		while(next_arrival_us <= tick_us) {
+			double t = (double)(next_capture_us - time_base_us) * 1e-6;
+			bench_optitrack_truth(t, pos, vel);
+
+			for(j = 0; j < 3; j++) {
+				pos[j] += ((float)rand() / RAND_MAX - 0.5f) * 0.001f;
+			}
+
+			if(rand() % 10 != 0) {
+				float q[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+				frame[0] = FRAME_PARSER_START_BYTE;
+				frame[2] = 1; //id
+				memcpy(&frame[3], pos, sizeof(pos));
+				memcpy(&frame[15], q, sizeof(q));
+				frame[OPTITRACK_SERIAL_MSG_SIZE - 1] = FRAME_PARSER_END_BYTE;
+				frame[1] = frame_parser_checksum(&frame[3], OPTITRACK_SERIAL_MSG_SIZE - 4);
+
+				host_timer_set_time_ns(next_arrival_us * 1000ULL);
+				host_uart_receive(UART7, frame, OPTITRACK_SERIAL_MSG_SIZE);
+				sent_cnt++;
+
+				/* previous driver */
+				for(j = 0; j < 3; j++) {
+					fixed_vel[j] = frame_received ? (pos[j] - fixed_pos_last[j]) * 120.0f : 0.0f;
+					fixed_pos_last[j] = pos[j];
+					frame_pos[j] = pos[j];
+				}
+				frame_received = true;
+			} else {
+				dropped_cnt++;
+			}
+
+			frame_index++;
+			next_capture_us = time_base_us + frame_index * frame_period_us;
+			next_arrival_us = next_capture_us + OPTITRACK_FRAME_TX_TIME + rand() % 2000;
+		}
+
+		host_timer_set_time_ns(tick_us * 1000ULL);
+		optitrack_update();
+
+		/* skip the first second (filter convergence) */
+		if(i < 400) {
+			continue;
+		}
+
+		bench_optitrack_truth((double)(tick_us - time_base_us) * 1e-6, pos, vel);
+
+		float pos_est[3] = {optitrack_read_pos_x(), optitrack_read_pos_y(), optitrack_read_pos_z()};
+		float vel_est[3] = {optitrack_read_vel_x(), optitrack_read_vel_y(), optitrack_read_vel_z()};
+
+		for(j = 0; j < 3; j++) {
+			float vel_err = fabsf(vel_est[j] - vel[j]);
+			float fixed_vel_err = fabsf(fixed_vel[j] - vel[j]);
+			float pos_err = pos_est[j] - pos[j];
+			float frame_pos_err = frame_pos[j] - pos[j];
+
+			vel_err_sum += vel_err * vel_err;
+			fixed_vel_err_sum += fixed_vel_err * fixed_vel_err;
+			pos_err_sum += pos_err * pos_err;
+			frame_pos_err_sum += frame_pos_err * frame_pos_err;
+
+			if(vel_err > vel_err_max) {
+				vel_err_max = vel_err;
+			}
+			if(fixed_vel_err > fixed_vel_err_max) {
+				fixed_vel_err_max = fixed_vel_err;
+			}
+		}
+		err_cnt += 3;
+	}
+
+	float vel_rms = (float)sqrt(vel_err_sum / err_cnt);
+	float fixed_vel_rms = (float)sqrt(fixed_vel_err_sum / err_cnt);
+	float pos_rms = (float)sqrt(pos_err_sum / err_cnt);
+	float frame_pos_rms = (float)sqrt(frame_pos_err_sum / err_cnt);
+
+	printf("optitrack: %d frames sent, %d dropped, velocity error rms/max = %.3f/%.3f m/s"
+	       " (fixed period: %.3f/%.3f m/s), predicted position error rms = %.2f mm"
+	       " (latest frame: %.2f mm)\n", sent_cnt, dropped_cnt, vel_rms, vel_err_max,
+	       fixed_vel_rms, fixed_vel_err_max, pos_rms * 1e3f, frame_pos_rms * 1e3f);
+
+	if(optitrack_available() == false || vel_rms > fixed_vel_rms * 0.5f ||
+	   vel_err_max > fixed_vel_err_max * 0.5f || pos_rms > frame_pos_rms * 0.5f) {
+		printf("error: unexpected optitrack position and velocity estimation\n");
+		return false;
+	}
+
+	return true;
+}
+
+/* advance the timer5 stand-in across several wraparounds of the 32-bit
+ * counter and check the extended time */
+static bool bench_sys_time_check(void)
+{
+	const uint64_t step_us = 30ULL * 60 * 1000000; //30 minutes, 2-3 steps per wraparound
+	const int step_cnt = 48 * 10; //10 days
+	uint64_t time_us = get_time_us();
+	uint64_t max_diff_us = 0;
+
+	int i;
+	for(i = 0; i < step_cnt; i++) {
+		/* odd offset so the fraction of the second is not zero */
+		time_us += step_us + 123457;
+		host_timer_set_time_ns(time_us * 1000ULL);
+
+		uint64_t read_us = get_time_us();
+		uint64_t diff_us = read_us > time_us ? read_us - time_us : time_us - read_us;
+		if(diff_us > max_diff_us) {
+			max_diff_us = diff_us;
+		}
+	}
+
+	printf("system time after %d wraparounds (%.1f days): %llu us, max error = %llu us\n", (int)(time_us >> 32),
+	       (double)time_us * 1e-6 / 86400.0, (unsigned long long)get_time_us(),
+	       (unsigned long long)max_diff_us);
+
+	if(max_diff_us != 0 || get_time_ns() != time_us * 1000ULL) {
+		printf("error: unexpected system time extension\n");
+		return false;
+	}
+
+	return true;
+}
+
+int main(void)
+{
+	perf_init(perf_list, SIZE_OF_PERF_LIST(perf_list));
+	ins_sync_buffer_init();
+
+	/* the estimators initialize the attitude with the sensor readings */
+	bench_imu_feed();
+	bench_compass_feed();
+	bench_optitrack_feed();
+
+	geometry_ctrl_init();
+	ahrs_init();
+	ins_init();
+
+	printf("%-40s %10s %10s %10s %14s\n",
+	       "function", "mean[ns]", "p50[ns]", "p99[ns]", "calls/s");
+
+	int i;
+	for(i = 0; i < (int)(sizeof(bench_list) / sizeof(bench_t)); i++) {
+		bench_run(&bench_list[i]);
+	}
+
+	/* the mpu6500 benchmarks overwrite the inputs of the estimators */
+	bench_imu_feed();
+
+	printf("eskf covariance storage: %d floats (%d bytes) per buffer\n",
+	       SYM_MAT_SIZE(ESKF_INS_STATE_NUM), (int)(SYM_MAT_SIZE(ESKF_INS_STATE_NUM) * sizeof(float)));
+
+	if(bench_eskf_ins_covariance_check(400 * 60) == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_eskf_ins_update_compare(400 * 60) == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_eskf_ins_delay_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_eskf_ins_bias_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_imu_preint_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_mpu6500_burst_read_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_mpu6500_fifo_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_ms5611_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_ist8310_i2c_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_i2c2_error_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_dma_rx_ring_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_frame_parser_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_sbus_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_ublox_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	if(bench_optitrack_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	/* moves the system time forward, run after the other checks */
+	if(bench_sys_time_check() == false) {
+		return EXIT_FAILURE;
+	}
+
+	/* sanity check of the estimator output */
+	float q[4];
+	get_attitude_quaternion(q);
+
+	if(isfinite(q[0]) == false || isfinite(q[1]) == false ||
+	    isfinite(q[2]) == false || isfinite(q[3]) == false) {
+		printf("error: estimator output is not finite\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,23 @@
+#ifndef __CYCLE_COUNTER_H__
+#define __CYCLE_COUNTER_H__
+
+#include <stdint.h>
+#include <time.h>
+
+/* host stand-in of the dwt cycle counter, one count per nanosecond of the
+ * monotonic clock (wall time, not the simulated clock of the host port) */
+
+#define CYCLE_COUNTER_FREQ 1000000000U
+
+static inline void cycle_counter_init(void)
+{
+}
+
+static inline uint32_t get_cycle_count(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+
+#endif
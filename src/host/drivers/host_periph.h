@@ -0,0 +1,40 @@
+#ifndef __HOST_PERIPH_H__
+#define __HOST_PERIPH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx.h"
+
+/* hooks of the host peripheral stand-ins, the device models of the host
+ * programs attach to the buses here instead of the real hardware */
+
+typedef void (*host_gpio_handler_t)(bool level);
+typedef void (*host_uart_tx_func_t)(char *s, int size);
+typedef uint8_t (*host_spi_transfer_func_t)(uint8_t data);
+
+typedef struct {
+	void (*start)(void);
+	void (*stop)(void);
+	bool (*write)(uint8_t data); //return true if the byte is acknowledged
+	uint8_t (*read)(void);
+} host_i2c_device_t;
+
+void host_gpio_attach_handler(GPIO_TypeDef *gpio, uint16_t pin, host_gpio_handler_t handler);
+
+void host_exti_raise(int line);
+
+void host_timer_set_time_ns(uint64_t time_ns);
+
+void host_uart_set_tx_handler(USART_TypeDef *uart, host_uart_tx_func_t handler);
+void host_uart_receive(USART_TypeDef *uart, uint8_t *data, int size);
+
+void host_spi_attach_device(SPI_TypeDef *spi, host_spi_transfer_func_t transfer);
+bool host_spi_dma_complete(SPI_TypeDef *spi); //return false if no transfer is pending
+
+void host_sw_i2c_attach_device(host_i2c_device_t *device);
+
+void host_i2c_attach_device(I2C_TypeDef *i2c, host_i2c_device_t *device);
+uint64_t host_i2c_get_bus_time_ns(I2C_TypeDef *i2c); //accumulated bus occupancy
+void host_i2c_inject_bus_error(I2C_TypeDef *i2c, int byte_index); //of the next transaction
+
+#endif
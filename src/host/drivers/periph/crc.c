@@ -0,0 +1,30 @@
+#include <stdint.h>
+#include "crc.h"
+
+/* software implementation of the stm32 crc unit (crc-32/mpeg-2: polynomial
+ * 0x04c11db7, initial value 0xffffffff, 32-bit words fed msb first) */
+
+#define CRC32_POLYNOMIAL 0x04c11db7
+
+void crc_init(void)
+{
+}
+
+uint32_t calculate_crc_of_words(uint32_t *data_arr, int size)
+{
+	uint32_t crc = 0xffffffff;
+
+	int i, j;
+	for(i = 0; i < size; i++) {
+		crc ^= data_arr[i];
+		for(j = 0; j < 32; j++) {
+			if(crc & 0x80000000) {
+				crc = (crc << 1) ^ CRC32_POLYNOMIAL;
+			} else {
+				crc = crc << 1;
+			}
+		}
+	}
+
+	return crc;
+}
@@ -0,0 +1,26 @@
+#include <stdbool.h>
+#include "stm32f4xx_conf.h"
+#include "exti.h"
+#include "mpu6500.h"
+#include "perf.h"
+#include "perf_list.h"
+#include "host_periph.h"
+
+/* host stand-in of the external interrupt driver, the device models raise
+ * the interrupt lines from their (simulated) interrupt context */
+
+static bool exti10_enabled = false;
+
+void exti10_init(void)
+{
+	exti10_enabled = true;
+}
+
+void host_exti_raise(int line)
+{
+	if(line == 10 && exti10_enabled == true) {
+		perf_start(PERF_IMU_ISR);
+		mpu6500_int_handler();
+		perf_end(PERF_IMU_ISR);
+	}
+}
@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include "flash.h"
+#include "uart.h"
+
+/* host stand-in of the internal flash. the parameter list is read from the
+ * absolute address of sector 11, so the sector is emulated by mapping a
+ * block of memory at the same address before main() is called */
+
+#define FLASH_SECTOR_11_SIZE (128 * 1024)
+
+__attribute__((constructor)) static void flash_sector_map(void)
+{
+	void *sector = mmap((void *)(uintptr_t)ADDR_FLASH_SECTOR_11, FLASH_SECTOR_11_SIZE,
+	                    PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE,
+	                    -1, 0);
+
+	if(sector != (void *)(uintptr_t)ADDR_FLASH_SECTOR_11) {
+		fprintf(stderr, "flash: failed to map sector 11 at %p\n",
+		        (void *)(uintptr_t)ADDR_FLASH_SECTOR_11);
+		exit(EXIT_FAILURE);
+	}
+
+	/* erased flash */
+	memset(sector, 0xff, FLASH_SECTOR_11_SIZE);
+}
+
+void flash_init(void)
+{
+}
+
+int flash_write(uint32_t start_addr, uint32_t *data_arr, int size)
+{
+	if(start_addr < ADDR_FLASH_SECTOR_11 ||
+	    (start_addr + (size * 4)) > (ADDR_FLASH_SECTOR_11 + FLASH_SECTOR_11_SIZE)) {
+		return FLASH_WR_DATA_INCORRECT;
+	}
+
+	memcpy((uint32_t *)(uintptr_t)start_addr, data_arr, sizeof(uint32_t) * size);
+
+	return FLASH_WR_SUCCEED;
+}
+
+void debug_print_flash(uint32_t start_address, int size)
+{
+	uint32_t data_read;
+
+	char s[50] = {0};
+
+	int i;
+	for(i = 0; i < size; i++) {
+		uint32_t read_addr = start_address + (i * 4);
+		data_read = *(uint32_t *)(uintptr_t)read_addr;
+
+		sprintf(s, "%p: %u\n\r", (uint32_t *)(uintptr_t)read_addr, data_read);
+		uart3_puts(s, strlen(s));
+	}
+}
@@ -0,0 +1,91 @@
+#include <stddef.h>
+#include <stdbool.h>
+#include "stm32f4xx.h"
+#include "gpio.h"
+#include "host_periph.h"
+
+#define GPIO_WATCH_MAX 8
+
+typedef struct {
+	GPIO_TypeDef *gpio;
+	uint16_t pin;
+	host_gpio_handler_t handler;
+} gpio_watch_t;
+
+/* register blocks of the host build, the driver macros operate on them as
+ * plain memory */
+static GPIO_TypeDef gpio_regs[5];
+static SPI_TypeDef spi_regs[2];
+static I2C_TypeDef i2c_regs[1];
+static USART_TypeDef uart_regs[5];
+static TIM_TypeDef tim_regs[2];
+
+GPIO_TypeDef *const GPIOA = &gpio_regs[0];
+GPIO_TypeDef *const GPIOB = &gpio_regs[1];
+GPIO_TypeDef *const GPIOC = &gpio_regs[2];
+GPIO_TypeDef *const GPIOD = &gpio_regs[3];
+GPIO_TypeDef *const GPIOE = &gpio_regs[4];
+
+SPI_TypeDef *const SPI1 = &spi_regs[0];
+SPI_TypeDef *const SPI3 = &spi_regs[1];
+
+I2C_TypeDef *const I2C2 = &i2c_regs[0];
+
+USART_TypeDef *const USART1 = &uart_regs[0];
+USART_TypeDef *const USART3 = &uart_regs[1];
+USART_TypeDef *const UART4 = &uart_regs[2];
+USART_TypeDef *const USART6 = &uart_regs[3];
+USART_TypeDef *const UART7 = &uart_regs[4];
+
+TIM_TypeDef *const TIM1 = &tim_regs[0];
+TIM_TypeDef *const TIM4 = &tim_regs[1];
+
+static gpio_watch_t gpio_watch_list[GPIO_WATCH_MAX];
+static int gpio_watch_cnt = 0;
+
+void host_gpio_attach_handler(GPIO_TypeDef *gpio, uint16_t pin, host_gpio_handler_t handler)
+{
+	if(gpio_watch_cnt < GPIO_WATCH_MAX) {
+		gpio_watch_list[gpio_watch_cnt].gpio = gpio;
+		gpio_watch_list[gpio_watch_cnt].pin = pin;
+		gpio_watch_list[gpio_watch_cnt].handler = handler;
+		gpio_watch_cnt++;
+	}
+}
+
+static void gpio_write(GPIO_TypeDef *gpio, uint32_t odr)
+{
+	uint32_t changed = gpio->ODR ^ odr;
+	gpio->ODR = odr;
+
+	/* notify the watchers of the changed pins */
+	int i;
+	for(i = 0; i < gpio_watch_cnt; i++) {
+		if(gpio_watch_list[i].gpio == gpio && (changed & gpio_watch_list[i].pin) != 0) {
+			gpio_watch_list[i].handler((odr & gpio_watch_list[i].pin) != 0);
+		}
+	}
+}
+
+void GPIO_SetBits(GPIO_TypeDef *gpio, uint16_t pin)
+{
+	gpio_write(gpio, gpio->ODR | pin);
+}
+
+void GPIO_ResetBits(GPIO_TypeDef *gpio, uint16_t pin)
+{
+	gpio_write(gpio, gpio->ODR & ~(uint32_t)pin);
+}
+
+void GPIO_ToggleBits(GPIO_TypeDef *gpio, uint16_t pin)
+{
+	gpio_write(gpio, gpio->ODR ^ pin);
+}
+
+void led_init(void)
+{
+}
+
+void ext_switch_init(void)
+{
+}
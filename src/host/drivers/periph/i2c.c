@@ -0,0 +1,170 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "i2c.h"
+#include "host_periph.h"
+
+/* host stand-in of the i2c driver, the queued transactions are played to the
+ * attached device model phase by phase (address, register, repeated start,
+ * data) like the interrupt state machine of the hardware driver. the bus
+ * occupancy is accumulated with the 400kHz clock: 9 clocks per byte
+ * (including the acknowledgement) and one clock per start/stop condition.
+ * a bus error can be injected at a byte of the next transaction, it is
+ * handled like the error interrupt: stop condition, completion with the
+ * error flag and the start of the next queued transaction */
+
+#define I2C2_BIT_TIME_NS 2500
+
+static host_i2c_device_t *i2c2_device;
+static uint64_t i2c2_bus_time_ns;
+static int i2c2_byte_cnt;       //bytes of the transaction in progress
+static int i2c2_error_byte = -1; //byte of the injected bus error, -1 if none
+
+/* queued transactions of i2c2, the one at the head is in progress */
+static i2c_transaction_t *i2c2_queue[I2C2_TRANSACTION_QUEUE_SIZE];
+static uint32_t i2c2_queue_head;
+static uint32_t i2c2_queue_tail;
+static bool i2c2_processing = false;
+
+void host_i2c_attach_device(I2C_TypeDef *i2c, host_i2c_device_t *device)
+{
+	if(i2c == I2C2) {
+		i2c2_device = device;
+	}
+}
+
+void host_i2c_inject_bus_error(I2C_TypeDef *i2c, int byte_index)
+{
+	if(i2c == I2C2) {
+		i2c2_error_byte = byte_index;
+	}
+}
+
+uint64_t host_i2c_get_bus_time_ns(I2C_TypeDef *i2c)
+{
+	if(i2c == I2C2) {
+		return i2c2_bus_time_ns;
+	}
+
+	return 0;
+}
+
+void i2c2_init(void)
+{
+}
+
+static void i2c2_condition(void (*condition)(void))
+{
+	i2c2_bus_time_ns += I2C2_BIT_TIME_NS;
+	condition();
+}
+
+/* the injected error aborts the byte, the device does not see it */
+static bool i2c2_bus_error(void)
+{
+	if(i2c2_byte_cnt++ == i2c2_error_byte) {
+		i2c2_error_byte = -1;
+		i2c2_bus_time_ns += I2C2_BIT_TIME_NS;
+		return true;
+	}
+
+	return false;
+}
+
+static bool i2c2_write_byte(uint8_t data)
+{
+	if(i2c2_bus_error() == true) {
+		return false;
+	}
+
+	i2c2_bus_time_ns += 9 * I2C2_BIT_TIME_NS;
+	return i2c2_device->write(data);
+}
+
+static bool i2c2_read_byte(uint8_t *data)
+{
+	if(i2c2_bus_error() == true) {
+		return false;
+	}
+
+	i2c2_bus_time_ns += 9 * I2C2_BIT_TIME_NS;
+	*data = i2c2_device->read();
+	return true;
+}
+
+static bool i2c2_transaction_play(i2c_transaction_t *transaction)
+{
+	if(i2c2_device == NULL) {
+		/* no device acknowledges the address */
+		i2c2_bus_time_ns += 11 * I2C2_BIT_TIME_NS;
+		return false;
+	}
+
+	bool ack;
+
+	i2c2_byte_cnt = 0;
+	i2c2_condition(i2c2_device->start);
+	ack = i2c2_write_byte(transaction->addr << 1);
+	if(ack == true) {
+		ack = i2c2_write_byte(transaction->reg);
+	}
+
+	if(ack == true && transaction->read == true) {
+		/* repeated start */
+		i2c2_condition(i2c2_device->start);
+		ack = i2c2_write_byte((transaction->addr << 1) | 1);
+		for(int i = 0; (ack == true) && (i < transaction->size); i++) {
+			ack = i2c2_read_byte(&transaction->data[i]);
+		}
+	} else {
+		for(int i = 0; (ack == true) && (i < transaction->size); i++) {
+			ack = i2c2_write_byte(transaction->data[i]);
+		}
+	}
+
+	/* the error interrupt also releases the bus with the stop condition */
+	i2c2_condition(i2c2_device->stop);
+
+	return ack;
+}
+
+/* the transactions are completed before the submission returns. a callback
+ * submitting the next transaction only queues it, the loop here plays it
+ * after the callback returns, same order as the hardware driver */
+bool i2c2_transaction_submit(i2c_transaction_t *transaction)
+{
+	if((i2c2_queue_tail - i2c2_queue_head) >= I2C2_TRANSACTION_QUEUE_SIZE) {
+		return false;
+	}
+
+	transaction->busy = true;
+	i2c2_queue[i2c2_queue_tail % I2C2_TRANSACTION_QUEUE_SIZE] = transaction;
+	i2c2_queue_tail++;
+
+	if(i2c2_processing == true) {
+		return true;
+	}
+
+	i2c2_processing = true;
+
+	while(i2c2_queue_tail != i2c2_queue_head) {
+		i2c_transaction_t *curr = i2c2_queue[i2c2_queue_head % I2C2_TRANSACTION_QUEUE_SIZE];
+
+		bool ack = i2c2_transaction_play(curr);
+
+		i2c2_queue_head++;
+		curr->error = !ack;
+		curr->busy = false;
+
+		BaseType_t higher_priority_task_woken = pdFALSE;
+		if(curr->callback != NULL) {
+			curr->callback(curr, &higher_priority_task_woken);
+		}
+	}
+
+	i2c2_processing = false;
+
+	return true;
+}
@@ -0,0 +1,17 @@
+#include "stm32f4xx_conf.h"
+#include "pwm.h"
+
+/* host stand-in of the pwm driver, the motor driver writes the compare
+ * registers of TIM1 and TIM4 which are plain memory on the host */
+
+void pwm_timer1_init(void)
+{
+}
+
+void pwm_timer4_init(void)
+{
+}
+
+void pwm_timer8_init(void)
+{
+}
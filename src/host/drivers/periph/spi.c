@@ -0,0 +1,137 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_conf.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "spi.h"
+#include "mpu6500.h"
+#include "perf.h"
+#include "perf_list.h"
+#include "host_periph.h"
+
+/* host stand-in of the spi driver, the transfers are forwarded to the
+ * attached device model. a bus without device reads 0xff (floating miso) */
+
+static host_spi_transfer_func_t spi1_device;
+static host_spi_transfer_func_t spi3_device;
+
+/* pending dma transfer of spi1 */
+static uint8_t *spi1_dma_tx_buf;
+static uint8_t *spi1_dma_rx_buf;
+static int spi1_dma_size;
+static bool spi1_dma_pending = false;
+
+/* queued transactions of spi3, the one at the head is in progress */
+static spi_transaction_t *spi3_queue[SPI3_TRANSACTION_QUEUE_SIZE];
+static uint32_t spi3_queue_head;
+static uint32_t spi3_queue_tail;
+
+void host_spi_attach_device(SPI_TypeDef *spi, host_spi_transfer_func_t transfer)
+{
+	if(spi == SPI1) {
+		spi1_device = transfer;
+	} else if(spi == SPI3) {
+		spi3_device = transfer;
+	}
+}
+
+void spi1_init(void)
+{
+}
+
+void spi3_init(void)
+{
+}
+
+uint8_t spi_read_write(SPI_TypeDef *spi_channel, uint8_t data)
+{
+	host_spi_transfer_func_t transfer = NULL;
+
+	if(spi_channel == SPI1) {
+		transfer = spi1_device;
+	} else if(spi_channel == SPI3) {
+		transfer = spi3_device;
+	}
+
+	if(transfer == NULL) {
+		return 0xff;
+	}
+
+	return transfer(data);
+}
+
+/* the transfer is only recorded like the dma stream configuration, the bytes
+ * are exchanged with the device model by host_spi_dma_complete(), which also
+ * raises the completion interrupt */
+void spi1_dma_read_write(uint8_t *tx_buf, uint8_t *rx_buf, int size)
+{
+	spi1_dma_tx_buf = tx_buf;
+	spi1_dma_rx_buf = rx_buf;
+	spi1_dma_size = size;
+	spi1_dma_pending = true;
+}
+
+static bool spi3_transaction_complete(void)
+{
+	if(spi3_queue_tail == spi3_queue_head) {
+		return false;
+	}
+
+	spi_transaction_t *transaction = spi3_queue[spi3_queue_head % SPI3_TRANSACTION_QUEUE_SIZE];
+
+	GPIO_ResetBits(transaction->cs_gpio, transaction->cs_pin);
+	int i;
+	for(i = 0; i < transaction->size; i++) {
+		transaction->rx_buf[i] = spi_read_write(SPI3, transaction->tx_buf[i]);
+	}
+	GPIO_SetBits(transaction->cs_gpio, transaction->cs_pin);
+
+	spi3_queue_head++;
+	transaction->busy = false;
+
+	BaseType_t higher_priority_task_woken = pdFALSE;
+	if(transaction->callback != NULL) {
+		transaction->callback(transaction, &higher_priority_task_woken);
+	}
+
+	return true;
+}
+
+/* the transaction is only queued, the bytes are exchanged with the device
+ * model by host_spi_dma_complete() */
+bool spi3_transaction_submit(spi_transaction_t *transaction)
+{
+	if((spi3_queue_tail - spi3_queue_head) >= SPI3_TRANSACTION_QUEUE_SIZE) {
+		return false;
+	}
+
+	transaction->busy = true;
+	spi3_queue[spi3_queue_tail % SPI3_TRANSACTION_QUEUE_SIZE] = transaction;
+	spi3_queue_tail++;
+
+	return true;
+}
+
+bool host_spi_dma_complete(SPI_TypeDef *spi)
+{
+	if(spi == SPI3) {
+		return spi3_transaction_complete();
+	}
+
+	if(spi != SPI1 || spi1_dma_pending == false) {
+		return false;
+	}
+
+	int i;
+	for(i = 0; i < spi1_dma_size; i++) {
+		spi1_dma_rx_buf[i] = spi_read_write(SPI1, spi1_dma_tx_buf[i]);
+	}
+
+	spi1_dma_pending = false;
+
+	perf_start(PERF_IMU_SPI_DMA_ISR);
+	mpu6500_burst_read_handler();
+	perf_end(PERF_IMU_SPI_DMA_ISR);
+
+	return true;
+}
@@ -0,0 +1,101 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sw_i2c.h"
+#include "host_periph.h"
+
+/* host stand-in of the software i2c driver, the bus operations are forwarded
+ * to the attached device model at byte level. both the blocked and the
+ * coroutine (timer driven) interfaces complete immediately */
+
+static host_i2c_device_t *i2c_device;
+
+void host_sw_i2c_attach_device(host_i2c_device_t *device)
+{
+	i2c_device = device;
+}
+
+void sw_i2c_init(void)
+{
+}
+
+void sw_i2c_blocked_init(void)
+{
+}
+
+void sw_i2c_blocked_start(void)
+{
+	if(i2c_device != NULL) {
+		i2c_device->start();
+	}
+}
+
+void sw_i2c_blocked_stop(void)
+{
+	if(i2c_device != NULL) {
+		i2c_device->stop();
+	}
+}
+
+bool sw_i2c_blocked_wait_ack(void)
+{
+	/* the acknowledgement is decided by the device model when the byte is
+	 * written, see sw_i2c_blocked_send_byte() */
+	return true;
+}
+
+void sw_i2c_blocked_ack(void)
+{
+}
+
+void sw_i2c_blocked_nack(void)
+{
+}
+
+uint8_t sw_i2c_blocked_read_byte(void)
+{
+	if(i2c_device == NULL) {
+		return 0xff;
+	}
+
+	return i2c_device->read();
+}
+
+void sw_i2c_blocked_send_byte(uint8_t data)
+{
+	if(i2c_device != NULL) {
+		i2c_device->write(data);
+	}
+}
+
+void sw_i2c_start(void)
+{
+	sw_i2c_blocked_start();
+}
+
+void sw_i2c_stop(void)
+{
+	sw_i2c_blocked_stop();
+}
+
+void sw_i2c_ack(void)
+{
+}
+
+void sw_i2c_nack(void)
+{
+}
+
+void sw_i2c_wait_ack(void)
+{
+}
+
+uint8_t sw_i2c_read_byte(void)
+{
+	return sw_i2c_blocked_read_byte();
+}
+
+void sw_i2c_send_byte(uint8_t data)
+{
+	sw_i2c_blocked_send_byte(data);
+}
@@ -0,0 +1,98 @@
+#include <stdint.h>
+#include "stm32f4xx_conf.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "timer.h"
+#include "flight_ctrl_task.h"
+#include "sys_time.h"
+#include "led.h"
+#include "ms5611.h"
+#include "ist8310.h"
+#include "mpu6500.h"
+#include "host_periph.h"
+#include "proj_config.h"
+#include "host_port.h"
+#include "perf.h"
+#include "perf_list.h"
+
+/* host stand-in of the timer driver. timer5 counts the simulated clock in
+ * microseconds (see timer_counter.c) and the handlers of its compare channels
+ * are attached to the clock with their own period */
+
+#define FLIGHT_CTL_PERIOD_NS     2500000ULL  //400Hz
+#define LED_CTRL_PERIOD_NS       40000000ULL //25Hz
+#define IMU_FIFO_PERIOD_NS       1000000ULL  //1kHz
+#define TIMER3_PERIOD_NS         2500000ULL  //400Hz
+#define COMPASS_PRESCALER_RELOAD    8 //50Hz
+#define BAROMETER_PRESCALER_RELOAD  4 //100Hz
+
+static void timer5_flight_ctrl_handler(void)
+{
+	perf_start(PERF_TIMER5_ISR);
+	get_time_us();
+	flight_ctrl_semaphore_handler();
+	perf_end(PERF_TIMER5_ISR);
+}
+
+static void timer5_imu_fifo_handler(void)
+{
+	mpu6500_fifo_drain_handler();
+
+	/* the fifo count read, then the fifo data read started by its completion */
+	host_spi_dma_complete(SPI1);
+	host_spi_dma_complete(SPI1);
+}
+
+static void timer5_led_ctrl_handler(void)
+{
+	rgb_led_handler();
+}
+
+static void timer3_handler(void)
+{
+#if (ENABLE_BAROMETER == 1)
+	static int barometer_cnt = BAROMETER_PRESCALER_RELOAD;
+#endif
+#if (ENABLE_MAGNETOMETER == 1)
+	static int compass_cnt = COMPASS_PRESCALER_RELOAD;
+#endif
+
+	perf_start(PERF_TIMER3_ISR);
+	BaseType_t higher_priority_task_woken = pdFALSE;
+
+#if (ENABLE_BAROMETER == 1)
+	barometer_cnt--;
+	if(barometer_cnt == 0) {
+		barometer_cnt = BAROMETER_PRESCALER_RELOAD;
+		ms5611_driver_handler(&higher_priority_task_woken);
+
+		/* the adc read and the conversion command */
+		while(host_spi_dma_complete(SPI3) == true);
+	}
+#endif
+
+#if (ENABLE_MAGNETOMETER == 1)
+	compass_cnt--;
+	if(compass_cnt == 0) {
+		compass_cnt = COMPASS_PRESCALER_RELOAD;
+		ist8310_semaphore_handler(&higher_priority_task_woken);
+	}
+#endif
+
+	perf_end(PERF_TIMER3_ISR);
+	portEND_SWITCHING_ISR(higher_priority_task_woken);
+}
+
+void timer5_init(void)
+{
+	host_port_set_clock_handler(host_timer_set_time_ns);
+	host_port_attach_irq(FLIGHT_CTL_PERIOD_NS, timer5_flight_ctrl_handler);
+	host_port_attach_irq(LED_CTRL_PERIOD_NS, timer5_led_ctrl_handler);
+	host_port_attach_irq(IMU_FIFO_PERIOD_NS, timer5_imu_fifo_handler);
+}
+
+void timer3_init(void)
+{
+	host_port_attach_irq(TIMER3_PERIOD_NS, timer3_handler);
+}
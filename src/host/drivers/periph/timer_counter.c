@@ -0,0 +1,20 @@
+#include <stdint.h>
+#include "timer.h"
+#include "host_periph.h"
+
+/* counter of the timer5 stand-in, kept apart from timer.c so the programs
+ * without the flight control task (bench, replay) can link the system time */
+
+static volatile uint64_t timer5_time_ns = 0;
+
+/* clock handler of the sitl, the replay program drives the clock by the log
+ * timestamps instead */
+void host_timer_set_time_ns(uint64_t time_ns)
+{
+	timer5_time_ns = time_ns;
+}
+
+uint32_t timer5_get_count(void)
+{
+	return (uint32_t)(timer5_time_ns / 1000ULL);
+}
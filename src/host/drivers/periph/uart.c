@@ -0,0 +1,299 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "stm32f4xx_conf.h"
+#include "uart.h"
+#include "semphr.h"
+#include "sbus_radio.h"
+#include "dma_rx_ring.h"
+#include "proj_config.h"
+#include "host_periph.h"
+#include "sys_time.h"
+
+/* host stand-in of the uart driver. transmitted data is passed to the tx
+ * handler registered by the host program (dropped otherwise), received data
+ * is injected with host_uart_receive(). uart3, uart4, uart6 and uart7
+ * simulate the circular dma reception of the firmware: the bytes are written
+ * at the dma position and the ring is updated at the half transfer, transfer
+ * complete and idle line events. every injected burst ends with an idle line,
+ * which is where uart4 hands the s-bus frame to the decoder */
+
+#define UART1_QUEUE_SIZE 100
+
+#define UART3_RX_RING_SIZE 1024
+#define UART4_RX_RING_SIZE 64
+#define UART6_RX_RING_SIZE 1024
+#define UART7_RX_RING_SIZE 1024
+
+typedef struct {
+	char c;
+} uart_c_t;
+
+typedef struct {
+	dma_rx_ring_t ring;
+	uint32_t dma_pos;
+} host_uart_rx_dma_t;
+
+QueueHandle_t uart1_rx_queue;
+SemaphoreHandle_t uart3_rx_semphr;
+
+static uint8_t uart3_rx_buf[UART3_RX_RING_SIZE];
+static uint8_t uart4_rx_buf[UART4_RX_RING_SIZE];
+static uint8_t uart6_rx_buf[UART6_RX_RING_SIZE];
+static uint8_t uart7_rx_buf[UART7_RX_RING_SIZE];
+
+static host_uart_rx_dma_t uart3_rx_dma;
+static host_uart_rx_dma_t uart4_rx_dma;
+static host_uart_rx_dma_t uart6_rx_dma;
+static host_uart_rx_dma_t uart7_rx_dma;
+
+static uint64_t uart7_rx_time;
+
+static host_uart_tx_func_t uart1_tx_handler;
+static host_uart_tx_func_t uart3_tx_handler;
+static host_uart_tx_func_t uart6_tx_handler;
+static host_uart_tx_func_t uart7_tx_handler;
+
+void host_uart_set_tx_handler(USART_TypeDef *uart, host_uart_tx_func_t handler)
+{
+	if(uart == USART1) {
+		uart1_tx_handler = handler;
+	} else if(uart == USART3) {
+		uart3_tx_handler = handler;
+	} else if(uart == USART6) {
+		uart6_tx_handler = handler;
+	} else if(uart == UART7) {
+		uart7_tx_handler = handler;
+	}
+}
+
+static void uart_rx_queue_push(QueueHandle_t queue, uint8_t c)
+{
+	if(queue == NULL) {
+		return;
+	}
+
+	uart_c_t uart_queue_item = {.c = c};
+	BaseType_t higher_priority_task_woken = pdFALSE;
+	xQueueSendToBackFromISR(queue, &uart_queue_item, &higher_priority_task_woken);
+}
+
+static void uart_rx_dma_receive(host_uart_rx_dma_t *rx_dma, uint8_t *data, int size)
+{
+	dma_rx_ring_t *ring = &rx_dma->ring;
+	if(ring->buf == NULL) {
+		return;
+	}
+
+	int i;
+	for(i = 0; i < size; i++) {
+		ring->buf[rx_dma->dma_pos] = data[i];
+		rx_dma->dma_pos = (rx_dma->dma_pos + 1) & (ring->size - 1);
+
+		/* half transfer and transfer complete interrupts */
+		if(rx_dma->dma_pos == (ring->size / 2) || rx_dma->dma_pos == 0) {
+			dma_rx_ring_update(ring, rx_dma->dma_pos);
+		}
+	}
+
+	/* idle line interrupt at the end of the burst */
+	dma_rx_ring_update(ring, rx_dma->dma_pos);
+}
+
+void host_uart_receive(USART_TypeDef *uart, uint8_t *data, int size)
+{
+	if(uart == USART3) {
+		uart_rx_dma_receive(&uart3_rx_dma, data, size);
+		if(uart3_rx_semphr != NULL) {
+			BaseType_t higher_priority_task_woken = pdFALSE;
+			xSemaphoreGiveFromISR(uart3_rx_semphr, &higher_priority_task_woken);
+		}
+		return;
+	} else if(uart == UART4) {
+		uart_rx_dma_receive(&uart4_rx_dma, data, size);
+		if(uart4_rx_dma.ring.buf != NULL) {
+			sbus_rc_idle_handler();
+		}
+		return;
+	} else if(uart == USART6) {
+		uart_rx_dma_receive(&uart6_rx_dma, data, size);
+		return;
+	} else if(uart == UART7) {
+		uart7_rx_time = get_time_us();
+		uart_rx_dma_receive(&uart7_rx_dma, data, size);
+		return;
+	}
+
+	int i;
+	for(i = 0; i < size; i++) {
+		if(uart == USART1) {
+			uart_rx_queue_push(uart1_rx_queue, data[i]);
+		}
+	}
+}
+
+void uart1_init(int baudrate)
+{
+	uart1_rx_queue = xQueueCreate(UART1_QUEUE_SIZE, sizeof(uart_c_t));
+}
+
+void uart3_init(int baudrate)
+{
+	uart3_rx_semphr = xSemaphoreCreateBinary();
+	dma_rx_ring_init(&uart3_rx_dma.ring, uart3_rx_buf, UART3_RX_RING_SIZE);
+	uart3_rx_dma.dma_pos = 0;
+}
+
+void uart4_init(int baudrate)
+{
+	dma_rx_ring_init(&uart4_rx_dma.ring, uart4_rx_buf, UART4_RX_RING_SIZE);
+	uart4_rx_dma.dma_pos = 0;
+}
+
+void uart6_init(int baudrate)
+{
+	dma_rx_ring_init(&uart6_rx_dma.ring, uart6_rx_buf, UART6_RX_RING_SIZE);
+	uart6_rx_dma.dma_pos = 0;
+}
+
+void uart7_init(int baudrate)
+{
+	dma_rx_ring_init(&uart7_rx_dma.ring, uart7_rx_buf, UART7_RX_RING_SIZE);
+	uart7_rx_dma.dma_pos = 0;
+}
+
+void uart_putc(USART_TypeDef *uart, char c)
+{
+	usart_puts(uart, &c, 1);
+}
+
+char uart_getc(USART_TypeDef *uart)
+{
+	char c = 0;
+
+	if(uart == USART1) {
+		uart1_getc(&c, portMAX_DELAY);
+	} else if(uart == USART3) {
+		uart3_read((uint8_t *)&c, 1, portMAX_DELAY);
+	}
+
+	return c;
+}
+
+void usart_puts(USART_TypeDef *uart, char *s, int size)
+{
+	if(uart == USART1) {
+		uart1_puts(s, size);
+	} else if(uart == USART3) {
+		uart3_puts(s, size);
+	} else if(uart == USART6) {
+		uart6_puts(s, size);
+	} else if(uart == UART7) {
+		uart7_puts(s, size);
+	}
+}
+
+void uart1_puts(char *s, int size)
+{
+	if(uart1_tx_handler != NULL) {
+		uart1_tx_handler(s, size);
+	}
+}
+
+void uart3_puts(char *s, int size)
+{
+	if(uart3_tx_handler != NULL) {
+		uart3_tx_handler(s, size);
+	}
+}
+
+void uart6_puts(char *s, int size)
+{
+	if(uart6_tx_handler != NULL) {
+		uart6_tx_handler(s, size);
+	}
+}
+
+void uart7_puts(char *s, int size)
+{
+	if(uart7_tx_handler != NULL) {
+		uart7_tx_handler(s, size);
+	}
+}
+
+bool uart7_write(uint8_t *data, int size)
+{
+	uart7_puts((char *)data, size);
+	return true;
+}
+
+bool uart1_getc(char *c, long sleep_ticks)
+{
+	uart_c_t recpt_c;
+	if(uart1_rx_queue == NULL ||
+	    xQueueReceive(uart1_rx_queue, &recpt_c, sleep_ticks) == pdFALSE) {
+		return false;
+	} else {
+		*c = recpt_c.c;
+		return true;
+	}
+}
+
+int uart3_read(uint8_t *data, int size, long sleep_ticks)
+{
+	if(uart3_rx_dma.ring.buf == NULL) {
+		return 0;
+	}
+
+	if(dma_rx_ring_available(&uart3_rx_dma.ring) == 0) {
+		xSemaphoreTake(uart3_rx_semphr, sleep_ticks);
+	}
+
+	return dma_rx_ring_read(&uart3_rx_dma.ring, data, size);
+}
+
+int uart4_read(uint8_t *data, int size)
+{
+	if(uart4_rx_dma.ring.buf == NULL) {
+		return 0;
+	}
+
+	return dma_rx_ring_read(&uart4_rx_dma.ring, data, size);
+}
+
+int uart6_read(uint8_t *data, int size)
+{
+	if(uart6_rx_dma.ring.buf == NULL) {
+		return 0;
+	}
+
+	return dma_rx_ring_read(&uart6_rx_dma.ring, data, size);
+}
+
+int uart7_read(uint8_t *data, int size)
+{
+	if(uart7_rx_dma.ring.buf == NULL) {
+		return 0;
+	}
+
+	return dma_rx_ring_read(&uart7_rx_dma.ring, data, size);
+}
+
+uint64_t uart7_get_rx_time(void)
+{
+	return uart7_rx_time;
+}
+
+uint32_t uart_get_rx_overrun_cnt(USART_TypeDef *uart)
+{
+	if(uart == USART3) {
+		return dma_rx_ring_get_overrun_cnt(&uart3_rx_dma.ring);
+	} else if(uart == UART4) {
+		return dma_rx_ring_get_overrun_cnt(&uart4_rx_dma.ring);
+	} else if(uart == USART6) {
+		return dma_rx_ring_get_overrun_cnt(&uart6_rx_dma.ring);
+	} else if(uart == UART7) {
+		return dma_rx_ring_get_overrun_cnt(&uart7_rx_dma.ring);
+	}
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+#ifndef _ARM_MATH_H
+#define _ARM_MATH_H
+
+/* host (x86/linux) replacement of the cmsis-dsp arm_math.h header.
+ *
+ * the original header pulls in the cortex-m core headers and inline assembly,
+ * this shim only provides the types and the floating-point subset used by the
+ * flight controller so the portable cmsis-dsp c sources under lib/CMSIS can be
+ * compiled for the host without modification. the include guard is shared
+ * with the original header on purpose, any indirect inclusion of the real
+ * arm_math.h (e.g. arm_common_tables.h) will be ignored */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef PI
+#define PI 3.14159265358979f
+#endif
+
+#define FAST_MATH_TABLE_SIZE 512
+#define FAST_MATH_Q31_SHIFT  (32 - 10)
+#define FAST_MATH_Q15_SHIFT  (16 - 10)
+
+#define __INLINE inline
+#define __SIMD32_TYPE int32_t
+#define ALIGN4 __attribute__((aligned(4)))
+#define CMSIS_UNUSED __attribute__((unused))
+
+typedef enum {
+	ARM_MATH_SUCCESS = 0,
+	ARM_MATH_ARGUMENT_ERROR = -1,
+	ARM_MATH_LENGTH_ERROR = -2,
+	ARM_MATH_SIZE_MISMATCH = -3,
+	ARM_MATH_NANINF = -4,
+	ARM_MATH_SINGULAR = -5,
+	ARM_MATH_TEST_FAILURE = -6
+} arm_status;
+
+typedef int8_t q7_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+typedef float float32_t;
+typedef double float64_t;
+
+typedef struct {
+	uint16_t numRows;
+	uint16_t numCols;
+	float32_t *pData;
+} arm_matrix_instance_f32;
+
+typedef struct {
+	uint16_t numRows;
+	uint16_t numCols;
+	float64_t *pData;
+} arm_matrix_instance_f64;
+
+/* basic math functions */
+void arm_sub_f32(float32_t *pSrcA, float32_t *pSrcB, float32_t *pDst, uint32_t blockSize);
+void arm_dot_prod_f32(float32_t *pSrcA, float32_t *pSrcB, uint32_t blockSize, float32_t *result);
+
+/* fast math functions */
+float32_t arm_sin_f32(float32_t x);
+float32_t arm_cos_f32(float32_t x);
+
+static inline arm_status arm_sqrt_f32(float32_t in, float32_t *pOut)
+{
+	if(in >= 0.0f) {
+		*pOut = __builtin_sqrtf(in);
+		return ARM_MATH_SUCCESS;
+	} else {
+		*pOut = 0.0f;
+		return ARM_MATH_ARGUMENT_ERROR;
+	}
+}
+
+/* statistics functions */
+void arm_power_f32(float32_t *pSrc, uint32_t blockSize, float32_t *pResult);
+void arm_max_f32(float32_t *pSrc, uint32_t blockSize, float32_t *pResult, uint32_t *pIndex);
+
+/* support functions */
+void arm_copy_f32(float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+
+/* matrix functions */
+void arm_mat_init_f32(arm_matrix_instance_f32 *S, uint16_t nRows, uint16_t nColumns,
+                      float32_t *pData);
+arm_status arm_mat_add_f32(const arm_matrix_instance_f32 *pSrcA,
+                           const arm_matrix_instance_f32 *pSrcB,
+                           arm_matrix_instance_f32 *pDst);
+arm_status arm_mat_sub_f32(const arm_matrix_instance_f32 *pSrcA,
+                           const arm_matrix_instance_f32 *pSrcB,
+                           arm_matrix_instance_f32 *pDst);
+arm_status arm_mat_mult_f32(const arm_matrix_instance_f32 *pSrcA,
+                            const arm_matrix_instance_f32 *pSrcB,
+                            arm_matrix_instance_f32 *pDst);
+arm_status arm_mat_scale_f32(const arm_matrix_instance_f32 *pSrc, float32_t scale,
+                             arm_matrix_instance_f32 *pDst);
+arm_status arm_mat_trans_f32(const arm_matrix_instance_f32 *pSrc,
+                             arm_matrix_instance_f32 *pDst);
+arm_status arm_mat_inverse_f32(const arm_matrix_instance_f32 *src,
+                               arm_matrix_instance_f32 *dst);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
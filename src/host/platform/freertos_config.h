@@ -0,0 +1,59 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* freertos configuration of the host (linux) build, the kernel settings are
+ * kept identical to platform/freertos_config.h except for the port specific
+ * ones */
+
+#include <stdint.h>
+#include <assert.h>
+
+uint32_t host_port_get_run_time_counter(void);
+
+#define configUSE_PREEMPTION                     1
+#define configSUPPORT_STATIC_ALLOCATION          0
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+#define configUSE_IDLE_HOOK                      1 //simulated interrupts, see port.c
+#define configUSE_TICK_HOOK                      0
+#define configCPU_CLOCK_HZ                       (180000000)
+#define configTICK_RATE_HZ                       ((TickType_t)4000)
+#define configMAX_PRIORITIES                     (10)
+#define configMINIMAL_STACK_SIZE                 ((uint16_t)130)
+#define configTOTAL_HEAP_SIZE                    (60 * 1024)
+#define configMAX_TASK_NAME_LEN                  (20)
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_MUTEXES                        1
+#define configQUEUE_REGISTRY_SIZE                8
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configUSE_TRACE_FACILITY                 1
+
+/* run time statistics, counted by the wall clock of the host in
+ * microseconds */
+#define configGENERATE_RUN_TIME_STATS            1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()         host_port_get_run_time_counter()
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES                    0
+#define configMAX_CO_ROUTINE_PRIORITIES          (2)
+
+/* Set the following definitions to 1 to include the API function, or zero
+   to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet            1
+#define INCLUDE_uxTaskPriorityGet           1
+#define INCLUDE_vTaskDelete                 1
+#define INCLUDE_vTaskCleanUpResources       0
+#define INCLUDE_vTaskSuspend                1
+#define INCLUDE_vTaskDelayUntil             0
+#define INCLUDE_vTaskDelay                  1
+#define INCLUDE_xTaskGetSchedulerState      1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
+
+/* interrupt priorities are only referenced by the driver layer (isr.h) */
+#define configPRIO_BITS                              4
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY      15
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY 5
+
+#define configASSERT(x) assert(x)
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,80 @@
+#ifndef __STM32F4XX_H
+#define __STM32F4XX_H
+
+/* host (linux) replacement of the stm32f4xx device header, only the
+ * peripheral definitions referenced by the driver headers are provided.
+ * the register blocks are plain memory so the pin and pwm operations can
+ * be inspected by the host programs */
+
+#include <stdint.h>
+
+typedef struct {
+	uint32_t ODR;
+} GPIO_TypeDef;
+
+typedef struct {
+	uint32_t DR;
+} SPI_TypeDef;
+
+typedef struct {
+	uint32_t DR;
+} USART_TypeDef;
+
+typedef struct {
+	uint32_t DR;
+} I2C_TypeDef;
+
+typedef struct {
+	uint32_t CCR1;
+	uint32_t CCR2;
+	uint32_t CCR3;
+	uint32_t CCR4;
+} TIM_TypeDef;
+
+extern GPIO_TypeDef *const GPIOA;
+extern GPIO_TypeDef *const GPIOB;
+extern GPIO_TypeDef *const GPIOC;
+extern GPIO_TypeDef *const GPIOD;
+extern GPIO_TypeDef *const GPIOE;
+
+extern SPI_TypeDef *const SPI1;
+extern SPI_TypeDef *const SPI3;
+
+extern I2C_TypeDef *const I2C2;
+
+extern USART_TypeDef *const USART1;
+extern USART_TypeDef *const USART3;
+extern USART_TypeDef *const UART4;
+extern USART_TypeDef *const USART6;
+extern USART_TypeDef *const UART7;
+
+extern TIM_TypeDef *const TIM1;
+extern TIM_TypeDef *const TIM4;
+
+#define GPIO_Pin_0  ((uint16_t)0x0001)
+#define GPIO_Pin_1  ((uint16_t)0x0002)
+#define GPIO_Pin_2  ((uint16_t)0x0004)
+#define GPIO_Pin_3  ((uint16_t)0x0008)
+#define GPIO_Pin_4  ((uint16_t)0x0010)
+#define GPIO_Pin_5  ((uint16_t)0x0020)
+#define GPIO_Pin_6  ((uint16_t)0x0040)
+#define GPIO_Pin_7  ((uint16_t)0x0080)
+#define GPIO_Pin_8  ((uint16_t)0x0100)
+#define GPIO_Pin_9  ((uint16_t)0x0200)
+#define GPIO_Pin_10 ((uint16_t)0x0400)
+#define GPIO_Pin_11 ((uint16_t)0x0800)
+#define GPIO_Pin_12 ((uint16_t)0x1000)
+#define GPIO_Pin_13 ((uint16_t)0x2000)
+#define GPIO_Pin_14 ((uint16_t)0x4000)
+#define GPIO_Pin_15 ((uint16_t)0x8000)
+
+/* pin writes are functions like in the standard peripheral library, the
+ * device models of the host programs can watch them (e.g. spi chip select) */
+void GPIO_SetBits(GPIO_TypeDef *gpio, uint16_t pin);
+void GPIO_ResetBits(GPIO_TypeDef *gpio, uint16_t pin);
+void GPIO_ToggleBits(GPIO_TypeDef *gpio, uint16_t pin);
+
+/* same as the device header, the driver configuration is pulled in at the end */
+#include "stm32f4xx_conf.h"
+
+#endif
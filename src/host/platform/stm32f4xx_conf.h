@@ -0,0 +1,7 @@
+#ifndef __STM32F4xx_CONF_H
+#define __STM32F4xx_CONF_H
+
+#include "stm32f4xx.h"
+#include "isr.h"
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef __HOST_PORT_H__
+#define __HOST_PORT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* simulated clock and interrupt sources of the host port. the interrupts are
+ * periodic handlers called with the kernel masked, like the isrs of the
+ * firmware. in lockstep mode the clock jumps to the next interrupt whenever
+ * all tasks are blocked (idle task), otherwise it follows the wall clock */
+
+#define HOST_PORT_IRQ_MAX 16
+
+typedef void (*host_irq_handler_t)(void);
+typedef void (*host_clock_handler_t)(uint64_t time_ns);
+
+void host_port_set_lockstep(bool enable);
+void host_port_set_clock_handler(host_clock_handler_t handler);
+int host_port_attach_irq(uint64_t period_ns, host_irq_handler_t handler);
+uint64_t host_port_get_time_ns(void);
+bool host_port_in_isr(void);
+uint32_t host_port_get_run_time_counter(void);
+
+#endif
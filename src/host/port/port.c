@@ -0,0 +1,472 @@
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for the host (linux)
+ * build, see portmacro.h for the scheduling model and host_port.h for the
+ * simulated clock.
+ *-----------------------------------------------------------*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "host_port.h"
+
+/* the watchdog thread keeps the clock running while a task busy waits for an
+ * interrupt (the idle task is not reached then). in lockstep mode the clock
+ * is advanced by 10ms whenever it did not move for 1ms of wall time */
+#define PORT_WATCHDOG_PERIOD_NS 100000ULL
+#define PORT_STALL_POLL_CNT     10
+#define PORT_STALL_ADVANCE_NS   10000000ULL
+
+typedef struct {
+	pthread_t thread;
+	pthread_cond_t cond;
+	bool running;
+	TaskFunction_t code;
+	void *param;
+} port_thread_t;
+
+typedef struct {
+	uint64_t period_ns;
+	uint64_t next_ns;
+	host_irq_handler_t handler;
+} port_irq_t;
+
+extern void * volatile pxCurrentTCB;
+
+/* interrupt mask */
+static pthread_mutex_t port_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t port_mask_owner;
+static volatile bool port_mask_owned = false;
+static UBaseType_t port_mask_nesting = 0;
+
+static __thread port_thread_t *port_thread_self = NULL;
+static __thread bool port_isr_active = false;
+
+static pthread_cond_t port_end_cond = PTHREAD_COND_INITIALIZER;
+static volatile bool port_yield_pending = false;
+static volatile bool port_scheduler_running = false;
+static volatile bool port_scheduler_ended = false;
+
+/* simulated clock */
+static bool port_lockstep = true;
+static port_irq_t port_irqs[HOST_PORT_IRQ_MAX];
+static int port_irq_cnt = 0;
+static host_clock_handler_t port_clock_handler = NULL;
+static volatile uint64_t port_time_ns = 0;
+static uint64_t port_wall_start_ns = 0;
+
+static uint64_t port_wall_time_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void port_wall_sleep_until(uint64_t wall_ns)
+{
+	struct timespec ts = {
+		.tv_sec = wall_ns / 1000000000ULL,
+		.tv_nsec = wall_ns % 1000000000ULL
+	};
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0);
+}
+
+static bool port_mask_held(void)
+{
+	return port_mask_owned == true && pthread_equal(port_mask_owner, pthread_self());
+}
+
+static void port_mask_lock(void)
+{
+	if(port_mask_held() == true) {
+		port_mask_nesting++;
+		return;
+	}
+
+	pthread_mutex_lock(&port_mutex);
+	port_mask_owner = pthread_self();
+	port_mask_owned = true;
+	port_mask_nesting = 1;
+}
+
+static void port_mask_unlock(void)
+{
+	configASSERT(port_mask_held());
+
+	port_mask_nesting--;
+	if(port_mask_nesting == 0) {
+		port_mask_owned = false;
+		pthread_mutex_unlock(&port_mutex);
+	}
+}
+
+/* give the mask away while waiting, the caller must hold it exactly once */
+static void port_mask_wait(pthread_cond_t *cond)
+{
+	port_mask_owned = false;
+	pthread_cond_wait(cond, &port_mutex);
+	port_mask_owner = pthread_self();
+	port_mask_owned = true;
+	port_mask_nesting = 1;
+}
+
+static port_thread_t *port_current_thread(void)
+{
+	/* the thread is saved on top of the task stack, see pxPortInitialiseStack() */
+	StackType_t *top_of_stack = *(StackType_t **)pxCurrentTCB;
+	return (port_thread_t *)top_of_stack[0];
+}
+
+static void port_thread_park(void)
+{
+	port_mask_lock();
+	port_thread_self->running = false;
+	while(1) {
+		port_mask_wait(&port_thread_self->cond);
+	}
+}
+
+static void port_switch_context(void)
+{
+	port_thread_t *self = port_thread_self;
+
+	port_mask_lock();
+
+	port_yield_pending = false;
+	vTaskSwitchContext();
+
+	port_thread_t *next = port_current_thread();
+	if(next != self) {
+		next->running = true;
+		pthread_cond_signal(&next->cond);
+
+		self->running = false;
+		while(self->running == false) {
+			port_mask_wait(&self->cond);
+		}
+	}
+
+	port_mask_unlock();
+}
+
+static void *port_thread_start(void *arg)
+{
+	port_thread_t *thread = (port_thread_t *)arg;
+	port_thread_self = thread;
+
+	port_mask_lock();
+	while(thread->running == false) {
+		port_mask_wait(&thread->cond);
+	}
+	port_mask_unlock();
+
+	thread->code(thread->param);
+
+	/* tasks are not allowed to return */
+	fprintf(stderr, "freertos: task returned\n");
+	abort();
+
+	return NULL;
+}
+
+static uint64_t port_irq_next_time(void)
+{
+	uint64_t next_ns = UINT64_MAX;
+
+	int i;
+	for(i = 0; i < port_irq_cnt; i++) {
+		if(port_irqs[i].next_ns < next_ns) {
+			next_ns = port_irqs[i].next_ns;
+		}
+	}
+
+	return next_ns;
+}
+
+/* advance the clock to the earliest pending interrupt and run every handler
+ * due at that time, must be called with the mask held */
+static void port_irq_dispatch(void)
+{
+	uint64_t next_ns = port_irq_next_time();
+	if(next_ns == UINT64_MAX) {
+		return;
+	}
+
+	port_time_ns = next_ns;
+	if(port_clock_handler != NULL) {
+		port_clock_handler(next_ns);
+	}
+
+	port_isr_active = true;
+
+	int i;
+	for(i = 0; i < port_irq_cnt; i++) {
+		if(port_irqs[i].next_ns == next_ns) {
+			port_irqs[i].next_ns += port_irqs[i].period_ns;
+			port_irqs[i].handler();
+		}
+
+		if(port_scheduler_ended == true) {
+			break;
+		}
+	}
+
+	port_isr_active = false;
+}
+
+static void port_tick_handler(void)
+{
+	if(xTaskIncrementTick() != pdFALSE) {
+		port_yield_pending = true;
+	}
+}
+
+static void *port_watchdog_thread(void *arg)
+{
+	uint64_t time_last_ns = 0;
+	int stall_cnt = 0;
+
+	while(1) {
+		port_wall_sleep_until(port_wall_time_ns() + PORT_WATCHDOG_PERIOD_NS);
+
+		port_mask_lock();
+
+		if(port_scheduler_ended == true) {
+			port_mask_unlock();
+			break;
+		}
+
+		if(port_lockstep == true) {
+			if(port_time_ns == time_last_ns) {
+				stall_cnt++;
+			} else {
+				stall_cnt = 0;
+			}
+
+			if(stall_cnt >= PORT_STALL_POLL_CNT) {
+				uint64_t until_ns = port_time_ns + PORT_STALL_ADVANCE_NS;
+				while(port_scheduler_ended == false && port_irq_next_time() <= until_ns) {
+					port_irq_dispatch();
+				}
+				stall_cnt = 0;
+			}
+
+			time_last_ns = port_time_ns;
+		} else {
+			uint64_t wall_elapsed_ns = port_wall_time_ns() - port_wall_start_ns;
+			while(port_scheduler_ended == false && port_irq_next_time() <= wall_elapsed_ns) {
+				port_irq_dispatch();
+			}
+		}
+
+		port_mask_unlock();
+	}
+
+	return NULL;
+}
+
+void host_port_set_lockstep(bool enable)
+{
+	port_lockstep = enable;
+}
+
+void host_port_set_clock_handler(host_clock_handler_t handler)
+{
+	port_mask_lock();
+	port_clock_handler = handler;
+	port_mask_unlock();
+}
+
+int host_port_attach_irq(uint64_t period_ns, host_irq_handler_t handler)
+{
+	int irq;
+
+	port_mask_lock();
+
+	if(port_irq_cnt >= HOST_PORT_IRQ_MAX || period_ns == 0) {
+		irq = -1;
+	} else {
+		irq = port_irq_cnt;
+		port_irqs[irq].period_ns = period_ns;
+		port_irqs[irq].next_ns = port_time_ns + period_ns;
+		port_irqs[irq].handler = handler;
+		port_irq_cnt++;
+	}
+
+	port_mask_unlock();
+
+	return irq;
+}
+
+uint64_t host_port_get_time_ns(void)
+{
+	return port_time_ns;
+}
+
+/* counter of the freertos run time statistics, wall time in microseconds */
+uint32_t host_port_get_run_time_counter(void)
+{
+	return (uint32_t)((port_wall_time_ns() - port_wall_start_ns) / 1000ULL);
+}
+
+bool host_port_in_isr(void)
+{
+	return port_isr_active;
+}
+
+/* the simulated interrupts are dispatched from here when every task is
+ * blocked, see configUSE_IDLE_HOOK */
+void vApplicationIdleHook( void )
+{
+	if(port_lockstep == false) {
+		port_mask_lock();
+		uint64_t next_ns = port_irq_next_time();
+		port_mask_unlock();
+
+		if(next_ns != UINT64_MAX) {
+			port_wall_sleep_until(port_wall_start_ns + next_ns);
+		}
+	}
+
+	port_mask_lock();
+	if(port_scheduler_ended == false &&
+	    (port_lockstep == true || port_irq_next_time() <= port_wall_time_ns() - port_wall_start_ns)) {
+		port_irq_dispatch();
+	}
+	port_mask_unlock();
+
+	if(port_yield_pending == true || port_scheduler_ended == true) {
+		vPortYield();
+	}
+}
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+	port_thread_t *thread = (port_thread_t *)malloc(sizeof(port_thread_t));
+	configASSERT(thread != NULL);
+
+	thread->running = false;
+	thread->code = pxCode;
+	thread->param = pvParameters;
+	pthread_cond_init(&thread->cond, NULL);
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	if(pthread_create(&thread->thread, &attr, port_thread_start, thread) != 0) {
+		fprintf(stderr, "freertos: failed to create the task thread\n");
+		abort();
+	}
+	pthread_attr_destroy(&attr);
+
+	*pxTopOfStack = (StackType_t)thread;
+
+	return pxTopOfStack;
+}
+
+BaseType_t xPortStartScheduler( void )
+{
+	host_port_attach_irq(1000000000ULL / configTICK_RATE_HZ, port_tick_handler);
+
+	port_mask_lock();
+
+	port_wall_start_ns = port_wall_time_ns();
+	port_scheduler_running = true;
+
+	/* start the first task */
+	port_thread_t *first = port_current_thread();
+	first->running = true;
+	pthread_cond_signal(&first->cond);
+
+	pthread_t watchdog;
+	pthread_create(&watchdog, NULL, port_watchdog_thread, NULL);
+	pthread_detach(watchdog);
+
+	/* the caller keeps the mask after the scheduler is ended, so the tasks and
+	 * the interrupts stay frozen while the results are collected */
+	while(port_scheduler_ended == false) {
+		port_mask_wait(&port_end_cond);
+	}
+
+	return pdFALSE;
+}
+
+void vPortEndScheduler( void )
+{
+	port_mask_lock();
+	port_scheduler_running = false;
+	port_scheduler_ended = true;
+	pthread_cond_signal(&port_end_cond);
+	port_mask_unlock();
+}
+
+void vPortYield( void )
+{
+	if(port_thread_self == NULL) {
+		return; //not called by a task
+	}
+
+	if(port_scheduler_ended == true) {
+		port_thread_park();
+	}
+
+	if(port_scheduler_running == false) {
+		return;
+	}
+
+	if(port_isr_active == true || port_mask_held() == true) {
+		/* switch after leaving the critical section, like a pended PendSV */
+		port_yield_pending = true;
+		return;
+	}
+
+	port_switch_context();
+}
+
+void vPortYieldFromISR( void )
+{
+	port_yield_pending = true;
+}
+
+/* only called by the kernel around starting and ending the scheduler, both
+ * are serialized by the mask already */
+void vPortDisableInterrupts( void )
+{
+}
+
+void vPortEnableInterrupts( void )
+{
+}
+
+UBaseType_t uxPortSetInterruptMaskFromISR( void )
+{
+	port_mask_lock();
+	return 0;
+}
+
+void vPortClearInterruptMaskFromISR( UBaseType_t uxMask )
+{
+	( void ) uxMask;
+	port_mask_unlock();
+}
+
+void vPortEnterCritical( void )
+{
+	port_mask_lock();
+}
+
+void vPortExitCritical( void )
+{
+	port_mask_unlock();
+
+	if(port_yield_pending == true && port_mask_held() == false &&
+	    port_isr_active == false && port_scheduler_running == true &&
+	    port_thread_self != NULL) {
+		port_switch_context();
+	}
+}
@@ -0,0 +1,584 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "arm_math.h"
+#include "sys_time.h"
+#include "host_periph.h"
+#include "mpu6500.h"
+#include "ist8310.h"
+#include "ms5611.h"
+#include "ublox_m8n.h"
+#include "optitrack.h"
+#include "vins_mono.h"
+#include "ahrs.h"
+#include "ins.h"
+#include "ins_comp_filter.h"
+#include "ins_eskf.h"
+#include "gps_to_enu.h"
+#include "eskf_ahrs.h"
+#include "ins_sensor_sync.h"
+#include "attitude_state.h"
+#include "sensor_log.h"
+#include "proj_config.h"
+
+/* replay of the raw sensor logs (see core/sensor_log) on the host, the
+ * records are processed by the same driver code as the firmware and the
+ * estimators are called with 400Hz of log time as fast as possible. every
+ * estimator runs in its own process since they share the sensor sync buffers */
+
+#define REPLAY_ESTIMATE_PERIOD_US 2500 //400Hz, see flight_ctrl_task
+#define REPLAY_HISTORY_SIZE       128  //fused positions of the last 320ms, covers ESKF_INS_GPS_DELAY
+
+extern mpu6500_t mpu6500;
+extern ms5611_t ms5611;
+extern optitrack_t optitrack;
+extern vins_mono_t vins_mono;
+extern attitude_t attitude; //of ins.c, read back by the ins (see get_rotation_matrix_b2i())
+
+enum {
+	REPLAY_AHRS,
+	REPLAY_INS_COMP_FILTER,
+	REPLAY_INS_ESKF,
+	REPLAY_ESTIMATOR_CNT
+} REPLAY_ESTIMATOR;
+
+typedef struct {
+	char *name;
+	uint64_t *samples; //execution time of each call [ns]
+	int cnt;
+	uint64_t sum;
+} replay_cost_t;
+
+typedef struct {
+	uint64_t time_us;
+	float pos_enu[3];
+} replay_history_t;
+
+typedef struct {
+	sensor_log_record_t *records;
+	int record_cnt;
+	int record_size;
+	uint32_t parse_error_cnt;
+
+	uint64_t *timestamps_us; //unwrapped
+	int record_type_cnt[SENSOR_LOG_TYPE_CNT];
+
+	FILE *csv;
+
+	float gps_outage_from, gps_outage_to; //[s] of log time, the ins eskf gets no gps
+} replay_t;
+
+static replay_t replay;
+
+static char *estimator_names[REPLAY_ESTIMATOR_CNT] = {
+	[REPLAY_AHRS] = "ahrs",
+	[REPLAY_INS_COMP_FILTER] = "ins_comp_filter",
+	[REPLAY_INS_ESKF] = "ins_eskf"
+};
+
+static char *record_type_names[SENSOR_LOG_TYPE_CNT] = {
+	[SENSOR_LOG_CALIBRATION] = "calibration",
+	[SENSOR_LOG_IMU] = "imu",
+	[SENSOR_LOG_COMPASS] = "compass",
+	[SENSOR_LOG_BAROMETER] = "barometer",
+	[SENSOR_LOG_GPS] = "gps",
+	[SENSOR_LOG_OPTITRACK] = "optitrack",
+	[SENSOR_LOG_VINS_MONO] = "vins_mono"
+};
+
+static inline uint64_t replay_time_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void replay_usage(char *name)
+{
+	printf("usage: %s [-e estimator] [-u update] [-o prefix] [-g from:to] log\n"
+	       "  -e  ahrs, ins_comp_filter, ins_eskf or all (default: all)\n"
+	       "  -u  eskf measurement update, batch or sequential (default: %s for the ahrs,"
+	       " %s for the ins)\n"
+	       "  -o  save the estimated trajectories to <prefix>_<estimator>.csv\n"
+	       "  -g  cut the gps of the ins_eskf between the log times [s] and report the"
+	       " drift from the cut gps fixes\n",
+	       name, SELECT_ESKF_AHRS_UPDATE == ESKF_UPDATE_BATCH ? "batch" : "sequential",
+	       SELECT_ESKF_INS_UPDATE == ESKF_UPDATE_BATCH ? "batch" : "sequential");
+}
+
+static int replay_load(char *path)
+{
+	FILE *file = fopen(path, "rb");
+	if(file == NULL) {
+		perror(path);
+		return 1;
+	}
+
+	sensor_log_parser_t parser;
+	sensor_log_parser_init(&parser);
+
+	uint8_t buf[4096];
+	size_t size;
+	while((size = fread(buf, 1, sizeof(buf), file)) > 0) {
+		size_t i;
+		for(i = 0; i < size; i++) {
+			if(sensor_log_parse(&parser, buf[i]) == false) {
+				continue;
+			}
+
+			/* skip the flight log records */
+			if(parser.record.type >= SENSOR_LOG_TYPE_CNT) {
+				continue;
+			}
+
+			if(replay.record_cnt == replay.record_size) {
+				replay.record_size = (replay.record_size == 0) ? 65536 : replay.record_size * 2;
+				replay.records = realloc(replay.records,
+				                         replay.record_size * sizeof(sensor_log_record_t));
+			}
+
+			replay.records[replay.record_cnt] = parser.record;
+			replay.record_cnt++;
+		}
+	}
+
+	fclose(file);
+
+	replay.parse_error_cnt = parser.error_cnt;
+
+	/* unwrap the 32 bits microsecond timestamps */
+	replay.timestamps_us = malloc((replay.record_cnt + 1) * sizeof(uint64_t));
+
+	uint64_t wrap_us = 0;
+	int i;
+	for(i = 0; i < replay.record_cnt; i++) {
+		if(i > 0 && replay.records[i].timestamp_us < replay.records[i - 1].timestamp_us) {
+			wrap_us += 1ULL << 32;
+		}
+		replay.timestamps_us[i] = wrap_us + replay.records[i].timestamp_us;
+		replay.record_type_cnt[replay.records[i].type]++;
+	}
+
+	return 0;
+}
+
+static void replay_set_sys_time(uint64_t time_us)
+{
+	/* counted by the timer5 stand-in, see get_time_us() */
+	host_timer_set_time_ns(time_us * 1000ULL);
+}
+
+static void replay_load_calibration(sensor_log_calibration_t *calib)
+{
+	mpu6500.init_finished = calib->imu_init_finished;
+	mpu6500.gyro_bias[0] = calib->gyro_bias[0];
+	mpu6500.gyro_bias[1] = calib->gyro_bias[1];
+	mpu6500.gyro_bias[2] = calib->gyro_bias[2];
+	mpu6500.accel_scale = calib->accel_scale;
+	mpu6500.gyro_scale = calib->gyro_scale;
+	mpu6500.accel_rescale_x = calib->accel_rescale[0];
+	mpu6500.accel_rescale_y = calib->accel_rescale[1];
+	mpu6500.accel_rescale_z = calib->accel_rescale[2];
+	mpu6500.accel_bias[0] = calib->accel_bias[0];
+	mpu6500.accel_bias[1] = calib->accel_bias[1];
+	mpu6500.accel_bias[2] = calib->accel_bias[2];
+	mpu6500_filter_init();
+
+	ist8310_filter_init();
+
+	ms5611.init_finished = calib->barometer_init_finished;
+	ms5611.c1 = calib->barometer_prom[0];
+	ms5611.c2 = calib->barometer_prom[1];
+	ms5611.c3 = calib->barometer_prom[2];
+	ms5611.c4 = calib->barometer_prom[3];
+	ms5611.c5 = calib->barometer_prom[4];
+	ms5611.c6 = calib->barometer_prom[5];
+	ms5611.press_lpf = calib->press_lpf;
+	ms5611.press_sea_level = calib->press_sea_level;
+
+	optitrack.id = calib->optitrack_id;
+	vins_mono.id = calib->vins_mono_id;
+}
+
+static void replay_apply_record(sensor_log_record_t *record)
+{
+	BaseType_t higher_priority_task_woken = pdFALSE;
+
+	switch(record->type) {
+	case SENSOR_LOG_CALIBRATION: {
+		sensor_log_calibration_t calib;
+		memcpy(&calib, record->payload, sizeof(calib));
+		replay_load_calibration(&calib);
+		break;
+	}
+	case SENSOR_LOG_IMU: {
+		sensor_log_imu_t imu;
+		memcpy(&imu, record->payload, sizeof(imu));
+		mpu6500_sample_update(imu.accel, imu.gyro, imu.temp, get_time_us());
+		break;
+	}
+	case SENSOR_LOG_COMPASS: {
+		sensor_log_compass_t compass;
+		memcpy(&compass, record->payload, sizeof(compass));
+		ist8310_sample_update(compass.mag);
+		break;
+	}
+	case SENSOR_LOG_BAROMETER: {
+		sensor_log_barometer_t barometer;
+		memcpy(&barometer, record->payload, sizeof(barometer));
+		ms5611_sample_update(barometer.d1, barometer.d2, &higher_priority_task_woken);
+		break;
+	}
+	case SENSOR_LOG_GPS:
+		ublox_decode_nav_pvt_payload(record->payload);
+		break;
+	case SENSOR_LOG_OPTITRACK:
+		optitrack_serial_decoder(record->payload, get_time_us());
+		break;
+	case SENSOR_LOG_VINS_MONO:
+		vins_mono_serial_decoder(record->payload);
+		break;
+	}
+}
+
+static int replay_sample_compare(const void *a, const void *b)
+{
+	uint64_t sample_a = *(const uint64_t *)a;
+	uint64_t sample_b = *(const uint64_t *)b;
+	return (sample_a > sample_b) - (sample_a < sample_b);
+}
+
+static void replay_cost_print(replay_cost_t *cost)
+{
+	if(cost->cnt == 0) {
+		return;
+	}
+
+	qsort(cost->samples, cost->cnt, sizeof(uint64_t), replay_sample_compare);
+
+	printf("%-36s %10d %10.1f %10lu %10lu %10lu\n", cost->name, cost->cnt,
+	       (double)cost->sum / cost->cnt,
+	       (unsigned long)cost->samples[cost->cnt / 2],
+	       (unsigned long)cost->samples[((uint64_t)cost->cnt * 99) / 100],
+	       (unsigned long)cost->samples[cost->cnt - 1]);
+}
+
+/* takes the gps fix of the outage out of the sync buffer before the ins eskf reads it,
+ * the drift is the horizontal distance of the fused position at the capture time from
+ * the fix. returns false if there is no fix to compare with */
+static bool replay_gps_outage_drift(replay_history_t *history, int history_cnt, float *drift)
+{
+	float longitude, latitude, height_msl, vx_ned, vy_ned, vz_ned;
+	uint64_t time_us;
+	if(ins_gps_sync_buffer_pop(&longitude, &latitude, &height_msl,
+	                           &vx_ned, &vy_ned, &vz_ned, &time_us) == false ||
+	    gps_home_is_set() == false) {
+		return false;
+	}
+
+	float x_enu, y_enu, z_enu;
+	longitude_latitude_to_enu(longitude, latitude, 0, &x_enu, &y_enu, &z_enu);
+
+	/* latest estimate not after the capture time of the fix */
+	uint64_t capture_us = time_us - ESKF_INS_GPS_DELAY;
+	int i;
+	for(i = history_cnt - 1; i >= 0 && i >= history_cnt - REPLAY_HISTORY_SIZE; i--) {
+		replay_history_t *entry = &history[i % REPLAY_HISTORY_SIZE];
+		if(entry->time_us <= capture_us) {
+			float dx = entry->pos_enu[0] - x_enu;
+			float dy = entry->pos_enu[1] - y_enu;
+			*drift = sqrtf(dx*dx + dy*dy);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+#define REPLAY_TIMED_CALL(cost, call) \
+	do { \
+		uint64_t start = replay_time_ns(); \
+		call; \
+		uint64_t elapsed = replay_time_ns() - start; \
+		(cost)->samples[(cost)->cnt++] = elapsed; \
+		(cost)->sum += elapsed; \
+	} while(0)
+
+static int replay_run(int estimator, char *csv_prefix)
+{
+	/* the log must begin with the driver states */
+	int first = 0;
+	while(first < replay.record_cnt && replay.records[first].type != SENSOR_LOG_CALIBRATION) {
+		first++;
+	}
+	if(first == replay.record_cnt) {
+		printf("replay: calibration record not found\n");
+		return EXIT_FAILURE;
+	}
+
+	if(csv_prefix != NULL) {
+		char path[256];
+		snprintf(path, sizeof(path), "%s_%s.csv", csv_prefix, estimator_names[estimator]);
+		replay.csv = fopen(path, "w");
+		if(replay.csv == NULL) {
+			perror(path);
+			return EXIT_FAILURE;
+		}
+		fprintf(replay.csv, "time,q0,q1,q2,q3,roll,pitch,yaw,"
+		        "px,py,pz,vx,vy,vz,px_raw,py_raw,pz_raw,vx_raw,vy_raw,vz_raw\n");
+	}
+
+	uint64_t start_us = replay.timestamps_us[first];
+	uint64_t end_us = replay.timestamps_us[replay.record_cnt - 1];
+	int call_cnt_max = (end_us - start_us) / REPLAY_ESTIMATE_PERIOD_US + 1;
+
+	replay_cost_t ahrs_cost = {.name = "ahrs_estimate"};
+	replay_cost_t ins_comp_cost = {.name = "ins_complementary_filter_estimate"};
+	replay_cost_t ins_eskf_cost = {.name = "ins_eskf_estimate"};
+	ahrs_cost.samples = malloc(call_cnt_max * sizeof(uint64_t));
+	ins_comp_cost.samples = malloc(call_cnt_max * sizeof(uint64_t));
+	ins_eskf_cost.samples = malloc(call_cnt_max * sizeof(uint64_t));
+
+	/* same initialization as the flight controller task */
+	replay_set_sys_time(start_us);
+	replay_apply_record(&replay.records[first]);
+	ins_sync_buffer_init();
+	ahrs_init();
+	ins_init();
+
+	attitude = (attitude_t) {
+		.q = {1.0f, 0.0f, 0.0f, 0.0f}
+	};
+	float pos_enu_raw[3] = {0.0f}, vel_enu_raw[3] = {0.0f};
+	float pos_enu_fused[3] = {0.0f}, vel_enu_fused[3] = {0.0f};
+	int eskf_not_ready_cnt = 0;
+
+	/* the fused positions are kept to compare them with the gps fixes of the outage */
+	bool gps_outage = estimator == REPLAY_INS_ESKF &&
+	                  replay.gps_outage_to > replay.gps_outage_from;
+	uint64_t gps_outage_from_us = start_us + (uint64_t)(replay.gps_outage_from * 1e6f);
+	uint64_t gps_outage_to_us = start_us + (uint64_t)(replay.gps_outage_to * 1e6f);
+	replay_history_t history[REPLAY_HISTORY_SIZE];
+	int history_cnt = 0;
+	float drift = 0.0f, drift_max = 0.0f;
+	int drift_cnt = 0;
+
+	uint64_t next_estimate_us = start_us + REPLAY_ESTIMATE_PERIOD_US;
+	uint64_t wall_start_ns = replay_time_ns();
+
+	int i;
+	for(i = first + 1; i < replay.record_cnt; i++) {
+		/* run the estimator for every period elapsed before this record */
+		while(next_estimate_us <= replay.timestamps_us[i]) {
+			replay_set_sys_time(next_estimate_us);
+
+			switch(estimator) {
+			case REPLAY_AHRS:
+				REPLAY_TIMED_CALL(&ahrs_cost, ahrs_estimate(&attitude));
+				break;
+			case REPLAY_INS_COMP_FILTER:
+				/* the attitude is required by the ins, see ins_state_estimate() */
+				REPLAY_TIMED_CALL(&ahrs_cost, ahrs_estimate(&attitude));
+				REPLAY_TIMED_CALL(&ins_comp_cost,
+				                  ins_complementary_filter_estimate(
+				                          pos_enu_raw, vel_enu_raw,
+				                          pos_enu_fused, vel_enu_fused));
+				break;
+			case REPLAY_INS_ESKF: {
+				bool eskf_ready;
+				REPLAY_TIMED_CALL(&ins_eskf_cost,
+				                  eskf_ready = ins_eskf_estimate(
+				                                       &attitude, pos_enu_raw, vel_enu_raw,
+				                                       pos_enu_fused, vel_enu_fused));
+				if(eskf_ready == false) {
+					eskf_not_ready_cnt++;
+				}
+
+				if(gps_outage == true) {
+					replay_history_t *entry = &history[history_cnt % REPLAY_HISTORY_SIZE];
+					entry->time_us = next_estimate_us;
+					memcpy(entry->pos_enu, pos_enu_fused, sizeof(entry->pos_enu));
+					history_cnt++;
+				}
+				break;
+			}
+			}
+
+			if(replay.csv != NULL) {
+				fprintf(replay.csv, "%.4f,%f,%f,%f,%f,%f,%f,%f,"
+				        "%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",
+				        (double)(next_estimate_us - start_us) * 1e-6,
+				        attitude.q[0], attitude.q[1], attitude.q[2], attitude.q[3],
+				        attitude.roll, attitude.pitch, attitude.yaw,
+				        pos_enu_fused[0], pos_enu_fused[1], pos_enu_fused[2],
+				        vel_enu_fused[0], vel_enu_fused[1], vel_enu_fused[2],
+				        pos_enu_raw[0], pos_enu_raw[1], pos_enu_raw[2],
+				        vel_enu_raw[0], vel_enu_raw[1], vel_enu_raw[2]);
+			}
+
+			next_estimate_us += REPLAY_ESTIMATE_PERIOD_US;
+		}
+
+		replay_set_sys_time(replay.timestamps_us[i]);
+		replay_apply_record(&replay.records[i]);
+
+		if(gps_outage == true && replay.records[i].type == SENSOR_LOG_GPS &&
+		    replay.timestamps_us[i] >= gps_outage_from_us &&
+		    replay.timestamps_us[i] < gps_outage_to_us &&
+		    replay_gps_outage_drift(history, history_cnt, &drift) == true) {
+			drift_max = fmaxf(drift_max, drift);
+			drift_cnt++;
+		}
+	}
+
+	float wall_time = (float)(replay_time_ns() - wall_start_ns) * 1e-9f;
+	float log_time = (float)(end_us - start_us) * 1e-6f;
+
+	if(replay.csv != NULL) {
+		fclose(replay.csv);
+	}
+
+	printf("\n[%s] replayed %.1fs of log in %.3fs (%.0fx real time)\n",
+	       estimator_names[estimator], log_time, wall_time, log_time / wall_time);
+	printf("%-36s %10s %10s %10s %10s %10s\n",
+	       "function", "calls", "mean[ns]", "p50[ns]", "p99[ns]", "max[ns]");
+	replay_cost_print(&ahrs_cost);
+	replay_cost_print(&ins_comp_cost);
+	replay_cost_print(&ins_eskf_cost);
+
+	printf("final attitude (roll, pitch, yaw) = (%.2f, %.2f, %.2f)deg\n",
+	       attitude.roll, attitude.pitch, attitude.yaw);
+	if(estimator != REPLAY_AHRS) {
+		printf("final position (enu) = (%.3f, %.3f, %.3f)m\n",
+		       pos_enu_fused[0], pos_enu_fused[1], pos_enu_fused[2]);
+	}
+	if(gps_outage == true) {
+		printf("horizontal drift after %.1fs without gps = %.3f m (max: %.3f m, %d fixes cut)\n",
+		       replay.gps_outage_to - replay.gps_outage_from, drift, drift_max, drift_cnt);
+	}
+	if(estimator == REPLAY_INS_ESKF && eskf_not_ready_cnt > 0) {
+		printf("ins_eskf_estimate() was not ready for %d of %d calls "
+		       "(check the sensors selected by proj_config.h)\n",
+		       eskf_not_ready_cnt, ins_eskf_cost.cnt);
+	}
+
+	if(isfinite(attitude.q[0]) == false || isfinite(attitude.q[1]) == false ||
+	    isfinite(attitude.q[2]) == false || isfinite(attitude.q[3]) == false ||
+	    isfinite(pos_enu_fused[0]) == false || isfinite(pos_enu_fused[1]) == false ||
+	    isfinite(pos_enu_fused[2]) == false) {
+		printf("error: estimator output is not finite\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+	char *csv_prefix = NULL;
+	int selected = -1; //all
+
+	int opt;
+	while((opt = getopt(argc, argv, "e:u:o:g:h")) != -1) {
+		switch(opt) {
+		case 'e':
+			if(strcmp(optarg, "all") == 0) {
+				selected = -1;
+				break;
+			}
+
+			for(selected = 0; selected < REPLAY_ESTIMATOR_CNT; selected++) {
+				if(strcmp(optarg, estimator_names[selected]) == 0) {
+					break;
+				}
+			}
+
+			if(selected == REPLAY_ESTIMATOR_CNT) {
+				replay_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'u': {
+			int update_mode;
+			if(strcmp(optarg, "batch") == 0) {
+				update_mode = ESKF_UPDATE_BATCH;
+			} else if(strcmp(optarg, "sequential") == 0) {
+				update_mode = ESKF_UPDATE_SEQUENTIAL;
+			} else {
+				replay_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			eskf_ahrs_set_update_mode(update_mode);
+			eskf_ins_set_update_mode(update_mode);
+			break;
+		}
+		case 'o':
+			csv_prefix = optarg;
+			break;
+		case 'g':
+			if(sscanf(optarg, "%f:%f", &replay.gps_outage_from, &replay.gps_outage_to) != 2) {
+				replay_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		default:
+			replay_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(optind >= argc) {
+		replay_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if(replay_load(argv[optind]) != 0) {
+		return EXIT_FAILURE;
+	}
+
+	printf("replay: %d records loaded from %s (%u corrupted)\n",
+	       replay.record_cnt, argv[optind], replay.parse_error_cnt);
+	int i;
+	for(i = 0; i < SENSOR_LOG_TYPE_CNT; i++) {
+		if(replay.record_type_cnt[i] > 0) {
+			printf("  %-12s %d\n", record_type_names[i], replay.record_type_cnt[i]);
+		}
+	}
+
+	if(replay.record_cnt == 0) {
+		return EXIT_FAILURE;
+	}
+
+	if(selected >= 0) {
+		return replay_run(selected, csv_prefix);
+	}
+
+	/* the estimators and the drivers keep their states in static variables,
+	 * each estimator is replayed by a fresh copy of the process */
+	int result = EXIT_SUCCESS;
+	for(i = 0; i < REPLAY_ESTIMATOR_CNT; i++) {
+		fflush(stdout);
+
+		pid_t pid = fork();
+		if(pid == 0) {
+			exit(replay_run(i, csv_prefix));
+		} else if(pid < 0) {
+			perror("fork");
+			return EXIT_FAILURE;
+		}
+
+		int status;
+		waitpid(pid, &status, 0);
+		if(WIFEXITED(status) == false || WEXITSTATUS(status) != EXIT_SUCCESS) {
+			result = EXIT_FAILURE;
+		}
+	}
+
+	return result;
+}
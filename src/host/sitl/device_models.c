@@ -0,0 +1,741 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include "stm32f4xx_conf.h"
+#include "mpu6500.h"
+#include "ms5611.h"
+#include "ist8310.h"
+#include "ublox_m8n.h"
+#include "sbus_radio.h"
+#include "optitrack.h"
+#include "motor.h"
+#include "../../lib/mavlink_v2/ncrl_mavlink/mavlink.h"
+#include "host_periph.h"
+#include "proj_config.h"
+#include "device_models.h"
+
+/* noise density of the simulated mpu6500 (per sample) */
+#define MPU6500_ACCEL_NOISE_STD 0.05f //[m/s^2]
+#define MPU6500_GYRO_NOISE_STD  0.1f  //[deg/s]
+#define MPU6500_GYRO_OFFSET_X   0.5f  //[deg/s], removed by the bias calibration of the driver
+#define MPU6500_GYRO_OFFSET_Y   -0.3f
+#define MPU6500_GYRO_OFFSET_Z   0.2f
+
+#define MPU6500_REG_SIZE 128
+
+/* fifo mode: 8kHz gyroscope, the accelerometer (4kHz) updates every second frame */
+#define MPU6500_MODEL_FIFO_FRAMES 8 //frames per sample of the 1kHz physics
+
+typedef struct {
+	uint8_t reg[MPU6500_REG_SIZE];
+	uint8_t address;
+	bool read;
+	bool selected;
+	bool address_phase;
+	uint32_t noise_seed;
+
+	uint8_t fifo[MPU6500_FIFO_SIZE];
+	int fifo_count;
+	int fifo_read_pos;
+} mpu6500_model_t;
+
+static mpu6500_model_t mpu6500_model;
+
+/* every model has its own seed, the noise of a device does not change with
+ * the other devices of the configuration */
+static float device_model_noise(uint32_t *seed, float std)
+{
+	/* box-muller transform with a fixed seed, the simulation is repeatable */
+	float u1 = ((float)rand_r(seed) + 1.0f) / ((float)RAND_MAX + 2.0f);
+	float u2 = ((float)rand_r(seed) + 1.0f) / ((float)RAND_MAX + 2.0f);
+	return std * sqrtf(-2.0f * logf(u1)) * cosf(2.0f * M_PI * u2);
+}
+
+/*==========================================*
+ * mpu6500 (spi1, chip select: gpio a pin4) *
+ *==========================================*/
+
+static void mpu6500_model_reset(void)
+{
+	memset(mpu6500_model.reg, 0, MPU6500_REG_SIZE);
+	mpu6500_model.reg[MPU6500_WHO_AM_I] = 0x70;
+	mpu6500_model.reg[MPU6500_PWR_MGMT_1] = 0x01; //auto select clock
+	mpu6500_model.fifo_count = 0;
+	mpu6500_model.fifo_read_pos = 0;
+}
+
+static bool mpu6500_model_fifo_enabled(void)
+{
+	return (mpu6500_model.reg[MPU6500_USER_CTRL] & USER_CTRL_FIFO_EN) != 0 &&
+	       mpu6500_model.reg[MPU6500_FIFO_EN] == FIFO_EN_TEMP_GYRO_ACCEL;
+}
+
+static uint8_t mpu6500_model_read_reg(uint8_t address)
+{
+	int count = mpu6500_model.fifo_count - mpu6500_model.fifo_read_pos;
+
+	switch(address) {
+	case MPU6500_FIFO_COUNTH:
+		return (count >> 8) & 0x1f;
+	case MPU6500_FIFO_COUNTL:
+		return count & 0xff;
+	case MPU6500_FIFO_R_W:
+		if(count == 0) {
+			return 0xff;
+		}
+		return mpu6500_model.fifo[mpu6500_model.fifo_read_pos++];
+	default:
+		return mpu6500_model.reg[address];
+	}
+}
+
+/* the unread bytes are moved to the front after every transfer */
+static void mpu6500_model_fifo_compact(void)
+{
+	int count = mpu6500_model.fifo_count - mpu6500_model.fifo_read_pos;
+	memmove(mpu6500_model.fifo, &mpu6500_model.fifo[mpu6500_model.fifo_read_pos], count);
+	mpu6500_model.fifo_count = count;
+	mpu6500_model.fifo_read_pos = 0;
+}
+
+/* fifo_mode of the config register is set by the driver, the fifo stops
+ * receiving new frames once it is full */
+static void mpu6500_model_fifo_push(void)
+{
+	if(mpu6500_model.fifo_count + MPU6500_FIFO_FRAME_SIZE > MPU6500_FIFO_SIZE) {
+		mpu6500_model.fifo_count = MPU6500_FIFO_SIZE; //reported as full
+		return;
+	}
+
+	memcpy(&mpu6500_model.fifo[mpu6500_model.fifo_count], &mpu6500_model.reg[MPU6500_ACCEL_XOUT_H],
+	       MPU6500_FIFO_FRAME_SIZE);
+	mpu6500_model.fifo_count += MPU6500_FIFO_FRAME_SIZE;
+}
+
+static void mpu6500_model_write_reg(uint8_t address, uint8_t data)
+{
+	if(address == MPU6500_PWR_MGMT_1 && (data & 0x80) != 0) {
+		mpu6500_model_reset(); //device reset bit clears itself
+		return;
+	}
+
+	if(address == MPU6500_USER_CTRL && (data & USER_CTRL_FIFO_RST) != 0) {
+		mpu6500_model.fifo_count = 0; //fifo reset bit clears itself
+		mpu6500_model.fifo_read_pos = 0;
+		data &= ~USER_CTRL_FIFO_RST;
+	}
+
+	mpu6500_model.reg[address] = data;
+}
+
+static uint8_t mpu6500_model_transfer(uint8_t data)
+{
+	if(mpu6500_model.selected == false) {
+		return 0xff;
+	}
+
+	/* first byte: read flag and register address */
+	if(mpu6500_model.address_phase == true) {
+		mpu6500_model.address_phase = false;
+		mpu6500_model.read = (data & 0x80) != 0;
+		mpu6500_model.address = data & 0x7f;
+		return 0x00;
+	}
+
+	uint8_t result = 0x00;
+	if(mpu6500_model.read == true) {
+		result = mpu6500_model_read_reg(mpu6500_model.address);
+	} else {
+		mpu6500_model_write_reg(mpu6500_model.address, data);
+	}
+
+	/* burst access, fifo_r_w keeps the address */
+	if(mpu6500_model.address != MPU6500_FIFO_R_W) {
+		mpu6500_model.address = (mpu6500_model.address + 1) % MPU6500_REG_SIZE;
+	}
+
+	return result;
+}
+
+static void mpu6500_model_chip_select_handler(bool level)
+{
+	/* chip select is active low */
+	mpu6500_model.selected = (level == false);
+	mpu6500_model.address_phase = true;
+
+	if(mpu6500_model.selected == false) {
+		mpu6500_model_fifo_compact();
+	}
+}
+
+static float mpu6500_model_noise(float std)
+{
+	return device_model_noise(&mpu6500_model.noise_seed, std);
+}
+
+static void mpu6500_model_write_int16(uint8_t address, float val)
+{
+	if(val > 32767.0f) {
+		val = 32767.0f;
+	} else if(val < -32768.0f) {
+		val = -32768.0f;
+	}
+
+	int16_t raw = (int16_t)lrintf(val);
+	mpu6500_model.reg[address] = (uint16_t)raw >> 8;
+	mpu6500_model.reg[address + 1] = (uint16_t)raw & 0xff;
+}
+
+void mpu6500_model_init(void)
+{
+	mpu6500_model_reset();
+	mpu6500_model.selected = (GPIOA->ODR & GPIO_Pin_4) == 0;
+	mpu6500_model.address_phase = true;
+	mpu6500_model.noise_seed = 1;
+
+	host_spi_attach_device(SPI1, mpu6500_model_transfer);
+	host_gpio_attach_handler(GPIOA, GPIO_Pin_4, mpu6500_model_chip_select_handler);
+}
+
+/* accel: specific force in body frame [m/s^2], gyro: angular velocity in body
+ * frame [rad/s], temp: [degC]. the axes are converted to the sensor frame
+ * of the chip, see mpu6500_int_handler(). in fifo mode the fifo is drained by
+ * the timer5 stand-in */
+void mpu6500_model_sample(float *accel, float *gyro, float temp)
+{
+	int accel_fs = (mpu6500_model.reg[MPU6500_ACCEL_CONFIG] >> 3) & 0x03;
+	int gyro_fs = (mpu6500_model.reg[MPU6500_GYRO_CONFIG] >> 3) & 0x03;
+	float accel_lsb = (16384.0f / (float)(1 << accel_fs)) / 9.81f; //[lsb/(m/s^2)]
+	float gyro_lsb = (131.0f / (float)(1 << gyro_fs)) * (180.0f / M_PI); //[lsb/(rad/s)]
+
+	bool fifo_enabled = mpu6500_model_fifo_enabled();
+	int frames = (fifo_enabled == true) ? MPU6500_MODEL_FIFO_FRAMES : 1;
+
+	int i, j;
+	for(j = 0; j < frames; j++) {
+		float accel_noisy[3], gyro_noisy[3];
+		for(i = 0; i < 3; i++) {
+			accel_noisy[i] = accel[i] + mpu6500_model_noise(MPU6500_ACCEL_NOISE_STD);
+			gyro_noisy[i] = gyro[i] + mpu6500_model_noise(MPU6500_GYRO_NOISE_STD) * (M_PI / 180.0f);
+		}
+		gyro_noisy[0] += MPU6500_GYRO_OFFSET_X * (M_PI / 180.0f);
+		gyro_noisy[1] += MPU6500_GYRO_OFFSET_Y * (M_PI / 180.0f);
+		gyro_noisy[2] += MPU6500_GYRO_OFFSET_Z * (M_PI / 180.0f);
+
+		if((j % 2) == 0) {
+			mpu6500_model_write_int16(MPU6500_ACCEL_XOUT_H, -accel_noisy[0] * accel_lsb);
+			mpu6500_model_write_int16(MPU6500_ACCEL_YOUT_H, -accel_noisy[1] * accel_lsb);
+			mpu6500_model_write_int16(MPU6500_ACCEL_ZOUT_H, +accel_noisy[2] * accel_lsb);
+		}
+		mpu6500_model_write_int16(MPU6500_TEMP_OUT_H, (temp - 21.0f) / MPU6500T_85degC);
+		mpu6500_model_write_int16(MPU6500_GYRO_XOUT_H, -gyro_noisy[0] * gyro_lsb);
+		mpu6500_model_write_int16(MPU6500_GYRO_YOUT_H, -gyro_noisy[1] * gyro_lsb);
+		mpu6500_model_write_int16(MPU6500_GYRO_ZOUT_H, +gyro_noisy[2] * gyro_lsb);
+
+		if(fifo_enabled == true) {
+			mpu6500_model_fifo_push();
+		}
+	}
+
+	/* data ready interrupt, then the spi1 dma completion of the burst read
+	 * started by the driver */
+	if((mpu6500_model.reg[MPU6500_INT_ENABLE] & 0x01) != 0) {
+		host_exti_raise(10);
+		host_spi_dma_complete(SPI1);
+	}
+}
+
+/*==========================================*
+ * ms5611 (spi3, chip select: gpio a pin15) *
+ *==========================================*/
+
+/* calibration data of the datasheet example, the temperature conversion (d2)
+ * stays at 20.07degC so only the first order compensation applies */
+#define MS5611_MODEL_D2             8569150
+#define MS5611_MODEL_GROUND_PRESS   1000.09f //[mbar]
+#define MS5611_MODEL_PRESS_GRADIENT 0.12512f //[mbar/m], air density of 1.2754kg/m^3
+#define MS5611_MODEL_NOISE_STD      0.012f   //[mbar], resolution of osr 4096
+
+static const uint16_t ms5611_model_prom[6] = {40127, 36924, 23317, 23282, 33464, 28312};
+
+typedef struct {
+	uint8_t cmd;
+	int byte_index;
+	uint32_t adc; //result of the last conversion
+	float height; //[m]
+	uint32_t noise_seed;
+} ms5611_model_t;
+
+static ms5611_model_t ms5611_model;
+
+/* inverse of ms5611_convert_pressure_temperature() above 20degC */
+static uint32_t ms5611_model_pressure_to_d1(float press)
+{
+	int64_t dt = MS5611_MODEL_D2 - ((int64_t)ms5611_model_prom[4] << 8);
+	int64_t off = ((int64_t)ms5611_model_prom[1] << 16) + (((int64_t)ms5611_model_prom[3] * dt) >> 7);
+	int64_t sens = ((int64_t)ms5611_model_prom[0] << 15) + (((int64_t)ms5611_model_prom[2] * dt) >> 8);
+
+	int64_t press_raw = llrintf(press * 100.0f); //[0.01mbar]
+	return (uint32_t)((((press_raw << 15) + off) << 21) / sens);
+}
+
+static uint8_t ms5611_model_transfer(uint8_t data)
+{
+	int index = ms5611_model.byte_index++;
+
+	if(index == 0) {
+		ms5611_model.cmd = data;
+
+		/* the conversion samples the pressure of the current height, the result
+		 * is read by the next adc read command */
+		if(data == MS5611_D1_CONVERT_OSR4096) {
+			float press = MS5611_MODEL_GROUND_PRESS -
+			              ms5611_model.height * MS5611_MODEL_PRESS_GRADIENT +
+			              device_model_noise(&ms5611_model.noise_seed, MS5611_MODEL_NOISE_STD);
+			ms5611_model.adc = ms5611_model_pressure_to_d1(press);
+		} else if(data == MS5611_D2_CONVERT_OSR4096) {
+			ms5611_model.adc = MS5611_MODEL_D2;
+		}
+		return 0xff;
+	}
+
+	/* prom read: 16 bits coefficient */
+	if(ms5611_model.cmd >= 0xa2 && ms5611_model.cmd <= 0xac && index <= 2) {
+		uint16_t prom = ms5611_model_prom[(ms5611_model.cmd - 0xa2) / 2];
+		return (index == 1) ? prom >> 8 : prom & 0xff;
+	}
+
+	/* adc read: 24 bits result */
+	if(ms5611_model.cmd == 0x00 && index <= 3) {
+		return (ms5611_model.adc >> ((3 - index) * 8)) & 0xff;
+	}
+
+	return 0xff;
+}
+
+static void ms5611_model_chip_select_handler(bool level)
+{
+	ms5611_model.byte_index = 0;
+}
+
+void ms5611_model_init(void)
+{
+	ms5611_model.noise_seed = 2;
+
+	host_spi_attach_device(SPI3, ms5611_model_transfer);
+	host_gpio_attach_handler(GPIOA, GPIO_Pin_15, ms5611_model_chip_select_handler);
+}
+
+/* height above the ground [m] */
+void ms5611_model_update(float height)
+{
+	ms5611_model.height = height;
+}
+
+/*========================================*
+ * ist8310 (i2c, see SELECT_COMPASS_I2C) *
+ *========================================*/
+
+#define IST8310_MODEL_REG_SIZE  0x50
+#define IST8310_MODEL_LSB       (IST8310_RESOLUTION * 0.01f) //[gauss/lsb], see ist8310_sample_update()
+#define IST8310_MODEL_NOISE_STD 0.003f //[gauss]
+
+typedef struct {
+	uint8_t reg[IST8310_MODEL_REG_SIZE];
+	uint8_t ptr;
+	int byte_index;
+	bool reading;
+	float mag[3]; //body frame [gauss]
+	uint32_t noise_seed;
+} ist8310_model_t;
+
+static ist8310_model_t ist8310_model;
+
+static void ist8310_model_write_int16(uint8_t address, float val)
+{
+	int16_t raw = (int16_t)lrintf(val / IST8310_MODEL_LSB);
+	ist8310_model.reg[address] = (uint16_t)raw & 0xff; //little endian
+	ist8310_model.reg[address + 1] = (uint16_t)raw >> 8;
+}
+
+/* single measurement mode, the data registers are updated once per request.
+ * the axes are in the register order of ist8310_read_sensor() */
+static void ist8310_model_measure(void)
+{
+	float mag[3];
+	int i;
+	for(i = 0; i < 3; i++) {
+		mag[i] = ist8310_model.mag[i] +
+		         device_model_noise(&ist8310_model.noise_seed, IST8310_MODEL_NOISE_STD);
+	}
+
+	ist8310_model_write_int16(IST8310_REG_DATA + 0, mag[1]);
+	ist8310_model_write_int16(IST8310_REG_DATA + 2, mag[0]);
+	ist8310_model_write_int16(IST8310_REG_DATA + 4, mag[2]);
+}
+
+static void ist8310_model_start(void)
+{
+	ist8310_model.byte_index = 0;
+}
+
+static void ist8310_model_stop(void)
+{
+}
+
+static bool ist8310_model_write(uint8_t data)
+{
+	int index = ist8310_model.byte_index++;
+
+	/* address byte */
+	if(index == 0) {
+		ist8310_model.reading = (data & 0x01) != 0;
+		return (data >> 1) == IST8310_ADDR;
+	}
+
+	/* register pointer, then the data */
+	if(index == 1) {
+		ist8310_model.ptr = data % IST8310_MODEL_REG_SIZE;
+		return true;
+	}
+
+	if(ist8310_model.ptr == IST8310_REG_CTRL1 && data == IST8310_ODR_SINGLE) {
+		ist8310_model_measure();
+	} else if(ist8310_model.ptr != IST8310_REG_CTRL2) { //soft reset bit clears itself
+		ist8310_model.reg[ist8310_model.ptr] = data;
+	}
+	ist8310_model.ptr = (ist8310_model.ptr + 1) % IST8310_MODEL_REG_SIZE;
+
+	return true;
+}
+
+static uint8_t ist8310_model_read(void)
+{
+	if(ist8310_model.reading == false) {
+		return 0xff;
+	}
+
+	uint8_t data = ist8310_model.reg[ist8310_model.ptr];
+	ist8310_model.ptr = (ist8310_model.ptr + 1) % IST8310_MODEL_REG_SIZE;
+
+	return data;
+}
+
+static host_i2c_device_t ist8310_model_device = {
+	.start = ist8310_model_start,
+	.stop = ist8310_model_stop,
+	.write = ist8310_model_write,
+	.read = ist8310_model_read
+};
+
+void ist8310_model_init(void)
+{
+	memset(ist8310_model.reg, 0, IST8310_MODEL_REG_SIZE);
+	ist8310_model.reg[IST8310_REG_WIA] = IST8310_CHIP_ID;
+	ist8310_model.noise_seed = 3;
+
+#if (SELECT_COMPASS_I2C == COMPASS_HW_I2C)
+	host_i2c_attach_device(I2C2, &ist8310_model_device);
+#else
+	host_sw_i2c_attach_device(&ist8310_model_device);
+#endif
+}
+
+/* mag: magnetic field in body frame [gauss] */
+void ist8310_model_update(float *mag)
+{
+	ist8310_model.mag[0] = mag[0];
+	ist8310_model.mag[1] = mag[1];
+	ist8310_model.mag[2] = mag[2];
+}
+
+/*=============================*
+ * u-blox m8n receiver (uart7) *
+ *=============================*/
+
+/* the home position and the earth sphere of gps_to_enu.c. the driver passes the
+ * geodetic coordinates in single precision (about 1m resolution of longitude
+ * at 120 degrees), the home is placed where they keep the centimeter level */
+#define UBLOX_MODEL_HOME_LONGITUDE 0.0       //[deg]
+#define UBLOX_MODEL_HOME_LATITUDE  0.0       //[deg]
+#define UBLOX_MODEL_HOME_HEIGHT    85.0f     //[m], above mean sea level
+#define UBLOX_MODEL_EARTH_RADIUS   6371000.0 //[m]
+
+#define UBLOX_MODEL_POS_NOISE_STD  0.05f //[m]
+#define UBLOX_MODEL_VEL_NOISE_STD  0.05f //[m/s]
+
+/* age of the fix when the nav-pvt message arrives, in updates of the 1kHz
+ * physics (solution computation and uart transmission) */
+#define UBLOX_MODEL_LATENCY        100
+#define UBLOX_MODEL_HISTORY_SIZE   128
+
+#define UBLOX_MODEL_CLASS_CFG 0x06
+#define UBLOX_MODEL_ID_CFG_MSG 0x01
+
+typedef struct {
+	float pos[UBLOX_MODEL_HISTORY_SIZE][3]; //ned [m]
+	float vel[UBLOX_MODEL_HISTORY_SIZE][3]; //ned [m/s]
+	int history_cnt;
+
+	bool nav_pvt_enabled; //by the cfg-msg of the driver
+	uint32_t noise_seed;
+} ublox_model_t;
+
+static ublox_model_t ublox_model;
+
+static int ublox_model_pack(uint8_t *msg, uint8_t msg_class, uint8_t msg_id, uint8_t *payload, int len)
+{
+	msg[0] = 0xb5;
+	msg[1] = 0x62;
+	msg[2] = msg_class;
+	msg[3] = msg_id;
+	msg[4] = len & 0xff;
+	msg[5] = len >> 8;
+	memcpy(&msg[6], payload, len);
+
+	/* 8-bit fletcher checksum of the class, id, length and payload */
+	uint8_t ck_a = 0, ck_b = 0;
+	int i;
+	for(i = 2; i < len + 6; i++) {
+		ck_a += msg[i];
+		ck_b += ck_a;
+	}
+	msg[len + 6] = ck_a;
+	msg[len + 7] = ck_b;
+
+	return len + 8;
+}
+
+/* every configuration command of the driver is acknowledged */
+static void ublox_model_tx_handler(char *s, int size)
+{
+	uint8_t *cmd = (uint8_t *)s;
+	if(size < 8 || cmd[0] != 0xb5 || cmd[1] != 0x62 || cmd[2] != UBLOX_MODEL_CLASS_CFG) {
+		return;
+	}
+
+	/* cfg-msg: message class, message id, then the output rate of each port (uart1 is the
+	 * second one) */
+	if(cmd[3] == UBLOX_MODEL_ID_CFG_MSG && cmd[6] == UBX_CLASS_NAV && cmd[7] == UBX_ID_NAV_PVT) {
+		ublox_model.nav_pvt_enabled = cmd[9] != 0;
+	}
+
+	uint8_t payload[UBX_ACK_PAYLOAD_LEN] = {cmd[2], cmd[3]};
+	uint8_t msg[UBX_ACK_PAYLOAD_LEN + 8];
+	int msg_size = ublox_model_pack(msg, UBX_CLASS_ACK, UBX_ID_ACK_ACK, payload, UBX_ACK_PAYLOAD_LEN);
+	host_uart_receive(UART7, msg, msg_size);
+}
+
+void ublox_model_init(void)
+{
+	ublox_model.history_cnt = 0;
+	ublox_model.nav_pvt_enabled = false;
+	ublox_model.noise_seed = 4;
+
+	host_uart_set_tx_handler(UART7, ublox_model_tx_handler);
+}
+
+/* pos: position in ned frame [m], vel: velocity in ned frame [m/s], called by
+ * the 1kHz physics */
+void ublox_model_update(float *pos, float *vel)
+{
+	int i = ublox_model.history_cnt % UBLOX_MODEL_HISTORY_SIZE;
+	memcpy(ublox_model.pos[i], pos, sizeof(ublox_model.pos[i]));
+	memcpy(ublox_model.vel[i], vel, sizeof(ublox_model.vel[i]));
+	ublox_model.history_cnt++;
+}
+
+/* nav-pvt message of a 3d fix with the state of UBLOX_MODEL_LATENCY updates ago */
+void ublox_model_send(void)
+{
+	if(ublox_model.nav_pvt_enabled == false || ublox_model.history_cnt <= UBLOX_MODEL_LATENCY) {
+		return;
+	}
+
+	int i = (ublox_model.history_cnt - 1 - UBLOX_MODEL_LATENCY) % UBLOX_MODEL_HISTORY_SIZE;
+	float pos[3], vel[3];
+	int j;
+	for(j = 0; j < 3; j++) {
+		pos[j] = ublox_model.pos[i][j] +
+		         device_model_noise(&ublox_model.noise_seed, UBLOX_MODEL_POS_NOISE_STD);
+		vel[j] = ublox_model.vel[i][j] +
+		         device_model_noise(&ublox_model.noise_seed, UBLOX_MODEL_VEL_NOISE_STD);
+	}
+
+	/* local tangent plane of the home position */
+	double home_latitude = UBLOX_MODEL_HOME_LATITUDE * (M_PI / 180.0);
+	double latitude = UBLOX_MODEL_HOME_LATITUDE +
+	                  (double)pos[0] / UBLOX_MODEL_EARTH_RADIUS * (180.0 / M_PI);
+	double longitude = UBLOX_MODEL_HOME_LONGITUDE +
+	                   (double)pos[1] / (UBLOX_MODEL_EARTH_RADIUS * cos(home_latitude)) *
+	                   (180.0 / M_PI);
+
+	int32_t longitude_raw = (int32_t)lrint(longitude * 1e7); //[deg/1e7]
+	int32_t latitude_raw = (int32_t)lrint(latitude * 1e7);   //[deg/1e7]
+	int32_t height_msl = (int32_t)lrintf((UBLOX_MODEL_HOME_HEIGHT - pos[2]) * 1e3f); //[mm]
+	int32_t vel_n = (int32_t)lrintf(vel[0] * 1e3f); //[mm/s]
+	int32_t vel_e = (int32_t)lrintf(vel[1] * 1e3f);
+	int32_t vel_d = (int32_t)lrintf(vel[2] * 1e3f);
+	uint32_t h_acc = 500, v_acc = 800; //[mm]
+	uint16_t pdop = 120; //[0.01]
+
+	uint8_t payload[UBX_NAV_PVT_PAYLOAD_LEN] = {0};
+	payload[20] = 3;  //3d fix
+	payload[23] = 12; //satellites
+	memcpy(&payload[24], &longitude_raw, sizeof(int32_t));
+	memcpy(&payload[28], &latitude_raw, sizeof(int32_t));
+	memcpy(&payload[36], &height_msl, sizeof(int32_t));
+	memcpy(&payload[40], &h_acc, sizeof(uint32_t));
+	memcpy(&payload[44], &v_acc, sizeof(uint32_t));
+	memcpy(&payload[48], &vel_n, sizeof(int32_t));
+	memcpy(&payload[52], &vel_e, sizeof(int32_t));
+	memcpy(&payload[56], &vel_d, sizeof(int32_t));
+	memcpy(&payload[76], &pdop, sizeof(uint16_t));
+
+	uint8_t msg[UBX_NAV_PVT_PAYLOAD_LEN + 8];
+	int msg_size = ublox_model_pack(msg, UBX_CLASS_NAV, UBX_ID_NAV_PVT, payload, UBX_NAV_PVT_PAYLOAD_LEN);
+	host_uart_receive(UART7, msg, msg_size);
+}
+
+/*=======================*
+ * s-bus receiver (uart4) *
+ *=======================*/
+
+static uint16_t sbus_model_scale(float val, float range_min, float range_max, int rc_min, int rc_max)
+{
+	float raw = (val - range_min) / (range_max - range_min) * (float)(rc_max - rc_min) + (float)rc_min;
+	return (uint16_t)lrintf(raw) & 0x07ff;
+}
+
+void sbus_model_send(radio_t *rc)
+{
+	uint16_t rc_val[SBUS_CHANNEL_CNT] = {0};
+	rc_val[0] = sbus_model_scale(rc->roll, RC_ROLL_RANGE_MIN, RC_ROLL_RANGE_MAX,
+	                             RC_ROLL_MIN, RC_ROLL_MAX);
+	rc_val[1] = sbus_model_scale(rc->pitch, RC_PITCH_RANGE_MIN, RC_PITCH_RANGE_MAX,
+	                             RC_PITCH_MIN, RC_PITCH_MAX);
+	rc_val[2] = sbus_model_scale(rc->throttle, RC_THROTTLE_RANGE_MIN, RC_THROTTLE_RANGE_MAX,
+	                             RC_THROTTLE_MIN, RC_THROTTLE_MAX);
+	rc_val[3] = sbus_model_scale(rc->yaw, RC_YAW_RANGE_MIN, RC_YAW_RANGE_MAX,
+	                             RC_YAW_MIN, RC_YAW_MAX);
+	rc_val[4] = (rc->safety == true) ? RC_SAFETY_MIN : RC_SAFETY_MAX;
+	rc_val[5] = (rc->auto_flight == true) ? RC_AUTO_FLIGHT_MAX : RC_AUTO_FLIGHT_MIN;
+
+	switch(rc->aux1_mode) {
+	case RC_AUX_MODE2:
+		rc_val[6] = RC_FLIGHT_MODE_MID;
+		break;
+	case RC_AUX_MODE3:
+		rc_val[6] = RC_FLIGHT_MODE_MAX;
+		break;
+	default:
+		rc_val[6] = RC_FLIGHT_MODE_MIN;
+		break;
+	}
+
+	/* 16 channels of 11 bits, least significant bit first */
+	uint8_t frame[SBUS_FRAME_SIZE] = {0};
+	frame[0] = SBUS_HEADER;
+
+	int bit_pos = 0;
+	int i, j;
+	for(i = 0; i < SBUS_CHANNEL_CNT; i++) {
+		for(j = 0; j < 11; j++) {
+			if((rc_val[i] >> j) & 0x01) {
+				frame[1 + bit_pos / 8] |= 1 << (bit_pos % 8);
+			}
+			bit_pos++;
+		}
+	}
+
+	frame[23] = 0x00; //no frame lost, no failsafe
+	frame[24] = SBUS_FOOTER;
+
+	host_uart_receive(UART4, frame, sizeof(frame));
+}
+
+/*=========================*
+ * optitrack link (uart7) *
+ *=========================*/
+
+void optitrack_model_send(int id, float *pos_ned, float *q)
+{
+	uint8_t buf[OPTITRACK_SERIAL_MSG_SIZE];
+
+	/* position in east-north-up frame, the quaternion is reordered and the
+	 * z component is negated, see optitrack_serial_decoder() */
+	float payload[7] = {
+		pos_ned[1], pos_ned[0], -pos_ned[2],
+		q[1], q[2], -q[3], q[0]
+	};
+
+	buf[0] = '@';
+	buf[2] = id;
+	memcpy(&buf[3], payload, sizeof(payload));
+	buf[OPTITRACK_SERIAL_MSG_SIZE - 1] = '+';
+
+	uint8_t checksum = 19;
+	int i;
+	for(i = 3; i < OPTITRACK_SERIAL_MSG_SIZE - 1; i++) {
+		checksum ^= buf[i];
+	}
+	buf[1] = checksum;
+
+	host_uart_receive(UART7, buf, sizeof(buf));
+}
+
+/*===================*
+ * motors (tim1/tim4) *
+ *===================*/
+
+static float motor_model_read_pwm(volatile uint32_t *ccr)
+{
+	/* the esc stays disarmed until it sees a valid pulse */
+	if(*ccr < MOTOR_PULSE_MIN) {
+		return -1.0f;
+	}
+
+	return (float)(*ccr - MOTOR_PULSE_MIN) / (float)(MOTOR_PULSE_MAX - MOTOR_PULSE_MIN);
+}
+
+void motor_model_read(float *motor_cmd)
+{
+	motor_cmd[0] = motor_model_read_pwm(MOTOR1);
+	motor_cmd[1] = motor_model_read_pwm(MOTOR2);
+	motor_cmd[2] = motor_model_read_pwm(MOTOR3);
+	motor_cmd[3] = motor_model_read_pwm(MOTOR4);
+}
+
+/*==========================*
+ * ground station (uart3) *
+ *==========================*/
+
+void gcs_model_send_heartbeat(void)
+{
+	mavlink_message_t msg;
+	uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+
+	mavlink_msg_heartbeat_pack_chan(255, MAV_COMP_ID_MISSIONPLANNER, MAVLINK_COMM_3, &msg,
+	                                MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0, MAV_STATE_ACTIVE);
+	int len = mavlink_msg_to_send_buffer(buf, &msg);
+	host_uart_receive(USART3, buf, len);
+}
+
+/* return the number of complete messages */
+int gcs_model_receive(char *s, int size)
+{
+	static mavlink_message_t msg;
+	static mavlink_status_t status;
+
+	int msg_cnt = 0;
+	int i;
+	for(i = 0; i < size; i++) {
+		if(mavlink_parse_char(MAVLINK_COMM_2, (uint8_t)s[i], &msg, &status) == 1) {
+			msg_cnt++;
+		}
+	}
+
+	return msg_cnt;
+}
@@ -0,0 +1,31 @@
+#ifndef __DEVICE_MODELS_H__
+#define __DEVICE_MODELS_H__
+
+#include "sbus_radio.h"
+
+/* simulated sensors and actuators, the models talk to the firmware drivers
+ * through the host peripheral stand-ins (spi, gpio, uart and pwm registers) */
+
+void mpu6500_model_init(void);
+void mpu6500_model_sample(float *accel, float *gyro, float temp);
+
+void ms5611_model_init(void);
+void ms5611_model_update(float height);
+
+void ist8310_model_init(void);
+void ist8310_model_update(float *mag);
+
+void ublox_model_init(void);
+void ublox_model_update(float *pos, float *vel);
+void ublox_model_send(void);
+
+void sbus_model_send(radio_t *rc);
+
+void optitrack_model_send(int id, float *pos_ned, float *q);
+
+void motor_model_read(float *motor_cmd);
+
+void gcs_model_send_heartbeat(void);
+int gcs_model_receive(char *s, int size);
+
+#endif
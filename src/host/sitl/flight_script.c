@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "stm32f4xx_conf.h"
+#include "sbus_radio.h"
+#include "host_periph.h"
+#include "flight_script.h"
+
+#define FLIGHT_SCRIPT_EVENT_MAX 64
+
+#define AUTO_FLIGHT_TIME 3.0f  //[s]
+#define UNLOCK_TIME      4.0f
+#define ARM_TIME         5.0f
+#define TAKEOFF_TIME     6.0f
+#define WAYPOINT_TIME    18.0f //first waypoint
+#define WAYPOINT_PERIOD  8.0f
+#define RETURN_TIME      22.0f //before the end of the simulation
+#define LANDING_TIME     14.0f //before the end of the simulation
+#define SETTLING_TIME    6.0f  //after each command, before checking the hovering error
+
+#define TAKEOFF_HEIGHT   1.5f  //[m], see autopilot_init()
+
+typedef struct {
+	float time;             //[s]
+	char cmd[40];           //shell input, confirmed with 'y'
+	bool hovering;          //the uav hovers at the target after the command
+	float target[3];        //east-north-up [m]
+	bool sent;
+} flight_script_event_t;
+
+static flight_script_event_t events[FLIGHT_SCRIPT_EVENT_MAX];
+static int event_cnt = 0;
+
+/* corners of the rectangle, inside the default geo-fence */
+static const float corners[4][2] = {
+	{+1.0f, +0.8f},
+	{-1.0f, +0.8f},
+	{-1.0f, -0.8f},
+	{+1.0f, -0.8f}
+};
+
+static void flight_script_add_event(float time, char *cmd, bool hovering, float x, float y)
+{
+	if(event_cnt >= FLIGHT_SCRIPT_EVENT_MAX) {
+		return;
+	}
+
+	flight_script_event_t *event = &events[event_cnt];
+	event->time = time;
+	snprintf(event->cmd, sizeof(event->cmd), "%s\ry\r", cmd);
+	event->hovering = hovering;
+	event->target[0] = x;
+	event->target[1] = y;
+	event->target[2] = TAKEOFF_HEIGHT;
+	event->sent = false;
+	event_cnt++;
+}
+
+int flight_script_init(float duration)
+{
+	if(duration < FLIGHT_SCRIPT_MIN_TIME) {
+		return 1;
+	}
+
+	event_cnt = 0;
+
+	flight_script_add_event(ARM_TIME, "arm", false, 0.0f, 0.0f);
+	flight_script_add_event(TAKEOFF_TIME, "takeoff", true, 0.0f, 0.0f);
+
+	float time = WAYPOINT_TIME;
+	int i = 0;
+	while(time <= duration - RETURN_TIME - WAYPOINT_PERIOD) {
+		char cmd[40];
+		snprintf(cmd, sizeof(cmd), "fly %.1f %.1f", corners[i][0], corners[i][1]);
+		flight_script_add_event(time, cmd, true, corners[i][0], corners[i][1]);
+
+		i = (i + 1) % 4;
+		time += WAYPOINT_PERIOD;
+	}
+
+	flight_script_add_event(duration - RETURN_TIME, "fly 0 0", true, 0.0f, 0.0f);
+	flight_script_add_event(duration - LANDING_TIME, "land", false, 0.0f, 0.0f);
+
+	return 0;
+}
+
+/* called at the s-bus frame rate */
+void flight_script_update(float time, radio_t *rc)
+{
+	/* sticks centered, switch to auto flight mode first then unlock the motors */
+	rc->throttle = 0.0f;
+	rc->roll = 0.0f;
+	rc->pitch = 0.0f;
+	rc->yaw = 0.0f;
+	rc->aux1_mode = RC_AUX_MODE1;
+	rc->auto_flight = (time >= AUTO_FLIGHT_TIME);
+	rc->safety = (time < UNLOCK_TIME);
+
+	/* type the shell commands */
+	int i;
+	for(i = 0; i < event_cnt; i++) {
+		if(events[i].sent == false && time >= events[i].time) {
+			host_uart_receive(USART1, (uint8_t *)events[i].cmd, strlen(events[i].cmd));
+			events[i].sent = true;
+		}
+	}
+}
+
+/* return true if the uav is expected to hover at pos_enu */
+bool flight_script_hover_target(float time, float *pos_enu)
+{
+	int i;
+	for(i = 0; i < event_cnt - 1; i++) {
+		if(events[i].hovering == true &&
+		    time >= events[i].time + SETTLING_TIME && time < events[i + 1].time) {
+			pos_enu[0] = events[i].target[0];
+			pos_enu[1] = events[i].target[1];
+			pos_enu[2] = events[i].target[2];
+			return true;
+		}
+	}
+
+	return false;
+}
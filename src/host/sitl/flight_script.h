@@ -0,0 +1,17 @@
+#ifndef __FLIGHT_SCRIPT_H__
+#define __FLIGHT_SCRIPT_H__
+
+#include <stdbool.h>
+#include "sbus_radio.h"
+
+#define FLIGHT_SCRIPT_MIN_TIME 40.0f //[s]
+
+/* scripted pilot of the simulation: the radio is switched to auto flight,
+ * then the uav is armed, taken off, flown around a rectangle and landed by
+ * shell commands */
+
+int flight_script_init(float duration);
+void flight_script_update(float time, radio_t *rc);
+bool flight_script_hover_target(float time, float *pos_enu);
+
+#endif
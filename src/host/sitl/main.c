@@ -0,0 +1,514 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "stm32f4xx.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "delay.h"
+#include "gpio.h"
+#include "uart.h"
+#include "spi.h"
+#include "timer.h"
+#include "pwm.h"
+#include "exti.h"
+#include "optitrack.h"
+#include "ublox_m8n.h"
+#include "ms5611.h"
+#include "ist8310.h"
+#include "sw_i2c.h"
+#include "i2c.h"
+#include "sbus_radio.h"
+#include "flight_ctrl_task.h"
+#include "shell_task.h"
+#include "mavlink_task.h"
+#include "calibration_task.h"
+#include "perf.h"
+#include "perf_list.h"
+#include "task_stats.h"
+#include "crc.h"
+#include "flash.h"
+#include "led.h"
+#include "sys_param.h"
+#include "common_list.h"
+#include "multirotor_geometry_param.h"
+#include "autopilot.h"
+#include "ins_sensor_sync.h"
+#include "sensor_log.h"
+#include "flight_log.h"
+#include "mpu6500.h"
+#include "se3_math.h"
+#include "proj_config.h"
+#include "host_port.h"
+#include "host_periph.h"
+#include "quadrotor_model.h"
+#include "device_models.h"
+#include "flight_script.h"
+
+/* software-in-the-loop simulation: the firmware tasks (flight controller,
+ * mavlink and shell) run on the host port of freertos, the sensors and the
+ * motors are replaced by the device models of a simulated quadrotor. the
+ * simulated devices follow the sensor selection of proj_config.h (optitrack,
+ * or gps, barometer and compass with the NAV=gps build) */
+
+#define SIM_PHYSICS_PERIOD_NS   1000000ULL  //1kHz, imu sampling rate
+#define SIM_SBUS_PERIOD_NS      14000000ULL //s-bus frame interval
+#define SIM_OPTITRACK_PERIOD_NS 8333333ULL  //120Hz
+#define SIM_GPS_PERIOD_NS       200000000ULL //5Hz, see ubx_utc_time_set
+#define SIM_GCS_PERIOD_NS       1000000000ULL
+#define SIM_IMU_TEMPERATURE     25.0f       //[degC]
+#define SIM_MAG_FIELD_NORTH     0.35f       //[gauss], no declination
+#define SIM_MAG_FIELD_DOWN      0.25f       //[gauss]
+
+#define SIM_LOG_DRAIN_SIZE      4096
+
+#define SIM_MAX_HOVER_ERROR     0.3f        //[m]
+#define SIM_MIN_TAKEOFF_HEIGHT  1.2f        //[m]
+
+extern mpu6500_t mpu6500;
+extern ms5611_t ms5611;
+
+perf_t perf_list[] = {
+	DEF_PERF(PERF_AHRS_INS, "ahrs and ins")
+	DEF_PERF(PERF_CONTROLLER, "controller")
+	/* histogram bucket width and deadline [us]. the loop has to finish in its
+	 * 2.5ms slot, a trigger period longer than 1.5 slots means a skipped one */
+	DEF_PERF_HIST(PERF_FLIGHT_CONTROL_LOOP, "flight control loop", 250, 2500)
+	DEF_PERF_HIST(PERF_FLIGHT_CONTROL_TRIGGER_TIME, "flight control trigger time", 250, 3750)
+	DEF_PERF_HIST(PERF_FLIGHT_CONTROL_WAKEUP, "flight control wakeup", 10, 0)
+	DEF_PERF_HIST(PERF_IMU_ISR, "imu isr", 2, 0)
+	DEF_PERF_HIST(PERF_IMU_SPI_DMA_ISR, "imu spi dma isr", 2, 0)
+	DEF_PERF_HIST(PERF_TIMER5_ISR, "timer5 isr", 2, 0)
+	DEF_PERF_HIST(PERF_TIMER3_ISR, "timer3 isr", 2, 0)
+};
+
+/* cpu time budget of the tasks in every 2.5ms frame [us] */
+task_budget_t task_budget_list[] = {
+	DEF_TASK_BUDGET("flight controller", 1000)
+	DEF_TASK_BUDGET("mavlink publisher", 150)
+	DEF_TASK_BUDGET("mavlink receiver", 100)
+	DEF_TASK_BUDGET("shell", 100)
+	DEF_TASK_BUDGET("debug_link", 100)
+	DEF_TASK_BUDGET("sensor log", 100)
+	DEF_TASK_BUDGET("flight log", 150)
+	DEF_TASK_BUDGET("calibration", 50)
+	DEF_TASK_BUDGET("compass driver", 50)
+};
+
+typedef struct {
+	float duration;       //[s]
+	bool quiet;
+	FILE *log_file;       //raw sensor log, see core/sensor_log
+	FILE *flight_log_file; //full rate flight data, see core/flight_log
+
+	quadrotor_t quad;
+	radio_t rc;
+
+	/* results */
+	float max_height;
+	float max_hover_error;
+	float max_tilt;       //[deg]
+	int mavlink_msg_cnt;
+} sitl_t;
+
+static sitl_t sitl = {
+	.duration = 60.0f,
+	.quiet = false,
+};
+
+static float sitl_time_s(void)
+{
+	return (float)host_port_get_time_ns() * 1e-9f;
+}
+
+static void sitl_shell_tx_handler(char *s, int size)
+{
+	if(sitl.quiet == false) {
+		fwrite(s, 1, size, stdout);
+		fflush(stdout);
+	}
+}
+
+static void sitl_mavlink_tx_handler(char *s, int size)
+{
+	sitl.mavlink_msg_cnt += gcs_model_receive(s, size);
+}
+
+static void sitl_sensor_log_drain(void)
+{
+	/* the recording starts once the imu is calibrated, like the firmware does
+	 * after the sensor initialization. the sea level pressure is reset by the
+	 * controller until the motors are unlocked, the barometer is recorded
+	 * after that so the one of the calibration record holds */
+	bool sensors_ready = mpu6500.init_finished == true;
+#if (SELECT_HEIGHT_SENSOR == HEIGHT_FUSION_USE_BAROMETER)
+	sensors_ready = sensors_ready && ms5611.init_finished == true && sitl.rc.safety == false;
+#endif
+	if(sensor_log_is_running() == false && sensors_ready == true) {
+		sensor_log_start();
+	}
+
+	uint8_t buf[SIM_LOG_DRAIN_SIZE];
+	int size;
+	while((size = sensor_log_read(buf, SIM_LOG_DRAIN_SIZE)) > 0) {
+		fwrite(buf, 1, size, sitl.log_file);
+	}
+}
+
+static void sitl_flight_log_drain(void)
+{
+	if(flight_log_is_running() == false && mpu6500.init_finished == true) {
+		flight_log_start();
+	}
+
+	uint8_t buf[SIM_LOG_DRAIN_SIZE];
+	int size;
+	while((size = flight_log_read(buf, SIM_LOG_DRAIN_SIZE)) > 0) {
+		fwrite(buf, 1, size, sitl.flight_log_file);
+	}
+}
+
+static void sitl_physics_handler(void)
+{
+	float motor_cmd[4];
+	motor_model_read(motor_cmd);
+
+	quadrotor_t *quad = &sitl.quad;
+	quadrotor_model_update(quad, motor_cmd, SIM_PHYSICS_PERIOD_NS * 1e-9f);
+
+	mpu6500_model_sample(quad->accel_b, quad->W, SIM_IMU_TEMPERATURE);
+
+#if (ENABLE_BAROMETER == 1)
+	ms5611_model_update(-quad->pos[2]);
+#endif
+
+#if (ENABLE_MAGNETOMETER == 1)
+	/* earth magnetic field in body frame: R^T * m */
+	float R[3*3], Rt[3*3];
+	quat_to_rotation_matrix(quad->q, R, Rt);
+	float mag_b[3];
+	int i;
+	for(i = 0; i < 3; i++) {
+		mag_b[i] = R[0*3 + i] * SIM_MAG_FIELD_NORTH + R[2*3 + i] * SIM_MAG_FIELD_DOWN;
+	}
+	ist8310_model_update(mag_b);
+#endif
+
+#if (SELECT_NAVIGATION_DEVICE1 == NAV_DEV1_USE_GPS)
+	ublox_model_update(quad->pos, quad->vel);
+#endif
+
+	if(sitl.log_file != NULL) {
+		sitl_sensor_log_drain();
+	}
+
+	if(sitl.flight_log_file != NULL) {
+		sitl_flight_log_drain();
+	}
+
+	/* flight statistics */
+	float height = -quad->pos[2];
+	if(height > sitl.max_height) {
+		sitl.max_height = height;
+	}
+
+	float tilt = acosf(1.0f - 2.0f * (quad->q[1]*quad->q[1] + quad->q[2]*quad->q[2])) * (180.0f / M_PI);
+	if(tilt > sitl.max_tilt) {
+		sitl.max_tilt = tilt;
+	}
+
+	float time = sitl_time_s();
+	float target_enu[3];
+	if(flight_script_hover_target(time, target_enu) == true) {
+		float dx = quad->pos[1] - target_enu[0];
+		float dy = quad->pos[0] - target_enu[1];
+		float dz = -quad->pos[2] - target_enu[2];
+		float error = sqrtf(dx*dx + dy*dy + dz*dz);
+		if(error > sitl.max_hover_error) {
+			sitl.max_hover_error = error;
+		}
+	}
+
+	if(time >= sitl.duration || quad->crashed == true) {
+		vTaskEndScheduler();
+	}
+}
+
+static void sitl_sbus_handler(void)
+{
+	flight_script_update(sitl_time_s(), &sitl.rc);
+	sbus_model_send(&sitl.rc);
+}
+
+#if (SELECT_NAVIGATION_DEVICE1 == NAV_DEV1_USE_OPTITRACK)
+static void sitl_optitrack_handler(void)
+{
+	optitrack_model_send(UAV_DEFAULT_ID, sitl.quad.pos, sitl.quad.q);
+}
+#endif
+
+static uint64_t sitl_wall_time_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void sitl_usage(char *name)
+{
+	printf("usage: %s [-t seconds] [-i mode] [-r] [-q] [-l file] [-f file]\n"
+	       "  -t  simulated flight time (default: 60s, minimum: %.0fs)\n"
+	       "  -i  imu acquisition mode, data_ready or fifo (default: %s)\n"
+	       "  -r  run in real time instead of lockstep\n"
+	       "  -q  do not print the shell output\n"
+	       "  -l  record the raw sensor log into the file\n"
+	       "  -f  record the flight log into the file\n",
+	       name, FLIGHT_SCRIPT_MIN_TIME,
+	       (SELECT_IMU_MODE == IMU_FIFO) ? "fifo" : "data_ready");
+}
+
+static void sitl_param_init(void)
+{
+	/* factory settings of a calibrated board */
+	flash_init();
+	crc_init();
+	init_multirotor_geometry_param_list();
+	set_sys_param_float(IMU_FINISH_CALIB, 1.0f);
+	save_param_list_to_flash();
+}
+
+int main(int argc, char **argv)
+{
+	bool lockstep = true;
+	char *log_path = NULL;
+	char *flight_log_path = NULL;
+
+	int opt;
+	while((opt = getopt(argc, argv, "t:i:rql:f:h")) != -1) {
+		switch(opt) {
+		case 't':
+			sitl.duration = atof(optarg);
+			break;
+		case 'i':
+			if(strcmp(optarg, "fifo") == 0) {
+				mpu6500_set_mode(IMU_FIFO);
+			} else if(strcmp(optarg, "data_ready") == 0) {
+				mpu6500_set_mode(IMU_DATA_READY);
+			} else {
+				sitl_usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'r':
+			lockstep = false;
+			break;
+		case 'q':
+			sitl.quiet = true;
+			break;
+		case 'l':
+			log_path = optarg;
+			break;
+		case 'f':
+			flight_log_path = optarg;
+			break;
+		default:
+			sitl_usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(flight_script_init(sitl.duration) != 0) {
+		sitl_usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if(log_path != NULL) {
+		sitl.log_file = fopen(log_path, "wb");
+		if(sitl.log_file == NULL) {
+			perror(log_path);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if(flight_log_path != NULL) {
+		sitl.flight_log_file = fopen(flight_log_path, "wb");
+		if(sitl.flight_log_file == NULL) {
+			perror(flight_log_path);
+			return EXIT_FAILURE;
+		}
+	}
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	host_port_set_lockstep(lockstep);
+
+	sitl_param_init();
+
+	/* simulated devices */
+	quadrotor_model_init(&sitl.quad);
+	mpu6500_model_init();
+#if (SELECT_NAVIGATION_DEVICE1 == NAV_DEV1_USE_GPS)
+	ublox_model_init();
+#endif
+#if (ENABLE_MAGNETOMETER == 1)
+	ist8310_model_init();
+#endif
+#if (ENABLE_BAROMETER == 1)
+	ms5611_model_init();
+#endif
+	host_uart_set_tx_handler(USART1, sitl_shell_tx_handler);
+	host_uart_set_tx_handler(USART3, sitl_mavlink_tx_handler);
+
+	/* same initialization sequence as the firmware, see core/main.c */
+	perf_init(perf_list, SIZE_OF_PERF_LIST(perf_list));
+	task_stats_init(task_budget_list, SIZE_OF_TASK_BUDGET_LIST(task_budget_list));
+
+	ins_sync_buffer_init();
+
+	led_init();
+	ext_switch_init();
+	uart1_init(115200);
+	uart3_init(115200); //telem
+	sbus_init();
+	uart4_init(100000); //s-bus
+#if (SELECT_NAVIGATION_DEVICE1 == NAV_DEV1_USE_GPS)
+	uart7_init(38400); //gps
+	ublox_m8n_init();
+#elif (SELECT_NAVIGATION_DEVICE1 == NAV_DEV1_USE_OPTITRACK)
+	uart7_init(115200);
+	optitrack_init(UAV_DEFAULT_ID);
+#endif
+
+	timer5_init();
+	pwm_timer1_init();
+	pwm_timer4_init();
+	exti10_init();
+	spi1_init();
+	blocked_delay_ms(50);
+
+#if (ENABLE_MAGNETOMETER == 1)
+#if (SELECT_COMPASS_I2C == COMPASS_HW_I2C)
+	i2c2_init();
+#else
+	sw_i2c_init();
+#endif
+	ist8310_register_task("compass driver", 512, tskIDLE_PRIORITY + 5);
+#endif
+
+#if (ENABLE_BAROMETER == 1)
+	spi3_init();
+	ms5611_init();
+#endif
+
+	timer3_init();
+
+	host_port_attach_irq(SIM_PHYSICS_PERIOD_NS, sitl_physics_handler);
+	host_port_attach_irq(SIM_SBUS_PERIOD_NS, sitl_sbus_handler);
+#if (SELECT_NAVIGATION_DEVICE1 == NAV_DEV1_USE_GPS)
+	host_port_attach_irq(SIM_GPS_PERIOD_NS, ublox_model_send);
+#elif (SELECT_NAVIGATION_DEVICE1 == NAV_DEV1_USE_OPTITRACK)
+	host_port_attach_irq(SIM_OPTITRACK_PERIOD_NS, sitl_optitrack_handler);
+#endif
+	host_port_attach_irq(SIM_GCS_PERIOD_NS, gcs_model_send_heartbeat);
+
+	flight_controller_register_task("flight controller", 4096, tskIDLE_PRIORITY + 6);
+#if (SELECT_MAIN_TELEM == TELEM_MAVLINK)
+	mavlink_tx_register_task("mavlink publisher", 1024, tskIDLE_PRIORITY + 3);
+	mavlink_rx_register_task("mavlink receiver", 2048, tskIDLE_PRIORITY + 3);
+#endif
+#if (SELECT_DEBUG_TELEM == TELEM_SHELL)
+	shell_register_task("shell", 1024, tskIDLE_PRIORITY + 3);
+#endif
+	calibration_register_task("calibration", 1024, tskIDLE_PRIORITY + 2);
+
+	uint64_t wall_start_ns = sitl_wall_time_ns();
+
+	/* returns when the simulation is finished, the tasks stay frozen */
+	vTaskStartScheduler();
+
+	float wall_time = (float)(sitl_wall_time_ns() - wall_start_ns) * 1e-9f;
+	float sim_time = sitl_time_s();
+	quadrotor_t *quad = &sitl.quad;
+
+	printf("\n\rsitl: simulated %.1fs in %.2fs (%.1fx real time)\n",
+	       sim_time, wall_time, sim_time / wall_time);
+	printf("sitl: final position (enu) = (%.3f, %.3f, %.3f)m\n",
+	       quad->pos[1], quad->pos[0], -quad->pos[2]);
+	printf("sitl: max height = %.3fm, max hover error = %.3fm, max tilt = %.1fdeg\n",
+	       sitl.max_height, sitl.max_hover_error, sitl.max_tilt);
+	printf("sitl: %d mavlink messages received by the ground station\n",
+	       sitl.mavlink_msg_cnt);
+	printf("sitl: %lu imu samples dropped by the busy spi1 dma\n",
+	       (unsigned long)mpu6500.burst_read_drop_cnt);
+	if(mpu6500.mode == IMU_FIFO) {
+		printf("sitl: %lu imu fifo overflows\n", (unsigned long)mpu6500.fifo_overflow_cnt);
+	}
+	printf("sitl: %lu imu samples dropped by the full sample queue\n",
+	       (unsigned long)imu_sample_get_overflow_cnt());
+
+	/* execution time of the flight control loop on the host cpu */
+	int i;
+	for(i = 0; i < perf_get_list_size(); i++) {
+		printf("sitl: perf %-28s mean = %8.2fus, min = %8.2fus, max = %8.2fus\n",
+		       perf_get_name(i), perf_cycles_to_us(perf_get_mean_cycles(i)),
+		       perf_cycles_to_us(perf_get_min_cycles(i)),
+		       perf_cycles_to_us(perf_get_max_cycles(i)));
+
+		if(perf_get_deadline_us(i) > 0) {
+			printf("sitl: perf %-28s p99 = %8.2fus, %lu of %lu exceeded %luus\n",
+			       perf_get_name(i), perf_get_percentile_us(i, 99.0f),
+			       (unsigned long)perf_get_deadline_miss_cnt(i),
+			       (unsigned long)perf_get_count(i),
+			       (unsigned long)perf_get_deadline_us(i));
+		}
+	}
+
+	/* host cpu time of the tasks per simulated frame (last window), the
+	 * tasks run on the thread stacks so the freertos stacks stay untouched */
+	for(i = 0; i < task_stats_get_task_cnt(); i++) {
+		task_stats_t *stats = task_stats_get(i);
+		printf("sitl: task %-28s cpu = %5.1f%%, time = %8.2fus/frame, budget = %7.1fus%s\n",
+		       stats->name, stats->cpu_percentage, stats->frame_time_us,
+		       stats->budget_us, stats->over_budget ? " [over budget]" : "");
+	}
+
+	if(sitl.log_file != NULL) {
+		sitl_sensor_log_drain();
+		fclose(sitl.log_file);
+		printf("sitl: sensor log saved to %s (%lu records dropped)\n",
+		       log_path, (unsigned long)sensor_log_get_dropped_cnt());
+	}
+
+	if(sitl.flight_log_file != NULL) {
+		sitl_flight_log_drain();
+		fclose(sitl.flight_log_file);
+		printf("sitl: flight log saved to %s (%lu records dropped)\n",
+		       flight_log_path, (unsigned long)flight_log_get_dropped_cnt());
+	}
+
+	bool landed = quad->on_ground == true && quad->motor_thrust[0] < 0.1f &&
+	              quad->motor_thrust[1] < 0.1f && quad->motor_thrust[2] < 0.1f &&
+	              quad->motor_thrust[3] < 0.1f;
+
+	if(quad->crashed == true) {
+		printf("sitl: failed, the uav crashed at %.2fs\n", sim_time);
+		return EXIT_FAILURE;
+	} else if(sitl.max_height < SIM_MIN_TAKEOFF_HEIGHT) {
+		printf("sitl: failed, the uav did not take off\n");
+		return EXIT_FAILURE;
+	} else if(sitl.max_hover_error > SIM_MAX_HOVER_ERROR) {
+		printf("sitl: failed, hovering error exceeds %.2fm\n", SIM_MAX_HOVER_ERROR);
+		return EXIT_FAILURE;
+	} else if(landed == false) {
+		printf("sitl: failed, the uav did not land\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("sitl: passed\n");
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include "se3_math.h"
+#include "motor_thrust_fitting.h"
+#include "quadrotor_model.h"
+
+/* airframe, same values as the default parameters of the geometry controller */
+#define QUAD_MASS           1.15f    //[kg]
+#define QUAD_INERTIA_XX     0.01466f //[kg*m^2]
+#define QUAD_INERTIA_YY     0.01466f //[kg*m^2]
+#define QUAD_INERTIA_ZZ     0.02848f //[kg*m^2]
+#define QUAD_ARM_LENGTH     0.1625f  //motor to center of gravity [m]
+#define QUAD_YAW_COEFF      1.0f     //reaction torque per thrust, matches COEFFICIENT_YAW
+#define QUAD_MOTOR_TAU      0.02f    //time constant of the motors [s]
+#define QUAD_DRAG_COEFF     0.1f     //linear air drag [N/(m/s)]
+#define QUAD_ANGULAR_DRAG   0.001f   //[N*m/(rad/s)]
+#define GRAVITY             9.81f
+
+/* landing gear limits */
+#define CRASH_SPEED         3.0f     //vertical speed at touch down [m/s]
+#define CRASH_TILT_COS      0.5f     //cos(60deg)
+
+void quadrotor_model_init(quadrotor_t *quad)
+{
+	memset(quad, 0, sizeof(quadrotor_t));
+	quad->q[0] = 1.0f;
+	quad->accel_b[2] = -GRAVITY;
+	quad->on_ground = true;
+}
+
+static void quadrotor_level_attitude(float *q)
+{
+	/* keep the heading only */
+	float yaw = atan2f(2.0f * (q[0]*q[3] + q[1]*q[2]), 1.0f - 2.0f * (q[2]*q[2] + q[3]*q[3]));
+	q[0] = cosf(0.5f * yaw);
+	q[1] = 0.0f;
+	q[2] = 0.0f;
+	q[3] = sinf(0.5f * yaw);
+}
+
+/* motor_cmd: 0~1 of each motor, negative value if the esc is not armed */
+void quadrotor_model_update(quadrotor_t *quad, float *motor_cmd, float dt)
+{
+	int i;
+
+	/* first order motor response */
+	for(i = 0; i < 4; i++) {
+		float thrust_cmd = (motor_cmd[i] < 0.0f) ? 0.0f : convert_motor_cmd_to_thrust(motor_cmd[i]);
+		quad->motor_thrust[i] += (thrust_cmd - quad->motor_thrust[i]) * dt / QUAD_MOTOR_TAU;
+	}
+
+	/* motor 1: front right, motor 2: rear right, motor 3: rear left, motor 4: front left
+	 * (see mr_geometry_ctrl_thrust_allocation()) */
+	float *f = quad->motor_thrust;
+	float f_total = f[0] + f[1] + f[2] + f[3];
+	float M[3];
+	M[0] = QUAD_ARM_LENGTH * (-f[0] + f[1] + f[2] - f[3]);
+	M[1] = QUAD_ARM_LENGTH * (+f[0] + f[1] - f[2] - f[3]);
+	M[2] = QUAD_YAW_COEFF * (-f[0] + f[1] - f[2] + f[3]);
+
+	float R[3*3], Rt[3*3];
+	quat_to_rotation_matrix(quad->q, R, Rt);
+
+	/* translational dynamics, thrust points to -z axis of the body frame */
+	for(i = 0; i < 3; i++) {
+		quad->accel[i] = (-f_total * R[i*3 + 2] - QUAD_DRAG_COEFF * quad->vel[i]) / QUAD_MASS;
+	}
+	quad->accel[2] += GRAVITY;
+
+	/* rotational dynamics: J * W_dot = M - W x (J * W) */
+	float J[3] = {QUAD_INERTIA_XX, QUAD_INERTIA_YY, QUAD_INERTIA_ZZ};
+	float JW[3] = {J[0] * quad->W[0], J[1] * quad->W[1], J[2] * quad->W[2]};
+	float WJW[3];
+	cross_product_3x1(quad->W, JW, WJW);
+
+	for(i = 0; i < 3; i++) {
+		float W_dot = (M[i] - WJW[i] - QUAD_ANGULAR_DRAG * quad->W[i]) / J[i];
+		quad->W[i] += W_dot * dt;
+	}
+
+	/* semi-implicit euler integration */
+	for(i = 0; i < 3; i++) {
+		quad->vel[i] += quad->accel[i] * dt;
+		quad->pos[i] += quad->vel[i] * dt;
+	}
+
+	/* q_dot = 0.5 * q x [0, W] */
+	float *q = quad->q;
+	float *W = quad->W;
+	float q_dot[4];
+	q_dot[0] = 0.5f * (-q[1]*W[0] - q[2]*W[1] - q[3]*W[2]);
+	q_dot[1] = 0.5f * (+q[0]*W[0] - q[3]*W[1] + q[2]*W[2]);
+	q_dot[2] = 0.5f * (+q[3]*W[0] + q[0]*W[1] - q[1]*W[2]);
+	q_dot[3] = 0.5f * (-q[2]*W[0] + q[1]*W[1] + q[0]*W[2]);
+	for(i = 0; i < 4; i++) {
+		q[i] += q_dot[i] * dt;
+	}
+	float q_norm = sqrtf(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+	for(i = 0; i < 4; i++) {
+		q[i] /= q_norm;
+	}
+
+	/* ground contact at z = 0 */
+	quad->on_ground = false;
+	if(quad->pos[2] >= 0.0f) {
+		if(quad->vel[2] > CRASH_SPEED || R[8] < CRASH_TILT_COS) {
+			quad->crashed = true;
+		}
+
+		quad->pos[2] = 0.0f;
+		if(quad->vel[2] > 0.0f) {
+			/* the ground takes the weight, no sliding */
+			memset(quad->vel, 0, sizeof(quad->vel));
+			memset(quad->accel, 0, sizeof(quad->accel));
+			memset(quad->W, 0, sizeof(quad->W));
+			quadrotor_level_attitude(quad->q);
+			quad->on_ground = true;
+		}
+	}
+
+	/* accelerometer measures the specific force: R^T * (a - g) */
+	float a_minus_g[3] = {quad->accel[0], quad->accel[1], quad->accel[2] - GRAVITY};
+	quat_to_rotation_matrix(quad->q, R, Rt);
+	for(i = 0; i < 3; i++) {
+		quad->accel_b[i] = R[0*3 + i] * a_minus_g[0] +
+		                   R[1*3 + i] * a_minus_g[1] +
+		                   R[2*3 + i] * a_minus_g[2];
+	}
+}
@@ -0,0 +1,26 @@
+#ifndef __QUADROTOR_MODEL_H__
+#define __QUADROTOR_MODEL_H__
+
+#include <stdbool.h>
+
+/* rigid body model of the quadrotor, the inertial frame is north-east-down
+ * and the body frame is front-right-down (same as the flight controller) */
+
+typedef struct {
+	float pos[3];          //[m]
+	float vel[3];          //[m/s]
+	float accel[3];        //[m/s^2]
+	float q[4];            //body to inertial frame rotation
+	float W[3];            //angular velocity in body frame [rad/s]
+	float motor_thrust[4]; //[N]
+
+	float accel_b[3];      //specific force in body frame [m/s^2]
+
+	bool on_ground;
+	bool crashed;
+} quadrotor_t;
+
+void quadrotor_model_init(quadrotor_t *quad);
+void quadrotor_model_update(quadrotor_t *quad, float *motor_cmd, float dt);
+
+#endif
@@ -5,6 +5,7 @@
 #if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
 #include <stdint.h>
 extern uint32_t SystemCoreClock;
+uint32_t timer5_get_count(void);
 #endif
 
 #define configUSE_PREEMPTION                     1
@@ -22,6 +23,13 @@ extern uint32_t SystemCoreClock;
 #define configUSE_MUTEXES                        1
 #define configQUEUE_REGISTRY_SIZE                8
 #define configUSE_PORT_OPTIMISED_TASK_SELECTION  1
+#define configUSE_TRACE_FACILITY                 1
+
+/* run time statistics, counted by timer5 in microseconds (see task_stats.c).
+ * timer5 is the system timer and is already started by main() */
+#define configGENERATE_RUN_TIME_STATS            1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()         timer5_get_count()
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES                    0
@@ -37,6 +45,7 @@ extern uint32_t SystemCoreClock;
 #define INCLUDE_vTaskDelayUntil             0
 #define INCLUDE_vTaskDelay                  1
 #define INCLUDE_xTaskGetSchedulerState      1
+#define INCLUDE_uxTaskGetStackHighWaterMark 1
 
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
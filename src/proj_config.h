@@ -19,6 +19,8 @@
 /* telemetry debug channel protocols */
 #define TELEM_SHELL      0
 #define TELEM_DEBUG_LINK 1
+#define TELEM_SENSOR_LOG 2 //raw sensor data for the host replay, see core/sensor_log
+#define TELEM_FLIGHT_LOG 3 //full rate flight data, see core/flight_log
 #define SELECT_DEBUG_TELEM TELEM_SHELL
 
 /* debug link message publish rate */
@@ -40,7 +42,16 @@
 /* ins algorithms */
 #define INS_COMPLEMENTARY_FILTER 0
 #define INS_ESKF                 1
+#ifndef SELECT_INS
 #define SELECT_INS INS_COMPLEMENTARY_FILTER
+#endif
+
+/* eskf measurement update methods, the generated batch update of the 15 state ins eskf
+ * is faster than its scalar updates, the 3 state ahrs eskf saves the matrix inversion */
+#define ESKF_UPDATE_BATCH      0 //kalman gain with the inverse of the innovation covariance
+#define ESKF_UPDATE_SEQUENTIAL 1 //one scalar update per measurement component, no inversion
+#define SELECT_ESKF_AHRS_UPDATE ESKF_UPDATE_SEQUENTIAL
+#define SELECT_ESKF_INS_UPDATE  ESKF_UPDATE_BATCH
 
 /* quadrotor control algorithms */
 #define QUADROTOR_USE_PID      0
@@ -51,22 +62,42 @@
  * hardware settings *
  *===================*/
 
+/* the navigation sensor selections of this and the next section can be given
+ * by the compiler flags, see the gps simulation of the host build (host/Makefile) */
+
 /* navigation device 1 */
 #define NAV_DEV1_NO_CONNECTION 0
 #define NAV_DEV1_USE_OPTITRACK 1
 #define NAV_DEV1_USE_GPS       2
+#ifndef SELECT_NAVIGATION_DEVICE1
 #define SELECT_NAVIGATION_DEVICE1 NAV_DEV1_USE_OPTITRACK
+#endif
 
 /* navigation device 2 */
 #define NAV_DEV2_NO_CONNECTION 0
 #define NAV_DEV2_USE_VINS_MONO 1
 #define SELECT_NAVIGATION_DEVICE2 NAV_DEV2_NO_CONNECTION
 
+/* imu acquisition mode */
+#define IMU_DATA_READY 0 //1kHz sampling with the 20Hz dlpf, one burst read per data ready interrupt
+#define IMU_FIFO       1 //8kHz gyroscope / 4kHz accelerometer, fifo drained with 1kHz and decimated
+#define SELECT_IMU_MODE IMU_DATA_READY
+
 /* compass sensor option */
+#ifndef ENABLE_MAGNETOMETER
 #define ENABLE_MAGNETOMETER    0
+#endif
+
+/* compass bus: the ist8310 of the board is wired to pe0/pe1 (no i2c alternate
+ * function), the hardware i2c option requires it to be rewired to i2c2 (pb10/pb11) */
+#define COMPASS_SW_I2C 0 //bit-banged i2c driven by timer2
+#define COMPASS_HW_I2C 1 //interrupt driven i2c2 transactions
+#define SELECT_COMPASS_I2C COMPASS_SW_I2C
 
 /* barometer sensor option */
+#ifndef ENABLE_BAROMETER
 #define ENABLE_BAROMETER       0
+#endif
 
 /*=======================================================*
  * sensor source settings for state estimation algorithm *
@@ -77,21 +108,27 @@
 #define HEADING_FUSION_USE_COMPASS   1
 #define HEADING_FUSION_USE_OPTITRACK 2
 #define HEADING_FUSION_USE_VINS_MONO 3
+#ifndef SELECT_HEADING_SENSOR
 #define SELECT_HEADING_SENSOR HEADING_FUSION_USE_OPTITRACK
+#endif
 
 /* height fusion source */
 #define NO_HEIGHT_SENSOR            0
 #define HEIGHT_FUSION_USE_BAROMETER 1
 #define HEIGHT_FUSION_USE_OPTITRACK 2
 #define HEIGHT_FUSION_USE_VINS_MONO 3
+#ifndef SELECT_HEIGHT_SENSOR
 #define SELECT_HEIGHT_SENSOR HEIGHT_FUSION_USE_OPTITRACK
+#endif
 
 /* position fusion source */
 #define NO_POSITION_SENSOR            0
 #define POSITION_FUSION_USE_GPS       1
 #define POSITION_FUSION_USE_OPTITRACK 2
 #define POSITION_FUSION_USE_VINS_MONO 3
+#ifndef SELECT_POSITION_SENSOR
 #define SELECT_POSITION_SENSOR POSITION_FUSION_USE_OPTITRACK
+#endif
 
 /* configuration validation */
 #if (SELECT_NAVIGATION_DEVICE1 != NAV_DEV1_USE_GPS) && (SELECT_POSITION_SENSOR == POSITION_FUSION_USE_GPS)
@@ -0,0 +1,455 @@
+import argparse
+import os
+
+import sympy as sp
+from sympy.printing.c import C99CodePrinter
+
+# code generator of the ins eskf covariance prediction and measurement updates
+# (src/core/state_estimator/ins/ins_eskf_generated.c), the models are written down
+# symbolically below and expanded with the known zeros of F and H, the common
+# subexpressions are eliminated by sympy and the code is printed with float literals
+# only. run it again after changing a model:
+#
+#   python3 tools/eskf_codegen.py (needs sympy)
+#
+# error state: delta_x = [delta_p (0-2); delta_v (3-5); delta_theta (6-8);
+#                         delta_a_b (9-11); delta_w_b (12-14)]
+#
+# the biases are random walks, F only couples them to the velocity and attitude
+# errors so the prediction costs a fraction of the dense 15 x 15 products
+
+STATE_NUM = 15
+OUTPUT_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                          '../src/core/state_estimator/ins')
+OUTPUT_NAME = 'ins_eskf_generated'
+
+#the velocity is integrated in the enu frame while R rotates the body frame to ned
+NED_TO_ENU = sp.Matrix([[0, 1, 0], [1, 0, 0], [0, 0, -1]])
+
+
+class FloatPrinter(C99CodePrinter):
+    """c printer that names the matrix elements and never promotes to double"""
+
+    def __init__(self, names):
+        super().__init__()
+        self.names = names
+
+    def _print_Symbol(self, expr):
+        return self.names.get(expr, expr.name)
+
+    def _print_Integer(self, expr):
+        return '%d.0f' % expr.p
+
+    def _print_Rational(self, expr):
+        return repr(float(expr)) + 'f'
+
+    def _print_Float(self, expr):
+        return repr(float(expr)) + 'f'
+
+    def _print_Pow(self, expr):
+        base = self.parenthesize(expr.base, sp.printing.precedence.PRECEDENCE['Mul'])
+        if expr.exp.is_Integer and 2 <= expr.exp <= 3:
+            return '*'.join([base] * int(expr.exp))
+        if expr.exp == -1:
+            return '1.0f/' + self.parenthesize(expr.base, sp.printing.precedence.PRECEDENCE['Pow'])
+        raise ValueError('unsupported power: %s' % expr)
+
+    def _print_Add(self, expr):
+        #start with a positive term if there is one
+        terms = self._as_ordered_terms(expr, order=None)
+        terms.sort(key=lambda term: term.could_extract_minus_sign())
+        code = self._print(terms[0])
+        for term in terms[1:]:
+            if term.could_extract_minus_sign():
+                code += ' - ' + self.parenthesize(-term, sp.printing.precedence.PRECEDENCE['Add'],
+                                                  strict=True)
+            else:
+                code += ' + ' + self._print(term)
+        return code
+
+    def _print_Mul(self, expr):
+        coeff, term = expr.as_coeff_Mul()
+        if coeff < 0:
+            return '-' + self.parenthesize(-expr, sp.printing.precedence.PRECEDENCE['Mul'],
+                                           strict=True)
+        if coeff.is_Rational and coeff.is_Integer == False:
+            return self._print(coeff) + '*' + \
+                self.parenthesize(term, sp.printing.precedence.PRECEDENCE['Mul'], strict=True)
+        return super()._print_Mul(expr)
+
+
+class Function:
+    """c function assembled from blocks of assignments, every block is reduced
+    with common subexpression elimination before it is printed"""
+
+    def __init__(self, comment, prototype):
+        self.comment = comment
+        self.prototype = prototype
+        self.names = {}
+        self.lines = []
+        self.temp_cnt = 0
+
+    def name(self, symbol, c_name):
+        self.names[symbol] = c_name
+
+    def block(self, comment, assignments):
+        """assignments: list of (c lvalue or sympy symbol, sympy expression)"""
+        printer = FloatPrinter(self.names)
+        exprs = [expr for _, expr in assignments]
+        temps = sp.numbered_symbols('c', start=self.temp_cnt)
+        replacements, reduced = sp.cse(exprs, symbols=temps, optimizations='basic')
+        self.temp_cnt += len(replacements)
+
+        self.lines.append('')
+        self.lines.append('\t/* %s */' % comment)
+        for temp, expr in replacements:
+            self.lines.append('\tfloat %s = %s;' % (temp, printer.doprint(expr)))
+        for (lvalue, _), expr in zip(assignments, reduced):
+            if isinstance(lvalue, sp.Symbol):
+                self.lines.append('\tfloat %s = %s;' % (lvalue.name, printer.doprint(expr)))
+            else:
+                self.lines.append('\t%s = %s;' % (lvalue, printer.doprint(expr)))
+
+    def code(self):
+        lines = ['/* ' + self.comment[0]] + [' * ' + line for line in self.comment[1:]]
+        lines[-1] += ' */'
+        lines.append(self.prototype)
+        lines.append('{')
+        lines += self.lines[1:]
+        lines.append('}')
+        return '\n'.join(lines)
+
+
+def prototype(name, args, width=100):
+    """function declaration wrapped at the given width, the arguments are aligned"""
+    lines = ['void %s(' % name]
+    indent = ' ' * len(lines[0])
+    line_start = True
+    for i, arg in enumerate(args):
+        arg += ')' if i == len(args) - 1 else ','
+        if line_start == False and len(lines[-1]) + len(arg) + 1 > width:
+            lines.append(indent)
+            line_start = True
+        lines[-1] += arg if line_start else ' ' + arg
+        line_start = False
+    return '\n'.join(lines)
+
+
+def sym_matrix(func, name, n):
+    """packed symmetric n x n matrix, (r, c) and (c, r) are the same symbol"""
+    P = sp.zeros(n, n)
+    for r in range(n):
+        for c in range(r, n):
+            P[r, c] = P[c, r] = sp.Symbol('%s_%d_%d' % (name, r, c))
+            func.name(P[r, c], '%s(%d, %d)' % (name, r, c))
+    return P
+
+
+def vector(func, name, n):
+    v = sp.Matrix([sp.Symbol('%s_%d' % (name, i)) for i in range(n)])
+    for i in range(n):
+        func.name(v[i], '%s[%d]' % (name, i))
+    return v
+
+
+def matrix(func, name, rows, cols):
+    M = sp.Matrix(rows, cols, lambda r, c: sp.Symbol('%s_%d_%d' % (name, r, c)))
+    for r in range(rows):
+        for c in range(cols):
+            func.name(M[r, c], '%s[%d]' % (name, r * cols + c))
+    return M
+
+
+def skew(v):
+    return sp.Matrix([[0, -v[2], v[1]],
+                      [v[2], 0, -v[0]],
+                      [-v[1], v[0], 0]])
+
+
+def quaternion_mult(a, b):
+    return sp.Matrix([a[0]*b[0] - a[1]*b[1] - a[2]*b[2] - a[3]*b[3],
+                      a[0]*b[1] + a[1]*b[0] + a[2]*b[3] - a[3]*b[2],
+                      a[0]*b[2] - a[1]*b[3] + a[2]*b[0] + a[3]*b[1],
+                      a[0]*b[3] + a[1]*b[2] - a[2]*b[1] + a[3]*b[0]])
+
+
+def quaternion_to_rotation_matrix(q):
+    q0, q1, q2, q3 = q
+    return sp.Matrix([[q0*q0 + q1*q1 - q2*q2 - q3*q3, 2*(q1*q2 - q0*q3), 2*(q1*q3 + q0*q2)],
+                      [2*(q1*q2 + q0*q3), q0*q0 - q1*q1 + q2*q2 - q3*q3, 2*(q2*q3 - q0*q1)],
+                      [2*(q1*q3 - q0*q2), 2*(q2*q3 + q0*q1), q0*q0 - q1*q1 - q2*q2 + q3*q3]])
+
+
+def attitude_jacobian(h, q):
+    """jacobian of the measurement function h(q) with respect to the attitude error,
+    the error is injected as q * [1, theta / 2] (see eskf_ins_accelerometer_correct())"""
+    theta = sp.symbols('theta_x theta_y theta_z')
+    q_error = [1, theta[0] / 2, theta[1] / 2, theta[2] / 2]
+    h_perturbed = h(quaternion_mult(q, q_error))
+    return sp.expand(h_perturbed.jacobian(theta).subs({t: 0 for t in theta}))
+
+
+def covariance_predict():
+    func = Function(['P_prior = F * P_post * Ft + Q, F is the error state transition matrix',
+                     'and Q has the variances of the acceleration and angular velocity noises',
+                     'and of the bias random walks, accel and gyro are the bias corrected inputs'],
+                    prototype('eskf_ins_covariance_predict',
+                              ['const float *_P_post', 'float *_P_prior', 'const float *R',
+                               'const float *accel', 'const float *gyro', 'const float *Q_i',
+                               'float dt']))
+    P_post = sym_matrix(func, 'P_post', STATE_NUM)
+    sym_matrix(func, 'P_prior', STATE_NUM)
+    R = matrix(func, 'R', 3, 3)
+    a = vector(func, 'accel', 3)
+    w = vector(func, 'gyro', 3)
+    Q_i = matrix(func, 'Q_i', 12, 12)
+    dt = sp.Symbol('dt')
+
+    R_enu = NED_TO_ENU * R
+
+    #velocity error driven by the attitude error: -R * [a_m - a_b]x * dt
+    R_a_dt = -R_enu * skew(a) * dt
+    #velocity error driven by the accelerometer bias error: -R * dt
+    R_dt = -R_enu * dt
+    #attitude error transition: Rt{(w_m - w_b) * dt} ~= I - [w_m - w_b]x * dt
+    Rt_w_dt = sp.eye(3) - skew(w) * dt
+
+    F_assignments = []
+    F = sp.eye(STATE_NUM)
+    F[0:3, 3:6] = sp.eye(3) * dt
+    F[6:9, 12:15] = -sp.eye(3) * dt
+    for r in range(3):
+        for c in range(3):
+            F[3 + r, 6 + c] = sp.Symbol('F_%d_%d' % (3 + r, 6 + c))
+            F_assignments.append((F[3 + r, 6 + c], sp.expand(R_a_dt[r, c])))
+            if r != c:
+                F[6 + r, 6 + c] = sp.Symbol('F_%d_%d' % (6 + r, 6 + c))
+                F_assignments.append((F[6 + r, 6 + c], Rt_w_dt[r, c]))
+    for r in range(3):
+        for c in range(3):
+            F[3 + r, 9 + c] = sp.Symbol('F_%d_%d' % (3 + r, 9 + c))
+            F_assignments.append((F[3 + r, 9 + c], R_dt[r, c]))
+    func.block('non-zero elements of F (except the identity and dt blocks)', F_assignments)
+
+    Q = sp.zeros(STATE_NUM, STATE_NUM)
+    for i in range(12):
+        Q[3 + i, 3 + i] = Q_i[i, i]
+
+    #F * P_post is calculated first since its rows are shared by the upper triangle of
+    #the product, the rows of the biases are the rows of P_post
+    FP_expr = F * P_post
+    FP = sp.Matrix(STATE_NUM, STATE_NUM, lambda r, c: FP_expr[r, c])
+    for r in range(9):
+        for c in range(STATE_NUM):
+            FP[r, c] = sp.Symbol('FP_%d_%d' % (r, c))
+
+    P_prior = [('P_prior(%d, %d)' % (r, c), (FP[r, :] * F[c, :].T)[0] + Q[r, c])
+               for r in range(STATE_NUM) for c in range(r, STATE_NUM)]
+    used = set().union(*[expr.free_symbols for _, expr in P_prior])
+    func.block('calculate F * P_post',
+               [(FP[r, c], FP_expr[r, c]) for r in range(9) for c in range(STATE_NUM)
+                if FP[r, c] in used])
+    func.block('calculate the a priori process covariance matrix', P_prior)
+
+    return func
+
+
+def measurement(name, comment, params, h, H):
+    """predicted measurement h and the non-zero columns of H (row-major)"""
+    func = Function(comment, prototype('eskf_ins_%s_measurement' % name,
+                                       [c_decl for c_decl, _ in params] + ['float *h', 'float *H']))
+    for _, symbols in params:
+        for symbol, c_name in symbols:
+            func.name(symbol, c_name)
+
+    H_len = H.cols
+    assignments = [('h[%d]' % i, h[i]) for i in range(h.rows)]
+    assignments += [('H[%d]' % (r * H_len + c), H[r, c])
+                    for r in range(H.rows) for c in range(H_len)]
+    func.block('predicted measurement and measurement matrix', assignments)
+
+    return func
+
+
+def covariance_update(name, comment, params, H, corrected):
+    """batch update with the kalman gain K = P * Ht * inv(H * P * Ht + V), H is given
+    symbolically so the known zeros and ones are folded into the expressions. only the
+    error states listed in corrected have a gain, the others are considered (schmidt):
+    their error state is zero, their covariance is kept and their cross covariance with
+    the corrected states is updated, P stays consistent with the injected error state"""
+    m = H.rows
+    func = Function(comment, prototype('eskf_ins_%s_covariance_update' % name,
+                                       ['const float *_P_prior', 'float *_P_post', 'float *delta_x'] +
+                                       [c_decl for c_decl, _ in params] +
+                                       ['const float *resid', 'const float *V']))
+    for _, symbols in params:
+        for symbol, c_name in symbols:
+            func.name(symbol, c_name)
+    P_prior = sym_matrix(func, 'P_prior', STATE_NUM)
+    sym_matrix(func, 'P_post', STATE_NUM)
+    resid = vector(func, 'resid', m)
+    V = matrix(func, 'V', m, m)
+
+    #P * Ht
+    PHt = sp.Matrix(STATE_NUM, m, lambda r, c: sp.Symbol('PHt_%d_%d' % (r, c)))
+    PHt_expr = P_prior * H.T
+    func.block('calculate P * Ht',
+               [(PHt[r, c], PHt_expr[r, c]) for r in range(STATE_NUM) for c in range(m)])
+
+    #(H * P * Ht) + V, symmetric
+    S = sp.zeros(m, m)
+    S_assignments = []
+    HPHt = H * PHt
+    for r in range(m):
+        for c in range(r, m):
+            S[r, c] = S[c, r] = sp.Symbol('HPHt_V_%d_%d' % (r, c))
+            S_assignments.append((S[r, c], HPHt[r, c] + (V[r, c] if r == c else 0)))
+    func.block('calculate (H * P * Ht) + V', S_assignments)
+
+    #inv(H * P * Ht + V) = adj(H * P * Ht + V) / det(H * P * Ht + V), the determinant is
+    #expanded along the first row to share the cofactors with the adjugate
+    adj = S.adjugate()
+    div_det = sp.Symbol('div_det')
+    S_inv = sp.zeros(m, m)
+    S_inv_assignments = [(div_det, 1 / sum(S[0, c] * adj[c, 0] for c in range(m)))]
+    for r in range(m):
+        for c in range(r, m):
+            S_inv[r, c] = S_inv[c, r] = sp.Symbol('HPHt_V_inv_%d_%d' % (r, c))
+            S_inv_assignments.append((S_inv[r, c], adj[r, c] * div_det))
+    func.block('calculate inv((H * P * Ht) + V)', S_inv_assignments)
+
+    #K = P * Ht * inv(H * P * Ht + V), zero rows for the considered states
+    K = sp.Matrix(STATE_NUM, m, lambda r, c: sp.Symbol('K_%d_%d' % (r, c)) if r in corrected else 0)
+    K_expr = PHt * S_inv
+    func.block('calculate kalman gain',
+               [(K[r, c], K_expr[r, c]) for r in corrected for c in range(m)])
+
+    #delta_x = K * resid
+    delta_x = K * resid
+    func.block('calculate error state',
+               [('delta_x[%d]' % r, delta_x[r]) for r in range(STATE_NUM)])
+
+    #P = (I - K*H) * P * (I - K*H)' + K * V * Kt, with the optimal rows of K this is
+    #P - K * (P * Ht)' if the row or the column is corrected and P otherwise
+    def P_post(r, c):
+        if r in corrected:
+            return P_prior[r, c] - (K[r, :] * PHt[c, :].T)[0]
+        if c in corrected:
+            return P_prior[r, c] - (K[c, :] * PHt[r, :].T)[0]
+        return P_prior[r, c]
+
+    func.block('calculate a posteriori process covariance matrix',
+               [('P_post(%d, %d)' % (r, c), P_post(r, c))
+                for r in range(STATE_NUM) for c in range(r, STATE_NUM)])
+
+    return func
+
+
+def quaternion_params():
+    q = sp.symbols('q0 q1 q2 q3')
+    return q, ('const float *q', [(q[i], 'q[%d]' % i) for i in range(4)])
+
+
+def main():
+    parser = argparse.ArgumentParser(description='generate the ins eskf equations')
+    parser.add_argument('--output', default=OUTPUT_DIR, help='output directory')
+    args = parser.parse_args()
+
+    functions = [covariance_predict()]
+
+    #accelerometer: gravity direction in the body frame, Rt * [0; 0; 1]. the measured
+    #direction g = -(a_m - a_b) / |a_m - a_b| depends on the bias as well, its error
+    #changes g by -(I - g * gt) / |a_m - a_b| * delta_a_b
+    q, q_param = quaternion_params()
+    g = sp.Matrix(sp.symbols('g0:3'))
+    div_norm = sp.Symbol('div_norm')
+    accel_params = [q_param, ('const float *g', [(g[i], 'g[%d]' % i) for i in range(3)]),
+                    ('float div_norm', [(div_norm, 'div_norm')])]
+    h_accel = lambda q: quaternion_to_rotation_matrix(q).T * sp.Matrix([0, 0, 1])
+    H_accel = attitude_jacobian(h_accel, q).row_join(-div_norm * (sp.eye(3) - g * g.T))
+    functions.append(measurement('accelerometer',
+                                 ['predicted gravity vector (body frame) and the attitude error',
+                                  'and accelerometer bias columns (6-11) of the measurement matrix'],
+                                 accel_params, h_accel(q), H_accel))
+
+    #magnetometer: the reference field has no east component, Rt * [gamma; 0; mz]
+    gamma, mz = sp.symbols('gamma mz')
+    mag_params = [q_param, ('float gamma', [(gamma, 'gamma')]), ('float mz', [(mz, 'mz')])]
+    h_mag = lambda q: quaternion_to_rotation_matrix(q).T * sp.Matrix([gamma, 0, mz])
+    H_mag = attitude_jacobian(h_mag, q)
+    functions.append(measurement('magnetometer',
+                                 ['predicted magnetic field vector (body frame) and the attitude',
+                                  'error columns (6-8) of the measurement matrix'],
+                                 mag_params, h_mag(q), H_mag))
+
+    #H is passed as the non-zero columns starting from the attitude error (6), the
+    #entries that are always zero are never read
+    def measurement_matrix(H_cols):
+        H_sym = matrix(Function([], ''), 'H', 3, H_cols.cols)
+        H = sp.zeros(3, STATE_NUM)
+        names = []
+        for r in range(3):
+            for c in range(H_cols.cols):
+                if H_cols[r, c] != 0:
+                    H[r, 6 + c] = H_sym[r, c]
+                    names.append((H_sym[r, c], 'H[%d]' % (r * H_cols.cols + c)))
+        return H, [('const float *H', names)]
+
+    H, H_param = measurement_matrix(H_accel)
+    functions.append(covariance_update(
+        'accelerometer', ['kalman gain, error state and a posteriori covariance of the',
+                          'accelerometer update, H contains the columns 6-11 of the measurement',
+                          'matrix (see eskf_ins_accelerometer_measurement())'],
+        H_param, H, range(STATE_NUM)))
+
+    #the compass only corrects the yaw and the gyroscope bias of the z axis, the roll and
+    #pitch are left to the accelerometer
+    H, H_param = measurement_matrix(H_mag)
+    functions.append(covariance_update(
+        'magnetometer', ['kalman gain, error state and a posteriori covariance of the',
+                         'magnetometer update, H contains the columns 6-8 of the measurement',
+                         'matrix (see eskf_ins_magnetometer_measurement())'],
+        H_param, H, [8, 14]))
+
+    #gps: px, py, vx, vy, the position is captured lag seconds ago and is a measurement
+    #of p - lag * v with the present state. the attitude is left to the accelerometer and
+    #the compass, only the measured axes and the accelerometer bias are corrected
+    lag = sp.Symbol('lag')
+    H_gps = sp.zeros(4, STATE_NUM)
+    H_gps[0, 0] = H_gps[1, 1] = 1
+    H_gps[0, 3] = H_gps[1, 4] = -lag
+    H_gps[2, 3] = H_gps[3, 4] = 1
+    functions.append(covariance_update(
+        'gps', ['kalman gain, error state and a posteriori covariance of the gps update,',
+                'resid = (px, py, vx, vy) - nominal state at the capture time'],
+        [('float lag', [(lag, 'lag')])], H_gps, [0, 1, 3, 4, 9, 10, 11]))
+
+    #barometer: pz, vz
+    H_baro = sp.zeros(2, STATE_NUM)
+    H_baro[0, 2] = 1
+    H_baro[0, 5] = -lag
+    H_baro[1, 5] = 1
+    functions.append(covariance_update(
+        'barometer', ['kalman gain, error state and a posteriori covariance of the barometer',
+                      'update, resid = (pz, vz) - nominal state at the capture time'],
+        [('float lag', [(lag, 'lag')])], H_baro, [2, 5, 9, 10, 11]))
+
+    banner = '/* generated by tools/eskf_codegen.py, do not edit */\n'
+
+    header = [banner, '#ifndef __INS_ESKF_GENERATED_H__', '#define __INS_ESKF_GENERATED_H__', '']
+    header += [f.prototype + ';' for f in functions]
+    header += ['', '#endif', '']
+
+    source = [banner, '#include "matrix.h"', '#include "%s.h"' % OUTPUT_NAME, '',
+              '#define P_prior(r, c) _P_prior[SYM_MAT_INDEX(%d, r, c)]' % STATE_NUM,
+              '#define P_post(r, c)  _P_post[SYM_MAT_INDEX(%d, r, c)]' % STATE_NUM, '']
+    source += ['\n\n'.join(f.code() for f in functions), '']
+
+    with open(os.path.join(args.output, OUTPUT_NAME + '.h'), 'w') as f:
+        f.write('\n'.join(header))
+    with open(os.path.join(args.output, OUTPUT_NAME + '.c'), 'w') as f:
+        f.write('\n'.join(source))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,98 @@
+import argparse
+import struct
+import sys
+
+# decoder of the flight log (see src/core/flight_log/flight_log.h), every
+# record type is saved into <prefix>_<type>.csv
+
+SYNC_BYTE = ord('$')
+HEADER_SIZE = 7
+
+record_formats = {
+    32: ('imu', '<6f', ['accel_x', 'accel_y', 'accel_z', 'gyro_x', 'gyro_y', 'gyro_z']),
+    33: ('attitude', '<4f', ['q0', 'q1', 'q2', 'q3']),
+    34: ('ins', '<6f', ['pos_x', 'pos_y', 'pos_z', 'vel_x', 'vel_y', 'vel_z']),
+    35: ('controller', '<4f', ['moment_x', 'moment_y', 'moment_z', 'force']),
+    36: ('motor', '<4H', ['motor1', 'motor2', 'motor3', 'motor4']),
+    37: ('perf', '<4I', ['ahrs_ins', 'controller', 'loop', 'wakeup'])
+}
+
+
+def parse_records(data):
+    i = 0
+    error_cnt = 0
+    while i + HEADER_SIZE < len(data):
+        if data[i] != SYNC_BYTE:
+            i += 1
+            continue
+
+        record_type = data[i + 1]
+        size = data[i + 2]
+        end = i + HEADER_SIZE + size
+        if end >= len(data):
+            break
+
+        checksum = 0
+        for c in data[i + 1:end]:
+            checksum ^= c
+
+        if checksum != data[end]:
+            error_cnt += 1
+            i += 1
+            continue
+
+        timestamp_us = struct.unpack_from('<I', data, i + 3)[0]
+        yield record_type, timestamp_us, data[i + HEADER_SIZE:end]
+        i = end + 1
+
+    if error_cnt > 0:
+        print('%d corrupted records skipped' % error_cnt, file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='flight log decoder')
+    parser.add_argument('log_file')
+    parser.add_argument('-o', '--prefix', default='flight_log')
+    args = parser.parse_args()
+
+    with open(args.log_file, 'rb') as f:
+        data = f.read()
+
+    csv_files = {}
+    record_cnt = {}
+    last_timestamp = {}
+    wrap_us = {}
+
+    for record_type, timestamp_us, payload in parse_records(data):
+        if record_type not in record_formats:
+            continue
+
+        name, fmt, fields = record_formats[record_type]
+        if struct.calcsize(fmt) != len(payload):
+            continue
+
+        if record_type not in csv_files:
+            csv_files[record_type] = open('%s_%s.csv' % (args.prefix, name), 'w')
+            csv_files[record_type].write('time_s,' + ','.join(fields) + '\n')
+            record_cnt[record_type] = 0
+            last_timestamp[record_type] = timestamp_us
+            wrap_us[record_type] = 0
+
+        # unwrap the 32 bits microsecond timestamps
+        if timestamp_us < last_timestamp[record_type]:
+            wrap_us[record_type] += 1 << 32
+        last_timestamp[record_type] = timestamp_us
+        time_s = (wrap_us[record_type] + timestamp_us) * 1e-6
+
+        values = struct.unpack(fmt, payload)
+        csv_files[record_type].write('%.6f,' % time_s +
+                                     ','.join(str(v) for v in values) + '\n')
+        record_cnt[record_type] += 1
+
+    for record_type in sorted(csv_files):
+        csv_files[record_type].close()
+        print('%-10s %8d records' % (record_formats[record_type][0], record_cnt[record_type]))
+
+
+if __name__ == '__main__':
+    main()
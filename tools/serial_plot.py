@@ -546,6 +546,12 @@ class serial_plotter_class:
             self.create_curve('P66', 'pink')
             self.create_curve('P77', 'gray')
             self.create_curve('P88', 'cyan')
+            self.create_curve('P99', 'olive')
+            self.create_curve('P1010', 'navy')
+            self.create_curve('P1111', 'teal')
+            self.create_curve('P1212', 'magenta')
+            self.create_curve('P1313', 'gold')
+            self.create_curve('P1414', 'black')
             self.show_subplot()
 
         elif (message_id == 33):